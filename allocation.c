@@ -0,0 +1,588 @@
+/***************************************************
+* Exposes pthread keys and pthread_once under C89. *
+***************************************************/
+#define _POSIX_C_SOURCE 200112L
+
+#include "allocation.h"
+#include "list.h"
+#include "my_assert.h"
+#include "parallel.h"
+#include "queue.h"
+#include "unordered_map.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FALSE 0
+#define TRUE 1
+
+static const char* SUBSYSTEM_NAMES[] = {
+    "list", "queue", "unordered_map", "unordered_set", "heap", "graph",
+    "frontier_queue", "concurrent_map", "search_path"
+};
+
+/*******************************************************************************
+* The counters of one thread. Only the owner writes them, with plain stores,   *
+* and the readers sum the records of all the threads, so an allocation touches *
+* no shared cache line. A record whose thread ended is handed to the next new  *
+* thread with its counts, as its blocks may still be freed elsewhere. The byte *
+* counts of a thread freeing blocks of another one wrap around below zero,     *
+* which the sums absorb; the peaks compare them as signed.                     *
+*******************************************************************************/
+typedef struct allocation_thread {
+    allocation_counters       counters_array[ALLOCATION_SUBSYSTEMS];
+    size_t                    bytes;
+    size_t                    scope_peak_bytes;
+    size_t                    in_use;
+    struct allocation_thread* p_next;
+    char                      padding[64];
+} allocation_thread;
+
+static void* default_alloc(size_t bytes, void* p_user)
+{
+    (void) p_user;
+    return malloc(bytes);
+}
+
+static void default_free(void* p_memory, size_t bytes, void* p_user)
+{
+    (void) bytes;
+    (void) p_user;
+    free(p_memory);
+}
+
+static allocation_hooks hooks = { default_alloc, default_free, NULL };
+static size_t           thread_list = 0;
+static int              key_created = FALSE;
+
+#ifdef _WIN32
+static DWORD     key;
+static INIT_ONCE key_once = INIT_ONCE_STATIC_INIT;
+#else
+static pthread_key_t  key;
+static pthread_once_t key_once = PTHREAD_ONCE_INIT;
+#endif
+
+/*******************************************************************************
+* Called as a thread ends, releasing its record for reuse.                     *
+*******************************************************************************/
+#ifdef _WIN32
+static VOID NTAPI release_thread(PVOID p_argument)
+#else
+static void release_thread(void* p_argument)
+#endif
+{
+    allocation_thread* p_thread = p_argument;
+
+    if (p_thread) PARALLEL_STORE(&p_thread->in_use, 0);
+}
+
+#ifdef _WIN32
+static BOOL CALLBACK create_key(PINIT_ONCE p_once,
+                                PVOID p_parameter,
+                                PVOID* pp_context)
+{
+    (void) p_once;
+    (void) p_parameter;
+    (void) pp_context;
+    key = FlsAlloc(release_thread);
+    key_created = key != FLS_OUT_OF_INDEXES;
+    return TRUE;
+}
+#else
+static void create_key()
+{
+    key_created = pthread_key_create(&key, release_thread) == 0;
+}
+#endif
+
+/*******************************************************************************
+* Takes the record of an ended thread, or links a new one into the list, which *
+* only grows. Returns NULL if the memory ran out.                              *
+*******************************************************************************/
+static allocation_thread* attach_thread()
+{
+    allocation_thread* p_thread;
+    size_t             head;
+
+    for (p_thread = (allocation_thread*) PARALLEL_LOAD(&thread_list);
+         p_thread;
+         p_thread = p_thread->p_next)
+    {
+        if (PARALLEL_CAS(&p_thread->in_use, 0, 1)) break;
+    }
+
+    if (!p_thread)
+    {
+        p_thread = calloc(1, sizeof(*p_thread));
+
+        if (!p_thread) return NULL;
+
+        p_thread->in_use = 1;
+
+        do
+        {
+            head = PARALLEL_LOAD(&thread_list);
+            p_thread->p_next = (allocation_thread*) head;
+        }
+        while (!PARALLEL_CAS(&thread_list, head, (size_t) p_thread));
+    }
+
+#ifdef _WIN32
+    FlsSetValue(key, p_thread);
+#else
+    pthread_setspecific(key, p_thread);
+#endif
+    return p_thread;
+}
+
+/*******************************************************************************
+* Returns the record of the calling thread, or NULL if it could not be made,   *
+* in which case nothing is counted.                                            *
+*******************************************************************************/
+static allocation_thread* current_thread()
+{
+    allocation_thread* p_thread;
+
+#ifdef _WIN32
+    InitOnceExecuteOnce(&key_once, create_key, NULL, NULL);
+
+    if (!key_created) return NULL;
+
+    p_thread = FlsGetValue(key);
+#else
+    pthread_once(&key_once, create_key);
+
+    if (!key_created) return NULL;
+
+    p_thread = pthread_getspecific(key);
+#endif
+    return p_thread ? p_thread : attach_thread();
+}
+
+/*******************************************************************************
+* Adds 'delta' to the count of the owner and raises its peak if need be.       *
+*******************************************************************************/
+static void add_bytes(size_t* p_bytes, size_t* p_peak_bytes, size_t delta)
+{
+    size_t bytes = *p_bytes + delta;
+
+    PARALLEL_STORE(p_bytes, bytes);
+
+    if ((ptrdiff_t) bytes > (ptrdiff_t) *p_peak_bytes)
+    {
+        PARALLEL_STORE(p_peak_bytes, bytes);
+    }
+}
+
+void* allocation_alloc(int subsystem, size_t bytes)
+{
+    allocation_thread*   p_thread = current_thread();
+    allocation_counters* p_counters;
+    void*                p_memory = hooks.p_alloc(bytes, hooks.p_user);
+
+    if (!p_memory || !p_thread) return p_memory;
+
+    p_counters = &p_thread->counters_array[subsystem];
+    PARALLEL_STORE(&p_counters->allocations, p_counters->allocations + 1);
+    add_bytes(&p_counters->bytes, &p_counters->peak_bytes, bytes);
+
+    /* Only the owner reads the peak of its scopes. */
+    PARALLEL_STORE(&p_thread->bytes, p_thread->bytes + bytes);
+
+    if ((ptrdiff_t) p_thread->bytes > (ptrdiff_t) p_thread->scope_peak_bytes)
+    {
+        p_thread->scope_peak_bytes = p_thread->bytes;
+    }
+
+    return p_memory;
+}
+
+void* allocation_calloc(int subsystem, size_t count, size_t size)
+{
+    void* p_memory;
+
+    if (size > 0 && count > (size_t) -1 / size) return NULL;
+
+    p_memory = allocation_alloc(subsystem, count * size);
+
+    if (p_memory)
+    {
+        memset(p_memory, 0, count * size);
+    }
+
+    return p_memory;
+}
+
+void allocation_free(int subsystem, void* p_memory, size_t bytes)
+{
+    allocation_thread*   p_thread;
+    allocation_counters* p_counters;
+
+    if (!p_memory) return;
+
+    hooks.p_free(p_memory, bytes, hooks.p_user);
+    p_thread = current_thread();
+
+    if (!p_thread) return;
+
+    p_counters = &p_thread->counters_array[subsystem];
+    PARALLEL_STORE(&p_counters->frees, p_counters->frees + 1);
+    PARALLEL_STORE(&p_counters->bytes, p_counters->bytes - bytes);
+    PARALLEL_STORE(&p_thread->bytes, p_thread->bytes - bytes);
+}
+
+void allocation_set_hooks(allocation_hooks* p_hooks)
+{
+    if (p_hooks && p_hooks->p_alloc && p_hooks->p_free)
+    {
+        hooks = *p_hooks;
+    }
+    else
+    {
+        hooks.p_alloc = default_alloc;
+        hooks.p_free  = default_free;
+        hooks.p_user  = NULL;
+    }
+}
+
+void allocation_get_counters(int subsystem, allocation_counters* p_counters)
+{
+    allocation_thread*   p_thread;
+    allocation_counters* p_source;
+
+    if (!p_counters) return;
+
+    memset(p_counters, 0, sizeof(*p_counters));
+
+    if (subsystem < 0 || subsystem >= ALLOCATION_SUBSYSTEMS) return;
+
+    for (p_thread = (allocation_thread*) PARALLEL_LOAD(&thread_list);
+         p_thread;
+         p_thread = p_thread->p_next)
+    {
+        p_source = &p_thread->counters_array[subsystem];
+        p_counters->bytes       += PARALLEL_LOAD(&p_source->bytes);
+        p_counters->peak_bytes  += PARALLEL_LOAD(&p_source->peak_bytes);
+        p_counters->allocations += PARALLEL_LOAD(&p_source->allocations);
+        p_counters->frees       += PARALLEL_LOAD(&p_source->frees);
+    }
+
+    if (p_counters->peak_bytes < p_counters->bytes)
+    {
+        p_counters->peak_bytes = p_counters->bytes;
+    }
+}
+
+size_t allocation_total_bytes()
+{
+    allocation_thread* p_thread;
+    size_t             bytes = 0;
+
+    for (p_thread = (allocation_thread*) PARALLEL_LOAD(&thread_list);
+         p_thread;
+         p_thread = p_thread->p_next)
+    {
+        bytes += PARALLEL_LOAD(&p_thread->bytes);
+    }
+
+    return bytes;
+}
+
+const char* allocation_subsystem_name(int subsystem)
+{
+    return subsystem >= 0 && subsystem < ALLOCATION_SUBSYSTEMS ?
+           SUBSYSTEM_NAMES[subsystem] :
+           "unknown";
+}
+
+/*******************************************************************************
+* Returns the number of blocks the thread allocated so far.                    *
+*******************************************************************************/
+static size_t thread_allocations(allocation_thread* p_thread)
+{
+    size_t allocations = 0;
+    int    subsystem;
+
+    for (subsystem = 0; subsystem < ALLOCATION_SUBSYSTEMS; ++subsystem)
+    {
+        allocations += p_thread->counters_array[subsystem].allocations;
+    }
+
+    return allocations;
+}
+
+void allocation_scope_begin(allocation_scope* p_scope)
+{
+    allocation_thread* p_thread = current_thread();
+
+    if (!p_thread)
+    {
+        p_scope->base_bytes       = 0;
+        p_scope->outer_peak_bytes = 0;
+        p_scope->base_allocations = 0;
+        return;
+    }
+
+    p_scope->base_allocations  = thread_allocations(p_thread);
+    p_scope->base_bytes        = p_thread->bytes;
+    p_scope->outer_peak_bytes  = p_thread->scope_peak_bytes;
+    p_thread->scope_peak_bytes = p_thread->bytes;
+}
+
+size_t allocation_scope_end(allocation_scope* p_scope)
+{
+    allocation_thread* p_thread = current_thread();
+    size_t             peak;
+
+    if (!p_thread) return 0;
+
+    peak = p_thread->scope_peak_bytes;
+
+    /* Restore the peak an enclosing scope has seen. */
+    if ((ptrdiff_t) p_scope->outer_peak_bytes > (ptrdiff_t) peak)
+    {
+        p_thread->scope_peak_bytes = p_scope->outer_peak_bytes;
+    }
+
+    return peak - p_scope->base_bytes;
+}
+
+size_t allocation_scope_allocations(allocation_scope* p_scope)
+{
+    allocation_thread* p_thread = current_thread();
+
+    return p_thread ? thread_allocations(p_thread) - p_scope->base_allocations
+                    : 0;
+}
+
+typedef struct test_allocator {
+    size_t blocks;
+    size_t bytes;
+} test_allocator;
+
+static void* test_alloc(size_t bytes, void* p_user)
+{
+    test_allocator* p_allocator = p_user;
+
+    p_allocator->blocks++;
+    p_allocator->bytes += bytes;
+    return malloc(bytes);
+}
+
+static void test_free(void* p_memory, size_t bytes, void* p_user)
+{
+    test_allocator* p_allocator = p_user;
+
+    p_allocator->blocks--;
+    p_allocator->bytes -= bytes;
+    free(p_memory);
+}
+
+static size_t test_hash_function(void* p)
+{
+    return (size_t) p;
+}
+
+static int test_equals_function(void* a, void* b)
+{
+    return a == b;
+}
+
+static void allocation_test_counters()
+{
+    allocation_counters before;
+    allocation_counters after;
+    void*               p_memory;
+    unsigned char*      p_zeroes;
+    size_t              i;
+
+    puts("        allocation_test_counters()");
+
+    allocation_get_counters(ALLOCATION_GRAPH, &before);
+    p_memory = allocation_alloc(ALLOCATION_GRAPH, 100);
+    p_zeroes = allocation_calloc(ALLOCATION_GRAPH, 10, 3);
+    ASSERT(p_memory && p_zeroes);
+
+    for (i = 0; i < 30; ++i)
+    {
+        ASSERT(p_zeroes[i] == 0);
+    }
+
+    allocation_get_counters(ALLOCATION_GRAPH, &after);
+    ASSERT(after.bytes == before.bytes + 130);
+    ASSERT(after.allocations == before.allocations + 2);
+    ASSERT(after.peak_bytes >= after.bytes);
+
+    allocation_free(ALLOCATION_GRAPH, p_memory, 100);
+    allocation_free(ALLOCATION_GRAPH, p_zeroes, 30);
+    allocation_free(ALLOCATION_GRAPH, NULL, 30);
+    allocation_get_counters(ALLOCATION_GRAPH, &after);
+    ASSERT(after.bytes == before.bytes);
+    ASSERT(after.frees == before.frees + 2);
+
+    ASSERT(allocation_calloc(ALLOCATION_GRAPH, (size_t) -1, 2) == NULL);
+    ASSERT(strcmp(allocation_subsystem_name(ALLOCATION_UNORDERED_SET),
+                  "unordered_set") == 0);
+}
+
+static void allocation_test_hooks()
+{
+    allocation_hooks    test_hooks;
+    test_allocator      allocator = { 0, 0 };
+    allocation_counters before;
+    allocation_counters after;
+    list*               p_list;
+    size_t              i;
+
+    puts("        allocation_test_hooks()");
+
+    test_hooks.p_alloc = test_alloc;
+    test_hooks.p_free  = test_free;
+    test_hooks.p_user  = &allocator;
+    allocation_set_hooks(&test_hooks);
+
+    allocation_get_counters(ALLOCATION_LIST, &before);
+    p_list = list_alloc(4);
+
+    for (i = 0; i < 100; ++i)
+    {
+        list_push_back(p_list, (void*)(intptr_t) i);
+    }
+
+    allocation_get_counters(ALLOCATION_LIST, &after);
+    ASSERT(allocator.blocks == 2);
+    ASSERT(allocator.bytes == list_memory_usage(p_list));
+    ASSERT(after.bytes - before.bytes == list_memory_usage(p_list));
+
+    list_free(p_list);
+    ASSERT(allocator.blocks == 0);
+    ASSERT(allocator.bytes == 0);
+    allocation_set_hooks(NULL);
+}
+
+static void allocation_test_usage()
+{
+    unordered_map* p_map;
+    queue*         p_queue;
+    size_t         base;
+    size_t         i;
+
+    puts("        allocation_test_usage()");
+
+    base = allocation_total_bytes();
+    p_map = unordered_map_alloc(8,
+                                1.0f,
+                                test_hash_function,
+                                test_equals_function);
+
+    for (i = 1; i <= 100; ++i)
+    {
+        unordered_map_put(p_map, (void*)(intptr_t) i, NULL);
+    }
+
+    ASSERT(allocation_total_bytes() - base ==
+           unordered_map_memory_usage(p_map));
+
+    unordered_map_free(&p_map);
+    ASSERT(allocation_total_bytes() == base);
+
+    p_queue = queue_alloc();
+
+    for (i = 1; i <= 10; ++i)
+    {
+        queue_push_back(p_queue, (void*)(intptr_t) i);
+    }
+
+    queue_pop_front(p_queue);
+    ASSERT(allocation_total_bytes() - base == queue_memory_usage(p_queue));
+
+    queue_free(p_queue);
+    ASSERT(allocation_total_bytes() == base);
+}
+
+static void allocation_test_scope()
+{
+    allocation_scope outer;
+    allocation_scope inner;
+    void*            p_a;
+    void*            p_b;
+
+    puts("        allocation_test_scope()");
+
+    allocation_scope_begin(&outer);
+    p_a = allocation_alloc(ALLOCATION_GRAPH, 1000);
+    allocation_free(ALLOCATION_GRAPH, p_a, 1000);
+
+    allocation_scope_begin(&inner);
+    p_b = allocation_alloc(ALLOCATION_GRAPH, 200);
+    allocation_free(ALLOCATION_GRAPH, p_b, 200);
+    ASSERT(allocation_scope_allocations(&inner) == 1);
+    ASSERT(allocation_scope_end(&inner) == 200);
+
+    ASSERT(allocation_scope_allocations(&outer) == 2);
+
+    ASSERT(allocation_scope_end(&outer) == 1000);
+}
+
+typedef struct test_thread {
+    size_t bytes;
+    void*  p_memory;
+} test_thread;
+
+static void test_thread_main(void* p_argument)
+{
+    test_thread* p_test = p_argument;
+    void*        p_memory = allocation_alloc(ALLOCATION_GRAPH, 5000);
+
+    allocation_free(ALLOCATION_GRAPH, p_memory, 5000);
+    p_test->p_memory = allocation_alloc(ALLOCATION_GRAPH, p_test->bytes);
+}
+
+/*******************************************************************************
+* Another thread allocates inside the scope of this one without showing in its *
+* peak, and a block it leaves behind is freed here.                            *
+*******************************************************************************/
+static void allocation_test_threads()
+{
+    allocation_scope    scope;
+    allocation_counters before;
+    allocation_counters after;
+    parallel_thread     thread;
+    test_thread         test = { 300, NULL };
+    size_t              base;
+    void*               p_memory;
+
+    puts("        allocation_test_threads()");
+
+    base = allocation_total_bytes();
+    allocation_get_counters(ALLOCATION_GRAPH, &before);
+    allocation_scope_begin(&scope);
+
+    ASSERT(parallel_thread_create(&thread, test_thread_main, &test));
+    parallel_thread_join(thread);
+    ASSERT(test.p_memory != NULL);
+    ASSERT(allocation_total_bytes() == base + 300);
+
+    p_memory = allocation_alloc(ALLOCATION_GRAPH, 200);
+    allocation_free(ALLOCATION_GRAPH, p_memory, 200);
+    allocation_free(ALLOCATION_GRAPH, test.p_memory, 300);
+    ASSERT(allocation_scope_end(&scope) == 200);
+
+    allocation_get_counters(ALLOCATION_GRAPH, &after);
+    ASSERT(after.bytes == before.bytes);
+    ASSERT(after.allocations == before.allocations + 3);
+    ASSERT(after.frees == before.frees + 3);
+    ASSERT(after.peak_bytes >= before.bytes + 5000);
+    ASSERT(allocation_total_bytes() == base);
+}
+
+void allocation_test()
+{
+    puts("    allocation_test()");
+    allocation_test_counters();
+    allocation_test_hooks();
+    allocation_test_usage();
+    allocation_test_scope();
+    allocation_test_threads();
+}
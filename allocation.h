@@ -0,0 +1,125 @@
+#ifndef ALLOCATION_H
+#define ALLOCATION_H
+
+#include <stddef.h>
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * The subsystems whose memory is accounted separately. Every container     *
+    * allocates through this module and names its subsystem.                   *
+    ***************************************************************************/
+#define ALLOCATION_LIST           0
+#define ALLOCATION_QUEUE          1
+#define ALLOCATION_UNORDERED_MAP  2
+#define ALLOCATION_UNORDERED_SET  3
+#define ALLOCATION_HEAP           4
+#define ALLOCATION_GRAPH          5
+#define ALLOCATION_FRONTIER_QUEUE 6
+#define ALLOCATION_CONCURRENT_MAP 7
+#define ALLOCATION_SEARCH_PATH    8
+#define ALLOCATION_SUBSYSTEMS     9
+
+    /***************************************************************************
+    * The allocator the containers use. The size of a block is passed to       *
+    * 'p_free' as well, so the hooks need no bookkeeping of their own. A block *
+    * must be released by the same hooks that allocated it, so the hooks       *
+    * should be changed only while no container is alive.                      *
+    ***************************************************************************/
+    typedef struct allocation_hooks {
+        void* (*p_alloc)(size_t bytes, void* p_user);
+        void  (*p_free) (void* p_memory, size_t bytes, void* p_user);
+        void*   p_user;
+    } allocation_hooks;
+
+    /***************************************************************************
+    * The counters of one subsystem. 'bytes' is the amount currently in use;   *
+    * 'allocations' and 'frees' count calls. Each thread keeps counters of its *
+    * own and the sums are returned, so 'peak_bytes', the sum of the most each *
+    * thread held at once, is exact with one thread and an upper bound of the  *
+    * peak otherwise.                                                          *
+    ***************************************************************************/
+    typedef struct allocation_counters {
+        size_t bytes;
+        size_t peak_bytes;
+        size_t allocations;
+        size_t frees;
+    } allocation_counters;
+
+    /***************************************************************************
+    * Tracks the peak of the bytes the calling thread allocated between        *
+    * 'allocation_scope_begin' and 'allocation_scope_end'. Each thread tracks  *
+    * its own scopes, which may nest; the memory other threads allocate        *
+    * meanwhile is not counted.                                                *
+    ***************************************************************************/
+    typedef struct allocation_scope {
+        size_t base_bytes;
+        size_t outer_peak_bytes;
+        size_t base_allocations;
+    } allocation_scope;
+
+    /***************************************************************************
+    * Allocates 'bytes' bytes on behalf of the subsystem. Returns NULL if the  *
+    * memory ran out.                                                          *
+    ***************************************************************************/
+    void* allocation_alloc(int subsystem, size_t bytes);
+
+    /***************************************************************************
+    * Allocates 'count' zeroed elements of 'size' bytes each.                  *
+    ***************************************************************************/
+    void* allocation_calloc(int subsystem, size_t count, size_t size);
+
+    /***************************************************************************
+    * Releases a block of 'bytes' bytes, which must be the size it was         *
+    * allocated with. Does nothing if 'p_memory' is NULL.                      *
+    ***************************************************************************/
+    void allocation_free(int subsystem, void* p_memory, size_t bytes);
+
+    /***************************************************************************
+    * Installs the hooks, or 'malloc' and 'free' if 'p_hooks' is NULL.         *
+    ***************************************************************************/
+    void allocation_set_hooks(allocation_hooks* p_hooks);
+
+    /***************************************************************************
+    * Copies the counters of the subsystem into 'p_counters'.                  *
+    ***************************************************************************/
+    void allocation_get_counters(int subsystem,
+                                 allocation_counters* p_counters);
+
+    /***************************************************************************
+    * Returns the total bytes in use by all the subsystems.                    *
+    ***************************************************************************/
+    size_t allocation_total_bytes();
+
+    /***************************************************************************
+    * Returns the name of the subsystem.                                       *
+    ***************************************************************************/
+    const char* allocation_subsystem_name(int subsystem);
+
+    /***************************************************************************
+    * Starts tracking the peak memory use of the calling thread.               *
+    ***************************************************************************/
+    void allocation_scope_begin(allocation_scope* p_scope);
+
+    /***************************************************************************
+    * Returns the largest number of bytes the calling thread had in use since  *
+    * the scope began, over what it had in use when it began.                  *
+    ***************************************************************************/
+    size_t allocation_scope_end(allocation_scope* p_scope);
+
+    /***************************************************************************
+    * Returns the number of blocks the calling thread allocated since the      *
+    * scope began.                                                             *
+    ***************************************************************************/
+    size_t allocation_scope_allocations(allocation_scope* p_scope);
+
+    /* Contains the unit tests. */
+    void allocation_test();
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif  /* ALLOCATION_H */
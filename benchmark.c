@@ -0,0 +1,1151 @@
+/*****************************************************************
+* Exposes getrusage under C89.                                   *
+*****************************************************************/
+#define _POSIX_C_SOURCE 200112L
+
+#include "benchmark.h"
+#include "bidirectional_breadth_first_search.h"
+#include "breadth_first_search.h"
+#include "graph_generator.h"
+#include "list.h"
+#include "my_assert.h"
+#include "philox.h"
+#include "timing.h"
+#include "unordered_set.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "psapi.lib")
+#endif
+#else
+#include <sys/resource.h>
+#endif
+
+#define FALSE 0
+#define TRUE 1
+
+#define RMAT_EDGE_FACTOR 8
+#define GEOMETRIC_AVERAGE_DEGREE 8.0
+#define POWER_LAW_ARCS_PER_NODE 4
+
+static const double RMAT_A = 0.57;
+static const double RMAT_B = 0.19;
+static const double RMAT_C = 0.19;
+static const double PI = 3.14159265358979323846;
+
+static const char* FAMILY_NAMES[] = {
+    "grid", "rmat", "geometric", "power_law", "chain"
+};
+
+static const char* ENGINE_NAMES[] = {
+    "bfs", "bidirectional_bfs", "balanced_bfs", "parallel_bfs"
+};
+
+static const char* CSV_HEADER =
+    "family,engine,nodes,arcs,queries,paths_found,p50_us,p99_us,mean_us,"
+    "queries_per_second,nodes_expanded,peak_rss_kb,cycles,instructions,"
+    "llc_misses,branch_misses,dtlb_misses";
+
+static double now_us()
+{
+    return timing_now_ns() / 1e3;
+}
+
+size_t benchmark_peak_rss_kb()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+
+    if (!GetProcessMemoryInfo(GetCurrentProcess(),
+                              &counters,
+                              sizeof(counters)))
+    {
+        return 0;
+    }
+
+    return (size_t)(counters.PeakWorkingSetSize / 1024);
+#else
+    struct rusage usage;
+
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+
+#ifdef __APPLE__
+    return (size_t) usage.ru_maxrss / 1024;
+#else
+    return (size_t) usage.ru_maxrss;
+#endif
+#endif
+}
+
+const char* benchmark_family_name(int family)
+{
+    return family >= 0 && family < BENCHMARK_FAMILIES ?
+           FAMILY_NAMES[family] :
+           "unknown";
+}
+
+const char* benchmark_engine_name(int engine)
+{
+    return engine >= 0 && engine < BENCHMARK_ENGINES ?
+           ENGINE_NAMES[engine] :
+           "unknown";
+}
+
+/*******************************************************************************
+* Generates the family in compact form. Grids are rounded down to a square and *
+* chains are grids one node high.                                              *
+*******************************************************************************/
+static compact_graph* generate(int family, size_t nodes, unsigned long seed)
+{
+    size_t side = 0;
+
+    switch (family)
+    {
+        case BENCHMARK_GRID:
+            while ((side + 1) * (side + 1) <= nodes) ++side;
+
+            return graph_generator_grid(side, side, 1, 1);
+
+        case BENCHMARK_RMAT:
+            return graph_generator_rmat(nodes,
+                                        RMAT_EDGE_FACTOR * nodes,
+                                        RMAT_A,
+                                        RMAT_B,
+                                        RMAT_C,
+                                        seed,
+                                        1);
+
+        case BENCHMARK_GEOMETRIC:
+            return graph_generator_geometric(
+                       nodes,
+                       1.0,
+                       1.0,
+                       0.0,
+                       sqrt(GEOMETRIC_AVERAGE_DEGREE / (PI * nodes)),
+                       seed,
+                       1,
+                       NULL);
+
+        case BENCHMARK_POWER_LAW:
+            return graph_generator_barabasi_albert(nodes,
+                                                   POWER_LAW_ARCS_PER_NODE,
+                                                   seed,
+                                                   1);
+
+        default:
+            return graph_generator_grid(nodes, 1, 1, 1);
+    }
+}
+
+benchmark_graph* benchmark_graph_alloc(int family,
+                                       size_t nodes,
+                                       unsigned long seed)
+{
+    benchmark_graph* p_graph;
+    compact_graph*   p_compact;
+    size_t           i;
+    size_t           arc;
+
+    if (family < 0 || family >= BENCHMARK_FAMILIES || nodes == 0)
+    {
+        return NULL;
+    }
+
+    if (!(p_compact = generate(family, nodes, seed))) return NULL;
+
+    if (!(p_graph = malloc(sizeof(*p_graph))))
+    {
+        compact_graph_free(p_compact);
+        return NULL;
+    }
+
+    p_graph->family = family;
+    p_graph->nodes = p_compact->nodes;
+    p_graph->arcs = 0;
+    p_graph->p_node_array = malloc(sizeof(directed_graph_node*) *
+                                   (p_compact->nodes + 1));
+
+    if (!p_graph->p_node_array)
+    {
+        compact_graph_free(p_compact);
+        free(p_graph);
+        return NULL;
+    }
+
+    for (i = 0; i < p_graph->nodes; ++i)
+    {
+        p_graph->p_node_array[i] = directed_graph_node_alloc((int) i);
+    }
+
+    /* The search engines walk directed graph nodes. Power-law arcs lead
+       from the newer node to the older one and are mirrored. */
+    for (i = 0; i < p_graph->nodes; ++i)
+    {
+        for (arc = p_compact->p_child_offsets[i];
+             arc < p_compact->p_child_offsets[i + 1];
+             ++arc)
+        {
+            directed_graph_node_add_arc(
+                p_graph->p_node_array[i],
+                p_graph->p_node_array[p_compact->p_child_array[arc]]);
+
+            if (family == BENCHMARK_POWER_LAW)
+            {
+                directed_graph_node_add_arc(
+                    p_graph->p_node_array[p_compact->p_child_array[arc]],
+                    p_graph->p_node_array[i]);
+            }
+        }
+    }
+
+    compact_graph_free(p_compact);
+
+    for (i = 0; i < p_graph->nodes; ++i)
+    {
+        p_graph->arcs += unordered_set_size(
+            directed_graph_node_children_set(p_graph->p_node_array[i]));
+    }
+
+    return p_graph;
+}
+
+void benchmark_graph_free(benchmark_graph* p_graph)
+{
+    size_t i;
+
+    if (!p_graph) return;
+
+    for (i = 0; i < p_graph->nodes; ++i)
+    {
+        directed_graph_node_free(p_graph->p_node_array[i]);
+    }
+
+    free(p_graph->p_node_array);
+    free(p_graph);
+}
+
+/*******************************************************************************
+* The node iterators handed to the search engines. They count the number of    *
+* times a node is expanded in the 'expanded' field of their state, which       *
+* lives for the whole query.                                                   *
+*******************************************************************************/
+typedef struct counting_iterator_state {
+    unordered_set_iterator* p_iterator;
+    size_t                  expanded;
+} counting_iterator_state;
+
+static void counting_children_iterator_init(child_node_iterator* p_me,
+                                            void* p_node)
+{
+    counting_iterator_state* p_state = p_me->state;
+
+    p_state->p_iterator = unordered_set_iterator_alloc(
+        directed_graph_node_children_set(p_node));
+    p_state->expanded++;
+}
+
+static int counting_children_iterator_has_next(child_node_iterator* p_me)
+{
+    counting_iterator_state* p_state = p_me->state;
+
+    return unordered_set_iterator_has_next(p_state->p_iterator) > 0;
+}
+
+static void* counting_children_iterator_next(child_node_iterator* p_me)
+{
+    counting_iterator_state* p_state = p_me->state;
+    void*                    p_value;
+
+    unordered_set_iterator_next(p_state->p_iterator, &p_value);
+    return p_value;
+}
+
+static void counting_children_iterator_free(child_node_iterator* p_me)
+{
+    counting_iterator_state* p_state = p_me->state;
+
+    unordered_set_iterator_free(p_state->p_iterator);
+    p_state->p_iterator = NULL;
+}
+
+static void counting_parents_iterator_init(parent_node_iterator* p_me,
+                                           void* p_node)
+{
+    counting_iterator_state* p_state = p_me->state;
+
+    p_state->p_iterator = unordered_set_iterator_alloc(
+        directed_graph_node_parent_set(p_node));
+    p_state->expanded++;
+}
+
+static int counting_parents_iterator_has_next(parent_node_iterator* p_me)
+{
+    counting_iterator_state* p_state = p_me->state;
+
+    return unordered_set_iterator_has_next(p_state->p_iterator) > 0;
+}
+
+static void* counting_parents_iterator_next(parent_node_iterator* p_me)
+{
+    counting_iterator_state* p_state = p_me->state;
+    void*                    p_value;
+
+    unordered_set_iterator_next(p_state->p_iterator, &p_value);
+    return p_value;
+}
+
+static void counting_parents_iterator_free(parent_node_iterator* p_me)
+{
+    counting_iterator_state* p_state = p_me->state;
+
+    unordered_set_iterator_free(p_state->p_iterator);
+    p_state->p_iterator = NULL;
+}
+
+/*******************************************************************************
+* The degrees the balanced search compares its frontiers by.                   *
+*******************************************************************************/
+static size_t out_degree(void* p_node)
+{
+    return unordered_set_size(directed_graph_node_children_set(p_node));
+}
+
+static size_t in_degree(void* p_node)
+{
+    return unordered_set_size(directed_graph_node_parent_set(p_node));
+}
+
+static int compare_doubles(const void* p_a, const void* p_b)
+{
+    double a = *(const double*) p_a;
+    double b = *(const double*) p_b;
+
+    return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+/*******************************************************************************
+* Returns the nearest-rank percentile of a sorted array, the element at the    *
+* rank 'ceil(fraction * count)', or zero if the array is empty.                *
+*******************************************************************************/
+static double percentile(double* p_sorted_array, size_t count, double fraction)
+{
+    double rank;
+
+    if (count == 0) return 0.0;
+
+    rank = ceil(fraction * count);
+
+    if (rank < 1.0)            return p_sorted_array[0];
+    if (rank > (double) count) return p_sorted_array[count - 1];
+
+    return p_sorted_array[(size_t) rank - 1];
+}
+
+void benchmark_summarize(double* p_time_array,
+                         size_t count,
+                         benchmark_result* p_result)
+{
+    double total = 0.0;
+    size_t i;
+
+    for (i = 0; i < count; ++i)
+    {
+        total += p_time_array[i];
+    }
+
+    qsort(p_time_array, count, sizeof(double), compare_doubles);
+
+    p_result->p50_us = percentile(p_time_array, count, 0.50);
+    p_result->p99_us = percentile(p_time_array, count, 0.99);
+    p_result->mean_us = count > 0 ? total / count : 0.0;
+    p_result->queries_per_second = total > 0.0 ? 1e6 * count / total : 0.0;
+}
+
+int benchmark_run_queries(benchmark_graph* p_graph,
+                          int engine,
+                          size_t queries,
+                          unsigned long seed,
+                          perf_counters* p_counters,
+                          benchmark_result* p_result)
+{
+    perf_sample             sample;
+    perf_sample             perf_total;
+    child_node_iterator     child_iterator;
+    parent_node_iterator    parent_iterator;
+    counting_iterator_state child_state;
+    counting_iterator_state parent_state;
+    philox                  random;
+    double*                 p_time_array;
+    directed_graph_node*    p_source;
+    directed_graph_node*    p_target;
+    list*                   p_path;
+    double                  start;
+    size_t                  hops;
+    size_t                  i;
+    int                     event;
+
+    if (!p_graph || !p_result || queries == 0 || p_graph->nodes == 0
+        || engine < 0 || engine >= BENCHMARK_ENGINES)
+    {
+        return FALSE;
+    }
+
+    if (!(p_time_array = malloc(sizeof(double) * queries))) return FALSE;
+
+    child_state.p_iterator = NULL;
+    child_state.expanded = 0;
+    parent_state.p_iterator = NULL;
+    parent_state.expanded = 0;
+
+    child_iterator.state = &child_state;
+    child_iterator.child_node_iterator_init = counting_children_iterator_init;
+    child_iterator.child_node_iterator_has_next =
+        counting_children_iterator_has_next;
+    child_iterator.child_node_iterator_next = counting_children_iterator_next;
+    child_iterator.child_node_iterator_free = counting_children_iterator_free;
+
+    parent_iterator.state = &parent_state;
+    parent_iterator.parent_node_iterator_init = counting_parents_iterator_init;
+    parent_iterator.parent_node_iterator_has_next =
+        counting_parents_iterator_has_next;
+    parent_iterator.parent_node_iterator_next =
+        counting_parents_iterator_next;
+    parent_iterator.parent_node_iterator_free =
+        counting_parents_iterator_free;
+
+    philox_init(&random, seed, 0);
+    memset(p_result, 0, sizeof(*p_result));
+    strcpy(p_result->family, benchmark_family_name(p_graph->family));
+    strcpy(p_result->engine, benchmark_engine_name(engine));
+    p_result->nodes = p_graph->nodes;
+    p_result->arcs = p_graph->arcs;
+    p_result->queries = queries;
+    perf_sample_clear(&perf_total);
+
+    for (i = 0; i < queries; ++i)
+    {
+        p_source = p_graph->p_node_array[philox_below(&random,
+                                                      p_graph->nodes)];
+        p_target = p_graph->p_node_array[philox_below(&random,
+                                                      p_graph->nodes)];
+
+        if (p_counters)
+        {
+            perf_counters_start(p_counters);
+        }
+
+        p_path = NULL;
+        hops = SEARCH_PATH_UNREACHABLE;
+        start = now_us();
+
+        if (engine == BENCHMARK_BFS)
+        {
+            p_path = breadth_first_search(p_source,
+                                          p_target,
+                                          &child_iterator,
+                                          directed_graph_node_hash_function,
+                                          directed_graph_nodes_equal_function);
+        }
+        else if (engine == BENCHMARK_BIDIRECTIONAL_BFS)
+        {
+            p_path = bidirectional_breadth_first_search(
+                p_source,
+                p_target,
+                &child_iterator,
+                &parent_iterator,
+                directed_graph_node_hash_function,
+                directed_graph_nodes_equal_function);
+        }
+        else if (engine == BENCHMARK_BALANCED_BFS)
+        {
+            hops = bidirectional_breadth_first_search_balanced(
+                p_source,
+                p_target,
+                &child_iterator,
+                &parent_iterator,
+                out_degree,
+                in_degree,
+                directed_graph_node_hash_function,
+                directed_graph_nodes_equal_function,
+                NULL,
+                NULL);
+        }
+        else
+        {
+            hops = bidirectional_breadth_first_search_parallel(
+                p_source,
+                p_target,
+                &child_iterator,
+                &parent_iterator,
+                directed_graph_node_hash_function,
+                directed_graph_nodes_equal_function,
+                NULL);
+        }
+
+        p_time_array[i] = now_us() - start;
+
+        if (p_counters)
+        {
+            perf_counters_stop(p_counters, &sample);
+            perf_sample_add(&perf_total, &sample);
+        }
+
+        if (p_path)
+        {
+            p_result->paths_found++;
+            list_free(p_path);
+        }
+        else if (hops != SEARCH_PATH_UNREACHABLE)
+        {
+            p_result->paths_found++;
+        }
+    }
+
+    benchmark_summarize(p_time_array, queries, p_result);
+    p_result->nodes_expanded =
+        (double)(child_state.expanded + parent_state.expanded) / queries;
+    p_result->peak_rss_kb = benchmark_peak_rss_kb();
+
+    for (event = 0; event < PERF_COUNTERS_EVENTS; ++event)
+    {
+        p_result->p_perf_array[event] =
+            perf_counters_has_event(p_counters, event) ?
+            (double) perf_total.p_count_array[event] / queries :
+            BENCHMARK_NOT_COUNTED;
+    }
+
+    free(p_time_array);
+    return TRUE;
+}
+
+/*******************************************************************************
+* Generates a graph of the suite, measuring the build as a result of its own.  *
+*******************************************************************************/
+static benchmark_graph* build_graph(int family,
+                                    size_t nodes,
+                                    unsigned long seed,
+                                    perf_counters* p_counters,
+                                    benchmark_result* p_result)
+{
+    benchmark_graph* p_graph;
+    perf_sample      sample;
+    double           start;
+    int              event;
+
+    if (p_counters)
+    {
+        perf_counters_start(p_counters);
+    }
+
+    start = now_us();
+    p_graph = benchmark_graph_alloc(family, nodes, seed);
+    memset(p_result, 0, sizeof(*p_result));
+    p_result->mean_us = now_us() - start;
+
+    if (p_counters)
+    {
+        perf_counters_stop(p_counters, &sample);
+    }
+
+    for (event = 0; event < PERF_COUNTERS_EVENTS; ++event)
+    {
+        p_result->p_perf_array[event] =
+            perf_counters_has_event(p_counters, event) ?
+            (double) sample.p_count_array[event] :
+            BENCHMARK_NOT_COUNTED;
+    }
+
+    if (!p_graph) return NULL;
+
+    strcpy(p_result->family, benchmark_family_name(family));
+    strcpy(p_result->engine, BENCHMARK_BUILD_PHASE);
+    p_result->nodes = p_graph->nodes;
+    p_result->arcs = p_graph->arcs;
+    p_result->queries = 1;
+    p_result->p50_us = p_result->mean_us;
+    p_result->p99_us = p_result->mean_us;
+    p_result->queries_per_second =
+        p_result->mean_us > 0.0 ? 1e6 / p_result->mean_us : 0.0;
+    p_result->peak_rss_kb = benchmark_peak_rss_kb();
+    return p_graph;
+}
+
+benchmark_result* benchmark_run_suite(benchmark_config* p_config,
+                                      size_t* p_count)
+{
+    benchmark_result* p_result_array;
+    benchmark_graph*  p_graph;
+    perf_counters     counters;
+    perf_counters*    p_counters = NULL;
+    size_t            size;
+    size_t            count = 0;
+    int               family;
+    int               engine;
+
+    if (!p_config || !p_count || !p_config->p_size_array) return NULL;
+
+    p_result_array = malloc(sizeof(benchmark_result)
+                            * p_config->sizes
+                            * BENCHMARK_FAMILIES
+                            * (BENCHMARK_ENGINES + 1));
+
+    if (!p_result_array) return NULL;
+
+    if (p_config->perf_counters && perf_counters_open(&counters) > 0)
+    {
+        p_counters = &counters;
+    }
+
+    for (size = 0; size < p_config->sizes; ++size)
+    {
+        for (family = 0; family < BENCHMARK_FAMILIES; ++family)
+        {
+            p_graph = build_graph(family,
+                                  p_config->p_size_array[size],
+                                  p_config->seed + family,
+                                  p_counters,
+                                  &p_result_array[count]);
+
+            if (!p_graph) continue;
+
+            ++count;
+
+            /* Both engines get the same query pairs. */
+            for (engine = 0; engine < BENCHMARK_ENGINES; ++engine)
+            {
+                if (benchmark_run_queries(p_graph,
+                                          engine,
+                                          p_config->queries,
+                                          p_config->seed,
+                                          p_counters,
+                                          &p_result_array[count]))
+                {
+                    ++count;
+                }
+            }
+
+            benchmark_graph_free(p_graph);
+        }
+    }
+
+    if (p_counters)
+    {
+        perf_counters_close(p_counters);
+    }
+
+    *p_count = count;
+    return p_result_array;
+}
+
+void benchmark_write_csv(FILE* p_file,
+                         benchmark_result* p_result_array,
+                         size_t count)
+{
+    size_t i;
+    int    event;
+
+    fprintf(p_file, "%s\n", CSV_HEADER);
+
+    for (i = 0; i < count; ++i)
+    {
+        fprintf(p_file,
+                "%s,%s,%lu,%lu,%lu,%lu,%.3f,%.3f,%.3f,%.3f,%.3f,%lu",
+                p_result_array[i].family,
+                p_result_array[i].engine,
+                (unsigned long) p_result_array[i].nodes,
+                (unsigned long) p_result_array[i].arcs,
+                (unsigned long) p_result_array[i].queries,
+                (unsigned long) p_result_array[i].paths_found,
+                p_result_array[i].p50_us,
+                p_result_array[i].p99_us,
+                p_result_array[i].mean_us,
+                p_result_array[i].queries_per_second,
+                p_result_array[i].nodes_expanded,
+                (unsigned long) p_result_array[i].peak_rss_kb);
+
+        for (event = 0; event < PERF_COUNTERS_EVENTS; ++event)
+        {
+            if (p_result_array[i].p_perf_array[event] < 0.0)
+            {
+                fputc(',', p_file);
+            }
+            else
+            {
+                fprintf(p_file, ",%.1f", p_result_array[i].p_perf_array[event]);
+            }
+        }
+
+        fputc('\n', p_file);
+    }
+}
+
+void benchmark_write_json(FILE* p_file,
+                          benchmark_result* p_result_array,
+                          size_t count)
+{
+    size_t i;
+    int    event;
+
+    fprintf(p_file, "[\n");
+
+    for (i = 0; i < count; ++i)
+    {
+        fprintf(p_file,
+                "  {\"family\": \"%s\", \"engine\": \"%s\", \"nodes\": %lu, "
+                "\"arcs\": %lu, \"queries\": %lu, \"paths_found\": %lu, "
+                "\"p50_us\": %.3f, \"p99_us\": %.3f, \"mean_us\": %.3f, "
+                "\"queries_per_second\": %.3f, \"nodes_expanded\": %.3f, "
+                "\"peak_rss_kb\": %lu",
+                p_result_array[i].family,
+                p_result_array[i].engine,
+                (unsigned long) p_result_array[i].nodes,
+                (unsigned long) p_result_array[i].arcs,
+                (unsigned long) p_result_array[i].queries,
+                (unsigned long) p_result_array[i].paths_found,
+                p_result_array[i].p50_us,
+                p_result_array[i].p99_us,
+                p_result_array[i].mean_us,
+                p_result_array[i].queries_per_second,
+                p_result_array[i].nodes_expanded,
+                (unsigned long) p_result_array[i].peak_rss_kb);
+
+        for (event = 0; event < PERF_COUNTERS_EVENTS; ++event)
+        {
+            fprintf(p_file, ", \"%s\": ", perf_counters_event_name(event));
+
+            if (p_result_array[i].p_perf_array[event] < 0.0)
+            {
+                fputs("null", p_file);
+            }
+            else
+            {
+                fprintf(p_file, "%.1f", p_result_array[i].p_perf_array[event]);
+            }
+        }
+
+        fprintf(p_file, "}%s\n", i + 1 < count ? "," : "");
+    }
+
+    fprintf(p_file, "]\n");
+}
+
+/*******************************************************************************
+* Parses the trailing event fields of a CSV line, each preceded by a comma. An *
+* empty field is an event that was not counted.                                *
+*******************************************************************************/
+static int read_counts(const char* p_text, double* p_perf_array)
+{
+    char* p_end;
+    int   event;
+
+    for (event = 0; event < PERF_COUNTERS_EVENTS; ++event)
+    {
+        if (*p_text++ != ',') return FALSE;
+
+        if (*p_text == ',' || *p_text == '\n' || *p_text == '\0')
+        {
+            p_perf_array[event] = BENCHMARK_NOT_COUNTED;
+            continue;
+        }
+
+        p_perf_array[event] = strtod(p_text, &p_end);
+
+        if (p_end == p_text) return FALSE;
+
+        p_text = p_end;
+    }
+
+    return TRUE;
+}
+
+benchmark_result* benchmark_read_csv(FILE* p_file, size_t* p_count)
+{
+    benchmark_result* p_result_array = NULL;
+    benchmark_result* p_new_array;
+    benchmark_result  result;
+    char              line[512];
+    size_t            count = 0;
+    size_t            capacity = 0;
+    unsigned long     nodes;
+    unsigned long     arcs;
+    unsigned long     queries;
+    unsigned long     paths_found;
+    unsigned long     peak_rss_kb;
+    int               offset;
+
+    if (!p_file || !p_count) return NULL;
+
+    if (!fgets(line, sizeof(line), p_file)
+        || strncmp(line, CSV_HEADER, strlen(CSV_HEADER)) != 0)
+    {
+        return NULL;
+    }
+
+    while (fgets(line, sizeof(line), p_file))
+    {
+        if (line[0] == '\n' || line[0] == '\0') continue;
+
+        memset(&result, 0, sizeof(result));
+
+        offset = 0;
+
+        if (sscanf(line,
+                   "%31[^,],%31[^,],%lu,%lu,%lu,%lu,%lf,%lf,%lf,%lf,%lf,%lu%n",
+                   result.family,
+                   result.engine,
+                   &nodes,
+                   &arcs,
+                   &queries,
+                   &paths_found,
+                   &result.p50_us,
+                   &result.p99_us,
+                   &result.mean_us,
+                   &result.queries_per_second,
+                   &result.nodes_expanded,
+                   &peak_rss_kb,
+                   &offset) != 12
+            || !read_counts(line + offset, result.p_perf_array))
+        {
+            free(p_result_array);
+            return NULL;
+        }
+
+        result.nodes = nodes;
+        result.arcs = arcs;
+        result.queries = queries;
+        result.paths_found = paths_found;
+        result.peak_rss_kb = peak_rss_kb;
+
+        if (count == capacity)
+        {
+            capacity = capacity ? 2 * capacity : 16;
+            p_new_array = realloc(p_result_array,
+                                  sizeof(benchmark_result) * capacity);
+
+            if (!p_new_array)
+            {
+                free(p_result_array);
+                return NULL;
+            }
+
+            p_result_array = p_new_array;
+        }
+
+        p_result_array[count++] = result;
+    }
+
+    /* An empty but valid file yields a valid, empty array. */
+    if (!p_result_array)
+    {
+        p_result_array = malloc(sizeof(benchmark_result));
+    }
+
+    *p_count = count;
+    return p_result_array;
+}
+
+static double relative_change(double before, double after)
+{
+    return before > 0.0 ? (after - before) / before : 0.0;
+}
+
+size_t benchmark_compare(FILE* p_file,
+                         benchmark_result* p_baseline_array,
+                         size_t baseline_count,
+                         benchmark_result* p_result_array,
+                         size_t result_count,
+                         double tolerance)
+{
+    benchmark_result* p_old;
+    benchmark_result* p_new;
+    size_t            regressions = 0;
+    size_t            i;
+    size_t            j;
+    double            p50_change;
+    double            p99_change;
+    double            qps_change;
+
+    for (i = 0; i < result_count; ++i)
+    {
+        p_new = &p_result_array[i];
+        p_old = NULL;
+
+        for (j = 0; j < baseline_count; ++j)
+        {
+            if (p_baseline_array[j].nodes == p_new->nodes
+                && strcmp(p_baseline_array[j].family, p_new->family) == 0
+                && strcmp(p_baseline_array[j].engine, p_new->engine) == 0)
+            {
+                p_old = &p_baseline_array[j];
+                break;
+            }
+        }
+
+        if (!p_old) continue;
+
+        p50_change = relative_change(p_old->p50_us, p_new->p50_us);
+        p99_change = relative_change(p_old->p99_us, p_new->p99_us);
+        qps_change = relative_change(p_old->queries_per_second,
+                                     p_new->queries_per_second);
+
+        if (p50_change > tolerance
+            || p99_change > tolerance
+            || qps_change < -tolerance)
+        {
+            ++regressions;
+
+            if (p_file)
+            {
+                fprintf(p_file,
+                        "REGRESSION %s/%s/%lu: p50 %.3f -> %.3f us (%+.1f%%), "
+                        "p99 %.3f -> %.3f us (%+.1f%%), "
+                        "qps %.1f -> %.1f (%+.1f%%)\n",
+                        p_new->family,
+                        p_new->engine,
+                        (unsigned long) p_new->nodes,
+                        p_old->p50_us,
+                        p_new->p50_us,
+                        100.0 * p50_change,
+                        p_old->p99_us,
+                        p_new->p99_us,
+                        100.0 * p99_change,
+                        p_old->queries_per_second,
+                        p_new->queries_per_second,
+                        100.0 * qps_change);
+            }
+        }
+    }
+
+    return regressions;
+}
+
+static void benchmark_test_graphs()
+{
+    benchmark_graph* p_graph;
+    benchmark_graph* p_again;
+    int              family;
+
+    puts("        benchmark_test_graphs()");
+
+    ASSERT(benchmark_graph_alloc(BENCHMARK_FAMILIES, 10, 1) == NULL);
+    ASSERT(benchmark_graph_alloc(BENCHMARK_GRID, 0, 1) == NULL);
+
+    for (family = 0; family < BENCHMARK_FAMILIES; ++family)
+    {
+        p_graph = benchmark_graph_alloc(family, 1000, 7);
+        p_again = benchmark_graph_alloc(family, 1000, 7);
+
+        ASSERT(p_graph->nodes > 0 && p_graph->nodes <= 1000);
+        ASSERT(p_graph->arcs > 0);
+        ASSERT(p_graph->nodes == p_again->nodes);
+        ASSERT(p_graph->arcs == p_again->arcs);
+
+        benchmark_graph_free(p_graph);
+        benchmark_graph_free(p_again);
+    }
+
+    p_graph = benchmark_graph_alloc(BENCHMARK_GRID, 1000, 1);
+    ASSERT(p_graph->nodes == 31 * 31);
+    ASSERT(p_graph->arcs == 4 * 31 * 30);
+    benchmark_graph_free(p_graph);
+
+    p_graph = benchmark_graph_alloc(BENCHMARK_CHAIN, 100, 1);
+    ASSERT(p_graph->arcs == 2 * 99);
+    benchmark_graph_free(p_graph);
+}
+
+static void benchmark_test_queries()
+{
+    benchmark_graph* p_graph;
+    benchmark_result result;
+    size_t           paths_found;
+    int              engine;
+
+    puts("        benchmark_test_queries()");
+
+    p_graph = benchmark_graph_alloc(BENCHMARK_CHAIN, 200, 3);
+
+    ASSERT(benchmark_run_queries(p_graph, BENCHMARK_ENGINES, 10, 1, NULL,
+                                 &result)
+           == FALSE);
+
+    for (engine = 0; engine < BENCHMARK_ENGINES; ++engine)
+    {
+        ASSERT(benchmark_run_queries(p_graph, engine, 20, 1, NULL, &result));
+        ASSERT(strcmp(result.family, "chain") == 0);
+        ASSERT(strcmp(result.engine, benchmark_engine_name(engine)) == 0);
+        ASSERT(result.queries == 20);
+        ASSERT(result.paths_found == 20);
+        ASSERT(result.p50_us <= result.p99_us);
+        ASSERT(result.nodes_expanded > 0.0);
+    }
+
+    benchmark_graph_free(p_graph);
+
+    /* All the engines find the same paths on a directed graph. */
+    p_graph = benchmark_graph_alloc(BENCHMARK_RMAT, 500, 3);
+    ASSERT(benchmark_run_queries(p_graph, BENCHMARK_BFS, 50, 2, NULL,
+                                 &result));
+    paths_found = result.paths_found;
+
+    for (engine = 0; engine < BENCHMARK_ENGINES; ++engine)
+    {
+        ASSERT(benchmark_run_queries(p_graph, engine, 50, 2, NULL, &result));
+        ASSERT(result.paths_found == paths_found);
+    }
+
+    benchmark_graph_free(p_graph);
+}
+
+static void benchmark_test_percentile()
+{
+    double array[100];
+    size_t i;
+
+    puts("        benchmark_test_percentile()");
+
+    for (i = 0; i < 100; ++i)
+    {
+        array[i] = (double)(i + 1);
+    }
+
+    ASSERT(percentile(array, 0, 0.5) == 0.0);
+    ASSERT(percentile(array, 1, 0.99) == 1.0);
+    ASSERT(percentile(array, 100, 0.0) == 1.0);
+    ASSERT(percentile(array, 100, 0.5) == 50.0);
+    ASSERT(percentile(array, 100, 0.99) == 99.0);
+    ASSERT(percentile(array, 100, 1.0) == 100.0);
+    ASSERT(percentile(array, 20, 0.5) == 10.0);
+    ASSERT(percentile(array, 20, 0.99) == 20.0);
+}
+
+static void benchmark_test_summarize()
+{
+    benchmark_result result;
+    double           array[100];
+    size_t           i;
+
+    puts("        benchmark_test_summarize()");
+
+    for (i = 0; i < 100; ++i)
+    {
+        array[i] = (double)(100 - i);
+    }
+
+    benchmark_summarize(array, 100, &result);
+
+    ASSERT(array[0] == 1.0);
+    ASSERT(result.p50_us == 50.0);
+    ASSERT(result.p99_us == 99.0);
+    ASSERT(result.mean_us == 50.5);
+    ASSERT(fabs(result.queries_per_second - 1e6 / 50.5) < 1e-6);
+}
+
+static void benchmark_test_suite()
+{
+    benchmark_config  config;
+    benchmark_result* p_result_array;
+    size_t            sizes[] = { 100 };
+    size_t            count;
+
+    puts("        benchmark_test_suite()");
+
+    config.p_size_array = sizes;
+    config.sizes = 1;
+    config.queries = 3;
+    config.seed = 5;
+    config.perf_counters = TRUE;
+
+    p_result_array = benchmark_run_suite(&config, &count);
+
+    ASSERT(count == BENCHMARK_FAMILIES * (BENCHMARK_ENGINES + 1));
+    ASSERT(strcmp(p_result_array[0].engine, BENCHMARK_BUILD_PHASE) == 0);
+    ASSERT(p_result_array[0].queries == 1);
+    ASSERT(strcmp(p_result_array[1].engine, "bfs") == 0);
+    ASSERT(p_result_array[1].queries == 3);
+
+    free(p_result_array);
+}
+
+static void benchmark_test_csv_and_compare()
+{
+    benchmark_result  results[2];
+    benchmark_result* p_read;
+    FILE*             p_file;
+    size_t            count;
+    char              json[1024];
+
+    puts("        benchmark_test_csv_and_compare()");
+
+    memset(results, 0, sizeof(results));
+    strcpy(results[0].family, "grid");
+    strcpy(results[0].engine, "bfs");
+    results[0].nodes = 100;
+    results[0].queries = 10;
+    results[0].p50_us = 10.0;
+    results[0].p99_us = 20.0;
+    results[0].queries_per_second = 1000.0;
+    results[0].p_perf_array[PERF_COUNTERS_LLC_MISSES] = 1234.0;
+    results[0].p_perf_array[PERF_COUNTERS_DTLB_MISSES] = BENCHMARK_NOT_COUNTED;
+    results[1] = results[0];
+    strcpy(results[1].engine, "bidirectional_bfs");
+
+    p_file = tmpfile();
+
+    if (!p_file) return;
+
+    benchmark_write_csv(p_file, results, 2);
+    rewind(p_file);
+    p_read = benchmark_read_csv(p_file, &count);
+    fclose(p_file);
+
+    ASSERT(p_read != NULL);
+    ASSERT(count == 2);
+    ASSERT(strcmp(p_read[1].engine, "bidirectional_bfs") == 0);
+    ASSERT(p_read[0].nodes == 100);
+    ASSERT(p_read[0].p99_us == 20.0);
+    ASSERT(p_read[0].p_perf_array[PERF_COUNTERS_LLC_MISSES] == 1234.0);
+    ASSERT(p_read[0].p_perf_array[PERF_COUNTERS_CYCLES] == 0.0);
+    ASSERT(p_read[1].p_perf_array[PERF_COUNTERS_DTLB_MISSES]
+           == BENCHMARK_NOT_COUNTED);
+
+    p_file = tmpfile();
+
+    if (p_file)
+    {
+        benchmark_write_json(p_file, results, 1);
+        rewind(p_file);
+        memset(json, 0, sizeof(json));
+        fread(json, 1, sizeof(json) - 1, p_file);
+        fclose(p_file);
+
+        ASSERT(strstr(json, "\"llc_misses\": 1234.0") != NULL);
+        ASSERT(strstr(json, "\"dtlb_misses\": null") != NULL);
+    }
+
+    ASSERT(benchmark_compare(NULL, results, 2, p_read, 2, 0.05) == 0);
+
+    p_read[0].p50_us = 12.0;
+    p_read[1].queries_per_second = 990.0;
+
+    ASSERT(benchmark_compare(NULL, results, 2, p_read, 2, 0.05) == 1);
+    ASSERT(benchmark_compare(NULL, results, 2, p_read, 2, 0.25) == 0);
+
+    free(p_read);
+}
+
+void benchmark_test()
+{
+    puts("    benchmark_test()");
+    benchmark_test_graphs();
+    benchmark_test_queries();
+    benchmark_test_percentile();
+    benchmark_test_summarize();
+    benchmark_test_suite();
+    benchmark_test_csv_and_compare();
+}
@@ -0,0 +1,187 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "directed_graph_node.h"
+#include "perf_counters.h"
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * The graph families. Grids, geometric graphs, power-law graphs and chains *
+    * have arcs in both directions; R-MAT graphs are directed.                 *
+    ***************************************************************************/
+#define BENCHMARK_GRID      0
+#define BENCHMARK_RMAT      1
+#define BENCHMARK_GEOMETRIC 2
+#define BENCHMARK_POWER_LAW 3
+#define BENCHMARK_CHAIN     4
+#define BENCHMARK_FAMILIES  5
+
+    /***************************************************************************
+    * The search engines under benchmark. The balanced engine expands the      *
+    * level of the lighter frontier by degree sum and the parallel one runs    *
+    * the backward side on a thread of its own; both return hop counts.        *
+    ***************************************************************************/
+#define BENCHMARK_BFS               0
+#define BENCHMARK_BIDIRECTIONAL_BFS 1
+#define BENCHMARK_BALANCED_BFS      2
+#define BENCHMARK_PARALLEL_BFS      3
+#define BENCHMARK_ENGINES           4
+
+    /***************************************************************************
+    * The engine name of the results measuring the graph build phase.          *
+    ***************************************************************************/
+#define BENCHMARK_BUILD_PHASE "build"
+
+#define BENCHMARK_NAME_LENGTH 32
+
+    /***************************************************************************
+    * Marks a hardware event that was not counted, either because the          *
+    * counters were off or because the event could not be opened.              *
+    ***************************************************************************/
+#define BENCHMARK_NOT_COUNTED (-1.0)
+
+    typedef struct benchmark_graph {
+        int                   family;
+        size_t                nodes;
+        size_t                arcs;
+        directed_graph_node** p_node_array;
+    } benchmark_graph;
+
+    /***************************************************************************
+    * Holds the statistics of one engine over one graph. The times are in      *
+    * microseconds; 'nodes_expanded' is the mean number of nodes whose         *
+    * neighbors were generated per query, in both directions. 'p_perf_array'   *
+    * holds the mean hardware event counts per query, indexed by the           *
+    * PERF_COUNTERS_* events, or BENCHMARK_NOT_COUNTED for the events that     *
+    * were not counted. The build phase results count as a single query.       *
+    ***************************************************************************/
+    typedef struct benchmark_result {
+        char   family[BENCHMARK_NAME_LENGTH];
+        char   engine[BENCHMARK_NAME_LENGTH];
+        size_t nodes;
+        size_t arcs;
+        size_t queries;
+        size_t paths_found;
+        double p50_us;
+        double p99_us;
+        double mean_us;
+        double queries_per_second;
+        double nodes_expanded;
+        size_t peak_rss_kb;
+        double p_perf_array[PERF_COUNTERS_EVENTS];
+    } benchmark_result;
+
+    /***************************************************************************
+    * Configures a suite run. Every family is generated at each of the sizes   *
+    * and every engine answers the same 'queries' random query pairs on it.    *
+    * The build of each graph is reported as a result of its own. If           *
+    * 'perf_counters' is set, every build and query is wrapped with hardware   *
+    * performance counters.                                                    *
+    ***************************************************************************/
+    typedef struct benchmark_config {
+        size_t*       p_size_array;
+        size_t        sizes;
+        size_t        queries;
+        unsigned long seed;
+        int           perf_counters;
+    } benchmark_config;
+
+    /***************************************************************************
+    * Returns the name of a family or an engine.                               *
+    ***************************************************************************/
+    const char* benchmark_family_name(int family);
+    const char* benchmark_engine_name(int engine);
+
+    /***************************************************************************
+    * Generates a graph of the family with about 'nodes' nodes from the seed.  *
+    * Grids are rounded down to a square.                                      *
+    ***************************************************************************/
+    benchmark_graph* benchmark_graph_alloc(int family,
+                                           size_t nodes,
+                                           unsigned long seed);
+
+    /***************************************************************************
+    * Deallocates the graph and its nodes.                                     *
+    ***************************************************************************/
+    void benchmark_graph_free(benchmark_graph* p_graph);
+
+    /***************************************************************************
+    * Runs 'queries' seeded random source/target queries with the engine and   *
+    * fills 'p_result'. If 'p_counters' is not NULL, each query is measured    *
+    * with the opened hardware counters. Returns false if the arguments are    *
+    * invalid.                                                                 *
+    ***************************************************************************/
+    int benchmark_run_queries(benchmark_graph* p_graph,
+                              int engine,
+                              size_t queries,
+                              unsigned long seed,
+                              perf_counters* p_counters,
+                              benchmark_result* p_result);
+
+    /***************************************************************************
+    * Sorts the 'count' times in microseconds, each of one query or operation, *
+    * and stores their percentiles, their mean and the rate they imply in      *
+    * 'p_result'.                                                              *
+    ***************************************************************************/
+    void benchmark_summarize(double* p_time_array,
+                             size_t count,
+                             benchmark_result* p_result);
+
+    /***************************************************************************
+    * Runs all the families, sizes and engines. Returns the array of results   *
+    * and stores its length in 'p_count', or returns NULL on failure.          *
+    ***************************************************************************/
+    benchmark_result* benchmark_run_suite(benchmark_config* p_config,
+                                          size_t* p_count);
+
+    /***************************************************************************
+    * Writes the results as CSV with a header line, or as a JSON array. An     *
+    * event that was not counted is written as an empty CSV field or a JSON    *
+    * null, never as a zero count.                                             *
+    ***************************************************************************/
+    void benchmark_write_csv(FILE* p_file,
+                             benchmark_result* p_result_array,
+                             size_t count);
+
+    void benchmark_write_json(FILE* p_file,
+                              benchmark_result* p_result_array,
+                              size_t count);
+
+    /***************************************************************************
+    * Reads the results written by 'benchmark_write_csv'. Returns NULL if the  *
+    * file cannot be parsed.                                                   *
+    ***************************************************************************/
+    benchmark_result* benchmark_read_csv(FILE* p_file, size_t* p_count);
+
+    /***************************************************************************
+    * Compares the new results to the baseline ones with the same family,      *
+    * size and engine. A result regresses if its p50 or p99 latency grows, or  *
+    * its throughput drops, by more than the relative 'tolerance'. Prints one  *
+    * line per regression to 'p_file' (if not NULL) and returns their number.  *
+    ***************************************************************************/
+    size_t benchmark_compare(FILE* p_file,
+                             benchmark_result* p_baseline_array,
+                             size_t baseline_count,
+                             benchmark_result* p_result_array,
+                             size_t result_count,
+                             double tolerance);
+
+    /***************************************************************************
+    * Returns the peak resident set size of the process in kilobytes, or zero  *
+    * if it is not available.                                                  *
+    ***************************************************************************/
+    size_t benchmark_peak_rss_kb();
+
+    /* Contains the unit tests. */
+    void benchmark_test();
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif  /* BENCHMARK_H */
@@ -0,0 +1,593 @@
+#include "betweenness_centrality.h"
+#include "my_assert.h"
+#include "parallel.h"
+#include "philox.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define UNREACHED ((size_t) -1)
+
+/*******************************************************************************
+* The scratch of one worker, allocated when it takes its first source. The     *
+* distances are UNREACHED and the path counts and dependencies zero between    *
+* sources; 'p_order_array' lists the nodes reached in BFS order and doubles as *
+* the queue. 'p_score_array' holds the worker's share of the scores.           *
+*******************************************************************************/
+typedef struct betweenness_worker {
+    size_t* p_distance_array;
+    double* p_sigma_array;
+    double* p_delta_array;
+    size_t* p_order_array;
+    double* p_score_array;
+} betweenness_worker;
+
+typedef struct betweenness_context {
+    compact_graph*      p_graph;
+    size_t*             p_source_array;
+    size_t              sources;
+    size_t              next_source;
+    size_t              failed;
+    betweenness_worker* p_worker_array;
+} betweenness_context;
+
+static int betweenness_worker_init(betweenness_worker* p_worker, size_t nodes)
+{
+    size_t i;
+
+    p_worker->p_distance_array = malloc(sizeof(size_t) * nodes);
+    p_worker->p_sigma_array    = calloc(nodes, sizeof(double));
+    p_worker->p_delta_array    = calloc(nodes, sizeof(double));
+    p_worker->p_order_array    = malloc(sizeof(size_t) * nodes);
+    p_worker->p_score_array    = calloc(nodes, sizeof(double));
+
+    if (!p_worker->p_distance_array
+        || !p_worker->p_sigma_array
+        || !p_worker->p_delta_array
+        || !p_worker->p_order_array
+        || !p_worker->p_score_array)
+    {
+        return 0;
+    }
+
+    for (i = 0; i < nodes; ++i)
+    {
+        p_worker->p_distance_array[i] = UNREACHED;
+    }
+
+    return 1;
+}
+
+static void betweenness_worker_destroy(betweenness_worker* p_worker)
+{
+    free(p_worker->p_distance_array);
+    free(p_worker->p_sigma_array);
+    free(p_worker->p_delta_array);
+    free(p_worker->p_order_array);
+    free(p_worker->p_score_array);
+}
+
+/*******************************************************************************
+* Adds the dependencies of 'source' on every other node to the worker's        *
+* scores. The parents of a node on its shortest paths are the ones one hop     *
+* closer to the source, found in its parent row, so no predecessor lists are   *
+* built. Only the entries of the reached nodes are reset afterwards.           *
+*******************************************************************************/
+static void accumulate_source(compact_graph* p_graph,
+                              betweenness_worker* p_worker,
+                              size_t source)
+{
+    size_t* p_distance_array = p_worker->p_distance_array;
+    double* p_sigma_array    = p_worker->p_sigma_array;
+    double* p_delta_array    = p_worker->p_delta_array;
+    size_t* p_order_array    = p_worker->p_order_array;
+    size_t  head = 0;
+    size_t  reached = 0;
+    size_t  node;
+    size_t  next;
+    size_t  i;
+    double  coefficient;
+
+    p_distance_array[source] = 0;
+    p_sigma_array[source]    = 1.0;
+    p_order_array[reached++] = source;
+
+    while (head < reached)
+    {
+        node = p_order_array[head++];
+
+        for (i = p_graph->p_child_offsets[node];
+             i < p_graph->p_child_offsets[node + 1];
+             ++i)
+        {
+            next = p_graph->p_child_array[i];
+
+            if (p_distance_array[next] == UNREACHED)
+            {
+                p_distance_array[next] = p_distance_array[node] + 1;
+                p_order_array[reached++] = next;
+            }
+
+            if (p_distance_array[next] == p_distance_array[node] + 1)
+            {
+                p_sigma_array[next] += p_sigma_array[node];
+            }
+        }
+    }
+
+    /* The source is first in the order and depends on nothing. */
+    for (head = reached; head > 1; --head)
+    {
+        node = p_order_array[head - 1];
+        coefficient = (1.0 + p_delta_array[node]) / p_sigma_array[node];
+
+        for (i = p_graph->p_parent_offsets[node];
+             i < p_graph->p_parent_offsets[node + 1];
+             ++i)
+        {
+            next = p_graph->p_parent_array[i];
+
+            if (p_distance_array[next] + 1 == p_distance_array[node])
+            {
+                p_delta_array[next] += p_sigma_array[next] * coefficient;
+            }
+        }
+
+        p_worker->p_score_array[node] += p_delta_array[node];
+    }
+
+    for (i = 0; i < reached; ++i)
+    {
+        node = p_order_array[i];
+        p_distance_array[node] = UNREACHED;
+        p_sigma_array[node]    = 0.0;
+        p_delta_array[node]    = 0.0;
+    }
+}
+
+/*******************************************************************************
+* Runs the workers of the chunk. Each takes sources until none is left.        *
+*******************************************************************************/
+static void betweenness_task(size_t chunk_begin,
+                             size_t chunk_end,
+                             size_t thread_index,
+                             void* p_argument)
+{
+    betweenness_context* p_context = (betweenness_context*) p_argument;
+    betweenness_worker*  p_worker;
+    size_t               worker;
+    size_t               source;
+    int                  ready;
+
+    (void) thread_index;
+
+    for (worker = chunk_begin; worker < chunk_end; ++worker)
+    {
+        p_worker = &p_context->p_worker_array[worker];
+        ready    = 0;
+
+        while ((source = PARALLEL_FETCH_ADD(&p_context->next_source, 1))
+               < p_context->sources)
+        {
+            if (!ready
+                && !(ready = betweenness_worker_init(
+                                 p_worker,
+                                 p_context->p_graph->nodes)))
+            {
+                PARALLEL_STORE(&p_context->failed, 1);
+                return;
+            }
+
+            accumulate_source(p_context->p_graph,
+                              p_worker,
+                              p_context->p_source_array[source]);
+        }
+    }
+}
+
+/*******************************************************************************
+* Returns the sources: all the nodes, or 'pivots' distinct ones drawn by a     *
+* partial Fisher-Yates shuffle.                                                *
+*******************************************************************************/
+static size_t* choose_sources(size_t nodes,
+                              size_t pivots,
+                              unsigned long seed)
+{
+    size_t* p_source_array = malloc(sizeof(size_t) * (nodes + 1));
+    philox  random;
+    size_t  i;
+    size_t  j;
+    size_t  swap;
+
+    if (!p_source_array) return NULL;
+
+    for (i = 0; i < nodes; ++i)
+    {
+        p_source_array[i] = i;
+    }
+
+    if (pivots >= nodes) return p_source_array;
+
+    philox_init(&random, seed, 0);
+
+    for (i = 0; i < pivots; ++i)
+    {
+        j = i + philox_below(&random, nodes - i);
+        swap = p_source_array[i];
+        p_source_array[i] = p_source_array[j];
+        p_source_array[j] = swap;
+    }
+
+    return p_source_array;
+}
+
+betweenness_centrality* betweenness_centrality_alloc(compact_graph* p_graph,
+                                                     size_t pivots,
+                                                     unsigned long seed,
+                                                     size_t threads)
+{
+    betweenness_centrality* p_centrality;
+    betweenness_context     context;
+    size_t                  workers;
+    size_t                  i;
+    size_t                  j;
+    double                  scale;
+
+    if (!p_graph) return NULL;
+
+    if (pivots == 0 || pivots > p_graph->nodes) pivots = p_graph->nodes;
+    if (threads == 0) threads = parallel_hardware_concurrency();
+
+    workers = threads < pivots ? threads : pivots;
+
+    p_centrality = malloc(sizeof(*p_centrality));
+    context.p_source_array = choose_sources(p_graph->nodes, pivots, seed);
+    context.p_worker_array = calloc(workers + 1, sizeof(betweenness_worker));
+
+    if (!p_centrality
+        || !context.p_source_array
+        || !context.p_worker_array
+        || !(p_centrality->p_score_array = calloc(p_graph->nodes + 1,
+                                                  sizeof(double))))
+    {
+        free(p_centrality);
+        free(context.p_source_array);
+        free(context.p_worker_array);
+        return NULL;
+    }
+
+    p_centrality->nodes   = p_graph->nodes;
+    p_centrality->sources = pivots;
+    context.p_graph     = p_graph;
+    context.sources     = pivots;
+    context.next_source = 0;
+    context.failed      = 0;
+
+    parallel_for(0, workers, workers, betweenness_task, &context);
+
+    scale = pivots < p_graph->nodes ? (double) p_graph->nodes / pivots : 1.0;
+
+    for (i = 0; i < workers; ++i)
+    {
+        if (context.p_worker_array[i].p_score_array)
+        {
+            for (j = 0; j < p_graph->nodes; ++j)
+            {
+                p_centrality->p_score_array[j] +=
+                    scale * context.p_worker_array[i].p_score_array[j];
+            }
+        }
+
+        betweenness_worker_destroy(&context.p_worker_array[i]);
+    }
+
+    free(context.p_source_array);
+    free(context.p_worker_array);
+
+    if (context.failed)
+    {
+        betweenness_centrality_free(p_centrality);
+        return NULL;
+    }
+
+    return p_centrality;
+}
+
+betweenness_centrality* betweenness_centrality_alloc_from_nodes(
+    directed_graph_node** p_node_array,
+    size_t nodes,
+    size_t pivots,
+    unsigned long seed,
+    size_t threads)
+{
+    compact_graph*          p_graph = compact_graph_alloc(p_node_array, nodes);
+    betweenness_centrality* p_centrality;
+
+    if (!p_graph) return NULL;
+
+    p_centrality = betweenness_centrality_alloc(p_graph, pivots, seed, threads);
+    compact_graph_free(p_graph);
+    return p_centrality;
+}
+
+void betweenness_centrality_free(betweenness_centrality* p_centrality)
+{
+    if (!p_centrality) return;
+
+    free(p_centrality->p_score_array);
+    free(p_centrality);
+}
+
+static void betweenness_centrality_test_small()
+{
+    directed_graph_node*    p_nodes[4];
+    betweenness_centrality* p_centrality;
+    size_t                  i;
+
+    puts("        betweenness_centrality_test_small()");
+
+    for (i = 0; i < 4; ++i)
+    {
+        p_nodes[i] = directed_graph_node_alloc((int) i);
+    }
+
+    /* The path 0 -> 1 -> 2 -> 3: nodes 1 and 2 each lie on two pairs. */
+    directed_graph_node_add_arc(p_nodes[0], p_nodes[1]);
+    directed_graph_node_add_arc(p_nodes[1], p_nodes[2]);
+    directed_graph_node_add_arc(p_nodes[2], p_nodes[3]);
+
+    p_centrality = betweenness_centrality_alloc_from_nodes(p_nodes,
+                                                           4,
+                                                           0,
+                                                           1,
+                                                           2);
+    ASSERT(p_centrality != NULL);
+    ASSERT(p_centrality->nodes == 4 && p_centrality->sources == 4);
+    ASSERT(p_centrality->p_score_array[0] == 0.0);
+    ASSERT(p_centrality->p_score_array[1] == 2.0);
+    ASSERT(p_centrality->p_score_array[2] == 2.0);
+    ASSERT(p_centrality->p_score_array[3] == 0.0);
+    betweenness_centrality_free(p_centrality);
+
+    /* The diamond 0 -> {1, 2} -> 3: the two paths from 0 to 3 split. */
+    directed_graph_node_remove_arc(p_nodes[1], p_nodes[2]);
+    directed_graph_node_remove_arc(p_nodes[2], p_nodes[3]);
+    directed_graph_node_add_arc(p_nodes[0], p_nodes[2]);
+    directed_graph_node_add_arc(p_nodes[1], p_nodes[3]);
+    directed_graph_node_add_arc(p_nodes[2], p_nodes[3]);
+
+    p_centrality = betweenness_centrality_alloc_from_nodes(p_nodes,
+                                                           4,
+                                                           0,
+                                                           1,
+                                                           1);
+    ASSERT(p_centrality->p_score_array[0] == 0.0);
+    ASSERT(p_centrality->p_score_array[1] == 0.5);
+    ASSERT(p_centrality->p_score_array[2] == 0.5);
+    ASSERT(p_centrality->p_score_array[3] == 0.0);
+    betweenness_centrality_free(p_centrality);
+
+    for (i = 0; i < 4; ++i)
+    {
+        directed_graph_node_free(p_nodes[i]);
+    }
+}
+
+/*******************************************************************************
+* Compares against the definition, summed over all the pairs with the          *
+* distances and path counts of a BFS from every node.                          *
+*******************************************************************************/
+static void betweenness_centrality_test_random()
+{
+    const size_t            nodes = 60;
+    directed_graph_node*    p_nodes[60];
+    compact_graph*          p_graph;
+    betweenness_centrality* p_centrality;
+    size_t*                 p_distance_matrix;
+    double*                 p_sigma_matrix;
+    double*                 p_expected_array;
+    size_t                  threads;
+    size_t                  s;
+    size_t                  t;
+    size_t                  v;
+    size_t                  i;
+    double                  total;
+    double                  sampled_total;
+
+    puts("        betweenness_centrality_test_random()");
+    srand(7);
+
+    for (i = 0; i < nodes; ++i)
+    {
+        p_nodes[i] = directed_graph_node_alloc((int) i);
+    }
+
+    for (i = 0; i < 3 * nodes; ++i)
+    {
+        directed_graph_node_add_arc(p_nodes[rand() % nodes],
+                                    p_nodes[rand() % nodes]);
+    }
+
+    p_graph = compact_graph_alloc(p_nodes, nodes);
+    p_distance_matrix = malloc(sizeof(size_t) * nodes * nodes);
+    p_sigma_matrix    = malloc(sizeof(double) * nodes * nodes);
+    p_expected_array  = calloc(nodes, sizeof(double));
+
+    /* The distances and path counts from 's', one level at a time. */
+    for (s = 0; s < nodes; ++s)
+    {
+        for (t = 0; t < nodes; ++t)
+        {
+            p_distance_matrix[s * nodes + t] = UNREACHED;
+            p_sigma_matrix[s * nodes + t]    = 0.0;
+        }
+
+        p_distance_matrix[s * nodes + s] = 0;
+        p_sigma_matrix[s * nodes + s]    = 1.0;
+
+        for (v = 1; v < nodes; ++v)
+        {
+            for (t = 0; t < nodes; ++t)
+            {
+                if (p_distance_matrix[s * nodes + t] != v - 1) continue;
+
+                for (i = p_graph->p_child_offsets[t];
+                     i < p_graph->p_child_offsets[t + 1];
+                     ++i)
+                {
+                    size_t child = p_graph->p_child_array[i];
+
+                    if (p_distance_matrix[s * nodes + child] == UNREACHED)
+                    {
+                        p_distance_matrix[s * nodes + child] = v;
+                    }
+
+                    if (p_distance_matrix[s * nodes + child] == v)
+                    {
+                        p_sigma_matrix[s * nodes + child] +=
+                            p_sigma_matrix[s * nodes + t];
+                    }
+                }
+            }
+        }
+    }
+
+    for (s = 0; s < nodes; ++s)
+    {
+        for (t = 0; t < nodes; ++t)
+        {
+            if (s == t || p_distance_matrix[s * nodes + t] == UNREACHED)
+            {
+                continue;
+            }
+
+            for (v = 0; v < nodes; ++v)
+            {
+                if (v == s
+                    || v == t
+                    || p_distance_matrix[s * nodes + v] == UNREACHED
+                    || p_distance_matrix[v * nodes + t] == UNREACHED
+                    || p_distance_matrix[s * nodes + v] +
+                       p_distance_matrix[v * nodes + t] !=
+                       p_distance_matrix[s * nodes + t])
+                {
+                    continue;
+                }
+
+                p_expected_array[v] += p_sigma_matrix[s * nodes + v] *
+                                       p_sigma_matrix[v * nodes + t] /
+                                       p_sigma_matrix[s * nodes + t];
+            }
+        }
+    }
+
+    for (threads = 1; threads <= 4; threads *= 2)
+    {
+        p_centrality = betweenness_centrality_alloc(p_graph, 0, 1, threads);
+        ASSERT(p_centrality->sources == nodes);
+
+        for (v = 0; v < nodes; ++v)
+        {
+            ASSERT(fabs(p_centrality->p_score_array[v] - p_expected_array[v])
+                   < 1e-9);
+        }
+
+        betweenness_centrality_free(p_centrality);
+    }
+
+    /* A sample is scaled up, and the same seed draws the same sample. */
+    p_centrality = betweenness_centrality_alloc(p_graph, 20, 5, 3);
+    ASSERT(p_centrality->sources == 20);
+
+    for (v = 0, sampled_total = 0.0; v < nodes; ++v)
+    {
+        ASSERT(p_centrality->p_score_array[v] >= 0.0);
+        sampled_total += p_centrality->p_score_array[v];
+    }
+
+    betweenness_centrality_free(p_centrality);
+    p_centrality = betweenness_centrality_alloc(p_graph, 20, 5, 1);
+
+    for (v = 0, total = 0.0; v < nodes; ++v)
+    {
+        total += p_centrality->p_score_array[v];
+    }
+
+    ASSERT(fabs(total - sampled_total) < 1e-9);
+    betweenness_centrality_free(p_centrality);
+
+    free(p_distance_matrix);
+    free(p_sigma_matrix);
+    free(p_expected_array);
+    compact_graph_free(p_graph);
+
+    for (i = 0; i < nodes; ++i)
+    {
+        directed_graph_node_free(p_nodes[i]);
+    }
+}
+
+/*******************************************************************************
+* On a directed cycle every source sees the same distances, so any sample      *
+* estimates the total of the scores exactly.                                   *
+*******************************************************************************/
+static void betweenness_centrality_test_cycle()
+{
+    directed_graph_node*    p_nodes[10];
+    betweenness_centrality* p_centrality;
+    size_t                  i;
+    double                  total;
+
+    puts("        betweenness_centrality_test_cycle()");
+
+    for (i = 0; i < 10; ++i)
+    {
+        p_nodes[i] = directed_graph_node_alloc((int) i);
+    }
+
+    for (i = 0; i < 10; ++i)
+    {
+        directed_graph_node_add_arc(p_nodes[i], p_nodes[(i + 1) % 10]);
+    }
+
+    /* Each node is inside 0 + 1 + ... + 8 paths. */
+    p_centrality = betweenness_centrality_alloc_from_nodes(p_nodes,
+                                                           10,
+                                                           0,
+                                                           1,
+                                                           0);
+
+    for (i = 0; i < 10; ++i)
+    {
+        ASSERT(p_centrality->p_score_array[i] == 36.0);
+    }
+
+    betweenness_centrality_free(p_centrality);
+    p_centrality = betweenness_centrality_alloc_from_nodes(p_nodes,
+                                                           10,
+                                                           3,
+                                                           11,
+                                                           2);
+    ASSERT(p_centrality->sources == 3);
+
+    for (i = 0, total = 0.0; i < 10; ++i)
+    {
+        total += p_centrality->p_score_array[i];
+    }
+
+    ASSERT(fabs(total - 360.0) < 1e-9);
+    betweenness_centrality_free(p_centrality);
+
+    for (i = 0; i < 10; ++i)
+    {
+        directed_graph_node_free(p_nodes[i]);
+    }
+}
+
+void betweenness_centrality_test()
+{
+    puts("    betweenness_centrality_test()");
+    betweenness_centrality_test_small();
+    betweenness_centrality_test_random();
+    betweenness_centrality_test_cycle();
+}
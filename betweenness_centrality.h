@@ -0,0 +1,68 @@
+#ifndef BETWEENNESS_CENTRALITY_H
+#define BETWEENNESS_CENTRALITY_H
+
+#include "compact_graph.h"
+#include "directed_graph_node.h"
+#include <stddef.h>
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * Maps each node index to its betweenness: the sum, over the ordered       *
+    * pairs of other nodes, of the share of the shortest paths between them    *
+    * that pass through the node. Arcs are directed and unweighted, and the    *
+    * scores are not normalized. 'sources' is the number of nodes the          *
+    * dependencies were accumulated from; if it is below 'nodes', the scores   *
+    * are scaled by 'nodes / sources' to estimate the exact ones.              *
+    ***************************************************************************/
+    typedef struct betweenness_centrality {
+        size_t  nodes;
+        size_t  sources;
+        double* p_score_array;
+    } betweenness_centrality;
+
+    /***************************************************************************
+    * Computes the betweenness by Brandes' algorithm: a BFS from each source   *
+    * counts the shortest paths, and a pass over the reached nodes, deepest    *
+    * first, accumulates the dependencies. The sources are handed out one by   *
+    * one to 'threads' workers, each with its own scratch arrays and scores,   *
+    * which it reuses from source to source; the scores are summed at the end. *
+    * If 'pivots' is zero or not below the node count, every node is a         *
+    * source; otherwise 'pivots' distinct sources are drawn from 'seed'. If    *
+    * 'threads' is zero, the hardware concurrency is used. As the workers      *
+    * take the sources in any order, the scores may differ in the last bits    *
+    * between runs. Returns NULL if the memory ran out.                        *
+    ***************************************************************************/
+    betweenness_centrality* betweenness_centrality_alloc(
+        compact_graph* p_graph,
+        size_t pivots,
+        unsigned long seed,
+        size_t threads);
+
+    /***************************************************************************
+    * Same as 'betweenness_centrality_alloc' over a snapshot of the nodes in   *
+    * 'p_node_array', which is released before returning. The scores follow    *
+    * the order of the array.                                                  *
+    ***************************************************************************/
+    betweenness_centrality* betweenness_centrality_alloc_from_nodes(
+        directed_graph_node** p_node_array,
+        size_t nodes,
+        size_t pivots,
+        unsigned long seed,
+        size_t threads);
+
+    /***************************************************************************
+    * Deallocates the scores.                                                  *
+    ***************************************************************************/
+    void betweenness_centrality_free(betweenness_centrality* p_centrality);
+
+    /* Contains the unit tests. */
+    void betweenness_centrality_test();
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif  /* BETWEENNESS_CENTRALITY_H */
@@ -1,8 +1,13 @@
+#include "allocation.h"
 #include "bidirectional_breadth_first_search.h"
+#include "breadth_first_search.h"
+#include "concurrent_map.h"
 #include "directed_graph_node.h"
 #include "list.h"
 #include "my_assert.h"
+#include "parallel.h"
 #include "queue.h"
+#include "search_path.h"
 #include "utils.h"
 #include <limits.h>
 
@@ -11,13 +16,36 @@
 
 typedef child_node_iterator neighbor_node_iterator;
 
-list* bidirectional_breadth_first_search(void* source_node,
-                                         void* target_node,
-                                         child_node_iterator* child_iterator,
-                                         parent_node_iterator* parent_iterator,
-                                         size_t (*hash_function)(void*),
-                                         int (*equals_function)(void*, void*))
+/*******************************************************************************
+* Adds 'N' to the counter 'FIELD' of 'p_stats' if the statistics are wanted.   *
+*******************************************************************************/
+#define COUNT(FIELD, N)               \
+    do                                \
+    {                                 \
+        if (p_stats)                  \
+        {                             \
+            p_stats->FIELD += (N);    \
+        }                             \
+    }                                 \
+    while (0)
+
+/*******************************************************************************
+* Runs the search and returns the hop count of the path found, or              *
+* SEARCH_PATH_UNREACHABLE. The path goes to '*pp_list' if it is not NULL, or   *
+* else to 'p_path' if that is not NULL.                                        *
+*******************************************************************************/
+static size_t search(void* source_node,
+                     void* target_node,
+                     child_node_iterator* child_iterator,
+                     parent_node_iterator* parent_iterator,
+                     size_t (*hash_function)(void*),
+                     int (*equals_function)(void*, void*),
+                     search_stats* p_stats,
+                     list** pp_list,
+                     search_path* p_path)
 {
+    timing_ticks start_ns = p_stats ? timing_now_ns() : 0;
+    allocation_scope scope;
     queue* queue_a;
     queue* queue_b;
     unordered_map* parents_a;
@@ -26,13 +54,20 @@ list* bidirectional_breadth_first_search(void* source_node,
     unordered_map* distance_b;
     size_t dist_a;
     size_t dist_b;
+    size_t level_a = (size_t) -1;
+    size_t level_b = (size_t) -1;
     size_t best_cost;
     void* touch_node;
     void* current_node;
     void* child_node;
     void* parent_node;
-    list* path;
-    
+    size_t forward_hops;
+    size_t backward_hops;
+    size_t hops = SEARCH_PATH_UNREACHABLE;
+
+    if (pp_list) *pp_list = NULL;
+    if (p_path)  p_path->nodes = 0;
+
     if (!source_node
         || !target_node
         || !child_iterator
@@ -40,9 +75,10 @@ list* bidirectional_breadth_first_search(void* source_node,
         || !hash_function
         || !equals_function)
     {
-        return NULL;
+        return SEARCH_PATH_UNREACHABLE;
     }
 
+    if (p_stats) allocation_scope_begin(&scope);
     queue_a = queue_alloc();
     queue_b = queue_alloc();
 
@@ -72,6 +108,7 @@ list* bidirectional_breadth_first_search(void* source_node,
     unordered_map_put(parents_b, target_node, NULL);
     unordered_map_put(distance_a, source_node, 0);
     unordered_map_put(distance_b, target_node, 0);
+    COUNT(hash_probes, 4);
 
     best_cost = UINT_MAX;
     touch_node = NULL;
@@ -80,22 +117,30 @@ list* bidirectional_breadth_first_search(void* source_node,
     {
         dist_a = (size_t) unordered_map_get(distance_a, queue_front(queue_a));
         dist_b = (size_t) unordered_map_get(distance_b, queue_front(queue_b));
+        COUNT(hash_probes, 2);
+
+        /* The front of a queue changes its distance exactly when a new level
+           starts, and then the queue holds that whole level. */
+        if (p_stats && dist_a != level_a)
+        {
+            level_a = dist_a;
+            search_stats_add_level(p_stats, 1, queue_size(queue_a));
+        }
+
+        if (p_stats && dist_b != level_b)
+        {
+            level_b = dist_b;
+            search_stats_add_level(p_stats, 0, queue_size(queue_b));
+        }
 
         if (touch_node && best_cost < dist_a + dist_b)
         {
-            path = trace_back_path_bidirectional(touch_node,
-                                                 parents_a,
-                                                 parents_b);
-            queue_free(queue_a);
-            queue_free(queue_b);
-            unordered_map_free(&parents_a);
-            unordered_map_free(&parents_b);
-            unordered_map_free(&distance_a);
-            unordered_map_free(&distance_b);
-            return path;
+            break;
         }
          
         current_node = queue_pop_front(queue_a);
+        COUNT(nodes_popped, 1);
+        COUNT(hash_probes, 1);
 
         if (unordered_map_contains_key(parents_b, current_node)
             &&
@@ -112,6 +157,8 @@ list* bidirectional_breadth_first_search(void* source_node,
         {
             child_node = child_iterator->
                          child_node_iterator_next(child_iterator);
+            COUNT(arcs_scanned, 1);
+            COUNT(hash_probes, 1);
 
             if (!unordered_map_contains_key(parents_a, child_node))
             {
@@ -124,12 +171,15 @@ list* bidirectional_breadth_first_search(void* source_node,
                                                     current_node)) + 1));
 
                 queue_push_back(queue_a, child_node);
+                COUNT(hash_probes, 3);
             }
         }
 
         child_iterator->child_node_iterator_free(child_iterator);
 
         current_node = queue_pop_front(queue_b);
+        COUNT(nodes_popped, 1);
+        COUNT(hash_probes, 1);
 
         if (unordered_map_contains_key(parents_a, current_node)
             &&
@@ -147,6 +197,8 @@ list* bidirectional_breadth_first_search(void* source_node,
         {
             parent_node = parent_iterator->
                           parent_node_iterator_next(parent_iterator);
+            COUNT(arcs_scanned, 1);
+            COUNT(hash_probes, 1);
 
             if (!unordered_map_contains_key(parents_b, parent_node))
             {
@@ -159,20 +211,960 @@ list* bidirectional_breadth_first_search(void* source_node,
                                                 current_node)) + 1));
 
                 queue_push_back(queue_b, parent_node);
+                COUNT(hash_probes, 3);
             }
         }
 
         parent_iterator->parent_node_iterator_free(parent_iterator);
     }
 
+    /* The sides may also have met just before one of them ran out of
+       nodes, as when the source is the target. */
+    if (touch_node)
+    {
+        forward_hops  = (size_t) unordered_map_get(distance_a, touch_node);
+        backward_hops = (size_t) unordered_map_get(distance_b, touch_node);
+        hops          = forward_hops + backward_hops;
+        COUNT(hash_probes, 2);
+
+        if (pp_list)
+        {
+            *pp_list = trace_back_path_bidirectional(touch_node,
+                                                     parents_a,
+                                                     parents_b);
+        }
+        else if (p_path)
+        {
+            search_path_trace_bidirectional(p_path,
+                                            touch_node,
+                                            forward_hops,
+                                            backward_hops,
+                                            parents_a,
+                                            parents_b);
+        }
+    }
+
     queue_free(queue_a);
     queue_free(queue_b);
     unordered_map_free(&parents_a);
     unordered_map_free(&parents_b);
     unordered_map_free(&distance_a);
     unordered_map_free(&distance_b);
+    COUNT(allocations, allocation_scope_allocations(&scope));
+    COUNT(peak_memory_bytes, allocation_scope_end(&scope));
+    COUNT(duration_ns, timing_now_ns() - start_ns);
+
+    return hops;
+}
+
+list* bidirectional_breadth_first_search_with_stats(
+    void* source_node,
+    void* target_node,
+    child_node_iterator* child_iterator,
+    parent_node_iterator* parent_iterator,
+    size_t (*hash_function)(void*),
+    int (*equals_function)(void*, void*),
+    search_stats* p_stats)
+{
+    list* path;
+
+    search(source_node,
+           target_node,
+           child_iterator,
+           parent_iterator,
+           hash_function,
+           equals_function,
+           p_stats,
+           &path,
+           NULL);
+
+    return path;
+}
+
+size_t bidirectional_breadth_first_search_path(
+    void* source_node,
+    void* target_node,
+    child_node_iterator* child_iterator,
+    parent_node_iterator* parent_iterator,
+    size_t (*hash_function)(void*),
+    int (*equals_function)(void*, void*),
+    search_path* p_path)
+{
+    return search(source_node,
+                  target_node,
+                  child_iterator,
+                  parent_iterator,
+                  hash_function,
+                  equals_function,
+                  NULL,
+                  NULL,
+                  p_path);
+}
+
+
+list* bidirectional_breadth_first_search(void* source_node,
+                                         void* target_node,
+                                         child_node_iterator* child_iterator,
+                                         parent_node_iterator* parent_iterator,
+                                         size_t (*hash_function)(void*),
+                                         int (*equals_function)(void*, void*))
+{
+    return bidirectional_breadth_first_search_with_stats(source_node,
+                                                         target_node,
+                                                         child_iterator,
+                                                         parent_iterator,
+                                                         hash_function,
+                                                         equals_function,
+                                                         NULL);
+}
+
+/*******************************************************************************
+* Expands the whole level 'level' of the forward search held in 'q'. Returns   *
+* the hop count of the path through the first node generated that the          *
+* backward search has reached, or SEARCH_PATH_UNREACHABLE.                     *
+*******************************************************************************/
+static size_t expand_forward_level(queue* q,
+                                   unordered_map* distance_map,
+                                   unordered_map* opposite_distance_map,
+                                   size_t level,
+                                   child_node_iterator* child_iterator)
+{
+    size_t remaining = queue_size(q);
+    void* current_node;
+    void* child_node;
+
+    while (remaining-- > 0)
+    {
+        current_node = queue_pop_front(q);
+        child_iterator->child_node_iterator_init(child_iterator, current_node);
+
+        while (child_iterator->child_node_iterator_has_next(child_iterator))
+        {
+            child_node = child_iterator->
+                         child_node_iterator_next(child_iterator);
+
+            if (unordered_map_contains_key(distance_map, child_node))
+            {
+                continue;
+            }
+
+            if (unordered_map_contains_key(opposite_distance_map, child_node))
+            {
+                child_iterator->child_node_iterator_free(child_iterator);
+                return level + 1 + (size_t) unordered_map_get(
+                                                opposite_distance_map,
+                                                child_node);
+            }
+
+            unordered_map_put(distance_map, child_node, (void*) (level + 1));
+            queue_push_back(q, child_node);
+        }
+
+        child_iterator->child_node_iterator_free(child_iterator);
+    }
+
+    return SEARCH_PATH_UNREACHABLE;
+}
+
+/*******************************************************************************
+* Same as 'expand_forward_level' for the backward search.                      *
+*******************************************************************************/
+static size_t expand_backward_level(queue* q,
+                                    unordered_map* distance_map,
+                                    unordered_map* opposite_distance_map,
+                                    size_t level,
+                                    parent_node_iterator* parent_iterator)
+{
+    size_t remaining = queue_size(q);
+    void* current_node;
+    void* parent_node;
+
+    while (remaining-- > 0)
+    {
+        current_node = queue_pop_front(q);
+        parent_iterator->parent_node_iterator_init(parent_iterator,
+                                                   current_node);
+
+        while (parent_iterator->
+               parent_node_iterator_has_next(parent_iterator))
+        {
+            parent_node = parent_iterator->
+                          parent_node_iterator_next(parent_iterator);
+
+            if (unordered_map_contains_key(distance_map, parent_node))
+            {
+                continue;
+            }
+
+            if (unordered_map_contains_key(opposite_distance_map, parent_node))
+            {
+                parent_iterator->parent_node_iterator_free(parent_iterator);
+                return level + 1 + (size_t) unordered_map_get(
+                                                opposite_distance_map,
+                                                parent_node);
+            }
+
+            unordered_map_put(distance_map, parent_node, (void*) (level + 1));
+            queue_push_back(q, parent_node);
+        }
+
+        parent_iterator->parent_node_iterator_free(parent_iterator);
+    }
+
+    return SEARCH_PATH_UNREACHABLE;
+}
+
+size_t bidirectional_breadth_first_search_distance(
+    void* source_node,
+    void* target_node,
+    child_node_iterator* child_iterator,
+    parent_node_iterator* parent_iterator,
+    size_t (*hash_function)(void*),
+    int (*equals_function)(void*, void*))
+{
+    return bidirectional_breadth_first_search_bounded_distance(
+               source_node,
+               target_node,
+               child_iterator,
+               parent_iterator,
+               hash_function,
+               equals_function,
+               SEARCH_PATH_UNREACHABLE);
+}
+
+size_t bidirectional_breadth_first_search_bounded_distance(
+    void* source_node,
+    void* target_node,
+    child_node_iterator* child_iterator,
+    parent_node_iterator* parent_iterator,
+    size_t (*hash_function)(void*),
+    int (*equals_function)(void*, void*),
+    size_t max_hops)
+{
+    queue* queue_a;
+    queue* queue_b;
+    unordered_map* distance_a;
+    unordered_map* distance_b;
+    size_t level_a = 0;
+    size_t level_b = 0;
+    size_t hops = SEARCH_PATH_UNREACHABLE;
+
+    if (!source_node
+        || !target_node
+        || !child_iterator
+        || !parent_iterator
+        || !hash_function
+        || !equals_function)
+    {
+        return SEARCH_PATH_UNREACHABLE;
+    }
+
+    if (equals_function(source_node, target_node)) return 0;
+
+    queue_a = queue_alloc();
+    queue_b = queue_alloc();
+    distance_a = unordered_map_alloc(10,
+                                     1.0f,
+                                     hash_function,
+                                     equals_function);
+    distance_b = unordered_map_alloc(10,
+                                     1.0f,
+                                     hash_function,
+                                     equals_function);
+
+    queue_push_back(queue_a, source_node);
+    queue_push_back(queue_b, target_node);
+    unordered_map_put(distance_a, source_node, (void*) 0);
+    unordered_map_put(distance_b, target_node, (void*) 0);
+
+    /* Every node within 'level_a' hops from the source or 'level_b' hops to
+       the target is known and no two of them met, so no path is shorter
+       than 'level_a + level_b + 1' and the first meeting gives a shortest
+       one. */
+    while (hops == SEARCH_PATH_UNREACHABLE
+           && queue_size(queue_a) > 0
+           && queue_size(queue_b) > 0
+           && level_a + level_b < max_hops)
+    {
+        if (queue_size(queue_a) <= queue_size(queue_b))
+        {
+            hops = expand_forward_level(queue_a,
+                                        distance_a,
+                                        distance_b,
+                                        level_a++,
+                                        child_iterator);
+        }
+        else
+        {
+            hops = expand_backward_level(queue_b,
+                                         distance_b,
+                                         distance_a,
+                                         level_b++,
+                                         parent_iterator);
+        }
+    }
+
+    queue_free(queue_a);
+    queue_free(queue_b);
+    unordered_map_free(&distance_a);
+    unordered_map_free(&distance_b);
+    return hops;
+}
+
+/*******************************************************************************
+* A side of the balanced search. 'p_parent_map' maps each node reached to the  *
+* node it was reached from, 'level' is the distance of the nodes in 'q' and    *
+* 'weight' is the sum of their degrees, or their count if there is no degree   *
+* function.                                                                    *
+*******************************************************************************/
+typedef struct search_side {
+    queue*         q;
+    unordered_map* p_parent_map;
+    size_t         level;
+    size_t         weight;
+    size_t       (*p_degree_function)(void*);
+} search_side;
+
+static void search_side_init(search_side* p_side,
+                             void* p_root,
+                             queue* q,
+                             unordered_map* p_parent_map,
+                             size_t (*p_degree_function)(void*))
+{
+    p_side->q = q;
+    p_side->p_parent_map = p_parent_map;
+    p_side->level = 0;
+    p_side->weight = p_degree_function ? p_degree_function(p_root) : 1;
+    p_side->p_degree_function = p_degree_function;
+
+    queue_push_back(p_side->q, p_root);
+    unordered_map_put(p_side->p_parent_map, p_root, NULL);
+}
+
+/*******************************************************************************
+* Reaches 'p_node' from 'p_current' unless it was reached already, adding its  *
+* degree to '*p_weight'. Returns true if the opposite side has reached it.     *
+*******************************************************************************/
+static int search_side_visit(search_side* p_side,
+                             search_side* p_opposite,
+                             void* p_current,
+                             void* p_node,
+                             size_t* p_weight,
+                             search_stats* p_stats)
+{
+    COUNT(arcs_scanned, 1);
+    COUNT(hash_probes, 1);
+
+    if (unordered_map_contains_key(p_side->p_parent_map, p_node))
+    {
+        return 0;
+    }
+
+    unordered_map_put(p_side->p_parent_map, p_node, p_current);
+    queue_push_back(p_side->q, p_node);
+    *p_weight += p_side->p_degree_function ?
+                 p_side->p_degree_function(p_node) : 1;
+
+    COUNT(hash_probes, 2);
+    return unordered_map_contains_key(p_opposite->p_parent_map, p_node);
+}
+
+/*******************************************************************************
+* Expands the whole frontier of 'p_side', forward along 'child_iterator' or    *
+* backward along 'parent_iterator', whichever is not NULL. Returns the first   *
+* node reached that the opposite side has reached too, or NULL.                *
+*******************************************************************************/
+static void* search_side_expand(search_side* p_side,
+                                search_side* p_opposite,
+                                child_node_iterator* child_iterator,
+                                parent_node_iterator* parent_iterator,
+                                search_stats* p_stats)
+{
+    size_t remaining = queue_size(p_side->q);
+    size_t weight = 0;
+    void* touch_node = NULL;
+    void* current_node;
+    void* next_node;
+
+    if (p_stats)
+    {
+        search_stats_add_level(p_stats, child_iterator != NULL, remaining);
+    }
+
+    while (remaining-- > 0 && !touch_node)
+    {
+        current_node = queue_pop_front(p_side->q);
+        COUNT(nodes_popped, 1);
+
+        if (child_iterator)
+        {
+            child_iterator->child_node_iterator_init(child_iterator,
+                                                     current_node);
+
+            while (!touch_node
+                   && child_iterator->
+                      child_node_iterator_has_next(child_iterator))
+            {
+                next_node = child_iterator->
+                            child_node_iterator_next(child_iterator);
+
+                if (search_side_visit(p_side,
+                                      p_opposite,
+                                      current_node,
+                                      next_node,
+                                      &weight,
+                                      p_stats))
+                {
+                    touch_node = next_node;
+                }
+            }
+
+            child_iterator->child_node_iterator_free(child_iterator);
+        }
+        else
+        {
+            parent_iterator->parent_node_iterator_init(parent_iterator,
+                                                       current_node);
+
+            while (!touch_node
+                   && parent_iterator->
+                      parent_node_iterator_has_next(parent_iterator))
+            {
+                next_node = parent_iterator->
+                            parent_node_iterator_next(parent_iterator);
+
+                if (search_side_visit(p_side,
+                                      p_opposite,
+                                      current_node,
+                                      next_node,
+                                      &weight,
+                                      p_stats))
+                {
+                    touch_node = next_node;
+                }
+            }
+
+            parent_iterator->parent_node_iterator_free(parent_iterator);
+        }
+    }
+
+    p_side->level++;
+    p_side->weight = weight;
+    return touch_node;
+}
+
+/*******************************************************************************
+* Runs the balanced search with the queues and maps of 'p_context' if it is    *
+* not NULL, emptying them afterwards, or else with ones allocated for it.      *
+*******************************************************************************/
+static size_t balanced_search(void* source_node,
+                              void* target_node,
+                              child_node_iterator* child_iterator,
+                              parent_node_iterator* parent_iterator,
+                              size_t (*out_degree_function)(void*),
+                              size_t (*in_degree_function)(void*),
+                              size_t (*hash_function)(void*),
+                              int (*equals_function)(void*, void*),
+                              search_context* p_context,
+                              search_stats* p_stats,
+                              search_path* p_path)
+{
+    timing_ticks start_ns = p_stats ? timing_now_ns() : 0;
+    allocation_scope scope;
+    search_context local_context;
+    search_side forward;
+    search_side backward;
+    void* touch_node = NULL;
+    size_t hops = SEARCH_PATH_UNREACHABLE;
+
+    if (p_path) p_path->nodes = 0;
+
+    if (!source_node
+        || !target_node
+        || !child_iterator
+        || !parent_iterator
+        || !hash_function
+        || !equals_function)
+    {
+        return SEARCH_PATH_UNREACHABLE;
+    }
+
+    if (p_stats) allocation_scope_begin(&scope);
+
+    if (!p_context)
+    {
+        if (!search_context_init(&local_context,
+                                 hash_function,
+                                 equals_function))
+        {
+            if (p_stats) allocation_scope_end(&scope);
+            return SEARCH_PATH_UNREACHABLE;
+        }
+
+        p_context = &local_context;
+    }
+
+    search_side_init(&forward,
+                     source_node,
+                     p_context->p_forward_queue,
+                     p_context->p_forward_map,
+                     out_degree_function);
+    search_side_init(&backward,
+                     target_node,
+                     p_context->p_backward_queue,
+                     p_context->p_backward_map,
+                     in_degree_function);
+    COUNT(hash_probes, 2);
+
+    if (equals_function(source_node, target_node))
+    {
+        touch_node = source_node;
+    }
+
+    /* As in the distance search, the first meeting is on a shortest path,
+       whichever side grows each time. The side to grow is the one whose
+       next level scans fewer arcs. */
+    while (!touch_node
+           && queue_size(forward.q) > 0
+           && queue_size(backward.q) > 0)
+    {
+        if (forward.weight <= backward.weight)
+        {
+            touch_node = search_side_expand(&forward,
+                                            &backward,
+                                            child_iterator,
+                                            NULL,
+                                            p_stats);
+        }
+        else
+        {
+            touch_node = search_side_expand(&backward,
+                                            &forward,
+                                            NULL,
+                                            parent_iterator,
+                                            p_stats);
+        }
+    }
+
+    if (touch_node)
+    {
+        hops = forward.level + backward.level;
+
+        if (p_path)
+        {
+            search_path_trace_bidirectional(p_path,
+                                            touch_node,
+                                            forward.level,
+                                            backward.level,
+                                            forward.p_parent_map,
+                                            backward.p_parent_map);
+        }
+    }
+
+    if (p_context == &local_context)
+    {
+        search_context_destroy(&local_context);
+    }
+    else
+    {
+        search_context_clear(p_context);
+    }
+
+    COUNT(allocations, allocation_scope_allocations(&scope));
+    COUNT(peak_memory_bytes, allocation_scope_end(&scope));
+    COUNT(duration_ns, timing_now_ns() - start_ns);
+    return hops;
+}
+
+size_t bidirectional_breadth_first_search_balanced(
+    void* source_node,
+    void* target_node,
+    child_node_iterator* child_iterator,
+    parent_node_iterator* parent_iterator,
+    size_t (*out_degree_function)(void*),
+    size_t (*in_degree_function)(void*),
+    size_t (*hash_function)(void*),
+    int (*equals_function)(void*, void*),
+    search_stats* p_stats,
+    search_path* p_path)
+{
+    return balanced_search(source_node,
+                           target_node,
+                           child_iterator,
+                           parent_iterator,
+                           out_degree_function,
+                           in_degree_function,
+                           hash_function,
+                           equals_function,
+                           NULL,
+                           p_stats,
+                           p_path);
+}
+
+size_t bidirectional_breadth_first_search_balanced_in_context(
+    void* source_node,
+    void* target_node,
+    child_node_iterator* child_iterator,
+    parent_node_iterator* parent_iterator,
+    size_t (*out_degree_function)(void*),
+    size_t (*in_degree_function)(void*),
+    search_context* p_context,
+    search_stats* p_stats,
+    search_path* p_path)
+{
+    return balanced_search(source_node,
+                           target_node,
+                           child_iterator,
+                           parent_iterator,
+                           out_degree_function,
+                           in_degree_function,
+                           p_context->hash_function,
+                           p_context->equals_function,
+                           p_context,
+                           p_stats,
+                           p_path);
+}
+
+struct parallel_search;
+
+/*******************************************************************************
+* A side of the parallel search, run by its own thread. 'p_distance_map' maps  *
+* each node reached to its hop count plus one, so that no value is NULL, and   *
+* is the only part the opposite thread reads. 'radius' is published once every *
+* node within that many hops has been reached and checked against the          *
+* opposite side. 'best_cost' and 'p_best_node' are the cheapest meeting this   *
+* side found; the parent map is kept only if a path is wanted.                 *
+*******************************************************************************/
+typedef struct parallel_search_side {
+    concurrent_map*         p_distance_map;
+    unordered_map*          p_parent_map;
+    queue*                  q;
+    child_node_iterator*    child_iterator;
+    parent_node_iterator*   parent_iterator;
+    size_t                  radius;
+    size_t                  best_cost;
+    void*                   p_best_node;
+    struct parallel_search_side* p_opposite;
+    struct parallel_search*      p_search;
+} parallel_search_side;
+
+/*******************************************************************************
+* The state shared by the two threads: the cheapest meeting cost either found, *
+* whether the search is over, and whether the memory ran out.                  *
+*******************************************************************************/
+typedef struct parallel_search {
+    parallel_search_side forward;
+    parallel_search_side backward;
+    size_t               best_cost;
+    size_t               done;
+    size_t               failed;
+} parallel_search;
+
+static int parallel_search_side_init(parallel_search_side* p_side,
+                                     parallel_search* p_search,
+                                     void* p_root,
+                                     int want_parents,
+                                     size_t (*hash_function)(void*),
+                                     int (*equals_function)(void*, void*))
+{
+    p_side->p_distance_map = concurrent_map_alloc(1024,
+                                                  0.5f,
+                                                  hash_function,
+                                                  equals_function);
+    p_side->p_parent_map = want_parents ?
+                           unordered_map_alloc(10,
+                                               1.0f,
+                                               hash_function,
+                                               equals_function) : NULL;
+    p_side->q           = queue_alloc();
+    p_side->radius      = 0;
+    p_side->best_cost   = SEARCH_PATH_UNREACHABLE;
+    p_side->p_best_node = NULL;
+    p_side->p_search    = p_search;
+
+    if (!p_side->p_distance_map
+        || (want_parents && !p_side->p_parent_map)
+        || !p_side->q
+        || concurrent_map_put_if_absent(p_side->p_distance_map,
+                                        p_root,
+                                        (void*) 1,
+                                        NULL) != CONCURRENT_MAP_INSERTED)
+    {
+        return 0;
+    }
+
+    queue_push_back(p_side->q, p_root);
+
+    if (p_side->p_parent_map)
+    {
+        unordered_map_put(p_side->p_parent_map, p_root, NULL);
+    }
+
+    return 1;
+}
+
+static void parallel_search_side_destroy(parallel_search_side* p_side)
+{
+    concurrent_map_free(p_side->p_distance_map);
+    unordered_map_free(&p_side->p_parent_map);
+    queue_free(p_side->q);
+}
+
+/*******************************************************************************
+* Reaches 'p_node' at 'distance' hops from 'p_current' unless it was reached   *
+* already, and if the opposite side has reached it too, lowers the best cost.  *
+* The insertion is a full barrier before the lookup, so of two threads         *
+* reaching the same node at once at least one sees the other.                  *
+*******************************************************************************/
+static void parallel_search_visit(parallel_search_side* p_side,
+                                  void* p_current,
+                                  void* p_node,
+                                  size_t distance)
+{
+    parallel_search* p_search = p_side->p_search;
+    void*            p_value;
+    size_t           cost;
+    size_t           best_cost;
+
+    switch (concurrent_map_put_if_absent(p_side->p_distance_map,
+                                         p_node,
+                                         (void*) (distance + 1),
+                                         NULL))
+    {
+        case CONCURRENT_MAP_PRESENT:
+            return;
+
+        case CONCURRENT_MAP_FAILED:
+            PARALLEL_STORE(&p_search->failed, 1);
+            PARALLEL_STORE(&p_search->done, 1);
+            return;
+    }
+
+    if (p_side->p_parent_map)
+    {
+        unordered_map_put(p_side->p_parent_map, p_node, p_current);
+    }
+
+    queue_push_back(p_side->q, p_node);
+    p_value = concurrent_map_get(p_side->p_opposite->p_distance_map, p_node);
+
+    if (!p_value) return;
+
+    cost = distance + (size_t) p_value - 1;
+
+    if (cost >= p_side->best_cost) return;
+
+    p_side->best_cost   = cost;
+    p_side->p_best_node = p_node;
+    best_cost = PARALLEL_LOAD(&p_search->best_cost);
+
+    while (cost < best_cost
+           && !PARALLEL_CAS(&p_search->best_cost, best_cost, cost))
+    {
+        best_cost = PARALLEL_LOAD(&p_search->best_cost);
+    }
+}
+
+/*******************************************************************************
+* Expands the side level by level, in step with the opposite side, until the   *
+* search is over. A path no longer than the sum of the two radii has a node    *
+* within both, which both threads have checked, so a best cost at most one     *
+* above that sum is final. A side that runs out of nodes has checked every     *
+* node it can reach, the opposite root included, so the best cost is final     *
+* then as well.                                                                *
+*******************************************************************************/
+static void parallel_search_side_run(void* p_argument)
+{
+    parallel_search_side* p_side   = (parallel_search_side*) p_argument;
+    parallel_search*      p_search = p_side->p_search;
+    child_node_iterator*  child_iterator  = p_side->child_iterator;
+    parent_node_iterator* parent_iterator = p_side->parent_iterator;
+    size_t                level = 0;
+    size_t                remaining;
+    void*                 current_node;
+
+    while (queue_size(p_side->q) > 0 && !PARALLEL_LOAD(&p_search->done))
+    {
+        remaining = queue_size(p_side->q);
+
+        while (remaining-- > 0 && !PARALLEL_LOAD(&p_search->done))
+        {
+            current_node = queue_pop_front(p_side->q);
+
+            if (child_iterator)
+            {
+                child_iterator->child_node_iterator_init(child_iterator,
+                                                         current_node);
+
+                while (child_iterator->
+                       child_node_iterator_has_next(child_iterator))
+                {
+                    parallel_search_visit(
+                        p_side,
+                        current_node,
+                        child_iterator->
+                        child_node_iterator_next(child_iterator),
+                        level + 1);
+                }
+
+                child_iterator->child_node_iterator_free(child_iterator);
+            }
+            else
+            {
+                parent_iterator->parent_node_iterator_init(parent_iterator,
+                                                           current_node);
+
+                while (parent_iterator->
+                       parent_node_iterator_has_next(parent_iterator))
+                {
+                    parallel_search_visit(
+                        p_side,
+                        current_node,
+                        parent_iterator->
+                        parent_node_iterator_next(parent_iterator),
+                        level + 1);
+                }
+
+                parent_iterator->parent_node_iterator_free(parent_iterator);
+            }
+        }
+
+        if (PARALLEL_LOAD(&p_search->done)) return;
+
+        PARALLEL_STORE(&p_side->radius, ++level);
+
+        /* Running ahead would only grow this side past where the other
+           one would meet it, and it starves the other side when the two
+           share a core. */
+        while (PARALLEL_LOAD(&p_side->p_opposite->radius) < level
+               && !PARALLEL_LOAD(&p_search->done))
+        {
+            parallel_yield();
+        }
+
+        if (PARALLEL_LOAD(&p_search->best_cost) <=
+            level + PARALLEL_LOAD(&p_side->p_opposite->radius) + 1)
+        {
+            break;
+        }
+    }
 
-    return NULL;
+    PARALLEL_STORE(&p_search->done, 1);
+}
+
+size_t bidirectional_breadth_first_search_parallel(
+    void* source_node,
+    void* target_node,
+    child_node_iterator* child_iterator,
+    parent_node_iterator* parent_iterator,
+    size_t (*hash_function)(void*),
+    int (*equals_function)(void*, void*),
+    search_path* p_path)
+{
+    parallel_search       search;
+    parallel_search_side* p_side;
+    parallel_thread       thread;
+    size_t                hops = SEARCH_PATH_UNREACHABLE;
+    int                   ready;
+
+    if (p_path) p_path->nodes = 0;
+
+    if (!source_node
+        || !target_node
+        || !child_iterator
+        || !parent_iterator
+        || !hash_function
+        || !equals_function)
+    {
+        return SEARCH_PATH_UNREACHABLE;
+    }
+
+    if (equals_function(source_node, target_node))
+    {
+        if (p_path && search_path_resize(p_path, 1))
+        {
+            p_path->p_node_array[0] = source_node;
+        }
+
+        return 0;
+    }
+
+    search.best_cost = SEARCH_PATH_UNREACHABLE;
+    search.done      = 0;
+    search.failed    = 0;
+    search.forward.child_iterator   = child_iterator;
+    search.forward.parent_iterator  = NULL;
+    search.forward.p_opposite       = &search.backward;
+    search.backward.child_iterator  = NULL;
+    search.backward.parent_iterator = parent_iterator;
+    search.backward.p_opposite      = &search.forward;
+
+    ready = parallel_search_side_init(&search.forward,
+                                      &search,
+                                      source_node,
+                                      p_path != NULL,
+                                      hash_function,
+                                      equals_function);
+    ready = parallel_search_side_init(&search.backward,
+                                      &search,
+                                      target_node,
+                                      p_path != NULL,
+                                      hash_function,
+                                      equals_function) && ready;
+
+    /* The calling thread runs the forward side. */
+    if (ready && parallel_thread_create(&thread,
+                                        parallel_search_side_run,
+                                        &search.backward))
+    {
+        parallel_search_side_run(&search.forward);
+        parallel_thread_join(thread);
+        ready = !search.failed;
+    }
+    else
+    {
+        ready = 0;
+    }
+
+    if (ready)
+    {
+        p_side = search.forward.best_cost <= search.backward.best_cost ?
+                 &search.forward : &search.backward;
+        hops = p_side->best_cost;
+
+        if (p_path && p_side->p_best_node)
+        {
+            search_path_trace_bidirectional(
+                p_path,
+                p_side->p_best_node,
+                (size_t) concurrent_map_get(search.forward.p_distance_map,
+                                            p_side->p_best_node) - 1,
+                (size_t) concurrent_map_get(search.backward.p_distance_map,
+                                            p_side->p_best_node) - 1,
+                search.forward.p_parent_map,
+                search.backward.p_parent_map);
+        }
+    }
+
+    parallel_search_side_destroy(&search.forward);
+    parallel_search_side_destroy(&search.backward);
+
+    /* Without a second thread or enough memory, search on this one. */
+    if (!ready)
+    {
+        hops = bidirectional_breadth_first_search_balanced(source_node,
+                                                           target_node,
+                                                           child_iterator,
+                                                           parent_iterator,
+                                                           NULL,
+                                                           NULL,
+                                                           hash_function,
+                                                           equals_function,
+                                                           NULL,
+                                                           p_path);
+    }
+
+    return hops;
 }
 
 /* Initaliaize the child node generator. */
@@ -228,6 +1220,252 @@ static void directed_graph_parents_iterator_free(parent_node_iterator* pni)
 }
 
 
+static size_t directed_graph_out_degree(void* node)
+{
+    return unordered_set_size(directed_graph_node_children_set(node));
+}
+
+static size_t directed_graph_in_degree(void* node)
+{
+    return unordered_set_size(directed_graph_node_parent_set(node));
+}
+
+/*******************************************************************************
+* Searches from 's' to 't' with the shortest path s -> m1 -> m2 -> t, while a  *
+* child 'h' of 's' has 99 children. The balanced search only has to grow the   *
+* thin backward side.                                                          *
+*******************************************************************************/
+static void bidirectional_breadth_first_search_test_balanced(
+    child_node_iterator* p_children_iterator,
+    parent_node_iterator* p_parents_iterator)
+{
+    directed_graph_node* p_node_array[104];
+    search_stats         stats;
+    search_path          result;
+    search_context       context;
+    size_t               i;
+
+    puts("        bidirectional_breadth_first_search_test_balanced()");
+
+    for (i = 0; i < 104; ++i)
+    {
+        p_node_array[i] = directed_graph_node_alloc((int) i);
+    }
+
+    /* 0 = s, 1 = h, 2 = m1, 3 = m2, 4 = t and the rest are below h. */
+    directed_graph_node_add_arc(p_node_array[0], p_node_array[1]);
+    directed_graph_node_add_arc(p_node_array[0], p_node_array[2]);
+    directed_graph_node_add_arc(p_node_array[2], p_node_array[3]);
+    directed_graph_node_add_arc(p_node_array[3], p_node_array[4]);
+
+    for (i = 5; i < 104; ++i)
+    {
+        directed_graph_node_add_arc(p_node_array[1], p_node_array[i]);
+    }
+
+    search_stats_init(&stats);
+    search_path_init(&result);
+    ASSERT(bidirectional_breadth_first_search_balanced(
+               p_node_array[0],
+               p_node_array[4],
+               p_children_iterator,
+               p_parents_iterator,
+               directed_graph_out_degree,
+               directed_graph_in_degree,
+               directed_graph_node_hash_function,
+               directed_graph_nodes_equal_function,
+               &stats,
+               &result) == 3);
+    ASSERT(result.nodes == 4);
+    ASSERT(result.p_node_array[0] == p_node_array[0]);
+    ASSERT(result.p_node_array[1] == p_node_array[2]);
+    ASSERT(result.p_node_array[2] == p_node_array[3]);
+    ASSERT(result.p_node_array[3] == p_node_array[4]);
+
+    /* t, m2 and m1 are expanded backward until m1 reaches s. */
+    ASSERT(stats.arcs_scanned == 3);
+    ASSERT(stats.forward_levels == 0 && stats.backward_levels == 3);
+
+    /* Comparing frontier sizes, s goes first as it has one node. */
+    search_stats_reset(&stats);
+    ASSERT(bidirectional_breadth_first_search_balanced(
+               p_node_array[0],
+               p_node_array[4],
+               p_children_iterator,
+               p_parents_iterator,
+               NULL,
+               NULL,
+               directed_graph_node_hash_function,
+               directed_graph_nodes_equal_function,
+               &stats,
+               NULL) == 3);
+    ASSERT(stats.forward_levels == 1 && stats.arcs_scanned == 4);
+
+    ASSERT(bidirectional_breadth_first_search_balanced(
+               p_node_array[4],
+               p_node_array[0],
+               p_children_iterator,
+               p_parents_iterator,
+               directed_graph_out_degree,
+               directed_graph_in_degree,
+               directed_graph_node_hash_function,
+               directed_graph_nodes_equal_function,
+               NULL,
+               &result) == SEARCH_PATH_UNREACHABLE);
+    ASSERT(result.nodes == 0);
+    ASSERT(bidirectional_breadth_first_search_balanced(
+               p_node_array[1],
+               p_node_array[1],
+               p_children_iterator,
+               p_parents_iterator,
+               directed_graph_out_degree,
+               directed_graph_in_degree,
+               directed_graph_node_hash_function,
+               directed_graph_nodes_equal_function,
+               NULL,
+               &result) == 0);
+    ASSERT(result.nodes == 1 && result.p_node_array[0] == p_node_array[1]);
+
+    /* A context serves one search after another and is left empty. */
+    ASSERT(search_context_init(&context,
+                               directed_graph_node_hash_function,
+                               directed_graph_nodes_equal_function));
+
+    for (i = 0; i < 2; ++i)
+    {
+        ASSERT(bidirectional_breadth_first_search_balanced_in_context(
+                   p_node_array[0],
+                   p_node_array[4],
+                   p_children_iterator,
+                   p_parents_iterator,
+                   directed_graph_out_degree,
+                   directed_graph_in_degree,
+                   &context,
+                   NULL,
+                   &result) == 3);
+        ASSERT(result.nodes == 4 && result.p_node_array[1] == p_node_array[2]);
+        ASSERT(unordered_map_size(context.p_forward_map) == 0);
+        ASSERT(unordered_map_size(context.p_backward_map) == 0);
+        ASSERT(queue_size(context.p_backward_queue) == 0);
+
+        ASSERT(breadth_first_search_in_context(p_node_array[0],
+                                               p_node_array[4],
+                                               p_children_iterator,
+                                               &context,
+                                               NULL,
+                                               &result) == 3);
+        ASSERT(result.nodes == 4 && result.p_node_array[2] == p_node_array[3]);
+        ASSERT(unordered_map_size(context.p_forward_map) == 0);
+        ASSERT(queue_size(context.p_forward_queue) == 0);
+    }
+
+    ASSERT(breadth_first_search_in_context(p_node_array[4],
+                                           p_node_array[0],
+                                           p_children_iterator,
+                                           &context,
+                                           NULL,
+                                           &result) == SEARCH_PATH_UNREACHABLE);
+    search_context_destroy(&context);
+
+    search_path_destroy(&result);
+    search_stats_destroy(&stats);
+
+    for (i = 0; i < 104; ++i)
+    {
+        directed_graph_node_free(p_node_array[i]);
+    }
+}
+
+/*******************************************************************************
+* Compares the parallel search against BFS from node 0 of a ring with chords   *
+* to every node, and to an extra node that nothing reaches.                    *
+*******************************************************************************/
+static void bidirectional_breadth_first_search_test_parallel(
+    child_node_iterator* p_children_iterator,
+    parent_node_iterator* p_parents_iterator)
+{
+    directed_graph_node* p_node_array[201];
+    search_path          result;
+    size_t               hops;
+    size_t               i;
+    size_t               j;
+
+    puts("        bidirectional_breadth_first_search_test_parallel()");
+
+    for (i = 0; i < 201; ++i)
+    {
+        p_node_array[i] = directed_graph_node_alloc((int) i);
+    }
+
+    for (i = 0; i < 200; ++i)
+    {
+        directed_graph_node_add_arc(p_node_array[i],
+                                    p_node_array[(i + 1) % 200]);
+        directed_graph_node_add_arc(p_node_array[i],
+                                    p_node_array[(i * 7 + 3) % 200]);
+    }
+
+    search_path_init(&result);
+
+    for (i = 0; i < 201; ++i)
+    {
+        hops = bidirectional_breadth_first_search_parallel(
+                   p_node_array[0],
+                   p_node_array[i],
+                   p_children_iterator,
+                   p_parents_iterator,
+                   directed_graph_node_hash_function,
+                   directed_graph_nodes_equal_function,
+                   &result);
+
+        ASSERT(hops == breadth_first_search_distance(
+                           p_node_array[0],
+                           p_node_array[i],
+                           p_children_iterator,
+                           directed_graph_node_hash_function,
+                           directed_graph_nodes_equal_function));
+
+        if (hops == SEARCH_PATH_UNREACHABLE)
+        {
+            ASSERT(i == 200 && result.nodes == 0);
+            continue;
+        }
+
+        ASSERT(result.nodes == hops + 1);
+        ASSERT(result.p_node_array[0] == p_node_array[0]);
+        ASSERT(result.p_node_array[hops] == p_node_array[i]);
+
+        for (j = 0; j < hops; ++j)
+        {
+            ASSERT(unordered_set_contains(
+                       directed_graph_node_children_set(
+                           result.p_node_array[j]),
+                       result.p_node_array[j + 1]));
+        }
+    }
+
+    ASSERT(bidirectional_breadth_first_search_parallel(
+               p_node_array[5],
+               p_node_array[4],
+               p_children_iterator,
+               p_parents_iterator,
+               directed_graph_node_hash_function,
+               directed_graph_nodes_equal_function,
+               NULL) == breadth_first_search_distance(
+                            p_node_array[5],
+                            p_node_array[4],
+                            p_children_iterator,
+                            directed_graph_node_hash_function,
+                            directed_graph_nodes_equal_function));
+
+    search_path_destroy(&result);
+
+    for (i = 0; i < 201; ++i)
+    {
+        directed_graph_node_free(p_node_array[i]);
+    }
+}
+
 void bidirectional_breadth_first_search_test()
 {
     directed_graph_node* a = directed_graph_node_alloc(1);
@@ -238,6 +1476,8 @@ void bidirectional_breadth_first_search_test()
 
     child_node_iterator children_iterator;
     parent_node_iterator parents_iterator;
+    search_stats stats;
+    search_path result;
 
     /* Fill the child node generator interface: */
     children_iterator.child_node_iterator_init =
@@ -287,7 +1527,167 @@ void bidirectional_breadth_first_search_test()
     ASSERT(b == list_get(path, 1));
     ASSERT(e == list_get(path, 2));
 
+    list_free(path);
+    search_stats_init(&stats);
+    path = breadth_first_search_with_stats(a,
+                                           e,
+                                           &children_iterator,
+                                           directed_graph_node_hash_function,
+                                           directed_graph_nodes_equal_function,
+                                           &stats);
+
+    ASSERT(list_size(path) == 3);
+    ASSERT(stats.nodes_popped >= 4 && stats.nodes_popped <= 5);
+    ASSERT(stats.arcs_scanned >= 3);
+    ASSERT(stats.hash_probes > stats.arcs_scanned);
+    ASSERT(stats.forward_levels == 3);
+    ASSERT(stats.p_forward_frontier_array[0] == 1);
+    ASSERT(stats.p_forward_frontier_array[1] == 2);
+    ASSERT(stats.p_forward_frontier_array[2] == 2);
+    ASSERT(stats.backward_levels == 0);
+    ASSERT(stats.allocations > 0);
+    ASSERT(stats.peak_memory_bytes > 0);
 
+    list_free(path);
+    search_stats_reset(&stats);
+    path = bidirectional_breadth_first_search_with_stats(
+        a,
+        e,
+        &children_iterator,
+        &parents_iterator,
+        directed_graph_node_hash_function,
+        directed_graph_nodes_equal_function,
+        &stats);
+
+    ASSERT(list_size(path) == 3);
+    ASSERT(stats.nodes_popped > 0);
+    ASSERT(stats.arcs_scanned > 0);
+    ASSERT(stats.allocations >= 12);
+    ASSERT(stats.forward_levels > 0 && stats.backward_levels > 0);
+    ASSERT(stats.p_forward_frontier_array[0] == 1);
+    ASSERT(stats.p_backward_frontier_array[0] == 1);
+    ASSERT(stats.peak_memory_bytes > 0);
+    search_stats_destroy(&stats);
+
+    search_path_init(&result);
+    ASSERT(breadth_first_search_path(a,
+                                     e,
+                                     &children_iterator,
+                                     directed_graph_node_hash_function,
+                                     directed_graph_nodes_equal_function,
+                                     &result) == 2);
+    ASSERT(result.nodes == 3);
+    ASSERT(result.p_node_array[0] == a && result.p_node_array[2] == e);
+    ASSERT(breadth_first_search_path(a,
+                                     d,
+                                     &children_iterator,
+                                     directed_graph_node_hash_function,
+                                     directed_graph_nodes_equal_function,
+                                     NULL) == 2);
+    ASSERT(breadth_first_search_path(e,
+                                     a,
+                                     &children_iterator,
+                                     directed_graph_node_hash_function,
+                                     directed_graph_nodes_equal_function,
+                                     &result) == SEARCH_PATH_UNREACHABLE);
+    ASSERT(result.nodes == 0);
+    ASSERT(bidirectional_breadth_first_search_path(
+               a,
+               e,
+               &children_iterator,
+               &parents_iterator,
+               directed_graph_node_hash_function,
+               directed_graph_nodes_equal_function,
+               &result) == 2);
+    ASSERT(result.nodes == 3);
+    ASSERT(result.p_node_array[0] == a);
+    ASSERT(result.p_node_array[1] == b || result.p_node_array[1] == c);
+    ASSERT(result.p_node_array[2] == e);
+    ASSERT(bidirectional_breadth_first_search_path(
+               a,
+               a,
+               &children_iterator,
+               &parents_iterator,
+               directed_graph_node_hash_function,
+               directed_graph_nodes_equal_function,
+               NULL) == 0);
+    search_path_destroy(&result);
+
+    ASSERT(breadth_first_search_distance(
+               a,
+               e,
+               &children_iterator,
+               directed_graph_node_hash_function,
+               directed_graph_nodes_equal_function) == 2);
+    ASSERT(breadth_first_search_distance(
+               e,
+               a,
+               &children_iterator,
+               directed_graph_node_hash_function,
+               directed_graph_nodes_equal_function) == SEARCH_PATH_UNREACHABLE);
+    ASSERT(breadth_first_search_bounded_distance(
+               a,
+               e,
+               &children_iterator,
+               directed_graph_node_hash_function,
+               directed_graph_nodes_equal_function,
+               1) == SEARCH_PATH_UNREACHABLE);
+    ASSERT(breadth_first_search_bounded_distance(
+               a,
+               e,
+               &children_iterator,
+               directed_graph_node_hash_function,
+               directed_graph_nodes_equal_function,
+               2) == 2);
+    ASSERT(breadth_first_search_bounded_distance(
+               a,
+               a,
+               &children_iterator,
+               directed_graph_node_hash_function,
+               directed_graph_nodes_equal_function,
+               0) == 0);
+    ASSERT(bidirectional_breadth_first_search_distance(
+               a,
+               e,
+               &children_iterator,
+               &parents_iterator,
+               directed_graph_node_hash_function,
+               directed_graph_nodes_equal_function) == 2);
+    ASSERT(bidirectional_breadth_first_search_distance(
+               a,
+               d,
+               &children_iterator,
+               &parents_iterator,
+               directed_graph_node_hash_function,
+               directed_graph_nodes_equal_function) == 2);
+    ASSERT(bidirectional_breadth_first_search_distance(
+               e,
+               a,
+               &children_iterator,
+               &parents_iterator,
+               directed_graph_node_hash_function,
+               directed_graph_nodes_equal_function) == SEARCH_PATH_UNREACHABLE);
+    ASSERT(bidirectional_breadth_first_search_bounded_distance(
+               a,
+               e,
+               &children_iterator,
+               &parents_iterator,
+               directed_graph_node_hash_function,
+               directed_graph_nodes_equal_function,
+               1) == SEARCH_PATH_UNREACHABLE);
+    ASSERT(bidirectional_breadth_first_search_bounded_distance(
+               a,
+               e,
+               &children_iterator,
+               &parents_iterator,
+               directed_graph_node_hash_function,
+               directed_graph_nodes_equal_function,
+               2) == 2);
+
+    bidirectional_breadth_first_search_test_balanced(&children_iterator,
+                                                     &parents_iterator);
+    bidirectional_breadth_first_search_test_parallel(&children_iterator,
+                                                     &parents_iterator);
 
     /****** Release memory: *******/
     directed_graph_node_free(a);
@@ -1,6 +1,8 @@
 #ifndef BIDIRECTIONAL_BREADTH_FIRST_SEARCH_H
 #define BIDIRECTIONAL_BREADTH_FIRST_SEARCH_H
 #include "list.h"
+#include "search_path.h"
+#include "timing.h"
 #include "utils.h"
 
 list* bidirectional_breadth_first_search(void* source_node,
@@ -10,6 +12,122 @@ list* bidirectional_breadth_first_search(void* source_node,
                                          size_t (*hash_function)(void*),
                                          int (*equals_function)(void*, void*));
 
+/*******************************************************************************
+* Same as 'bidirectional_breadth_first_search' but, if 'p_stats' is not NULL,  *
+* adds the search's counters to it. The frontier sizes of the forward and the  *
+* backward search are recorded as forward and backward levels.                 *
+*******************************************************************************/
+list* bidirectional_breadth_first_search_with_stats(
+    void* source_node,
+    void* target_node,
+    child_node_iterator* child_iterator,
+    parent_node_iterator* parent_iterator,
+    size_t (*hash_function)(void*),
+    int (*equals_function)(void*, void*),
+    search_stats* p_stats);
+
+/*******************************************************************************
+* Same as 'bidirectional_breadth_first_search' but returns the hop count of    *
+* the path found, or SEARCH_PATH_UNREACHABLE, read from the distances of the   *
+* two sides at the meeting node. The path is stored to 'p_path' unless it is   *
+* NULL; if the memory runs out while storing it, the path is left empty.       *
+*******************************************************************************/
+size_t bidirectional_breadth_first_search_path(
+    void* source_node,
+    void* target_node,
+    child_node_iterator* child_iterator,
+    parent_node_iterator* parent_iterator,
+    size_t (*hash_function)(void*),
+    int (*equals_function)(void*, void*),
+    search_path* p_path);
+
+/*******************************************************************************
+* Returns the hop count of a shortest path, or SEARCH_PATH_UNREACHABLE. Only   *
+* the hop count of each node is stored, one map per side. The searches expand  *
+* whole levels, always the one of the smaller frontier, and stop at the first  *
+* node generated that the other side has reached.                              *
+*******************************************************************************/
+size_t bidirectional_breadth_first_search_distance(
+    void* source_node,
+    void* target_node,
+    child_node_iterator* child_iterator,
+    parent_node_iterator* parent_iterator,
+    size_t (*hash_function)(void*),
+    int (*equals_function)(void*, void*));
+
+/*******************************************************************************
+* Same as 'bidirectional_breadth_first_search_distance' but stops once the two *
+* sides together cover 'max_hops' levels, reporting a target farther away as   *
+* SEARCH_PATH_UNREACHABLE. Each side then explores about half the limit.       *
+*******************************************************************************/
+size_t bidirectional_breadth_first_search_bounded_distance(
+    void* source_node,
+    void* target_node,
+    child_node_iterator* child_iterator,
+    parent_node_iterator* parent_iterator,
+    size_t (*hash_function)(void*),
+    int (*equals_function)(void*, void*),
+    size_t max_hops);
+
+/*******************************************************************************
+* Returns the hop count of a shortest path, or SEARCH_PATH_UNREACHABLE, and    *
+* stores the path to 'p_path' unless it is NULL. Unlike the node by node       *
+* alternation of 'bidirectional_breadth_first_search', the sides expand whole  *
+* levels, always the one with the lighter frontier, so a side that reaches a   *
+* hub waits while the other catches up. A frontier weighs the sum of the out-  *
+* degrees ('out_degree_function') or in-degrees ('in_degree_function') of its  *
+* nodes, summed as they are reached; if a degree function is NULL, the sizes   *
+* of the frontiers are compared instead. 'p_stats' may be NULL.                *
+*******************************************************************************/
+size_t bidirectional_breadth_first_search_balanced(
+    void* source_node,
+    void* target_node,
+    child_node_iterator* child_iterator,
+    parent_node_iterator* parent_iterator,
+    size_t (*out_degree_function)(void*),
+    size_t (*in_degree_function)(void*),
+    size_t (*hash_function)(void*),
+    int (*equals_function)(void*, void*),
+    search_stats* p_stats,
+    search_path* p_path);
+
+/*******************************************************************************
+* Same as 'bidirectional_breadth_first_search_balanced' but searches with the  *
+* queues and parent maps of 'p_context', hashing and comparing with its        *
+* functions, and leaves them empty, so that a thread running many searches     *
+* allocates them once.                                                         *
+*******************************************************************************/
+size_t bidirectional_breadth_first_search_balanced_in_context(
+    void* source_node,
+    void* target_node,
+    child_node_iterator* child_iterator,
+    parent_node_iterator* parent_iterator,
+    size_t (*out_degree_function)(void*),
+    size_t (*in_degree_function)(void*),
+    search_context* p_context,
+    search_stats* p_stats,
+    search_path* p_path);
+
+/*******************************************************************************
+* Returns the hop count of a shortest path, or SEARCH_PATH_UNREACHABLE, and    *
+* stores the path to 'p_path' unless it is NULL. The backward search runs on a *
+* thread of its own while the calling thread runs the forward one. The sides   *
+* expand whole levels in step, each into a concurrent map that the other looks *
+* its new nodes up in, and the cheapest meeting cost is shared atomically. The *
+* sides stop once that cost cannot be beaten by a path through the levels      *
+* they have yet to expand. The iterators, hash and equality functions must     *
+* tolerate the two threads reading the graph at once. If the thread cannot be  *
+* started or the memory runs out, the search falls back to the balanced one.   *
+*******************************************************************************/
+size_t bidirectional_breadth_first_search_parallel(
+    void* source_node,
+    void* target_node,
+    child_node_iterator* child_iterator,
+    parent_node_iterator* parent_iterator,
+    size_t (*hash_function)(void*),
+    int (*equals_function)(void*, void*),
+    search_path* p_path);
+
 void bidirectional_breadht_first_search_test();
 
 #endif /* BIDIRECTIONAL_BREADTH_FIRST_SEARCH_H */
\ No newline at end of file
@@ -1,13 +1,17 @@
+#include "allocation.h"
 #include "breadth_first_search.h"
 #include "directed_graph_node.h"
 #include "queue.h"
 #include "list.h"
+#include "search_path.h"
 #include "unordered_map.h"
 #include "unordered_set.h"
 
-static list* trace_back_path(void* target_node, unordered_map* parents)
+static list* trace_back_path(void* target_node,
+                             size_t hops,
+                             unordered_map* parents)
 {
-    list* path = list_alloc(10);
+    list* path = list_alloc(hops + 1);
     void* node = target_node;
 
     while (node)
@@ -19,20 +23,49 @@ static list* trace_back_path(void* target_node, unordered_map* parents)
     return path;
 }
 
-list* breadth_first_search(void* source_node, 
-                           void* target_node,
-                           child_node_iterator* child_iterator,
-                           size_t (*hash_function)   (void*),
-                           int    (*equals_function) (void*, void*))
+/*******************************************************************************
+* Adds 'N' to the counter 'FIELD' of 'p_stats' if the statistics are wanted.   *
+*******************************************************************************/
+#define COUNT(FIELD, N)               \
+    do                                \
+    {                                 \
+        if (p_stats)                  \
+        {                             \
+            p_stats->FIELD += (N);    \
+        }                             \
+    }                                 \
+    while (0)
+
+/*******************************************************************************
+* Runs the search and returns the hop count of the path found, or              *
+* SEARCH_PATH_UNREACHABLE. The path goes to '*pp_list' if it is not NULL, or   *
+* else to 'p_path' if that is not NULL; the hop count is the level at which    *
+* the target is popped, so no distances are stored. The forward queue and map  *
+* of 'p_context' are used and emptied if it is not NULL; otherwise they are    *
+* allocated for the search.                                                    *
+*******************************************************************************/
+static size_t search(void* source_node,
+                     void* target_node,
+                     child_node_iterator* child_iterator,
+                     size_t (*hash_function)   (void*),
+                     int    (*equals_function) (void*, void*),
+                     search_context* p_context,
+                     search_stats* p_stats,
+                     list** pp_list,
+                     search_path* p_path)
 {
-    queue* q = queue_alloc();
-    unordered_map* parent_map = 
-        unordered_map_alloc(10,
-                            1.0f, 
-                            hash_function, 
-                            equals_function);
+    timing_ticks start_ns = p_stats ? timing_now_ns() : 0;
+    allocation_scope scope;
+    queue* q;
+    unordered_map* parent_map;
     void* current_node;
     void* child_node;
+    size_t level_remaining = 1;
+    size_t level = 0;
+    size_t hops = SEARCH_PATH_UNREACHABLE;
+
+    if (pp_list) *pp_list = NULL;
+    if (p_path)  p_path->nodes = 0;
 
     if (!source_node
         || !target_node
@@ -40,19 +73,53 @@ list* breadth_first_search(void* source_node,
         || !hash_function
         || !equals_function)
     {
-        return NULL;
+        return SEARCH_PATH_UNREACHABLE;
+    }
+
+    if (p_stats) allocation_scope_begin(&scope);
+
+    if (p_context)
+    {
+        q = p_context->p_forward_queue;
+        parent_map = p_context->p_forward_map;
+    }
+    else
+    {
+        q = queue_alloc();
+        parent_map = unordered_map_alloc(10,
+                                         1.0f,
+                                         hash_function,
+                                         equals_function);
     }
 
     queue_push_back(q, source_node);
     unordered_map_put(parent_map, source_node, NULL);
+    COUNT(hash_probes, 1);
+
+    if (p_stats)
+    {
+        search_stats_add_level(p_stats, 1, 1);
+    }
 
     while (queue_size(q) > 0)
     {
         current_node = queue_pop_front(q);
+        COUNT(nodes_popped, 1);
 
         if (equals_function(current_node, target_node))
         {
-            return trace_back_path(target_node, parent_map);
+            hops = level;
+
+            if (pp_list)
+            {
+                *pp_list = trace_back_path(target_node, hops, parent_map);
+            }
+            else if (p_path)
+            {
+                search_path_trace(p_path, target_node, hops, parent_map);
+            }
+
+            break;
         }
 
         child_iterator->child_node_iterator_init(child_iterator, current_node);
@@ -61,16 +128,210 @@ list* breadth_first_search(void* source_node,
         {
             child_node = child_iterator->
                          child_node_iterator_next(child_iterator);
+            COUNT(arcs_scanned, 1);
+            COUNT(hash_probes, 1);
 
             if (!unordered_map_contains_key(parent_map, child_node))
             {
                 unordered_map_put(parent_map, child_node, current_node);
                 queue_push_back(q, child_node);
+                COUNT(hash_probes, 1);
+            }
+        }
+
+        child_iterator->child_node_iterator_free(child_iterator);
+
+        /* The queue holds exactly the next level once the current one is
+           exhausted. */
+        if (--level_remaining == 0)
+        {
+            level_remaining = queue_size(q);
+            level++;
+
+            if (p_stats && level_remaining > 0)
+            {
+                search_stats_add_level(p_stats, 1, level_remaining);
+            }
+        }
+    }
+
+    if (p_context)
+    {
+        queue_clear(q);
+        unordered_map_clear(parent_map);
+    }
+    else
+    {
+        queue_free(q);
+        unordered_map_free(&parent_map);
+    }
+
+    COUNT(allocations, allocation_scope_allocations(&scope));
+    COUNT(peak_memory_bytes, allocation_scope_end(&scope));
+    COUNT(duration_ns, timing_now_ns() - start_ns);
+    return hops;
+}
+
+list* breadth_first_search(void* source_node, 
+                           void* target_node,
+                           child_node_iterator* child_iterator,
+                           size_t (*hash_function)   (void*),
+                           int    (*equals_function) (void*, void*))
+{
+    return breadth_first_search_with_stats(source_node,
+                                           target_node,
+                                           child_iterator,
+                                           hash_function,
+                                           equals_function,
+                                           NULL);
+}
+
+list* breadth_first_search_with_stats(void* source_node,
+                                      void* target_node,
+                                      child_node_iterator* child_iterator,
+                                      size_t (*hash_function)   (void*),
+                                      int    (*equals_function) (void*, void*),
+                                      search_stats* p_stats)
+{
+    list* path;
+
+    search(source_node,
+           target_node,
+           child_iterator,
+           hash_function,
+           equals_function,
+           NULL,
+           p_stats,
+           &path,
+           NULL);
+
+    return path;
+}
+
+size_t breadth_first_search_path(void* source_node,
+                                 void* target_node,
+                                 child_node_iterator* child_iterator,
+                                 size_t (*hash_function)   (void*),
+                                 int    (*equals_function) (void*, void*),
+                                 search_path* p_path)
+{
+    return search(source_node,
+                  target_node,
+                  child_iterator,
+                  hash_function,
+                  equals_function,
+                  NULL,
+                  NULL,
+                  NULL,
+                  p_path);
+}
+
+size_t breadth_first_search_in_context(void* source_node,
+                                       void* target_node,
+                                       child_node_iterator* child_iterator,
+                                       search_context* p_context,
+                                       search_stats* p_stats,
+                                       search_path* p_path)
+{
+    return search(source_node,
+                  target_node,
+                  child_iterator,
+                  p_context->hash_function,
+                  p_context->equals_function,
+                  p_context,
+                  p_stats,
+                  NULL,
+                  p_path);
+}
+
+size_t breadth_first_search_distance(void* source_node,
+                                     void* target_node,
+                                     child_node_iterator* child_iterator,
+                                     size_t (*hash_function)   (void*),
+                                     int    (*equals_function) (void*, void*))
+{
+    return breadth_first_search_bounded_distance(source_node,
+                                                 target_node,
+                                                 child_iterator,
+                                                 hash_function,
+                                                 equals_function,
+                                                 SEARCH_PATH_UNREACHABLE);
+}
+
+size_t breadth_first_search_bounded_distance(
+    void* source_node,
+    void* target_node,
+    child_node_iterator* child_iterator,
+    size_t (*hash_function)   (void*),
+    int    (*equals_function) (void*, void*),
+    size_t max_hops)
+{
+    queue* q;
+    unordered_map* distance_map;
+    void* current_node;
+    void* child_node;
+    size_t current_distance;
+    size_t hops = SEARCH_PATH_UNREACHABLE;
+
+    if (!source_node
+        || !target_node
+        || !child_iterator
+        || !hash_function
+        || !equals_function)
+    {
+        return SEARCH_PATH_UNREACHABLE;
+    }
+
+    if (equals_function(source_node, target_node)) return 0;
+
+    q = queue_alloc();
+    distance_map = unordered_map_alloc(10,
+                                       1.0f,
+                                       hash_function,
+                                       equals_function);
+
+    queue_push_back(q, source_node);
+    unordered_map_put(distance_map, source_node, (void*) 0);
+
+    while (queue_size(q) > 0 && hops == SEARCH_PATH_UNREACHABLE)
+    {
+        current_node = queue_pop_front(q);
+        current_distance = (size_t) unordered_map_get(distance_map,
+                                                      current_node);
+
+        /* The queue is in the order of distance, so every node left is at
+           the limit as well. */
+        if (current_distance >= max_hops) break;
+
+        child_iterator->child_node_iterator_init(child_iterator, current_node);
+
+        while (child_iterator->child_node_iterator_has_next(child_iterator))
+        {
+            child_node = child_iterator->
+                         child_node_iterator_next(child_iterator);
+
+            /* The target is done as soon as it is generated; waiting for
+               it to be popped would expand the rest of its parent's
+               level and most of its own. */
+            if (equals_function(child_node, target_node))
+            {
+                hops = current_distance + 1;
+                break;
+            }
+
+            if (!unordered_map_contains_key(distance_map, child_node))
+            {
+                unordered_map_put(distance_map,
+                                  child_node,
+                                  (void*) (current_distance + 1));
+                queue_push_back(q, child_node);
             }
         }
 
         child_iterator->child_node_iterator_free(child_iterator);
     }
 
-    return NULL;
+    queue_free(q);
+    unordered_map_free(&distance_map);
+    return hops;
 }
@@ -1,6 +1,8 @@
 #ifndef BREADTH_FIRST_SEARCH_H
 #define BREADTH_FIRST_SEARCH_h
 #include "list.h"
+#include "search_path.h"
+#include "timing.h"
 #include "utils.h"
 
 /*******************************************************************************
@@ -12,4 +14,68 @@ list* breadth_first_search(void* source_node,
                            size_t (*hash_function)(void*),
                            int(*equals_function)(void*, void*));
 
+/*******************************************************************************
+* Same as 'breadth_first_search' but, if 'p_stats' is not NULL, adds the       *
+* search's counters to it and records the frontier size of each level as       *
+* forward levels. Hash probes count the parent map operations; allocations     *
+* count the blocks the search allocated through 'allocation.h', read from the  *
+* counters of the calling thread.                                              *
+*******************************************************************************/
+list* breadth_first_search_with_stats(void* source_node,
+                                      void* target_node,
+                                      child_node_iterator* child_iterator,
+                                      size_t (*hash_function)(void*),
+                                      int(*equals_function)(void*, void*),
+                                      search_stats* p_stats);
+
+/*******************************************************************************
+* Same as 'breadth_first_search' but returns the hop count of a shortest path, *
+* or SEARCH_PATH_UNREACHABLE. The path is stored to 'p_path' unless it is      *
+* NULL, in which case only the hop count is computed; if the memory runs out   *
+* while storing it, the path is left empty.                                    *
+*******************************************************************************/
+size_t breadth_first_search_path(void* source_node,
+                                 void* target_node,
+                                 child_node_iterator* child_iterator,
+                                 size_t (*hash_function)(void*),
+                                 int(*equals_function)(void*, void*),
+                                 search_path* p_path);
+
+/*******************************************************************************
+* Same as 'breadth_first_search_path' but searches with the forward queue and  *
+* parent map of 'p_context', hashing and comparing with its functions, and     *
+* leaves them empty, so that a thread running many searches allocates them     *
+* once. 'p_stats' may be NULL.                                                 *
+*******************************************************************************/
+size_t breadth_first_search_in_context(void* source_node,
+                                       void* target_node,
+                                       child_node_iterator* child_iterator,
+                                       search_context* p_context,
+                                       search_stats* p_stats,
+                                       search_path* p_path);
+
+/*******************************************************************************
+* Returns the hop count of a shortest path, or SEARCH_PATH_UNREACHABLE. Only   *
+* the hop count of each node is stored, and the search stops as soon as the    *
+* target is generated.                                                         *
+*******************************************************************************/
+size_t breadth_first_search_distance(void* source_node,
+                                     void* target_node,
+                                     child_node_iterator* child_iterator,
+                                     size_t (*hash_function)(void*),
+                                     int(*equals_function)(void*, void*));
+
+/*******************************************************************************
+* Same as 'breadth_first_search_distance' but does not expand the nodes        *
+* 'max_hops' hops away, so a target farther away is reported as                *
+* SEARCH_PATH_UNREACHABLE without exploring the graph past the limit.          *
+*******************************************************************************/
+size_t breadth_first_search_bounded_distance(
+    void* source_node,
+    void* target_node,
+    child_node_iterator* child_iterator,
+    size_t (*hash_function)(void*),
+    int(*equals_function)(void*, void*),
+    size_t max_hops);
+
 #endif
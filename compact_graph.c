@@ -0,0 +1,345 @@
+#include "allocation.h"
+#include "compact_graph.h"
+#include "my_assert.h"
+#include "unordered_set.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+#define FALSE 0
+#define TRUE 1
+
+/*******************************************************************************
+* Rows shorter than this are sorted by insertion.                              *
+*******************************************************************************/
+#define INSERTION_SORT_LIMIT 16
+
+static const float LOAD_FACTOR = 1.0f;
+
+static void compact_graph_release(compact_graph* p_graph)
+{
+    size_t offset_bytes = sizeof(size_t) * (p_graph->nodes + 1);
+    size_t arc_bytes    = sizeof(size_t) * (p_graph->arcs + 1);
+
+    allocation_free(ALLOCATION_GRAPH, p_graph->p_child_offsets, offset_bytes);
+    allocation_free(ALLOCATION_GRAPH, p_graph->p_child_array, arc_bytes);
+    allocation_free(ALLOCATION_GRAPH, p_graph->p_parent_offsets, offset_bytes);
+    allocation_free(ALLOCATION_GRAPH, p_graph->p_parent_array, arc_bytes);
+    allocation_free(ALLOCATION_GRAPH,
+                    p_graph->p_node_array,
+                    sizeof(directed_graph_node*) * (p_graph->nodes + 1));
+    unordered_map_free(&p_graph->p_index_map);
+    allocation_free(ALLOCATION_GRAPH, p_graph, sizeof(*p_graph));
+}
+
+size_t compact_graph_index_of(compact_graph* p_graph,
+                              directed_graph_node* p_node)
+{
+    size_t index;
+
+    if (!p_graph || !p_node || !p_graph->p_index_map)
+    {
+        return p_graph ? p_graph->nodes : 0;
+    }
+
+    /* Indices are stored off by one so that NULL means "not present". */
+    index = (size_t) unordered_map_get(p_graph->p_index_map, p_node);
+    return index == 0 ? p_graph->nodes : index - 1;
+}
+
+compact_graph* compact_graph_alloc(directed_graph_node** p_node_array,
+                                   size_t nodes)
+{
+    compact_graph*         p_graph;
+    unordered_set_iterator iterator;
+    directed_graph_node*   p_child;
+    size_t                 i;
+    size_t                 j;
+    size_t                 child_index;
+    size_t                 arcs;
+
+    if (!p_node_array) return NULL;
+
+    p_graph = allocation_calloc(ALLOCATION_GRAPH, 1, sizeof(*p_graph));
+
+    if (!p_graph) return NULL;
+
+    p_graph->nodes            = nodes;
+    p_graph->p_node_array     = allocation_alloc(ALLOCATION_GRAPH,
+                                                 sizeof(directed_graph_node*) *
+                                                 (nodes + 1));
+    p_graph->p_child_offsets  = allocation_calloc(ALLOCATION_GRAPH,
+                                                  nodes + 1,
+                                                  sizeof(size_t));
+    p_graph->p_parent_offsets = allocation_calloc(ALLOCATION_GRAPH,
+                                                  nodes + 1,
+                                                  sizeof(size_t));
+    p_graph->p_index_map      =
+        unordered_map_alloc(nodes,
+                            LOAD_FACTOR,
+                            directed_graph_node_hash_function,
+                            directed_graph_nodes_equal_function);
+
+    if (!p_graph->p_node_array
+        || !p_graph->p_child_offsets
+        || !p_graph->p_parent_offsets
+        || !p_graph->p_index_map)
+    {
+        compact_graph_release(p_graph);
+        return NULL;
+    }
+
+    for (i = 0; i < nodes; ++i)
+    {
+        p_graph->p_node_array[i] = p_node_array[i];
+        unordered_map_put(p_graph->p_index_map,
+                          p_node_array[i],
+                          (void*)(intptr_t)(i + 1));
+    }
+
+    /* Count the arcs staying within the snapshot. */
+    arcs = 0;
+
+    for (i = 0; i < nodes; ++i)
+    {
+        unordered_set_iterator_init(&p_node_array[i]->m_child_node_set,
+                                    &iterator);
+
+        while (unordered_set_iterator_has_next(&iterator))
+        {
+            unordered_set_iterator_next(&iterator, (void**) &p_child);
+            child_index = compact_graph_index_of(p_graph, p_child);
+
+            if (child_index < nodes)
+            {
+                p_graph->p_child_offsets[i + 1]++;
+                p_graph->p_parent_offsets[child_index + 1]++;
+                arcs++;
+            }
+        }
+    }
+
+    p_graph->arcs = arcs;
+
+    for (i = 0; i < nodes; ++i)
+    {
+        p_graph->p_child_offsets[i + 1]  += p_graph->p_child_offsets[i];
+        p_graph->p_parent_offsets[i + 1] += p_graph->p_parent_offsets[i];
+    }
+
+    p_graph->p_child_array  = allocation_alloc(ALLOCATION_GRAPH,
+                                               sizeof(size_t) * (arcs + 1));
+    p_graph->p_parent_array = allocation_alloc(ALLOCATION_GRAPH,
+                                               sizeof(size_t) * (arcs + 1));
+
+    if (!p_graph->p_child_array || !p_graph->p_parent_array)
+    {
+        compact_graph_release(p_graph);
+        return NULL;
+    }
+
+    for (i = 0; i < nodes; ++i)
+    {
+        j = p_graph->p_child_offsets[i];
+        unordered_set_iterator_init(&p_node_array[i]->m_child_node_set,
+                                    &iterator);
+
+        while (unordered_set_iterator_has_next(&iterator))
+        {
+            unordered_set_iterator_next(&iterator, (void**) &p_child);
+            child_index = compact_graph_index_of(p_graph, p_child);
+
+            if (child_index < nodes)
+            {
+                p_graph->p_child_array[j++] = child_index;
+            }
+        }
+    }
+
+    /* The parent lists are the transpose of the child lists. The offsets are
+       used as insertion cursors and shifted back afterwards. */
+    for (i = 0; i < nodes; ++i)
+    {
+        for (j = p_graph->p_child_offsets[i];
+             j < p_graph->p_child_offsets[i + 1];
+             ++j)
+        {
+            child_index = p_graph->p_child_array[j];
+            p_graph->p_parent_array[p_graph->p_parent_offsets[child_index]++] =
+                i;
+        }
+    }
+
+    for (i = nodes; i > 0; --i)
+    {
+        p_graph->p_parent_offsets[i] = p_graph->p_parent_offsets[i - 1];
+    }
+
+    p_graph->p_parent_offsets[0] = 0;
+    return p_graph;
+}
+
+size_t compact_graph_out_degree(compact_graph* p_graph, size_t index)
+{
+    return p_graph->p_child_offsets[index + 1] -
+           p_graph->p_child_offsets[index];
+}
+
+size_t compact_graph_in_degree(compact_graph* p_graph, size_t index)
+{
+    return p_graph->p_parent_offsets[index + 1] -
+           p_graph->p_parent_offsets[index];
+}
+
+int compact_graph_compare_indices(const void* p_a, const void* p_b)
+{
+    size_t a = *(const size_t*) p_a;
+    size_t b = *(const size_t*) p_b;
+
+    return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+void compact_graph_sort_row(size_t* p_row, size_t length)
+{
+    size_t i;
+    size_t j;
+    size_t value;
+
+    if (length > INSERTION_SORT_LIMIT)
+    {
+        qsort(p_row, length, sizeof(size_t), compact_graph_compare_indices);
+        return;
+    }
+
+    for (i = 1; i < length; ++i)
+    {
+        value = p_row[i];
+
+        for (j = i; j > 0 && p_row[j - 1] > value; --j)
+        {
+            p_row[j] = p_row[j - 1];
+        }
+
+        p_row[j] = value;
+    }
+}
+
+void compact_graph_free(compact_graph* p_graph)
+{
+    if (!p_graph) return;
+
+    compact_graph_release(p_graph);
+}
+
+size_t compact_graph_memory_usage(compact_graph* p_graph)
+{
+    if (!p_graph) return 0;
+
+    return sizeof(*p_graph)
+         + sizeof(size_t) * 2 * (p_graph->nodes + 1)
+         + sizeof(size_t) * 2 * (p_graph->arcs + 1)
+         + (p_graph->p_node_array ?
+            sizeof(directed_graph_node*) * (p_graph->nodes + 1) : 0)
+         + unordered_map_memory_usage(p_graph->p_index_map);
+}
+
+static void compact_graph_test_build()
+{
+    directed_graph_node* p_nodes[4];
+    directed_graph_node* p_outsider;
+    compact_graph*       p_graph;
+    allocation_counters  counters;
+    size_t               base;
+    size_t               i;
+
+    puts("        compact_graph_test_build()");
+
+    for (i = 0; i < 4; ++i)
+    {
+        p_nodes[i] = directed_graph_node_alloc(i);
+    }
+
+    p_outsider = directed_graph_node_alloc(100);
+
+    directed_graph_node_add_arc(p_nodes[0], p_nodes[1]);
+    directed_graph_node_add_arc(p_nodes[0], p_nodes[2]);
+    directed_graph_node_add_arc(p_nodes[2], p_nodes[1]);
+    directed_graph_node_add_arc(p_nodes[3], p_nodes[3]);
+    directed_graph_node_add_arc(p_nodes[3], p_outsider);
+
+    allocation_get_counters(ALLOCATION_GRAPH, &counters);
+    base    = counters.bytes;
+    p_graph = compact_graph_alloc(p_nodes, 4);
+
+    ASSERT(p_graph != NULL);
+
+    /* All but the index map is graph memory. */
+    allocation_get_counters(ALLOCATION_GRAPH, &counters);
+    ASSERT(counters.bytes - base ==
+           compact_graph_memory_usage(p_graph) -
+           unordered_map_memory_usage(p_graph->p_index_map));
+    ASSERT(p_graph->nodes == 4);
+    ASSERT(p_graph->arcs == 4);
+    ASSERT(compact_graph_index_of(p_graph, p_nodes[2]) == 2);
+    ASSERT(compact_graph_index_of(p_graph, p_outsider) == 4);
+
+    ASSERT(compact_graph_out_degree(p_graph, 0) == 2);
+    ASSERT(compact_graph_out_degree(p_graph, 1) == 0);
+    ASSERT(compact_graph_out_degree(p_graph, 2) == 1);
+    ASSERT(compact_graph_out_degree(p_graph, 3) == 1);
+
+    ASSERT(compact_graph_in_degree(p_graph, 0) == 0);
+    ASSERT(compact_graph_in_degree(p_graph, 1) == 2);
+    ASSERT(compact_graph_in_degree(p_graph, 2) == 1);
+    ASSERT(compact_graph_in_degree(p_graph, 3) == 1);
+
+    ASSERT(p_graph->p_child_array[p_graph->p_child_offsets[2]] == 1);
+    ASSERT(p_graph->p_parent_array[p_graph->p_parent_offsets[2]] == 0);
+    ASSERT(p_graph->p_parent_array[p_graph->p_parent_offsets[3]] == 3);
+
+    compact_graph_free(p_graph);
+    allocation_get_counters(ALLOCATION_GRAPH, &counters);
+    ASSERT(counters.bytes == base);
+
+    for (i = 0; i < 4; ++i)
+    {
+        directed_graph_node_free(p_nodes[i]);
+    }
+
+    directed_graph_node_free(p_outsider);
+}
+
+static void compact_graph_test_sort_row()
+{
+    size_t p_short[] = { 5, 1, 4, 1, 3 };
+    size_t p_long[100];
+    size_t i;
+    int    sorted = TRUE;
+
+    puts("        compact_graph_test_sort_row()");
+
+    compact_graph_sort_row(p_short, 5);
+    ASSERT(p_short[0] == 1 && p_short[1] == 1 && p_short[2] == 3);
+    ASSERT(p_short[3] == 4 && p_short[4] == 5);
+
+    for (i = 0; i < 100; ++i)
+    {
+        p_long[i] = (i * 37) % 100;
+    }
+
+    compact_graph_sort_row(p_long, 100);
+
+    for (i = 0; i < 100; ++i)
+    {
+        if (p_long[i] != i) sorted = FALSE;
+    }
+
+    ASSERT(sorted);
+    compact_graph_sort_row(p_long, 0);
+}
+
+void compact_graph_test()
+{
+    puts("    compact_graph_test()");
+    compact_graph_test_build();
+    compact_graph_test_sort_row();
+}
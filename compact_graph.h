@@ -0,0 +1,87 @@
+#ifndef COMPACT_GRAPH_H
+#define COMPACT_GRAPH_H
+
+#include "directed_graph_node.h"
+#include "unordered_map.h"
+#include <stddef.h>
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * A read-only snapshot of a set of directed graph nodes in compressed      *
+    * sparse row form. Nodes are identified by their index in 'p_node_array';  *
+    * the children of the node 'i' are                                         *
+    * p_child_array[p_child_offsets[i] .. p_child_offsets[i + 1] - 1], and the *
+    * parents are laid out in the same manner. Graphs built directly in this   *
+    * form, such as the generated ones, have no node array nor index map. The  *
+    * struct and the arrays come from the ALLOCATION_GRAPH subsystem, sized    *
+    * for 'nodes + 1' offsets or nodes and 'arcs + 1' arcs; code building a    *
+    * graph by hand must allocate them so, as 'compact_graph_free' releases    *
+    * them by these sizes.                                                     *
+    ***************************************************************************/
+    typedef struct compact_graph {
+        size_t                nodes;
+        size_t                arcs;
+        size_t*               p_child_offsets;
+        size_t*               p_child_array;
+        size_t*               p_parent_offsets;
+        size_t*               p_parent_array;
+        directed_graph_node** p_node_array;
+        unordered_map*        p_index_map;
+    } compact_graph;
+
+    /***************************************************************************
+    * Builds a compact snapshot of the nodes in 'p_node_array'. Arcs leading   *
+    * to nodes not present in the array are not included.                     *
+    ***************************************************************************/
+    compact_graph* compact_graph_alloc(directed_graph_node** p_node_array,
+                                       size_t nodes);
+
+    /***************************************************************************
+    * Returns the index of the node in the snapshot, or 'p_graph->nodes' if    *
+    * the node is not in the snapshot.                                         *
+    ***************************************************************************/
+    size_t compact_graph_index_of(compact_graph* p_graph,
+                                  directed_graph_node* p_node);
+
+    /***************************************************************************
+    * Returns the number of children of the node with index 'index'.           *
+    ***************************************************************************/
+    size_t compact_graph_out_degree(compact_graph* p_graph, size_t index);
+
+    /***************************************************************************
+    * Returns the number of parents of the node with index 'index'.            *
+    ***************************************************************************/
+    size_t compact_graph_in_degree(compact_graph* p_graph, size_t index);
+
+    /***************************************************************************
+    * Compares two node indices for 'qsort' and 'bsearch'.                     *
+    ***************************************************************************/
+    int compact_graph_compare_indices(const void* p_a, const void* p_b);
+
+    /***************************************************************************
+    * Sorts a row of node indices in increasing order. The rows of the graphs  *
+    * are short as a rule, so short rows are sorted by insertion.              *
+    ***************************************************************************/
+    void compact_graph_sort_row(size_t* p_row, size_t length);
+
+    /***************************************************************************
+    * Deallocates the snapshot. The nodes themselves are not touched.          *
+    ***************************************************************************/
+    void compact_graph_free(compact_graph* p_graph);
+
+    /***************************************************************************
+    * Returns the number of bytes allocated by the snapshot.                   *
+    ***************************************************************************/
+    size_t compact_graph_memory_usage(compact_graph* p_graph);
+
+    /* Contains the unit tests. */
+    void compact_graph_test();
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif  /* COMPACT_GRAPH_H */
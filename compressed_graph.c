@@ -0,0 +1,966 @@
+#include "allocation.h"
+#include "breadth_first_search.h"
+#include "compressed_graph.h"
+#include "graph_generator.h"
+#include "graph_ordering.h"
+#include "my_assert.h"
+#include "parallel.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__SSSE3__) || (defined(_MSC_VER) && defined(__AVX__))
+#include <tmmintrin.h>
+#define COMPRESSED_GRAPH_SSSE3
+#endif
+
+#define FALSE 0
+#define TRUE 1
+
+/*******************************************************************************
+* A group of four values takes at most 16 bytes. The data arrays are padded so *
+* that a group can always be loaded whole, even at the end of the data.        *
+*******************************************************************************/
+#define GROUP_BYTES 16
+
+#define MAX_NODES 0x80000000UL
+
+typedef struct compress_context {
+    compact_graph*    p_source;
+    compressed_graph* p_graph;
+    size_t            failed;
+} compress_context;
+
+#ifdef COMPRESSED_GRAPH_SSSE3
+
+/*******************************************************************************
+* For each control byte, the byte shuffle that spreads the data of a group     *
+* over four 32-bit lanes. Built once by the first call to 'build_shuffles'.    *
+*******************************************************************************/
+static unsigned char shuffle_table[256][GROUP_BYTES];
+static size_t        shuffle_table_state;
+
+static void build_shuffles()
+{
+    size_t control;
+    size_t lane;
+    size_t length;
+    size_t offset;
+    size_t i;
+
+    /* 0: not built, 1: being built, 2: ready. */
+    if (!PARALLEL_CAS(&shuffle_table_state, 0, 1))
+    {
+        while (PARALLEL_LOAD(&shuffle_table_state) != 2) {}
+
+        return;
+    }
+
+    for (control = 0; control < 256; ++control)
+    {
+        offset = 0;
+
+        for (lane = 0; lane < 4; ++lane)
+        {
+            length = ((control >> (2 * lane)) & 3) + 1;
+
+            for (i = 0; i < 4; ++i)
+            {
+                shuffle_table[control][4 * lane + i] =
+                    (unsigned char)(i < length ? offset + i : 0x80);
+            }
+
+            offset += length;
+        }
+    }
+
+    PARALLEL_STORE(&shuffle_table_state, 2);
+}
+
+#endif
+
+static size_t value_length(size_t value)
+{
+    return value < 0x100UL ? 1 :
+           value < 0x10000UL ? 2 :
+           value < 0x1000000UL ? 3 : 4;
+}
+
+static size_t varint_length(size_t value)
+{
+    size_t length = 1;
+
+    while (value >= 0x80)
+    {
+        value >>= 7;
+        length++;
+    }
+
+    return length;
+}
+
+static unsigned char* write_varint(unsigned char* p_out, size_t value)
+{
+    while (value >= 0x80)
+    {
+        *p_out++ = (unsigned char)((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+
+    *p_out++ = (unsigned char) value;
+    return p_out;
+}
+
+static const unsigned char* read_varint(const unsigned char* p_in,
+                                        size_t* p_value)
+{
+    size_t value = 0;
+    size_t shift = 0;
+
+    while (*p_in & 0x80)
+    {
+        value |= (size_t)(*p_in++ & 0x7F) << shift;
+        shift += 7;
+    }
+
+    *p_value = value | (size_t) *p_in++ << shift;
+    return p_in;
+}
+
+/*******************************************************************************
+* The first neighbor is stored relative to the node: 2d for a distance d       *
+* upward and 2d - 1 for a distance d downward.                                 *
+*******************************************************************************/
+static size_t zigzag(size_t neighbor, size_t node)
+{
+    return neighbor >= node ? 2 * (neighbor - node) :
+                              2 * (node - neighbor) - 1;
+}
+
+static size_t unzigzag(size_t value, size_t node)
+{
+    return value & 1 ? node - (value + 1) / 2 : node + value / 2;
+}
+
+/*******************************************************************************
+* Returns the value of the 'i'th of the sorted neighbors as stored.            *
+*******************************************************************************/
+static size_t gap_of(size_t* p_row, size_t i, size_t node)
+{
+    return i == 0 ? zigzag(p_row[0], node) : p_row[i] - p_row[i - 1] - 1;
+}
+
+/*******************************************************************************
+* Decodes the four values of a full group into 'p_value_array' and returns the *
+* number of data bytes they took.                                              *
+*******************************************************************************/
+static size_t decode_group(unsigned char control,
+                           const unsigned char* p_data,
+                           size_t* p_value_array)
+{
+    size_t length = (size_t)(control & 3) + ((control >> 2) & 3) +
+                    ((control >> 4) & 3) + ((control >> 6) & 3) + 4;
+#ifdef COMPRESSED_GRAPH_SSSE3
+    unsigned int p_lane_array[4];
+    __m128i      data = _mm_loadu_si128((const __m128i*) p_data);
+    __m128i      mask =
+        _mm_loadu_si128((const __m128i*) shuffle_table[control]);
+
+    _mm_storeu_si128((__m128i*) p_lane_array, _mm_shuffle_epi8(data, mask));
+    p_value_array[0] = p_lane_array[0];
+    p_value_array[1] = p_lane_array[1];
+    p_value_array[2] = p_lane_array[2];
+    p_value_array[3] = p_lane_array[3];
+#else
+    size_t lane;
+    size_t bytes;
+    size_t value;
+    size_t i;
+
+    for (lane = 0; lane < 4; ++lane)
+    {
+        bytes = ((size_t) control >> (2 * lane) & 3) + 1;
+        value = 0;
+
+        for (i = bytes; i > 0; --i)
+        {
+            value = value << 8 | p_data[i - 1];
+        }
+
+        p_value_array[lane] = value;
+        p_data += bytes;
+    }
+#endif
+    return length;
+}
+
+/*******************************************************************************
+* Decodes the first 'count' values of a group.                                 *
+*******************************************************************************/
+static size_t decode_partial_group(unsigned char control,
+                                   const unsigned char* p_data,
+                                   size_t count,
+                                   size_t* p_value_array)
+{
+    size_t length = 0;
+    size_t lane;
+    size_t bytes;
+    size_t value;
+    size_t i;
+
+    for (lane = 0; lane < count; ++lane)
+    {
+        bytes = ((size_t) control >> (2 * lane) & 3) + 1;
+        value = 0;
+
+        for (i = bytes; i > 0; --i)
+        {
+            value = value << 8 | p_data[length + i - 1];
+        }
+
+        p_value_array[lane] = value;
+        length += bytes;
+    }
+
+    return length;
+}
+
+/*******************************************************************************
+* Returns the number of bytes the row takes once encoded.                      *
+*******************************************************************************/
+static size_t encoded_length(size_t* p_row, size_t count, size_t node)
+{
+    size_t length = varint_length(count) + (count + 3) / 4;
+    size_t i;
+
+    for (i = 0; i < count; ++i)
+    {
+        length += value_length(gap_of(p_row, i, node));
+    }
+
+    return length;
+}
+
+static void encode_row(unsigned char* p_out,
+                       size_t* p_row,
+                       size_t count,
+                       size_t node)
+{
+    unsigned char* p_control;
+    unsigned char* p_data;
+    size_t         value;
+    size_t         bytes;
+    size_t         i;
+
+    p_control = write_varint(p_out, count);
+    p_data    = p_control + (count + 3) / 4;
+    memset(p_control, 0, (count + 3) / 4);
+
+    for (i = 0; i < count; ++i)
+    {
+        value = gap_of(p_row, i, node);
+        bytes = value_length(value);
+        p_control[i / 4] |= (unsigned char)((bytes - 1) << (2 * (i % 4)));
+
+        while (bytes-- > 0)
+        {
+            *p_data++ = (unsigned char)(value & 0xFF);
+            value >>= 8;
+        }
+    }
+}
+
+/*******************************************************************************
+* Measures the rows in the first pass and encodes them in the second. The      *
+* offset array of a side holds the row lengths until the prefix sum.           *
+*******************************************************************************/
+static void compress_rows(size_t begin,
+                          size_t end,
+                          void* p_argument,
+                          int encode)
+{
+    compress_context* p_context = p_argument;
+    compact_graph*    p_source  = p_context->p_source;
+    compressed_graph* p_graph   = p_context->p_graph;
+    size_t*           p_row;
+    size_t*           p_source_offsets;
+    size_t*           p_source_array;
+    size_t*           p_offsets;
+    unsigned char*    p_data;
+    size_t            count;
+    size_t            node;
+    int               side;
+
+    p_row = malloc(sizeof(size_t) * (p_graph->max_degree + 1));
+
+    if (!p_row)
+    {
+        PARALLEL_STORE(&p_context->failed, TRUE);
+        return;
+    }
+
+    for (side = 0; side < 2; ++side)
+    {
+        p_source_offsets = side == 0 ? p_source->p_child_offsets :
+                                       p_source->p_parent_offsets;
+        p_source_array   = side == 0 ? p_source->p_child_array :
+                                       p_source->p_parent_array;
+        p_offsets        = side == 0 ? p_graph->p_child_offsets :
+                                       p_graph->p_parent_offsets;
+        p_data           = side == 0 ? p_graph->p_child_data :
+                                       p_graph->p_parent_data;
+
+        for (node = begin; node < end; ++node)
+        {
+            count = p_source_offsets[node + 1] - p_source_offsets[node];
+            memcpy(p_row,
+                   p_source_array + p_source_offsets[node],
+                   sizeof(size_t) * count);
+            compact_graph_sort_row(p_row, count);
+
+            if (encode)
+            {
+                encode_row(p_data + p_offsets[node], p_row, count, node);
+            }
+            else
+            {
+                p_offsets[node + 1] = encoded_length(p_row, count, node);
+            }
+        }
+    }
+
+    free(p_row);
+}
+
+static void measure_rows_body(size_t begin,
+                              size_t end,
+                              size_t thread_index,
+                              void* p_argument)
+{
+    (void) thread_index;
+
+    compress_rows(begin, end, p_argument, FALSE);
+}
+
+static void encode_rows_body(size_t begin,
+                             size_t end,
+                             size_t thread_index,
+                             void* p_argument)
+{
+    (void) thread_index;
+
+    compress_rows(begin, end, p_argument, TRUE);
+}
+
+compressed_graph* compressed_graph_alloc(compact_graph* p_graph,
+                                         size_t threads)
+{
+    compressed_graph* p_result;
+    compress_context  context;
+    size_t            nodes;
+    size_t            node;
+
+    if (!p_graph || p_graph->nodes > MAX_NODES) return NULL;
+
+#ifdef COMPRESSED_GRAPH_SSSE3
+    build_shuffles();
+#endif
+
+    nodes    = p_graph->nodes;
+    p_result = allocation_calloc(ALLOCATION_GRAPH, 1, sizeof(*p_result));
+
+    if (!p_result) return NULL;
+
+    p_result->nodes            = nodes;
+    p_result->arcs             = p_graph->arcs;
+    p_result->p_child_offsets  = allocation_alloc(ALLOCATION_GRAPH,
+                                                  sizeof(size_t) *
+                                                  (nodes + 1));
+    p_result->p_parent_offsets = allocation_alloc(ALLOCATION_GRAPH,
+                                                  sizeof(size_t) *
+                                                  (nodes + 1));
+
+    if (!p_result->p_child_offsets || !p_result->p_parent_offsets)
+    {
+        compressed_graph_free(p_result);
+        return NULL;
+    }
+
+    for (node = 0; node < nodes; ++node)
+    {
+        if (p_result->max_degree < compact_graph_out_degree(p_graph, node))
+        {
+            p_result->max_degree = compact_graph_out_degree(p_graph, node);
+        }
+
+        if (p_result->max_degree < compact_graph_in_degree(p_graph, node))
+        {
+            p_result->max_degree = compact_graph_in_degree(p_graph, node);
+        }
+    }
+
+    context.p_source = p_graph;
+    context.p_graph  = p_result;
+    context.failed   = FALSE;
+    parallel_for(0, nodes, threads, measure_rows_body, &context);
+
+    p_result->p_child_offsets[0]  = 0;
+    p_result->p_parent_offsets[0] = 0;
+
+    for (node = 0; node < nodes; ++node)
+    {
+        p_result->p_child_offsets[node + 1]  +=
+            p_result->p_child_offsets[node];
+        p_result->p_parent_offsets[node + 1] +=
+            p_result->p_parent_offsets[node];
+    }
+
+    p_result->p_child_data  = allocation_calloc(
+                                  ALLOCATION_GRAPH,
+                                  p_result->p_child_offsets[nodes] +
+                                  GROUP_BYTES,
+                                  1);
+    p_result->p_parent_data = allocation_calloc(
+                                  ALLOCATION_GRAPH,
+                                  p_result->p_parent_offsets[nodes] +
+                                  GROUP_BYTES,
+                                  1);
+
+    if (context.failed
+        || !p_result->p_child_data
+        || !p_result->p_parent_data)
+    {
+        compressed_graph_free(p_result);
+        return NULL;
+    }
+
+    parallel_for(0, nodes, threads, encode_rows_body, &context);
+
+    if (context.failed)
+    {
+        compressed_graph_free(p_result);
+        return NULL;
+    }
+
+    return p_result;
+}
+
+size_t compressed_graph_out_degree(compressed_graph* p_graph, size_t index)
+{
+    size_t degree;
+
+    read_varint(p_graph->p_child_data + p_graph->p_child_offsets[index],
+                &degree);
+    return degree;
+}
+
+size_t compressed_graph_in_degree(compressed_graph* p_graph, size_t index)
+{
+    size_t degree;
+
+    read_varint(p_graph->p_parent_data + p_graph->p_parent_offsets[index],
+                &degree);
+    return degree;
+}
+
+/*******************************************************************************
+* Decodes the row at 'p_row' of the node 'index' into 'p_neighbor_array'.      *
+*******************************************************************************/
+static size_t decode_row(const unsigned char* p_row,
+                         size_t index,
+                         size_t* p_neighbor_array)
+{
+    const unsigned char* p_control;
+    const unsigned char* p_data;
+    size_t               count;
+    size_t               previous;
+    size_t               i;
+
+    p_control = read_varint(p_row, &count);
+    p_data    = p_control + (count + 3) / 4;
+
+    for (i = 0; i + 4 <= count; i += 4)
+    {
+        p_data += decode_group(p_control[i / 4],
+                               p_data,
+                               p_neighbor_array + i);
+    }
+
+    if (i < count)
+    {
+        decode_partial_group(p_control[i / 4],
+                             p_data,
+                             count - i,
+                             p_neighbor_array + i);
+    }
+
+    if (count == 0) return 0;
+
+    previous = p_neighbor_array[0] = unzigzag(p_neighbor_array[0], index);
+
+    for (i = 1; i < count; ++i)
+    {
+        previous += p_neighbor_array[i] + 1;
+        p_neighbor_array[i] = previous;
+    }
+
+    return count;
+}
+
+size_t compressed_graph_children(compressed_graph* p_graph,
+                                 size_t index,
+                                 size_t* p_child_array)
+{
+    return decode_row(p_graph->p_child_data + p_graph->p_child_offsets[index],
+                      index,
+                      p_child_array);
+}
+
+size_t compressed_graph_parents(compressed_graph* p_graph,
+                                size_t index,
+                                size_t* p_parent_array)
+{
+    return decode_row(p_graph->p_parent_data +
+                      p_graph->p_parent_offsets[index],
+                      index,
+                      p_parent_array);
+}
+
+void compressed_graph_cursor_init(compressed_graph_cursor* p_cursor,
+                                  compressed_graph* p_graph,
+                                  size_t index,
+                                  int parents)
+{
+    const unsigned char* p_row = parents ?
+        p_graph->p_parent_data + p_graph->p_parent_offsets[index] :
+        p_graph->p_child_data + p_graph->p_child_offsets[index];
+
+    p_cursor->p_graph        = p_graph;
+    p_cursor->parents        = parents;
+    p_cursor->p_control      = read_varint(p_row, &p_cursor->remaining);
+    p_cursor->p_data         = p_cursor->p_control +
+                               (p_cursor->remaining + 3) / 4;
+    p_cursor->previous       = index;
+    p_cursor->first          = TRUE;
+    p_cursor->block_size     = 0;
+    p_cursor->block_position = 0;
+}
+
+int compressed_graph_cursor_has_next(compressed_graph_cursor* p_cursor)
+{
+    return p_cursor->block_position < p_cursor->block_size
+        || p_cursor->remaining > 0;
+}
+
+size_t compressed_graph_cursor_next(compressed_graph_cursor* p_cursor)
+{
+    size_t* p_block_array = p_cursor->p_block_array;
+    size_t  i;
+
+    if (p_cursor->block_position < p_cursor->block_size)
+    {
+        return p_block_array[p_cursor->block_position++];
+    }
+
+    if (p_cursor->remaining >= 4)
+    {
+        p_cursor->p_data += decode_group(*p_cursor->p_control++,
+                                         p_cursor->p_data,
+                                         p_block_array);
+        p_cursor->block_size = 4;
+    }
+    else
+    {
+        p_cursor->p_data += decode_partial_group(*p_cursor->p_control++,
+                                                 p_cursor->p_data,
+                                                 p_cursor->remaining,
+                                                 p_block_array);
+        p_cursor->block_size = p_cursor->remaining;
+    }
+
+    /* Turn the gaps into neighbor indices. */
+    for (i = 0; i < p_cursor->block_size; ++i)
+    {
+        if (p_cursor->first)
+        {
+            p_cursor->previous = unzigzag(p_block_array[i],
+                                          p_cursor->previous);
+            p_cursor->first    = FALSE;
+        }
+        else
+        {
+            p_cursor->previous += p_block_array[i] + 1;
+        }
+
+        p_block_array[i] = p_cursor->previous;
+    }
+
+    p_cursor->remaining     -= p_cursor->block_size;
+    p_cursor->block_position = 1;
+    return p_block_array[0];
+}
+
+static void children_iterator_init(child_node_iterator* p_iterator,
+                                   void* p_node)
+{
+    compressed_graph_cursor* p_cursor = p_iterator->state;
+
+    compressed_graph_cursor_init(p_cursor,
+                                 p_cursor->p_graph,
+                                 compressed_graph_index(p_node),
+                                 FALSE);
+}
+
+static int children_iterator_has_next(child_node_iterator* p_iterator)
+{
+    return compressed_graph_cursor_has_next(p_iterator->state);
+}
+
+static void* children_iterator_next(child_node_iterator* p_iterator)
+{
+    return compressed_graph_node(
+               compressed_graph_cursor_next(p_iterator->state));
+}
+
+static void children_iterator_free(child_node_iterator* p_iterator)
+{
+    (void) p_iterator;
+}
+
+static void parents_iterator_init(parent_node_iterator* p_iterator,
+                                  void* p_node)
+{
+    compressed_graph_cursor* p_cursor = p_iterator->state;
+
+    compressed_graph_cursor_init(p_cursor,
+                                 p_cursor->p_graph,
+                                 compressed_graph_index(p_node),
+                                 TRUE);
+}
+
+static int parents_iterator_has_next(parent_node_iterator* p_iterator)
+{
+    return compressed_graph_cursor_has_next(p_iterator->state);
+}
+
+static void* parents_iterator_next(parent_node_iterator* p_iterator)
+{
+    return compressed_graph_node(
+               compressed_graph_cursor_next(p_iterator->state));
+}
+
+static void parents_iterator_free(parent_node_iterator* p_iterator)
+{
+    (void) p_iterator;
+}
+
+void compressed_graph_children_iterator(child_node_iterator* p_iterator,
+                                        compressed_graph_cursor* p_cursor,
+                                        compressed_graph* p_graph)
+{
+    p_cursor->p_graph                        = p_graph;
+    p_cursor->remaining                      = 0;
+    p_cursor->block_size                     = 0;
+    p_cursor->block_position                 = 0;
+    p_iterator->state                        = p_cursor;
+    p_iterator->child_node_iterator_init     = children_iterator_init;
+    p_iterator->child_node_iterator_has_next = children_iterator_has_next;
+    p_iterator->child_node_iterator_next     = children_iterator_next;
+    p_iterator->child_node_iterator_free     = children_iterator_free;
+}
+
+void compressed_graph_parents_iterator(parent_node_iterator* p_iterator,
+                                       compressed_graph_cursor* p_cursor,
+                                       compressed_graph* p_graph)
+{
+    p_cursor->p_graph                         = p_graph;
+    p_cursor->remaining                       = 0;
+    p_cursor->block_size                      = 0;
+    p_cursor->block_position                  = 0;
+    p_iterator->state                         = p_cursor;
+    p_iterator->parent_node_iterator_init     = parents_iterator_init;
+    p_iterator->parent_node_iterator_has_next = parents_iterator_has_next;
+    p_iterator->parent_node_iterator_next     = parents_iterator_next;
+    p_iterator->parent_node_iterator_free     = parents_iterator_free;
+}
+
+void* compressed_graph_node(size_t index)
+{
+    /* Off by one so that the node 0 is not NULL. */
+    return (void*)(intptr_t)(index + 1);
+}
+
+size_t compressed_graph_index(void* p_node)
+{
+    return (size_t)(intptr_t) p_node - 1;
+}
+
+size_t compressed_graph_node_hash_function(void* p_node)
+{
+    return (size_t)(intptr_t) p_node;
+}
+
+int compressed_graph_nodes_equal_function(void* p_a, void* p_b)
+{
+    return p_a == p_b;
+}
+
+void compressed_graph_free(compressed_graph* p_graph)
+{
+    if (!p_graph) return;
+
+    /* The data arrays exist only once the offsets are complete. */
+    if (p_graph->p_child_data)
+    {
+        allocation_free(ALLOCATION_GRAPH,
+                        p_graph->p_child_data,
+                        p_graph->p_child_offsets[p_graph->nodes] +
+                        GROUP_BYTES);
+    }
+
+    if (p_graph->p_parent_data)
+    {
+        allocation_free(ALLOCATION_GRAPH,
+                        p_graph->p_parent_data,
+                        p_graph->p_parent_offsets[p_graph->nodes] +
+                        GROUP_BYTES);
+    }
+
+    allocation_free(ALLOCATION_GRAPH,
+                    p_graph->p_child_offsets,
+                    sizeof(size_t) * (p_graph->nodes + 1));
+    allocation_free(ALLOCATION_GRAPH,
+                    p_graph->p_parent_offsets,
+                    sizeof(size_t) * (p_graph->nodes + 1));
+    allocation_free(ALLOCATION_GRAPH, p_graph, sizeof(*p_graph));
+}
+
+size_t compressed_graph_memory_usage(compressed_graph* p_graph)
+{
+    if (!p_graph) return 0;
+
+    return sizeof(*p_graph)
+         + sizeof(size_t) * 2 * (p_graph->nodes + 1)
+         + p_graph->p_child_offsets[p_graph->nodes] + GROUP_BYTES
+         + p_graph->p_parent_offsets[p_graph->nodes] + GROUP_BYTES;
+}
+
+/*******************************************************************************
+* Checks that the compressed graph has the same rows as the compact one, in    *
+* sorted order, through the bulk decoders and the cursors.                     *
+*******************************************************************************/
+static int rows_match(compact_graph* p_graph, compressed_graph* p_compressed)
+{
+    compressed_graph_cursor cursor;
+    size_t*                 p_expected;
+    size_t*                 p_actual;
+    size_t                  count;
+    size_t                  node;
+    size_t                  i;
+    int                     side;
+    int                     match = TRUE;
+
+    p_expected = malloc(sizeof(size_t) * (p_compressed->max_degree + 1));
+    p_actual   = malloc(sizeof(size_t) * (p_compressed->max_degree + 1));
+
+    for (node = 0; node < p_graph->nodes && match; ++node)
+    {
+        for (side = 0; side < 2; ++side)
+        {
+            count = side == 0 ? compact_graph_out_degree(p_graph, node) :
+                                compact_graph_in_degree(p_graph, node);
+            memcpy(p_expected,
+                   side == 0 ?
+                   p_graph->p_child_array + p_graph->p_child_offsets[node] :
+                   p_graph->p_parent_array + p_graph->p_parent_offsets[node],
+                   sizeof(size_t) * count);
+            compact_graph_sort_row(p_expected, count);
+
+            if (count != (side == 0 ?
+                          compressed_graph_out_degree(p_compressed, node) :
+                          compressed_graph_in_degree(p_compressed, node))
+                || count != (side == 0 ?
+                             compressed_graph_children(p_compressed,
+                                                       node,
+                                                       p_actual) :
+                             compressed_graph_parents(p_compressed,
+                                                      node,
+                                                      p_actual))
+                || memcmp(p_expected,
+                          p_actual,
+                          sizeof(size_t) * count) != 0)
+            {
+                match = FALSE;
+            }
+
+            compressed_graph_cursor_init(&cursor, p_compressed, node, side);
+
+            for (i = 0; i < count; ++i)
+            {
+                if (!compressed_graph_cursor_has_next(&cursor)
+                    || compressed_graph_cursor_next(&cursor) != p_expected[i])
+                {
+                    match = FALSE;
+                    break;
+                }
+            }
+
+            if (compressed_graph_cursor_has_next(&cursor)) match = FALSE;
+        }
+    }
+
+    free(p_expected);
+    free(p_actual);
+    return match;
+}
+
+static void compressed_graph_test_codec()
+{
+    unsigned char p_buffer[32];
+    size_t        p_value_array[4];
+    size_t        p_row[6] = { 3, 4, 300, 70000, 20000000, 3000000000UL };
+    size_t        p_decoded[6];
+    size_t        value;
+
+    puts("        compressed_graph_test_codec()");
+
+#ifdef COMPRESSED_GRAPH_SSSE3
+    build_shuffles();
+#endif
+
+    ASSERT(write_varint(p_buffer, 300) == p_buffer + 2);
+    ASSERT(read_varint(p_buffer, &value) == p_buffer + 2);
+    ASSERT(value == 300);
+
+    ASSERT(zigzag(7, 7) == 0);
+    ASSERT(zigzag(6, 7) == 1);
+    ASSERT(zigzag(8, 7) == 2);
+    ASSERT(unzigzag(zigzag(0, 7), 7) == 0);
+    ASSERT(unzigzag(zigzag(100, 7), 7) == 100);
+
+    /* Values of every byte length, and a partial last group. */
+    memset(p_buffer, 0, sizeof(p_buffer));
+    ASSERT(encoded_length(p_row, 6, 10) == 1 + 2 + 1 + 1 + 2 + 3 + 4 + 4);
+    encode_row(p_buffer, p_row, 6, 10);
+    ASSERT(decode_row(p_buffer, 10, p_decoded) == 6);
+    ASSERT(memcmp(p_row, p_decoded, sizeof(p_row)) == 0);
+
+    /* The control byte 0xE4 gives the lengths 1, 2, 3 and 4. */
+    memset(p_buffer, 0, sizeof(p_buffer));
+    p_buffer[0] = 0x11;
+    p_buffer[1] = 0x22;
+    p_buffer[2] = 0x33;
+    p_buffer[5] = 0x44;
+    p_buffer[9] = 0x55;
+    ASSERT(decode_group(0xE4, p_buffer, p_value_array) == 10);
+    ASSERT(p_value_array[0] == 0x11);
+    ASSERT(p_value_array[1] == 0x3322);
+    ASSERT(p_value_array[2] == 0x44UL << 16);
+    ASSERT(p_value_array[3] == 0x55UL << 24);
+}
+
+static void compressed_graph_test_graphs()
+{
+    compact_graph*      p_graph;
+    compact_graph*      p_ordered;
+    compressed_graph*   p_compressed;
+    compressed_graph*   p_ordered_compressed;
+    graph_ordering*     p_ordering;
+    allocation_counters counters;
+    size_t              base;
+
+    puts("        compressed_graph_test_graphs()");
+
+    /* Both graphs account for their memory in the graph subsystem. */
+    allocation_get_counters(ALLOCATION_GRAPH, &counters);
+    base         = counters.bytes;
+    p_graph      = graph_generator_rmat(5000, 40000, 0.57, 0.19, 0.19, 3, 2);
+    p_compressed = compressed_graph_alloc(p_graph, 3);
+    ASSERT(p_compressed != NULL);
+    allocation_get_counters(ALLOCATION_GRAPH, &counters);
+    ASSERT(counters.bytes - base ==
+           compact_graph_memory_usage(p_graph) +
+           compressed_graph_memory_usage(p_compressed));
+    ASSERT(p_compressed->arcs == p_graph->arcs);
+    ASSERT(rows_match(p_graph, p_compressed));
+    ASSERT(compressed_graph_memory_usage(p_compressed) <
+           compact_graph_memory_usage(p_graph));
+    compressed_graph_free(p_compressed);
+    compact_graph_free(p_graph);
+    allocation_get_counters(ALLOCATION_GRAPH, &counters);
+    ASSERT(counters.bytes == base);
+
+    /* Numbering for locality shrinks the gaps. */
+    p_graph = graph_generator_geometric(5000, 1.0, 1.0, 1.0, 0.1, 3, 2,
+                                        NULL);
+    p_ordering   = graph_ordering_reverse_cuthill_mckee(p_graph);
+    p_ordered    = graph_ordering_apply(p_ordering, p_graph, 2);
+    p_compressed = compressed_graph_alloc(p_graph, 1);
+    p_ordered_compressed = compressed_graph_alloc(p_ordered, 0);
+    ASSERT(rows_match(p_graph, p_compressed));
+    ASSERT(rows_match(p_ordered, p_ordered_compressed));
+    ASSERT(compressed_graph_memory_usage(p_ordered_compressed) <
+           compressed_graph_memory_usage(p_compressed));
+    compressed_graph_free(p_compressed);
+    compressed_graph_free(p_ordered_compressed);
+    compact_graph_free(p_ordered);
+    compact_graph_free(p_graph);
+    graph_ordering_free(p_ordering);
+}
+
+static void compressed_graph_test_iterators()
+{
+    compact_graph*          p_graph;
+    compressed_graph*       p_compressed;
+    compressed_graph_cursor child_cursor;
+    compressed_graph_cursor parent_cursor;
+    child_node_iterator     child_iterator;
+    parent_node_iterator    parent_iterator;
+    list*                   p_path;
+    size_t                  parents = 0;
+
+    puts("        compressed_graph_test_iterators()");
+
+    /* The corners of a 10 x 10 grid are 18 steps apart. */
+    p_graph      = graph_generator_grid(10, 10, 1, 1);
+    p_compressed = compressed_graph_alloc(p_graph, 1);
+    compressed_graph_children_iterator(&child_iterator,
+                                       &child_cursor,
+                                       p_compressed);
+    p_path = breadth_first_search(compressed_graph_node(0),
+                                  compressed_graph_node(99),
+                                  &child_iterator,
+                                  compressed_graph_node_hash_function,
+                                  compressed_graph_nodes_equal_function);
+    ASSERT(p_path != NULL);
+    ASSERT(list_size(p_path) == 19);
+    ASSERT(compressed_graph_index(list_get(p_path, 0)) == 0);
+    ASSERT(compressed_graph_index(list_get(p_path, 18)) == 99);
+    list_free(p_path);
+
+    compressed_graph_parents_iterator(&parent_iterator,
+                                      &parent_cursor,
+                                      p_compressed);
+    parent_iterator.parent_node_iterator_init(&parent_iterator,
+                                              compressed_graph_node(11));
+
+    while (parent_iterator.parent_node_iterator_has_next(&parent_iterator))
+    {
+        parent_iterator.parent_node_iterator_next(&parent_iterator);
+        parents++;
+    }
+
+    parent_iterator.parent_node_iterator_free(&parent_iterator);
+    ASSERT(parents == 4);
+
+    compressed_graph_free(p_compressed);
+    compact_graph_free(p_graph);
+}
+
+void compressed_graph_test()
+{
+    puts("    compressed_graph_test()");
+    compressed_graph_test_codec();
+    compressed_graph_test_graphs();
+    compressed_graph_test_iterators();
+}
@@ -0,0 +1,147 @@
+#ifndef COMPRESSED_GRAPH_H
+#define COMPRESSED_GRAPH_H
+
+#include "compact_graph.h"
+#include "utils.h"
+#include <stddef.h>
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * A read-only graph whose neighbor lists are compressed. Each row is the   *
+    * number of neighbors as a varint followed by the sorted neighbors as gaps *
+    * in Stream VByte form: a control byte holding the 2-bit byte lengths of   *
+    * four values, then the values themselves. The first gap is taken from the *
+    * node itself and zigzag-coded, so graphs numbered for locality (see       *
+    * graph_ordering.h) need a byte or two per arc. 'p_child_offsets[i]' is    *
+    * the position of the row of the node 'i' in 'p_child_data', and likewise  *
+    * for the parents. At most 2^31 nodes are supported.                       *
+    ***************************************************************************/
+    typedef struct compressed_graph {
+        size_t         nodes;
+        size_t         arcs;
+        size_t         max_degree;
+        size_t*        p_child_offsets;
+        unsigned char* p_child_data;
+        size_t*        p_parent_offsets;
+        unsigned char* p_parent_data;
+    } compressed_graph;
+
+    /***************************************************************************
+    * Walks one neighbor list, decoding four values at a time.                 *
+    ***************************************************************************/
+    typedef struct compressed_graph_cursor {
+        compressed_graph*    p_graph;
+        int                  parents;
+        const unsigned char* p_control;
+        const unsigned char* p_data;
+        size_t               remaining;
+        size_t               previous;
+        int                  first;
+        size_t               p_block_array[4];
+        size_t               block_size;
+        size_t               block_position;
+    } compressed_graph_cursor;
+
+    /***************************************************************************
+    * Compresses 'p_graph' using 'threads' threads, or the hardware            *
+    * concurrency if it is zero. Returns NULL if the memory ran out or the     *
+    * graph has too many nodes.                                                *
+    ***************************************************************************/
+    compressed_graph* compressed_graph_alloc(compact_graph* p_graph,
+                                             size_t threads);
+
+    /***************************************************************************
+    * Returns the number of children of the node with index 'index'.           *
+    ***************************************************************************/
+    size_t compressed_graph_out_degree(compressed_graph* p_graph,
+                                       size_t index);
+
+    /***************************************************************************
+    * Returns the number of parents of the node with index 'index'.            *
+    ***************************************************************************/
+    size_t compressed_graph_in_degree(compressed_graph* p_graph, size_t index);
+
+    /***************************************************************************
+    * Decodes the children of the node with index 'index' into                 *
+    * 'p_child_array', which must hold 'max_degree' entries. Returns the       *
+    * number of children.                                                      *
+    ***************************************************************************/
+    size_t compressed_graph_children(compressed_graph* p_graph,
+                                     size_t index,
+                                     size_t* p_child_array);
+
+    /***************************************************************************
+    * Decodes the parents of the node with index 'index' into                  *
+    * 'p_parent_array' in the same manner.                                     *
+    ***************************************************************************/
+    size_t compressed_graph_parents(compressed_graph* p_graph,
+                                    size_t index,
+                                    size_t* p_parent_array);
+
+    /***************************************************************************
+    * Positions the cursor at the start of the children of the node with       *
+    * index 'index', or at its parents if 'parents' is nonzero.                *
+    ***************************************************************************/
+    void compressed_graph_cursor_init(compressed_graph_cursor* p_cursor,
+                                      compressed_graph* p_graph,
+                                      size_t index,
+                                      int parents);
+
+    /***************************************************************************
+    * Signals whether the cursor has more neighbors.                           *
+    ***************************************************************************/
+    int compressed_graph_cursor_has_next(compressed_graph_cursor* p_cursor);
+
+    /***************************************************************************
+    * Returns the next neighbor index.                                         *
+    ***************************************************************************/
+    size_t compressed_graph_cursor_next(compressed_graph_cursor* p_cursor);
+
+    /***************************************************************************
+    * Sets up 'p_iterator' to walk the children in the compressed graph, with  *
+    * 'p_cursor' as its state. The nodes seen by the searches are the values   *
+    * of 'compressed_graph_node' and need the hash and equality functions      *
+    * below. Nothing is allocated.                                             *
+    ***************************************************************************/
+    void compressed_graph_children_iterator(child_node_iterator* p_iterator,
+                                            compressed_graph_cursor* p_cursor,
+                                            compressed_graph* p_graph);
+
+    /***************************************************************************
+    * Sets up 'p_iterator' to walk the parents in the compressed graph.        *
+    ***************************************************************************/
+    void compressed_graph_parents_iterator(parent_node_iterator* p_iterator,
+                                           compressed_graph_cursor* p_cursor,
+                                           compressed_graph* p_graph);
+
+    /***************************************************************************
+    * Converts a node index to the non-NULL pointer the iterators yield, and   *
+    * back.                                                                    *
+    ***************************************************************************/
+    void*  compressed_graph_node(size_t index);
+    size_t compressed_graph_index(void* p_node);
+
+    size_t compressed_graph_node_hash_function(void* p_node);
+    int    compressed_graph_nodes_equal_function(void* p_a, void* p_b);
+
+    /***************************************************************************
+    * Deallocates the compressed graph.                                        *
+    ***************************************************************************/
+    void compressed_graph_free(compressed_graph* p_graph);
+
+    /***************************************************************************
+    * Returns the number of bytes allocated by the compressed graph.           *
+    ***************************************************************************/
+    size_t compressed_graph_memory_usage(compressed_graph* p_graph);
+
+    /* Contains the unit tests. */
+    void compressed_graph_test();
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif  /* COMPRESSED_GRAPH_H */
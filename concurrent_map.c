@@ -0,0 +1,758 @@
+#include "allocation.h"
+#include "concurrent_map.h"
+#include "my_assert.h"
+#include "parallel.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define FALSE 0
+#define TRUE 1
+
+#define EMPTY          ((size_t) 0)
+#define MOVED          ((size_t) 1)
+#define MIN_CAPACITY   16
+#define CHUNK_SLOTS    1024
+#define MIN_BLOCK_SIZE 256
+
+typedef struct concurrent_map_entry {
+    void*  p_key;
+    void*  p_value;
+    size_t hash;
+} concurrent_map_entry;
+
+/*******************************************************************************
+* A slot holds EMPTY, MOVED or a pointer to an entry. 'next' is the table the  *
+* entries are migrating to. The migrating threads claim chunks through         *
+* 'claimed' and count the finished ones in 'migrated'.                         *
+*******************************************************************************/
+typedef struct concurrent_map_table {
+    size_t*                      p_slot_array;
+    size_t                       capacity;
+    size_t                       chunks;
+    size_t                       next;
+    size_t                       claimed;
+    size_t                       migrated;
+    struct concurrent_map_table* p_older;
+} concurrent_map_table;
+
+typedef struct concurrent_map_block {
+    struct concurrent_map_block* p_next;
+    size_t                       used;
+    size_t                       capacity;
+    concurrent_map_entry*        p_entry_array;
+} concurrent_map_block;
+
+static concurrent_map_table* table_alloc(size_t capacity)
+{
+    concurrent_map_table* p_table =
+        allocation_alloc(ALLOCATION_CONCURRENT_MAP, sizeof(*p_table));
+
+    if (!p_table) return NULL;
+
+    p_table->p_slot_array = allocation_calloc(ALLOCATION_CONCURRENT_MAP,
+                                              capacity,
+                                              sizeof(size_t));
+
+    if (!p_table->p_slot_array)
+    {
+        allocation_free(ALLOCATION_CONCURRENT_MAP, p_table, sizeof(*p_table));
+        return NULL;
+    }
+
+    p_table->capacity = capacity;
+    p_table->chunks   = (capacity + CHUNK_SLOTS - 1) / CHUNK_SLOTS;
+    p_table->next     = 0;
+    p_table->claimed  = 0;
+    p_table->migrated = 0;
+    p_table->p_older  = NULL;
+    return p_table;
+}
+
+static void table_free(concurrent_map_table* p_table)
+{
+    allocation_free(ALLOCATION_CONCURRENT_MAP,
+                    p_table->p_slot_array,
+                    sizeof(size_t) * p_table->capacity);
+    allocation_free(ALLOCATION_CONCURRENT_MAP, p_table, sizeof(*p_table));
+}
+
+static concurrent_map_block* block_alloc(size_t capacity)
+{
+    concurrent_map_block* p_block =
+        allocation_alloc(ALLOCATION_CONCURRENT_MAP, sizeof(*p_block));
+
+    if (!p_block) return NULL;
+
+    p_block->p_entry_array =
+        allocation_alloc(ALLOCATION_CONCURRENT_MAP,
+                         sizeof(concurrent_map_entry) * capacity);
+
+    if (!p_block->p_entry_array)
+    {
+        allocation_free(ALLOCATION_CONCURRENT_MAP, p_block, sizeof(*p_block));
+        return NULL;
+    }
+
+    p_block->p_next   = NULL;
+    p_block->used     = 0;
+    p_block->capacity = capacity;
+    return p_block;
+}
+
+static void free_blocks(concurrent_map_block* p_block)
+{
+    concurrent_map_block* p_next;
+
+    for (; p_block; p_block = p_next)
+    {
+        p_next = p_block->p_next;
+        allocation_free(ALLOCATION_CONCURRENT_MAP,
+                        p_block->p_entry_array,
+                        sizeof(concurrent_map_entry) * p_block->capacity);
+        allocation_free(ALLOCATION_CONCURRENT_MAP, p_block, sizeof(*p_block));
+    }
+}
+
+/*******************************************************************************
+* Bumps the index of the current block; the thread that finds it exhausted     *
+* installs a block twice as large.                                             *
+*******************************************************************************/
+static concurrent_map_entry* entry_alloc(concurrent_map* p_map)
+{
+    concurrent_map_block* p_block;
+    concurrent_map_block* p_larger;
+    size_t                index;
+
+    for (;;)
+    {
+        p_block = (concurrent_map_block*) PARALLEL_LOAD(&p_map->block);
+        index   = PARALLEL_FETCH_ADD(&p_block->used, 1);
+
+        if (index < p_block->capacity) return &p_block->p_entry_array[index];
+
+        p_larger = block_alloc(2 * p_block->capacity);
+
+        if (!p_larger) return NULL;
+
+        p_larger->p_next = p_block;
+
+        if (!PARALLEL_CAS(&p_map->block, (size_t) p_block, (size_t) p_larger))
+        {
+            p_larger->p_next = NULL;
+            free_blocks(p_larger);
+        }
+    }
+}
+
+/*******************************************************************************
+* Places an entry into a table nobody inserts into but the migrating threads.  *
+* The keys moving in are distinct, so no comparison is needed.                 *
+*******************************************************************************/
+static void copy_entry(concurrent_map_table* p_table,
+                       concurrent_map_entry* p_entry)
+{
+    size_t mask = p_table->capacity - 1;
+    size_t i    = p_entry->hash & mask;
+
+    while (!PARALLEL_CAS(&p_table->p_slot_array[i], EMPTY, (size_t) p_entry))
+    {
+        i = (i + 1) & mask;
+    }
+}
+
+/*******************************************************************************
+* An entry is copied before its slot turns MOVED, so a reader that passes the  *
+* MOVED slot finds the entry in the next table.                                *
+*******************************************************************************/
+static void migrate_chunk(concurrent_map_table* p_table,
+                          concurrent_map_table* p_next,
+                          size_t chunk)
+{
+    size_t begin = chunk * CHUNK_SLOTS;
+    size_t end   = begin + CHUNK_SLOTS;
+    size_t slot;
+    size_t i;
+
+    if (end > p_table->capacity) end = p_table->capacity;
+
+    for (i = begin; i < end; ++i)
+    {
+        for (;;)
+        {
+            slot = PARALLEL_LOAD(&p_table->p_slot_array[i]);
+
+            if (slot == EMPTY)
+            {
+                if (PARALLEL_CAS(&p_table->p_slot_array[i], EMPTY, MOVED))
+                {
+                    break;
+                }
+
+                continue;
+            }
+
+            copy_entry(p_next, (concurrent_map_entry*) slot);
+            PARALLEL_STORE(&p_table->p_slot_array[i], MOVED);
+            break;
+        }
+    }
+}
+
+/*******************************************************************************
+* Migrates chunks of 'p_table' until none is left, waits for the chunks other  *
+* threads took and returns the next table.                                     *
+*******************************************************************************/
+static concurrent_map_table* help_resize(concurrent_map* p_map,
+                                         concurrent_map_table* p_table)
+{
+    concurrent_map_table* p_next =
+        (concurrent_map_table*) PARALLEL_LOAD(&p_table->next);
+    size_t                chunk;
+
+    for (;;)
+    {
+        chunk = PARALLEL_FETCH_ADD(&p_table->claimed, 1);
+
+        if (chunk >= p_table->chunks) break;
+
+        migrate_chunk(p_table, p_next, chunk);
+        PARALLEL_FETCH_ADD(&p_table->migrated, 1);
+    }
+
+    while (PARALLEL_LOAD(&p_table->migrated) < p_table->chunks)
+    {
+        parallel_yield();
+    }
+
+    PARALLEL_CAS(&p_map->current, (size_t) p_table, (size_t) p_next);
+    return p_next;
+}
+
+/*******************************************************************************
+* Attaches a table twice as large unless another thread did. Returns false if  *
+* the memory ran out.                                                          *
+*******************************************************************************/
+static int start_resize(concurrent_map_table* p_table)
+{
+    concurrent_map_table* p_next;
+
+    if (PARALLEL_LOAD(&p_table->next)) return TRUE;
+
+    p_next = table_alloc(2 * p_table->capacity);
+
+    if (!p_next) return FALSE;
+
+    p_next->p_older = p_table;
+
+    if (!PARALLEL_CAS(&p_table->next, 0, (size_t) p_next)) table_free(p_next);
+
+    return TRUE;
+}
+
+concurrent_map* concurrent_map_alloc(size_t initial_capacity,
+                                     float load_factor,
+                                     size_t (*p_hash_function)(void*),
+                                     int (*p_equals_function)(void*, void*))
+{
+    concurrent_map*       p_map;
+    concurrent_map_table* p_table;
+    concurrent_map_block* p_block;
+    size_t                capacity = MIN_CAPACITY;
+
+    if (!p_hash_function || !p_equals_function) return NULL;
+
+    if (load_factor < 0.1f) load_factor = 0.1f;
+    if (load_factor > 0.9f) load_factor = 0.9f;
+
+    while (capacity * load_factor < initial_capacity) capacity *= 2;
+
+    p_map   = allocation_alloc(ALLOCATION_CONCURRENT_MAP, sizeof(*p_map));
+    p_table = table_alloc(capacity);
+    p_block = block_alloc(initial_capacity > MIN_BLOCK_SIZE ?
+                          initial_capacity :
+                          MIN_BLOCK_SIZE);
+
+    if (!p_map || !p_table || !p_block)
+    {
+        allocation_free(ALLOCATION_CONCURRENT_MAP, p_map, sizeof(*p_map));
+
+        if (p_table) table_free(p_table);
+
+        free_blocks(p_block);
+        return NULL;
+    }
+
+    p_map->current           = (size_t) p_table;
+    p_map->block             = (size_t) p_block;
+    p_map->size              = 0;
+    p_map->load_factor       = load_factor;
+    p_map->p_hash_function   = p_hash_function;
+    p_map->p_equals_function = p_equals_function;
+    return p_map;
+}
+
+int concurrent_map_put_if_absent(concurrent_map* p_map,
+                                 void* p_key,
+                                 void* p_value,
+                                 void** pp_value)
+{
+    concurrent_map_table* p_table;
+    concurrent_map_entry* p_new = NULL;
+    concurrent_map_entry* p_entry;
+    size_t                hash;
+    size_t                mask;
+    size_t                probes;
+    size_t                slot;
+    size_t                i;
+
+    if (!p_map || !p_key) return CONCURRENT_MAP_FAILED;
+
+    hash    = p_map->p_hash_function(p_key);
+    p_table = (concurrent_map_table*) PARALLEL_LOAD(&p_map->current);
+
+    for (;;)
+    {
+        if (PARALLEL_LOAD(&p_table->next))
+        {
+            p_table = help_resize(p_map, p_table);
+            continue;
+        }
+
+        mask = p_table->capacity - 1;
+        i    = hash & mask;
+
+        /* A MOVED slot may hide a migrated copy of the key further on, so
+           the search restarts in the next table instead of probing on. */
+        for (probes = 0; probes < p_table->capacity; )
+        {
+            slot = PARALLEL_LOAD(&p_table->p_slot_array[i]);
+
+            if (slot == MOVED) break;
+
+            if (slot == EMPTY)
+            {
+                if (!p_new)
+                {
+                    p_new = entry_alloc(p_map);
+
+                    if (!p_new) return CONCURRENT_MAP_FAILED;
+
+                    p_new->p_key   = p_key;
+                    p_new->p_value = p_value;
+                    p_new->hash    = hash;
+                }
+
+                if (PARALLEL_CAS(&p_table->p_slot_array[i],
+                                 EMPTY,
+                                 (size_t) p_new))
+                {
+                    if (PARALLEL_FETCH_ADD(&p_map->size, 1) + 1 >
+                        p_table->capacity * p_map->load_factor
+                        && start_resize(p_table))
+                    {
+                        help_resize(p_map, p_table);
+                    }
+
+                    return CONCURRENT_MAP_INSERTED;
+                }
+
+                /* Look at what won the slot. */
+                continue;
+            }
+
+            p_entry = (concurrent_map_entry*) slot;
+
+            if (p_entry->hash == hash
+                && p_map->p_equals_function(p_entry->p_key, p_key))
+            {
+                if (pp_value) *pp_value = p_entry->p_value;
+
+                return CONCURRENT_MAP_PRESENT;
+            }
+
+            i = (i + 1) & mask;
+            ++probes;
+        }
+
+        if (probes == p_table->capacity && !start_resize(p_table))
+        {
+            return CONCURRENT_MAP_FAILED;
+        }
+    }
+}
+
+/*******************************************************************************
+* Lookups probe past the MOVED slots and then follow the chain of tables.      *
+*******************************************************************************/
+static concurrent_map_entry* find_entry(concurrent_map* p_map, void* p_key)
+{
+    concurrent_map_table* p_table;
+    concurrent_map_entry* p_entry;
+    size_t                hash;
+    size_t                mask;
+    size_t                probes;
+    size_t                slot;
+    size_t                i;
+
+    if (!p_map || !p_key) return NULL;
+
+    hash    = p_map->p_hash_function(p_key);
+    p_table = (concurrent_map_table*) PARALLEL_LOAD(&p_map->current);
+
+    while (p_table)
+    {
+        mask = p_table->capacity - 1;
+        i    = hash & mask;
+
+        for (probes = 0; probes < p_table->capacity; ++probes)
+        {
+            slot = PARALLEL_LOAD(&p_table->p_slot_array[i]);
+
+            if (slot == EMPTY) break;
+
+            if (slot != MOVED)
+            {
+                p_entry = (concurrent_map_entry*) slot;
+
+                if (p_entry->hash == hash
+                    && p_map->p_equals_function(p_entry->p_key, p_key))
+                {
+                    return p_entry;
+                }
+            }
+
+            i = (i + 1) & mask;
+        }
+
+        p_table = (concurrent_map_table*) PARALLEL_LOAD(&p_table->next);
+    }
+
+    return NULL;
+}
+
+void* concurrent_map_get(concurrent_map* p_map, void* p_key)
+{
+    concurrent_map_entry* p_entry = find_entry(p_map, p_key);
+
+    return p_entry ? p_entry->p_value : NULL;
+}
+
+int concurrent_map_contains_key(concurrent_map* p_map, void* p_key)
+{
+    return find_entry(p_map, p_key) != NULL;
+}
+
+size_t concurrent_map_size(concurrent_map* p_map)
+{
+    return p_map ? PARALLEL_LOAD(&p_map->size) : 0;
+}
+
+/*******************************************************************************
+* Returns the newest table; the older ones hang from its 'p_older' chain.      *
+*******************************************************************************/
+static concurrent_map_table* newest_table(concurrent_map* p_map)
+{
+    concurrent_map_table* p_table =
+        (concurrent_map_table*) p_map->current;
+
+    while (p_table->next) p_table = (concurrent_map_table*) p_table->next;
+
+    return p_table;
+}
+
+void concurrent_map_clear(concurrent_map* p_map)
+{
+    concurrent_map_table* p_table;
+    concurrent_map_table* p_older;
+    concurrent_map_block* p_block;
+    size_t                i;
+
+    if (!p_map) return;
+
+    p_table = newest_table(p_map);
+
+    for (p_older = p_table->p_older; p_older; p_older = p_table->p_older)
+    {
+        p_table->p_older = p_older->p_older;
+        table_free(p_older);
+    }
+
+    for (i = 0; i < p_table->capacity; ++i) p_table->p_slot_array[i] = EMPTY;
+
+    p_table->claimed  = 0;
+    p_table->migrated = 0;
+
+    /* Keep the largest block only. */
+    p_block = (concurrent_map_block*) p_map->block;
+    free_blocks(p_block->p_next);
+    p_block->p_next = NULL;
+    p_block->used   = 0;
+
+    p_map->current = (size_t) p_table;
+    p_map->size    = 0;
+}
+
+void concurrent_map_free(concurrent_map* p_map)
+{
+    concurrent_map_table* p_table;
+    concurrent_map_table* p_older;
+
+    if (!p_map) return;
+
+    for (p_table = newest_table(p_map); p_table; p_table = p_older)
+    {
+        p_older = p_table->p_older;
+        table_free(p_table);
+    }
+
+    free_blocks((concurrent_map_block*) p_map->block);
+    allocation_free(ALLOCATION_CONCURRENT_MAP, p_map, sizeof(*p_map));
+}
+
+size_t concurrent_map_memory_usage(concurrent_map* p_map)
+{
+    concurrent_map_table* p_table;
+    concurrent_map_block* p_block;
+    size_t                bytes;
+
+    if (!p_map) return 0;
+
+    bytes = sizeof(*p_map);
+
+    for (p_table = newest_table(p_map); p_table; p_table = p_table->p_older)
+    {
+        bytes += sizeof(*p_table) + sizeof(size_t) * p_table->capacity;
+    }
+
+    for (p_block = (concurrent_map_block*) p_map->block;
+         p_block;
+         p_block = p_block->p_next)
+    {
+        bytes += sizeof(*p_block) +
+                 sizeof(concurrent_map_entry) * p_block->capacity;
+    }
+
+    return bytes;
+}
+
+static size_t concurrent_map_test_hash(void* p_key)
+{
+    return (size_t) p_key * 2654435761UL;
+}
+
+static int concurrent_map_test_equals(void* p_a, void* p_b)
+{
+    return p_a == p_b;
+}
+
+/*******************************************************************************
+* Runs of 64 keys hash alike, so that probing and migration see long clusters. *
+*******************************************************************************/
+static size_t concurrent_map_test_bad_hash(void* p_key)
+{
+    return ((size_t) p_key / 64) * 2654435761UL;
+}
+
+static void concurrent_map_test_single()
+{
+    concurrent_map* p_map;
+    void*           p_value;
+    size_t          base = allocation_total_bytes();
+    size_t          i;
+
+    puts("        concurrent_map_test_single()");
+
+    ASSERT(concurrent_map_alloc(4, 0.5f, NULL, concurrent_map_test_equals)
+           == NULL);
+
+    p_map = concurrent_map_alloc(4,
+                                 0.5f,
+                                 concurrent_map_test_hash,
+                                 concurrent_map_test_equals);
+
+    ASSERT(concurrent_map_put_if_absent(p_map, NULL, NULL, NULL)
+           == CONCURRENT_MAP_FAILED);
+
+    for (i = 1; i <= 10000; ++i)
+    {
+        ASSERT(concurrent_map_put_if_absent(p_map,
+                                            (void*) i,
+                                            (void*) (3 * i),
+                                            NULL)
+               == CONCURRENT_MAP_INSERTED);
+    }
+
+    ASSERT(concurrent_map_size(p_map) == 10000);
+
+    for (i = 1; i <= 10000; ++i)
+    {
+        p_value = NULL;
+        ASSERT(concurrent_map_put_if_absent(p_map,
+                                            (void*) i,
+                                            (void*) 7,
+                                            &p_value)
+               == CONCURRENT_MAP_PRESENT);
+        ASSERT(p_value == (void*) (3 * i));
+        ASSERT(concurrent_map_get(p_map, (void*) i) == (void*) (3 * i));
+    }
+
+    ASSERT(!concurrent_map_contains_key(p_map, (void*) 10001));
+    ASSERT(concurrent_map_get(p_map, (void*) 10001) == NULL);
+
+    /* A NULL value is a value. */
+    ASSERT(concurrent_map_put_if_absent(p_map, (void*) 10001, NULL, NULL)
+           == CONCURRENT_MAP_INSERTED);
+    ASSERT(concurrent_map_contains_key(p_map, (void*) 10001));
+
+    concurrent_map_clear(p_map);
+    ASSERT(concurrent_map_size(p_map) == 0);
+    ASSERT(!concurrent_map_contains_key(p_map, (void*) 1));
+
+    for (i = 1; i <= 100; ++i)
+    {
+        ASSERT(concurrent_map_put_if_absent(p_map, (void*) i, NULL, NULL)
+               == CONCURRENT_MAP_INSERTED);
+    }
+
+    ASSERT(concurrent_map_size(p_map) == 100);
+    ASSERT(allocation_total_bytes() - base ==
+           concurrent_map_memory_usage(p_map));
+    concurrent_map_free(p_map);
+    ASSERT(allocation_total_bytes() == base);
+}
+
+#define TEST_THREADS 4
+#define TEST_KEYS    19997
+
+typedef struct concurrent_map_test_state {
+    concurrent_map* p_map;
+    size_t*         p_winner_array;
+    size_t          thread;
+    size_t          writers_done;
+    size_t          errors;
+} concurrent_map_test_state;
+
+/*******************************************************************************
+* Every writer offers every key, in its own order as the key count is prime,   *
+* with its own index as the value. A key read twice must show the same value.  *
+*******************************************************************************/
+static void concurrent_map_test_writer(void* p_argument)
+{
+    concurrent_map_test_state* p_state = p_argument;
+    size_t                     thread  =
+        PARALLEL_FETCH_ADD(&p_state->thread, 1);
+    void*                      p_value;
+    size_t                     key;
+    size_t                     i;
+    int                        result;
+
+    for (i = 0; i < TEST_KEYS; ++i)
+    {
+        key = (i * (2 * thread + 1) + thread * 7919) % TEST_KEYS + 1;
+        p_value = NULL;
+        result = concurrent_map_put_if_absent(p_state->p_map,
+                                              (void*) key,
+                                              (void*) (thread + 1),
+                                              &p_value);
+
+        if (result == CONCURRENT_MAP_INSERTED)
+        {
+            PARALLEL_FETCH_ADD(&p_state->p_winner_array[key], thread + 1);
+        }
+        else if (result != CONCURRENT_MAP_PRESENT
+                 || p_value == NULL
+                 || p_value != concurrent_map_get(p_state->p_map,
+                                                  (void*) key))
+        {
+            PARALLEL_FETCH_ADD(&p_state->errors, 1);
+        }
+    }
+
+    PARALLEL_FETCH_ADD(&p_state->writers_done, 1);
+}
+
+static void concurrent_map_test_reader(void* p_argument)
+{
+    concurrent_map_test_state* p_state = p_argument;
+    void*                      p_value;
+    size_t                     key = 1;
+
+    while (PARALLEL_LOAD(&p_state->writers_done) < TEST_THREADS)
+    {
+        p_value = concurrent_map_get(p_state->p_map, (void*) key);
+
+        if (p_value && p_value != concurrent_map_get(p_state->p_map,
+                                                     (void*) key))
+        {
+            PARALLEL_FETCH_ADD(&p_state->errors, 1);
+        }
+
+        key = key % TEST_KEYS + 1;
+    }
+}
+
+static void concurrent_map_test_concurrent()
+{
+    concurrent_map_test_state state;
+    parallel_thread           thread_array[TEST_THREADS + 1];
+    size_t                    (*hash_array[2])(void*);
+    size_t                    h;
+    size_t                    i;
+
+    puts("        concurrent_map_test_concurrent()");
+
+    hash_array[0] = concurrent_map_test_hash;
+    hash_array[1] = concurrent_map_test_bad_hash;
+
+    for (h = 0; h < 2; ++h)
+    {
+        state.p_map = concurrent_map_alloc(1,
+                                           0.5f,
+                                           hash_array[h],
+                                           concurrent_map_test_equals);
+        state.p_winner_array = calloc(TEST_KEYS + 1, sizeof(size_t));
+        state.thread         = 0;
+        state.writers_done   = 0;
+        state.errors         = 0;
+
+        ASSERT(parallel_thread_create(&thread_array[TEST_THREADS],
+                                      concurrent_map_test_reader,
+                                      &state));
+
+        for (i = 0; i < TEST_THREADS; ++i)
+        {
+            ASSERT(parallel_thread_create(&thread_array[i],
+                                          concurrent_map_test_writer,
+                                          &state));
+        }
+
+        for (i = 0; i <= TEST_THREADS; ++i)
+        {
+            parallel_thread_join(thread_array[i]);
+        }
+
+        ASSERT(state.errors == 0);
+        ASSERT(concurrent_map_size(state.p_map) == TEST_KEYS);
+
+        for (i = 1; i <= TEST_KEYS; ++i)
+        {
+            if (state.p_winner_array[i] == 0
+                || concurrent_map_get(state.p_map, (void*) i)
+                   != (void*) state.p_winner_array[i])
+            {
+                break;
+            }
+        }
+
+        ASSERT(i == TEST_KEYS + 1);
+        free(state.p_winner_array);
+        concurrent_map_free(state.p_map);
+    }
+}
+
+void concurrent_map_test()
+{
+    puts("    concurrent_map_test()");
+    concurrent_map_test_single();
+    concurrent_map_test_concurrent();
+}
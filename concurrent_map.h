@@ -0,0 +1,99 @@
+#ifndef CONCURRENT_MAP_H
+#define CONCURRENT_MAP_H
+
+#include <stddef.h>
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * The results of 'concurrent_map_put_if_absent'.                           *
+    ***************************************************************************/
+#define CONCURRENT_MAP_INSERTED 1
+#define CONCURRENT_MAP_PRESENT  0
+#define CONCURRENT_MAP_FAILED   (-1)
+
+    /***************************************************************************
+    * A map that any number of threads may insert into and look up at once.    *
+    * Keys cannot be removed, which keeps the open addressing lock-free: a     *
+    * slot only goes from empty to an entry, and an entry never changes. When  *
+    * the table passes the load factor, a larger one is attached to it and the *
+    * threads inserting meanwhile migrate the old slots chunk by chunk before  *
+    * they insert into the new table; lookups never wait. 'current' points to  *
+    * the table the operations start from and 'block' to the block of entries  *
+    * being filled. The replaced tables stay allocated until the map is freed, *
+    * as a reader may still be probing them. NULL is not a valid key; values   *
+    * may be NULL.                                                             *
+    ***************************************************************************/
+    typedef struct concurrent_map {
+        size_t current;
+        size_t block;
+        size_t size;
+        float  load_factor;
+        size_t (*p_hash_function)(void*);
+        int    (*p_equals_function)(void*, void*);
+    } concurrent_map;
+
+    /***************************************************************************
+    * Allocates an empty map. Returns NULL if the memory ran out.              *
+    ***************************************************************************/
+    concurrent_map* concurrent_map_alloc(size_t initial_capacity,
+                                         float load_factor,
+                                         size_t (*p_hash_function)(void*),
+                                         int (*p_equals_function)(void*,
+                                                                  void*));
+
+    /***************************************************************************
+    * Maps 'p_key' to 'p_value' unless the key is already mapped. Returns      *
+    * CONCURRENT_MAP_INSERTED if this call added the key,                      *
+    * CONCURRENT_MAP_PRESENT if it was there, storing its value to             *
+    * '*pp_value' unless that is NULL, and CONCURRENT_MAP_FAILED if the memory *
+    * ran out. Among threads racing to insert the same key, exactly one        *
+    * succeeds and all agree on its value.                                     *
+    ***************************************************************************/
+    int concurrent_map_put_if_absent(concurrent_map* p_map,
+                                     void* p_key,
+                                     void* p_value,
+                                     void** pp_value);
+
+    /***************************************************************************
+    * Returns the value of 'p_key', or NULL if it is not mapped.               *
+    ***************************************************************************/
+    void* concurrent_map_get(concurrent_map* p_map, void* p_key);
+
+    /***************************************************************************
+    * Returns true if 'p_key' is mapped.                                       *
+    ***************************************************************************/
+    int concurrent_map_contains_key(concurrent_map* p_map, void* p_key);
+
+    /***************************************************************************
+    * Returns the number of keys. While threads insert, it may lag behind.     *
+    ***************************************************************************/
+    size_t concurrent_map_size(concurrent_map* p_map);
+
+    /***************************************************************************
+    * Removes all the keys and releases the replaced tables. No other thread   *
+    * may use the map meanwhile.                                               *
+    ***************************************************************************/
+    void concurrent_map_clear(concurrent_map* p_map);
+
+    /***************************************************************************
+    * Deallocates the map. The keys and values are not touched.                *
+    ***************************************************************************/
+    void concurrent_map_free(concurrent_map* p_map);
+
+    /***************************************************************************
+    * Returns the number of bytes allocated by the map, counting the replaced  *
+    * tables it still holds. No other thread may insert meanwhile.             *
+    ***************************************************************************/
+    size_t concurrent_map_memory_usage(concurrent_map* p_map);
+
+    /* Contains the unit tests. */
+    void concurrent_map_test();
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif  /* CONCURRENT_MAP_H */
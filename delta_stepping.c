@@ -0,0 +1,897 @@
+#include "delta_stepping.h"
+#include "my_assert.h"
+#include "parallel.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+#define FALSE 0
+#define TRUE 1
+
+static const size_t NO_BUCKET = (size_t) -1;
+
+typedef struct index_vector {
+    size_t* p_data;
+    size_t  size;
+    size_t  capacity;
+} index_vector;
+
+typedef struct relax_request {
+    size_t node;
+    size_t parent;
+    double distance;
+} relax_request;
+
+typedef struct request_vector {
+    relax_request* p_data;
+    size_t         size;
+    size_t         capacity;
+} request_vector;
+
+typedef enum delta_stepping_phase {
+    PHASE_FIND_BUCKET,
+    PHASE_RELAX_LIGHT,
+    PHASE_RELAX_HEAVY,
+    PHASE_APPLY
+} delta_stepping_phase;
+
+/*******************************************************************************
+* The state of the owner of one block of nodes: the buckets of its nodes, the  *
+* nodes settled in the current bucket and one outbox of requests per           *
+* destination block.                                                           *
+*******************************************************************************/
+typedef struct delta_stepping_worker {
+    index_vector*   p_bucket_array;
+    index_vector    frontier;
+    index_vector    settled;
+    request_vector* p_outbox_array;
+    size_t          next_bucket;
+    int             has_work;
+    int             out_of_memory;
+} delta_stepping_worker;
+
+typedef struct delta_stepping_context {
+    compact_graph*         p_graph;
+    double*                p_weight_array;
+    double                 delta;
+    size_t                 slots;
+    size_t                 threads;
+    size_t                 block;
+    size_t                 bucket;
+    delta_stepping_phase   phase;
+    double*                p_distance_array;
+    double*                p_relaxed_array;
+    size_t*                p_parent_array;
+    size_t*                p_settled_bucket_array;
+    delta_stepping_worker* p_worker_array;
+} delta_stepping_context;
+
+static int index_vector_push(index_vector* p_vector, size_t value)
+{
+    size_t  new_capacity;
+    size_t* p_new_data;
+
+    if (p_vector->size == p_vector->capacity)
+    {
+        new_capacity = p_vector->capacity ? 2 * p_vector->capacity : 16;
+        p_new_data = realloc(p_vector->p_data, sizeof(size_t) * new_capacity);
+
+        if (!p_new_data) return FALSE;
+
+        p_vector->p_data   = p_new_data;
+        p_vector->capacity = new_capacity;
+    }
+
+    p_vector->p_data[p_vector->size++] = value;
+    return TRUE;
+}
+
+static int request_vector_push(request_vector* p_vector,
+                               size_t node,
+                               size_t parent,
+                               double distance)
+{
+    size_t         new_capacity;
+    relax_request* p_new_data;
+
+    if (p_vector->size == p_vector->capacity)
+    {
+        new_capacity = p_vector->capacity ? 2 * p_vector->capacity : 16;
+        p_new_data = realloc(p_vector->p_data,
+                             sizeof(relax_request) * new_capacity);
+
+        if (!p_new_data) return FALSE;
+
+        p_vector->p_data   = p_new_data;
+        p_vector->capacity = new_capacity;
+    }
+
+    p_vector->p_data[p_vector->size].node     = node;
+    p_vector->p_data[p_vector->size].parent   = parent;
+    p_vector->p_data[p_vector->size].distance = distance;
+    p_vector->size++;
+    return TRUE;
+}
+
+static size_t bucket_of(delta_stepping_context* p_context, double distance)
+{
+    return (size_t)(distance / p_context->delta);
+}
+
+static index_vector* slot_of(delta_stepping_context* p_context,
+                             delta_stepping_worker* p_worker,
+                             size_t bucket)
+{
+    return &p_worker->p_bucket_array[bucket % p_context->slots];
+}
+
+/*******************************************************************************
+* Drops the stale entries of the bucket 'bucket', that is, the nodes whose     *
+* distance has improved into an earlier bucket since they were inserted.       *
+*******************************************************************************/
+static void purge_bucket(delta_stepping_context* p_context,
+                         delta_stepping_worker* p_worker,
+                         size_t bucket)
+{
+    index_vector* p_slot = slot_of(p_context, p_worker, bucket);
+    size_t        read;
+    size_t        write = 0;
+    size_t        node;
+
+    for (read = 0; read < p_slot->size; ++read)
+    {
+        node = p_slot->p_data[read];
+
+        if (bucket_of(p_context, p_context->p_distance_array[node]) == bucket)
+        {
+            p_slot->p_data[write++] = node;
+        }
+    }
+
+    p_slot->size = write;
+}
+
+static void find_bucket(delta_stepping_context* p_context,
+                        delta_stepping_worker* p_worker)
+{
+    size_t offset;
+
+    p_worker->next_bucket = NO_BUCKET;
+
+    for (offset = 0; offset < p_context->slots; ++offset)
+    {
+        purge_bucket(p_context, p_worker, p_context->bucket + offset);
+
+        if (slot_of(p_context,
+                    p_worker,
+                    p_context->bucket + offset)->size > 0)
+        {
+            p_worker->next_bucket = p_context->bucket + offset;
+            return;
+        }
+    }
+}
+
+static void relax_arcs(delta_stepping_context* p_context,
+                       delta_stepping_worker* p_worker,
+                       size_t node,
+                       int light)
+{
+    compact_graph* p_graph = p_context->p_graph;
+    double         distance = p_context->p_distance_array[node];
+    double         weight;
+    size_t         arc;
+    size_t         head;
+
+    for (arc = p_graph->p_child_offsets[node];
+         arc < p_graph->p_child_offsets[node + 1];
+         ++arc)
+    {
+        weight = p_context->p_weight_array[arc];
+
+        if (weight == DELTA_STEPPING_INFINITY
+            || (weight <= p_context->delta) != light)
+        {
+            continue;
+        }
+
+        head = p_graph->p_child_array[arc];
+
+        if (!request_vector_push(
+                &p_worker->p_outbox_array[head / p_context->block],
+                head,
+                node,
+                distance + weight))
+        {
+            p_worker->out_of_memory = TRUE;
+        }
+    }
+}
+
+/*******************************************************************************
+* Empties the current bucket into the frontier and requests relaxations along  *
+* the light arcs of every node whose distance changed since its last visit.    *
+*******************************************************************************/
+static void relax_light(delta_stepping_context* p_context,
+                        delta_stepping_worker* p_worker)
+{
+    index_vector* p_slot = slot_of(p_context, p_worker, p_context->bucket);
+    index_vector  swap;
+    size_t        i;
+    size_t        node;
+    double        distance;
+
+    purge_bucket(p_context, p_worker, p_context->bucket);
+
+    swap = p_worker->frontier;
+    p_worker->frontier = *p_slot;
+    *p_slot = swap;
+    p_slot->size = 0;
+
+    for (i = 0; i < p_worker->frontier.size; ++i)
+    {
+        node = p_worker->frontier.p_data[i];
+        distance = p_context->p_distance_array[node];
+
+        if (p_context->p_relaxed_array[node] == distance) continue;
+
+        p_context->p_relaxed_array[node] = distance;
+
+        if (p_context->p_settled_bucket_array[node] != p_context->bucket)
+        {
+            p_context->p_settled_bucket_array[node] = p_context->bucket;
+
+            if (!index_vector_push(&p_worker->settled, node))
+            {
+                p_worker->out_of_memory = TRUE;
+            }
+        }
+
+        relax_arcs(p_context, p_worker, node, TRUE);
+    }
+
+    p_worker->frontier.size = 0;
+}
+
+static void relax_heavy(delta_stepping_context* p_context,
+                        delta_stepping_worker* p_worker)
+{
+    size_t i;
+
+    for (i = 0; i < p_worker->settled.size; ++i)
+    {
+        relax_arcs(p_context, p_worker, p_worker->settled.p_data[i], FALSE);
+    }
+
+    p_worker->settled.size = 0;
+}
+
+/*******************************************************************************
+* Applies the requests sent to the block 'owner' by all the blocks. Only the   *
+* owner of a node ever writes its distance, so no atomics are needed.          *
+*******************************************************************************/
+static void apply_requests(delta_stepping_context* p_context, size_t owner)
+{
+    delta_stepping_worker* p_worker = &p_context->p_worker_array[owner];
+    request_vector*        p_inbox;
+    relax_request*         p_request;
+    size_t                 sender;
+    size_t                 i;
+
+    for (sender = 0; sender < p_context->threads; ++sender)
+    {
+        p_inbox = &p_context->p_worker_array[sender]
+                            .p_outbox_array[owner];
+
+        for (i = 0; i < p_inbox->size; ++i)
+        {
+            p_request = &p_inbox->p_data[i];
+
+            if (p_request->distance <
+                p_context->p_distance_array[p_request->node])
+            {
+                p_context->p_distance_array[p_request->node] =
+                    p_request->distance;
+                p_context->p_parent_array[p_request->node] = p_request->parent;
+
+                if (!index_vector_push(
+                        slot_of(p_context,
+                                p_worker,
+                                bucket_of(p_context, p_request->distance)),
+                        p_request->node))
+                {
+                    p_worker->out_of_memory = TRUE;
+                }
+            }
+        }
+
+        p_inbox->size = 0;
+    }
+
+    p_worker->has_work =
+        slot_of(p_context, p_worker, p_context->bucket)->size > 0;
+}
+
+static void run_owner(delta_stepping_context* p_context, size_t owner)
+{
+    delta_stepping_worker* p_worker = &p_context->p_worker_array[owner];
+
+    switch (p_context->phase)
+    {
+        case PHASE_FIND_BUCKET:
+            find_bucket(p_context, p_worker);
+            break;
+
+        case PHASE_RELAX_LIGHT:
+            relax_light(p_context, p_worker);
+            break;
+
+        case PHASE_RELAX_HEAVY:
+            relax_heavy(p_context, p_worker);
+            break;
+
+        case PHASE_APPLY:
+            apply_requests(p_context, owner);
+            break;
+    }
+}
+
+/*******************************************************************************
+* Runs the current phase for the blocks in ['begin', 'end'). A block is run by *
+* one chunk only, so its state needs no locking.                               *
+*******************************************************************************/
+static void phase_body(size_t begin,
+                       size_t end,
+                       size_t thread_index,
+                       void* p_argument)
+{
+    size_t owner;
+
+    (void) thread_index;
+
+    for (owner = begin; owner < end; ++owner)
+    {
+        run_owner(p_argument, owner);
+    }
+}
+
+/*******************************************************************************
+* Runs a phase for every block. The return of 'parallel_for' is the barrier    *
+* between the phases.                                                          *
+*******************************************************************************/
+static void run_phase(delta_stepping_context* p_context,
+                      delta_stepping_phase phase)
+{
+    p_context->phase = phase;
+    parallel_for(0,
+                 p_context->threads,
+                 p_context->threads,
+                 phase_body,
+                 p_context);
+}
+
+static void free_workers(delta_stepping_context* p_context)
+{
+    delta_stepping_worker* p_worker;
+    size_t                 i;
+    size_t                 j;
+
+    if (!p_context->p_worker_array) return;
+
+    for (i = 0; i < p_context->threads; ++i)
+    {
+        p_worker = &p_context->p_worker_array[i];
+
+        if (p_worker->p_bucket_array)
+        {
+            for (j = 0; j < p_context->slots; ++j)
+            {
+                free(p_worker->p_bucket_array[j].p_data);
+            }
+        }
+
+        if (p_worker->p_outbox_array)
+        {
+            for (j = 0; j < p_context->threads; ++j)
+            {
+                free(p_worker->p_outbox_array[j].p_data);
+            }
+        }
+
+        free(p_worker->p_bucket_array);
+        free(p_worker->p_outbox_array);
+        free(p_worker->frontier.p_data);
+        free(p_worker->settled.p_data);
+    }
+
+    free(p_context->p_worker_array);
+}
+
+static int alloc_workers(delta_stepping_context* p_context)
+{
+    delta_stepping_worker* p_worker;
+    size_t                 i;
+
+    p_context->p_worker_array =
+        calloc(p_context->threads, sizeof(delta_stepping_worker));
+
+    if (!p_context->p_worker_array) return FALSE;
+
+    for (i = 0; i < p_context->threads; ++i)
+    {
+        p_worker = &p_context->p_worker_array[i];
+        p_worker->p_bucket_array =
+            calloc(p_context->slots, sizeof(index_vector));
+        p_worker->p_outbox_array =
+            calloc(p_context->threads, sizeof(request_vector));
+
+        if (!p_worker->p_bucket_array || !p_worker->p_outbox_array)
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+/*******************************************************************************
+* Chooses delta and the number of bucket slots. Live distances always lie in   *
+* a window of 'max_weight / delta + 2' buckets, so the buckets are kept in a   *
+* cyclic array of that many slots. Delta is raised if needed so that there    *
+* are no more slots than nodes.                                                *
+*******************************************************************************/
+static void choose_delta(delta_stepping_context* p_context, double delta)
+{
+    compact_graph* p_graph = p_context->p_graph;
+    double         max_weight = 0.0;
+    double         average_degree;
+    size_t         arc;
+
+    for (arc = 0; arc < p_graph->arcs; ++arc)
+    {
+        if (p_context->p_weight_array[arc] != DELTA_STEPPING_INFINITY
+            && p_context->p_weight_array[arc] > max_weight)
+        {
+            max_weight = p_context->p_weight_array[arc];
+        }
+    }
+
+    if (delta <= 0.0)
+    {
+        average_degree = p_graph->nodes ?
+                         (double) p_graph->arcs / p_graph->nodes : 1.0;
+        delta = max_weight / (average_degree > 1.0 ? average_degree : 1.0);
+    }
+
+    if (delta <= 0.0)
+    {
+        delta = 1.0;
+    }
+
+    if (max_weight / delta > (double) p_graph->nodes)
+    {
+        delta = max_weight / p_graph->nodes;
+    }
+
+    p_context->delta = delta;
+    p_context->slots = (size_t)(max_weight / delta) + 2;
+}
+
+delta_stepping_result* delta_stepping(compact_graph* p_graph,
+                                      double* p_weight_array,
+                                      size_t source,
+                                      double delta,
+                                      size_t threads)
+{
+    delta_stepping_context context;
+    delta_stepping_result* p_result;
+    size_t                 nodes;
+    size_t                 i;
+    size_t                 next_bucket;
+    int                    has_work;
+    int                    out_of_memory = FALSE;
+
+    if (!p_graph || !p_weight_array || source >= p_graph->nodes) return NULL;
+
+    if (threads == 0) threads = parallel_hardware_concurrency();
+
+    nodes = p_graph->nodes;
+    p_result = malloc(sizeof(*p_result));
+
+    if (!p_result) return NULL;
+
+    p_result->nodes            = nodes;
+    p_result->source           = source;
+    p_result->p_distance_array = malloc(sizeof(double) * nodes);
+    p_result->p_parent_array   = malloc(sizeof(size_t) * nodes);
+
+    context.p_graph                = p_graph;
+    context.p_weight_array         = p_weight_array;
+    context.threads                = threads < nodes ? threads : nodes;
+    context.block                  = (nodes + context.threads - 1) /
+                                     context.threads;
+    context.bucket                 = 0;
+    context.p_distance_array       = p_result->p_distance_array;
+    context.p_parent_array         = p_result->p_parent_array;
+    context.p_relaxed_array        = malloc(sizeof(double) * nodes);
+    context.p_settled_bucket_array = malloc(sizeof(size_t) * nodes);
+    context.p_worker_array         = NULL;
+
+    choose_delta(&context, delta);
+
+    if (!p_result->p_distance_array
+        || !p_result->p_parent_array
+        || !context.p_relaxed_array
+        || !context.p_settled_bucket_array
+        || !alloc_workers(&context))
+    {
+        free_workers(&context);
+        free(context.p_relaxed_array);
+        free(context.p_settled_bucket_array);
+        delta_stepping_result_free(p_result);
+        return NULL;
+    }
+
+    for (i = 0; i < nodes; ++i)
+    {
+        context.p_distance_array[i]       = DELTA_STEPPING_INFINITY;
+        context.p_relaxed_array[i]        = DELTA_STEPPING_INFINITY;
+        context.p_parent_array[i]         = nodes;
+        context.p_settled_bucket_array[i] = NO_BUCKET;
+    }
+
+    context.p_distance_array[source] = 0.0;
+    index_vector_push(
+        slot_of(&context,
+                &context.p_worker_array[source / context.block],
+                0),
+        source);
+
+    for (;;)
+    {
+        run_phase(&context, PHASE_FIND_BUCKET);
+        next_bucket = NO_BUCKET;
+
+        for (i = 0; i < context.threads; ++i)
+        {
+            if (context.p_worker_array[i].next_bucket < next_bucket)
+            {
+                next_bucket = context.p_worker_array[i].next_bucket;
+            }
+        }
+
+        if (next_bucket == NO_BUCKET) break;
+
+        context.bucket = next_bucket;
+
+        do
+        {
+            run_phase(&context, PHASE_RELAX_LIGHT);
+            run_phase(&context, PHASE_APPLY);
+            has_work = FALSE;
+
+            for (i = 0; i < context.threads; ++i)
+            {
+                has_work |= context.p_worker_array[i].has_work;
+            }
+        }
+        while (has_work);
+
+        run_phase(&context, PHASE_RELAX_HEAVY);
+        run_phase(&context, PHASE_APPLY);
+    }
+
+    for (i = 0; i < context.threads; ++i)
+    {
+        out_of_memory |= context.p_worker_array[i].out_of_memory;
+    }
+
+    free_workers(&context);
+    free(context.p_relaxed_array);
+    free(context.p_settled_bucket_array);
+
+    if (out_of_memory)
+    {
+        delta_stepping_result_free(p_result);
+        return NULL;
+    }
+
+    return p_result;
+}
+
+double* delta_stepping_weights_from_function(
+    compact_graph* p_graph,
+    directed_graph_weight_function* p_weight_function)
+{
+    double* p_weight_array;
+    double* p_weight;
+    size_t  node;
+    size_t  arc;
+
+    if (!p_graph || !p_weight_function) return NULL;
+
+    p_weight_array = malloc(sizeof(double) * (p_graph->arcs + 1));
+
+    if (!p_weight_array) return NULL;
+
+    for (node = 0; node < p_graph->nodes; ++node)
+    {
+        for (arc = p_graph->p_child_offsets[node];
+             arc < p_graph->p_child_offsets[node + 1];
+             ++arc)
+        {
+            p_weight = directed_graph_weight_function_get(
+                    p_weight_function,
+                    p_graph->p_node_array[node],
+                    p_graph->p_node_array[p_graph->p_child_array[arc]]);
+
+            p_weight_array[arc] = p_weight ? *p_weight
+                                           : DELTA_STEPPING_INFINITY;
+        }
+    }
+
+    return p_weight_array;
+}
+
+delta_stepping_result* delta_stepping_with_weight_function(
+    compact_graph* p_graph,
+    directed_graph_weight_function* p_weight_function,
+    size_t source,
+    double delta,
+    size_t threads)
+{
+    delta_stepping_result* p_result;
+    double*                p_weight_array =
+        delta_stepping_weights_from_function(p_graph, p_weight_function);
+
+    if (!p_weight_array) return NULL;
+
+    p_result = delta_stepping(p_graph, p_weight_array, source, delta, threads);
+    free(p_weight_array);
+    return p_result;
+}
+
+list* delta_stepping_result_path(delta_stepping_result* p_result,
+                                 compact_graph* p_graph,
+                                 size_t target)
+{
+    list*  p_path;
+    size_t node;
+
+    if (!p_result || !p_graph || target >= p_result->nodes) return NULL;
+
+    if (p_result->p_distance_array[target] == DELTA_STEPPING_INFINITY)
+    {
+        return NULL;
+    }
+
+    p_path = list_alloc(10);
+
+    if (!p_path) return NULL;
+
+    for (node = target; node != p_result->nodes;
+         node = p_result->p_parent_array[node])
+    {
+        list_push_front(p_path, p_graph->p_node_array[node]);
+    }
+
+    return p_path;
+}
+
+void delta_stepping_result_free(delta_stepping_result* p_result)
+{
+    if (!p_result) return;
+
+    free(p_result->p_distance_array);
+    free(p_result->p_parent_array);
+    free(p_result);
+}
+
+/* Computes the reference distances with a quadratic Dijkstra. */
+static double* reference_distances(compact_graph* p_graph,
+                                   double* p_weight_array,
+                                   size_t source)
+{
+    double* p_distance_array = malloc(sizeof(double) * p_graph->nodes);
+    char*   p_done = calloc(p_graph->nodes, 1);
+    size_t  round;
+    size_t  node;
+    size_t  best;
+    size_t  arc;
+    double  candidate;
+
+    for (node = 0; node < p_graph->nodes; ++node)
+    {
+        p_distance_array[node] = DELTA_STEPPING_INFINITY;
+    }
+
+    p_distance_array[source] = 0.0;
+
+    for (round = 0; round < p_graph->nodes; ++round)
+    {
+        best = p_graph->nodes;
+
+        for (node = 0; node < p_graph->nodes; ++node)
+        {
+            if (!p_done[node]
+                && p_distance_array[node] != DELTA_STEPPING_INFINITY
+                && (best == p_graph->nodes
+                    || p_distance_array[node] < p_distance_array[best]))
+            {
+                best = node;
+            }
+        }
+
+        if (best == p_graph->nodes) break;
+
+        p_done[best] = TRUE;
+
+        for (arc = p_graph->p_child_offsets[best];
+             arc < p_graph->p_child_offsets[best + 1];
+             ++arc)
+        {
+            candidate = p_distance_array[best] + p_weight_array[arc];
+
+            if (candidate < p_distance_array[p_graph->p_child_array[arc]])
+            {
+                p_distance_array[p_graph->p_child_array[arc]] = candidate;
+            }
+        }
+    }
+
+    free(p_done);
+    return p_distance_array;
+}
+
+static void delta_stepping_test_weight_function()
+{
+    directed_graph_node*            p_nodes[4];
+    directed_graph_weight_function* p_weight_function;
+    compact_graph*                  p_graph;
+    delta_stepping_result*          p_result;
+    list*                           p_path;
+    double*                         p_weight;
+    size_t                          i;
+
+    puts("        delta_stepping_test_weight_function()");
+
+    for (i = 0; i < 4; ++i)
+    {
+        p_nodes[i] = directed_graph_node_alloc(i);
+    }
+
+    p_weight_function =
+        directed_graph_weight_function_alloc(
+            directed_graph_node_hash_function,
+            directed_graph_nodes_equal_function);
+
+    /* 0 -> 1 -> 2 costs 3.0 while the direct arc 0 -> 2 costs 5.0. */
+    directed_graph_node_add_arc(p_nodes[0], p_nodes[1]);
+    directed_graph_node_add_arc(p_nodes[1], p_nodes[2]);
+    directed_graph_node_add_arc(p_nodes[0], p_nodes[2]);
+
+    p_weight = malloc(sizeof(double));
+    *p_weight = 1.0;
+    directed_graph_weight_function_put(p_weight_function,
+                                       p_nodes[0], p_nodes[1], p_weight);
+    p_weight = malloc(sizeof(double));
+    *p_weight = 2.0;
+    directed_graph_weight_function_put(p_weight_function,
+                                       p_nodes[1], p_nodes[2], p_weight);
+    p_weight = malloc(sizeof(double));
+    *p_weight = 5.0;
+    directed_graph_weight_function_put(p_weight_function,
+                                       p_nodes[0], p_nodes[2], p_weight);
+
+    p_graph = compact_graph_alloc(p_nodes, 4);
+    p_result = delta_stepping_with_weight_function(p_graph,
+                                                   p_weight_function,
+                                                   0,
+                                                   1.5,
+                                                   1);
+
+    ASSERT(p_result->p_distance_array[0] == 0.0);
+    ASSERT(p_result->p_distance_array[1] == 1.0);
+    ASSERT(p_result->p_distance_array[2] == 3.0);
+    ASSERT(p_result->p_distance_array[3] == DELTA_STEPPING_INFINITY);
+
+    p_path = delta_stepping_result_path(p_result, p_graph, 2);
+
+    ASSERT(list_size(p_path) == 3);
+    ASSERT(list_get(p_path, 0) == p_nodes[0]);
+    ASSERT(list_get(p_path, 1) == p_nodes[1]);
+    ASSERT(list_get(p_path, 2) == p_nodes[2]);
+    ASSERT(delta_stepping_result_path(p_result, p_graph, 3) == NULL);
+
+    list_free(p_path);
+    delta_stepping_result_free(p_result);
+    compact_graph_free(p_graph);
+    directed_graph_weight_function_free(p_weight_function);
+
+    for (i = 0; i < 4; ++i)
+    {
+        directed_graph_node_free(p_nodes[i]);
+    }
+}
+
+static void delta_stepping_test_random()
+{
+    const size_t           nodes = 500;
+    const double           deltas[] = { 0.0, 0.5, 3.0, 100.0 };
+    directed_graph_node**  p_nodes;
+    compact_graph*         p_graph;
+    delta_stepping_result* p_result;
+    double*                p_weight_array;
+    double*                p_expected;
+    size_t                 i;
+    size_t                 d;
+    size_t                 threads;
+    int                    all_equal;
+
+    puts("        delta_stepping_test_random()");
+
+    p_nodes = malloc(sizeof(directed_graph_node*) * nodes);
+
+    for (i = 0; i < nodes; ++i)
+    {
+        p_nodes[i] = directed_graph_node_alloc(i);
+    }
+
+    for (i = 0; i < 4 * nodes; ++i)
+    {
+        directed_graph_node_add_arc(p_nodes[rand() % nodes],
+                                    p_nodes[rand() % nodes]);
+    }
+
+    p_graph = compact_graph_alloc(p_nodes, nodes);
+    p_weight_array = malloc(sizeof(double) * p_graph->arcs);
+
+    for (i = 0; i < p_graph->arcs; ++i)
+    {
+        /* Small integers keep the sums exact. */
+        p_weight_array[i] = (double)(rand() % 10);
+    }
+
+    p_expected = reference_distances(p_graph, p_weight_array, 0);
+
+    for (threads = 1; threads <= 4; ++threads)
+    {
+        for (d = 0; d < sizeof(deltas) / sizeof(deltas[0]); ++d)
+        {
+            p_result = delta_stepping(p_graph,
+                                      p_weight_array,
+                                      0,
+                                      deltas[d],
+                                      threads);
+            all_equal = TRUE;
+
+            for (i = 0; i < nodes; ++i)
+            {
+                if (p_result->p_distance_array[i] != p_expected[i])
+                {
+                    all_equal = FALSE;
+                }
+            }
+
+            ASSERT(all_equal);
+            delta_stepping_result_free(p_result);
+        }
+    }
+
+    free(p_expected);
+    free(p_weight_array);
+    compact_graph_free(p_graph);
+
+    for (i = 0; i < nodes; ++i)
+    {
+        directed_graph_node_free(p_nodes[i]);
+    }
+
+    free(p_nodes);
+}
+
+void delta_stepping_test()
+{
+    puts("    delta_stepping_test()");
+    delta_stepping_test_weight_function();
+    delta_stepping_test_random();
+}
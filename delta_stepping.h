@@ -0,0 +1,83 @@
+#ifndef DELTA_STEPPING_H
+#define DELTA_STEPPING_H
+
+#include "compact_graph.h"
+#include "directed_graph_weight_function.h"
+#include "list.h"
+#include <float.h>
+#include <stddef.h>
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * Holds the single-source shortest path tree. Unreachable nodes have the   *
+    * distance DELTA_STEPPING_INFINITY and the parent 'nodes'.                 *
+    ***************************************************************************/
+    typedef struct delta_stepping_result {
+        size_t  nodes;
+        size_t  source;
+        double* p_distance_array;
+        size_t* p_parent_array;
+    } delta_stepping_result;
+
+#define DELTA_STEPPING_INFINITY DBL_MAX
+
+    /***************************************************************************
+    * Returns a flat weight array aligned with 'p_graph->p_child_array'. The   *
+    * weight function must map each arc to a pointer to a 'double'; arcs       *
+    * without a weight get DELTA_STEPPING_INFINITY and are never relaxed.      *
+    ***************************************************************************/
+    double* delta_stepping_weights_from_function(
+        compact_graph* p_graph,
+        directed_graph_weight_function* p_weight_function);
+
+    /***************************************************************************
+    * Computes the shortest paths from the node with index 'source' using      *
+    * delta-stepping. 'p_weight_array' holds a non-negative weight for each    *
+    * arc of 'p_graph'. Arcs no heavier than 'delta' are relaxed in repeated   *
+    * light phases, the rest once per bucket. If 'delta' is not positive, it   *
+    * is chosen from the maximum weight and the average degree. The nodes are  *
+    * split into 'threads' contiguous blocks, each owning the buckets of its   *
+    * nodes, and every phase runs over the blocks with 'parallel_for' on at    *
+    * most 'threads' threads. If 'threads' is zero, the hardware concurrency   *
+    * is used.                                                                 *
+    ***************************************************************************/
+    delta_stepping_result* delta_stepping(compact_graph* p_graph,
+                                          double* p_weight_array,
+                                          size_t source,
+                                          double delta,
+                                          size_t threads);
+
+    /***************************************************************************
+    * Same as 'delta_stepping' but reads the weights from a weight function.   *
+    ***************************************************************************/
+    delta_stepping_result* delta_stepping_with_weight_function(
+        compact_graph* p_graph,
+        directed_graph_weight_function* p_weight_function,
+        size_t source,
+        double delta,
+        size_t threads);
+
+    /***************************************************************************
+    * Returns the list of nodes on the shortest path from the source to the    *
+    * node with index 'target', or NULL if the target is unreachable.          *
+    ***************************************************************************/
+    list* delta_stepping_result_path(delta_stepping_result* p_result,
+                                     compact_graph* p_graph,
+                                     size_t target);
+
+    /***************************************************************************
+    * Deallocates the result.                                                  *
+    ***************************************************************************/
+    void delta_stepping_result_free(delta_stepping_result* p_result);
+
+    /* Contains the unit tests. */
+    void delta_stepping_test();
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif  /* DELTA_STEPPING_H */
@@ -1,4 +1,5 @@
 #define _CRT_SECURE_NO_WARNINGS
+#include "allocation.h"
 #include "directed_graph_node.h"
 #include "my_assert.h"
 #include "unordered_set.h"
@@ -65,7 +66,8 @@ void directed_graph_node_init(directed_graph_node* p_node,
 
 directed_graph_node* directed_graph_node_alloc(int id)
 {
-    directed_graph_node* p_node = malloc(sizeof(*p_node));
+    directed_graph_node* p_node = allocation_alloc(ALLOCATION_GRAPH,
+                                                   sizeof(*p_node));
 
     if (!p_node)
     {
@@ -191,7 +193,35 @@ void directed_graph_node_destruct(directed_graph_node* p_node)
 void directed_graph_node_free(directed_graph_node* p_node)
 {
     directed_graph_node_destruct(p_node);
-    free(p_node);
+    allocation_free(ALLOCATION_GRAPH, p_node, sizeof(*p_node));
+}
+
+size_t directed_graph_node_memory_usage(directed_graph_node* p_node)
+{
+    if (!p_node) return 0;
+
+    /* The set structures are embedded in the node. */
+    return sizeof(*p_node)
+         + unordered_set_memory_usage(&p_node->m_child_node_set)
+         - sizeof(p_node->m_child_node_set)
+         + unordered_set_memory_usage(&p_node->m_parent_node_set)
+         - sizeof(p_node->m_parent_node_set);
+}
+
+size_t directed_graph_memory_usage(directed_graph_node** p_node_array,
+                                   size_t nodes)
+{
+    size_t bytes = 0;
+    size_t i;
+
+    if (!p_node_array) return 0;
+
+    for (i = 0; i < nodes; ++i)
+    {
+        bytes += directed_graph_node_memory_usage(p_node_array[i]);
+    }
+
+    return bytes;
 }
 
 static void directed_graph_node_test_add_arc()
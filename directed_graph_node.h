@@ -97,6 +97,18 @@ extern "C" {
 
     void directed_graph_node_destruct(directed_graph_node* p_node);
 
+    /***************************************************************************
+    * Returns the number of bytes allocated by the node and its arc sets.      *
+    ***************************************************************************/
+    size_t directed_graph_node_memory_usage(directed_graph_node* p_node);
+
+    /***************************************************************************
+    * Returns the number of bytes allocated by all the nodes of a graph. The   *
+    * node array itself is not counted.                                        *
+    ***************************************************************************/
+    size_t directed_graph_memory_usage(directed_graph_node** p_node_array,
+                                       size_t nodes);
+
 
 #ifdef  __cplusplus
 } 
@@ -0,0 +1,478 @@
+#include "directed_graph_update.h"
+#include "my_assert.h"
+#include "parallel.h"
+#include "philox.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RADIX_BITS    11
+#define RADIX_BUCKETS ((size_t) 1 << RADIX_BITS)
+
+/*******************************************************************************
+* One side of an update: the change to the child set of the tail or to the     *
+* parent set of the head.                                                      *
+*******************************************************************************/
+typedef struct half_update {
+    directed_graph_node* p_node;
+    directed_graph_node* p_other;
+    int                  operation;
+} half_update;
+
+/*******************************************************************************
+* The changes to one set, 'p_side_array[side][begin .. end - 1]'. Side 0 are   *
+* the child sets and side 1 the parent sets.                                   *
+*******************************************************************************/
+typedef struct node_group {
+    int    side;
+    size_t begin;
+    size_t end;
+} node_group;
+
+typedef struct update_context {
+    directed_graph_update* p_update_array;
+    half_update*           p_side_array[2];
+    half_update*           p_buffer_array[2];
+    size_t                 length;
+    node_group*            p_group_array;
+    size_t                 changes;
+    size_t                 failed;
+} update_context;
+
+static unordered_set* set_of(half_update* p_half, int side)
+{
+    return side == 0 ? &p_half->p_node->m_child_node_set :
+                       &p_half->p_node->m_parent_node_set;
+}
+
+/*******************************************************************************
+* Returns the node pointer as an integer for sorting.                          *
+*******************************************************************************/
+static size_t key_of(half_update* p_half)
+{
+    return (size_t)(intptr_t) p_half->p_node;
+}
+
+/*******************************************************************************
+* Sorts the half updates by node with a least significant digit radix sort,    *
+* using 'p_buffer_array' of the same length as scratch. The sort is stable, so *
+* the changes to each set stay in batch order. The keys are reduced to the     *
+* bits in which the node addresses differ. Returns the array holding the       *
+* result, which is one of the two.                                             *
+*******************************************************************************/
+static half_update* radix_sort(half_update* p_half_array,
+                               half_update* p_buffer_array,
+                               size_t length)
+{
+    size_t       p_count_array[RADIX_BUCKETS];
+    half_update* p_swap;
+    size_t       min_key = (size_t) -1;
+    size_t       differing = 0;
+    size_t       shift = 0;
+    size_t       digit;
+    size_t       sum;
+    size_t       tmp;
+    size_t       i;
+
+    for (i = 0; i < length; ++i)
+    {
+        if (min_key > key_of(&p_half_array[i]))
+        {
+            min_key = key_of(&p_half_array[i]);
+        }
+    }
+
+    for (i = 0; i < length; ++i)
+    {
+        differing |= key_of(&p_half_array[i]) - min_key;
+    }
+
+    /* Skip the low bits that are zero in every offset, such as alignment. */
+    while (differing != 0 && (differing & 1) == 0)
+    {
+        differing >>= 1;
+        shift++;
+    }
+
+    while (differing != 0)
+    {
+        memset(p_count_array, 0, sizeof(p_count_array));
+
+        for (i = 0; i < length; ++i)
+        {
+            digit = ((key_of(&p_half_array[i]) - min_key) >> shift) &
+                    (RADIX_BUCKETS - 1);
+            p_count_array[digit]++;
+        }
+
+        for (sum = 0, digit = 0; digit < RADIX_BUCKETS; ++digit)
+        {
+            tmp                  = p_count_array[digit];
+            p_count_array[digit] = sum;
+            sum                 += tmp;
+        }
+
+        for (i = 0; i < length; ++i)
+        {
+            digit = ((key_of(&p_half_array[i]) - min_key) >> shift) &
+                    (RADIX_BUCKETS - 1);
+            p_buffer_array[p_count_array[digit]++] = p_half_array[i];
+        }
+
+        p_swap         = p_half_array;
+        p_half_array   = p_buffer_array;
+        p_buffer_array = p_swap;
+        differing    >>= RADIX_BITS;
+        shift         += RADIX_BITS;
+    }
+
+    return p_half_array;
+}
+
+static void split_body(size_t begin,
+                       size_t end,
+                       size_t thread_index,
+                       void* p_argument)
+{
+    update_context*        p_context = p_argument;
+    directed_graph_update* p_update;
+    half_update*           p_child_half;
+    half_update*           p_parent_half;
+    size_t                 i;
+
+    (void) thread_index;
+
+    for (i = begin; i < end; ++i)
+    {
+        p_update      = &p_context->p_update_array[i];
+        p_child_half  = &p_context->p_side_array[0][i];
+        p_parent_half = &p_context->p_side_array[1][i];
+
+        p_child_half->p_node     = p_update->p_tail;
+        p_child_half->p_other    = p_update->p_head;
+        p_child_half->operation  = p_update->operation;
+        p_parent_half->p_node    = p_update->p_head;
+        p_parent_half->p_other   = p_update->p_tail;
+        p_parent_half->operation = p_update->operation;
+    }
+}
+
+static void sort_body(size_t begin,
+                      size_t end,
+                      size_t thread_index,
+                      void* p_argument)
+{
+    update_context* p_context = p_argument;
+    size_t          side;
+
+    (void) thread_index;
+
+    for (side = begin; side < end; ++side)
+    {
+        p_context->p_side_array[side] =
+            radix_sort(p_context->p_side_array[side],
+                       p_context->p_buffer_array[side],
+                       p_context->length);
+    }
+}
+
+/*******************************************************************************
+* Grows each set of the chunk to fit all of its additions at once.             *
+*******************************************************************************/
+static void reserve_body(size_t begin,
+                         size_t end,
+                         size_t thread_index,
+                         void* p_argument)
+{
+    update_context* p_context = p_argument;
+    node_group*     p_group;
+    half_update*    p_half_array;
+    unordered_set*  p_set;
+    size_t          additions;
+    size_t          g;
+    size_t          i;
+
+    (void) thread_index;
+
+    for (g = begin; g < end; ++g)
+    {
+        p_group      = &p_context->p_group_array[g];
+        p_half_array = p_context->p_side_array[p_group->side];
+        p_set        = set_of(&p_half_array[p_group->begin], p_group->side);
+        additions    = 0;
+
+        for (i = p_group->begin; i < p_group->end; ++i)
+        {
+            if (p_half_array[i].operation == DIRECTED_GRAPH_UPDATE_ADD)
+            {
+                additions++;
+            }
+        }
+
+        if (additions > 0
+            && !unordered_set_reserve(p_set,
+                                      unordered_set_size(p_set) + additions))
+        {
+            PARALLEL_STORE(&p_context->failed, TRUE);
+        }
+    }
+}
+
+static void apply_body(size_t begin,
+                       size_t end,
+                       size_t thread_index,
+                       void* p_argument)
+{
+    update_context* p_context = p_argument;
+    node_group*     p_group;
+    half_update*    p_half_array;
+    unordered_set*  p_set;
+    size_t          changes = 0;
+    size_t          g;
+    size_t          i;
+    int             changed;
+
+    (void) thread_index;
+
+    for (g = begin; g < end; ++g)
+    {
+        p_group      = &p_context->p_group_array[g];
+        p_half_array = p_context->p_side_array[p_group->side];
+        p_set        = set_of(&p_half_array[p_group->begin], p_group->side);
+
+        for (i = p_group->begin; i < p_group->end; ++i)
+        {
+            changed =
+                p_half_array[i].operation == DIRECTED_GRAPH_UPDATE_ADD ?
+                unordered_set_add(p_set, p_half_array[i].p_other) :
+                unordered_set_remove(p_set, p_half_array[i].p_other);
+
+            /* Each arc is counted on its child side only. */
+            if (changed && p_group->side == 0) changes++;
+        }
+    }
+
+    PARALLEL_FETCH_ADD(&p_context->changes, changes);
+}
+
+size_t directed_graph_apply_updates(directed_graph_update* p_update_array,
+                                    size_t updates,
+                                    size_t threads)
+{
+    update_context context;
+    half_update*   p_memory;
+    half_update*   p_half_array;
+    size_t         groups = 0;
+    size_t         side;
+    size_t         i;
+
+    if (!p_update_array || updates == 0) return 0;
+
+    p_memory                  = malloc(sizeof(half_update) * 4 * updates);
+    context.p_update_array    = p_update_array;
+    context.p_group_array     = malloc(sizeof(node_group) * 2 * updates);
+    context.length            = updates;
+    context.changes           = 0;
+    context.failed            = FALSE;
+
+    if (!p_memory || !context.p_group_array)
+    {
+        free(p_memory);
+        free(context.p_group_array);
+        return (size_t) -1;
+    }
+
+    context.p_side_array[0]   = p_memory;
+    context.p_side_array[1]   = p_memory + updates;
+    context.p_buffer_array[0] = p_memory + 2 * updates;
+    context.p_buffer_array[1] = p_memory + 3 * updates;
+
+    parallel_for(0, updates, threads, split_body, &context);
+    parallel_for(0, 2, threads, sort_body, &context);
+
+    for (side = 0; side < 2; ++side)
+    {
+        p_half_array = context.p_side_array[side];
+
+        for (i = 0; i < updates; ++i)
+        {
+            if (i > 0 && p_half_array[i].p_node == p_half_array[i - 1].p_node)
+            {
+                continue;
+            }
+
+            if (i > 0) context.p_group_array[groups - 1].end = i;
+
+            context.p_group_array[groups].side  = (int) side;
+            context.p_group_array[groups].begin = i;
+            groups++;
+        }
+
+        context.p_group_array[groups - 1].end = updates;
+    }
+
+    parallel_for(0, groups, threads, reserve_body, &context);
+
+    if (context.failed)
+    {
+        context.changes = (size_t) -1;
+    }
+    else
+    {
+        parallel_for(0, groups, threads, apply_body, &context);
+    }
+
+    free(p_memory);
+    free(context.p_group_array);
+    return context.changes;
+}
+
+static directed_graph_node** alloc_nodes(size_t nodes)
+{
+    directed_graph_node** p_node_array =
+        malloc(sizeof(directed_graph_node*) * nodes);
+    size_t i;
+
+    for (i = 0; i < nodes; ++i)
+    {
+        p_node_array[i] = directed_graph_node_alloc((int) i);
+    }
+
+    return p_node_array;
+}
+
+static void free_nodes(directed_graph_node** p_node_array, size_t nodes)
+{
+    size_t i;
+
+    for (i = 0; i < nodes; ++i)
+    {
+        directed_graph_node_free(p_node_array[i]);
+    }
+
+    free(p_node_array);
+}
+
+/*******************************************************************************
+* Checks that the two graphs over the same IDs have the same arcs, and that    *
+* the child and parent sets of each agree.                                     *
+*******************************************************************************/
+static int graphs_equal(directed_graph_node** p_a,
+                        directed_graph_node** p_b,
+                        size_t nodes)
+{
+    size_t i;
+    size_t j;
+    int    arc;
+
+    for (i = 0; i < nodes; ++i)
+    {
+        if (unordered_set_size(&p_a[i]->m_child_node_set) !=
+                unordered_set_size(&p_b[i]->m_child_node_set)
+            || unordered_set_size(&p_a[i]->m_parent_node_set) !=
+                unordered_set_size(&p_b[i]->m_parent_node_set))
+        {
+            return FALSE;
+        }
+
+        for (j = 0; j < nodes; ++j)
+        {
+            arc = directed_graph_node_has_arc(p_a[i], p_a[j]);
+
+            if (arc != directed_graph_node_has_arc(p_b[i], p_b[j])
+                || arc != unordered_set_contains(&p_a[j]->m_parent_node_set,
+                                                 p_a[i]))
+            {
+                return FALSE;
+            }
+        }
+    }
+
+    return TRUE;
+}
+
+static void directed_graph_update_test_batch()
+{
+    const size_t           nodes   = 60;
+    const size_t           updates = 3000;
+    directed_graph_node**  p_a     = alloc_nodes(nodes);
+    directed_graph_node**  p_b     = alloc_nodes(nodes);
+    directed_graph_update* p_update_array;
+    philox                 random;
+    size_t                 changes = 0;
+    size_t                 tail;
+    size_t                 head;
+    size_t                 i;
+    int                    operation;
+
+    puts("        directed_graph_update_test_batch()");
+
+    p_update_array = malloc(sizeof(directed_graph_update) * updates);
+    philox_init(&random, 11, 0);
+
+    /* Start both graphs from the same arcs. */
+    for (i = 0; i < 400; ++i)
+    {
+        tail = philox_below(&random, nodes);
+        head = philox_below(&random, nodes);
+        directed_graph_node_add_arc(p_a[tail], p_a[head]);
+        directed_graph_node_add_arc(p_b[tail], p_b[head]);
+    }
+
+    /* Few nodes give many repeated arcs and self-loops. */
+    for (i = 0; i < updates; ++i)
+    {
+        tail      = philox_below(&random, nodes);
+        head      = philox_below(&random, nodes);
+        operation = philox_below(&random, 3) == 0 ?
+                    DIRECTED_GRAPH_UPDATE_REMOVE :
+                    DIRECTED_GRAPH_UPDATE_ADD;
+
+        p_update_array[i].p_tail    = p_a[tail];
+        p_update_array[i].p_head    = p_a[head];
+        p_update_array[i].operation = operation;
+
+        if (operation == DIRECTED_GRAPH_UPDATE_ADD)
+        {
+            changes += directed_graph_node_add_arc(p_b[tail], p_b[head]);
+        }
+        else if (directed_graph_node_has_arc(p_b[tail], p_b[head]))
+        {
+            directed_graph_node_remove_arc(p_b[tail], p_b[head]);
+            changes++;
+        }
+    }
+
+    ASSERT(directed_graph_apply_updates(p_update_array, updates, 4) ==
+           changes);
+    ASSERT(graphs_equal(p_a, p_b, nodes));
+
+    /* Undoing the batch in one go restores the start. */
+    for (i = 0; i < updates; ++i)
+    {
+        p_update_array[i].operation = DIRECTED_GRAPH_UPDATE_REMOVE;
+    }
+
+    directed_graph_apply_updates(p_update_array, updates, 1);
+
+    for (i = 0; i < updates; ++i)
+    {
+        tail = (size_t) p_update_array[i].p_tail->m_id;
+        head = (size_t) p_update_array[i].p_head->m_id;
+        ASSERT(!directed_graph_node_has_arc(p_a[tail], p_a[head]));
+        ASSERT(!unordered_set_contains(&p_a[head]->m_parent_node_set,
+                                       p_a[tail]));
+    }
+
+    ASSERT(directed_graph_apply_updates(p_update_array, 0, 2) == 0);
+
+    free(p_update_array);
+    free_nodes(p_a, nodes);
+    free_nodes(p_b, nodes);
+}
+
+void directed_graph_update_test()
+{
+    puts("    directed_graph_update_test()");
+    directed_graph_update_test_batch();
+}
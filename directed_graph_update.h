@@ -0,0 +1,46 @@
+#ifndef DIRECTED_GRAPH_UPDATE_H
+#define DIRECTED_GRAPH_UPDATE_H
+
+#include "directed_graph_node.h"
+#include <stddef.h>
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+#define DIRECTED_GRAPH_UPDATE_ADD    0
+#define DIRECTED_GRAPH_UPDATE_REMOVE 1
+
+    /***************************************************************************
+    * Adds or removes the arc ('p_tail', 'p_head') depending on 'operation',   *
+    * which is DIRECTED_GRAPH_UPDATE_ADD or DIRECTED_GRAPH_UPDATE_REMOVE.      *
+    ***************************************************************************/
+    typedef struct directed_graph_update {
+        directed_graph_node* p_tail;
+        directed_graph_node* p_head;
+        int                  operation;
+    } directed_graph_update;
+
+    /***************************************************************************
+    * Applies a batch of updates. The child sides and the parent sides of the  *
+    * updates are sorted by node with a stable radix sort, and then each       *
+    * node's set is grown once and updated in one pass, the updates of each    *
+    * set keeping their batch order. Different nodes are updated in parallel   *
+    * by 'threads' threads, or by the hardware concurrency if it is zero, so   *
+    * no other thread may touch the nodes of the batch meanwhile. The result   *
+    * is the same as applying the updates one by one in array order. Returns   *
+    * the number of updates that changed the graph, or (size_t) -1 if the      *
+    * memory ran out before any change was made.                               *
+    ***************************************************************************/
+    size_t directed_graph_apply_updates(directed_graph_update* p_update_array,
+                                        size_t updates,
+                                        size_t threads);
+
+    /* Contains the unit tests. */
+    void directed_graph_update_test();
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif  /* DIRECTED_GRAPH_UPDATE_H */
@@ -0,0 +1,753 @@
+#include "dynamic_bfs_tree.h"
+#include "my_assert.h"
+#include "philox.h"
+#include "unordered_set.h"
+#include <stdlib.h>
+
+/*******************************************************************************
+* An affected node with the distance it can get from an unaffected parent at   *
+* the start of the second phase of a removal.                                  *
+*******************************************************************************/
+typedef struct dynamic_bfs_seed {
+    dynamic_bfs_tree_entry* p_entry;
+    size_t                  distance;
+} dynamic_bfs_seed;
+
+static dynamic_bfs_tree_entry* get_entry(dynamic_bfs_tree* p_tree,
+                                         directed_graph_node* p_node)
+{
+    return unordered_map_get(p_tree->p_entry_map, p_node);
+}
+
+/*******************************************************************************
+* Makes the scratch arrays hold at least 'size' elements.                      *
+*******************************************************************************/
+static int ensure_capacity(dynamic_bfs_tree* p_tree, size_t size)
+{
+    dynamic_bfs_tree_entry** p_affected_array;
+    dynamic_bfs_tree_entry** p_queue_array;
+    dynamic_bfs_seed*        p_seed_array;
+    size_t                   capacity = p_tree->capacity;
+
+    if (size <= capacity) return TRUE;
+
+    while (capacity < size) capacity = 2 * capacity + 16;
+
+    p_affected_array = realloc(p_tree->p_affected_array,
+                               sizeof(dynamic_bfs_tree_entry*) * capacity);
+
+    if (!p_affected_array) return FALSE;
+
+    p_tree->p_affected_array = p_affected_array;
+    p_queue_array = realloc(p_tree->p_queue_array,
+                            sizeof(dynamic_bfs_tree_entry*) * capacity);
+
+    if (!p_queue_array) return FALSE;
+
+    p_tree->p_queue_array = p_queue_array;
+    p_seed_array = realloc(p_tree->p_seed_array,
+                           sizeof(dynamic_bfs_seed) * capacity);
+
+    if (!p_seed_array) return FALSE;
+
+    p_tree->p_seed_array = p_seed_array;
+    p_tree->capacity     = capacity;
+    return TRUE;
+}
+
+static dynamic_bfs_tree_entry* add_entry(dynamic_bfs_tree* p_tree,
+                                         directed_graph_node* p_node)
+{
+    dynamic_bfs_tree_entry* p_entry = malloc(sizeof(*p_entry));
+
+    if (!p_entry) return NULL;
+
+    p_entry->p_node   = p_node;
+    p_entry->p_parent = NULL;
+    p_entry->distance = DYNAMIC_BFS_TREE_UNREACHABLE;
+    p_entry->affected = FALSE;
+    unordered_map_put(p_tree->p_entry_map, p_node, p_entry);
+
+    if (get_entry(p_tree, p_node) != p_entry)
+    {
+        free(p_entry);
+        return NULL;
+    }
+
+    return p_entry;
+}
+
+static void free_entries(dynamic_bfs_tree* p_tree)
+{
+    unordered_map_iterator iterator;
+    void*                  p_node;
+    void*                  p_entry;
+
+    unordered_map_iterator_init(p_tree->p_entry_map, &iterator);
+
+    while (unordered_map_iterator_has_next(&iterator))
+    {
+        unordered_map_iterator_next(&iterator, &p_node, &p_entry);
+        free(p_entry);
+    }
+
+    unordered_map_clear(p_tree->p_entry_map);
+}
+
+/*******************************************************************************
+* Relaxes forward from the 'queued' entries in the queue array, whose          *
+* distances are final, in breadth-first order. Returns the number of entries   *
+* lowered, or (size_t) -1 if the memory ran out.                               *
+*******************************************************************************/
+static size_t relax_forward(dynamic_bfs_tree* p_tree, size_t queued)
+{
+    unordered_set_iterator  iterator;
+    dynamic_bfs_tree_entry* p_entry;
+    dynamic_bfs_tree_entry* p_child_entry;
+    directed_graph_node*    p_child;
+    size_t                  head = 0;
+    size_t                  lowered = 0;
+
+    while (head < queued)
+    {
+        p_entry = p_tree->p_queue_array[head++];
+        unordered_set_iterator_init(&p_entry->p_node->m_child_node_set,
+                                    &iterator);
+
+        while (unordered_set_iterator_has_next(&iterator))
+        {
+            unordered_set_iterator_next(&iterator, (void**) &p_child);
+            p_child_entry = get_entry(p_tree, p_child);
+
+            if (p_child_entry &&
+                p_child_entry->distance <= p_entry->distance + 1)
+            {
+                continue;
+            }
+
+            if (!p_child_entry)
+            {
+                p_child_entry = add_entry(p_tree, p_child);
+
+                if (!p_child_entry) return (size_t) -1;
+            }
+
+            if (!ensure_capacity(p_tree, queued + 1)) return (size_t) -1;
+
+            p_child_entry->distance = p_entry->distance + 1;
+            p_child_entry->p_parent = p_entry->p_node;
+            p_tree->p_queue_array[queued++] = p_child_entry;
+            ++lowered;
+        }
+    }
+
+    return lowered;
+}
+
+dynamic_bfs_tree* dynamic_bfs_tree_alloc(directed_graph_node* p_source)
+{
+    dynamic_bfs_tree* p_tree;
+
+    if (!p_source) return NULL;
+
+    p_tree = malloc(sizeof(*p_tree));
+
+    if (!p_tree) return NULL;
+
+    p_tree->p_source         = p_source;
+    p_tree->p_affected_array = NULL;
+    p_tree->p_queue_array    = NULL;
+    p_tree->p_seed_array     = NULL;
+    p_tree->capacity         = 0;
+    p_tree->p_entry_map      = unordered_map_alloc(
+                                   16,
+                                   1.0f,
+                                   directed_graph_node_hash_function,
+                                   directed_graph_nodes_equal_function);
+
+    if (!p_tree->p_entry_map || !dynamic_bfs_tree_rebuild(p_tree))
+    {
+        dynamic_bfs_tree_free(p_tree);
+        return NULL;
+    }
+
+    return p_tree;
+}
+
+int dynamic_bfs_tree_rebuild(dynamic_bfs_tree* p_tree)
+{
+    dynamic_bfs_tree_entry* p_entry;
+
+    free_entries(p_tree);
+    p_entry = add_entry(p_tree, p_tree->p_source);
+
+    if (!p_entry || !ensure_capacity(p_tree, 1)) return FALSE;
+
+    p_entry->distance        = 0;
+    p_tree->p_queue_array[0] = p_entry;
+    return relax_forward(p_tree, 1) != (size_t) -1;
+}
+
+size_t dynamic_bfs_tree_distance(dynamic_bfs_tree* p_tree,
+                                 directed_graph_node* p_node)
+{
+    dynamic_bfs_tree_entry* p_entry = get_entry(p_tree, p_node);
+
+    return p_entry ? p_entry->distance : DYNAMIC_BFS_TREE_UNREACHABLE;
+}
+
+directed_graph_node* dynamic_bfs_tree_parent(dynamic_bfs_tree* p_tree,
+                                             directed_graph_node* p_node)
+{
+    dynamic_bfs_tree_entry* p_entry = get_entry(p_tree, p_node);
+
+    return p_entry ? p_entry->p_parent : NULL;
+}
+
+list* dynamic_bfs_tree_path(dynamic_bfs_tree* p_tree,
+                            directed_graph_node* p_target)
+{
+    dynamic_bfs_tree_entry* p_entry = get_entry(p_tree, p_target);
+    list*                   p_path;
+
+    if (!p_entry) return NULL;
+
+    p_path = list_alloc(p_entry->distance + 1);
+
+    while (p_entry)
+    {
+        list_push_front(p_path, p_entry->p_node);
+        p_entry = p_entry->p_parent ? get_entry(p_tree, p_entry->p_parent)
+                                    : NULL;
+    }
+
+    return p_path;
+}
+
+size_t dynamic_bfs_tree_arc_added(dynamic_bfs_tree* p_tree,
+                                  directed_graph_node* p_tail,
+                                  directed_graph_node* p_head)
+{
+    dynamic_bfs_tree_entry* p_tail_entry = get_entry(p_tree, p_tail);
+    dynamic_bfs_tree_entry* p_head_entry = get_entry(p_tree, p_head);
+    size_t                  lowered;
+
+    if (!p_tail_entry) return 0;
+
+    if (p_head_entry && p_head_entry->distance <= p_tail_entry->distance + 1)
+    {
+        return 0;
+    }
+
+    if (!p_head_entry)
+    {
+        p_head_entry = add_entry(p_tree, p_head);
+
+        if (!p_head_entry) return (size_t) -1;
+    }
+
+    if (!ensure_capacity(p_tree, 1)) return (size_t) -1;
+
+    p_head_entry->distance   = p_tail_entry->distance + 1;
+    p_head_entry->p_parent   = p_tail;
+    p_tree->p_queue_array[0] = p_head_entry;
+    lowered = relax_forward(p_tree, 1);
+    return lowered == (size_t) -1 ? lowered : lowered + 1;
+}
+
+/*******************************************************************************
+* Looks for a parent of the entry that is one level up and not affected, and   *
+* makes it the tree parent. Returns false if there is none.                    *
+*******************************************************************************/
+static int reparent(dynamic_bfs_tree* p_tree, dynamic_bfs_tree_entry* p_entry)
+{
+    unordered_set_iterator  iterator;
+    dynamic_bfs_tree_entry* p_parent_entry;
+    directed_graph_node*    p_parent;
+
+    unordered_set_iterator_init(&p_entry->p_node->m_parent_node_set,
+                                &iterator);
+
+    while (unordered_set_iterator_has_next(&iterator))
+    {
+        unordered_set_iterator_next(&iterator, (void**) &p_parent);
+        p_parent_entry = get_entry(p_tree, p_parent);
+
+        if (p_parent_entry &&
+            !p_parent_entry->affected &&
+            p_parent_entry->distance + 1 == p_entry->distance)
+        {
+            p_entry->p_parent = p_parent;
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+static int compare_seeds(const void* p_a, const void* p_b)
+{
+    size_t a = ((const dynamic_bfs_seed*) p_a)->distance;
+    size_t b = ((const dynamic_bfs_seed*) p_b)->distance;
+
+    return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+/*******************************************************************************
+* Collects the affected subtree below 'p_head_entry' level by level. A node    *
+* is affected if none of its parents one level up is unaffected. The tree      *
+* children of the affected nodes are the candidates of the next level, and     *
+* since the affected array is filled in level order, the whole previous level  *
+* is settled by the time a candidate is checked. Returns the number of         *
+* affected nodes, or (size_t) -1 if the memory ran out.                        *
+*******************************************************************************/
+static size_t collect_affected(dynamic_bfs_tree* p_tree,
+                               dynamic_bfs_tree_entry* p_head_entry)
+{
+    unordered_set_iterator  iterator;
+    dynamic_bfs_tree_entry* p_entry;
+    dynamic_bfs_tree_entry* p_child_entry;
+    directed_graph_node*    p_child;
+    size_t                  affected = 0;
+    size_t                  i;
+
+    if (reparent(p_tree, p_head_entry)) return 0;
+    if (!ensure_capacity(p_tree, 1))    return (size_t) -1;
+
+    p_head_entry->affected = TRUE;
+    p_tree->p_affected_array[affected++] = p_head_entry;
+
+    for (i = 0; i < affected; ++i)
+    {
+        p_entry = p_tree->p_affected_array[i];
+        unordered_set_iterator_init(&p_entry->p_node->m_child_node_set,
+                                    &iterator);
+
+        while (unordered_set_iterator_has_next(&iterator))
+        {
+            unordered_set_iterator_next(&iterator, (void**) &p_child);
+            p_child_entry = get_entry(p_tree, p_child);
+
+            if (!p_child_entry ||
+                p_child_entry->affected ||
+                p_child_entry->p_parent != p_entry->p_node ||
+                reparent(p_tree, p_child_entry))
+            {
+                continue;
+            }
+
+            if (!ensure_capacity(p_tree, affected + 1))
+            {
+                affected = (size_t) -1;
+                break;
+            }
+
+            p_child_entry->affected = TRUE;
+            p_tree->p_affected_array[affected++] = p_child_entry;
+        }
+
+        if (affected == (size_t) -1) break;
+    }
+
+    return affected;
+}
+
+/*******************************************************************************
+* Gives the affected nodes their new distances. Each starts from its best      *
+* unaffected parent; those seeds are sorted by distance and merged with a      *
+* FIFO queue of the nodes lowered through other affected nodes, which is       *
+* nondecreasing too, so every node is settled at its final distance. The nodes *
+* never settled are no longer reachable and lose their entries.                *
+*******************************************************************************/
+static void settle_affected(dynamic_bfs_tree* p_tree, size_t affected)
+{
+    unordered_set_iterator  iterator;
+    dynamic_bfs_tree_entry* p_entry;
+    dynamic_bfs_tree_entry* p_other_entry;
+    directed_graph_node*    p_other;
+    dynamic_bfs_seed*       p_seed_array = p_tree->p_seed_array;
+    size_t                  seeds = 0;
+    size_t                  seed = 0;
+    size_t                  head = 0;
+    size_t                  tail = 0;
+    size_t                  i;
+
+    for (i = 0; i < affected; ++i)
+    {
+        p_entry           = p_tree->p_affected_array[i];
+        p_entry->distance = DYNAMIC_BFS_TREE_UNREACHABLE;
+        p_entry->p_parent = NULL;
+        unordered_set_iterator_init(&p_entry->p_node->m_parent_node_set,
+                                    &iterator);
+
+        while (unordered_set_iterator_has_next(&iterator))
+        {
+            unordered_set_iterator_next(&iterator, (void**) &p_other);
+            p_other_entry = get_entry(p_tree, p_other);
+
+            if (p_other_entry &&
+                !p_other_entry->affected &&
+                p_other_entry->distance + 1 < p_entry->distance)
+            {
+                p_entry->distance = p_other_entry->distance + 1;
+                p_entry->p_parent = p_other;
+            }
+        }
+
+        if (p_entry->p_parent)
+        {
+            p_seed_array[seeds].p_entry  = p_entry;
+            p_seed_array[seeds].distance = p_entry->distance;
+            ++seeds;
+        }
+    }
+
+    qsort(p_seed_array, seeds, sizeof(dynamic_bfs_seed), compare_seeds);
+
+    while (seed < seeds || head < tail)
+    {
+        if (head == tail ||
+            (seed < seeds &&
+             p_seed_array[seed].distance <
+             p_tree->p_queue_array[head]->distance))
+        {
+            p_entry = p_seed_array[seed++].p_entry;
+        }
+        else
+        {
+            p_entry = p_tree->p_queue_array[head++];
+        }
+
+        /* A node lowered after seeding was settled from the queue. */
+        if (!p_entry->affected) continue;
+
+        p_entry->affected = FALSE;
+        unordered_set_iterator_init(&p_entry->p_node->m_child_node_set,
+                                    &iterator);
+
+        while (unordered_set_iterator_has_next(&iterator))
+        {
+            unordered_set_iterator_next(&iterator, (void**) &p_other);
+            p_other_entry = get_entry(p_tree, p_other);
+
+            if (p_other_entry &&
+                p_other_entry->affected &&
+                p_entry->distance + 1 < p_other_entry->distance)
+            {
+                /* The settled distances never go down, so each node enters
+                   the queue at most once. */
+                p_other_entry->distance = p_entry->distance + 1;
+                p_other_entry->p_parent = p_entry->p_node;
+                p_tree->p_queue_array[tail++] = p_other_entry;
+            }
+        }
+    }
+
+    for (i = 0; i < affected; ++i)
+    {
+        p_entry = p_tree->p_affected_array[i];
+
+        if (p_entry->affected)
+        {
+            unordered_map_remove(p_tree->p_entry_map, p_entry->p_node);
+            free(p_entry);
+        }
+    }
+}
+
+size_t dynamic_bfs_tree_arc_removed(dynamic_bfs_tree* p_tree,
+                                    directed_graph_node* p_tail,
+                                    directed_graph_node* p_head)
+{
+    dynamic_bfs_tree_entry* p_head_entry = get_entry(p_tree, p_head);
+    size_t                  affected;
+
+    /* Only the removal of a tree arc changes anything. */
+    if (!p_head_entry || p_head_entry->p_parent != p_tail) return 0;
+
+    affected = collect_affected(p_tree, p_head_entry);
+
+    if (affected == (size_t) -1) return affected;
+
+    settle_affected(p_tree, affected);
+    return affected;
+}
+
+int dynamic_bfs_tree_add_arc(dynamic_bfs_tree** p_tree_array,
+                             size_t trees,
+                             directed_graph_node* p_tail,
+                             directed_graph_node* p_head)
+{
+    size_t i;
+
+    if (!directed_graph_node_add_arc(p_tail, p_head)) return FALSE;
+
+    for (i = 0; i < trees; ++i)
+    {
+        if (dynamic_bfs_tree_arc_added(p_tree_array[i], p_tail, p_head)
+            == (size_t) -1)
+        {
+            dynamic_bfs_tree_rebuild(p_tree_array[i]);
+        }
+    }
+
+    return TRUE;
+}
+
+int dynamic_bfs_tree_remove_arc(dynamic_bfs_tree** p_tree_array,
+                                size_t trees,
+                                directed_graph_node* p_tail,
+                                directed_graph_node* p_head)
+{
+    size_t i;
+
+    if (!directed_graph_node_remove_arc(p_tail, p_head)) return FALSE;
+
+    for (i = 0; i < trees; ++i)
+    {
+        if (dynamic_bfs_tree_arc_removed(p_tree_array[i], p_tail, p_head)
+            == (size_t) -1)
+        {
+            dynamic_bfs_tree_rebuild(p_tree_array[i]);
+        }
+    }
+
+    return TRUE;
+}
+
+void dynamic_bfs_tree_free(dynamic_bfs_tree* p_tree)
+{
+    if (!p_tree) return;
+
+    if (p_tree->p_entry_map)
+    {
+        free_entries(p_tree);
+        unordered_map_free(&p_tree->p_entry_map);
+    }
+
+    free(p_tree->p_affected_array);
+    free(p_tree->p_queue_array);
+    free(p_tree->p_seed_array);
+    free(p_tree);
+}
+
+static directed_graph_node** alloc_nodes(size_t nodes)
+{
+    directed_graph_node** p_node_array =
+        malloc(sizeof(directed_graph_node*) * nodes);
+    size_t i;
+
+    for (i = 0; i < nodes; ++i)
+    {
+        p_node_array[i] = directed_graph_node_alloc((int) i);
+    }
+
+    return p_node_array;
+}
+
+static void free_nodes(directed_graph_node** p_node_array, size_t nodes)
+{
+    size_t i;
+
+    for (i = 0; i < nodes; ++i)
+    {
+        directed_graph_node_free(p_node_array[i]);
+    }
+
+    free(p_node_array);
+}
+
+/*******************************************************************************
+* Checks the tree against one computed from scratch: the distances must agree, *
+* and each tree parent must be a real parent one level up.                     *
+*******************************************************************************/
+static int tree_is_exact(dynamic_bfs_tree* p_tree,
+                         directed_graph_node** p_node_array,
+                         size_t nodes)
+{
+    dynamic_bfs_tree*       p_expected = dynamic_bfs_tree_alloc(
+                                             p_tree->p_source);
+    dynamic_bfs_tree_entry* p_entry;
+    directed_graph_node*    p_parent;
+    size_t                  i;
+    int                     exact = TRUE;
+
+    for (i = 0; i < nodes && exact; ++i)
+    {
+        p_entry = unordered_map_get(p_tree->p_entry_map, p_node_array[i]);
+
+        if (dynamic_bfs_tree_distance(p_tree, p_node_array[i]) !=
+            dynamic_bfs_tree_distance(p_expected, p_node_array[i]))
+        {
+            exact = FALSE;
+        }
+        else if (p_entry && p_entry->affected)
+        {
+            exact = FALSE;
+        }
+        else if (p_entry && p_node_array[i] != p_tree->p_source)
+        {
+            p_parent = p_entry->p_parent;
+            exact = p_parent &&
+                    directed_graph_node_has_arc(p_parent, p_node_array[i]) &&
+                    dynamic_bfs_tree_distance(p_tree, p_parent) + 1 ==
+                    p_entry->distance;
+        }
+    }
+
+    exact = exact && unordered_map_size(p_tree->p_entry_map) ==
+                     unordered_map_size(p_expected->p_entry_map);
+    dynamic_bfs_tree_free(p_expected);
+    return exact;
+}
+
+static void dynamic_bfs_tree_test_chain()
+{
+    directed_graph_node** p_node_array = alloc_nodes(6);
+    dynamic_bfs_tree*     p_tree;
+    list*                 p_path;
+    size_t                i;
+
+    puts("        dynamic_bfs_tree_test_chain()");
+
+    for (i = 0; i < 5; ++i)
+    {
+        directed_graph_node_add_arc(p_node_array[i], p_node_array[i + 1]);
+    }
+
+    p_tree = dynamic_bfs_tree_alloc(p_node_array[0]);
+    ASSERT(dynamic_bfs_tree_distance(p_tree, p_node_array[5]) == 5);
+    ASSERT(dynamic_bfs_tree_parent(p_tree, p_node_array[0]) == NULL);
+
+    /* A shortcut lowers the whole tail of the chain. */
+    ASSERT(dynamic_bfs_tree_add_arc(&p_tree,
+                                    1,
+                                    p_node_array[0],
+                                    p_node_array[3]));
+    ASSERT(dynamic_bfs_tree_distance(p_tree, p_node_array[5]) == 3);
+    ASSERT(dynamic_bfs_tree_parent(p_tree, p_node_array[3]) ==
+           p_node_array[0]);
+
+    p_path = dynamic_bfs_tree_path(p_tree, p_node_array[5]);
+    ASSERT(list_size(p_path) == 4);
+    ASSERT(list_get(p_path, 0) == p_node_array[0]);
+    ASSERT(list_get(p_path, 1) == p_node_array[3]);
+    list_free(p_path);
+
+    /* Nothing hangs from the arc (2, 3) any more. */
+    ASSERT(dynamic_bfs_tree_arc_removed(p_tree,
+                                        p_node_array[2],
+                                        p_node_array[3]) == 0);
+
+    /* Removing the shortcut falls back on the chain. */
+    ASSERT(dynamic_bfs_tree_remove_arc(&p_tree,
+                                       1,
+                                       p_node_array[0],
+                                       p_node_array[3]));
+    ASSERT(dynamic_bfs_tree_distance(p_tree, p_node_array[5]) == 5);
+
+    /* Cutting the chain strands its tail. */
+    ASSERT(dynamic_bfs_tree_remove_arc(&p_tree,
+                                       1,
+                                       p_node_array[1],
+                                       p_node_array[2]));
+    ASSERT(dynamic_bfs_tree_distance(p_tree, p_node_array[1]) == 1);
+    ASSERT(dynamic_bfs_tree_distance(p_tree, p_node_array[4]) ==
+           DYNAMIC_BFS_TREE_UNREACHABLE);
+    ASSERT(dynamic_bfs_tree_path(p_tree, p_node_array[4]) == NULL);
+    ASSERT(unordered_map_size(p_tree->p_entry_map) == 2);
+    ASSERT(tree_is_exact(p_tree, p_node_array, 6));
+
+    dynamic_bfs_tree_free(p_tree);
+    free_nodes(p_node_array, 6);
+}
+
+static void dynamic_bfs_tree_test_random()
+{
+    const size_t          nodes = 200;
+    const size_t          trees = 4;
+    directed_graph_node** p_node_array = alloc_nodes(nodes);
+    dynamic_bfs_tree*     p_tree_array[4];
+    philox                random;
+    size_t                tail;
+    size_t                head;
+    size_t                i;
+    size_t                t;
+    int                   exact = TRUE;
+
+    puts("        dynamic_bfs_tree_test_random()");
+
+    philox_init(&random, 19, 0);
+
+    for (i = 0; i < 600; ++i)
+    {
+        directed_graph_node_add_arc(
+            p_node_array[philox_below(&random, nodes)],
+            p_node_array[philox_below(&random, nodes)]);
+    }
+
+    for (t = 0; t < trees; ++t)
+    {
+        p_tree_array[t] = dynamic_bfs_tree_alloc(p_node_array[t * 7]);
+    }
+
+    /* Sparse updates keep disconnecting and reconnecting parts. */
+    for (i = 0; i < 4000; ++i)
+    {
+        tail = philox_below(&random, nodes);
+        head = philox_below(&random, nodes);
+
+        if (philox_below(&random, 2) == 0)
+        {
+            dynamic_bfs_tree_add_arc(p_tree_array,
+                                     trees,
+                                     p_node_array[tail],
+                                     p_node_array[head]);
+        }
+        else
+        {
+            /* Remove a random arc out of 'tail' if it has one. */
+            unordered_set_iterator iterator;
+            directed_graph_node*   p_child;
+
+            unordered_set_iterator_init(
+                &p_node_array[tail]->m_child_node_set,
+                &iterator);
+
+            if (unordered_set_iterator_has_next(&iterator))
+            {
+                unordered_set_iterator_next(&iterator, (void**) &p_child);
+                dynamic_bfs_tree_remove_arc(p_tree_array,
+                                            trees,
+                                            p_node_array[tail],
+                                            p_child);
+            }
+        }
+
+        if (i % 50 == 0)
+        {
+            for (t = 0; t < trees; ++t)
+            {
+                exact = exact &&
+                        tree_is_exact(p_tree_array[t], p_node_array, nodes);
+            }
+        }
+    }
+
+    ASSERT(exact);
+
+    for (t = 0; t < trees; ++t)
+    {
+        ASSERT(tree_is_exact(p_tree_array[t], p_node_array, nodes));
+        dynamic_bfs_tree_free(p_tree_array[t]);
+    }
+
+    free_nodes(p_node_array, nodes);
+}
+
+void dynamic_bfs_tree_test()
+{
+    puts("    dynamic_bfs_tree_test()");
+    dynamic_bfs_tree_test_chain();
+    dynamic_bfs_tree_test_random();
+}
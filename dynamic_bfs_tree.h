@@ -0,0 +1,129 @@
+#ifndef DYNAMIC_BFS_TREE_H
+#define DYNAMIC_BFS_TREE_H
+
+#include "directed_graph_node.h"
+#include "list.h"
+#include "unordered_map.h"
+#include <stddef.h>
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * The distance of the nodes not reachable from the source.                 *
+    ***************************************************************************/
+#define DYNAMIC_BFS_TREE_UNREACHABLE ((size_t) -1)
+
+    /***************************************************************************
+    * The hop distance and the tree parent of a node reached from the source.  *
+    * 'affected' is only set while the tree is being repaired.                 *
+    ***************************************************************************/
+    typedef struct dynamic_bfs_tree_entry {
+        directed_graph_node* p_node;
+        directed_graph_node* p_parent;
+        size_t               distance;
+        int                  affected;
+    } dynamic_bfs_tree_entry;
+
+    /***************************************************************************
+    * A breadth-first search tree rooted at 'p_source' that is kept up to date *
+    * as arcs come and go. An arc insertion relaxes forward from its head. An  *
+    * arc removal follows Ramalingam and Reps: only the subtree hanging from   *
+    * the removed tree arc is examined, the nodes of it with another parent    *
+    * one level up keep their distance, and the rest get new distances from    *
+    * the unaffected nodes by a two-queue breadth-first pass. 'p_entry_map'    *
+    * maps each reached node to its entry. The arrays are scratch space kept   *
+    * between repairs.                                                         *
+    ***************************************************************************/
+    typedef struct dynamic_bfs_tree {
+        directed_graph_node*     p_source;
+        unordered_map*           p_entry_map;
+        dynamic_bfs_tree_entry** p_affected_array;
+        dynamic_bfs_tree_entry** p_queue_array;
+        struct dynamic_bfs_seed* p_seed_array;
+        size_t                   capacity;
+    } dynamic_bfs_tree;
+
+    /***************************************************************************
+    * Allocates the tree of 'p_source' and fills it with a breadth-first       *
+    * search. Returns NULL if the memory ran out.                              *
+    ***************************************************************************/
+    dynamic_bfs_tree* dynamic_bfs_tree_alloc(directed_graph_node* p_source);
+
+    /***************************************************************************
+    * Recomputes the whole tree from scratch. Returns false if the memory ran  *
+    * out.                                                                     *
+    ***************************************************************************/
+    int dynamic_bfs_tree_rebuild(dynamic_bfs_tree* p_tree);
+
+    /***************************************************************************
+    * Returns the hop distance from the source to 'p_node', or                 *
+    * DYNAMIC_BFS_TREE_UNREACHABLE.                                            *
+    ***************************************************************************/
+    size_t dynamic_bfs_tree_distance(dynamic_bfs_tree* p_tree,
+                                     directed_graph_node* p_node);
+
+    /***************************************************************************
+    * Returns the tree parent of 'p_node', or NULL for the source and the      *
+    * unreachable nodes.                                                       *
+    ***************************************************************************/
+    directed_graph_node* dynamic_bfs_tree_parent(dynamic_bfs_tree* p_tree,
+                                                 directed_graph_node* p_node);
+
+    /***************************************************************************
+    * Returns the tree path from the source to 'p_target', or NULL if the      *
+    * target is not reachable.                                                 *
+    ***************************************************************************/
+    list* dynamic_bfs_tree_path(dynamic_bfs_tree* p_tree,
+                                directed_graph_node* p_target);
+
+    /***************************************************************************
+    * Repairs the tree after the arc ('p_tail', 'p_head') was added to the     *
+    * graph. Returns the number of nodes whose distance went down, or          *
+    * (size_t) -1 if the memory ran out; rebuild the tree then.                *
+    ***************************************************************************/
+    size_t dynamic_bfs_tree_arc_added(dynamic_bfs_tree* p_tree,
+                                      directed_graph_node* p_tail,
+                                      directed_graph_node* p_head);
+
+    /***************************************************************************
+    * Repairs the tree after the arc ('p_tail', 'p_head') was removed from the *
+    * graph. Returns the number of nodes whose distance was recomputed, or     *
+    * (size_t) -1 if the memory ran out; rebuild the tree then.                *
+    ***************************************************************************/
+    size_t dynamic_bfs_tree_arc_removed(dynamic_bfs_tree* p_tree,
+                                        directed_graph_node* p_tail,
+                                        directed_graph_node* p_head);
+
+    /***************************************************************************
+    * Adds the arc to the graph and repairs each of the 'trees' trees in       *
+    * 'p_tree_array'. Returns the value of 'directed_graph_node_add_arc'.      *
+    ***************************************************************************/
+    int dynamic_bfs_tree_add_arc(dynamic_bfs_tree** p_tree_array,
+                                 size_t trees,
+                                 directed_graph_node* p_tail,
+                                 directed_graph_node* p_head);
+
+    /***************************************************************************
+    * Removes the arc from the graph and repairs each of the trees. Returns    *
+    * the value of 'directed_graph_node_remove_arc'.                           *
+    ***************************************************************************/
+    int dynamic_bfs_tree_remove_arc(dynamic_bfs_tree** p_tree_array,
+                                    size_t trees,
+                                    directed_graph_node* p_tail,
+                                    directed_graph_node* p_head);
+
+    /***************************************************************************
+    * Deallocates the tree.                                                    *
+    ***************************************************************************/
+    void dynamic_bfs_tree_free(dynamic_bfs_tree* p_tree);
+
+    /* Contains the unit tests. */
+    void dynamic_bfs_tree_test();
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif  /* DYNAMIC_BFS_TREE_H */
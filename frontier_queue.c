@@ -0,0 +1,516 @@
+#include "allocation.h"
+#include "frontier_queue.h"
+#include "my_assert.h"
+#include "parallel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FALSE 0
+#define TRUE 1
+
+/*******************************************************************************
+* A cell is a sequence number, a length and 'block' words.                     *
+*******************************************************************************/
+static size_t* cell_at(frontier_queue* p_queue, size_t position)
+{
+    return p_queue->p_cell_array +
+           (position & (p_queue->cells - 1)) * (p_queue->block + 2);
+}
+
+static size_t cell_array_bytes(frontier_queue* p_queue)
+{
+    return sizeof(size_t) * p_queue->cells * (p_queue->block + 2);
+}
+
+frontier_queue* frontier_queue_alloc(size_t capacity, size_t block)
+{
+    frontier_queue* p_queue;
+    size_t          cells = 2;
+
+    if (capacity == 0 || block == 0) return NULL;
+
+    while (cells * block < capacity) cells *= 2;
+
+    p_queue = allocation_alloc(ALLOCATION_FRONTIER_QUEUE, sizeof(*p_queue));
+
+    if (!p_queue) return NULL;
+
+    p_queue->cells = cells;
+    p_queue->block = block;
+    p_queue->p_cell_array = allocation_alloc(ALLOCATION_FRONTIER_QUEUE,
+                                             cell_array_bytes(p_queue));
+
+    if (!p_queue->p_cell_array)
+    {
+        allocation_free(ALLOCATION_FRONTIER_QUEUE, p_queue, sizeof(*p_queue));
+        return NULL;
+    }
+
+    frontier_queue_clear(p_queue);
+    return p_queue;
+}
+
+int frontier_queue_try_push_block(frontier_queue* p_queue,
+                                  const size_t* p_item_array,
+                                  size_t count)
+{
+    size_t  position;
+    size_t  sequence;
+    size_t* p_cell;
+
+    if (!p_queue || count == 0 || count > p_queue->block) return FALSE;
+
+    position = PARALLEL_LOAD(&p_queue->enqueue_position);
+
+    for (;;)
+    {
+        p_cell   = cell_at(p_queue, position);
+        sequence = PARALLEL_LOAD(&p_cell[0]);
+
+        if (sequence == position)
+        {
+            if (PARALLEL_CAS(&p_queue->enqueue_position,
+                             position,
+                             position + 1))
+            {
+                break;
+            }
+        }
+        else if ((ptrdiff_t)(sequence - position) < 0)
+        {
+            /* The cell still holds the block of the previous round. */
+            return FALSE;
+        }
+
+        position = PARALLEL_LOAD(&p_queue->enqueue_position);
+    }
+
+    p_cell[1] = count;
+    memcpy(p_cell + 2, p_item_array, sizeof(size_t) * count);
+    PARALLEL_STORE(&p_cell[0], position + 1);
+    return TRUE;
+}
+
+size_t frontier_queue_try_pop_block(frontier_queue* p_queue,
+                                    size_t* p_item_array)
+{
+    size_t  position;
+    size_t  sequence;
+    size_t  count;
+    size_t* p_cell;
+
+    if (!p_queue) return 0;
+
+    position = PARALLEL_LOAD(&p_queue->dequeue_position);
+
+    for (;;)
+    {
+        p_cell   = cell_at(p_queue, position);
+        sequence = PARALLEL_LOAD(&p_cell[0]);
+
+        if (sequence == position + 1)
+        {
+            if (PARALLEL_CAS(&p_queue->dequeue_position,
+                             position,
+                             position + 1))
+            {
+                break;
+            }
+        }
+        else if ((ptrdiff_t)(sequence - (position + 1)) < 0)
+        {
+            return 0;
+        }
+
+        position = PARALLEL_LOAD(&p_queue->dequeue_position);
+    }
+
+    count = p_cell[1];
+    memcpy(p_item_array, p_cell + 2, sizeof(size_t) * count);
+    PARALLEL_STORE(&p_cell[0], position + p_queue->cells);
+    return count;
+}
+
+int frontier_queue_is_empty(frontier_queue* p_queue)
+{
+    size_t position;
+
+    if (!p_queue) return TRUE;
+
+    position = PARALLEL_LOAD(&p_queue->dequeue_position);
+    return PARALLEL_LOAD(&cell_at(p_queue, position)[0]) != position + 1;
+}
+
+void frontier_queue_clear(frontier_queue* p_queue)
+{
+    size_t i;
+
+    if (!p_queue) return;
+
+    for (i = 0; i < p_queue->cells; ++i)
+    {
+        PARALLEL_STORE(&cell_at(p_queue, i)[0], i);
+    }
+
+    PARALLEL_STORE(&p_queue->enqueue_position, 0);
+    PARALLEL_STORE(&p_queue->dequeue_position, 0);
+}
+
+void frontier_queue_free(frontier_queue* p_queue)
+{
+    if (!p_queue) return;
+
+    allocation_free(ALLOCATION_FRONTIER_QUEUE,
+                    p_queue->p_cell_array,
+                    cell_array_bytes(p_queue));
+    allocation_free(ALLOCATION_FRONTIER_QUEUE, p_queue, sizeof(*p_queue));
+}
+
+size_t frontier_queue_memory_usage(frontier_queue* p_queue)
+{
+    return p_queue ? sizeof(*p_queue) + cell_array_bytes(p_queue) : 0;
+}
+
+int frontier_queue_local_init(frontier_queue_local* p_local,
+                              frontier_queue* p_queue)
+{
+    if (!p_local || !p_queue) return FALSE;
+
+    p_local->p_queue     = p_queue;
+    p_local->p_out_array = allocation_alloc(ALLOCATION_FRONTIER_QUEUE,
+                                            sizeof(size_t) * p_queue->block);
+    p_local->p_in_array  = allocation_alloc(ALLOCATION_FRONTIER_QUEUE,
+                                            sizeof(size_t) * p_queue->block);
+    p_local->out_count   = 0;
+    p_local->in_next     = 0;
+    p_local->in_count    = 0;
+
+    if (!p_local->p_out_array || !p_local->p_in_array)
+    {
+        frontier_queue_local_free(p_local);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+int frontier_queue_local_push(frontier_queue_local* p_local, size_t item)
+{
+    if (p_local->out_count == p_local->p_queue->block
+        && !frontier_queue_local_flush(p_local))
+    {
+        return FALSE;
+    }
+
+    p_local->p_out_array[p_local->out_count++] = item;
+    return TRUE;
+}
+
+int frontier_queue_local_flush(frontier_queue_local* p_local)
+{
+    if (p_local->out_count == 0) return TRUE;
+
+    if (!frontier_queue_try_push_block(p_local->p_queue,
+                                       p_local->p_out_array,
+                                       p_local->out_count))
+    {
+        return FALSE;
+    }
+
+    p_local->out_count = 0;
+    return TRUE;
+}
+
+int frontier_queue_local_pop(frontier_queue_local* p_local, size_t* p_item)
+{
+    if (p_local->in_next == p_local->in_count)
+    {
+        p_local->in_next  = 0;
+        p_local->in_count = frontier_queue_try_pop_block(p_local->p_queue,
+                                                         p_local->p_in_array);
+
+        if (p_local->in_count == 0)
+        {
+            if (p_local->out_count == 0) return FALSE;
+
+            *p_item = p_local->p_out_array[--p_local->out_count];
+            return TRUE;
+        }
+    }
+
+    *p_item = p_local->p_in_array[p_local->in_next++];
+    return TRUE;
+}
+
+void frontier_queue_local_free(frontier_queue_local* p_local)
+{
+    if (!p_local || !p_local->p_queue) return;
+
+    allocation_free(ALLOCATION_FRONTIER_QUEUE,
+                    p_local->p_out_array,
+                    sizeof(size_t) * p_local->p_queue->block);
+    allocation_free(ALLOCATION_FRONTIER_QUEUE,
+                    p_local->p_in_array,
+                    sizeof(size_t) * p_local->p_queue->block);
+    p_local->p_out_array = NULL;
+    p_local->p_in_array  = NULL;
+    p_local->out_count   = 0;
+    p_local->in_next     = 0;
+    p_local->in_count    = 0;
+}
+
+size_t frontier_queue_local_memory_usage(frontier_queue_local* p_local)
+{
+    return p_local && p_local->p_out_array ?
+           2 * sizeof(size_t) * p_local->p_queue->block :
+           0;
+}
+
+static void frontier_queue_test_blocks()
+{
+    frontier_queue* p_queue;
+    size_t          item_array[4];
+    size_t          round;
+    size_t          i;
+
+    puts("        frontier_queue_test_blocks()");
+
+    ASSERT(frontier_queue_alloc(0, 4) == NULL);
+    ASSERT(frontier_queue_alloc(4, 0) == NULL);
+
+    p_queue = frontier_queue_alloc(10, 4);
+
+    ASSERT(p_queue->cells == 4);
+    ASSERT(frontier_queue_is_empty(p_queue));
+    ASSERT(frontier_queue_try_pop_block(p_queue, item_array) == 0);
+
+    /* Several rounds, so that the cells get reused. */
+    for (round = 0; round < 3; ++round)
+    {
+        for (i = 0; i < 4; ++i)
+        {
+            item_array[0] = 10 * round + i;
+            item_array[1] = 10 * round + i + 1;
+            ASSERT(frontier_queue_try_push_block(p_queue, item_array, i + 1));
+        }
+
+        ASSERT(!frontier_queue_try_push_block(p_queue, item_array, 1));
+        ASSERT(!frontier_queue_is_empty(p_queue));
+
+        for (i = 0; i < 4; ++i)
+        {
+            ASSERT(frontier_queue_try_pop_block(p_queue, item_array) == i + 1);
+            ASSERT(item_array[0] == 10 * round + i);
+
+            if (i > 0) ASSERT(item_array[1] == 10 * round + i + 1);
+        }
+
+        ASSERT(frontier_queue_is_empty(p_queue));
+    }
+
+    ASSERT(!frontier_queue_try_push_block(p_queue, item_array, 0));
+    ASSERT(!frontier_queue_try_push_block(p_queue, item_array, 5));
+
+    frontier_queue_try_push_block(p_queue, item_array, 2);
+    frontier_queue_clear(p_queue);
+    ASSERT(frontier_queue_is_empty(p_queue));
+    frontier_queue_free(p_queue);
+}
+
+static void frontier_queue_test_local()
+{
+    frontier_queue*      p_queue;
+    frontier_queue_local producer;
+    frontier_queue_local consumer;
+    size_t               base = allocation_total_bytes();
+    size_t               item;
+    size_t               i;
+
+    puts("        frontier_queue_test_local()");
+
+    p_queue = frontier_queue_alloc(8, 4);
+    ASSERT(frontier_queue_local_init(&producer, p_queue));
+    ASSERT(frontier_queue_local_init(&consumer, p_queue));
+    ASSERT(frontier_queue_local_memory_usage(&producer) ==
+           2 * 4 * sizeof(size_t));
+    ASSERT(allocation_total_bytes() - base ==
+           frontier_queue_memory_usage(p_queue) +
+           frontier_queue_local_memory_usage(&producer) +
+           frontier_queue_local_memory_usage(&consumer));
+
+    /* Two blocks fill the ring; the third block stays local. */
+    for (i = 0; i < 12; ++i)
+    {
+        ASSERT(frontier_queue_local_push(&producer, i));
+    }
+
+    ASSERT(!frontier_queue_local_push(&producer, 12));
+    ASSERT(!frontier_queue_local_flush(&producer));
+
+    for (i = 0; i < 8; ++i)
+    {
+        ASSERT(frontier_queue_local_pop(&consumer, &item));
+        ASSERT(item == i);
+    }
+
+    ASSERT(!frontier_queue_local_pop(&consumer, &item));
+    ASSERT(frontier_queue_local_flush(&producer));
+    ASSERT(frontier_queue_local_flush(&producer));
+    ASSERT(frontier_queue_local_push(&producer, 12));
+
+    for (i = 8; i < 12; ++i)
+    {
+        ASSERT(frontier_queue_local_pop(&consumer, &item));
+        ASSERT(item == i);
+    }
+
+    /* The producer gets back the word it did not send. */
+    ASSERT(frontier_queue_local_pop(&producer, &item));
+    ASSERT(item == 12);
+    ASSERT(!frontier_queue_local_pop(&producer, &item));
+
+    frontier_queue_local_free(&producer);
+    frontier_queue_local_free(&consumer);
+    ASSERT(frontier_queue_local_memory_usage(&producer) == 0);
+    frontier_queue_free(p_queue);
+    ASSERT(allocation_total_bytes() == base);
+}
+
+#define STRESS_PRODUCERS 4
+#define STRESS_CONSUMERS 4
+#define STRESS_ITEMS     20000
+
+typedef struct frontier_queue_test_state {
+    frontier_queue* p_queue;
+    size_t*         p_seen_array;
+    size_t          producer;
+    size_t          consumed;
+    size_t          errors;
+} frontier_queue_test_state;
+
+static void frontier_queue_test_producer(void* p_argument)
+{
+    frontier_queue_test_state* p_state = p_argument;
+    frontier_queue_local       local;
+    size_t                     producer =
+        PARALLEL_FETCH_ADD(&p_state->producer, 1);
+    size_t                     i;
+
+    if (!frontier_queue_local_init(&local, p_state->p_queue))
+    {
+        PARALLEL_FETCH_ADD(&p_state->errors, 1);
+        return;
+    }
+
+    for (i = 0; i < STRESS_ITEMS; ++i)
+    {
+        while (!frontier_queue_local_push(&local,
+                                          producer * STRESS_ITEMS + i))
+        {
+            parallel_yield();
+        }
+    }
+
+    while (!frontier_queue_local_flush(&local)) parallel_yield();
+
+    frontier_queue_local_free(&local);
+}
+
+static void frontier_queue_test_consumer(void* p_argument)
+{
+    frontier_queue_test_state* p_state = p_argument;
+    frontier_queue_local       local;
+    size_t                     item;
+
+    if (!frontier_queue_local_init(&local, p_state->p_queue))
+    {
+        PARALLEL_FETCH_ADD(&p_state->errors, 1);
+        return;
+    }
+
+    while (PARALLEL_LOAD(&p_state->consumed)
+           < STRESS_PRODUCERS * STRESS_ITEMS)
+    {
+        if (!frontier_queue_local_pop(&local, &item))
+        {
+            parallel_yield();
+            continue;
+        }
+
+        if (item >= STRESS_PRODUCERS * STRESS_ITEMS
+            || PARALLEL_FETCH_ADD(&p_state->p_seen_array[item], 1) != 0)
+        {
+            PARALLEL_FETCH_ADD(&p_state->errors, 1);
+        }
+
+        PARALLEL_FETCH_ADD(&p_state->consumed, 1);
+    }
+
+    frontier_queue_local_free(&local);
+}
+
+/*******************************************************************************
+* Producers and consumers share a small ring, so that it keeps running full    *
+* and empty. Each word must come out exactly once.                             *
+*******************************************************************************/
+static void frontier_queue_test_stress()
+{
+    frontier_queue_test_state state;
+    parallel_thread           thread_array[STRESS_PRODUCERS +
+                                           STRESS_CONSUMERS];
+    size_t                    block;
+    size_t                    i;
+
+    puts("        frontier_queue_test_stress()");
+
+    for (block = 1; block <= 64; block *= 8)
+    {
+        state.p_queue      = frontier_queue_alloc(16 * block, block);
+        state.p_seen_array = calloc(STRESS_PRODUCERS * STRESS_ITEMS,
+                                    sizeof(size_t));
+        state.producer     = 0;
+        state.consumed     = 0;
+        state.errors       = 0;
+
+        for (i = 0; i < STRESS_CONSUMERS; ++i)
+        {
+            ASSERT(parallel_thread_create(&thread_array[i],
+                                          frontier_queue_test_consumer,
+                                          &state));
+        }
+
+        for (i = 0; i < STRESS_PRODUCERS; ++i)
+        {
+            ASSERT(parallel_thread_create(&thread_array[STRESS_CONSUMERS + i],
+                                          frontier_queue_test_producer,
+                                          &state));
+        }
+
+        for (i = 0; i < STRESS_PRODUCERS + STRESS_CONSUMERS; ++i)
+        {
+            parallel_thread_join(thread_array[i]);
+        }
+
+        ASSERT(state.errors == 0);
+        ASSERT(state.consumed == STRESS_PRODUCERS * STRESS_ITEMS);
+        ASSERT(frontier_queue_is_empty(state.p_queue));
+
+        for (i = 0; i < STRESS_PRODUCERS * STRESS_ITEMS; ++i)
+        {
+            if (state.p_seen_array[i] != 1) break;
+        }
+
+        ASSERT(i == STRESS_PRODUCERS * STRESS_ITEMS);
+        free(state.p_seen_array);
+        frontier_queue_free(state.p_queue);
+    }
+}
+
+void frontier_queue_test()
+{
+    puts("    frontier_queue_test()");
+    frontier_queue_test_blocks();
+    frontier_queue_test_local();
+    frontier_queue_test_stress();
+}
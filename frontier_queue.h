@@ -0,0 +1,133 @@
+#ifndef FRONTIER_QUEUE_H
+#define FRONTIER_QUEUE_H
+
+#include <stddef.h>
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * A bounded multi-producer multi-consumer FIFO queue of words. It is a     *
+    * ring of cells, each holding a block of up to 'block' words, so that a    *
+    * producer or a consumer pays one CAS per block rather than per word. A    *
+    * cell is free for the producers of round 'r' when its sequence number is  *
+    * 'r * cells + i', and full for the consumers when it is one more. The two *
+    * positions live on cache lines of their own.                              *
+    ***************************************************************************/
+    typedef struct frontier_queue {
+        size_t* p_cell_array;
+        size_t  cells;
+        size_t  block;
+        char    padding_a[64];
+        size_t  enqueue_position;
+        char    padding_b[64];
+        size_t  dequeue_position;
+        char    padding_c[64];
+    } frontier_queue;
+
+    /***************************************************************************
+    * The private buffers of one thread. Pushed words gather in 'p_out_array'  *
+    * until a block is full and goes to the ring; a block taken from the ring  *
+    * is handed out of 'p_in_array' one word at a time.                        *
+    ***************************************************************************/
+    typedef struct frontier_queue_local {
+        frontier_queue* p_queue;
+        size_t*         p_out_array;
+        size_t          out_count;
+        size_t*         p_in_array;
+        size_t          in_next;
+        size_t          in_count;
+    } frontier_queue_local;
+
+    /***************************************************************************
+    * Allocates a queue with room for at least 'capacity' words in blocks of   *
+    * 'block' words. Returns NULL if the memory ran out or an argument is      *
+    * zero.                                                                    *
+    ***************************************************************************/
+    frontier_queue* frontier_queue_alloc(size_t capacity, size_t block);
+
+    /***************************************************************************
+    * Appends the 'count' words of 'p_item_array' as one block; 'count' must   *
+    * not exceed the block size. Returns false if the queue is full.           *
+    ***************************************************************************/
+    int frontier_queue_try_push_block(frontier_queue* p_queue,
+                                      const size_t* p_item_array,
+                                      size_t count);
+
+    /***************************************************************************
+    * Removes the oldest block, copies it to 'p_item_array', which must have   *
+    * room for a block, and returns its length. Returns zero if the queue is   *
+    * empty.                                                                   *
+    ***************************************************************************/
+    size_t frontier_queue_try_pop_block(frontier_queue* p_queue,
+                                        size_t* p_item_array);
+
+    /***************************************************************************
+    * Returns true if no block was in the queue at some moment during the      *
+    * call. Words still in the local buffers are not seen.                     *
+    ***************************************************************************/
+    int frontier_queue_is_empty(frontier_queue* p_queue);
+
+    /***************************************************************************
+    * Empties the queue. No other thread may use it meanwhile.                 *
+    ***************************************************************************/
+    void frontier_queue_clear(frontier_queue* p_queue);
+
+    /***************************************************************************
+    * Deallocates the queue.                                                   *
+    ***************************************************************************/
+    void frontier_queue_free(frontier_queue* p_queue);
+
+    /***************************************************************************
+    * Returns the number of bytes allocated by the queue, not counting the     *
+    * local buffers of the threads.                                            *
+    ***************************************************************************/
+    size_t frontier_queue_memory_usage(frontier_queue* p_queue);
+
+    /***************************************************************************
+    * Gives the calling thread buffers for 'p_queue'. Returns false if the     *
+    * memory ran out.                                                          *
+    ***************************************************************************/
+    int frontier_queue_local_init(frontier_queue_local* p_local,
+                                  frontier_queue* p_queue);
+
+    /***************************************************************************
+    * Buffers 'item', sending the buffer to the ring when it is full. Returns  *
+    * false, without taking the item, if the buffer is full and so is the      *
+    * ring.                                                                    *
+    ***************************************************************************/
+    int frontier_queue_local_push(frontier_queue_local* p_local, size_t item);
+
+    /***************************************************************************
+    * Sends the buffered words to the ring. Returns false if the ring is full. *
+    ***************************************************************************/
+    int frontier_queue_local_flush(frontier_queue_local* p_local);
+
+    /***************************************************************************
+    * Takes a word, first from the block taken last, then from a new block of  *
+    * the ring and finally from the words this thread pushed but did not send  *
+    * yet. Returns false if there was none.                                    *
+    ***************************************************************************/
+    int frontier_queue_local_pop(frontier_queue_local* p_local,
+                                 size_t* p_item);
+
+    /***************************************************************************
+    * Releases the buffers, before the queue is freed. Unsent and untaken      *
+    * words are dropped, so flush and drain first as needed.                   *
+    ***************************************************************************/
+    void frontier_queue_local_free(frontier_queue_local* p_local);
+
+    /***************************************************************************
+    * Returns the number of bytes allocated by the buffers.                    *
+    ***************************************************************************/
+    size_t frontier_queue_local_memory_usage(frontier_queue_local* p_local);
+
+    /* Contains the unit tests. */
+    void frontier_queue_test();
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif  /* FRONTIER_QUEUE_H */
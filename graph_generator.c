@@ -0,0 +1,1180 @@
+#include "allocation.h"
+#include "graph_generator.h"
+#include "my_assert.h"
+#include "parallel.h"
+#include "philox.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FALSE 0
+#define TRUE 1
+
+/*******************************************************************************
+* Describes the graph being generated. A generator either produces arcs one    *
+* by one through 'p_arc_function', which reports a tail of 'nodes' for no arc, *
+* or the children of a node at a time through 'p_row_function', which only     *
+* counts them if 'p_row' is NULL.                                              *
+*******************************************************************************/
+typedef struct generator {
+    size_t        nodes;
+    size_t        arcs;
+    unsigned long seed;
+    int           symmetric;
+
+    void   (*p_arc_function)(struct generator* p_generator,
+                             size_t arc,
+                             size_t* p_tail,
+                             size_t* p_head);
+    size_t (*p_row_function)(struct generator* p_generator,
+                             size_t node,
+                             size_t* p_row);
+
+    /* The order to generate the rows in, or NULL for the index order. */
+    size_t*       p_row_order;
+
+    /* Erdos-Renyi. */
+    double        arc_probability;
+    double        log_miss_probability;
+
+    /* R-MAT. */
+    unsigned long p_quadrant_threshold_array[3];
+    size_t        scale;
+
+    /* Barabasi-Albert. */
+    size_t        arcs_per_node;
+
+    /* Random geometric. */
+    point_3d*     p_point_array;
+    double        maxx;
+    double        maxy;
+    double        maxz;
+    double        radius;
+    double        cell_size;
+    size_t        cells_x;
+    size_t        cells_y;
+    size_t        cells_z;
+    size_t*       p_cell_of_array;
+    size_t*       p_cell_offsets;
+    size_t*       p_cell_node_array;
+    point_3d*     p_cell_point_array;
+
+    /* Grid. */
+    size_t        width;
+    size_t        height;
+    size_t        depth;
+
+    /* The arrays under construction and the lengths of the target arrays. */
+    size_t*       p_offsets;
+    size_t*       p_targets;
+    size_t*       p_cursors;
+    size_t*       p_new_offsets;
+    size_t*       p_new_targets;
+    size_t        targets;
+    size_t        new_targets;
+} generator;
+
+/*******************************************************************************
+* Turns counts stored at 'p_array[1 .. length]' into offsets.                  *
+*******************************************************************************/
+static void prefix_sum(size_t* p_array, size_t length)
+{
+    size_t i;
+
+    p_array[0] = 0;
+
+    for (i = 1; i <= length; ++i)
+    {
+        p_array[i] += p_array[i - 1];
+    }
+}
+
+static void count_arcs_body(size_t begin,
+                            size_t end,
+                            size_t thread_index,
+                            void* p_argument)
+{
+    generator* p_generator = p_argument;
+    size_t     tail;
+    size_t     head;
+    size_t     arc;
+
+    (void) thread_index;
+
+    for (arc = begin; arc < end; ++arc)
+    {
+        p_generator->p_arc_function(p_generator, arc, &tail, &head);
+
+        if (tail < p_generator->nodes)
+        {
+            PARALLEL_FETCH_ADD(&p_generator->p_offsets[tail + 1], 1);
+        }
+    }
+}
+
+static void scatter_arcs_body(size_t begin,
+                              size_t end,
+                              size_t thread_index,
+                              void* p_argument)
+{
+    generator* p_generator = p_argument;
+    size_t     tail;
+    size_t     head;
+    size_t     arc;
+
+    (void) thread_index;
+
+    for (arc = begin; arc < end; ++arc)
+    {
+        p_generator->p_arc_function(p_generator, arc, &tail, &head);
+
+        if (tail < p_generator->nodes)
+        {
+            p_generator->p_targets[
+                PARALLEL_FETCH_ADD(&p_generator->p_cursors[tail], 1)] = head;
+        }
+    }
+}
+
+static void count_rows_body(size_t begin,
+                            size_t end,
+                            size_t thread_index,
+                            void* p_argument)
+{
+    generator* p_generator = p_argument;
+    size_t     node;
+    size_t     i;
+
+    (void) thread_index;
+
+    for (i = begin; i < end; ++i)
+    {
+        node = p_generator->p_row_order ? p_generator->p_row_order[i] : i;
+        p_generator->p_offsets[node + 1] =
+            p_generator->p_row_function(p_generator, node, NULL);
+    }
+}
+
+static void fill_rows_body(size_t begin,
+                           size_t end,
+                           size_t thread_index,
+                           void* p_argument)
+{
+    generator* p_generator = p_argument;
+    size_t     node;
+    size_t     i;
+
+    (void) thread_index;
+
+    for (i = begin; i < end; ++i)
+    {
+        node = p_generator->p_row_order ? p_generator->p_row_order[i] : i;
+        p_generator->p_row_function(
+            p_generator,
+            node,
+            p_generator->p_targets + p_generator->p_offsets[node]);
+    }
+}
+
+/*******************************************************************************
+* Sorts each row and counts its distinct entries other than the node itself.   *
+*******************************************************************************/
+static void sort_rows_body(size_t begin,
+                           size_t end,
+                           size_t thread_index,
+                           void* p_argument)
+{
+    generator* p_generator = p_argument;
+    size_t*    p_row;
+    size_t     length;
+    size_t     distinct;
+    size_t     node;
+    size_t     i;
+
+    (void) thread_index;
+
+    for (node = begin; node < end; ++node)
+    {
+        p_row = p_generator->p_targets + p_generator->p_offsets[node];
+        length = p_generator->p_offsets[node + 1] -
+                 p_generator->p_offsets[node];
+        compact_graph_sort_row(p_row, length);
+        distinct = 0;
+
+        for (i = 0; i < length; ++i)
+        {
+            if (p_row[i] != node && (i == 0 || p_row[i] != p_row[i - 1]))
+            {
+                distinct++;
+            }
+        }
+
+        p_generator->p_new_offsets[node + 1] = distinct;
+    }
+}
+
+static void compact_rows_body(size_t begin,
+                              size_t end,
+                              size_t thread_index,
+                              void* p_argument)
+{
+    generator* p_generator = p_argument;
+    size_t*    p_row;
+    size_t*    p_out;
+    size_t     length;
+    size_t     node;
+    size_t     i;
+
+    (void) thread_index;
+
+    for (node = begin; node < end; ++node)
+    {
+        p_row = p_generator->p_targets + p_generator->p_offsets[node];
+        p_out = p_generator->p_new_targets + p_generator->p_new_offsets[node];
+        length = p_generator->p_offsets[node + 1] -
+                 p_generator->p_offsets[node];
+
+        for (i = 0; i < length; ++i)
+        {
+            if (p_row[i] != node && (i == 0 || p_row[i] != p_row[i - 1]))
+            {
+                *p_out++ = p_row[i];
+            }
+        }
+    }
+}
+
+static void count_parents_body(size_t begin,
+                               size_t end,
+                               size_t thread_index,
+                               void* p_argument)
+{
+    generator* p_generator = p_argument;
+    size_t     arc;
+
+    (void) thread_index;
+
+    for (arc = begin; arc < end; ++arc)
+    {
+        PARALLEL_FETCH_ADD(
+            &p_generator->p_new_offsets[p_generator->p_targets[arc] + 1], 1);
+    }
+}
+
+static void scatter_parents_body(size_t begin,
+                                 size_t end,
+                                 size_t thread_index,
+                                 void* p_argument)
+{
+    generator* p_generator = p_argument;
+    size_t     node;
+    size_t     arc;
+
+    (void) thread_index;
+
+    for (node = begin; node < end; ++node)
+    {
+        for (arc = p_generator->p_offsets[node];
+             arc < p_generator->p_offsets[node + 1];
+             ++arc)
+        {
+            p_generator->p_new_targets[
+                PARALLEL_FETCH_ADD(
+                    &p_generator->p_cursors[p_generator->p_targets[arc]],
+                    1)] = node;
+        }
+    }
+}
+
+static void sort_parents_body(size_t begin,
+                              size_t end,
+                              size_t thread_index,
+                              void* p_argument)
+{
+    generator* p_generator = p_argument;
+    size_t     node;
+
+    (void) thread_index;
+
+    for (node = begin; node < end; ++node)
+    {
+        compact_graph_sort_row(p_generator->p_new_targets +
+                               p_generator->p_new_offsets[node],
+                               p_generator->p_new_offsets[node + 1] -
+                               p_generator->p_new_offsets[node]);
+    }
+}
+
+/*******************************************************************************
+* The arrays become the arrays of the graph, so they are allocated as graph    *
+* memory.                                                                      *
+*******************************************************************************/
+static size_t* alloc_indices(size_t length)
+{
+    return allocation_alloc(ALLOCATION_GRAPH, sizeof(size_t) * length);
+}
+
+static size_t* calloc_indices(size_t length)
+{
+    return allocation_calloc(ALLOCATION_GRAPH, length, sizeof(size_t));
+}
+
+static void free_indices(size_t* p_array, size_t length)
+{
+    allocation_free(ALLOCATION_GRAPH, p_array, sizeof(size_t) * length);
+}
+
+static void release_arrays(generator* p_generator)
+{
+    size_t nodes = p_generator->nodes;
+
+    free_indices(p_generator->p_offsets, nodes + 1);
+    free_indices(p_generator->p_targets, p_generator->targets);
+    free_indices(p_generator->p_cursors, nodes + 1);
+    free_indices(p_generator->p_new_offsets, nodes + 1);
+    free_indices(p_generator->p_new_targets, p_generator->new_targets);
+    p_generator->p_offsets     = NULL;
+    p_generator->p_targets     = NULL;
+    p_generator->p_cursors     = NULL;
+    p_generator->p_new_offsets = NULL;
+    p_generator->p_new_targets = NULL;
+}
+
+/*******************************************************************************
+* Takes the raw child rows in 'p_offsets' and 'p_targets', drops self-loops    *
+* and parallel arcs, and builds the parent rows by transposition, or by        *
+* copying the child rows if the graph is symmetric.                            *
+*******************************************************************************/
+static compact_graph* finish_graph(generator* p_generator, size_t threads)
+{
+    compact_graph* p_graph;
+    size_t         nodes = p_generator->nodes;
+    size_t         arcs;
+
+    p_generator->p_new_offsets = calloc_indices(nodes + 1);
+
+    if (!p_generator->p_new_offsets)
+    {
+        release_arrays(p_generator);
+        return NULL;
+    }
+
+    parallel_for(0, nodes, threads, sort_rows_body, p_generator);
+    prefix_sum(p_generator->p_new_offsets, nodes);
+    arcs = p_generator->p_new_offsets[nodes];
+    p_generator->p_new_targets = alloc_indices(arcs + 1);
+    p_generator->new_targets   = arcs + 1;
+
+    if (!p_generator->p_new_targets)
+    {
+        release_arrays(p_generator);
+        return NULL;
+    }
+
+    parallel_for(0, nodes, threads, compact_rows_body, p_generator);
+
+    free_indices(p_generator->p_offsets, nodes + 1);
+    free_indices(p_generator->p_targets, p_generator->targets);
+    p_generator->p_offsets     = p_generator->p_new_offsets;
+    p_generator->p_targets     = p_generator->p_new_targets;
+    p_generator->targets       = arcs + 1;
+    p_generator->p_new_offsets = calloc_indices(nodes + 1);
+    p_generator->p_new_targets = alloc_indices(arcs + 1);
+    free_indices(p_generator->p_cursors, nodes + 1);
+    p_generator->p_cursors     = alloc_indices(nodes + 1);
+    p_graph                    = allocation_alloc(ALLOCATION_GRAPH,
+                                                  sizeof(*p_graph));
+
+    if (!p_generator->p_new_offsets
+        || !p_generator->p_new_targets
+        || !p_generator->p_cursors
+        || !p_graph)
+    {
+        release_arrays(p_generator);
+        allocation_free(ALLOCATION_GRAPH, p_graph, sizeof(*p_graph));
+        return NULL;
+    }
+
+    if (p_generator->symmetric)
+    {
+        memcpy(p_generator->p_new_offsets,
+               p_generator->p_offsets,
+               sizeof(size_t) * (nodes + 1));
+        memcpy(p_generator->p_new_targets,
+               p_generator->p_targets,
+               sizeof(size_t) * arcs);
+    }
+    else
+    {
+        parallel_for(0, arcs, threads, count_parents_body, p_generator);
+        prefix_sum(p_generator->p_new_offsets, nodes);
+        memcpy(p_generator->p_cursors,
+               p_generator->p_new_offsets,
+               sizeof(size_t) * (nodes + 1));
+        parallel_for(0, nodes, threads, scatter_parents_body, p_generator);
+        parallel_for(0, nodes, threads, sort_parents_body, p_generator);
+    }
+
+    p_graph->nodes            = nodes;
+    p_graph->arcs             = arcs;
+    p_graph->p_child_offsets  = p_generator->p_offsets;
+    p_graph->p_child_array    = p_generator->p_targets;
+    p_graph->p_parent_offsets = p_generator->p_new_offsets;
+    p_graph->p_parent_array   = p_generator->p_new_targets;
+    p_graph->p_node_array     = NULL;
+    p_graph->p_index_map      = NULL;
+
+    free_indices(p_generator->p_cursors, nodes + 1);
+    p_generator->p_offsets     = NULL;
+    p_generator->p_targets     = NULL;
+    p_generator->p_cursors     = NULL;
+    p_generator->p_new_offsets = NULL;
+    p_generator->p_new_targets = NULL;
+    return p_graph;
+}
+
+/*******************************************************************************
+* Generates the arcs twice, first to count the children of each node and then  *
+* to place them, which avoids storing an arc list.                             *
+*******************************************************************************/
+static compact_graph* build_from_arcs(generator* p_generator, size_t threads)
+{
+    size_t nodes = p_generator->nodes;
+
+    p_generator->p_offsets = calloc_indices(nodes + 1);
+    p_generator->p_cursors = alloc_indices(nodes + 1);
+
+    if (!p_generator->p_offsets || !p_generator->p_cursors)
+    {
+        release_arrays(p_generator);
+        return NULL;
+    }
+
+    parallel_for(0, p_generator->arcs, threads, count_arcs_body, p_generator);
+    prefix_sum(p_generator->p_offsets, nodes);
+    p_generator->targets   = p_generator->p_offsets[nodes] + 1;
+    p_generator->p_targets = alloc_indices(p_generator->targets);
+
+    if (!p_generator->p_targets)
+    {
+        release_arrays(p_generator);
+        return NULL;
+    }
+
+    memcpy(p_generator->p_cursors,
+           p_generator->p_offsets,
+           sizeof(size_t) * (nodes + 1));
+    parallel_for(0, p_generator->arcs, threads, scatter_arcs_body, p_generator);
+    return finish_graph(p_generator, threads);
+}
+
+static compact_graph* build_from_rows(generator* p_generator, size_t threads)
+{
+    size_t nodes = p_generator->nodes;
+
+    p_generator->p_offsets = calloc_indices(nodes + 1);
+
+    if (!p_generator->p_offsets) return NULL;
+
+    parallel_for(0, nodes, threads, count_rows_body, p_generator);
+    prefix_sum(p_generator->p_offsets, nodes);
+    p_generator->targets   = p_generator->p_offsets[nodes] + 1;
+    p_generator->p_targets = alloc_indices(p_generator->targets);
+
+    if (!p_generator->p_targets)
+    {
+        release_arrays(p_generator);
+        return NULL;
+    }
+
+    parallel_for(0, nodes, threads, fill_rows_body, p_generator);
+    return finish_graph(p_generator, threads);
+}
+
+/*******************************************************************************
+* Walks over the other nodes in increasing order, jumping over the ones not    *
+* connected to. The length of a jump is geometrically distributed, so a row    *
+* costs time proportional to its length rather than to the number of nodes.    *
+*******************************************************************************/
+static size_t erdos_renyi_row(generator* p_generator,
+                              size_t node,
+                              size_t* p_row)
+{
+    philox random;
+    size_t candidates = p_generator->nodes - 1;
+    size_t next = 0;
+    size_t count = 0;
+    double skip;
+
+    if (p_generator->arc_probability <= 0.0) return 0;
+
+    philox_init(&random, p_generator->seed, node);
+
+    for (;;)
+    {
+        skip = p_generator->arc_probability >= 1.0 ?
+               0.0 :
+               floor(log(1.0 - philox_uniform(&random)) /
+                     p_generator->log_miss_probability);
+
+        if (skip >= (double)(candidates - next)) break;
+
+        next += (size_t) skip;
+
+        if (p_row)
+        {
+            /* Candidates are numbered skipping the node itself. */
+            p_row[count] = next < node ? next : next + 1;
+        }
+
+        count++;
+        next++;
+    }
+
+    return count;
+}
+
+compact_graph* graph_generator_erdos_renyi(size_t nodes,
+                                           size_t arcs,
+                                           unsigned long seed,
+                                           size_t threads)
+{
+    generator gen;
+
+    memset(&gen, 0, sizeof(gen));
+    gen.nodes          = nodes;
+    gen.seed           = seed;
+    gen.p_row_function = erdos_renyi_row;
+
+    if (nodes > 1)
+    {
+        gen.arc_probability = (double) arcs / nodes / (nodes - 1);
+    }
+
+    if (gen.arc_probability > 0.0 && gen.arc_probability < 1.0)
+    {
+        gen.log_miss_probability = log(1.0 - gen.arc_probability);
+    }
+
+    return build_from_rows(&gen, threads);
+}
+
+static void rmat_arc(generator* p_generator,
+                     size_t arc,
+                     size_t* p_tail,
+                     size_t* p_head)
+{
+    unsigned long* p_threshold_array = p_generator->p_quadrant_threshold_array;
+    unsigned long  word = 0;
+    unsigned long  u;
+    philox         random;
+    size_t         level;
+
+    philox_init(&random, p_generator->seed, arc);
+
+    do
+    {
+        *p_tail = 0;
+        *p_head = 0;
+
+        /* Each level takes 16 random bits, half of a word. */
+        for (level = 0; level < p_generator->scale; ++level)
+        {
+            if (level % 2 == 0)
+            {
+                word = philox_next(&random);
+            }
+
+            u = level % 2 == 0 ? word & 0xFFFFUL : word >> 16;
+            *p_tail <<= 1;
+            *p_head <<= 1;
+
+            if (u >= p_threshold_array[2])
+            {
+                *p_tail |= 1;
+                *p_head |= 1;
+            }
+            else if (u >= p_threshold_array[1])
+            {
+                *p_tail |= 1;
+            }
+            else if (u >= p_threshold_array[0])
+            {
+                *p_head |= 1;
+            }
+        }
+    }
+    while (*p_tail >= p_generator->nodes || *p_head >= p_generator->nodes);
+}
+
+compact_graph* graph_generator_rmat(size_t nodes,
+                                    size_t arcs,
+                                    double a,
+                                    double b,
+                                    double c,
+                                    unsigned long seed,
+                                    size_t threads)
+{
+    generator gen;
+
+    memset(&gen, 0, sizeof(gen));
+    gen.nodes          = nodes;
+    gen.arcs           = nodes > 0 ? arcs : 0;
+    gen.seed           = seed;
+    gen.p_quadrant_threshold_array[0] = (unsigned long)(a * 65536.0);
+    gen.p_quadrant_threshold_array[1] = (unsigned long)((a + b) * 65536.0);
+    gen.p_quadrant_threshold_array[2] =
+        (unsigned long)((a + b + c) * 65536.0);
+    gen.p_arc_function = rmat_arc;
+
+    while (((size_t) 1 << gen.scale) < nodes)
+    {
+        gen.scale++;
+    }
+
+    return build_from_arcs(&gen, threads);
+}
+
+/*******************************************************************************
+* The arc 'arc' leaves the node 'arc / m + 1'. Its head is an endpoint of a    *
+* uniformly chosen earlier arc: a tail is known at once, a head is found by    *
+* repeating the choice for that arc. Choosing among endpoints is choosing      *
+* nodes proportionally to their degree.                                        *
+*******************************************************************************/
+static size_t barabasi_albert_head(generator* p_generator, size_t arc)
+{
+    philox random;
+    size_t endpoint;
+
+    while (arc > 0)
+    {
+        philox_init(&random, p_generator->seed, arc);
+        endpoint = philox_below(&random, 2 * arc);
+
+        if (endpoint % 2 == 0)
+        {
+            return endpoint / 2 / p_generator->arcs_per_node + 1;
+        }
+
+        arc = endpoint / 2;
+    }
+
+    return 0;
+}
+
+/*******************************************************************************
+* The arcs of a node are consecutive, so the rows are generated directly.      *
+*******************************************************************************/
+static size_t barabasi_albert_row(generator* p_generator,
+                                  size_t node,
+                                  size_t* p_row)
+{
+    size_t first_arc;
+    size_t i;
+
+    if (node == 0) return 0;
+
+    if (p_row)
+    {
+        first_arc = (node - 1) * p_generator->arcs_per_node;
+
+        for (i = 0; i < p_generator->arcs_per_node; ++i)
+        {
+            p_row[i] = barabasi_albert_head(p_generator, first_arc + i);
+        }
+    }
+
+    return p_generator->arcs_per_node;
+}
+
+compact_graph* graph_generator_barabasi_albert(size_t nodes,
+                                               size_t arcs_per_node,
+                                               unsigned long seed,
+                                               size_t threads)
+{
+    generator gen;
+
+    memset(&gen, 0, sizeof(gen));
+    gen.nodes          = nodes;
+    gen.arcs_per_node  = arcs_per_node > 0 ? arcs_per_node : 1;
+    gen.seed           = seed;
+    gen.p_row_function = barabasi_albert_row;
+    return build_from_rows(&gen, threads);
+}
+
+static size_t cell_coordinate(double value, double cell_size, size_t cells)
+{
+    size_t cell = (size_t)(value / cell_size);
+
+    return cell < cells ? cell : cells - 1;
+}
+
+static size_t cell_of(generator* p_generator, point_3d* p_point)
+{
+    size_t x = cell_coordinate(p_point->x,
+                               p_generator->cell_size,
+                               p_generator->cells_x);
+    size_t y = cell_coordinate(p_point->y,
+                               p_generator->cell_size,
+                               p_generator->cells_y);
+    size_t z = cell_coordinate(p_point->z,
+                               p_generator->cell_size,
+                               p_generator->cells_z);
+
+    return x + p_generator->cells_x * (y + p_generator->cells_y * z);
+}
+
+static void place_points_body(size_t begin,
+                              size_t end,
+                              size_t thread_index,
+                              void* p_argument)
+{
+    generator* p_generator = p_argument;
+    philox     random;
+    point_3d*  p_point;
+    size_t     node;
+
+    (void) thread_index;
+
+    for (node = begin; node < end; ++node)
+    {
+        philox_init(&random, p_generator->seed, node);
+        p_point = &p_generator->p_point_array[node];
+        p_point->x = philox_uniform(&random) * p_generator->maxx;
+        p_point->y = philox_uniform(&random) * p_generator->maxy;
+        p_point->z = philox_uniform(&random) * p_generator->maxz;
+        p_generator->p_cell_of_array[node] = cell_of(p_generator, p_point);
+    }
+}
+
+/*******************************************************************************
+* The cells are at least 'radius' wide, so all the neighbors of a point are in *
+* its own cell or the 26 cells around it.                                      *
+*******************************************************************************/
+static size_t geometric_row(generator* p_generator,
+                            size_t node,
+                            size_t* p_row)
+{
+    point_3d* p_point = &p_generator->p_point_array[node];
+    point_3d* p_other;
+    size_t    x = cell_coordinate(p_point->x,
+                                  p_generator->cell_size,
+                                  p_generator->cells_x);
+    size_t    y = cell_coordinate(p_point->y,
+                                  p_generator->cell_size,
+                                  p_generator->cells_y);
+    size_t    z = cell_coordinate(p_point->z,
+                                  p_generator->cell_size,
+                                  p_generator->cells_z);
+    size_t    cx;
+    size_t    cy;
+    size_t    cz;
+    size_t    cell;
+    size_t    i;
+    size_t    other;
+    size_t    count = 0;
+    double    dx;
+    double    dy;
+    double    dz;
+    double    squared_radius = p_generator->radius * p_generator->radius;
+
+    for (cz = z > 0 ? z - 1 : 0; cz <= z + 1 && cz < p_generator->cells_z; ++cz)
+    {
+        for (cy = y > 0 ? y - 1 : 0;
+             cy <= y + 1 && cy < p_generator->cells_y;
+             ++cy)
+        {
+            for (cx = x > 0 ? x - 1 : 0;
+                 cx <= x + 1 && cx < p_generator->cells_x;
+                 ++cx)
+            {
+                cell = cx + p_generator->cells_x
+                          * (cy + p_generator->cells_y * cz);
+
+                for (i = p_generator->p_cell_offsets[cell];
+                     i < p_generator->p_cell_offsets[cell + 1];
+                     ++i)
+                {
+                    other = p_generator->p_cell_node_array[i];
+                    p_other = &p_generator->p_cell_point_array[i];
+                    dx = p_point->x - p_other->x;
+                    dy = p_point->y - p_other->y;
+                    dz = p_point->z - p_other->z;
+
+                    if (other != node
+                        && dx * dx + dy * dy + dz * dz <= squared_radius)
+                    {
+                        if (p_row)
+                        {
+                            p_row[count] = other;
+                        }
+
+                        count++;
+                    }
+                }
+            }
+        }
+    }
+
+    return count;
+}
+
+static size_t cells_along(double length, double cell_size)
+{
+    return (size_t)(length / cell_size) + 1;
+}
+
+compact_graph* graph_generator_geometric(size_t nodes,
+                                         double maxx,
+                                         double maxy,
+                                         double maxz,
+                                         double radius,
+                                         unsigned long seed,
+                                         size_t threads,
+                                         point_3d** pp_point_array)
+{
+    generator      gen;
+    compact_graph* p_graph = NULL;
+    size_t         cells;
+    size_t         node;
+
+    memset(&gen, 0, sizeof(gen));
+    gen.nodes          = nodes;
+    gen.seed           = seed;
+    gen.maxx           = maxx;
+    gen.maxy           = maxy;
+    gen.maxz           = maxz;
+    gen.radius         = radius;
+    gen.symmetric      = TRUE;
+    gen.p_row_function = geometric_row;
+
+    /* Widen the cells until there are not many more of them than nodes. */
+    gen.cell_size = radius > 0.0 ? radius : 1.0;
+
+    while ((double) cells_along(maxx, gen.cell_size)
+           * (double) cells_along(maxy, gen.cell_size)
+           * (double) cells_along(maxz, gen.cell_size) > 2.0 * nodes + 1.0)
+    {
+        gen.cell_size *= 2.0;
+    }
+
+    gen.cells_x = cells_along(maxx, gen.cell_size);
+    gen.cells_y = cells_along(maxy, gen.cell_size);
+    gen.cells_z = cells_along(maxz, gen.cell_size);
+    cells = gen.cells_x * gen.cells_y * gen.cells_z;
+
+    gen.p_point_array     = malloc(sizeof(point_3d) * (nodes + 1));
+    gen.p_cell_of_array   = malloc(sizeof(size_t) * (nodes + 1));
+    gen.p_cell_offsets    = calloc(cells + 1, sizeof(size_t));
+    gen.p_cell_node_array = malloc(sizeof(size_t) * (nodes + 1));
+    gen.p_cell_point_array = malloc(sizeof(point_3d) * (nodes + 1));
+
+    if (gen.p_point_array
+        && gen.p_cell_of_array
+        && gen.p_cell_offsets
+        && gen.p_cell_node_array
+        && gen.p_cell_point_array)
+    {
+        parallel_for(0, nodes, threads, place_points_body, &gen);
+
+        /* A stable counting sort keeps each cell ordered by node index. */
+        for (node = 0; node < nodes; ++node)
+        {
+            gen.p_cell_offsets[gen.p_cell_of_array[node] + 1]++;
+        }
+
+        prefix_sum(gen.p_cell_offsets, cells);
+
+        /* Place the nodes by advancing the offsets, then shift them back. */
+        for (node = 0; node < nodes; ++node)
+        {
+            gen.p_cell_node_array[
+                gen.p_cell_offsets[gen.p_cell_of_array[node]]++] = node;
+        }
+
+        memmove(gen.p_cell_offsets + 1,
+                gen.p_cell_offsets,
+                sizeof(size_t) * cells);
+        gen.p_cell_offsets[0] = 0;
+
+        /* Scanning a cell reads its points contiguously, and generating the
+           rows cell by cell keeps the neighboring cells in cache. */
+        for (node = 0; node < nodes; ++node)
+        {
+            gen.p_cell_point_array[node] =
+                gen.p_point_array[gen.p_cell_node_array[node]];
+        }
+
+        gen.p_row_order = gen.p_cell_node_array;
+
+        p_graph = build_from_rows(&gen, threads);
+    }
+
+    free(gen.p_cell_of_array);
+    free(gen.p_cell_offsets);
+    free(gen.p_cell_node_array);
+    free(gen.p_cell_point_array);
+
+    if (p_graph && pp_point_array)
+    {
+        *pp_point_array = gen.p_point_array;
+    }
+    else
+    {
+        free(gen.p_point_array);
+    }
+
+    return p_graph;
+}
+
+static size_t grid_row(generator* p_generator, size_t node, size_t* p_row)
+{
+    size_t width  = p_generator->width;
+    size_t height = p_generator->height;
+    size_t x      = node % width;
+    size_t y      = node / width % height;
+    size_t z      = node / width / height;
+    size_t plane  = width * height;
+    size_t p_neighbor_array[6];
+    size_t count  = 0;
+    size_t i;
+
+    if (x > 0)                       p_neighbor_array[count++] = node - 1;
+    if (x + 1 < width)               p_neighbor_array[count++] = node + 1;
+    if (y > 0)                       p_neighbor_array[count++] = node - width;
+    if (y + 1 < height)              p_neighbor_array[count++] = node + width;
+    if (z > 0)                       p_neighbor_array[count++] = node - plane;
+    if (z + 1 < p_generator->depth)  p_neighbor_array[count++] = node + plane;
+
+    if (p_row)
+    {
+        for (i = 0; i < count; ++i)
+        {
+            p_row[i] = p_neighbor_array[i];
+        }
+    }
+
+    return count;
+}
+
+compact_graph* graph_generator_grid(size_t width,
+                                    size_t height,
+                                    size_t depth,
+                                    size_t threads)
+{
+    generator gen;
+
+    memset(&gen, 0, sizeof(gen));
+    gen.width          = width;
+    gen.height         = height;
+    gen.depth          = depth;
+    gen.nodes          = width * height * depth;
+    gen.symmetric      = TRUE;
+    gen.p_row_function = grid_row;
+    return build_from_rows(&gen, threads);
+}
+
+/*******************************************************************************
+* Checks that the rows are strictly increasing, hold no self-loops, and that   *
+* the parent rows are the transpose of the child rows.                         *
+*******************************************************************************/
+static int is_well_formed(compact_graph* p_graph)
+{
+    size_t node;
+    size_t arc;
+    size_t child;
+    size_t begin;
+    size_t end;
+    size_t parents = 0;
+
+    for (node = 0; node < p_graph->nodes; ++node)
+    {
+        for (arc = p_graph->p_child_offsets[node];
+             arc < p_graph->p_child_offsets[node + 1];
+             ++arc)
+        {
+            child = p_graph->p_child_array[arc];
+
+            if (child >= p_graph->nodes || child == node) return FALSE;
+
+            if (arc > p_graph->p_child_offsets[node]
+                && p_graph->p_child_array[arc - 1] >= child)
+            {
+                return FALSE;
+            }
+
+            begin = p_graph->p_parent_offsets[child];
+            end   = p_graph->p_parent_offsets[child + 1];
+
+            if (!bsearch(&node,
+                         p_graph->p_parent_array + begin,
+                         end - begin,
+                         sizeof(size_t),
+                         compact_graph_compare_indices))
+            {
+                return FALSE;
+            }
+        }
+
+        parents += compact_graph_in_degree(p_graph, node);
+    }
+
+    return parents == p_graph->arcs
+        && p_graph->p_child_offsets[p_graph->nodes] == p_graph->arcs;
+}
+
+static int graphs_equal(compact_graph* p_a, compact_graph* p_b)
+{
+    return p_a->nodes == p_b->nodes
+        && p_a->arcs == p_b->arcs
+        && memcmp(p_a->p_child_offsets,
+                  p_b->p_child_offsets,
+                  sizeof(size_t) * (p_a->nodes + 1)) == 0
+        && memcmp(p_a->p_child_array,
+                  p_b->p_child_array,
+                  sizeof(size_t) * p_a->arcs) == 0
+        && memcmp(p_a->p_parent_array,
+                  p_b->p_parent_array,
+                  sizeof(size_t) * p_a->arcs) == 0;
+}
+
+static void graph_generator_test_grid()
+{
+    compact_graph* p_graph;
+
+    puts("        graph_generator_test_grid()");
+
+    p_graph = graph_generator_grid(3, 3, 1, 2);
+    ASSERT(p_graph != NULL);
+    ASSERT(p_graph->nodes == 9);
+    ASSERT(p_graph->arcs == 24);
+    ASSERT(compact_graph_out_degree(p_graph, 4) == 4);
+    ASSERT(compact_graph_out_degree(p_graph, 0) == 2);
+    ASSERT(p_graph->p_child_array[p_graph->p_child_offsets[4]] == 1);
+    ASSERT(is_well_formed(p_graph));
+    compact_graph_free(p_graph);
+
+    p_graph = graph_generator_grid(2, 2, 2, 0);
+    ASSERT(p_graph->arcs == 24);
+    ASSERT(compact_graph_in_degree(p_graph, 7) == 3);
+    ASSERT(is_well_formed(p_graph));
+    compact_graph_free(p_graph);
+}
+
+static void graph_generator_test_random()
+{
+    compact_graph* p_a;
+    compact_graph* p_b;
+    compact_graph* p_c;
+    size_t         node;
+    size_t         arc;
+
+    puts("        graph_generator_test_random()");
+
+    /* The graph does not depend on the number of threads. */
+    p_a = graph_generator_erdos_renyi(1000, 5000, 7, 1);
+    p_b = graph_generator_erdos_renyi(1000, 5000, 7, 4);
+    p_c = graph_generator_erdos_renyi(1000, 5000, 8, 4);
+    ASSERT(p_a && p_b && p_c);
+    ASSERT(p_a->arcs > 4500 && p_a->arcs < 5500);
+    ASSERT(is_well_formed(p_a));
+    ASSERT(graphs_equal(p_a, p_b));
+    ASSERT(!graphs_equal(p_a, p_c));
+    ASSERT(p_a->p_node_array == NULL);
+    compact_graph_free(p_a);
+    compact_graph_free(p_b);
+    compact_graph_free(p_c);
+
+    p_a = graph_generator_rmat(1000, 8000, 0.57, 0.19, 0.19, 3, 1);
+    p_b = graph_generator_rmat(1000, 8000, 0.57, 0.19, 0.19, 3, 3);
+    ASSERT(is_well_formed(p_a));
+    ASSERT(graphs_equal(p_a, p_b));
+    /* The skew puts most arcs on the low indices. */
+    ASSERT(compact_graph_out_degree(p_a, 0) > compact_graph_out_degree(p_a,
+                                                                       999));
+    compact_graph_free(p_a);
+    compact_graph_free(p_b);
+
+    p_a = graph_generator_barabasi_albert(2000, 3, 11, 1);
+    p_b = graph_generator_barabasi_albert(2000, 3, 11, 4);
+    ASSERT(is_well_formed(p_a));
+    ASSERT(graphs_equal(p_a, p_b));
+
+    for (node = 1; node < p_a->nodes; ++node)
+    {
+        ASSERT(compact_graph_out_degree(p_a, node) >= 1);
+
+        for (arc = p_a->p_child_offsets[node];
+             arc < p_a->p_child_offsets[node + 1];
+             ++arc)
+        {
+            ASSERT(p_a->p_child_array[arc] < node);
+        }
+    }
+
+    /* The early nodes collect many more arcs than the late ones. */
+    ASSERT(compact_graph_in_degree(p_a, 0) > 20);
+    compact_graph_free(p_a);
+    compact_graph_free(p_b);
+}
+
+static void graph_generator_test_geometric()
+{
+    compact_graph* p_a;
+    compact_graph* p_b;
+    point_3d*      p_point_array;
+    size_t         i;
+    size_t         j;
+    size_t         pairs = 0;
+    double         radius = 0.1;
+    double         dx;
+    double         dy;
+    double         dz;
+
+    puts("        graph_generator_test_geometric()");
+
+    p_a = graph_generator_geometric(500, 1.0, 1.0, 1.0, radius, 5, 4,
+                                    &p_point_array);
+    p_b = graph_generator_geometric(500, 1.0, 1.0, 1.0, radius, 5, 1, NULL);
+    ASSERT(p_a && p_b);
+    ASSERT(is_well_formed(p_a));
+    ASSERT(graphs_equal(p_a, p_b));
+
+    for (i = 0; i < 500; ++i)
+    {
+        for (j = 0; j < 500; ++j)
+        {
+            dx = p_point_array[i].x - p_point_array[j].x;
+            dy = p_point_array[i].y - p_point_array[j].y;
+            dz = p_point_array[i].z - p_point_array[j].z;
+
+            if (i != j && dx * dx + dy * dy + dz * dz <= radius * radius)
+            {
+                pairs++;
+            }
+        }
+    }
+
+    ASSERT(pairs == p_a->arcs);
+    ASSERT(pairs > 0);
+
+    free(p_point_array);
+    compact_graph_free(p_a);
+    compact_graph_free(p_b);
+
+    /* A flat box gives points in the plane. */
+    p_a = graph_generator_geometric(200, 1.0, 1.0, 0.0, 0.2, 1, 2,
+                                    &p_point_array);
+    ASSERT(p_a && p_point_array[17].z == 0.0);
+    ASSERT(is_well_formed(p_a));
+    free(p_point_array);
+    compact_graph_free(p_a);
+}
+
+void graph_generator_test()
+{
+    puts("    graph_generator_test()");
+    graph_generator_test_grid();
+    graph_generator_test_random();
+    graph_generator_test_geometric();
+}
@@ -0,0 +1,87 @@
+#ifndef GRAPH_GENERATOR_H
+#define GRAPH_GENERATOR_H
+
+#include "compact_graph.h"
+#include "utils.h"
+#include <stddef.h>
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * The generators below build their graphs in parallel directly in compact  *
+    * form, without directed graph nodes: 'p_node_array' and 'p_index_map' of  *
+    * the result are NULL. The random ones draw every arc or point from its    *
+    * own Philox stream, so the graph depends only on the seed and not on the  *
+    * number of threads. Self-loops and parallel arcs are dropped and the      *
+    * children and parents of each node are sorted by index. 'threads' zero    *
+    * means the hardware concurrency. All return NULL if the memory ran out.   *
+    ***************************************************************************/
+
+    /***************************************************************************
+    * Includes each of the possible arcs independently with the probability    *
+    * giving 'arcs' arcs on average, which is the G(n, p) model.               *
+    ***************************************************************************/
+    compact_graph* graph_generator_erdos_renyi(size_t nodes,
+                                               size_t arcs,
+                                               unsigned long seed,
+                                               size_t threads);
+
+    /***************************************************************************
+    * Draws 'arcs' arcs by the recursive matrix model, descending into the     *
+    * quadrants of the adjacency matrix with the probabilities 'a', 'b', 'c'   *
+    * and 1 - a - b - c. Endpoints beyond 'nodes' are drawn again.             *
+    ***************************************************************************/
+    compact_graph* graph_generator_rmat(size_t nodes,
+                                        size_t arcs,
+                                        double a,
+                                        double b,
+                                        double c,
+                                        unsigned long seed,
+                                        size_t threads);
+
+    /***************************************************************************
+    * Grows a Barabasi-Albert preferential attachment graph where each node    *
+    * after the first sends 'arcs_per_node' arcs to earlier nodes. Each target *
+    * is found by following random earlier arc endpoints, which makes the arcs *
+    * independent of each other and thus parallel.                             *
+    ***************************************************************************/
+    compact_graph* graph_generator_barabasi_albert(size_t nodes,
+                                                   size_t arcs_per_node,
+                                                   unsigned long seed,
+                                                   size_t threads);
+
+    /***************************************************************************
+    * Scatters the nodes uniformly in the box [0, maxx] x [0, maxy] x          *
+    * [0, maxz] and connects, in both directions, every two nodes at most      *
+    * 'radius' apart. If 'pp_point_array' is not NULL, it receives the array   *
+    * of the node coordinates, which the caller frees.                         *
+    ***************************************************************************/
+    compact_graph* graph_generator_geometric(size_t nodes,
+                                             double maxx,
+                                             double maxy,
+                                             double maxz,
+                                             double radius,
+                                             unsigned long seed,
+                                             size_t threads,
+                                             point_3d** pp_point_array);
+
+    /***************************************************************************
+    * Builds a 'width' x 'height' x 'depth' grid where each node is connected  *
+    * in both directions to its axis neighbors. A depth of one gives a 2D      *
+    * grid. The node (x, y, z) has the index x + width * (y + height * z).     *
+    ***************************************************************************/
+    compact_graph* graph_generator_grid(size_t width,
+                                        size_t height,
+                                        size_t depth,
+                                        size_t threads);
+
+    /* Contains the unit tests. */
+    void graph_generator_test();
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif  /* GRAPH_GENERATOR_H */
@@ -0,0 +1,1154 @@
+#include "allocation.h"
+#include "graph_ordering.h"
+#include "graph_generator.h"
+#include "my_assert.h"
+#include "parallel.h"
+#include "philox.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FALSE 0
+#define TRUE 1
+
+/*******************************************************************************
+* The maximum number of times the search for a pseudo-peripheral node moves to *
+* a farther node.                                                              *
+*******************************************************************************/
+#define PERIPHERAL_SWEEPS 4
+
+static const float LOAD_FACTOR = 1.0f;
+
+typedef struct degree_entry {
+    size_t degree;
+    size_t node;
+} degree_entry;
+
+typedef struct apply_context {
+    graph_ordering* p_ordering;
+    compact_graph*  p_graph;
+    compact_graph*  p_result;
+} apply_context;
+
+static size_t degree_of(compact_graph* p_graph, size_t node)
+{
+    return compact_graph_out_degree(p_graph, node) +
+           compact_graph_in_degree(p_graph, node);
+}
+
+static int compare_degree_entries(const void* p_a, const void* p_b)
+{
+    const degree_entry* p_entry_a = p_a;
+    const degree_entry* p_entry_b = p_b;
+
+    if (p_entry_a->degree != p_entry_b->degree)
+    {
+        return p_entry_a->degree < p_entry_b->degree ? -1 : 1;
+    }
+
+    return p_entry_a->node < p_entry_b->node ? -1 :
+           (p_entry_a->node > p_entry_b->node ? 1 : 0);
+}
+
+static graph_ordering* ordering_alloc(size_t nodes)
+{
+    graph_ordering* p_ordering = malloc(sizeof(*p_ordering));
+
+    if (!p_ordering) return NULL;
+
+    p_ordering->nodes             = nodes;
+    p_ordering->p_new_index_array = malloc(sizeof(size_t) * (nodes + 1));
+    p_ordering->p_old_index_array = malloc(sizeof(size_t) * (nodes + 1));
+
+    if (!p_ordering->p_new_index_array || !p_ordering->p_old_index_array)
+    {
+        graph_ordering_free(p_ordering);
+        return NULL;
+    }
+
+    return p_ordering;
+}
+
+/*******************************************************************************
+* Stores the nodes of the graph in 'p_node_array' sorted by degree, ascending  *
+* or descending, with ties in index order. This is a counting sort.            *
+*******************************************************************************/
+static int sort_by_degree(compact_graph* p_graph,
+                          size_t* p_node_array,
+                          int descending)
+{
+    size_t* p_count_array;
+    size_t  max_degree = 0;
+    size_t  degree;
+    size_t  node;
+
+    for (node = 0; node < p_graph->nodes; ++node)
+    {
+        degree = degree_of(p_graph, node);
+
+        if (max_degree < degree) max_degree = degree;
+    }
+
+    p_count_array = calloc(max_degree + 2, sizeof(size_t));
+
+    if (!p_count_array) return FALSE;
+
+    for (node = 0; node < p_graph->nodes; ++node)
+    {
+        degree = degree_of(p_graph, node);
+        p_count_array[(descending ? max_degree - degree : degree) + 1]++;
+    }
+
+    for (degree = 1; degree <= max_degree + 1; ++degree)
+    {
+        p_count_array[degree] += p_count_array[degree - 1];
+    }
+
+    for (node = 0; node < p_graph->nodes; ++node)
+    {
+        degree = degree_of(p_graph, node);
+        p_node_array[p_count_array[descending ?
+                                   max_degree - degree :
+                                   degree]++] = node;
+    }
+
+    free(p_count_array);
+    return TRUE;
+}
+
+/*******************************************************************************
+* Numbers the unnumbered nodes reachable from 'root' breadth-first, starting   *
+* with the number 'next'; unnumbered nodes have the new index 'nodes'. The     *
+* numbered nodes double as the queue. If 'p_entry_array' is not NULL, the      *
+* nodes found from each node are numbered by ascending degree. Returns the     *
+* next free number.                                                            *
+*******************************************************************************/
+static size_t number_component(compact_graph* p_graph,
+                               graph_ordering* p_ordering,
+                               size_t root,
+                               size_t next,
+                               degree_entry* p_entry_array)
+{
+    size_t* p_new_index_array = p_ordering->p_new_index_array;
+    size_t* p_old_index_array = p_ordering->p_old_index_array;
+    size_t* p_offsets;
+    size_t* p_array;
+    size_t  nodes = p_graph->nodes;
+    size_t  head  = next;
+    size_t  first;
+    size_t  node;
+    size_t  neighbor;
+    size_t  side;
+    size_t  i;
+    size_t  j;
+
+    p_new_index_array[root]   = next;
+    p_old_index_array[next++] = root;
+
+    while (head < next)
+    {
+        node  = p_old_index_array[head++];
+        first = next;
+
+        for (side = 0; side < 2; ++side)
+        {
+            p_offsets = side == 0 ? p_graph->p_child_offsets :
+                                    p_graph->p_parent_offsets;
+            p_array   = side == 0 ? p_graph->p_child_array :
+                                    p_graph->p_parent_array;
+
+            for (j = p_offsets[node]; j < p_offsets[node + 1]; ++j)
+            {
+                neighbor = p_array[j];
+
+                if (p_new_index_array[neighbor] == nodes)
+                {
+                    p_new_index_array[neighbor] = next;
+                    p_old_index_array[next++]   = neighbor;
+                }
+            }
+        }
+
+        if (!p_entry_array || next - first < 2) continue;
+
+        for (i = first; i < next; ++i)
+        {
+            p_entry_array[i - first].node   = p_old_index_array[i];
+            p_entry_array[i - first].degree =
+                degree_of(p_graph, p_old_index_array[i]);
+        }
+
+        qsort(p_entry_array,
+              next - first,
+              sizeof(degree_entry),
+              compare_degree_entries);
+
+        for (i = first; i < next; ++i)
+        {
+            p_old_index_array[i] = p_entry_array[i - first].node;
+            p_new_index_array[p_old_index_array[i]] = i;
+        }
+    }
+
+    return next;
+}
+
+graph_ordering* graph_ordering_bfs(compact_graph* p_graph)
+{
+    graph_ordering* p_ordering;
+    size_t          next = 0;
+    size_t          node;
+
+    if (!p_graph) return NULL;
+
+    p_ordering = ordering_alloc(p_graph->nodes);
+
+    if (!p_ordering) return NULL;
+
+    for (node = 0; node < p_graph->nodes; ++node)
+    {
+        p_ordering->p_new_index_array[node] = p_graph->nodes;
+    }
+
+    for (node = 0; node < p_graph->nodes; ++node)
+    {
+        if (p_ordering->p_new_index_array[node] == p_graph->nodes)
+        {
+            next = number_component(p_graph, p_ordering, node, next, NULL);
+        }
+    }
+
+    return p_ordering;
+}
+
+/*******************************************************************************
+* Searches breadth-first from 'root' and stores the visited nodes in 'p_queue' *
+* level by level. Returns the number of levels and sets '*p_visited' and       *
+* '*p_last_level' to the number of visited nodes and the position of the first *
+* node of the last level. 'p_level_array' must be 'nodes' everywhere and is    *
+* left that way.                                                               *
+*******************************************************************************/
+static size_t level_sweep(compact_graph* p_graph,
+                          size_t root,
+                          size_t* p_queue,
+                          size_t* p_level_array,
+                          size_t* p_visited,
+                          size_t* p_last_level)
+{
+    size_t* p_offsets;
+    size_t* p_array;
+    size_t  nodes = p_graph->nodes;
+    size_t  head  = 0;
+    size_t  tail  = 0;
+    size_t  node;
+    size_t  neighbor;
+    size_t  side;
+    size_t  i;
+    size_t  levels;
+
+    p_level_array[root] = 0;
+    p_queue[tail++]     = root;
+    *p_last_level       = 0;
+
+    while (head < tail)
+    {
+        node = p_queue[head++];
+
+        for (side = 0; side < 2; ++side)
+        {
+            p_offsets = side == 0 ? p_graph->p_child_offsets :
+                                    p_graph->p_parent_offsets;
+            p_array   = side == 0 ? p_graph->p_child_array :
+                                    p_graph->p_parent_array;
+
+            for (i = p_offsets[node]; i < p_offsets[node + 1]; ++i)
+            {
+                neighbor = p_array[i];
+
+                if (p_level_array[neighbor] == nodes)
+                {
+                    p_level_array[neighbor] = p_level_array[node] + 1;
+
+                    if (p_level_array[neighbor] >
+                        p_level_array[p_queue[*p_last_level]])
+                    {
+                        *p_last_level = tail;
+                    }
+
+                    p_queue[tail++] = neighbor;
+                }
+            }
+        }
+    }
+
+    levels = p_level_array[p_queue[tail - 1]] + 1;
+
+    for (i = 0; i < tail; ++i)
+    {
+        p_level_array[p_queue[i]] = nodes;
+    }
+
+    *p_visited = tail;
+    return levels;
+}
+
+/*******************************************************************************
+* Finds a node of nearly maximal eccentricity in the component of 'root' by    *
+* the method of George and Liu: search from the node and move to the node of   *
+* smallest degree on the last level for as long as the levels get more.        *
+*******************************************************************************/
+static size_t find_peripheral_node(compact_graph* p_graph,
+                                   size_t root,
+                                   size_t* p_queue,
+                                   size_t* p_level_array)
+{
+    size_t levels;
+    size_t candidate_levels;
+    size_t candidate;
+    size_t visited;
+    size_t last_level;
+    size_t sweep;
+    size_t i;
+
+    levels = level_sweep(p_graph,
+                         root,
+                         p_queue,
+                         p_level_array,
+                         &visited,
+                         &last_level);
+
+    for (sweep = 0; sweep < PERIPHERAL_SWEEPS; ++sweep)
+    {
+        candidate = p_queue[last_level];
+
+        for (i = last_level + 1; i < visited; ++i)
+        {
+            if (degree_of(p_graph, p_queue[i]) <
+                degree_of(p_graph, candidate))
+            {
+                candidate = p_queue[i];
+            }
+        }
+
+        candidate_levels = level_sweep(p_graph,
+                                       candidate,
+                                       p_queue,
+                                       p_level_array,
+                                       &visited,
+                                       &last_level);
+
+        if (candidate_levels <= levels) break;
+
+        root   = candidate;
+        levels = candidate_levels;
+    }
+
+    return root;
+}
+
+graph_ordering* graph_ordering_reverse_cuthill_mckee(compact_graph* p_graph)
+{
+    graph_ordering* p_ordering;
+    degree_entry*   p_entry_array;
+    size_t*         p_root_array;
+    size_t*         p_level_array;
+    size_t          nodes;
+    size_t          next = 0;
+    size_t          node;
+    size_t          root;
+    size_t          i;
+
+    if (!p_graph) return NULL;
+
+    nodes         = p_graph->nodes;
+    p_ordering    = ordering_alloc(nodes);
+    p_entry_array = malloc(sizeof(degree_entry) * (nodes + 1));
+    p_root_array  = malloc(sizeof(size_t) * (nodes + 1));
+    p_level_array = malloc(sizeof(size_t) * (nodes + 1));
+
+    if (!p_ordering
+        || !p_entry_array
+        || !p_root_array
+        || !p_level_array
+        || !sort_by_degree(p_graph, p_root_array, FALSE))
+    {
+        graph_ordering_free(p_ordering);
+        free(p_entry_array);
+        free(p_root_array);
+        free(p_level_array);
+        return NULL;
+    }
+
+    for (node = 0; node < nodes; ++node)
+    {
+        p_ordering->p_new_index_array[node] = nodes;
+        p_level_array[node]                 = nodes;
+    }
+
+    /* Each component starts from its node of least degree. The level sweeps
+       use the unnumbered part of the old index array as their queue. */
+    for (i = 0; i < nodes; ++i)
+    {
+        node = p_root_array[i];
+
+        if (p_ordering->p_new_index_array[node] != nodes) continue;
+
+        root = find_peripheral_node(p_graph,
+                                    node,
+                                    p_ordering->p_old_index_array + next,
+                                    p_level_array);
+        next = number_component(p_graph,
+                                p_ordering,
+                                root,
+                                next,
+                                p_entry_array);
+    }
+
+    for (i = 0; i < nodes / 2; ++i)
+    {
+        node = p_ordering->p_old_index_array[i];
+        p_ordering->p_old_index_array[i] =
+            p_ordering->p_old_index_array[nodes - 1 - i];
+        p_ordering->p_old_index_array[nodes - 1 - i] = node;
+    }
+
+    for (i = 0; i < nodes; ++i)
+    {
+        p_ordering->p_new_index_array[p_ordering->p_old_index_array[i]] = i;
+    }
+
+    free(p_entry_array);
+    free(p_root_array);
+    free(p_level_array);
+    return p_ordering;
+}
+
+graph_ordering* graph_ordering_degree(compact_graph* p_graph)
+{
+    graph_ordering* p_ordering;
+    size_t          i;
+
+    if (!p_graph) return NULL;
+
+    p_ordering = ordering_alloc(p_graph->nodes);
+
+    if (!p_ordering) return NULL;
+
+    if (!sort_by_degree(p_graph, p_ordering->p_old_index_array, TRUE))
+    {
+        graph_ordering_free(p_ordering);
+        return NULL;
+    }
+
+    for (i = 0; i < p_graph->nodes; ++i)
+    {
+        p_ordering->p_new_index_array[p_ordering->p_old_index_array[i]] = i;
+    }
+
+    return p_ordering;
+}
+
+/*******************************************************************************
+* The priority queue of Gorder. The scores only ever change by one, so the     *
+* unnumbered nodes are kept in doubly linked lists, one per score, and finding *
+* the maximum only walks down from the previous maximum.                       *
+*******************************************************************************/
+typedef struct unit_heap {
+    size_t* p_score_array;
+    size_t* p_next_array;
+    size_t* p_previous_array;
+    size_t* p_bucket_array;
+    size_t  nodes;
+    size_t  top;
+} unit_heap;
+
+static void unit_heap_unlink(unit_heap* p_heap, size_t node)
+{
+    size_t next     = p_heap->p_next_array[node];
+    size_t previous = p_heap->p_previous_array[node];
+
+    if (previous == p_heap->nodes)
+    {
+        p_heap->p_bucket_array[p_heap->p_score_array[node]] = next;
+    }
+    else
+    {
+        p_heap->p_next_array[previous] = next;
+    }
+
+    if (next != p_heap->nodes)
+    {
+        p_heap->p_previous_array[next] = previous;
+    }
+}
+
+static void unit_heap_push(unit_heap* p_heap, size_t node)
+{
+    size_t* p_head = &p_heap->p_bucket_array[p_heap->p_score_array[node]];
+
+    p_heap->p_previous_array[node] = p_heap->nodes;
+    p_heap->p_next_array[node]     = *p_head;
+
+    if (*p_head != p_heap->nodes)
+    {
+        p_heap->p_previous_array[*p_head] = node;
+    }
+
+    *p_head = node;
+
+    if (p_heap->top < p_heap->p_score_array[node])
+    {
+        p_heap->top = p_heap->p_score_array[node];
+    }
+}
+
+/*******************************************************************************
+* Adds 'delta', which is 1 or -1, to the scores of the nodes related to 'node' *
+* that are not numbered yet: its children and parents, and the other children  *
+* of its parents that have at most 'hub_degree' children.                      *
+*******************************************************************************/
+static void gorder_update(compact_graph* p_graph,
+                          graph_ordering* p_ordering,
+                          unit_heap* p_heap,
+                          size_t node,
+                          int delta,
+                          size_t hub_degree)
+{
+    size_t* p_offsets;
+    size_t* p_array;
+    size_t  nodes = p_graph->nodes;
+    size_t  side;
+    size_t  parent;
+    size_t  neighbor;
+    size_t  i;
+    size_t  j;
+
+    for (side = 0; side < 3; ++side)
+    {
+        p_offsets = side == 0 ? p_graph->p_child_offsets :
+                                p_graph->p_parent_offsets;
+        p_array   = side == 0 ? p_graph->p_child_array :
+                                p_graph->p_parent_array;
+
+        for (i = p_offsets[node]; i < p_offsets[node + 1]; ++i)
+        {
+            if (side < 2)
+            {
+                neighbor = p_array[i];
+
+                if (p_ordering->p_new_index_array[neighbor] != nodes) continue;
+
+                unit_heap_unlink(p_heap, neighbor);
+                p_heap->p_score_array[neighbor] += delta;
+                unit_heap_push(p_heap, neighbor);
+                continue;
+            }
+
+            parent = p_array[i];
+
+            if (compact_graph_out_degree(p_graph, parent) > hub_degree)
+            {
+                continue;
+            }
+
+            for (j = p_graph->p_child_offsets[parent];
+                 j < p_graph->p_child_offsets[parent + 1];
+                 ++j)
+            {
+                neighbor = p_graph->p_child_array[j];
+
+                if (neighbor == node
+                    || p_ordering->p_new_index_array[neighbor] != nodes)
+                {
+                    continue;
+                }
+
+                unit_heap_unlink(p_heap, neighbor);
+                p_heap->p_score_array[neighbor] += delta;
+                unit_heap_push(p_heap, neighbor);
+            }
+        }
+    }
+}
+
+graph_ordering* graph_ordering_gorder(compact_graph* p_graph, size_t window)
+{
+    graph_ordering* p_ordering;
+    unit_heap       heap;
+    size_t          nodes;
+    size_t          max_in_degree = 0;
+    size_t          buckets;
+    size_t          hub_degree;
+    size_t          node;
+    size_t          i;
+
+    if (!p_graph) return NULL;
+
+    if (window == 0) window = 1;
+
+    nodes = p_graph->nodes;
+
+    for (node = 0; node < nodes; ++node)
+    {
+        if (max_in_degree < compact_graph_in_degree(p_graph, node))
+        {
+            max_in_degree = compact_graph_in_degree(p_graph, node);
+        }
+    }
+
+    /* Each node in the window adds at most two for the arcs and one for each
+       parent in common. */
+    hub_degree            = (size_t) sqrt((double) nodes) + 1;
+    buckets               = window * (max_in_degree + 2) + 1;
+    p_ordering            = ordering_alloc(nodes);
+    heap.nodes            = nodes;
+    heap.top              = 0;
+    heap.p_score_array    = calloc(nodes + 1, sizeof(size_t));
+    heap.p_next_array     = malloc(sizeof(size_t) * (nodes + 1));
+    heap.p_previous_array = malloc(sizeof(size_t) * (nodes + 1));
+    heap.p_bucket_array   = malloc(sizeof(size_t) * buckets);
+
+    if (!p_ordering
+        || !heap.p_score_array
+        || !heap.p_next_array
+        || !heap.p_previous_array
+        || !heap.p_bucket_array
+        || !sort_by_degree(p_graph, p_ordering->p_old_index_array, TRUE))
+    {
+        graph_ordering_free(p_ordering);
+        free(heap.p_score_array);
+        free(heap.p_next_array);
+        free(heap.p_previous_array);
+        free(heap.p_bucket_array);
+        return NULL;
+    }
+
+    for (i = 0; i < buckets; ++i)
+    {
+        heap.p_bucket_array[i] = nodes;
+    }
+
+    /* Ties are broken toward high degree: the nodes enter the zero bucket
+       from the lowest degree up. */
+    for (i = nodes; i > 0; --i)
+    {
+        node = p_ordering->p_old_index_array[i - 1];
+        p_ordering->p_new_index_array[node] = nodes;
+        unit_heap_push(&heap, node);
+    }
+
+    for (i = 0; i < nodes; ++i)
+    {
+        while (heap.top > 0 && heap.p_bucket_array[heap.top] == nodes)
+        {
+            heap.top--;
+        }
+
+        node = heap.p_bucket_array[heap.top];
+        unit_heap_unlink(&heap, node);
+        p_ordering->p_new_index_array[node] = i;
+        p_ordering->p_old_index_array[i]    = node;
+        gorder_update(p_graph, p_ordering, &heap, node, 1, hub_degree);
+
+        if (i >= window)
+        {
+            gorder_update(p_graph,
+                          p_ordering,
+                          &heap,
+                          p_ordering->p_old_index_array[i - window],
+                          -1,
+                          hub_degree);
+        }
+    }
+
+    free(heap.p_score_array);
+    free(heap.p_next_array);
+    free(heap.p_previous_array);
+    free(heap.p_bucket_array);
+    return p_ordering;
+}
+
+static void apply_rows_body(size_t begin,
+                            size_t end,
+                            size_t thread_index,
+                            void* p_argument)
+{
+    apply_context*  p_context  = p_argument;
+    graph_ordering* p_ordering = p_context->p_ordering;
+    compact_graph*  p_graph    = p_context->p_graph;
+    compact_graph*  p_result   = p_context->p_result;
+    size_t          node;
+    size_t          old;
+    size_t          i;
+    size_t          j;
+
+    (void) thread_index;
+
+    for (node = begin; node < end; ++node)
+    {
+        old = p_ordering->p_old_index_array[node];
+        j   = p_result->p_child_offsets[node];
+
+        for (i = p_graph->p_child_offsets[old];
+             i < p_graph->p_child_offsets[old + 1];
+             ++i)
+        {
+            p_result->p_child_array[j++] =
+                p_ordering->p_new_index_array[p_graph->p_child_array[i]];
+        }
+
+        j = p_result->p_parent_offsets[node];
+
+        for (i = p_graph->p_parent_offsets[old];
+             i < p_graph->p_parent_offsets[old + 1];
+             ++i)
+        {
+            p_result->p_parent_array[j++] =
+                p_ordering->p_new_index_array[p_graph->p_parent_array[i]];
+        }
+
+        compact_graph_sort_row(p_result->p_child_array +
+                               p_result->p_child_offsets[node],
+                               compact_graph_out_degree(p_result, node));
+        compact_graph_sort_row(p_result->p_parent_array +
+                               p_result->p_parent_offsets[node],
+                               compact_graph_in_degree(p_result, node));
+    }
+}
+
+compact_graph* graph_ordering_apply(graph_ordering* p_ordering,
+                                    compact_graph* p_graph,
+                                    size_t threads)
+{
+    compact_graph* p_result;
+    apply_context  context;
+    size_t         nodes;
+    size_t         node;
+    size_t         old;
+
+    if (!p_ordering || !p_graph || p_ordering->nodes != p_graph->nodes)
+    {
+        return NULL;
+    }
+
+    nodes    = p_graph->nodes;
+    p_result = allocation_calloc(ALLOCATION_GRAPH, 1, sizeof(*p_result));
+
+    if (!p_result) return NULL;
+
+    p_result->nodes            = nodes;
+    p_result->arcs             = p_graph->arcs;
+    p_result->p_child_offsets  = allocation_alloc(ALLOCATION_GRAPH,
+                                                  sizeof(size_t) *
+                                                  (nodes + 1));
+    p_result->p_parent_offsets = allocation_alloc(ALLOCATION_GRAPH,
+                                                  sizeof(size_t) *
+                                                  (nodes + 1));
+    p_result->p_child_array    = allocation_alloc(ALLOCATION_GRAPH,
+                                                  sizeof(size_t) *
+                                                  (p_graph->arcs + 1));
+    p_result->p_parent_array   = allocation_alloc(ALLOCATION_GRAPH,
+                                                  sizeof(size_t) *
+                                                  (p_graph->arcs + 1));
+
+    if (!p_result->p_child_offsets
+        || !p_result->p_parent_offsets
+        || !p_result->p_child_array
+        || !p_result->p_parent_array)
+    {
+        compact_graph_free(p_result);
+        return NULL;
+    }
+
+    p_result->p_child_offsets[0]  = 0;
+    p_result->p_parent_offsets[0] = 0;
+
+    for (node = 0; node < nodes; ++node)
+    {
+        old = p_ordering->p_old_index_array[node];
+        p_result->p_child_offsets[node + 1] =
+            p_result->p_child_offsets[node] +
+            compact_graph_out_degree(p_graph, old);
+        p_result->p_parent_offsets[node + 1] =
+            p_result->p_parent_offsets[node] +
+            compact_graph_in_degree(p_graph, old);
+    }
+
+    context.p_ordering = p_ordering;
+    context.p_graph    = p_graph;
+    context.p_result   = p_result;
+    parallel_for(0, nodes, threads, apply_rows_body, &context);
+
+    if (!p_graph->p_node_array) return p_result;
+
+    p_result->p_node_array = allocation_alloc(ALLOCATION_GRAPH,
+                                              sizeof(directed_graph_node*) *
+                                              (nodes + 1));
+    p_result->p_index_map  =
+        unordered_map_alloc(nodes,
+                            LOAD_FACTOR,
+                            directed_graph_node_hash_function,
+                            directed_graph_nodes_equal_function);
+
+    if (!p_result->p_node_array || !p_result->p_index_map)
+    {
+        compact_graph_free(p_result);
+        return NULL;
+    }
+
+    for (node = 0; node < nodes; ++node)
+    {
+        p_result->p_node_array[node] =
+            p_graph->p_node_array[p_ordering->p_old_index_array[node]];
+        unordered_map_put(p_result->p_index_map,
+                          p_result->p_node_array[node],
+                          (void*)(intptr_t)(node + 1));
+    }
+
+    return p_result;
+}
+
+void graph_ordering_restore(graph_ordering* p_ordering,
+                            const void* p_new_array,
+                            void* p_old_array,
+                            size_t element_size)
+{
+    const char* p_source = p_new_array;
+    char*       p_target = p_old_array;
+    size_t      node;
+
+    for (node = 0; node < p_ordering->nodes; ++node)
+    {
+        memcpy(p_target + p_ordering->p_old_index_array[node] * element_size,
+               p_source + node * element_size,
+               element_size);
+    }
+}
+
+void graph_ordering_restore_indices(graph_ordering* p_ordering,
+                                    const size_t* p_new_array,
+                                    size_t* p_old_array)
+{
+    size_t node;
+    size_t value;
+
+    for (node = 0; node < p_ordering->nodes; ++node)
+    {
+        value = p_new_array[node];
+        p_old_array[p_ordering->p_old_index_array[node]] =
+            value < p_ordering->nodes ?
+            p_ordering->p_old_index_array[value] :
+            value;
+    }
+}
+
+void graph_ordering_free(graph_ordering* p_ordering)
+{
+    if (!p_ordering) return;
+
+    free(p_ordering->p_new_index_array);
+    free(p_ordering->p_old_index_array);
+    free(p_ordering);
+}
+
+static int is_permutation(graph_ordering* p_ordering, size_t nodes)
+{
+    size_t node;
+
+    if (!p_ordering || p_ordering->nodes != nodes) return FALSE;
+
+    for (node = 0; node < nodes; ++node)
+    {
+        if (p_ordering->p_old_index_array[node] >= nodes
+            || p_ordering->p_new_index_array[
+                   p_ordering->p_old_index_array[node]] != node)
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+static int has_arc(compact_graph* p_graph, size_t tail, size_t head)
+{
+    size_t i;
+
+    for (i = p_graph->p_child_offsets[tail];
+         i < p_graph->p_child_offsets[tail + 1];
+         ++i)
+    {
+        if (p_graph->p_child_array[i] == head) return TRUE;
+    }
+
+    return FALSE;
+}
+
+/*******************************************************************************
+* Checks that 'p_result' is 'p_graph' relabeled by the ordering.               *
+*******************************************************************************/
+static int is_relabeling(graph_ordering* p_ordering,
+                         compact_graph* p_graph,
+                         compact_graph* p_result)
+{
+    size_t* p_new_index_array = p_ordering->p_new_index_array;
+    size_t  node;
+    size_t  i;
+
+    if (!p_result
+        || p_result->nodes != p_graph->nodes
+        || p_result->arcs != p_graph->arcs)
+    {
+        return FALSE;
+    }
+
+    for (node = 0; node < p_graph->nodes; ++node)
+    {
+        if (compact_graph_in_degree(p_graph, node) !=
+            compact_graph_in_degree(p_result, p_new_index_array[node]))
+        {
+            return FALSE;
+        }
+
+        for (i = p_graph->p_child_offsets[node];
+             i < p_graph->p_child_offsets[node + 1];
+             ++i)
+        {
+            if (!has_arc(p_result,
+                         p_new_index_array[node],
+                         p_new_index_array[p_graph->p_child_array[i]]))
+            {
+                return FALSE;
+            }
+        }
+    }
+
+    return TRUE;
+}
+
+/*******************************************************************************
+* Returns the largest index difference over the arcs.                          *
+*******************************************************************************/
+static size_t bandwidth(compact_graph* p_graph)
+{
+    size_t max_difference = 0;
+    size_t difference;
+    size_t node;
+    size_t i;
+
+    for (node = 0; node < p_graph->nodes; ++node)
+    {
+        for (i = p_graph->p_child_offsets[node];
+             i < p_graph->p_child_offsets[node + 1];
+             ++i)
+        {
+            difference = node > p_graph->p_child_array[i] ?
+                         node - p_graph->p_child_array[i] :
+                         p_graph->p_child_array[i] - node;
+
+            if (max_difference < difference) max_difference = difference;
+        }
+    }
+
+    return max_difference;
+}
+
+/*******************************************************************************
+* Returns a copy of the graph with the nodes shuffled.                         *
+*******************************************************************************/
+static compact_graph* shuffle(compact_graph* p_graph, unsigned long seed)
+{
+    graph_ordering* p_ordering = ordering_alloc(p_graph->nodes);
+    compact_graph*  p_result;
+    philox          random;
+    size_t          i;
+    size_t          j;
+    size_t          tmp;
+
+    philox_init(&random, seed, 0);
+
+    for (i = 0; i < p_graph->nodes; ++i)
+    {
+        p_ordering->p_old_index_array[i] = i;
+    }
+
+    for (i = p_graph->nodes; i > 1; --i)
+    {
+        j   = philox_below(&random, i);
+        tmp = p_ordering->p_old_index_array[i - 1];
+        p_ordering->p_old_index_array[i - 1] =
+            p_ordering->p_old_index_array[j];
+        p_ordering->p_old_index_array[j] = tmp;
+    }
+
+    for (i = 0; i < p_graph->nodes; ++i)
+    {
+        p_ordering->p_new_index_array[p_ordering->p_old_index_array[i]] = i;
+    }
+
+    p_result = graph_ordering_apply(p_ordering, p_graph, 2);
+    ASSERT(is_relabeling(p_ordering, p_graph, p_result));
+    graph_ordering_free(p_ordering);
+    return p_result;
+}
+
+static void graph_ordering_test_bandwidth()
+{
+    compact_graph*  p_grid;
+    compact_graph*  p_shuffled;
+    compact_graph*  p_result;
+    graph_ordering* p_ordering;
+
+    puts("        graph_ordering_test_bandwidth()");
+
+    /* A path comes out as a path again. */
+    p_grid     = graph_generator_grid(50, 1, 1, 1);
+    p_shuffled = shuffle(p_grid, 3);
+    ASSERT(p_shuffled != NULL);
+    ASSERT(bandwidth(p_shuffled) > 1);
+
+    p_ordering = graph_ordering_reverse_cuthill_mckee(p_shuffled);
+    ASSERT(is_permutation(p_ordering, 50));
+    p_result = graph_ordering_apply(p_ordering, p_shuffled, 1);
+    ASSERT(is_relabeling(p_ordering, p_shuffled, p_result));
+    ASSERT(bandwidth(p_result) == 1);
+    graph_ordering_free(p_ordering);
+    compact_graph_free(p_result);
+
+    p_ordering = graph_ordering_bfs(p_shuffled);
+    ASSERT(is_permutation(p_ordering, 50));
+    p_result = graph_ordering_apply(p_ordering, p_shuffled, 1);
+    ASSERT(bandwidth(p_result) <= 2);
+    graph_ordering_free(p_ordering);
+    compact_graph_free(p_result);
+    compact_graph_free(p_shuffled);
+    compact_graph_free(p_grid);
+
+    /* A grid gets a bandwidth about its width. */
+    p_grid     = graph_generator_grid(20, 20, 1, 1);
+    p_shuffled = shuffle(p_grid, 4);
+    ASSERT(p_shuffled != NULL);
+    p_ordering = graph_ordering_reverse_cuthill_mckee(p_shuffled);
+    ASSERT(is_permutation(p_ordering, 400));
+    p_result = graph_ordering_apply(p_ordering, p_shuffled, 3);
+    ASSERT(is_relabeling(p_ordering, p_shuffled, p_result));
+    ASSERT(bandwidth(p_result) <= 40);
+    ASSERT(bandwidth(p_shuffled) > 100);
+    graph_ordering_free(p_ordering);
+    compact_graph_free(p_result);
+    compact_graph_free(p_shuffled);
+    compact_graph_free(p_grid);
+}
+
+static void graph_ordering_test_random()
+{
+    compact_graph*  p_graph;
+    compact_graph*  p_result;
+    graph_ordering* p_ordering;
+    size_t          kind;
+    size_t          i;
+
+    puts("        graph_ordering_test_random()");
+
+    /* A graph with hubs, isolated nodes and several components. */
+    p_graph = graph_generator_rmat(1000, 3000, 0.57, 0.19, 0.19, 7, 2);
+    ASSERT(p_graph != NULL);
+
+    for (kind = 0; kind < 4; ++kind)
+    {
+        switch (kind)
+        {
+            case 0:
+                p_ordering = graph_ordering_bfs(p_graph);
+                break;
+
+            case 1:
+                p_ordering = graph_ordering_reverse_cuthill_mckee(p_graph);
+                break;
+
+            case 2:
+                p_ordering = graph_ordering_degree(p_graph);
+                break;
+
+            default:
+                p_ordering = graph_ordering_gorder(p_graph, 5);
+                break;
+        }
+
+        ASSERT(is_permutation(p_ordering, 1000));
+        p_result = graph_ordering_apply(p_ordering, p_graph, 0);
+        ASSERT(is_relabeling(p_ordering, p_graph, p_result));
+
+        if (kind == 2)
+        {
+            for (i = 1; i < 1000; ++i)
+            {
+                ASSERT(degree_of(p_result, i - 1) >= degree_of(p_result, i));
+
+                if (degree_of(p_result, i - 1) == degree_of(p_result, i))
+                {
+                    ASSERT(p_ordering->p_old_index_array[i - 1] <
+                           p_ordering->p_old_index_array[i]);
+                }
+            }
+        }
+
+        graph_ordering_free(p_ordering);
+        compact_graph_free(p_result);
+    }
+
+    compact_graph_free(p_graph);
+}
+
+static void graph_ordering_test_restore()
+{
+    compact_graph*  p_graph;
+    graph_ordering* p_ordering;
+    size_t          p_new_array[4];
+    size_t          p_old_array[4];
+    double          p_new_value_array[4] = { 0.5, 1.5, 2.5, 3.5 };
+    double          p_old_value_array[4];
+    size_t          i;
+
+    puts("        graph_ordering_test_restore()");
+
+    /* The path 0 - 1 - 2 - 3 numbered by degree: 1, 2, 0, 3. */
+    p_graph    = graph_generator_grid(4, 1, 1, 1);
+    p_ordering = graph_ordering_degree(p_graph);
+    ASSERT(p_ordering->p_old_index_array[0] == 1);
+    ASSERT(p_ordering->p_old_index_array[1] == 2);
+    ASSERT(p_ordering->p_old_index_array[2] == 0);
+    ASSERT(p_ordering->p_old_index_array[3] == 3);
+
+    graph_ordering_restore(p_ordering,
+                           p_new_value_array,
+                           p_old_value_array,
+                           sizeof(double));
+    ASSERT(p_old_value_array[1] == 0.5);
+    ASSERT(p_old_value_array[3] == 3.5);
+
+    /* A parent array on the new labels; the root has no parent. */
+    for (i = 0; i < 4; ++i)
+    {
+        p_new_array[i] = 0;
+    }
+
+    p_new_array[0] = 4;
+    graph_ordering_restore_indices(p_ordering, p_new_array, p_old_array);
+    ASSERT(p_old_array[1] == 4);
+    ASSERT(p_old_array[0] == 1);
+    ASSERT(p_old_array[2] == 1);
+    ASSERT(p_old_array[3] == 1);
+
+    graph_ordering_free(p_ordering);
+    compact_graph_free(p_graph);
+}
+
+void graph_ordering_test()
+{
+    puts("    graph_ordering_test()");
+    graph_ordering_test_bandwidth();
+    graph_ordering_test_random();
+    graph_ordering_test_restore();
+}
@@ -0,0 +1,104 @@
+#ifndef GRAPH_ORDERING_H
+#define GRAPH_ORDERING_H
+
+#include "compact_graph.h"
+#include <stddef.h>
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * A relabeling of the nodes of a compact graph. Traversals touch the rows  *
+    * of neighboring nodes one after another, so numbering the neighbors close *
+    * to each other turns random memory accesses into nearly sequential ones.  *
+    ***************************************************************************/
+    typedef struct graph_ordering {
+        size_t  nodes;
+
+        /* Maps each old node index to its new index. */
+        size_t* p_new_index_array;
+
+        /* Maps each new node index back to the old one. */
+        size_t* p_old_index_array;
+    } graph_ordering;
+
+    /***************************************************************************
+    * The orderings below treat the arcs as undirected; the degree of a node   *
+    * is the sum of its out- and in-degree. All return NULL if the memory ran  *
+    * out.                                                                     *
+    ***************************************************************************/
+
+    /***************************************************************************
+    * Numbers the nodes in breadth-first order, starting a new search from the *
+    * smallest unnumbered index whenever a component is exhausted.             *
+    ***************************************************************************/
+    graph_ordering* graph_ordering_bfs(compact_graph* p_graph);
+
+    /***************************************************************************
+    * Computes the reverse Cuthill-McKee ordering: each component is searched  *
+    * breadth-first from a pseudo-peripheral node, visiting the neighbors by   *
+    * ascending degree, and the whole order is reversed. This keeps the arcs   *
+    * near the diagonal of the adjacency matrix.                               *
+    ***************************************************************************/
+    graph_ordering* graph_ordering_reverse_cuthill_mckee(
+        compact_graph* p_graph);
+
+    /***************************************************************************
+    * Numbers the nodes by descending degree, so that the hubs share a few     *
+    * cache lines. Nodes of equal degree keep their relative order.            *
+    ***************************************************************************/
+    graph_ordering* graph_ordering_degree(compact_graph* p_graph);
+
+    /***************************************************************************
+    * Computes a Gorder ordering: the next node is always the one sharing the  *
+    * most arcs and common parents with the last 'window' numbered nodes, so   *
+    * that nodes used together land in the same cache lines. Parents with more *
+    * than about the square root of the node count children are ignored when   *
+    * scoring common parents.                                                  *
+    ***************************************************************************/
+    graph_ordering* graph_ordering_gorder(compact_graph* p_graph,
+                                          size_t window);
+
+    /***************************************************************************
+    * Builds a copy of 'p_graph' with the nodes relabeled by the ordering. The *
+    * rows of the copy are sorted by index. If the graph has a node array, the *
+    * copy has it permuted along with an index map of its own. 'threads' zero  *
+    * means the hardware concurrency.                                          *
+    ***************************************************************************/
+    compact_graph* graph_ordering_apply(graph_ordering* p_ordering,
+                                        compact_graph* p_graph,
+                                        size_t threads);
+
+    /***************************************************************************
+    * Translates a result computed on the relabeled graph back: the element    *
+    * of 'p_new_array' at each new index is copied to its old index in         *
+    * 'p_old_array'. Elements are 'element_size' bytes long.                   *
+    ***************************************************************************/
+    void graph_ordering_restore(graph_ordering* p_ordering,
+                                const void* p_new_array,
+                                void* p_old_array,
+                                size_t element_size);
+
+    /***************************************************************************
+    * Like 'graph_ordering_restore' for arrays holding node indices, such as   *
+    * parent arrays. The indices are translated too; values not less than the  *
+    * number of nodes are kept as they are.                                    *
+    ***************************************************************************/
+    void graph_ordering_restore_indices(graph_ordering* p_ordering,
+                                        const size_t* p_new_array,
+                                        size_t* p_old_array);
+
+    /***************************************************************************
+    * Deallocates the ordering.                                                *
+    ***************************************************************************/
+    void graph_ordering_free(graph_ordering* p_ordering);
+
+    /* Contains the unit tests. */
+    void graph_ordering_test();
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif  /* GRAPH_ORDERING_H */
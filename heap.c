@@ -0,0 +1,907 @@
+#include "allocation.h"
+#include "heap.h"
+#include "my_assert.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define FALSE 0
+#define TRUE 1
+
+#define HEAP_CACHE_LINE 64
+#define HEAP_NODES_PER_BLOCK 256
+
+/*******************************************************************************
+* A heap node is the handle of an element. The d-ary heap uses only 'index',   *
+* the position of the node's entry in the array; the pairing heap uses the     *
+* child, sibling and 'p_prev' links, where 'p_prev' points to the left         *
+* sibling or, for the leftmost child, to the parent.                           *
+*******************************************************************************/
+typedef struct heap_node {
+    void*             p_element;
+    double            priority;
+    size_t            index;
+    struct heap_node* p_child;
+    struct heap_node* p_sibling;
+    struct heap_node* p_prev;
+} heap_node;
+
+/*******************************************************************************
+* The nodes are carved out of blocks. Each node starts at a multiple of the    *
+* node stride, a power of two, from a cache line boundary, so no node is       *
+* split between two cache lines.                                               *
+*******************************************************************************/
+typedef struct heap_node_block {
+    struct heap_node_block* p_next;
+} heap_node_block;
+
+static void* align_to_cache_line(void* p_memory)
+{
+    size_t misalignment = (size_t) p_memory % HEAP_CACHE_LINE;
+
+    return misalignment == 0 ?
+           p_memory :
+           (char*) p_memory + (HEAP_CACHE_LINE - misalignment);
+}
+
+static size_t compute_node_stride()
+{
+    size_t stride = 1;
+
+    while (stride < sizeof(heap_node))
+    {
+        stride <<= 1;
+    }
+
+    return stride;
+}
+
+static size_t node_block_bytes(heap* p_heap)
+{
+    return sizeof(heap_node_block)
+         + HEAP_CACHE_LINE
+         + p_heap->node_stride * HEAP_NODES_PER_BLOCK;
+}
+
+static heap_node* node_alloc(heap* p_heap, void* p_element, double priority)
+{
+    heap_node_block* p_block;
+    heap_node*       p_node;
+    char*            p_nodes;
+    size_t           i;
+
+    if (!p_heap->p_free_list)
+    {
+        p_block = allocation_alloc(ALLOCATION_HEAP, node_block_bytes(p_heap));
+
+        if (!p_block) return NULL;
+
+        p_block->p_next = p_heap->p_block_list;
+        p_heap->p_block_list = p_block;
+        p_nodes = align_to_cache_line(p_block + 1);
+
+        for (i = HEAP_NODES_PER_BLOCK; i > 0; --i)
+        {
+            p_node = (heap_node*)(p_nodes + (i - 1) * p_heap->node_stride);
+            p_node->p_sibling = p_heap->p_free_list;
+            p_heap->p_free_list = p_node;
+        }
+    }
+
+    p_node = p_heap->p_free_list;
+    p_heap->p_free_list = p_node->p_sibling;
+    p_node->p_element = p_element;
+    p_node->priority  = priority;
+    p_node->index     = 0;
+    p_node->p_child   = NULL;
+    p_node->p_sibling = NULL;
+    p_node->p_prev    = NULL;
+    return p_node;
+}
+
+static void node_release(heap* p_heap, heap_node* p_node)
+{
+    p_node->p_sibling = p_heap->p_free_list;
+    p_heap->p_free_list = p_node;
+}
+
+/*******************************************************************************
+* The d-ary heap array is shifted by 'degree - 1' entries from a cache line    *
+* boundary. This way the children of the entry 'i', which start at the index   *
+* 'degree * i + 1', start at a multiple of 'degree' from the boundary, so with *
+* a degree filling whole cache lines each group of siblings is one line.       *
+*******************************************************************************/
+static size_t entry_memory_bytes(heap* p_heap, size_t capacity)
+{
+    return sizeof(heap_entry) * (capacity + p_heap->degree) + HEAP_CACHE_LINE;
+}
+
+static int ensure_entry_capacity(heap* p_heap, size_t capacity)
+{
+    void*       p_memory;
+    heap_entry* p_entry_array;
+    size_t      new_capacity;
+
+    if (capacity <= p_heap->entry_capacity) return TRUE;
+
+    new_capacity = p_heap->entry_capacity ? p_heap->entry_capacity : 16;
+
+    while (new_capacity < capacity)
+    {
+        new_capacity *= 2;
+    }
+
+    p_memory = allocation_alloc(ALLOCATION_HEAP,
+                                entry_memory_bytes(p_heap, new_capacity));
+
+    if (!p_memory) return FALSE;
+
+    p_entry_array = (heap_entry*) align_to_cache_line(p_memory)
+                    + (p_heap->degree - 1);
+
+    if (p_heap->size > 0)
+    {
+        memcpy(p_entry_array,
+               p_heap->p_entry_array,
+               sizeof(heap_entry) * p_heap->size);
+    }
+
+    allocation_free(ALLOCATION_HEAP,
+                    p_heap->p_entry_memory,
+                    entry_memory_bytes(p_heap, p_heap->entry_capacity));
+    p_heap->p_entry_memory = p_memory;
+    p_heap->p_entry_array  = p_entry_array;
+    p_heap->entry_capacity = new_capacity;
+    return TRUE;
+}
+
+static void sift_up(heap* p_heap, size_t index)
+{
+    heap_entry* p_entry_array = p_heap->p_entry_array;
+    heap_entry  entry = p_entry_array[index];
+    size_t      parent;
+
+    while (index > 0)
+    {
+        parent = (index - 1) / p_heap->degree;
+
+        if (p_entry_array[parent].priority <= entry.priority) break;
+
+        p_entry_array[index] = p_entry_array[parent];
+        p_entry_array[index].p_node->index = index;
+        index = parent;
+    }
+
+    p_entry_array[index] = entry;
+    entry.p_node->index = index;
+}
+
+static void sift_down(heap* p_heap, size_t index)
+{
+    heap_entry* p_entry_array = p_heap->p_entry_array;
+    heap_entry  entry = p_entry_array[index];
+    size_t      first_child;
+    size_t      last_child;
+    size_t      min_child;
+    size_t      child;
+
+    for (;;)
+    {
+        first_child = p_heap->degree * index + 1;
+
+        if (first_child >= p_heap->size) break;
+
+        last_child = first_child + p_heap->degree;
+
+        if (last_child > p_heap->size)
+        {
+            last_child = p_heap->size;
+        }
+
+        min_child = first_child;
+
+        for (child = first_child + 1; child < last_child; ++child)
+        {
+            if (p_entry_array[child].priority <
+                p_entry_array[min_child].priority)
+            {
+                min_child = child;
+            }
+        }
+
+        if (entry.priority <= p_entry_array[min_child].priority) break;
+
+        p_entry_array[index] = p_entry_array[min_child];
+        p_entry_array[index].p_node->index = index;
+        index = min_child;
+    }
+
+    p_entry_array[index] = entry;
+    entry.p_node->index = index;
+}
+
+/*******************************************************************************
+* Links two pairing heap roots: the one with the larger priority becomes the   *
+* leftmost child of the other one.                                             *
+*******************************************************************************/
+static heap_node* pairing_link(heap_node* p_a, heap_node* p_b)
+{
+    heap_node* p_tmp;
+
+    if (p_b->priority < p_a->priority)
+    {
+        p_tmp = p_a;
+        p_a = p_b;
+        p_b = p_tmp;
+    }
+
+    p_b->p_sibling = p_a->p_child;
+
+    if (p_a->p_child)
+    {
+        p_a->p_child->p_prev = p_b;
+    }
+
+    p_b->p_prev = p_a;
+    p_a->p_child = p_b;
+    return p_a;
+}
+
+/*******************************************************************************
+* Merges a list of sibling trees into one using the standard two-pass scheme:  *
+* link the trees in pairs left to right, then link the pairs right to left.    *
+*******************************************************************************/
+static heap_node* merge_pairs(heap_node* p_first)
+{
+    heap_node* p_pairs = NULL;
+    heap_node* p_a;
+    heap_node* p_b;
+    heap_node* p_next;
+    heap_node* p_result = NULL;
+
+    while (p_first)
+    {
+        p_a = p_first;
+        p_b = p_a->p_sibling;
+        p_next = p_b ? p_b->p_sibling : NULL;
+
+        p_a->p_sibling = NULL;
+        p_a->p_prev = NULL;
+
+        if (p_b)
+        {
+            p_b->p_sibling = NULL;
+            p_b->p_prev = NULL;
+            p_a = pairing_link(p_a, p_b);
+        }
+
+        /* Push the pair to a stack so that the second pass goes right to
+           left. */
+        p_a->p_sibling = p_pairs;
+        p_pairs = p_a;
+        p_first = p_next;
+    }
+
+    while (p_pairs)
+    {
+        p_next = p_pairs->p_sibling;
+        p_pairs->p_sibling = NULL;
+        p_result = p_result ? pairing_link(p_result, p_pairs) : p_pairs;
+        p_pairs = p_next;
+    }
+
+    return p_result;
+}
+
+/*******************************************************************************
+* Detaches a non-root node, together with its subtree, from the pairing heap.  *
+*******************************************************************************/
+static void cut(heap_node* p_node)
+{
+    if (p_node->p_prev->p_child == p_node)
+    {
+        p_node->p_prev->p_child = p_node->p_sibling;
+    }
+    else
+    {
+        p_node->p_prev->p_sibling = p_node->p_sibling;
+    }
+
+    if (p_node->p_sibling)
+    {
+        p_node->p_sibling->p_prev = p_node->p_prev;
+    }
+
+    p_node->p_sibling = NULL;
+    p_node->p_prev = NULL;
+}
+
+int heap_init(heap* p_heap,
+              int backend,
+              size_t degree,
+              size_t initial_capacity,
+              size_t (*p_hash_function)(void*),
+              int (*p_equals_function)(void*, void*))
+{
+    if (!p_heap) return FALSE;
+
+    if (backend != HEAP_D_ARY && backend != HEAP_PAIRING) return FALSE;
+
+    if (degree == 0)
+    {
+        degree = HEAP_DEFAULT_DEGREE;
+    }
+    else if (degree < 2)
+    {
+        return FALSE;
+    }
+
+    if (!unordered_map_init(&p_heap->handle_map,
+                            initial_capacity,
+                            1.0f,
+                            p_hash_function,
+                            p_equals_function))
+    {
+        return FALSE;
+    }
+
+    p_heap->backend        = backend;
+    p_heap->degree         = degree;
+    p_heap->size           = 0;
+    p_heap->p_entry_array  = NULL;
+    p_heap->p_entry_memory = NULL;
+    p_heap->entry_capacity = 0;
+    p_heap->p_root         = NULL;
+    p_heap->p_block_list   = NULL;
+    p_heap->p_free_list    = NULL;
+    p_heap->node_stride    = compute_node_stride();
+
+    if (backend == HEAP_D_ARY
+        && !ensure_entry_capacity(p_heap, initial_capacity))
+    {
+        unordered_map_destroy(&p_heap->handle_map);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+heap* heap_alloc(int backend,
+                 size_t degree,
+                 size_t initial_capacity,
+                 size_t (*p_hash_function)(void*),
+                 int (*p_equals_function)(void*, void*))
+{
+    heap* p_heap = allocation_alloc(ALLOCATION_HEAP, sizeof(*p_heap));
+
+    if (!p_heap) return NULL;
+
+    if (!heap_init(p_heap,
+                   backend,
+                   degree,
+                   initial_capacity,
+                   p_hash_function,
+                   p_equals_function))
+    {
+        allocation_free(ALLOCATION_HEAP, p_heap, sizeof(*p_heap));
+        return NULL;
+    }
+
+    return p_heap;
+}
+
+/*******************************************************************************
+* Allocates a node for the element and maps the element to it. Returns NULL if *
+* the element is already present or the memory ran out.                        *
+*******************************************************************************/
+static heap_node* add_handle(heap* p_heap, void* p_element, double priority)
+{
+    heap_node* p_node;
+
+    if (unordered_map_get(&p_heap->handle_map, p_element)) return NULL;
+
+    if (!(p_node = node_alloc(p_heap, p_element, priority))) return NULL;
+
+    unordered_map_put(&p_heap->handle_map, p_element, p_node);
+    return p_node;
+}
+
+int heap_add(heap* p_heap, void* p_element, double priority)
+{
+    heap_node* p_node;
+
+    if (!p_heap) return FALSE;
+
+    if (p_heap->backend == HEAP_D_ARY
+        && !ensure_entry_capacity(p_heap, p_heap->size + 1))
+    {
+        return FALSE;
+    }
+
+    if (!(p_node = add_handle(p_heap, p_element, priority))) return FALSE;
+
+    if (p_heap->backend == HEAP_D_ARY)
+    {
+        p_heap->p_entry_array[p_heap->size].priority = priority;
+        p_heap->p_entry_array[p_heap->size].p_node = p_node;
+        p_heap->size++;
+        sift_up(p_heap, p_heap->size - 1);
+    }
+    else
+    {
+        p_heap->p_root = p_heap->p_root ? pairing_link(p_heap->p_root, p_node)
+                                        : p_node;
+        p_heap->size++;
+    }
+
+    return TRUE;
+}
+
+int heap_decrease_key(heap* p_heap, void* p_element, double priority)
+{
+    heap_node* p_node;
+
+    if (!p_heap) return FALSE;
+
+    p_node = unordered_map_get(&p_heap->handle_map, p_element);
+
+    if (!p_node || priority > p_node->priority) return FALSE;
+
+    p_node->priority = priority;
+
+    if (p_heap->backend == HEAP_D_ARY)
+    {
+        p_heap->p_entry_array[p_node->index].priority = priority;
+        sift_up(p_heap, p_node->index);
+    }
+    else if (p_node != p_heap->p_root)
+    {
+        cut(p_node);
+        p_heap->p_root = pairing_link(p_heap->p_root, p_node);
+    }
+
+    return TRUE;
+}
+
+int heap_heapify(heap* p_heap,
+                 void** p_element_array,
+                 double* p_priority_array,
+                 size_t count)
+{
+    heap_node* p_node;
+    heap_node* p_list = NULL;
+    heap_node* p_merged;
+    size_t     i;
+    size_t     index;
+    int        ok = TRUE;
+
+    if (!p_heap || (count > 0 && (!p_element_array || !p_priority_array)))
+    {
+        return FALSE;
+    }
+
+    if (p_heap->backend == HEAP_D_ARY
+        && !ensure_entry_capacity(p_heap, p_heap->size + count))
+    {
+        return FALSE;
+    }
+
+    for (i = 0; i < count; ++i)
+    {
+        p_node = add_handle(p_heap, p_element_array[i], p_priority_array[i]);
+
+        if (!p_node)
+        {
+            ok = FALSE;
+            break;
+        }
+
+        if (p_heap->backend == HEAP_D_ARY)
+        {
+            p_heap->p_entry_array[p_heap->size].priority = p_node->priority;
+            p_heap->p_entry_array[p_heap->size].p_node = p_node;
+            p_node->index = p_heap->size;
+        }
+        else
+        {
+            p_node->p_sibling = p_list;
+            p_list = p_node;
+        }
+
+        p_heap->size++;
+    }
+
+    if (p_heap->backend == HEAP_D_ARY)
+    {
+        /* Floyd's bottom-up construction over the whole array. */
+        if (p_heap->size > 1)
+        {
+            for (index = (p_heap->size - 2) / p_heap->degree + 1;
+                 index > 0;
+                 --index)
+            {
+                sift_down(p_heap, index - 1);
+            }
+        }
+    }
+    else if (p_list)
+    {
+        p_merged = merge_pairs(p_list);
+        p_heap->p_root = p_heap->p_root ? pairing_link(p_heap->p_root, p_merged)
+                                        : p_merged;
+    }
+
+    return ok;
+}
+
+int heap_contains(heap* p_heap, void* p_element)
+{
+    if (!p_heap) return FALSE;
+
+    return unordered_map_get(&p_heap->handle_map, p_element) != NULL;
+}
+
+double heap_priority(heap* p_heap, void* p_element)
+{
+    heap_node* p_node = unordered_map_get(&p_heap->handle_map, p_element);
+
+    return p_node->priority;
+}
+
+void* heap_min(heap* p_heap)
+{
+    if (!p_heap || p_heap->size == 0) return NULL;
+
+    return p_heap->backend == HEAP_D_ARY ?
+           p_heap->p_entry_array[0].p_node->p_element :
+           p_heap->p_root->p_element;
+}
+
+void* heap_extract_min(heap* p_heap)
+{
+    heap_node* p_node;
+    void*      p_element;
+
+    if (!p_heap || p_heap->size == 0) return NULL;
+
+    if (p_heap->backend == HEAP_D_ARY)
+    {
+        p_node = p_heap->p_entry_array[0].p_node;
+
+        if (--p_heap->size > 0)
+        {
+            p_heap->p_entry_array[0] = p_heap->p_entry_array[p_heap->size];
+            sift_down(p_heap, 0);
+        }
+    }
+    else
+    {
+        p_node = p_heap->p_root;
+        p_heap->p_root = merge_pairs(p_node->p_child);
+        p_heap->size--;
+    }
+
+    p_element = p_node->p_element;
+    unordered_map_remove(&p_heap->handle_map, p_element);
+    node_release(p_heap, p_node);
+    return p_element;
+}
+
+size_t heap_size(heap* p_heap)
+{
+    return p_heap ? p_heap->size : 0;
+}
+
+void heap_clear(heap* p_heap)
+{
+    heap_node_block* p_block;
+    heap_node_block* p_next;
+
+    if (!p_heap) return;
+
+    unordered_map_clear(&p_heap->handle_map);
+
+    for (p_block = p_heap->p_block_list; p_block; p_block = p_next)
+    {
+        p_next = p_block->p_next;
+        allocation_free(ALLOCATION_HEAP, p_block, node_block_bytes(p_heap));
+    }
+
+    p_heap->p_block_list = NULL;
+    p_heap->p_free_list  = NULL;
+    p_heap->p_root       = NULL;
+    p_heap->size         = 0;
+}
+
+static int pairing_heap_is_healthy(heap* p_heap)
+{
+    heap_node** p_stack;
+    heap_node*  p_node;
+    heap_node*  p_child;
+    heap_node*  p_prev;
+    size_t      stack_size = 0;
+    size_t      visited = 0;
+    int         healthy = TRUE;
+
+    if (!p_heap->p_root) return p_heap->size == 0;
+
+    if (p_heap->p_root->p_prev || p_heap->p_root->p_sibling) return FALSE;
+
+    p_stack = malloc(sizeof(heap_node*) * p_heap->size);
+
+    if (!p_stack) return FALSE;
+
+    p_stack[stack_size++] = p_heap->p_root;
+
+    while (healthy && stack_size > 0)
+    {
+        p_node = p_stack[--stack_size];
+
+        if (++visited > p_heap->size
+            || unordered_map_get(&p_heap->handle_map,
+                                 p_node->p_element) != p_node)
+        {
+            healthy = FALSE;
+            break;
+        }
+
+        p_prev = p_node;
+
+        for (p_child = p_node->p_child; p_child; p_child = p_child->p_sibling)
+        {
+            if (p_child->p_prev != p_prev
+                || p_child->priority < p_node->priority
+                || stack_size == p_heap->size)
+            {
+                healthy = FALSE;
+                break;
+            }
+
+            p_stack[stack_size++] = p_child;
+            p_prev = p_child;
+        }
+    }
+
+    free(p_stack);
+    return healthy && visited == p_heap->size;
+}
+
+int heap_is_healthy(heap* p_heap)
+{
+    heap_entry* p_entry_array;
+    size_t      i;
+
+    if (!p_heap) return FALSE;
+
+    if (unordered_map_size(&p_heap->handle_map) != p_heap->size) return FALSE;
+
+    if (p_heap->backend == HEAP_PAIRING) return pairing_heap_is_healthy(p_heap);
+
+    p_entry_array = p_heap->p_entry_array;
+
+    for (i = 0; i < p_heap->size; ++i)
+    {
+        if (p_entry_array[i].p_node->index != i
+            || p_entry_array[i].p_node->priority != p_entry_array[i].priority
+            || unordered_map_get(&p_heap->handle_map,
+                                 p_entry_array[i].p_node->p_element)
+               != p_entry_array[i].p_node)
+        {
+            return FALSE;
+        }
+
+        if (i > 0 && p_entry_array[(i - 1) / p_heap->degree].priority >
+                     p_entry_array[i].priority)
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+void heap_destroy(heap* p_heap)
+{
+    if (!p_heap) return;
+
+    heap_clear(p_heap);
+    unordered_map_destroy(&p_heap->handle_map);
+    allocation_free(ALLOCATION_HEAP,
+                    p_heap->p_entry_memory,
+                    entry_memory_bytes(p_heap, p_heap->entry_capacity));
+    p_heap->p_entry_memory = NULL;
+    p_heap->p_entry_array  = NULL;
+    p_heap->entry_capacity = 0;
+}
+
+void heap_free(heap* p_heap)
+{
+    if (!p_heap) return;
+
+    heap_destroy(p_heap);
+    allocation_free(ALLOCATION_HEAP, p_heap, sizeof(*p_heap));
+}
+
+size_t heap_memory_usage(heap* p_heap)
+{
+    heap_node_block* p_block;
+    size_t           bytes;
+
+    if (!p_heap) return 0;
+
+    /* The handle map counts the heap structure it is embedded in. */
+    bytes = unordered_map_memory_usage(&p_heap->handle_map)
+          - sizeof(p_heap->handle_map)
+          + sizeof(*p_heap);
+
+    if (p_heap->p_entry_memory)
+    {
+        bytes += entry_memory_bytes(p_heap, p_heap->entry_capacity);
+    }
+
+    for (p_block = p_heap->p_block_list; p_block; p_block = p_block->p_next)
+    {
+        bytes += node_block_bytes(p_heap);
+    }
+
+    return bytes;
+}
+
+static size_t element_hash_function(void* p_element)
+{
+    return (size_t) p_element;
+}
+
+static int element_equals_function(void* p_a, void* p_b)
+{
+    return p_a == p_b;
+}
+
+static heap* test_heap_alloc(int configuration)
+{
+    /* 0: binary, 1: 4-ary, 2: 8-ary, 3: pairing. */
+    static const size_t degrees[] = { 2, 4, 8 };
+
+    return configuration < 3 ?
+           heap_alloc(HEAP_D_ARY,
+                      degrees[configuration],
+                      2,
+                      element_hash_function,
+                      element_equals_function) :
+           heap_alloc(HEAP_PAIRING,
+                      0,
+                      2,
+                      element_hash_function,
+                      element_equals_function);
+}
+
+static void heap_test_basic()
+{
+    heap*  p_heap;
+    size_t configuration;
+
+    puts("        heap_test_basic()");
+
+    ASSERT(heap_alloc(HEAP_D_ARY, 1, 8, element_hash_function,
+                      element_equals_function) == NULL);
+    ASSERT(heap_alloc(7, 0, 8, element_hash_function,
+                      element_equals_function) == NULL);
+
+    for (configuration = 0; configuration < 4; ++configuration)
+    {
+        p_heap = test_heap_alloc((int) configuration);
+
+        ASSERT(heap_size(p_heap) == 0);
+        ASSERT(heap_min(p_heap) == NULL);
+        ASSERT(heap_extract_min(p_heap) == NULL);
+
+        ASSERT(heap_add(p_heap, (void*) 3, 3.0));
+        ASSERT(heap_add(p_heap, (void*) 1, 5.0));
+        ASSERT(heap_add(p_heap, (void*) 2, 4.0));
+        ASSERT(heap_add(p_heap, (void*) 2, 1.0) == FALSE);
+        ASSERT(heap_size(p_heap) == 3);
+        ASSERT(heap_contains(p_heap, (void*) 1));
+        ASSERT(heap_contains(p_heap, (void*) 4) == FALSE);
+        ASSERT(heap_min(p_heap) == (void*) 3);
+
+        ASSERT(heap_decrease_key(p_heap, (void*) 1, 2.0));
+        ASSERT(heap_decrease_key(p_heap, (void*) 1, 9.0) == FALSE);
+        ASSERT(heap_decrease_key(p_heap, (void*) 4, 1.0) == FALSE);
+        ASSERT(heap_priority(p_heap, (void*) 1) == 2.0);
+        ASSERT(heap_is_healthy(p_heap));
+
+        ASSERT(heap_extract_min(p_heap) == (void*) 1);
+        ASSERT(heap_extract_min(p_heap) == (void*) 3);
+        ASSERT(heap_contains(p_heap, (void*) 3) == FALSE);
+        ASSERT(heap_extract_min(p_heap) == (void*) 2);
+        ASSERT(heap_size(p_heap) == 0);
+
+        ASSERT(heap_add(p_heap, (void*) 5, 1.0));
+        heap_clear(p_heap);
+        ASSERT(heap_size(p_heap) == 0);
+        ASSERT(heap_contains(p_heap, (void*) 5) == FALSE);
+        ASSERT(heap_is_healthy(p_heap));
+
+        heap_free(p_heap);
+    }
+}
+
+static void heap_test_random()
+{
+    const size_t N = 2000;
+    heap*        p_heap;
+    double*      p_priority_array;
+    void**       p_element_array;
+    double       previous;
+    double       priority;
+    size_t       configuration;
+    size_t       i;
+    size_t       element;
+
+    puts("        heap_test_random()");
+
+    p_priority_array = malloc(sizeof(double) * (N + 1));
+    p_element_array  = malloc(sizeof(void*) * (N + 1));
+
+    for (configuration = 0; configuration < 4; ++configuration)
+    {
+        p_heap = test_heap_alloc((int) configuration);
+
+        /* The first half is added one by one, the second half in bulk. */
+        for (i = 1; i <= N / 2; ++i)
+        {
+            p_priority_array[i] = rand() % 1000;
+            ASSERT(heap_add(p_heap, (void*) i, p_priority_array[i]));
+        }
+
+        for (i = N / 2 + 1; i <= N; ++i)
+        {
+            p_priority_array[i] = rand() % 1000;
+            p_element_array[i] = (void*) i;
+        }
+
+        ASSERT(heap_heapify(p_heap,
+                            p_element_array + N / 2 + 1,
+                            p_priority_array + N / 2 + 1,
+                            N - N / 2));
+        ASSERT(heap_size(p_heap) == N);
+        ASSERT(heap_is_healthy(p_heap));
+
+        for (i = 0; i < N; ++i)
+        {
+            element = 1 + rand() % N;
+            priority = p_priority_array[element] - rand() % 100;
+            ASSERT(heap_decrease_key(p_heap, (void*) element, priority));
+            p_priority_array[element] = priority;
+        }
+
+        ASSERT(heap_is_healthy(p_heap));
+
+        previous = -1e9;
+
+        for (i = 0; i < N; ++i)
+        {
+            element = (size_t) heap_min(p_heap);
+            ASSERT(heap_extract_min(p_heap) == (void*) element);
+            ASSERT(p_priority_array[element] >= previous);
+            previous = p_priority_array[element];
+
+            if (i % 256 == 0)
+            {
+                ASSERT(heap_is_healthy(p_heap));
+            }
+        }
+
+        ASSERT(heap_size(p_heap) == 0);
+        heap_free(p_heap);
+    }
+
+    free(p_priority_array);
+    free(p_element_array);
+}
+
+void heap_test()
+{
+    puts("    heap_test()");
+    heap_test_basic();
+    heap_test_random();
+}
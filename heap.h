@@ -0,0 +1,166 @@
+#ifndef HEAP_H
+#define HEAP_H
+
+#include "unordered_map.h"
+#include <stddef.h>
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * The available heap backends. The d-ary heap keeps its entries in one     *
+    * implicit array, the pairing heap is a tree of nodes with O(1) amortized  *
+    * insertion and decrease-key.                                              *
+    ***************************************************************************/
+#define HEAP_D_ARY   0
+#define HEAP_PAIRING 1
+
+    /***************************************************************************
+    * The degree of the d-ary heap used when the requested degree is zero.     *
+    ***************************************************************************/
+#define HEAP_DEFAULT_DEGREE 4
+
+    struct heap_node;
+    struct heap_node_block;
+
+    /***************************************************************************
+    * An entry of the d-ary heap array. The priority is stored next to the     *
+    * node pointer so that comparing the children of a node reads one cache    *
+    * line.                                                                    *
+    ***************************************************************************/
+    typedef struct heap_entry {
+        double            priority;
+        struct heap_node* p_node;
+    } heap_entry;
+
+    /***************************************************************************
+    * An addressable min-priority queue over 'void*' elements with 'double'    *
+    * priorities. The handle map maps each element to its heap node, which    *
+    * makes 'heap_decrease_key' possible by the element alone.                 *
+    ***************************************************************************/
+    typedef struct heap {
+        unordered_map           handle_map;
+        int                     backend;
+        size_t                  degree;
+        size_t                  size;
+
+        /* The d-ary heap. 'p_entry_memory' is the unaligned allocation. */
+        heap_entry*             p_entry_array;
+        void*                   p_entry_memory;
+        size_t                  entry_capacity;
+
+        /* The pairing heap. */
+        struct heap_node*       p_root;
+
+        /* The pool of nodes shared by both backends. */
+        struct heap_node_block* p_block_list;
+        struct heap_node*       p_free_list;
+        size_t                  node_stride;
+    } heap;
+
+    /***************************************************************************
+    * Allocates a new, empty heap using the 'backend' (HEAP_D_ARY or           *
+    * HEAP_PAIRING). 'degree' is the number of children per node in the d-ary *
+    * heap and is ignored by the pairing heap. The hash and equality functions *
+    * are used by the handle map over the elements.                            *
+    ***************************************************************************/
+    heap* heap_alloc(int backend,
+                     size_t degree,
+                     size_t initial_capacity,
+                     size_t (*p_hash_function)(void*),
+                     int (*p_equals_function)(void*, void*));
+
+    /***************************************************************************
+    * Initializes a given heap to an empty state.                              *
+    ***************************************************************************/
+    int heap_init(heap* p_heap,
+                  int backend,
+                  size_t degree,
+                  size_t initial_capacity,
+                  size_t (*p_hash_function)(void*),
+                  int (*p_equals_function)(void*, void*));
+
+    /***************************************************************************
+    * Adds the element with the given priority. Returns false if the element   *
+    * is already in the heap or the memory ran out.                            *
+    ***************************************************************************/
+    int heap_add(heap* p_heap, void* p_element, double priority);
+
+    /***************************************************************************
+    * Lowers the priority of the element. Returns false if the element is not  *
+    * in the heap or 'priority' is larger than its current priority.           *
+    ***************************************************************************/
+    int heap_decrease_key(heap* p_heap, void* p_element, double priority);
+
+    /***************************************************************************
+    * Adds 'count' elements at once in linear time. Returns false if some      *
+    * element is already in the heap or the memory ran out; the elements       *
+    * preceding the failing one stay in the heap.                              *
+    ***************************************************************************/
+    int heap_heapify(heap* p_heap,
+                     void** p_element_array,
+                     double* p_priority_array,
+                     size_t count);
+
+    /***************************************************************************
+    * Returns a positive value if the element is in the heap.                  *
+    ***************************************************************************/
+    int heap_contains(heap* p_heap, void* p_element);
+
+    /***************************************************************************
+    * Returns the priority of the element, which must be in the heap.          *
+    ***************************************************************************/
+    double heap_priority(heap* p_heap, void* p_element);
+
+    /***************************************************************************
+    * Returns but does not remove the element with the lowest priority, or     *
+    * NULL if the heap is empty.                                               *
+    ***************************************************************************/
+    void* heap_min(heap* p_heap);
+
+    /***************************************************************************
+    * Removes and returns the element with the lowest priority, or NULL if the *
+    * heap is empty.                                                           *
+    ***************************************************************************/
+    void* heap_extract_min(heap* p_heap);
+
+    /***************************************************************************
+    * Returns the number of elements in the heap.                              *
+    ***************************************************************************/
+    size_t heap_size(heap* p_heap);
+
+    /***************************************************************************
+    * Removes all the elements from the heap.                                  *
+    ***************************************************************************/
+    void heap_clear(heap* p_heap);
+
+    /***************************************************************************
+    * Checks that the heap is in valid state.                                  *
+    ***************************************************************************/
+    int heap_is_healthy(heap* p_heap);
+
+    /***************************************************************************
+    * Destroys but does not deallocate the heap.                               *
+    ***************************************************************************/
+    void heap_destroy(heap* p_heap);
+
+    /***************************************************************************
+    * Deallocates the heap. The elements themselves are not deallocated.       *
+    ***************************************************************************/
+    void heap_free(heap* p_heap);
+
+    /***************************************************************************
+    * Returns the number of bytes allocated by the heap, its handle map and    *
+    * its node pool included.                                                  *
+    ***************************************************************************/
+    size_t heap_memory_usage(heap* p_heap);
+
+    /* Contains the unit tests. */
+    void heap_test();
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif  /* HEAP_H */
@@ -0,0 +1,692 @@
+#include "integer_dijkstra.h"
+#include "my_assert.h"
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FALSE 0
+#define TRUE 1
+
+#define RADIX_BUCKETS (sizeof(size_t) * CHAR_BIT + 1)
+
+/* Maximum arc weight for which 'integer_dijkstra' chooses Dial's buckets. */
+static const size_t DIAL_MAXIMUM_WEIGHT = 255;
+
+typedef struct heap_item {
+    size_t key;
+    size_t node;
+} heap_item;
+
+typedef struct item_vector {
+    heap_item* p_data;
+    size_t     size;
+    size_t     capacity;
+} item_vector;
+
+typedef struct radix_heap {
+    item_vector buckets[RADIX_BUCKETS];
+    size_t      last;
+    size_t      size;
+} radix_heap;
+
+static int item_vector_push(item_vector* p_vector, size_t key, size_t node)
+{
+    size_t     new_capacity;
+    heap_item* p_new_data;
+
+    if (p_vector->size == p_vector->capacity)
+    {
+        new_capacity = p_vector->capacity ? 2 * p_vector->capacity : 16;
+        p_new_data = realloc(p_vector->p_data, sizeof(heap_item) * new_capacity);
+
+        if (!p_new_data) return FALSE;
+
+        p_vector->p_data   = p_new_data;
+        p_vector->capacity = new_capacity;
+    }
+
+    p_vector->p_data[p_vector->size].key  = key;
+    p_vector->p_data[p_vector->size].node = node;
+    p_vector->size++;
+    return TRUE;
+}
+
+/* Returns the index of the most significant set bit of a non-zero word. */
+static size_t most_significant_bit(size_t word)
+{
+#if defined(__GNUC__) && !defined(_WIN64)
+    return sizeof(size_t) * CHAR_BIT - 1 - (size_t) __builtin_clzl(word);
+#else
+    size_t bit = 0;
+
+    while (word >>= 1)
+    {
+        ++bit;
+    }
+
+    return bit;
+#endif
+}
+
+static size_t radix_bucket_of(radix_heap* p_heap, size_t key)
+{
+    return key == p_heap->last ? 0
+                               : most_significant_bit(key ^ p_heap->last) + 1;
+}
+
+static int radix_heap_push(radix_heap* p_heap, size_t key, size_t node)
+{
+    if (!item_vector_push(&p_heap->buckets[radix_bucket_of(p_heap, key)],
+                          key,
+                          node))
+    {
+        return FALSE;
+    }
+
+    p_heap->size++;
+    return TRUE;
+}
+
+/*******************************************************************************
+* Pops an item with the minimum key. If the bucket 0 is empty, the first       *
+* non-empty bucket is emptied into the lower buckets relative to its minimum   *
+* key, which then lands in the bucket 0.                                       *
+*******************************************************************************/
+static heap_item radix_heap_pop(radix_heap* p_heap)
+{
+    item_vector* p_bucket;
+    size_t       bucket;
+    size_t       i;
+    size_t       minimum;
+
+    if (p_heap->buckets[0].size == 0)
+    {
+        for (bucket = 1; p_heap->buckets[bucket].size == 0; ++bucket)
+        {
+        }
+
+        p_bucket = &p_heap->buckets[bucket];
+        minimum  = p_bucket->p_data[0].key;
+
+        for (i = 1; i < p_bucket->size; ++i)
+        {
+            if (p_bucket->p_data[i].key < minimum)
+            {
+                minimum = p_bucket->p_data[i].key;
+            }
+        }
+
+        p_heap->last = minimum;
+
+        /* Every item goes to a strictly lower bucket, so pushing into the
+           lower buckets never reallocates 'p_bucket'. */
+        for (i = 0; i < p_bucket->size; ++i)
+        {
+            item_vector_push(
+                &p_heap->buckets[radix_bucket_of(p_heap,
+                                                 p_bucket->p_data[i].key)],
+                p_bucket->p_data[i].key,
+                p_bucket->p_data[i].node);
+        }
+
+        p_bucket->size = 0;
+    }
+
+    p_heap->size--;
+    return p_heap->buckets[0].p_data[--p_heap->buckets[0].size];
+}
+
+static void radix_heap_destroy(radix_heap* p_heap)
+{
+    size_t i;
+
+    for (i = 0; i < RADIX_BUCKETS; ++i)
+    {
+        free(p_heap->buckets[i].p_data);
+    }
+}
+
+static integer_shortest_paths* paths_alloc(compact_graph* p_graph,
+                                           size_t source)
+{
+    integer_shortest_paths* p_paths = malloc(sizeof(*p_paths));
+    size_t                  i;
+
+    if (!p_paths) return NULL;
+
+    p_paths->nodes            = p_graph->nodes;
+    p_paths->source           = source;
+    p_paths->p_distance_array = malloc(sizeof(size_t) * (p_graph->nodes + 1));
+    p_paths->p_parent_array   = malloc(sizeof(size_t) * (p_graph->nodes + 1));
+
+    if (!p_paths->p_distance_array || !p_paths->p_parent_array)
+    {
+        integer_shortest_paths_free(p_paths);
+        return NULL;
+    }
+
+    for (i = 0; i < p_graph->nodes; ++i)
+    {
+        p_paths->p_distance_array[i] = INTEGER_DIJKSTRA_INFINITY;
+        p_paths->p_parent_array[i]   = p_graph->nodes;
+    }
+
+    p_paths->p_distance_array[source] = 0;
+    return p_paths;
+}
+
+integer_shortest_paths* integer_dijkstra_radix_heap(compact_graph* p_graph,
+                                                    size_t* p_weight_array,
+                                                    size_t source,
+                                                    size_t target)
+{
+    integer_shortest_paths* p_paths;
+    radix_heap              heap;
+    heap_item               item;
+    size_t*                 p_distance_array;
+    size_t                  arc;
+    size_t                  child;
+    size_t                  distance;
+    int                     ok = TRUE;
+
+    if (!p_graph || !p_weight_array || source >= p_graph->nodes) return NULL;
+
+    if (!(p_paths = paths_alloc(p_graph, source))) return NULL;
+
+    p_distance_array = p_paths->p_distance_array;
+    memset(&heap, 0, sizeof(heap));
+    ok = radix_heap_push(&heap, 0, source);
+
+    while (ok && heap.size > 0)
+    {
+        item = radix_heap_pop(&heap);
+
+        /* Skip the entries superseded by a later improvement. */
+        if (item.key != p_distance_array[item.node]) continue;
+
+        if (item.node == target) break;
+
+        for (arc = p_graph->p_child_offsets[item.node];
+             arc < p_graph->p_child_offsets[item.node + 1];
+             ++arc)
+        {
+            child = p_graph->p_child_array[arc];
+            distance = item.key + p_weight_array[arc];
+
+            if (distance < p_distance_array[child])
+            {
+                p_distance_array[child] = distance;
+                p_paths->p_parent_array[child] = item.node;
+                ok &= radix_heap_push(&heap, distance, child);
+            }
+        }
+    }
+
+    radix_heap_destroy(&heap);
+
+    if (!ok)
+    {
+        integer_shortest_paths_free(p_paths);
+        return NULL;
+    }
+
+    return p_paths;
+}
+
+integer_shortest_paths* integer_dijkstra_dial(compact_graph* p_graph,
+                                              size_t* p_weight_array,
+                                              size_t source,
+                                              size_t target)
+{
+    integer_shortest_paths* p_paths;
+    item_vector*            p_bucket_array;
+    item_vector*            p_bucket;
+    heap_item               item;
+    size_t*                 p_distance_array;
+    size_t                  max_weight = 0;
+    size_t                  slots;
+    size_t                  items;
+    size_t                  current;
+    size_t                  arc;
+    size_t                  child;
+    size_t                  distance;
+    int                     ok;
+
+    if (!p_graph || !p_weight_array || source >= p_graph->nodes) return NULL;
+
+    for (arc = 0; arc < p_graph->arcs; ++arc)
+    {
+        if (p_weight_array[arc] > max_weight)
+        {
+            max_weight = p_weight_array[arc];
+        }
+    }
+
+    /* Tentative distances span at most 'max_weight + 1' consecutive values. */
+    slots = max_weight + 1;
+    p_bucket_array = calloc(slots, sizeof(item_vector));
+
+    if (!p_bucket_array) return NULL;
+
+    if (!(p_paths = paths_alloc(p_graph, source)))
+    {
+        free(p_bucket_array);
+        return NULL;
+    }
+
+    p_distance_array = p_paths->p_distance_array;
+    ok = item_vector_push(&p_bucket_array[0], 0, source);
+    items = 1;
+    current = 0;
+
+    while (ok && items > 0)
+    {
+        p_bucket = &p_bucket_array[current % slots];
+
+        if (p_bucket->size == 0)
+        {
+            ++current;
+            continue;
+        }
+
+        item = p_bucket->p_data[--p_bucket->size];
+        --items;
+
+        if (item.key != p_distance_array[item.node]) continue;
+
+        if (item.node == target) break;
+
+        for (arc = p_graph->p_child_offsets[item.node];
+             arc < p_graph->p_child_offsets[item.node + 1];
+             ++arc)
+        {
+            child = p_graph->p_child_array[arc];
+            distance = item.key + p_weight_array[arc];
+
+            if (distance < p_distance_array[child])
+            {
+                p_distance_array[child] = distance;
+                p_paths->p_parent_array[child] = item.node;
+                ok &= item_vector_push(&p_bucket_array[distance % slots],
+                                       distance,
+                                       child);
+                ++items;
+            }
+        }
+    }
+
+    for (current = 0; current < slots; ++current)
+    {
+        free(p_bucket_array[current].p_data);
+    }
+
+    free(p_bucket_array);
+
+    if (!ok)
+    {
+        integer_shortest_paths_free(p_paths);
+        return NULL;
+    }
+
+    return p_paths;
+}
+
+/*******************************************************************************
+* Moves the heap entry at 'index' up while its key is smaller than its         *
+* parent's, keeping 'p_position_array' in sync.                                *
+*******************************************************************************/
+static void sift_up(size_t* p_heap,
+                    size_t* p_position_array,
+                    size_t* p_key_array,
+                    size_t index)
+{
+    size_t node = p_heap[index];
+    size_t parent;
+
+    while (index > 0)
+    {
+        parent = (index - 1) / 2;
+
+        if (p_key_array[p_heap[parent]] <= p_key_array[node]) break;
+
+        p_heap[index] = p_heap[parent];
+        p_position_array[p_heap[index]] = index;
+        index = parent;
+    }
+
+    p_heap[index] = node;
+    p_position_array[node] = index;
+}
+
+static void sift_down(size_t* p_heap,
+                      size_t* p_position_array,
+                      size_t* p_key_array,
+                      size_t size,
+                      size_t index)
+{
+    size_t node = p_heap[index];
+    size_t child;
+
+    for (;;)
+    {
+        child = 2 * index + 1;
+
+        if (child >= size) break;
+
+        if (child + 1 < size
+            && p_key_array[p_heap[child + 1]] < p_key_array[p_heap[child]])
+        {
+            ++child;
+        }
+
+        if (p_key_array[node] <= p_key_array[p_heap[child]]) break;
+
+        p_heap[index] = p_heap[child];
+        p_position_array[p_heap[index]] = index;
+        index = child;
+    }
+
+    p_heap[index] = node;
+    p_position_array[node] = index;
+}
+
+integer_shortest_paths* integer_dijkstra_binary_heap(compact_graph* p_graph,
+                                                     size_t* p_weight_array,
+                                                     size_t source,
+                                                     size_t target)
+{
+    integer_shortest_paths* p_paths;
+    size_t*                 p_heap;
+    size_t*                 p_position_array;
+    size_t*                 p_distance_array;
+    size_t                  nodes;
+    size_t                  size;
+    size_t                  node;
+    size_t                  arc;
+    size_t                  child;
+    size_t                  distance;
+
+    if (!p_graph || !p_weight_array || source >= p_graph->nodes) return NULL;
+
+    nodes = p_graph->nodes;
+    p_heap = malloc(sizeof(size_t) * nodes);
+    p_position_array = malloc(sizeof(size_t) * nodes);
+    p_paths = paths_alloc(p_graph, source);
+
+    if (!p_heap || !p_position_array || !p_paths)
+    {
+        free(p_heap);
+        free(p_position_array);
+        integer_shortest_paths_free(p_paths);
+        return NULL;
+    }
+
+    for (node = 0; node < nodes; ++node)
+    {
+        p_position_array[node] = nodes;
+    }
+
+    p_distance_array = p_paths->p_distance_array;
+    p_heap[0] = source;
+    p_position_array[source] = 0;
+    size = 1;
+
+    while (size > 0)
+    {
+        node = p_heap[0];
+        p_position_array[node] = nodes;
+
+        if (--size > 0)
+        {
+            p_heap[0] = p_heap[size];
+            sift_down(p_heap, p_position_array, p_distance_array, size, 0);
+        }
+
+        if (node == target) break;
+
+        for (arc = p_graph->p_child_offsets[node];
+             arc < p_graph->p_child_offsets[node + 1];
+             ++arc)
+        {
+            child = p_graph->p_child_array[arc];
+            distance = p_distance_array[node] + p_weight_array[arc];
+
+            if (distance < p_distance_array[child])
+            {
+                p_distance_array[child] = distance;
+                p_paths->p_parent_array[child] = node;
+
+                if (p_position_array[child] == nodes)
+                {
+                    p_heap[size] = child;
+                    p_position_array[child] = size;
+                    ++size;
+                }
+
+                sift_up(p_heap,
+                        p_position_array,
+                        p_distance_array,
+                        p_position_array[child]);
+            }
+        }
+    }
+
+    free(p_heap);
+    free(p_position_array);
+    return p_paths;
+}
+
+integer_shortest_paths* integer_dijkstra(compact_graph* p_graph,
+                                         size_t* p_weight_array,
+                                         size_t source,
+                                         size_t target)
+{
+    size_t arc;
+
+    if (!p_graph || !p_weight_array) return NULL;
+
+    for (arc = 0; arc < p_graph->arcs; ++arc)
+    {
+        if (p_weight_array[arc] > DIAL_MAXIMUM_WEIGHT)
+        {
+            return integer_dijkstra_radix_heap(p_graph,
+                                               p_weight_array,
+                                               source,
+                                               target);
+        }
+    }
+
+    return integer_dijkstra_dial(p_graph, p_weight_array, source, target);
+}
+
+list* integer_shortest_paths_path(integer_shortest_paths* p_paths,
+                                  compact_graph* p_graph,
+                                  size_t target)
+{
+    list*  p_path;
+    size_t node;
+
+    if (!p_paths || !p_graph || target >= p_paths->nodes) return NULL;
+
+    if (p_paths->p_distance_array[target] == INTEGER_DIJKSTRA_INFINITY)
+    {
+        return NULL;
+    }
+
+    if (!(p_path = list_alloc(10))) return NULL;
+
+    for (node = target; node != p_paths->nodes;
+         node = p_paths->p_parent_array[node])
+    {
+        list_push_front(p_path, p_graph->p_node_array[node]);
+    }
+
+    return p_path;
+}
+
+void integer_shortest_paths_free(integer_shortest_paths* p_paths)
+{
+    if (!p_paths) return;
+
+    free(p_paths->p_distance_array);
+    free(p_paths->p_parent_array);
+    free(p_paths);
+}
+
+static void integer_dijkstra_test_path()
+{
+    directed_graph_node*    p_nodes[5];
+    compact_graph*          p_graph;
+    integer_shortest_paths* p_paths;
+    list*                   p_path;
+    size_t*                 p_weight_array;
+    size_t                  i;
+    size_t                  arc;
+    size_t                  head;
+
+    puts("        integer_dijkstra_test_path()");
+
+    for (i = 0; i < 5; ++i)
+    {
+        p_nodes[i] = directed_graph_node_alloc(i);
+    }
+
+    /* 0 -> 1 -> 2 -> 3 costs 3 while 0 -> 3 costs 1000. */
+    directed_graph_node_add_arc(p_nodes[0], p_nodes[1]);
+    directed_graph_node_add_arc(p_nodes[1], p_nodes[2]);
+    directed_graph_node_add_arc(p_nodes[2], p_nodes[3]);
+    directed_graph_node_add_arc(p_nodes[0], p_nodes[3]);
+
+    p_graph = compact_graph_alloc(p_nodes, 5);
+    p_weight_array = malloc(sizeof(size_t) * p_graph->arcs);
+
+    for (i = 0; i < 5; ++i)
+    {
+        for (arc = p_graph->p_child_offsets[i];
+             arc < p_graph->p_child_offsets[i + 1];
+             ++arc)
+        {
+            head = p_graph->p_child_array[arc];
+            p_weight_array[arc] = (i == 0 && head == 3) ? 1000 : 1;
+        }
+    }
+
+    p_paths = integer_dijkstra(p_graph, p_weight_array, 0, 5);
+
+    ASSERT(p_paths->p_distance_array[3] == 3);
+    ASSERT(p_paths->p_distance_array[4] == INTEGER_DIJKSTRA_INFINITY);
+
+    p_path = integer_shortest_paths_path(p_paths, p_graph, 3);
+
+    ASSERT(list_size(p_path) == 4);
+    ASSERT(list_get(p_path, 0) == p_nodes[0]);
+    ASSERT(list_get(p_path, 3) == p_nodes[3]);
+    ASSERT(integer_shortest_paths_path(p_paths, p_graph, 4) == NULL);
+
+    list_free(p_path);
+    integer_shortest_paths_free(p_paths);
+    free(p_weight_array);
+    compact_graph_free(p_graph);
+
+    for (i = 0; i < 5; ++i)
+    {
+        directed_graph_node_free(p_nodes[i]);
+    }
+}
+
+static int same_distances(integer_shortest_paths* p_a,
+                          integer_shortest_paths* p_b)
+{
+    size_t i;
+
+    for (i = 0; i < p_a->nodes; ++i)
+    {
+        if (p_a->p_distance_array[i] != p_b->p_distance_array[i])
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+static void integer_dijkstra_test_random()
+{
+    const size_t            nodes = 1000;
+    const size_t            max_weights[] = { 1, 7, 1000000 };
+    directed_graph_node**   p_nodes;
+    compact_graph*          p_graph;
+    integer_shortest_paths* p_binary;
+    integer_shortest_paths* p_radix;
+    integer_shortest_paths* p_dial;
+    integer_shortest_paths* p_early;
+    size_t*                 p_weight_array;
+    size_t                  i;
+    size_t                  w;
+    size_t                  target;
+
+    puts("        integer_dijkstra_test_random()");
+
+    p_nodes = malloc(sizeof(directed_graph_node*) * nodes);
+
+    for (i = 0; i < nodes; ++i)
+    {
+        p_nodes[i] = directed_graph_node_alloc(i);
+    }
+
+    for (i = 0; i < 5 * nodes; ++i)
+    {
+        directed_graph_node_add_arc(p_nodes[rand() % nodes],
+                                    p_nodes[rand() % nodes]);
+    }
+
+    p_graph = compact_graph_alloc(p_nodes, nodes);
+    p_weight_array = malloc(sizeof(size_t) * p_graph->arcs);
+
+    for (w = 0; w < sizeof(max_weights) / sizeof(max_weights[0]); ++w)
+    {
+        for (i = 0; i < p_graph->arcs; ++i)
+        {
+            p_weight_array[i] = (size_t) rand() % (max_weights[w] + 1);
+        }
+
+        p_binary = integer_dijkstra_binary_heap(p_graph, p_weight_array, 0,
+                                                nodes);
+        p_radix  = integer_dijkstra_radix_heap(p_graph, p_weight_array, 0,
+                                               nodes);
+        p_dial   = integer_dijkstra_dial(p_graph, p_weight_array, 0, nodes);
+
+        ASSERT(same_distances(p_binary, p_radix));
+        ASSERT(same_distances(p_binary, p_dial));
+
+        /* A settled target has its final distance even on early exit. */
+        target = rand() % nodes;
+        p_early = integer_dijkstra_radix_heap(p_graph, p_weight_array, 0,
+                                              target);
+
+        ASSERT(p_early->p_distance_array[target] ==
+               p_binary->p_distance_array[target]);
+
+        integer_shortest_paths_free(p_binary);
+        integer_shortest_paths_free(p_radix);
+        integer_shortest_paths_free(p_dial);
+        integer_shortest_paths_free(p_early);
+    }
+
+    free(p_weight_array);
+    compact_graph_free(p_graph);
+
+    for (i = 0; i < nodes; ++i)
+    {
+        directed_graph_node_free(p_nodes[i]);
+    }
+
+    free(p_nodes);
+}
+
+void integer_dijkstra_test()
+{
+    puts("    integer_dijkstra_test()");
+    integer_dijkstra_test_path();
+    integer_dijkstra_test_random();
+}
@@ -0,0 +1,89 @@
+#ifndef INTEGER_DIJKSTRA_H
+#define INTEGER_DIJKSTRA_H
+
+#include "compact_graph.h"
+#include "list.h"
+#include <stddef.h>
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+#define INTEGER_DIJKSTRA_INFINITY ((size_t) -1)
+
+    /***************************************************************************
+    * Holds a shortest path tree over integer weights. Unreached nodes have    *
+    * the distance INTEGER_DIJKSTRA_INFINITY and the parent 'nodes'.           *
+    ***************************************************************************/
+    typedef struct integer_shortest_paths {
+        size_t  nodes;
+        size_t  source;
+        size_t* p_distance_array;
+        size_t* p_parent_array;
+    } integer_shortest_paths;
+
+    /***************************************************************************
+    * The following compute shortest paths from the node with index 'source'   *
+    * using the integer weights in 'p_weight_array', aligned with              *
+    * 'p_graph->p_child_array'. If 'target' is a valid node index, the search  *
+    * stops as soon as the target is settled; pass 'p_graph->nodes' to settle  *
+    * every reachable node.                                                    *
+    ***************************************************************************/
+
+    /***************************************************************************
+    * Uses a radix heap: a monotone priority queue whose buckets are ranges of *
+    * keys by the highest bit differing from the last extracted key. Every     *
+    * item moves to a lower bucket at most once per bit.                       *
+    ***************************************************************************/
+    integer_shortest_paths* integer_dijkstra_radix_heap(compact_graph* p_graph,
+                                                        size_t* p_weight_array,
+                                                        size_t source,
+                                                        size_t target);
+
+    /***************************************************************************
+    * Uses Dial's algorithm: a cyclic array of 'max weight + 1' buckets, one   *
+    * per distance. Best when the maximum weight is small.                     *
+    ***************************************************************************/
+    integer_shortest_paths* integer_dijkstra_dial(compact_graph* p_graph,
+                                                  size_t* p_weight_array,
+                                                  size_t source,
+                                                  size_t target);
+
+    /***************************************************************************
+    * Uses a comparison-based binary heap with decrease-key.                   *
+    ***************************************************************************/
+    integer_shortest_paths* integer_dijkstra_binary_heap(compact_graph* p_graph,
+                                                         size_t* p_weight_array,
+                                                         size_t source,
+                                                         size_t target);
+
+    /***************************************************************************
+    * Picks Dial's algorithm if the maximum weight is small and the radix heap *
+    * otherwise.                                                               *
+    ***************************************************************************/
+    integer_shortest_paths* integer_dijkstra(compact_graph* p_graph,
+                                             size_t* p_weight_array,
+                                             size_t source,
+                                             size_t target);
+
+    /***************************************************************************
+    * Returns the list of nodes on the shortest path to 'target', or NULL if   *
+    * the target was not reached.                                              *
+    ***************************************************************************/
+    list* integer_shortest_paths_path(integer_shortest_paths* p_paths,
+                                      compact_graph* p_graph,
+                                      size_t target);
+
+    /***************************************************************************
+    * Deallocates the shortest path tree.                                      *
+    ***************************************************************************/
+    void integer_shortest_paths_free(integer_shortest_paths* p_paths);
+
+    /* Contains the unit tests. */
+    void integer_dijkstra_test();
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif  /* INTEGER_DIJKSTRA_H */
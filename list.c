@@ -1,3 +1,4 @@
+#include "allocation.h"
 #include "list.h"
 #include "my_assert.h"
 #include <stdint.h>
@@ -35,7 +36,7 @@ static int fix_initial_capacity(size_t initial_capacity)
 
 list* list_alloc(size_t initial_capacity)
 {
-    list* my_list = malloc(sizeof(*my_list));
+    list* my_list = allocation_alloc(ALLOCATION_LIST, sizeof(*my_list));
 
     if (!my_list)
     {
@@ -44,11 +45,12 @@ list* list_alloc(size_t initial_capacity)
 
     initial_capacity = fix_initial_capacity(initial_capacity);
 
-    my_list->m_storage = malloc(sizeof(void*) * initial_capacity);
+    my_list->m_storage = allocation_alloc(ALLOCATION_LIST,
+                                          sizeof(void*) * initial_capacity);
 
     if (!my_list->m_storage)
     {
-        free(my_list);
+        allocation_free(ALLOCATION_LIST, my_list, sizeof(*my_list));
         return NULL;
     }
 
@@ -72,7 +74,8 @@ static int ensure_capacity_before_add(list* my_list)
     }
 
     new_capacity = 2 * my_list->m_capacity;
-    new_table = malloc(sizeof(void*) * new_capacity);
+    new_table = allocation_alloc(ALLOCATION_LIST,
+                                 sizeof(void*) * new_capacity);
 
     if (!new_table)
     {
@@ -85,7 +88,9 @@ static int ensure_capacity_before_add(list* my_list)
             my_list->m_storage[(my_list->m_head + i) & my_list->m_mask];
     }
 
-    free(my_list->m_storage);
+    allocation_free(ALLOCATION_LIST,
+                    my_list->m_storage,
+                    sizeof(void*) * my_list->m_capacity);
 
     my_list->m_storage = new_table;
     my_list->m_capacity = new_capacity;
@@ -399,8 +404,17 @@ void list_free(list* my_list)
         return;
     }
 
-    free(my_list->m_storage);
-    free(my_list);
+    allocation_free(ALLOCATION_LIST,
+                    my_list->m_storage,
+                    sizeof(void*) * my_list->m_capacity);
+    allocation_free(ALLOCATION_LIST, my_list, sizeof(*my_list));
+}
+
+size_t list_memory_usage(list* my_list)
+{
+    return my_list ?
+           sizeof(*my_list) + sizeof(void*) * my_list->m_capacity :
+           0;
 }
 
 static int equals(void* a, void* b)
@@ -100,6 +100,11 @@ extern "C" {
     * Clears and deallocates the list.                                         *
     ***************************************************************************/
     void list_free(list* my_list);
+
+    /***************************************************************************
+    * Returns the number of bytes allocated by the list.                       *
+    ***************************************************************************/
+    size_t list_memory_usage(list* my_list);
     
     /* Contains the unit tests. */
     void list_test();
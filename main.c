@@ -1,13 +1,40 @@
+#include "allocation.h"
+#include "benchmark.h"
+#include "betweenness_centrality.h"
 #include "breadth_first_search.h"
 #include "bidirectional_breadth_first_search.h"
+#include "compact_graph.h"
+#include "compressed_graph.h"
+#include "concurrent_map.h"
+#include "delta_stepping.h"
 #include "directed_graph_node.h"
+#include "directed_graph_update.h"
+#include "frontier_queue.h"
+#include "dynamic_bfs_tree.h"
+#include "graph_generator.h"
+#include "graph_ordering.h"
+#include "heap.h"
+#include "integer_dijkstra.h"
 #include "list.h"
 #include "my_assert.h"
+#include "pagerank.h"
+#include "parallel.h"
+#include "perf_counters.h"
+#include "philox.h"
+#include "query_engine.h"
 #include "queue.h"
+#include "reachability_index.h"
+#include "scheduler.h"
+#include "search_path.h"
+#include "timing.h"
 #include "unordered_map.h"
 #include "unordered_set.h"
 #include "utils.h"
+#include "versioned_graph.h"
+#include "weakly_connected_components.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <time.h>
 
 #define _C_GRAPH_V2_TEST
@@ -21,8 +48,33 @@ static void test_all()
     puts("--- Testing ---");
     queue_test();
     list_test();
+    search_path_test();
     unordered_map_test();
     unordered_set_test();
+    allocation_test();
+    heap_test();
+    timing_test();
+    perf_counters_test();
+    benchmark_test();
+    parallel_test();
+    scheduler_test();
+    frontier_queue_test();
+    concurrent_map_test();
+    directed_graph_update_test();
+    dynamic_bfs_tree_test();
+    compact_graph_test();
+    philox_test();
+    graph_generator_test();
+    graph_ordering_test();
+    compressed_graph_test();
+    query_engine_test();
+    versioned_graph_test();
+    weakly_connected_components_test();
+    reachability_index_test();
+    delta_stepping_test();
+    betweenness_centrality_test();
+    pagerank_test();
+    integer_dijkstra_test();
     bidirectional_breadth_first_search_test();
     PRINT_TEST_RESULTS;
     puts("--- Done testing ---");
@@ -87,6 +139,48 @@ static void directed_graph_parents_iterator_free(parent_node_iterator* pni)
     unordered_set_iterator_free(pni->state);
 }
 
+/*******************************************************************************
+* Fills the iterators over the children and the parents of a directed graph    *
+* node.                                                                        *
+*******************************************************************************/
+static void directed_graph_iterators_init(
+    child_node_iterator* p_children_iterator,
+    parent_node_iterator* p_parents_iterator)
+{
+    p_children_iterator->child_node_iterator_init =
+        directed_graph_children_iterator_init;
+    p_children_iterator->child_node_iterator_has_next =
+        directed_graph_children_iterator_has_next;
+    p_children_iterator->child_node_iterator_next =
+        directed_graph_children_iterator_next;
+    p_children_iterator->child_node_iterator_free =
+        directed_graph_children_iterator_free;
+    p_parents_iterator->parent_node_iterator_init =
+        directed_graph_parents_iterator_init;
+    p_parents_iterator->parent_node_iterator_has_next =
+        directed_graph_parents_iterator_has_next;
+    p_parents_iterator->parent_node_iterator_next =
+        directed_graph_parents_iterator_next;
+    p_parents_iterator->parent_node_iterator_free =
+        directed_graph_parents_iterator_free;
+}
+
+static void print_allocation_counters()
+{
+    allocation_counters counters;
+    int                 subsystem;
+
+    for (subsystem = 0; subsystem < ALLOCATION_SUBSYSTEMS; ++subsystem)
+    {
+        allocation_get_counters(subsystem, &counters);
+        printf("%-14s %10lu bytes, peak %10lu bytes, %10lu allocations\n",
+               allocation_subsystem_name(subsystem),
+               (unsigned long) counters.bytes,
+               (unsigned long) counters.peak_bytes,
+               (unsigned long) counters.allocations);
+    }
+}
+
 static void benchmark_unweighted_general_graph()
 {
     child_node_iterator  children_iterator;
@@ -96,6 +190,9 @@ static void benchmark_unweighted_general_graph()
     size_t i;
     list* path1;
     list* path2;
+    size_t hops1;
+    size_t hops2;
+    size_t within;
     double time_a;
     double time_b;
 
@@ -109,31 +206,7 @@ static void benchmark_unweighted_general_graph()
                 directed_graph_node_hash_function,
                 directed_graph_nodes_equal_function);
 
-    /* Fill the child node generator interface: */
-    children_iterator.child_node_iterator_init = 
-        directed_graph_children_iterator_init;
-
-    children_iterator.child_node_iterator_has_next =
-        directed_graph_children_iterator_has_next;
-
-    children_iterator.child_node_iterator_next =
-        directed_graph_children_iterator_next;
-
-    children_iterator.child_node_iterator_free =
-        directed_graph_children_iterator_free;
-
-    /* Fill the parent node generator interface: */
-    parents_iterator.parent_node_iterator_init =
-        directed_graph_parents_iterator_init;
-
-    parents_iterator.parent_node_iterator_has_next =
-        directed_graph_parents_iterator_has_next;
-
-    parents_iterator.parent_node_iterator_next =
-        directed_graph_parents_iterator_next;
-
-    parents_iterator.parent_node_iterator_free =
-        directed_graph_parents_iterator_free;
+    directed_graph_iterators_init(&children_iterator, &parents_iterator);
     
     /* Randomize the terminal nodes: */
     source_node = choose(gd->p_node_array, NODES);
@@ -185,15 +258,1948 @@ static void benchmark_unweighted_general_graph()
     printf("Valid path: %s\n", is_valid_path(path2) ? "true" : "false");
     printf("Paths are of the same length: %s\n", 
            list_size(path1) == list_size(path2) ? "true" : "false");
+
+    /* Hop counts only: */
+    time_a = get_time();
+    hops1 = breadth_first_search_distance(source_node,
+                                          target_node,
+                                          &children_iterator,
+                                          directed_graph_node_hash_function,
+                                          directed_graph_nodes_equal_function);
+    time_b = get_time();
+    printf("BFS distance: %d hops in %d milliseconds.\n",
+           (int) hops1,
+           (int)(time_b - time_a));
+
+    time_a = get_time();
+    hops2 = bidirectional_breadth_first_search_distance(
+                source_node,
+                target_node,
+                &children_iterator,
+                &parents_iterator,
+                directed_graph_node_hash_function,
+                directed_graph_nodes_equal_function);
+    time_b = get_time();
+    printf("Bidirectional BFS distance: %d hops in %d milliseconds.\n",
+           (int) hops2,
+           (int)(time_b - time_a));
+    printf("Distances agree with the paths: %s\n",
+           hops1 + 1 == list_size(path1) && hops2 + 1 == list_size(path2) ?
+           "true" : "false");
+
+    /* Within 3 hops: */
+    time_a = get_time();
+
+    for (i = 0, within = 0; i < NODES / 50; ++i)
+    {
+        if (bidirectional_breadth_first_search_bounded_distance(
+                choose(gd->p_node_array, NODES),
+                choose(gd->p_node_array, NODES),
+                &children_iterator,
+                &parents_iterator,
+                directed_graph_node_hash_function,
+                directed_graph_nodes_equal_function,
+                3) != SEARCH_PATH_UNREACHABLE)
+        {
+            within++;
+        }
+    }
+
+    time_b = get_time();
+    printf("%d of %d random pairs within 3 hops in %d milliseconds.\n",
+           (int) within,
+           (int) (NODES / 50),
+           (int)(time_b - time_a));
+    printf("Graph memory: %lu bytes.\n",
+           (unsigned long) directed_graph_memory_usage(gd->p_node_array,
+                                                       NODES));
+    print_allocation_counters();
 }
 
-static void benchmark_all()
+static size_t directed_graph_out_degree(void* node)
 {
-    benchmark_unweighted_general_graph();
+    return unordered_set_size(directed_graph_node_children_set(node));
 }
 
-int main(int argc, char* argv[])
+static size_t directed_graph_in_degree(void* node)
+{
+    return unordered_set_size(directed_graph_node_parent_set(node));
+}
+
+/*******************************************************************************
+* Compares the arcs scanned by the alternating bidirectional search and by the *
+* balanced one on a graph where a quarter of the arc ends go to 16 hubs.       *
+*******************************************************************************/
+static void benchmark_balanced_bidirectional_search()
+{
+    const size_t         hubs = 16;
+    const size_t         queries = 200;
+    directed_graph_node** p_node_array =
+        malloc(sizeof(directed_graph_node*) * NODES);
+    child_node_iterator  children_iterator;
+    parent_node_iterator parents_iterator;
+    search_stats         stats_array[3];
+    directed_graph_node* tail;
+    directed_graph_node* head;
+    list*                path;
+    size_t               i;
+    size_t               hops;
+    size_t               agree = 0;
+    double               time_array[3] = { 0.0, 0.0, 0.0 };
+    double               time_a;
+    const char*          p_name_array[] = {
+        "alternating", "balanced by size", "balanced by degree"
+    };
+
+    directed_graph_iterators_init(&children_iterator, &parents_iterator);
+
+    for (i = 0; i < NODES; ++i)
+    {
+        p_node_array[i] = directed_graph_node_alloc((int) i);
+    }
+
+    for (i = 0; i < ARCS; ++i)
+    {
+        tail = p_node_array[rand() % (rand() % 4 ? NODES : hubs)];
+        head = p_node_array[rand() % (rand() % 4 ? NODES : hubs)];
+        directed_graph_node_add_arc(tail, head);
+    }
+
+    for (i = 0; i < 3; ++i)
+    {
+        search_stats_init(&stats_array[i]);
+    }
+
+    for (i = 0; i < queries; ++i)
+    {
+        tail = p_node_array[hubs + rand() % (NODES - hubs)];
+        head = p_node_array[hubs + rand() % (NODES - hubs)];
+
+        time_a = get_time();
+        path = bidirectional_breadth_first_search_with_stats(
+                   tail,
+                   head,
+                   &children_iterator,
+                   &parents_iterator,
+                   directed_graph_node_hash_function,
+                   directed_graph_nodes_equal_function,
+                   &stats_array[0]);
+        time_array[0] += get_time() - time_a;
+
+        time_a = get_time();
+        bidirectional_breadth_first_search_balanced(
+            tail,
+            head,
+            &children_iterator,
+            &parents_iterator,
+            NULL,
+            NULL,
+            directed_graph_node_hash_function,
+            directed_graph_nodes_equal_function,
+            &stats_array[1],
+            NULL);
+        time_array[1] += get_time() - time_a;
+
+        time_a = get_time();
+        hops = bidirectional_breadth_first_search_balanced(
+                   tail,
+                   head,
+                   &children_iterator,
+                   &parents_iterator,
+                   directed_graph_out_degree,
+                   directed_graph_in_degree,
+                   directed_graph_node_hash_function,
+                   directed_graph_nodes_equal_function,
+                   &stats_array[2],
+                   NULL);
+        time_array[2] += get_time() - time_a;
+
+        if (path ? hops + 1 == list_size(path) :
+                   hops == SEARCH_PATH_UNREACHABLE)
+        {
+            agree++;
+        }
+
+        list_free(path);
+    }
+
+    for (i = 0; i < 3; ++i)
+    {
+        printf("Skewed graph, %s: %lu arcs scanned, %d milliseconds.\n",
+               p_name_array[i],
+               (unsigned long) stats_array[i].arcs_scanned,
+               (int) time_array[i]);
+        search_stats_destroy(&stats_array[i]);
+    }
+
+    printf("The alternating search found a shortest path on %lu of %lu "
+           "queries.\n",
+           (unsigned long) agree,
+           (unsigned long) queries);
+
+    for (i = 0; i < NODES; ++i)
+    {
+        directed_graph_node_free(p_node_array[i]);
+    }
+
+    free(p_node_array);
+}
+
+/*******************************************************************************
+* Adds and removes random arcs of an R-MAT graph one at a time, timing blocks  *
+* of them, and then in whole batches on one thread and on all of them, timing  *
+* each of a few runs. Every sample is the mean time of an arc in microseconds. *
+*******************************************************************************/
+static void benchmark_arc_updates()
+{
+    const size_t           updates = 2000000;
+    const size_t           blocks = 100;
+    const size_t           runs = 5;
+    directed_graph_update* p_update_array;
+    benchmark_graph*       p_graph;
+    benchmark_result       add_result;
+    benchmark_result       remove_result;
+    philox                 random;
+    double                 p_add_array[100];
+    double                 p_remove_array[100];
+    size_t                 block = updates / blocks;
+    size_t                 i;
+    size_t                 b;
+    size_t                 run;
+    size_t                 mode;
+    size_t                 changes = 0;
+    double                 time_a;
+
+    p_graph = benchmark_graph_alloc(BENCHMARK_RMAT, NODES, 2);
+    p_update_array = malloc(sizeof(directed_graph_update) * updates);
+    philox_init(&random, 2, 0);
+
+    for (i = 0; i < updates; ++i)
+    {
+        p_update_array[i].p_tail =
+            p_graph->p_node_array[philox_below(&random, p_graph->nodes)];
+        p_update_array[i].p_head =
+            p_graph->p_node_array[philox_below(&random, p_graph->nodes)];
+        p_update_array[i].operation = DIRECTED_GRAPH_UPDATE_ADD;
+    }
+
+    for (b = 0; b < blocks; ++b)
+    {
+        time_a = get_time();
+
+        for (i = b * block; i < (b + 1) * block; ++i)
+        {
+            directed_graph_node_add_arc(p_update_array[i].p_tail,
+                                        p_update_array[i].p_head);
+        }
+
+        p_add_array[b] = 1e3 * (get_time() - time_a) / block;
+    }
+
+    for (b = 0; b < blocks; ++b)
+    {
+        time_a = get_time();
+
+        for (i = b * block; i < (b + 1) * block; ++i)
+        {
+            directed_graph_node_remove_arc(p_update_array[i].p_tail,
+                                           p_update_array[i].p_head);
+        }
+
+        p_remove_array[b] = 1e3 * (get_time() - time_a) / block;
+    }
+
+    benchmark_summarize(p_add_array, blocks, &add_result);
+    benchmark_summarize(p_remove_array, blocks, &remove_result);
+
+    printf("%lu arcs one at a time, microseconds per arc over %lu blocks: "
+           "added p50 %.3f, p99 %.3f, removed p50 %.3f, p99 %.3f.\n",
+           (unsigned long) updates,
+           (unsigned long) blocks,
+           add_result.p50_us,
+           add_result.p99_us,
+           remove_result.p50_us,
+           remove_result.p99_us);
+
+    for (mode = 0; mode < 2; ++mode)
+    {
+        for (run = 0; run < runs; ++run)
+        {
+            for (i = 0; i < updates; ++i)
+            {
+                p_update_array[i].operation = DIRECTED_GRAPH_UPDATE_ADD;
+            }
+
+            time_a  = get_time();
+            changes = directed_graph_apply_updates(p_update_array,
+                                                   updates,
+                                                   mode == 0 ? 1 : 0);
+            p_add_array[run] = 1e3 * (get_time() - time_a) / updates;
+
+            for (i = 0; i < updates; ++i)
+            {
+                p_update_array[i].operation = DIRECTED_GRAPH_UPDATE_REMOVE;
+            }
+
+            time_a = get_time();
+            directed_graph_apply_updates(p_update_array,
+                                         updates,
+                                         mode == 0 ? 1 : 0);
+            p_remove_array[run] = 1e3 * (get_time() - time_a) / updates;
+        }
+
+        benchmark_summarize(p_add_array, runs, &add_result);
+        benchmark_summarize(p_remove_array, runs, &remove_result);
+
+        printf("%lu arcs in a batch, %s, microseconds per arc over %lu "
+               "runs: %lu added, p50 %.3f, p99 %.3f, removed p50 %.3f, "
+               "p99 %.3f.\n",
+               (unsigned long) updates,
+               mode == 0 ? "1 thread" : "all threads",
+               (unsigned long) runs,
+               (unsigned long) changes,
+               add_result.p50_us,
+               add_result.p99_us,
+               remove_result.p50_us,
+               remove_result.p99_us);
+    }
+
+    free(p_update_array);
+    benchmark_graph_free(p_graph);
+}
+
+/*******************************************************************************
+* Keeps the search trees of a few hubs of an R-MAT graph up to date under arc  *
+* insertions and removals, timing each update of all the trees, and compares   *
+* with recomputing the trees, timing the build of each.                        *
+*******************************************************************************/
+static void benchmark_dynamic_bfs_tree()
+{
+    const size_t           trees = 20;
+    const size_t           updates = 1000;
+    dynamic_bfs_tree*      p_tree_array[20];
+    benchmark_graph*       p_graph;
+    benchmark_result       build_result;
+    benchmark_result       add_result;
+    benchmark_result       remove_result;
+    philox                 random;
+    directed_graph_node**  p_tail_array;
+    directed_graph_node**  p_head_array;
+    double                 p_build_array[20];
+    double*                p_add_array;
+    double*                p_remove_array;
+    size_t                 i;
+    double                 time_a;
+
+    p_graph = benchmark_graph_alloc(BENCHMARK_RMAT, NODES, 3);
+    philox_init(&random, 3, 0);
+
+    p_tail_array   = malloc(sizeof(directed_graph_node*) * updates);
+    p_head_array   = malloc(sizeof(directed_graph_node*) * updates);
+    p_add_array    = malloc(sizeof(double) * updates);
+    p_remove_array = malloc(sizeof(double) * updates);
+
+    for (i = 0; i < updates; ++i)
+    {
+        p_tail_array[i] =
+            p_graph->p_node_array[philox_below(&random, p_graph->nodes)];
+        p_head_array[i] =
+            p_graph->p_node_array[philox_below(&random, p_graph->nodes)];
+    }
+
+    for (i = 0; i < trees; ++i)
+    {
+        time_a = get_time();
+        p_tree_array[i] = dynamic_bfs_tree_alloc(
+            p_graph->p_node_array[philox_below(&random, p_graph->nodes)]);
+        p_build_array[i] = 1e3 * (get_time() - time_a);
+    }
+
+    for (i = 0; i < updates; ++i)
+    {
+        time_a = get_time();
+        dynamic_bfs_tree_add_arc(p_tree_array,
+                                 trees,
+                                 p_tail_array[i],
+                                 p_head_array[i]);
+        p_add_array[i] = 1e3 * (get_time() - time_a);
+    }
+
+    for (i = 0; i < updates; ++i)
+    {
+        time_a = get_time();
+        dynamic_bfs_tree_remove_arc(p_tree_array,
+                                    trees,
+                                    p_tail_array[i],
+                                    p_head_array[i]);
+        p_remove_array[i] = 1e3 * (get_time() - time_a);
+    }
+
+    benchmark_summarize(p_build_array, trees, &build_result);
+    benchmark_summarize(p_add_array, updates, &add_result);
+    benchmark_summarize(p_remove_array, updates, &remove_result);
+
+    printf("Dynamic BFS trees of %lu hubs, %lu updates, microseconds per "
+           "update: added p50 %.1f, p99 %.1f, removed p50 %.1f, p99 %.1f; "
+           "recomputing all trees takes %.1f.\n",
+           (unsigned long) trees,
+           (unsigned long) updates,
+           add_result.p50_us,
+           add_result.p99_us,
+           remove_result.p50_us,
+           remove_result.p99_us,
+           build_result.mean_us * trees);
+
+    for (i = 0; i < trees; ++i)
+    {
+        dynamic_bfs_tree_free(p_tree_array[i]);
+    }
+
+    free(p_tail_array);
+    free(p_head_array);
+    free(p_add_array);
+    free(p_remove_array);
+    benchmark_graph_free(p_graph);
+}
+
+/*******************************************************************************
+* Answers batches of point-to-point queries on an R-MAT graph with a query     *
+* engine of one worker and then of a worker per hardware thread. Each batch    *
+* yields a sample, the mean time of its queries, and both engines get the same *
+* seeded batches.                                                              *
+*******************************************************************************/
+static void benchmark_query_engine()
+{
+    const size_t         batches = 20;
+    const size_t         queries = 200;
+    child_node_iterator  children_iterator;
+    parent_node_iterator parents_iterator;
+    benchmark_graph*     p_graph;
+    benchmark_result     result;
+    query_engine*        p_engine;
+    query_engine_query*  p_query_array;
+    philox               random;
+    double*              p_time_array;
+    size_t               p_thread_array[2];
+    size_t               found;
+    size_t               batch;
+    size_t               run;
+    size_t               i;
+    double               time_a;
+
+    p_graph = benchmark_graph_alloc(BENCHMARK_RMAT, NODES, 1);
+    directed_graph_iterators_init(&children_iterator, &parents_iterator);
+
+    p_query_array = malloc(sizeof(query_engine_query) * queries);
+    p_time_array  = malloc(sizeof(double) * batches);
+
+    p_thread_array[0] = 1;
+    p_thread_array[1] = parallel_hardware_concurrency();
+
+    for (run = 0; run < 2; ++run)
+    {
+        p_engine = query_engine_alloc(p_thread_array[run],
+                                      &children_iterator,
+                                      &parents_iterator,
+                                      NULL,
+                                      NULL,
+                                      directed_graph_node_hash_function,
+                                      directed_graph_nodes_equal_function);
+        philox_init(&random, 1, 0);
+        found = 0;
+
+        for (batch = 0; batch < batches; ++batch)
+        {
+            for (i = 0; i < queries; ++i)
+            {
+                p_query_array[i].p_source =
+                    p_graph->p_node_array[philox_below(&random,
+                                                       p_graph->nodes)];
+                p_query_array[i].p_target =
+                    p_graph->p_node_array[philox_below(&random,
+                                                       p_graph->nodes)];
+            }
+
+            time_a = get_time();
+            query_engine_run(p_engine, p_query_array, queries);
+            p_time_array[batch] = 1e3 * (get_time() - time_a) / queries;
+
+            for (i = 0; i < queries; ++i)
+            {
+                if (p_query_array[i].p_path)
+                {
+                    found++;
+                    list_free(p_query_array[i].p_path);
+                }
+            }
+        }
+
+        benchmark_summarize(p_time_array, batches, &result);
+
+        printf("Query engine, %lu workers, %lu batches of %lu queries: "
+               "p50 %.3f, p99 %.3f, mean %.3f microseconds per query, "
+               "%.0f queries per second, %lu paths found.\n",
+               (unsigned long) p_thread_array[run],
+               (unsigned long) batches,
+               (unsigned long) queries,
+               result.p50_us,
+               result.p99_us,
+               result.mean_us,
+               result.queries_per_second,
+               (unsigned long) found);
+        query_engine_free(p_engine);
+    }
+
+    free(p_query_array);
+    free(p_time_array);
+    benchmark_graph_free(p_graph);
+}
+
+static void benchmark_weakly_connected_components()
+{
+    compact_graph*               p_graph;
+    weakly_connected_components* p_components;
+    size_t                       threads;
+    size_t                       max_threads;
+    double                       time_a;
+    double                       time_b;
+
+    unweighted_graph_data* gd =
+            create_unweighted_random_graph(
+                NODES,
+                NODES / 2,
+                MAXX,
+                MAXY,
+                MAXZ,
+                directed_graph_node_hash_function,
+                directed_graph_nodes_equal_function);
+
+    time_a = get_time();
+    p_graph = compact_graph_alloc(gd->p_node_array, NODES);
+    time_b = get_time();
+
+    printf("Compact graph built in %d milliseconds.\n", (int)(time_b - time_a));
+
+    max_threads = parallel_hardware_concurrency();
+
+    for (threads = 1; threads <= max_threads; threads <<= 1)
+    {
+        time_a = get_time();
+        p_components = weakly_connected_components_alloc(p_graph, threads);
+        time_b = get_time();
+
+        printf("Weakly connected components: %lu, threads: %lu, "
+               "duration: %d milliseconds.\n",
+               (unsigned long) p_components->components,
+               (unsigned long) threads,
+               (int)(time_b - time_a));
+
+        weakly_connected_components_free(p_components);
+    }
+
+    compact_graph_free(p_graph);
+}
+
+static void benchmark_reachability_index()
+{
+    child_node_iterator  children_iterator;
+    parent_node_iterator parents_iterator;
+    compact_graph*       p_graph;
+    reachability_index*  p_index;
+    directed_graph_node* source_node;
+    directed_graph_node* target_node;
+    list*                path;
+    size_t               i;
+    size_t               found_plain = 0;
+    size_t               found_indexed = 0;
+    double               time_a;
+    double               time_b;
+    double               duration_plain = 0.0;
+    double               duration_indexed = 0.0;
+    const size_t         QUERIES = 200;
+
+    unweighted_graph_data* gd =
+            create_unweighted_random_graph(
+                NODES,
+                2 * NODES,
+                MAXX,
+                MAXY,
+                MAXZ,
+                directed_graph_node_hash_function,
+                directed_graph_nodes_equal_function);
+
+    directed_graph_iterators_init(&children_iterator, &parents_iterator);
+
+    time_a = get_time();
+    p_graph = compact_graph_alloc(gd->p_node_array, NODES);
+    p_index = reachability_index_alloc(p_graph, 3);
+    time_b = get_time();
+
+    printf("Reachability index over %lu components built in %d milliseconds.\n",
+           (unsigned long) p_index->components,
+           (int)(time_b - time_a));
+
+    for (i = 0; i < QUERIES; ++i)
+    {
+        source_node = choose(gd->p_node_array, NODES);
+        target_node = choose(gd->p_node_array, NODES);
+
+        time_a = get_time();
+        path = bidirectional_breadth_first_search(
+                source_node,
+                target_node,
+                &children_iterator,
+                &parents_iterator,
+                directed_graph_node_hash_function,
+                directed_graph_nodes_equal_function);
+        time_b = get_time();
+        duration_plain += time_b - time_a;
+
+        if (path)
+        {
+            found_plain++;
+            list_free(path);
+        }
+
+        time_a = get_time();
+        path = reachability_index_find_path(
+                p_index,
+                source_node,
+                target_node,
+                &children_iterator,
+                &parents_iterator,
+                directed_graph_node_hash_function,
+                directed_graph_nodes_equal_function);
+        time_b = get_time();
+        duration_indexed += time_b - time_a;
+
+        if (path)
+        {
+            found_indexed++;
+            list_free(path);
+        }
+    }
+
+    printf("%lu queries, %lu reachable. Plain: %d milliseconds, "
+           "indexed: %d milliseconds, agree: %s\n",
+           (unsigned long) QUERIES,
+           (unsigned long) found_plain,
+           (int) duration_plain,
+           (int) duration_indexed,
+           found_plain == found_indexed ? "true" : "false");
+
+    reachability_index_free(p_index);
+    compact_graph_free(p_graph);
+}
+
+static void benchmark_delta_stepping()
+{
+    compact_graph*         p_graph;
+    delta_stepping_result* p_result;
+    double*                p_weight_array;
+    size_t                 i;
+    size_t                 threads;
+    size_t                 max_threads;
+    size_t                 source;
+    double                 time_a;
+    double                 time_b;
+
+    unweighted_graph_data* gd =
+            create_unweighted_random_graph(
+                NODES,
+                ARCS,
+                MAXX,
+                MAXY,
+                MAXZ,
+                directed_graph_node_hash_function,
+                directed_graph_nodes_equal_function);
+
+    p_graph = compact_graph_alloc(gd->p_node_array, NODES);
+    p_weight_array = malloc(sizeof(double) * p_graph->arcs);
+
+    for (i = 0; i < p_graph->arcs; ++i)
+    {
+        p_weight_array[i] = 1.0 + rand() % 100;
+    }
+
+    source = rand() % NODES;
+    max_threads = parallel_hardware_concurrency();
+
+    for (threads = 1; threads <= max_threads; threads <<= 1)
+    {
+        time_a = get_time();
+        p_result = delta_stepping(p_graph,
+                                  p_weight_array,
+                                  source,
+                                  0.0,
+                                  threads);
+        time_b = get_time();
+
+        printf("Delta-stepping, threads: %lu, duration: %d milliseconds.\n",
+               (unsigned long) threads,
+               (int)(time_b - time_a));
+
+        delta_stepping_result_free(p_result);
+    }
+
+    free(p_weight_array);
+    compact_graph_free(p_graph);
+}
+
+/*******************************************************************************
+* Returns the index of the highest score.                                      *
+*******************************************************************************/
+static size_t top_betweenness_node(betweenness_centrality* p_centrality)
+{
+    size_t top = 0;
+    size_t i;
+
+    for (i = 1; i < p_centrality->nodes; ++i)
+    {
+        if (p_centrality->p_score_array[i] > p_centrality->p_score_array[top])
+        {
+            top = i;
+        }
+    }
+
+    return top;
+}
+
+/*******************************************************************************
+* Times the exact betweenness of a small R-MAT graph on a growing number of    *
+* threads, then estimates it from 128 pivots on a larger one.                  *
+*******************************************************************************/
+static void benchmark_betweenness_centrality()
 {
+    compact_graph*          p_graph;
+    betweenness_centrality* p_centrality;
+    size_t                  threads;
+    size_t                  max_threads = parallel_hardware_concurrency();
+    double                  time_a;
+    double                  time_b;
+
+    p_graph = graph_generator_rmat(4096, 32768, 0.57, 0.19, 0.19, 1, 0);
+
+    for (threads = 1; threads <= max_threads; threads <<= 1)
+    {
+        time_a = get_time();
+        p_centrality = betweenness_centrality_alloc(p_graph, 0, 1, threads);
+        time_b = get_time();
+
+        printf("Exact betweenness, %lu nodes, threads: %lu, "
+               "duration: %d milliseconds, top node: %lu.\n",
+               (unsigned long) p_graph->nodes,
+               (unsigned long) threads,
+               (int)(time_b - time_a),
+               (unsigned long) top_betweenness_node(p_centrality));
+
+        betweenness_centrality_free(p_centrality);
+    }
+
+    compact_graph_free(p_graph);
+    p_graph = graph_generator_rmat(131072, 1048576, 0.57, 0.19, 0.19, 1, 0);
+
+    time_a = get_time();
+    p_centrality = betweenness_centrality_alloc(p_graph, 128, 1, 0);
+    time_b = get_time();
+
+    printf("Sampled betweenness, %lu nodes, 128 pivots, "
+           "duration: %d milliseconds, top node: %lu.\n",
+           (unsigned long) p_graph->nodes,
+           (int)(time_b - time_a),
+           (unsigned long) top_betweenness_node(p_centrality));
+
+    betweenness_centrality_free(p_centrality);
+    compact_graph_free(p_graph);
+}
+
+/*******************************************************************************
+* Times PageRank on an R-MAT graph on a growing number of threads, then a      *
+* hundred personalized queries from random seeds.                              *
+*******************************************************************************/
+static void benchmark_pagerank()
+{
+    compact_graph*                p_graph;
+    pagerank_result*              p_result;
+    personalized_pagerank_context context;
+    size_t                        threads;
+    size_t                        max_threads = parallel_hardware_concurrency();
+    size_t                        pushes = 0;
+    size_t                        query;
+    double                        time_a;
+    double                        time_b;
+
+    p_graph = graph_generator_rmat(262144, 2097152, 0.57, 0.19, 0.19, 1, 0);
+
+    for (threads = 1; threads <= max_threads; threads <<= 1)
+    {
+        time_a = get_time();
+        p_result = pagerank_alloc(p_graph, 0.85f, 1e-6, 100, threads);
+        time_b = get_time();
+
+        printf("PageRank, %lu nodes, threads: %lu, iterations: %lu, "
+               "duration: %d milliseconds.\n",
+               (unsigned long) p_graph->nodes,
+               (unsigned long) threads,
+               (unsigned long) p_result->iterations,
+               (int)(time_b - time_a));
+
+        pagerank_result_free(p_result);
+    }
+
+    srand(1);
+    personalized_pagerank_context_init(&context, p_graph);
+    time_a = get_time();
+
+    for (query = 0; query < 100; ++query)
+    {
+        personalized_pagerank_run(&context,
+                                  rand() % p_graph->nodes,
+                                  0.85f,
+                                  1e-6);
+        pushes += context.iterations;
+    }
+
+    time_b = get_time();
+    personalized_pagerank_context_destroy(&context);
+
+    printf("Personalized PageRank, 100 queries, pushes: %lu, "
+           "duration: %d milliseconds.\n",
+           (unsigned long) pushes,
+           (int)(time_b - time_a));
+
+    compact_graph_free(p_graph);
+}
+
+/*******************************************************************************
+* Times each generator at one million nodes and ten million arcs or so, first *
+* on one thread and then on all of them.                                       *
+*******************************************************************************/
+static void benchmark_graph_generators()
+{
+    compact_graph* p_graph;
+    size_t         p_thread_array[] = { 1, 0 };
+    size_t         threads;
+    int            family;
+    int            run;
+    double         time_a;
+    double         time_b;
+    const char*    p_name_array[] = {
+        "Erdos-Renyi", "R-MAT", "Barabasi-Albert", "Geometric", "Grid"
+    };
+
+    for (family = 0; family < 5; ++family)
+    {
+        for (run = 0; run < 2; ++run)
+        {
+            threads = p_thread_array[run];
+            time_a = get_time();
+
+            switch (family)
+            {
+                case 0:
+                    p_graph = graph_generator_erdos_renyi(1000000,
+                                                          10000000,
+                                                          1,
+                                                          threads);
+                    break;
+
+                case 1:
+                    p_graph = graph_generator_rmat(1000000,
+                                                   10000000,
+                                                   0.57,
+                                                   0.19,
+                                                   0.19,
+                                                   1,
+                                                   threads);
+                    break;
+
+                case 2:
+                    p_graph = graph_generator_barabasi_albert(1000000,
+                                                              10,
+                                                              1,
+                                                              threads);
+                    break;
+
+                case 3:
+                    p_graph = graph_generator_geometric(1000000,
+                                                        1.0,
+                                                        1.0,
+                                                        1.0,
+                                                        0.0134,
+                                                        1,
+                                                        threads,
+                                                        NULL);
+                    break;
+
+                default:
+                    p_graph = graph_generator_grid(1000, 1000, 1, threads);
+                    break;
+            }
+
+            time_b = get_time();
+
+            printf("%s, %s: %lu arcs in %d milliseconds.\n",
+                   p_name_array[family],
+                   threads == 1 ? "1 thread" : "all threads",
+                   p_graph ? (unsigned long) p_graph->arcs : 0UL,
+                   (int)(time_b - time_a));
+
+            compact_graph_free(p_graph);
+        }
+    }
+}
+
+static void benchmark_graph_ordering()
+{
+    compact_graph*          p_graph;
+    compact_graph*          p_ordered;
+    graph_ordering*         p_ordering;
+    integer_shortest_paths* p_paths;
+    size_t*                 p_weight_array;
+    size_t                  i;
+    size_t                  source;
+    int                     kind;
+    double                  time_a;
+    double                  time_b;
+    double                  time_c;
+    const char*             p_name_array[] = {
+        "Original", "BFS", "Reverse Cuthill-McKee", "Degree", "Gorder"
+    };
+
+    /* The geometric generator numbers the nodes in random spatial order. */
+    p_graph = graph_generator_geometric(1000000,
+                                        1.0,
+                                        1.0,
+                                        1.0,
+                                        0.0134,
+                                        1,
+                                        0,
+                                        NULL);
+    p_weight_array = malloc(sizeof(size_t) * (p_graph->arcs + 1));
+
+    for (i = 0; i < p_graph->arcs; ++i)
+    {
+        p_weight_array[i] = 1;
+    }
+
+    for (kind = 0; kind < 5; ++kind)
+    {
+        time_a = get_time();
+
+        switch (kind)
+        {
+            case 0:
+                p_ordering = NULL;
+                break;
+
+            case 1:
+                p_ordering = graph_ordering_bfs(p_graph);
+                break;
+
+            case 2:
+                p_ordering = graph_ordering_reverse_cuthill_mckee(p_graph);
+                break;
+
+            case 3:
+                p_ordering = graph_ordering_degree(p_graph);
+                break;
+
+            default:
+                p_ordering = graph_ordering_gorder(p_graph, 5);
+                break;
+        }
+
+        p_ordered = p_ordering ?
+                    graph_ordering_apply(p_ordering, p_graph, 0) :
+                    p_graph;
+        source    = p_ordering ? p_ordering->p_new_index_array[0] : 0;
+        time_b    = get_time();
+        p_paths   = integer_dijkstra_dial(p_ordered,
+                                          p_weight_array,
+                                          source,
+                                          p_ordered->nodes);
+        time_c    = get_time();
+
+        printf("%s ordering: built in %d milliseconds, unit-weight "
+               "traversal in %d milliseconds.\n",
+               p_name_array[kind],
+               (int)(time_b - time_a),
+               (int)(time_c - time_b));
+
+        integer_shortest_paths_free(p_paths);
+
+        if (p_ordering)
+        {
+            compact_graph_free(p_ordered);
+            graph_ordering_free(p_ordering);
+        }
+    }
+
+    free(p_weight_array);
+    compact_graph_free(p_graph);
+}
+
+/*******************************************************************************
+* Sums the children of every node, which touches every arc once.               *
+*******************************************************************************/
+static size_t scan_compact_graph(compact_graph* p_graph)
+{
+    size_t sum = 0;
+    size_t i;
+
+    for (i = 0; i < p_graph->arcs; ++i)
+    {
+        sum += p_graph->p_child_array[i];
+    }
+
+    return sum;
+}
+
+static size_t scan_compressed_graph(compressed_graph* p_graph,
+                                    size_t* p_row)
+{
+    size_t sum = 0;
+    size_t node;
+    size_t count;
+    size_t i;
+
+    for (node = 0; node < p_graph->nodes; ++node)
+    {
+        count = compressed_graph_children(p_graph, node, p_row);
+
+        for (i = 0; i < count; ++i)
+        {
+            sum += p_row[i];
+        }
+    }
+
+    return sum;
+}
+
+static size_t scan_compressed_graph_cursor(compressed_graph* p_graph)
+{
+    compressed_graph_cursor cursor;
+    size_t                  sum = 0;
+    size_t                  node;
+
+    for (node = 0; node < p_graph->nodes; ++node)
+    {
+        compressed_graph_cursor_init(&cursor, p_graph, node, FALSE);
+
+        while (compressed_graph_cursor_has_next(&cursor))
+        {
+            sum += compressed_graph_cursor_next(&cursor);
+        }
+    }
+
+    return sum;
+}
+
+static void benchmark_compressed_graph()
+{
+    compact_graph*    p_graph;
+    compact_graph*    p_ordered;
+    compressed_graph* p_compressed;
+    graph_ordering*   p_ordering;
+    size_t*           p_row;
+    size_t            sum_a;
+    size_t            sum_b;
+    size_t            sum_c;
+    double            time_a;
+    double            time_b;
+    double            time_c;
+    double            time_d;
+    double            time_e;
+    int               run;
+
+    p_graph    = graph_generator_geometric(1000000,
+                                           1.0,
+                                           1.0,
+                                           1.0,
+                                           0.0134,
+                                           1,
+                                           0,
+                                           NULL);
+    p_ordering = graph_ordering_reverse_cuthill_mckee(p_graph);
+    p_ordered  = graph_ordering_apply(p_ordering, p_graph, 0);
+
+    for (run = 0; run < 2; ++run)
+    {
+        compact_graph* p_source = run == 0 ? p_graph : p_ordered;
+
+        time_a       = get_time();
+        p_compressed = compressed_graph_alloc(p_source, 0);
+        time_b       = get_time();
+        p_row        = malloc(sizeof(size_t) *
+                              (p_compressed->max_degree + 1));
+        sum_a        = scan_compact_graph(p_source);
+        time_c       = get_time();
+        sum_b        = scan_compressed_graph(p_compressed, p_row);
+        time_d       = get_time();
+        sum_c        = scan_compressed_graph_cursor(p_compressed);
+        time_e       = get_time();
+
+        printf("Compressed graph, %s: %.2f bytes per arc against %.2f, "
+               "built in %d milliseconds.\n",
+               run == 0 ? "random numbering" : "RCM numbering",
+               (double) compressed_graph_memory_usage(p_compressed) /
+                   p_source->arcs,
+               (double) compact_graph_memory_usage(p_source) /
+                   p_source->arcs,
+               (int)(time_b - time_a));
+        printf("Full scan: compact %d milliseconds, decoded rows %d "
+               "milliseconds, cursors %d milliseconds. Sums agree: %d.\n",
+               (int)(time_c - time_b),
+               (int)(time_d - time_c),
+               (int)(time_e - time_d),
+               sum_a == sum_b && sum_b == sum_c);
+
+        free(p_row);
+        compressed_graph_free(p_compressed);
+    }
+
+    graph_ordering_free(p_ordering);
+    compact_graph_free(p_ordered);
+    compact_graph_free(p_graph);
+}
+
+typedef struct versioned_benchmark_state {
+    versioned_graph* p_graph;
+    size_t           stream;
+    size_t           done;
+    size_t           reads;
+    size_t           sum;
+} versioned_benchmark_state;
+
+/*******************************************************************************
+* Pins snapshots one after another and sums the children of the children of    *
+* 1000 random nodes in each, until the writer is done.                         *
+*******************************************************************************/
+static void versioned_benchmark_reader(void* p_argument)
+{
+    versioned_benchmark_state* p_state = p_argument;
+    versioned_graph_reader*    p_reader;
+    versioned_graph_snapshot*  p_snapshot;
+    const size_t*              p_child_array;
+    const size_t*              p_grandchild_array;
+    philox                     random;
+    size_t                     children;
+    size_t                     sum = 0;
+    size_t                     i;
+    size_t                     j;
+
+    philox_init(&random, 5, PARALLEL_FETCH_ADD(&p_state->stream, 1));
+    p_reader = versioned_graph_reader_alloc(p_state->p_graph);
+
+    while (!PARALLEL_LOAD(&p_state->done))
+    {
+        p_snapshot = versioned_graph_begin(p_reader);
+
+        for (i = 0; i < 1000; ++i)
+        {
+            children = versioned_graph_children(
+                           p_snapshot,
+                           philox_below(&random, p_snapshot->nodes),
+                           &p_child_array);
+
+            for (j = 0; j < children; ++j)
+            {
+                sum += versioned_graph_children(p_snapshot,
+                                                p_child_array[j],
+                                                &p_grandchild_array);
+            }
+        }
+
+        versioned_graph_end(p_reader);
+        PARALLEL_FETCH_ADD(&p_state->reads, 1);
+    }
+
+    PARALLEL_FETCH_ADD(&p_state->sum, sum);
+    versioned_graph_reader_free(p_reader);
+}
+
+typedef struct concurrent_map_benchmark_state {
+    concurrent_map* p_map;
+    size_t*         p_key_array;
+    size_t          inserted;
+} concurrent_map_benchmark_state;
+
+static void concurrent_map_benchmark_body(size_t chunk_begin,
+                                          size_t chunk_end,
+                                          size_t thread_index,
+                                          void* p_argument)
+{
+    concurrent_map_benchmark_state* p_state = p_argument;
+    size_t                          inserted = 0;
+    size_t                          i;
+
+    (void) thread_index;
+
+    for (i = chunk_begin; i < chunk_end; ++i)
+    {
+        if (concurrent_map_put_if_absent(
+                p_state->p_map,
+                compressed_graph_node(p_state->p_key_array[i]),
+                NULL,
+                NULL) == CONCURRENT_MAP_INSERTED)
+        {
+            inserted++;
+        }
+    }
+
+    PARALLEL_FETCH_ADD(&p_state->inserted, inserted);
+}
+
+/*******************************************************************************
+* Marks random node IDs visited, many of them repeatedly, in an unordered map  *
+* and in the concurrent map on one thread and on all of them.                  *
+*******************************************************************************/
+static void benchmark_concurrent_map()
+{
+    const size_t                   keys = 4000000;
+    concurrent_map_benchmark_state state;
+    unordered_map*                 p_unordered_map;
+    philox                         random;
+    size_t                         inserted[3];
+    size_t                         run;
+    size_t                         i;
+    double                         times[3];
+    double                         time_a;
+
+    state.p_key_array = malloc(sizeof(size_t) * keys);
+    philox_init(&random, 11, 0);
+
+    for (i = 0; i < keys; ++i)
+    {
+        state.p_key_array[i] = philox_below(&random, keys / 4);
+    }
+
+    p_unordered_map =
+        unordered_map_alloc(16,
+                            1.0f,
+                            compressed_graph_node_hash_function,
+                            compressed_graph_nodes_equal_function);
+    inserted[0] = 0;
+    time_a = get_time();
+
+    for (i = 0; i < keys; ++i)
+    {
+        void* p_node = compressed_graph_node(state.p_key_array[i]);
+
+        if (!unordered_map_contains_key(p_unordered_map, p_node))
+        {
+            unordered_map_put(p_unordered_map, p_node, NULL);
+            inserted[0]++;
+        }
+    }
+
+    times[0] = get_time() - time_a;
+    unordered_map_free(&p_unordered_map);
+
+    for (run = 1; run < 3; ++run)
+    {
+        state.p_map =
+            concurrent_map_alloc(16,
+                                 0.5f,
+                                 compressed_graph_node_hash_function,
+                                 compressed_graph_nodes_equal_function);
+        state.inserted = 0;
+        time_a = get_time();
+        parallel_for(0,
+                     keys,
+                     run == 1 ? 1 : 0,
+                     concurrent_map_benchmark_body,
+                     &state);
+        times[run] = get_time() - time_a;
+        inserted[run] = state.inserted;
+        concurrent_map_free(state.p_map);
+    }
+
+    printf("Visited map, %lu marks: unordered map %d milliseconds, "
+           "concurrent map on one thread %d milliseconds, on %lu threads %d "
+           "milliseconds. Distinct counts agree: %d.\n",
+           (unsigned long) keys,
+           (int) times[0],
+           (int) times[1],
+           (unsigned long) parallel_hardware_concurrency(),
+           (int) times[2],
+           inserted[0] == inserted[1] && inserted[1] == inserted[2]);
+
+    free(state.p_key_array);
+}
+
+typedef struct frontier_benchmark_state {
+    frontier_queue* p_queue;
+    size_t          items;
+    size_t          consumed;
+    size_t          sum;
+} frontier_benchmark_state;
+
+static void frontier_benchmark_producer(void* p_argument)
+{
+    frontier_benchmark_state* p_state = p_argument;
+    frontier_queue_local      local;
+    size_t                    i;
+
+    frontier_queue_local_init(&local, p_state->p_queue);
+
+    for (i = 0; i < p_state->items; ++i)
+    {
+        while (!frontier_queue_local_push(&local, i)) parallel_yield();
+    }
+
+    while (!frontier_queue_local_flush(&local)) parallel_yield();
+
+    frontier_queue_local_free(&local);
+}
+
+static void frontier_benchmark_consumer(void* p_argument)
+{
+    frontier_benchmark_state* p_state = p_argument;
+    frontier_queue_local      local;
+    size_t                    total = 2 * p_state->items;
+    size_t                    sum = 0;
+    size_t                    item;
+
+    frontier_queue_local_init(&local, p_state->p_queue);
+
+    while (PARALLEL_LOAD(&p_state->consumed) < total)
+    {
+        if (frontier_queue_local_pop(&local, &item))
+        {
+            sum += item;
+            PARALLEL_FETCH_ADD(&p_state->consumed, 1);
+        }
+        else
+        {
+            parallel_yield();
+        }
+    }
+
+    PARALLEL_FETCH_ADD(&p_state->sum, sum);
+    frontier_queue_local_free(&local);
+}
+
+/*******************************************************************************
+* Two producers and two consumers pass words through the frontier queue, one   *
+* word per block and 64 words per block.                                       *
+*******************************************************************************/
+static void benchmark_frontier_queue()
+{
+    frontier_benchmark_state state;
+    parallel_thread          thread_array[4];
+    size_t                   block;
+    size_t                   i;
+    double                   time_a;
+    double                   time_b;
+
+    for (block = 1; block <= 64; block *= 64)
+    {
+        state.p_queue  = frontier_queue_alloc(1 << 16, block);
+        state.items    = 1000000;
+        state.consumed = 0;
+        state.sum      = 0;
+
+        time_a = get_time();
+
+        for (i = 0; i < 4; ++i)
+        {
+            parallel_thread_create(&thread_array[i],
+                                   i < 2 ? frontier_benchmark_producer :
+                                           frontier_benchmark_consumer,
+                                   &state);
+        }
+
+        for (i = 0; i < 4; ++i)
+        {
+            parallel_thread_join(thread_array[i]);
+        }
+
+        time_b = get_time();
+
+        printf("Frontier queue, block %lu: %lu words in %d milliseconds, "
+               "checksum agrees: %d.\n",
+               (unsigned long) block,
+               (unsigned long) (2 * state.items),
+               (int)(time_b - time_a),
+               state.sum == state.items * (state.items - 1));
+
+        frontier_queue_free(state.p_queue);
+    }
+}
+
+typedef struct scheduler_benchmark_state {
+    compact_graph* p_graph;
+    size_t         sum;
+} scheduler_benchmark_state;
+
+/*******************************************************************************
+* Sums the out-degrees of the children of each node, so the work per node      *
+* follows the skewed degrees of the graph.                                     *
+*******************************************************************************/
+static void scheduler_benchmark_body(size_t chunk_begin,
+                                     size_t chunk_end,
+                                     size_t thread_index,
+                                     void* p_argument)
+{
+    scheduler_benchmark_state* p_state = p_argument;
+    size_t*                    p_offsets = p_state->p_graph->p_child_offsets;
+    size_t*                    p_children = p_state->p_graph->p_child_array;
+    size_t                     sum = 0;
+    size_t                     node;
+    size_t                     i;
+
+    (void) thread_index;
+
+    for (node = chunk_begin; node < chunk_end; ++node)
+    {
+        for (i = p_offsets[node]; i < p_offsets[node + 1]; ++i)
+        {
+            sum += p_offsets[p_children[i] + 1] - p_offsets[p_children[i]];
+        }
+    }
+
+    PARALLEL_FETCH_ADD(&p_state->sum, sum);
+}
+
+typedef struct scheduler_benchmark_fibonacci {
+    scheduler* p_scheduler;
+    size_t     n;
+    size_t     result;
+} scheduler_benchmark_fibonacci;
+
+static void scheduler_benchmark_fibonacci_task(void* p_argument)
+{
+    scheduler_benchmark_fibonacci* p_task = p_argument;
+    scheduler_benchmark_fibonacci  left;
+    scheduler_benchmark_fibonacci  right;
+    scheduler_group                group;
+
+    if (p_task->n < 2)
+    {
+        p_task->result = p_task->n;
+        return;
+    }
+
+    left.p_scheduler  = p_task->p_scheduler;
+    left.n            = p_task->n - 1;
+    right.p_scheduler = p_task->p_scheduler;
+    right.n           = p_task->n - 2;
+
+    scheduler_group_init(&group);
+    scheduler_spawn(p_task->p_scheduler,
+                    &group,
+                    scheduler_benchmark_fibonacci_task,
+                    &left);
+    scheduler_benchmark_fibonacci_task(&right);
+    scheduler_wait(p_task->p_scheduler, &group);
+    p_task->result = left.result + right.result;
+}
+
+/*******************************************************************************
+* Runs a degree-skewed loop over an R-MAT graph serially, in one coarse chunk  *
+* per thread and with the adaptive grain, then times fork-join spawning.       *
+*******************************************************************************/
+static void benchmark_scheduler()
+{
+    scheduler_benchmark_state     state;
+    scheduler_benchmark_fibonacci task;
+    scheduler*                    p_scheduler = scheduler_shared();
+    size_t                        threads = parallel_hardware_concurrency();
+    size_t                        sums[3];
+    double                        times[4];
+    double                        time_a;
+
+    state.p_graph = graph_generator_rmat(200000, 2000000,
+                                         0.57, 0.19, 0.19, 1, 0);
+
+    time_a = get_time();
+    state.sum = 0;
+    scheduler_benchmark_body(0, state.p_graph->nodes, 0, &state);
+    sums[0] = state.sum;
+    times[0] = get_time() - time_a;
+
+    time_a = get_time();
+    state.sum = 0;
+    scheduler_parallel_for(p_scheduler,
+                           0,
+                           state.p_graph->nodes,
+                           (state.p_graph->nodes + threads - 1) / threads,
+                           0,
+                           scheduler_benchmark_body,
+                           &state);
+    sums[1] = state.sum;
+    times[1] = get_time() - time_a;
+
+    time_a = get_time();
+    state.sum = 0;
+    scheduler_parallel_for(p_scheduler,
+                           0,
+                           state.p_graph->nodes,
+                           0,
+                           0,
+                           scheduler_benchmark_body,
+                           &state);
+    sums[2] = state.sum;
+    times[2] = get_time() - time_a;
+
+    task.p_scheduler = p_scheduler;
+    task.n           = 25;
+    time_a = get_time();
+    scheduler_run(p_scheduler, scheduler_benchmark_fibonacci_task, &task);
+    times[3] = get_time() - time_a;
+
+    printf("Scheduler, %lu threads: skewed loop serial %d milliseconds, "
+           "coarse chunks %d milliseconds, adaptive %d milliseconds, "
+           "sums agree: %d. Fork-join fib(25) = %lu in %d milliseconds.\n",
+           (unsigned long) threads,
+           (int) times[0],
+           (int) times[1],
+           (int) times[2],
+           sums[0] == sums[1] && sums[1] == sums[2],
+           (unsigned long) task.result,
+           (int) times[3]);
+
+    compact_graph_free(state.p_graph);
+}
+
+/*******************************************************************************
+* Applies batches of random updates to an R-MAT graph while readers keep       *
+* scanning snapshots of it.                                                    *
+*******************************************************************************/
+static void benchmark_versioned_graph()
+{
+    const size_t              batches = 100;
+    const size_t              updates = 10000;
+    compact_graph*            p_graph;
+    versioned_benchmark_state state;
+    versioned_graph_update*   p_update_array;
+    parallel_thread*          p_thread_array;
+    philox                    random;
+    size_t                    readers;
+    size_t                    batch;
+    size_t                    i;
+    double                    time_a;
+    double                    time_b;
+
+    readers = parallel_hardware_concurrency();
+    readers = readers > 1 ? readers - 1 : 1;
+    p_graph = graph_generator_rmat(100000, 1000000, 0.57, 0.19, 0.19, 1, 0);
+
+    state.p_graph  = versioned_graph_load(p_graph, readers);
+    state.stream   = 0;
+    state.done     = FALSE;
+    state.reads    = 0;
+    state.sum      = 0;
+    p_update_array = malloc(sizeof(versioned_graph_update) * updates);
+    p_thread_array = malloc(sizeof(parallel_thread) * readers);
+    philox_init(&random, 7, 0);
+
+    for (i = 0; i < readers; ++i)
+    {
+        parallel_thread_create(&p_thread_array[i],
+                               versioned_benchmark_reader,
+                               &state);
+    }
+
+    time_a = get_time();
+
+    for (batch = 0; batch < batches; ++batch)
+    {
+        for (i = 0; i < updates; ++i)
+        {
+            p_update_array[i].tail      = philox_below(&random,
+                                                       p_graph->nodes);
+            p_update_array[i].head      = philox_below(&random,
+                                                       p_graph->nodes);
+            p_update_array[i].operation = (i & 1) ?
+                                          DIRECTED_GRAPH_UPDATE_REMOVE :
+                                          DIRECTED_GRAPH_UPDATE_ADD;
+        }
+
+        versioned_graph_apply(state.p_graph, p_update_array, updates);
+    }
+
+    time_b = get_time();
+    PARALLEL_STORE(&state.done, TRUE);
+
+    for (i = 0; i < readers; ++i)
+    {
+        parallel_thread_join(p_thread_array[i]);
+    }
+
+    printf("Versioned graph: %lu batches of %lu updates in %d milliseconds, "
+           "while %lu readers scanned %lu snapshots.\n",
+           (unsigned long) batches,
+           (unsigned long) updates,
+           (int)(time_b - time_a),
+           (unsigned long) readers,
+           (unsigned long) state.reads);
+
+    free(p_thread_array);
+    free(p_update_array);
+    versioned_graph_free(state.p_graph);
+    compact_graph_free(p_graph);
+}
+
+static void benchmark_integer_dijkstra()
+{
+    const size_t            max_weights[] = { 10, 100000 };
+    compact_graph*          p_graph;
+    integer_shortest_paths* p_paths;
+    size_t*                 p_weight_array;
+    size_t                  i;
+    size_t                  w;
+    size_t                  source;
+    double                  time_a;
+    double                  time_b;
+    double                  time_c;
+    double                  time_d;
+
+    unweighted_graph_data* gd =
+            create_unweighted_random_graph(
+                NODES,
+                ARCS,
+                MAXX,
+                MAXY,
+                MAXZ,
+                directed_graph_node_hash_function,
+                directed_graph_nodes_equal_function);
+
+    p_graph = compact_graph_alloc(gd->p_node_array, NODES);
+    p_weight_array = malloc(sizeof(size_t) * p_graph->arcs);
+    source = rand() % NODES;
+
+    for (w = 0; w < sizeof(max_weights) / sizeof(max_weights[0]); ++w)
+    {
+        for (i = 0; i < p_graph->arcs; ++i)
+        {
+            p_weight_array[i] = 1 + (size_t) rand() % max_weights[w];
+        }
+
+        time_a = get_time();
+        p_paths = integer_dijkstra_binary_heap(p_graph, p_weight_array,
+                                               source, NODES);
+        integer_shortest_paths_free(p_paths);
+        time_b = get_time();
+        p_paths = integer_dijkstra_radix_heap(p_graph, p_weight_array,
+                                              source, NODES);
+        integer_shortest_paths_free(p_paths);
+        time_c = get_time();
+        p_paths = integer_dijkstra_dial(p_graph, p_weight_array,
+                                        source, NODES);
+        integer_shortest_paths_free(p_paths);
+        time_d = get_time();
+
+        printf("Integer Dijkstra, weights 1..%lu. Binary heap: %d "
+               "milliseconds, radix heap: %d milliseconds, Dial: %d "
+               "milliseconds.\n",
+               (unsigned long) max_weights[w],
+               (int)(time_b - time_a),
+               (int)(time_c - time_b),
+               (int)(time_d - time_c));
+    }
+
+    free(p_weight_array);
+    compact_graph_free(p_graph);
+}
+
+static size_t heap_element_hash_function(void* p_element)
+{
+    return (size_t) p_element;
+}
+
+static int heap_element_equals_function(void* p_a, void* p_b)
+{
+    return p_a == p_b;
+}
+
+static void benchmark_heap()
+{
+    static const char* names[] = { "binary", "4-ary", "8-ary", "pairing" };
+    static const size_t degrees[] = { 2, 4, 8, 0 };
+    heap*   p_heap;
+    double* p_priority_array;
+    void**  p_element_array;
+    size_t  configuration;
+    size_t  i;
+    double  time_a;
+    double  time_b;
+    double  time_c;
+    double  time_d;
+
+    p_priority_array = malloc(sizeof(double) * NODES);
+    p_element_array = malloc(sizeof(void*) * NODES);
+
+    for (i = 0; i < NODES; ++i)
+    {
+        p_priority_array[i] = rand() % 1000000;
+        p_element_array[i] = (void*)(i + 1);
+    }
+
+    for (configuration = 0; configuration < 4; ++configuration)
+    {
+        p_heap = heap_alloc(configuration < 3 ? HEAP_D_ARY : HEAP_PAIRING,
+                            degrees[configuration],
+                            NODES,
+                            heap_element_hash_function,
+                            heap_element_equals_function);
+
+        time_a = get_time();
+
+        for (i = 0; i < NODES; ++i)
+        {
+            heap_add(p_heap, p_element_array[i], p_priority_array[i]);
+        }
+
+        for (i = 0; i < NODES; i += 2)
+        {
+            heap_decrease_key(p_heap,
+                              p_element_array[i],
+                              p_priority_array[i] / 2);
+        }
+
+        time_b = get_time();
+
+        while (heap_size(p_heap) > 0)
+        {
+            heap_extract_min(p_heap);
+        }
+
+        time_c = get_time();
+        heap_heapify(p_heap, p_element_array, p_priority_array, NODES);
+        time_d = get_time();
+
+        printf("Heap %s: add + decrease-key: %d milliseconds, "
+               "extract-min: %d milliseconds, heapify: %d milliseconds.\n",
+               names[configuration],
+               (int)(time_b - time_a),
+               (int)(time_c - time_b),
+               (int)(time_d - time_c));
+
+        heap_free(p_heap);
+    }
+
+    free(p_priority_array);
+    free(p_element_array);
+}
+
+/*******************************************************************************
+* Runs the benchmark suite over all the graph families. Writes CSV to          *
+* 'p_csv_file' and JSON to 'p_json_file' if they are not NULL. If              *
+* 'perf_counters' is set, the hardware counters are read around every phase.   *
+*******************************************************************************/
+static int benchmark_suite(size_t* p_size_array,
+                           size_t sizes,
+                           size_t queries,
+                           unsigned long seed,
+                           int perf_counters,
+                           FILE* p_csv_file,
+                           FILE* p_json_file)
+{
+    benchmark_config  config;
+    benchmark_result* p_result_array;
+    size_t            count;
+
+    config.p_size_array = p_size_array;
+    config.sizes = sizes;
+    config.queries = queries;
+    config.seed = seed;
+    config.perf_counters = perf_counters;
+
+    p_result_array = benchmark_run_suite(&config, &count);
+
+    if (!p_result_array) return FALSE;
+
+    if (p_csv_file) benchmark_write_csv(p_csv_file, p_result_array, count);
+    if (p_json_file) benchmark_write_json(p_json_file, p_result_array, count);
+
+    free(p_result_array);
+    return TRUE;
+}
+
+/*******************************************************************************
+* Compares two CSV result files and returns the number of regressions, or -1   *
+* if a file cannot be read.                                                    *
+*******************************************************************************/
+static int benchmark_compare_files(const char* p_baseline_path,
+                                   const char* p_result_path,
+                                   double tolerance)
+{
+    FILE*             p_file;
+    benchmark_result* p_baseline_array = NULL;
+    benchmark_result* p_result_array = NULL;
+    size_t            baseline_count = 0;
+    size_t            result_count = 0;
+    size_t            regressions;
+
+    if ((p_file = fopen(p_baseline_path, "r")))
+    {
+        p_baseline_array = benchmark_read_csv(p_file, &baseline_count);
+        fclose(p_file);
+    }
+
+    if ((p_file = fopen(p_result_path, "r")))
+    {
+        p_result_array = benchmark_read_csv(p_file, &result_count);
+        fclose(p_file);
+    }
+
+    if (!p_baseline_array || !p_result_array)
+    {
+        fprintf(stderr, "Cannot read the benchmark results.\n");
+        free(p_baseline_array);
+        free(p_result_array);
+        return -1;
+    }
+
+    regressions = benchmark_compare(stdout,
+                                    p_baseline_array,
+                                    baseline_count,
+                                    p_result_array,
+                                    result_count,
+                                    tolerance);
+
+    printf("%lu regression(s) out of %lu result(s).\n",
+           (unsigned long) regressions,
+           (unsigned long) result_count);
+
+    free(p_baseline_array);
+    free(p_result_array);
+    return (int) regressions;
+}
+
+static void benchmark_graph_families()
+{
+    size_t sizes[] = { 1000, 10000 };
+
+    puts("Graph families:");
+    benchmark_suite(sizes, 2, 50, 1, FALSE, stdout, NULL);
+}
+
+static void benchmark_all()
+{
+    benchmark_unweighted_general_graph();
+    benchmark_balanced_bidirectional_search();
+    benchmark_heap();
+    benchmark_arc_updates();
+    benchmark_dynamic_bfs_tree();
+    benchmark_weakly_connected_components();
+    benchmark_reachability_index();
+    benchmark_delta_stepping();
+    benchmark_betweenness_centrality();
+    benchmark_pagerank();
+    benchmark_integer_dijkstra();
+    benchmark_graph_generators();
+    benchmark_graph_ordering();
+    benchmark_compressed_graph();
+    benchmark_versioned_graph();
+    benchmark_query_engine();
+    benchmark_scheduler();
+    benchmark_frontier_queue();
+    benchmark_concurrent_map();
+    benchmark_graph_families();
+}
+
+static void print_usage(const char* p_program)
+{
+    printf("Usage: %s\n"
+           "       %s --benchmark [--csv FILE] [--json FILE] "
+           "[--queries N] [--seed N] [--perf]\n"
+           "       %s --compare BASELINE.csv RESULTS.csv [TOLERANCE]\n",
+           p_program,
+           p_program,
+           p_program);
+}
+
+/*******************************************************************************
+* Runs the benchmark suite at the sizes 1000, 10000 and 100000 as requested by *
+* the command line.                                                            *
+*******************************************************************************/
+static int run_benchmark_command(int argc, char* argv[])
+{
+    size_t        sizes[] = { 1000, 10000, 100000 };
+    size_t        queries = 100;
+    unsigned long seed = 1;
+    int           perf_counters = FALSE;
+    FILE*         p_csv_file = NULL;
+    FILE*         p_json_file = NULL;
+    int           i;
+    int           ok;
+
+    for (i = 2; i < argc; ++i)
+    {
+        if (i + 1 < argc && strcmp(argv[i], "--csv") == 0)
+        {
+            p_csv_file = fopen(argv[++i], "w");
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--json") == 0)
+        {
+            p_json_file = fopen(argv[++i], "w");
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--queries") == 0)
+        {
+            queries = (size_t) atol(argv[++i]);
+        }
+        else if (i + 1 < argc && strcmp(argv[i], "--seed") == 0)
+        {
+            seed = (unsigned long) atol(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--perf") == 0)
+        {
+            perf_counters = TRUE;
+        }
+        else
+        {
+            print_usage(argv[0]);
+            return 2;
+        }
+    }
+
+    ok = benchmark_suite(sizes,
+                         sizeof(sizes) / sizeof(sizes[0]),
+                         queries,
+                         seed,
+                         perf_counters,
+                         p_csv_file || p_json_file ? p_csv_file : stdout,
+                         p_json_file);
+
+    if (p_csv_file) fclose(p_csv_file);
+    if (p_json_file) fclose(p_json_file);
+
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
+{
+    int regressions;
+
+    if (argc > 1 && strcmp(argv[1], "--benchmark") == 0)
+    {
+        return run_benchmark_command(argc, argv);
+    }
+
+    if (argc > 1 && strcmp(argv[1], "--compare") == 0)
+    {
+        if (argc < 4)
+        {
+            print_usage(argv[0]);
+            return 2;
+        }
+
+        regressions = benchmark_compare_files(argv[2],
+                                              argv[3],
+                                              argc > 4 ? atof(argv[4]) : 0.1);
+        return regressions == 0 ? 0 : 1;
+    }
+
+    if (argc > 1)
+    {
+        print_usage(argv[0]);
+        return 2;
+    }
+
 #ifdef _C_GRAPH_V2_TEST
     test_all();
 #endif
@@ -35,17 +35,42 @@ OBJECTDIR=${CND_BUILDDIR}/${CND_CONF}/${CND_PLATFORM}
 
 # Object Files
 OBJECTFILES= \
+	${OBJECTDIR}/allocation.o \
+	${OBJECTDIR}/benchmark.o \
+	${OBJECTDIR}/betweenness_centrality.o \
 	${OBJECTDIR}/bidirectional_breadth_first_search.o \
 	${OBJECTDIR}/breadth_first_search.o \
+	${OBJECTDIR}/compact_graph.o \
+	${OBJECTDIR}/compressed_graph.o \
+	${OBJECTDIR}/concurrent_map.o \
+	${OBJECTDIR}/delta_stepping.o \
 	${OBJECTDIR}/directed_graph_node.o \
+	${OBJECTDIR}/directed_graph_update.o \
 	${OBJECTDIR}/directed_graph_weight_function.o \
+	${OBJECTDIR}/dynamic_bfs_tree.o \
+	${OBJECTDIR}/frontier_queue.o \
+	${OBJECTDIR}/graph_generator.o \
+	${OBJECTDIR}/graph_ordering.o \
+	${OBJECTDIR}/heap.o \
+	${OBJECTDIR}/integer_dijkstra.o \
 	${OBJECTDIR}/list.o \
 	${OBJECTDIR}/main.o \
 	${OBJECTDIR}/my_assert.o \
+	${OBJECTDIR}/pagerank.o \
+	${OBJECTDIR}/parallel.o \
+	${OBJECTDIR}/perf_counters.o \
+	${OBJECTDIR}/philox.o \
+	${OBJECTDIR}/query_engine.o \
 	${OBJECTDIR}/queue.o \
+	${OBJECTDIR}/reachability_index.o \
+	${OBJECTDIR}/scheduler.o \
+	${OBJECTDIR}/search_path.o \
+	${OBJECTDIR}/timing.o \
 	${OBJECTDIR}/unordered_map.o \
 	${OBJECTDIR}/unordered_set.o \
-	${OBJECTDIR}/utils.o
+	${OBJECTDIR}/utils.o \
+	${OBJECTDIR}/versioned_graph.o \
+	${OBJECTDIR}/weakly_connected_components.o
 
 
 # C Compiler Flags
@@ -62,7 +87,7 @@ FFLAGS=
 ASFLAGS=
 
 # Link Libraries and Options
-LDLIBSOPTIONS=
+LDLIBSOPTIONS=-lpthread -lm
 
 # Build Targets
 .build-conf: ${BUILD_SUBPROJECTS}
@@ -72,6 +97,21 @@ ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/c.graph.v2: ${OBJECTFILES}
 	${MKDIR} -p ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}
 	${LINK.c} -o ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/c.graph.v2 ${OBJECTFILES} ${LDLIBSOPTIONS}
 
+${OBJECTDIR}/allocation.o: allocation.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -std=c89 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/allocation.o allocation.c
+
+${OBJECTDIR}/benchmark.o: benchmark.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -std=c89 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/benchmark.o benchmark.c
+
+${OBJECTDIR}/betweenness_centrality.o: betweenness_centrality.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -std=c89 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/betweenness_centrality.o betweenness_centrality.c
+
 ${OBJECTDIR}/bidirectional_breadth_first_search.o: bidirectional_breadth_first_search.c
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
@@ -82,16 +122,71 @@ ${OBJECTDIR}/breadth_first_search.o: breadth_first_search.c
 	${RM} "$@.d"
 	$(COMPILE.c) -O2 -std=c89 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/breadth_first_search.o breadth_first_search.c
 
+${OBJECTDIR}/compact_graph.o: compact_graph.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -std=c89 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/compact_graph.o compact_graph.c
+
+${OBJECTDIR}/compressed_graph.o: compressed_graph.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -std=c89 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/compressed_graph.o compressed_graph.c
+
+${OBJECTDIR}/concurrent_map.o: concurrent_map.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -std=c89 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/concurrent_map.o concurrent_map.c
+
+${OBJECTDIR}/delta_stepping.o: delta_stepping.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -std=c89 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/delta_stepping.o delta_stepping.c
+
 ${OBJECTDIR}/directed_graph_node.o: directed_graph_node.c
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
 	$(COMPILE.c) -O2 -std=c89 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/directed_graph_node.o directed_graph_node.c
 
+${OBJECTDIR}/directed_graph_update.o: directed_graph_update.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -std=c89 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/directed_graph_update.o directed_graph_update.c
+
 ${OBJECTDIR}/directed_graph_weight_function.o: directed_graph_weight_function.c
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
 	$(COMPILE.c) -O2 -std=c89 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/directed_graph_weight_function.o directed_graph_weight_function.c
 
+${OBJECTDIR}/dynamic_bfs_tree.o: dynamic_bfs_tree.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -std=c89 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/dynamic_bfs_tree.o dynamic_bfs_tree.c
+
+${OBJECTDIR}/frontier_queue.o: frontier_queue.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -std=c89 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/frontier_queue.o frontier_queue.c
+
+${OBJECTDIR}/graph_generator.o: graph_generator.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -std=c89 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/graph_generator.o graph_generator.c
+
+${OBJECTDIR}/graph_ordering.o: graph_ordering.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -std=c89 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/graph_ordering.o graph_ordering.c
+
+${OBJECTDIR}/heap.o: heap.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -std=c89 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/heap.o heap.c
+
+${OBJECTDIR}/integer_dijkstra.o: integer_dijkstra.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -std=c89 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/integer_dijkstra.o integer_dijkstra.c
+
 ${OBJECTDIR}/list.o: list.c
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
@@ -107,11 +202,56 @@ ${OBJECTDIR}/my_assert.o: my_assert.c
 	${RM} "$@.d"
 	$(COMPILE.c) -O2 -std=c89 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/my_assert.o my_assert.c
 
+${OBJECTDIR}/pagerank.o: pagerank.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -std=c89 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/pagerank.o pagerank.c
+
+${OBJECTDIR}/parallel.o: parallel.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -std=c89 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/parallel.o parallel.c
+
+${OBJECTDIR}/perf_counters.o: perf_counters.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -std=c89 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/perf_counters.o perf_counters.c
+
+${OBJECTDIR}/philox.o: philox.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -std=c89 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/philox.o philox.c
+
+${OBJECTDIR}/query_engine.o: query_engine.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -std=c89 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/query_engine.o query_engine.c
+
 ${OBJECTDIR}/queue.o: queue.c
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
 	$(COMPILE.c) -O2 -std=c89 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/queue.o queue.c
 
+${OBJECTDIR}/reachability_index.o: reachability_index.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -std=c89 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/reachability_index.o reachability_index.c
+
+${OBJECTDIR}/scheduler.o: scheduler.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -std=c89 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/scheduler.o scheduler.c
+
+${OBJECTDIR}/search_path.o: search_path.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -std=c89 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/search_path.o search_path.c
+
+${OBJECTDIR}/timing.o: timing.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -std=c89 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/timing.o timing.c
+
 ${OBJECTDIR}/unordered_map.o: unordered_map.c
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
@@ -127,6 +267,16 @@ ${OBJECTDIR}/utils.o: utils.c
 	${RM} "$@.d"
 	$(COMPILE.c) -O2 -std=c89 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/utils.o utils.c
 
+${OBJECTDIR}/versioned_graph.o: versioned_graph.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -std=c89 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/versioned_graph.o versioned_graph.c
+
+${OBJECTDIR}/weakly_connected_components.o: weakly_connected_components.c
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.c) -O2 -std=c89 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/weakly_connected_components.o weakly_connected_components.c
+
 # Subprojects
 .build-subprojects:
 
@@ -0,0 +1,703 @@
+#include "my_assert.h"
+#include "pagerank.h"
+#include "parallel.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define FALSE 0
+#define TRUE 1
+
+/*******************************************************************************
+* The rows of a sweep are processed in blocks of this many nodes, each block   *
+* summing its own residual and dangling mass.                                  *
+*******************************************************************************/
+#define PAGERANK_BLOCK 4096
+
+typedef struct pagerank_context {
+    compact_graph* p_graph;
+    float*         p_rank_array;
+    float*         p_share_array;
+    float*         p_next_share_array;
+    double*        p_residual_array;
+    double*        p_dangling_array;
+    float          damping;
+    float          base;
+} pagerank_context;
+
+/*******************************************************************************
+* Runs a sweep over the blocks of the chunk. A node's new rank depends only on *
+* the shares of the previous sweep, so the ranks are updated in place and the  *
+* shares of the next sweep are written to the other array.                     *
+*******************************************************************************/
+static void pagerank_sweep(size_t chunk_begin,
+                           size_t chunk_end,
+                           size_t thread_index,
+                           void* p_argument)
+{
+    pagerank_context* p_context = (pagerank_context*) p_argument;
+    compact_graph*    p_graph   = p_context->p_graph;
+    const size_t*     p_offsets = p_graph->p_parent_offsets;
+    const size_t*     p_parents = p_graph->p_parent_array;
+    const float*      p_share_array = p_context->p_share_array;
+    size_t            block;
+    size_t            node;
+    size_t            end;
+    size_t            i;
+    size_t            out_degree;
+    float             sum;
+    float             rank;
+    double            residual;
+    double            dangling;
+
+    (void) thread_index;
+
+    for (block = chunk_begin; block < chunk_end; ++block)
+    {
+        end = (block + 1) * PAGERANK_BLOCK;
+
+        if (end > p_graph->nodes) end = p_graph->nodes;
+
+        residual = 0.0;
+        dangling = 0.0;
+
+        for (node = block * PAGERANK_BLOCK; node < end; ++node)
+        {
+            sum = 0.0f;
+
+            for (i = p_offsets[node]; i < p_offsets[node + 1]; ++i)
+            {
+                sum += p_share_array[p_parents[i]];
+            }
+
+            rank = p_context->base + p_context->damping * sum;
+            residual += fabs((double) rank - p_context->p_rank_array[node]);
+            p_context->p_rank_array[node] = rank;
+            out_degree = p_graph->p_child_offsets[node + 1] -
+                         p_graph->p_child_offsets[node];
+
+            if (out_degree > 0)
+            {
+                p_context->p_next_share_array[node] = rank / out_degree;
+            }
+            else
+            {
+                p_context->p_next_share_array[node] = 0.0f;
+                dangling += rank;
+            }
+        }
+
+        p_context->p_residual_array[block] = residual;
+        p_context->p_dangling_array[block] = dangling;
+    }
+}
+
+pagerank_result* pagerank_alloc(compact_graph* p_graph,
+                                float damping,
+                                double tolerance,
+                                size_t max_iterations,
+                                size_t threads)
+{
+    pagerank_result* p_result;
+    pagerank_context context;
+    float*           p_swap;
+    size_t           blocks;
+    size_t           node;
+    size_t           out_degree;
+    size_t           i;
+    double           dangling = 0.0;
+    float            initial;
+
+    if (!p_graph) return NULL;
+
+    blocks = (p_graph->nodes + PAGERANK_BLOCK - 1) / PAGERANK_BLOCK;
+    p_result = malloc(sizeof(*p_result));
+    context.p_rank_array       = malloc(sizeof(float) * (p_graph->nodes + 1));
+    context.p_share_array      = malloc(sizeof(float) * (p_graph->nodes + 1));
+    context.p_next_share_array = malloc(sizeof(float) * (p_graph->nodes + 1));
+    context.p_residual_array   = malloc(sizeof(double) * (blocks + 1));
+    context.p_dangling_array   = malloc(sizeof(double) * (blocks + 1));
+
+    if (!p_result
+        || !context.p_rank_array
+        || !context.p_share_array
+        || !context.p_next_share_array
+        || !context.p_residual_array
+        || !context.p_dangling_array)
+    {
+        free(p_result);
+        free(context.p_rank_array);
+        free(context.p_share_array);
+        free(context.p_next_share_array);
+        free(context.p_residual_array);
+        free(context.p_dangling_array);
+        return NULL;
+    }
+
+    context.p_graph = p_graph;
+    context.damping = damping;
+    initial = p_graph->nodes > 0 ? 1.0f / p_graph->nodes : 0.0f;
+
+    for (node = 0; node < p_graph->nodes; ++node)
+    {
+        out_degree = p_graph->p_child_offsets[node + 1] -
+                     p_graph->p_child_offsets[node];
+        context.p_rank_array[node]  = initial;
+        context.p_share_array[node] = out_degree > 0 ?
+                                      initial / out_degree : 0.0f;
+
+        if (out_degree == 0) dangling += initial;
+    }
+
+    p_result->nodes        = p_graph->nodes;
+    p_result->iterations   = 0;
+    p_result->residual     = 0.0;
+    p_result->p_rank_array = context.p_rank_array;
+
+    while (p_result->iterations < max_iterations && p_graph->nodes > 0)
+    {
+        /* The mass of the nodes without children is spread evenly. */
+        context.base = (float) ((1.0 - damping + damping * dangling) /
+                                p_graph->nodes);
+
+        parallel_for(0, blocks, threads, pagerank_sweep, &context);
+
+        p_result->iterations++;
+        p_result->residual = 0.0;
+        dangling = 0.0;
+
+        for (i = 0; i < blocks; ++i)
+        {
+            p_result->residual += context.p_residual_array[i];
+            dangling += context.p_dangling_array[i];
+        }
+
+        p_swap = context.p_share_array;
+        context.p_share_array = context.p_next_share_array;
+        context.p_next_share_array = p_swap;
+
+        if (p_result->residual < tolerance) break;
+    }
+
+    free(context.p_share_array);
+    free(context.p_next_share_array);
+    free(context.p_residual_array);
+    free(context.p_dangling_array);
+    return p_result;
+}
+
+pagerank_result* pagerank_alloc_from_nodes(directed_graph_node** p_node_array,
+                                           size_t nodes,
+                                           float damping,
+                                           double tolerance,
+                                           size_t max_iterations,
+                                           size_t threads)
+{
+    compact_graph*   p_graph = compact_graph_alloc(p_node_array, nodes);
+    pagerank_result* p_result;
+
+    if (!p_graph) return NULL;
+
+    p_result = pagerank_alloc(p_graph,
+                              damping,
+                              tolerance,
+                              max_iterations,
+                              threads);
+    compact_graph_free(p_graph);
+    return p_result;
+}
+
+#define STATE_QUEUED  1
+#define STATE_TOUCHED 2
+
+/*******************************************************************************
+* Adds to the residual of the node, listing it as touched the first time, and  *
+* enqueues it unless it is queued already or its residual is at most 'epsilon' *
+* times its out-degree, a node without children counting as one.               *
+*******************************************************************************/
+static void pagerank_push(personalized_pagerank_context* p_context,
+                          size_t node,
+                          float mass,
+                          size_t head,
+                          size_t* p_size,
+                          double epsilon)
+{
+    compact_graph* p_graph = p_context->p_graph;
+    size_t         out_degree = p_graph->p_child_offsets[node + 1] -
+                                p_graph->p_child_offsets[node];
+
+    p_context->p_residual_array[node] += mass;
+
+    if (!(p_context->p_state_array[node] & STATE_TOUCHED))
+    {
+        p_context->p_touched_array[p_context->touched++] = node;
+        p_context->p_state_array[node] |= STATE_TOUCHED;
+    }
+
+    if (p_context->p_state_array[node] & STATE_QUEUED) return;
+
+    if (p_context->p_residual_array[node]
+        <= epsilon * (out_degree > 0 ? out_degree : 1))
+    {
+        return;
+    }
+
+    /* The queue is circular; a node is in it at most once. */
+    p_context->p_queue_array[(head + (*p_size)++) % p_graph->nodes] = node;
+    p_context->p_state_array[node] |= STATE_QUEUED;
+}
+
+int personalized_pagerank_context_init(personalized_pagerank_context* p_context,
+                                       compact_graph* p_graph)
+{
+    size_t nodes = p_graph->nodes;
+
+    p_context->p_graph          = p_graph;
+    p_context->p_rank_array     = calloc(nodes, sizeof(float));
+    p_context->p_residual_array = calloc(nodes, sizeof(float));
+    p_context->p_queue_array    = malloc(sizeof(size_t) * nodes);
+    p_context->p_touched_array  = malloc(sizeof(size_t) * nodes);
+    p_context->p_state_array    = calloc(nodes, sizeof(char));
+    p_context->touched          = 0;
+    p_context->iterations       = 0;
+    p_context->residual         = 0.0;
+
+    if (!p_context->p_rank_array
+        || !p_context->p_residual_array
+        || !p_context->p_queue_array
+        || !p_context->p_touched_array
+        || !p_context->p_state_array)
+    {
+        personalized_pagerank_context_destroy(p_context);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+int personalized_pagerank_run(personalized_pagerank_context* p_context,
+                              size_t seed,
+                              float damping,
+                              double epsilon)
+{
+    compact_graph* p_graph = p_context->p_graph;
+    size_t         head = 0;
+    size_t         size = 0;
+    size_t         node;
+    size_t         out_degree;
+    size_t         i;
+    float          residual;
+    float          kept;
+    float          share;
+
+    if (seed >= p_graph->nodes) return FALSE;
+
+    /* Only the nodes of the previous query need clearing. */
+    for (i = 0; i < p_context->touched; ++i)
+    {
+        node = p_context->p_touched_array[i];
+        p_context->p_rank_array[node]     = 0.0f;
+        p_context->p_residual_array[node] = 0.0f;
+        p_context->p_state_array[node]    = 0;
+    }
+
+    p_context->touched    = 0;
+    p_context->iterations = 0;
+    p_context->residual   = 1.0;
+    pagerank_push(p_context, seed, 1.0f, head, &size, epsilon);
+
+    while (size > 0)
+    {
+        node = p_context->p_queue_array[head];
+        head = (head + 1) % p_graph->nodes;
+        size--;
+        p_context->p_state_array[node] &= ~STATE_QUEUED;
+
+        residual = p_context->p_residual_array[node];
+        out_degree = p_graph->p_child_offsets[node + 1] -
+                     p_graph->p_child_offsets[node];
+        kept = (1.0f - damping) * residual;
+        p_context->p_rank_array[node] += kept;
+        p_context->p_residual_array[node] = 0.0f;
+        p_context->residual -= kept;
+        p_context->iterations++;
+
+        if (out_degree == 0)
+        {
+            /* The surfer jumps back to the seed. */
+            pagerank_push(p_context,
+                          seed,
+                          damping * residual,
+                          head,
+                          &size,
+                          epsilon);
+            continue;
+        }
+
+        share = damping * residual / out_degree;
+
+        for (i = p_graph->p_child_offsets[node];
+             i < p_graph->p_child_offsets[node + 1];
+             ++i)
+        {
+            pagerank_push(p_context,
+                          p_graph->p_child_array[i],
+                          share,
+                          head,
+                          &size,
+                          epsilon);
+        }
+    }
+
+    if (p_context->residual < 0.0) p_context->residual = 0.0;
+
+    return TRUE;
+}
+
+void personalized_pagerank_context_destroy(
+    personalized_pagerank_context* p_context)
+{
+    free(p_context->p_rank_array);
+    free(p_context->p_residual_array);
+    free(p_context->p_queue_array);
+    free(p_context->p_touched_array);
+    free(p_context->p_state_array);
+
+    p_context->p_rank_array     = NULL;
+    p_context->p_residual_array = NULL;
+    p_context->p_queue_array    = NULL;
+    p_context->p_touched_array  = NULL;
+    p_context->p_state_array    = NULL;
+    p_context->touched          = 0;
+}
+
+pagerank_result* personalized_pagerank_alloc(compact_graph* p_graph,
+                                             size_t seed,
+                                             float damping,
+                                             double epsilon)
+{
+    personalized_pagerank_context context;
+    pagerank_result*              p_result;
+
+    if (!p_graph || seed >= p_graph->nodes) return NULL;
+
+    p_result = malloc(sizeof(*p_result));
+
+    if (!p_result) return NULL;
+
+    if (!personalized_pagerank_context_init(&context, p_graph))
+    {
+        free(p_result);
+        return NULL;
+    }
+
+    personalized_pagerank_run(&context, seed, damping, epsilon);
+
+    /* The result takes over the rank array. */
+    p_result->nodes        = p_graph->nodes;
+    p_result->iterations   = context.iterations;
+    p_result->residual     = context.residual;
+    p_result->p_rank_array = context.p_rank_array;
+    context.p_rank_array   = NULL;
+
+    personalized_pagerank_context_destroy(&context);
+    return p_result;
+}
+
+void pagerank_result_free(pagerank_result* p_result)
+{
+    if (!p_result) return;
+
+    free(p_result->p_rank_array);
+    free(p_result);
+}
+
+static void pagerank_test_cycle()
+{
+    directed_graph_node* p_nodes[8];
+    pagerank_result*     p_result;
+    size_t               i;
+
+    puts("        pagerank_test_cycle()");
+
+    for (i = 0; i < 8; ++i)
+    {
+        p_nodes[i] = directed_graph_node_alloc((int) i);
+    }
+
+    /* Every node of a directed cycle has the same rank. */
+    for (i = 0; i < 8; ++i)
+    {
+        directed_graph_node_add_arc(p_nodes[i], p_nodes[(i + 1) % 8]);
+    }
+
+    p_result = pagerank_alloc_from_nodes(p_nodes, 8, 0.85f, 1e-7, 100, 2);
+    ASSERT(p_result != NULL);
+    ASSERT(p_result->nodes == 8);
+    ASSERT(p_result->iterations == 1);
+
+    for (i = 0; i < 8; ++i)
+    {
+        ASSERT(fabs(p_result->p_rank_array[i] - 0.125) < 1e-6);
+    }
+
+    pagerank_result_free(p_result);
+
+    /* The sink 7 is dangling and collects the most rank. */
+    directed_graph_node_remove_arc(p_nodes[7], p_nodes[0]);
+
+    p_result = pagerank_alloc_from_nodes(p_nodes, 8, 0.85f, 1e-7, 100, 1);
+    ASSERT(p_result->iterations > 1 && p_result->residual < 1e-7);
+
+    for (i = 1; i < 8; ++i)
+    {
+        ASSERT(p_result->p_rank_array[i] > p_result->p_rank_array[i - 1]);
+    }
+
+    pagerank_result_free(p_result);
+
+    p_result = pagerank_alloc_from_nodes(p_nodes, 8, 0.85f, 0.0, 3, 1);
+    ASSERT(p_result->iterations == 3);
+    pagerank_result_free(p_result);
+
+    for (i = 0; i < 8; ++i)
+    {
+        directed_graph_node_free(p_nodes[i]);
+    }
+}
+
+/*******************************************************************************
+* Compares against a power iteration in double precision on a random graph     *
+* with dangling nodes, spread over a few blocks.                               *
+*******************************************************************************/
+static void pagerank_test_random()
+{
+    const size_t          nodes = 10000;
+    directed_graph_node** p_nodes = malloc(sizeof(*p_nodes) * nodes);
+    compact_graph*        p_graph;
+    pagerank_result*      p_result;
+    pagerank_result*      p_other;
+    double*               p_expected_array = malloc(sizeof(double) * nodes);
+    double*               p_next_array = malloc(sizeof(double) * nodes);
+    double                dangling;
+    double                total;
+    size_t                out_degree;
+    size_t                iteration;
+    size_t                v;
+    size_t                i;
+
+    puts("        pagerank_test_random()");
+    srand(11);
+
+    for (i = 0; i < nodes; ++i)
+    {
+        p_nodes[i] = directed_graph_node_alloc((int) i);
+    }
+
+    /* Only the first half has children. */
+    for (i = 0; i < 4 * nodes; ++i)
+    {
+        directed_graph_node_add_arc(p_nodes[rand() % (nodes / 2)],
+                                    p_nodes[rand() % nodes]);
+    }
+
+    p_graph = compact_graph_alloc(p_nodes, nodes);
+
+    for (v = 0; v < nodes; ++v) p_expected_array[v] = 1.0 / nodes;
+
+    for (iteration = 0; iteration < 200; ++iteration)
+    {
+        dangling = 0.0;
+
+        for (v = 0; v < nodes; ++v)
+        {
+            if (compact_graph_out_degree(p_graph, v) == 0)
+            {
+                dangling += p_expected_array[v];
+            }
+        }
+
+        for (v = 0; v < nodes; ++v)
+        {
+            p_next_array[v] = (0.15 + 0.85 * dangling) / nodes;
+        }
+
+        for (v = 0; v < nodes; ++v)
+        {
+            out_degree = compact_graph_out_degree(p_graph, v);
+
+            for (i = p_graph->p_child_offsets[v];
+                 i < p_graph->p_child_offsets[v + 1];
+                 ++i)
+            {
+                p_next_array[p_graph->p_child_array[i]] +=
+                    0.85 * p_expected_array[v] / out_degree;
+            }
+        }
+
+        for (v = 0; v < nodes; ++v) p_expected_array[v] = p_next_array[v];
+    }
+
+    p_result = pagerank_alloc(p_graph, 0.85f, 1e-6, 100, 1);
+    ASSERT(p_result != NULL);
+    ASSERT(p_result->iterations < 100 && p_result->residual < 1e-6);
+    total = 0.0;
+
+    for (v = 0; v < nodes; ++v)
+    {
+        ASSERT(fabs(p_result->p_rank_array[v] - p_expected_array[v]) < 1e-6);
+        total += p_result->p_rank_array[v];
+    }
+
+    ASSERT(fabs(total - 1.0) < 1e-4);
+
+    /* The block sums are added in order whatever the thread count. */
+    p_other = pagerank_alloc(p_graph, 0.85f, 1e-6, 100, 4);
+    ASSERT(p_other->iterations == p_result->iterations);
+    ASSERT(p_other->residual == p_result->residual);
+
+    for (v = 0; v < nodes; ++v)
+    {
+        ASSERT(p_other->p_rank_array[v] == p_result->p_rank_array[v]);
+    }
+
+    pagerank_result_free(p_result);
+    pagerank_result_free(p_other);
+    compact_graph_free(p_graph);
+
+    for (i = 0; i < nodes; ++i)
+    {
+        directed_graph_node_free(p_nodes[i]);
+    }
+
+    free(p_nodes);
+    free(p_expected_array);
+    free(p_next_array);
+}
+
+/*******************************************************************************
+* Compares the pushes against a power iteration in double precision that jumps *
+* back to the seed, checks that the mass is kept and that a reused context     *
+* gives the same ranks as a fresh one.                                         *
+*******************************************************************************/
+static void pagerank_test_personalized()
+{
+    const size_t                  nodes = 200;
+    directed_graph_node*          p_nodes[200];
+    compact_graph*                p_graph;
+    pagerank_result*              p_result;
+    personalized_pagerank_context context;
+    double                        p_expected_array[200];
+    double                        p_next_array[200];
+    double                        dangling;
+    double                        total;
+    size_t                        out_degree;
+    size_t                        iteration;
+    size_t                        seed;
+    size_t                        v;
+    size_t                        i;
+
+    puts("        pagerank_test_personalized()");
+    srand(13);
+
+    for (i = 0; i < nodes; ++i)
+    {
+        p_nodes[i] = directed_graph_node_alloc((int) i);
+    }
+
+    for (i = 0; i < 3 * nodes; ++i)
+    {
+        v = (size_t) rand() % nodes;
+
+        /* Every tenth node is dangling. */
+        if (v % 10 != 9)
+        {
+            directed_graph_node_add_arc(p_nodes[v], p_nodes[rand() % nodes]);
+        }
+    }
+
+    p_graph = compact_graph_alloc(p_nodes, nodes);
+    ASSERT(personalized_pagerank_context_init(&context, p_graph));
+
+    for (seed = 0; seed < nodes; seed += 37)
+    {
+        for (v = 0; v < nodes; ++v) p_expected_array[v] = v == seed;
+
+        for (iteration = 0; iteration < 300; ++iteration)
+        {
+            dangling = 0.0;
+
+            for (v = 0; v < nodes; ++v)
+            {
+                p_next_array[v] = 0.0;
+
+                if (compact_graph_out_degree(p_graph, v) == 0)
+                {
+                    dangling += p_expected_array[v];
+                }
+            }
+
+            p_next_array[seed] = 0.15 + 0.85 * dangling;
+
+            for (v = 0; v < nodes; ++v)
+            {
+                out_degree = compact_graph_out_degree(p_graph, v);
+
+                for (i = p_graph->p_child_offsets[v];
+                     i < p_graph->p_child_offsets[v + 1];
+                     ++i)
+                {
+                    p_next_array[p_graph->p_child_array[i]] +=
+                        0.85 * p_expected_array[v] / out_degree;
+                }
+            }
+
+            for (v = 0; v < nodes; ++v) p_expected_array[v] = p_next_array[v];
+        }
+
+        p_result = personalized_pagerank_alloc(p_graph, seed, 0.85f, 1e-7);
+        ASSERT(p_result != NULL);
+        ASSERT(p_result->iterations > 0);
+        ASSERT(p_result->residual < 1e-3);
+        total = p_result->residual;
+
+        for (v = 0; v < nodes; ++v)
+        {
+            ASSERT(fabs(p_result->p_rank_array[v] - p_expected_array[v])
+                   < 1e-3);
+            total += p_result->p_rank_array[v];
+        }
+
+        ASSERT(fabs(total - 1.0) < 1e-4);
+
+        /* The reused context clears what the previous seed left behind. */
+        ASSERT(personalized_pagerank_run(&context, seed, 0.85f, 1e-7));
+        ASSERT(context.iterations == p_result->iterations);
+        ASSERT(context.residual == p_result->residual);
+
+        for (v = 0; v < nodes; ++v)
+        {
+            ASSERT(context.p_rank_array[v] == p_result->p_rank_array[v]);
+        }
+
+        pagerank_result_free(p_result);
+    }
+
+    ASSERT(!personalized_pagerank_run(&context, nodes, 0.85f, 1e-7));
+    personalized_pagerank_context_destroy(&context);
+    ASSERT(personalized_pagerank_alloc(p_graph, nodes, 0.85f, 1e-7) == NULL);
+    compact_graph_free(p_graph);
+
+    for (i = 0; i < nodes; ++i)
+    {
+        directed_graph_node_free(p_nodes[i]);
+    }
+}
+
+void pagerank_test()
+{
+    puts("    pagerank_test()");
+    pagerank_test_cycle();
+    pagerank_test_random();
+    pagerank_test_personalized();
+}
@@ -0,0 +1,132 @@
+#ifndef PAGERANK_H
+#define PAGERANK_H
+
+#include "compact_graph.h"
+#include "directed_graph_node.h"
+#include <stddef.h>
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * Maps each node index to its rank. 'iterations' is the number of sweeps   *
+    * of 'pagerank_alloc' or of pushes of 'personalized_pagerank_alloc', and   *
+    * 'residual' the L1 change of the last sweep or the residual mass left     *
+    * unpushed.                                                                *
+    ***************************************************************************/
+    typedef struct pagerank_result {
+        size_t nodes;
+        size_t iterations;
+        double residual;
+        float* p_rank_array;
+    } pagerank_result;
+
+    /***************************************************************************
+    * Computes the PageRank of every node by power iteration: a surfer follows *
+    * a random arc with the probability 'damping' and jumps to a random node   *
+    * otherwise, and from a node without children always jumps. Each sweep     *
+    * pulls along the parent rows of the snapshot: a node sums the shares      *
+    * 'rank / out-degree' of its parents, which the previous sweep stored in   *
+    * a flat float array, so the inner loop is a gather and an add. The rows   *
+    * are split into blocks run by 'threads' threads, zero meaning the         *
+    * hardware concurrency; the block sums are added in order, so the result   *
+    * does not depend on the thread count. Stops once a sweep changes the      *
+    * ranks by less than 'tolerance' in L1 norm, or after 'max_iterations'     *
+    * sweeps. Returns NULL if the memory ran out.                              *
+    ***************************************************************************/
+    pagerank_result* pagerank_alloc(compact_graph* p_graph,
+                                    float damping,
+                                    double tolerance,
+                                    size_t max_iterations,
+                                    size_t threads);
+
+    /***************************************************************************
+    * Same as 'pagerank_alloc' over a snapshot of the nodes in 'p_node_array', *
+    * which is released before returning. The ranks follow the order of the    *
+    * array.                                                                   *
+    ***************************************************************************/
+    pagerank_result* pagerank_alloc_from_nodes(
+        directed_graph_node** p_node_array,
+        size_t nodes,
+        float damping,
+        double tolerance,
+        size_t max_iterations,
+        size_t threads);
+
+    /***************************************************************************
+    * The scratch arrays of personalized PageRank over one graph, kept between *
+    * queries so that only 'personalized_pagerank_context_init' allocates and  *
+    * zeroes arrays the size of the graph. After a query, 'p_rank_array' holds *
+    * the rank of each node index, 'p_touched_array' lists the 'touched' nodes *
+    * that received mass, every other rank being zero, 'iterations' counts the *
+    * pushes and 'residual' is the mass left unpushed.                         *
+    ***************************************************************************/
+    typedef struct personalized_pagerank_context {
+        compact_graph* p_graph;
+        float*         p_rank_array;
+        float*         p_residual_array;
+        size_t*        p_queue_array;
+        size_t*        p_touched_array;
+        char*          p_state_array;
+        size_t         touched;
+        size_t         iterations;
+        double         residual;
+    } personalized_pagerank_context;
+
+    /***************************************************************************
+    * Allocates the scratch arrays for the graph. Returns false if the memory  *
+    * ran out, leaving nothing allocated.                                      *
+    ***************************************************************************/
+    int personalized_pagerank_context_init(
+        personalized_pagerank_context* p_context,
+        compact_graph* p_graph);
+
+    /***************************************************************************
+    * Approximates the PageRank personalized to the node with index 'seed',    *
+    * where every jump, from a node without children as well, goes to the      *
+    * seed. Starting with the whole mass as residual at the seed, a node       *
+    * whose residual exceeds 'epsilon' times its out-degree keeps the share    *
+    * '1 - damping' of it as rank and pushes the rest to its children. No rank *
+    * exceeds the exact one, and the ranks fall short by the residual mass,    *
+    * which is tracked as the pushes happen. A query first clears the nodes    *
+    * touched by the previous one, so its cost depends only on the nodes near  *
+    * the seeds and not on the size of the graph. Returns false if the seed is *
+    * not a node.                                                              *
+    ***************************************************************************/
+    int personalized_pagerank_run(personalized_pagerank_context* p_context,
+                                  size_t seed,
+                                  float damping,
+                                  double epsilon);
+
+    /***************************************************************************
+    * Releases the scratch arrays.                                             *
+    ***************************************************************************/
+    void personalized_pagerank_context_destroy(
+        personalized_pagerank_context* p_context);
+
+    /***************************************************************************
+    * Runs a single 'personalized_pagerank_run' in a context of its own and    *
+    * returns its ranks. Allocating and zeroing the context costs time linear  *
+    * in the size of the graph on every call; a caller with many queries over  *
+    * one graph should keep a context instead. Returns NULL if the memory ran  *
+    * out or the seed is not a node.                                           *
+    ***************************************************************************/
+    pagerank_result* personalized_pagerank_alloc(compact_graph* p_graph,
+                                                 size_t seed,
+                                                 float damping,
+                                                 double epsilon);
+
+    /***************************************************************************
+    * Deallocates the result.                                                  *
+    ***************************************************************************/
+    void pagerank_result_free(pagerank_result* p_result);
+
+    /* Contains the unit tests. */
+    void pagerank_test();
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif  /* PAGERANK_H */
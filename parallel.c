@@ -0,0 +1,345 @@
+/*******************************************************
+* Exposes pthreads, sysconf and sched_yield under C89. *
+*******************************************************/
+#define _POSIX_C_SOURCE 200112L
+
+#include "my_assert.h"
+#include "parallel.h"
+#include "scheduler.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifndef _WIN32
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+#define FALSE 0
+#define TRUE 1
+
+typedef struct parallel_thread_start {
+    void (*p_function)(void*);
+    void*  p_argument;
+} parallel_thread_start;
+
+#ifdef _WIN32
+static DWORD WINAPI parallel_thread_entry(LPVOID p_argument)
+#else
+static void* parallel_thread_entry(void* p_argument)
+#endif
+{
+    parallel_thread_start start = *(parallel_thread_start*) p_argument;
+
+    free(p_argument);
+    start.p_function(start.p_argument);
+    return 0;
+}
+
+int parallel_thread_create(parallel_thread* p_thread,
+                           void (*p_function)(void*),
+                           void* p_argument)
+{
+    parallel_thread_start* p_start;
+
+    if (!p_thread || !p_function) return FALSE;
+
+    p_start = malloc(sizeof(*p_start));
+
+    if (!p_start) return FALSE;
+
+    p_start->p_function = p_function;
+    p_start->p_argument = p_argument;
+
+#ifdef _WIN32
+    *p_thread = CreateThread(NULL, 0, parallel_thread_entry, p_start, 0, NULL);
+
+    if (!*p_thread)
+#else
+    if (pthread_create(p_thread, NULL, parallel_thread_entry, p_start) != 0)
+#endif
+    {
+        free(p_start);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+void parallel_thread_join(parallel_thread thread)
+{
+#ifdef _WIN32
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+#else
+    pthread_join(thread, NULL);
+#endif
+}
+
+void parallel_mutex_init(parallel_mutex* p_mutex)
+{
+#ifdef _WIN32
+    InitializeCriticalSection(p_mutex);
+#else
+    pthread_mutex_init(p_mutex, NULL);
+#endif
+}
+
+void parallel_mutex_destroy(parallel_mutex* p_mutex)
+{
+#ifdef _WIN32
+    DeleteCriticalSection(p_mutex);
+#else
+    pthread_mutex_destroy(p_mutex);
+#endif
+}
+
+void parallel_mutex_lock(parallel_mutex* p_mutex)
+{
+#ifdef _WIN32
+    EnterCriticalSection(p_mutex);
+#else
+    pthread_mutex_lock(p_mutex);
+#endif
+}
+
+void parallel_mutex_unlock(parallel_mutex* p_mutex)
+{
+#ifdef _WIN32
+    LeaveCriticalSection(p_mutex);
+#else
+    pthread_mutex_unlock(p_mutex);
+#endif
+}
+
+void parallel_condition_init(parallel_condition* p_condition)
+{
+#ifdef _WIN32
+    InitializeConditionVariable(p_condition);
+#else
+    pthread_cond_init(p_condition, NULL);
+#endif
+}
+
+void parallel_condition_destroy(parallel_condition* p_condition)
+{
+#ifndef _WIN32
+    pthread_cond_destroy(p_condition);
+#endif
+}
+
+void parallel_condition_wait(parallel_condition* p_condition,
+                             parallel_mutex* p_mutex)
+{
+#ifdef _WIN32
+    SleepConditionVariableCS(p_condition, p_mutex, INFINITE);
+#else
+    pthread_cond_wait(p_condition, p_mutex);
+#endif
+}
+
+void parallel_condition_signal(parallel_condition* p_condition)
+{
+#ifdef _WIN32
+    WakeConditionVariable(p_condition);
+#else
+    pthread_cond_signal(p_condition);
+#endif
+}
+
+void parallel_condition_broadcast(parallel_condition* p_condition)
+{
+#ifdef _WIN32
+    WakeAllConditionVariable(p_condition);
+#else
+    pthread_cond_broadcast(p_condition);
+#endif
+}
+
+void parallel_yield()
+{
+#ifdef _WIN32
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+size_t parallel_hardware_concurrency()
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? info.dwNumberOfProcessors : 1;
+#else
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+    return count > 0 ? (size_t) count : 1;
+#endif
+}
+
+typedef struct parallel_for_chunk {
+    size_t begin;
+    size_t end;
+    size_t thread_index;
+    void (*p_body)(size_t, size_t, size_t, void*);
+    void*  p_argument;
+} parallel_for_chunk;
+
+static void parallel_for_run_chunk(void* p_argument)
+{
+    parallel_for_chunk* p_chunk = p_argument;
+
+    p_chunk->p_body(p_chunk->begin,
+                    p_chunk->end,
+                    p_chunk->thread_index,
+                    p_chunk->p_argument);
+}
+
+void parallel_for(size_t begin,
+                  size_t end,
+                  size_t threads,
+                  void (*p_body)(size_t, size_t, size_t, void*),
+                  void* p_argument)
+{
+    scheduler*          p_scheduler;
+    parallel_for_chunk* p_chunks;
+    parallel_thread*    p_threads;
+    size_t              length;
+    size_t              i;
+    size_t              started;
+
+    if (!p_body || begin >= end) return;
+
+    length = end - begin;
+
+    if (threads == 0)     threads = parallel_hardware_concurrency();
+    if (threads > length) threads = length;
+
+    if (threads == 1)
+    {
+        p_body(begin, end, 0, p_argument);
+        return;
+    }
+
+    p_scheduler = scheduler_shared();
+
+    if (p_scheduler)
+    {
+        scheduler_parallel_for(p_scheduler,
+                               begin,
+                               end,
+                               length / (8 * threads),
+                               threads,
+                               p_body,
+                               p_argument);
+        return;
+    }
+
+    /* Without the shared scheduler, each chunk gets a thread of its own. */
+    p_chunks  = malloc(sizeof(*p_chunks) * threads);
+    p_threads = malloc(sizeof(*p_threads) * threads);
+
+    if (!p_chunks || !p_threads)
+    {
+        free(p_chunks);
+        free(p_threads);
+        p_body(begin, end, 0, p_argument);
+        return;
+    }
+
+    for (i = 0; i < threads; ++i)
+    {
+        p_chunks[i].begin        = begin + (length * i) / threads;
+        p_chunks[i].end          = begin + (length * (i + 1)) / threads;
+        p_chunks[i].thread_index = i;
+        p_chunks[i].p_body       = p_body;
+        p_chunks[i].p_argument   = p_argument;
+    }
+
+    /* Chunks whose thread could not be started run on the calling thread. */
+    for (started = 1; started < threads; ++started)
+    {
+        if (!parallel_thread_create(&p_threads[started],
+                                    parallel_for_run_chunk,
+                                    &p_chunks[started]))
+        {
+            break;
+        }
+    }
+
+    parallel_for_run_chunk(&p_chunks[0]);
+
+    for (i = started; i < threads; ++i)
+    {
+        parallel_for_run_chunk(&p_chunks[i]);
+    }
+
+    for (i = 1; i < started; ++i)
+    {
+        parallel_thread_join(p_threads[i]);
+    }
+
+    free(p_chunks);
+    free(p_threads);
+}
+
+static void parallel_test_sum_body(size_t chunk_begin,
+                                   size_t chunk_end,
+                                   size_t thread_index,
+                                   void*  p_argument)
+{
+    size_t i;
+    size_t local = 0;
+
+    (void) thread_index;
+
+    for (i = chunk_begin; i < chunk_end; ++i)
+    {
+        local += i;
+    }
+
+    PARALLEL_FETCH_ADD((size_t*) p_argument, local);
+}
+
+static void parallel_test_for()
+{
+    size_t sum = 0;
+    size_t threads;
+
+    puts("        parallel_test_for()");
+
+    for (threads = 0; threads <= 8; ++threads)
+    {
+        sum = 0;
+        parallel_for(0, 10000, threads, parallel_test_sum_body, &sum);
+        ASSERT(PARALLEL_LOAD(&sum) == (size_t) 10000 * 9999 / 2);
+    }
+
+    sum = 0;
+    parallel_for(5, 8, 16, parallel_test_sum_body, &sum);
+    ASSERT(sum == 5 + 6 + 7);
+
+    sum = 0;
+    parallel_for(8, 8, 4, parallel_test_sum_body, &sum);
+    ASSERT(sum == 0);
+}
+
+static void parallel_test_atomics()
+{
+    size_t word = 10;
+
+    puts("        parallel_test_atomics()");
+
+    ASSERT(PARALLEL_CAS(&word, 10, 11));
+    ASSERT(!PARALLEL_CAS(&word, 10, 12));
+    ASSERT(PARALLEL_LOAD(&word) == 11);
+    ASSERT(PARALLEL_FETCH_ADD(&word, 5) == 11);
+    PARALLEL_STORE(&word, 3);
+    ASSERT(word == 3);
+}
+
+void parallel_test()
+{
+    puts("    parallel_test()");
+    parallel_test_atomics();
+    parallel_test_for();
+}
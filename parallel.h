@@ -0,0 +1,124 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <stddef.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <pthread.h>
+#endif
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+#ifdef _WIN32
+    typedef HANDLE             parallel_thread;
+    typedef CRITICAL_SECTION   parallel_mutex;
+    typedef CONDITION_VARIABLE parallel_condition;
+#else
+    typedef pthread_t          parallel_thread;
+    typedef pthread_mutex_t    parallel_mutex;
+    typedef pthread_cond_t     parallel_condition;
+#endif
+
+    /***************************************************************************
+    * Atomic operations over 'size_t' words. PARALLEL_CAS returns true if the  *
+    * word pointed to by 'P' held 'EXPECTED' and was replaced by 'DESIRED'.    *
+    ***************************************************************************/
+#if defined(_MSC_VER) && defined(_WIN64)
+#define PARALLEL_LOAD(P) \
+    ((size_t) InterlockedCompareExchange64((volatile LONG64*)(P), 0, 0))
+#define PARALLEL_STORE(P, VALUE) \
+    InterlockedExchange64((volatile LONG64*)(P), (LONG64)(VALUE))
+#define PARALLEL_CAS(P, EXPECTED, DESIRED)                           \
+    (InterlockedCompareExchange64((volatile LONG64*)(P),             \
+                                  (LONG64)(DESIRED),                 \
+                                  (LONG64)(EXPECTED)) == (LONG64)(EXPECTED))
+#define PARALLEL_FETCH_ADD(P, DELTA) \
+    ((size_t) InterlockedExchangeAdd64((volatile LONG64*)(P), (LONG64)(DELTA)))
+#elif defined(_MSC_VER)
+#define PARALLEL_LOAD(P) \
+    ((size_t) InterlockedCompareExchange((volatile LONG*)(P), 0, 0))
+#define PARALLEL_STORE(P, VALUE) \
+    InterlockedExchange((volatile LONG*)(P), (LONG)(VALUE))
+#define PARALLEL_CAS(P, EXPECTED, DESIRED)                           \
+    (InterlockedCompareExchange((volatile LONG*)(P),                 \
+                                (LONG)(DESIRED),                     \
+                                (LONG)(EXPECTED)) == (LONG)(EXPECTED))
+#define PARALLEL_FETCH_ADD(P, DELTA) \
+    ((size_t) InterlockedExchangeAdd((volatile LONG*)(P), (LONG)(DELTA)))
+#else
+#define PARALLEL_LOAD(P)         __atomic_load_n((P), __ATOMIC_ACQUIRE)
+#define PARALLEL_STORE(P, VALUE) __atomic_store_n((P), (VALUE), __ATOMIC_RELEASE)
+#define PARALLEL_CAS(P, EXPECTED, DESIRED) \
+    __sync_bool_compare_and_swap((P), (EXPECTED), (DESIRED))
+#define PARALLEL_FETCH_ADD(P, DELTA) __sync_fetch_and_add((P), (DELTA))
+#endif
+
+    /***************************************************************************
+    * Starts a new thread running 'p_function(p_argument)'. Returns true on    *
+    * success.                                                                 *
+    ***************************************************************************/
+    int parallel_thread_create(parallel_thread* p_thread,
+                               void (*p_function)(void*),
+                               void* p_argument);
+
+    /***************************************************************************
+    * Waits for the thread to terminate and releases its resources.            *
+    ***************************************************************************/
+    void parallel_thread_join(parallel_thread thread);
+
+    /***************************************************************************
+    * Mutexes and condition variables.                                         *
+    ***************************************************************************/
+    void parallel_mutex_init(parallel_mutex* p_mutex);
+    void parallel_mutex_destroy(parallel_mutex* p_mutex);
+    void parallel_mutex_lock(parallel_mutex* p_mutex);
+    void parallel_mutex_unlock(parallel_mutex* p_mutex);
+
+    void parallel_condition_init(parallel_condition* p_condition);
+    void parallel_condition_destroy(parallel_condition* p_condition);
+    void parallel_condition_wait(parallel_condition* p_condition,
+                                 parallel_mutex* p_mutex);
+    void parallel_condition_signal(parallel_condition* p_condition);
+    void parallel_condition_broadcast(parallel_condition* p_condition);
+
+    /***************************************************************************
+    * Gives the processor to another thread, for the spin loops.               *
+    ***************************************************************************/
+    void parallel_yield();
+
+    /***************************************************************************
+    * Returns the number of hardware threads available, at least one.          *
+    ***************************************************************************/
+    size_t parallel_hardware_concurrency();
+
+    /***************************************************************************
+    * Runs 'p_body' over contiguous chunks of ['begin', 'end') that together   *
+    * cover the range once. If 'threads' is one, the calling thread runs the   *
+    * whole range; otherwise the range is balanced over at most 'threads'      *
+    * slots of the shared work-stealing scheduler (see 'scheduler.h') with a   *
+    * grain of an eighth of the range per thread asked for. If 'threads' is    *
+    * zero, the hardware concurrency is used. Chunks running at the same time  *
+    * get different 'thread_index' values. Returns when all the chunks are     *
+    * processed.                                                               *
+    ***************************************************************************/
+    void parallel_for(size_t begin,
+                      size_t end,
+                      size_t threads,
+                      void (*p_body)(size_t chunk_begin,
+                                     size_t chunk_end,
+                                     size_t thread_index,
+                                     void* p_argument),
+                      void* p_argument);
+
+    /* Contains the unit tests. */
+    void parallel_test();
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif  /* PARALLEL_H */
@@ -0,0 +1,232 @@
+/***************************************************
+* Exposes syscall and ioctl under C89 on Linux.    *
+***************************************************/
+#define _GNU_SOURCE
+
+#include "my_assert.h"
+#include "perf_counters.h"
+#include <string.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#define FALSE 0
+#define TRUE 1
+
+static const char* EVENT_NAMES[] = {
+    "cycles", "instructions", "llc_misses", "branch_misses", "dtlb_misses"
+};
+
+#ifdef __linux__
+static int open_event(unsigned int type, unsigned long config)
+{
+    struct perf_event_attr attributes;
+
+    memset(&attributes, 0, sizeof(attributes));
+    attributes.type = type;
+    attributes.size = sizeof(attributes);
+    attributes.config = config;
+    attributes.disabled = 1;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+
+    return (int) syscall(__NR_perf_event_open, &attributes, 0, -1, -1, 0);
+}
+#endif
+
+int perf_counters_open(perf_counters* p_counters)
+{
+    int event;
+
+    if (!p_counters) return 0;
+
+    p_counters->opened = 0;
+
+    for (event = 0; event < PERF_COUNTERS_EVENTS; ++event)
+    {
+        p_counters->p_fd_array[event] = -1;
+    }
+
+#ifdef __linux__
+    p_counters->p_fd_array[PERF_COUNTERS_CYCLES] =
+        open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+
+    p_counters->p_fd_array[PERF_COUNTERS_INSTRUCTIONS] =
+        open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+
+    p_counters->p_fd_array[PERF_COUNTERS_LLC_MISSES] =
+        open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+
+    p_counters->p_fd_array[PERF_COUNTERS_BRANCH_MISSES] =
+        open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+
+    p_counters->p_fd_array[PERF_COUNTERS_DTLB_MISSES] =
+        open_event(PERF_TYPE_HW_CACHE,
+                   PERF_COUNT_HW_CACHE_DTLB
+                   | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                   | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+
+    for (event = 0; event < PERF_COUNTERS_EVENTS; ++event)
+    {
+        if (p_counters->p_fd_array[event] >= 0)
+        {
+            p_counters->opened++;
+        }
+    }
+#endif
+
+    return p_counters->opened;
+}
+
+void perf_counters_start(perf_counters* p_counters)
+{
+#ifdef __linux__
+    int event;
+
+    if (!p_counters) return;
+
+    for (event = 0; event < PERF_COUNTERS_EVENTS; ++event)
+    {
+        if (p_counters->p_fd_array[event] >= 0)
+        {
+            ioctl(p_counters->p_fd_array[event], PERF_EVENT_IOC_RESET, 0);
+            ioctl(p_counters->p_fd_array[event], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#endif
+}
+
+void perf_counters_stop(perf_counters* p_counters, perf_sample* p_sample)
+{
+    int event;
+
+    if (!p_counters || !p_sample) return;
+
+    perf_sample_clear(p_sample);
+
+#ifdef __linux__
+    for (event = 0; event < PERF_COUNTERS_EVENTS; ++event)
+    {
+        if (p_counters->p_fd_array[event] >= 0)
+        {
+            ioctl(p_counters->p_fd_array[event], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+
+    for (event = 0; event < PERF_COUNTERS_EVENTS; ++event)
+    {
+        if (p_counters->p_fd_array[event] >= 0
+            && read(p_counters->p_fd_array[event],
+                    &p_sample->p_count_array[event],
+                    sizeof(timing_ticks)) != (ssize_t) sizeof(timing_ticks))
+        {
+            p_sample->p_count_array[event] = 0;
+        }
+    }
+#else
+    (void) event;
+#endif
+}
+
+void perf_counters_close(perf_counters* p_counters)
+{
+    int event;
+
+    if (!p_counters) return;
+
+    for (event = 0; event < PERF_COUNTERS_EVENTS; ++event)
+    {
+#ifdef __linux__
+        if (p_counters->p_fd_array[event] >= 0)
+        {
+            close(p_counters->p_fd_array[event]);
+        }
+#endif
+        p_counters->p_fd_array[event] = -1;
+    }
+
+    p_counters->opened = 0;
+}
+
+int perf_counters_has_event(perf_counters* p_counters, int event)
+{
+    return p_counters
+        && event >= 0
+        && event < PERF_COUNTERS_EVENTS
+        && p_counters->p_fd_array[event] >= 0;
+}
+
+const char* perf_counters_event_name(int event)
+{
+    return event >= 0 && event < PERF_COUNTERS_EVENTS ?
+           EVENT_NAMES[event] :
+           "unknown";
+}
+
+void perf_sample_clear(perf_sample* p_sample)
+{
+    int event;
+
+    for (event = 0; event < PERF_COUNTERS_EVENTS; ++event)
+    {
+        p_sample->p_count_array[event] = 0;
+    }
+}
+
+void perf_sample_add(perf_sample* p_total, perf_sample* p_sample)
+{
+    int event;
+
+    for (event = 0; event < PERF_COUNTERS_EVENTS; ++event)
+    {
+        p_total->p_count_array[event] += p_sample->p_count_array[event];
+    }
+}
+
+void perf_counters_test()
+{
+    perf_counters counters;
+    perf_sample   sample;
+    perf_sample   total;
+    volatile int  sink = 0;
+    int           i;
+
+    puts("    perf_counters_test()");
+
+    perf_counters_open(&counters);
+    perf_sample_clear(&total);
+
+    perf_counters_start(&counters);
+
+    for (i = 0; i < 100000; ++i)
+    {
+        sink += i;
+    }
+
+    perf_counters_stop(&counters, &sample);
+    perf_sample_add(&total, &sample);
+    perf_sample_add(&total, &sample);
+
+    /* The counters may be unavailable here, so only check consistency. */
+    for (i = 0; i < PERF_COUNTERS_EVENTS; ++i)
+    {
+        ASSERT(total.p_count_array[i] == 2 * sample.p_count_array[i]);
+        ASSERT(perf_counters_has_event(&counters, i)
+               || sample.p_count_array[i] == 0);
+    }
+
+    if (perf_counters_has_event(&counters, PERF_COUNTERS_INSTRUCTIONS))
+    {
+        ASSERT(sample.p_count_array[PERF_COUNTERS_INSTRUCTIONS] > 100000);
+    }
+
+    ASSERT(strcmp(perf_counters_event_name(PERF_COUNTERS_DTLB_MISSES),
+                  "dtlb_misses") == 0);
+
+    perf_counters_close(&counters);
+    ASSERT(perf_counters_has_event(&counters, PERF_COUNTERS_CYCLES) == FALSE);
+}
@@ -0,0 +1,83 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include "timing.h"
+#include <stddef.h>
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * The hardware events counted. Not every event is available on every CPU   *
+    * or virtual machine; the missing ones read as zero.                       *
+    ***************************************************************************/
+#define PERF_COUNTERS_CYCLES        0
+#define PERF_COUNTERS_INSTRUCTIONS  1
+#define PERF_COUNTERS_LLC_MISSES    2
+#define PERF_COUNTERS_BRANCH_MISSES 3
+#define PERF_COUNTERS_DTLB_MISSES   4
+#define PERF_COUNTERS_EVENTS        5
+
+    /***************************************************************************
+    * Holds one file descriptor per event as returned by 'perf_event_open' on  *
+    * Linux, or -1 if the event could not be opened.                           *
+    ***************************************************************************/
+    typedef struct perf_counters {
+        int p_fd_array[PERF_COUNTERS_EVENTS];
+        int opened;
+    } perf_counters;
+
+    /***************************************************************************
+    * The counts of the events over one measured region.                       *
+    ***************************************************************************/
+    typedef struct perf_sample {
+        timing_ticks p_count_array[PERF_COUNTERS_EVENTS];
+    } perf_sample;
+
+    /***************************************************************************
+    * Opens the counters of the calling thread, user space only. Returns the   *
+    * number of events opened, which is zero on systems without                *
+    * 'perf_event_open' or if the kernel does not permit it.                   *
+    ***************************************************************************/
+    int perf_counters_open(perf_counters* p_counters);
+
+    /***************************************************************************
+    * Resets and enables the counters.                                         *
+    ***************************************************************************/
+    void perf_counters_start(perf_counters* p_counters);
+
+    /***************************************************************************
+    * Disables the counters and stores their values in 'p_sample'.             *
+    ***************************************************************************/
+    void perf_counters_stop(perf_counters* p_counters, perf_sample* p_sample);
+
+    /***************************************************************************
+    * Closes the counters.                                                     *
+    ***************************************************************************/
+    void perf_counters_close(perf_counters* p_counters);
+
+    /***************************************************************************
+    * Returns a positive value if the event was opened.                        *
+    ***************************************************************************/
+    int perf_counters_has_event(perf_counters* p_counters, int event);
+
+    /***************************************************************************
+    * Returns the name of an event.                                            *
+    ***************************************************************************/
+    const char* perf_counters_event_name(int event);
+
+    /***************************************************************************
+    * Zeroes a sample and adds one sample to another.                          *
+    ***************************************************************************/
+    void perf_sample_clear(perf_sample* p_sample);
+    void perf_sample_add(perf_sample* p_total, perf_sample* p_sample);
+
+    /* Contains the unit tests. */
+    void perf_counters_test();
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif  /* PERF_COUNTERS_H */
@@ -0,0 +1,205 @@
+#include "my_assert.h"
+#include "philox.h"
+#include <limits.h>
+
+#define FALSE 0
+#define TRUE 1
+
+#define PHILOX_MULTIPLIER 0xD256D193UL
+#define PHILOX_KEY_BUMP   0x9E3779B9UL
+#define PHILOX_ROUNDS     10
+#define WORD_MASK         0xFFFFFFFFUL
+
+/*******************************************************************************
+* Computes the 64-bit product of two 32-bit words as its high and low halves.  *
+* 'unsigned long' is only guaranteed to hold 32 bits, hence the split into     *
+* 16-bit digits where it is not wider.                                         *
+*******************************************************************************/
+static void multiply_high_low(unsigned long a,
+                              unsigned long b,
+                              unsigned long* p_high,
+                              unsigned long* p_low)
+{
+#if ULONG_MAX > WORD_MASK
+    unsigned long product = a * b;
+
+    *p_high = product >> 32;
+    *p_low  = product & WORD_MASK;
+#else
+    unsigned long a0 = a & 0xFFFFUL;
+    unsigned long a1 = a >> 16;
+    unsigned long b0 = b & 0xFFFFUL;
+    unsigned long b1 = b >> 16;
+    unsigned long p00 = a0 * b0;
+    unsigned long p01 = a0 * b1;
+    unsigned long p10 = a1 * b0;
+    unsigned long middle = (p00 >> 16) + (p01 & 0xFFFFUL) + (p10 & 0xFFFFUL);
+
+    *p_high = (a1 * b1 + (p01 >> 16) + (p10 >> 16) + (middle >> 16))
+              & WORD_MASK;
+    *p_low  = ((middle << 16) | (p00 & 0xFFFFUL)) & WORD_MASK;
+#endif
+}
+
+void philox_2x32(unsigned long key,
+                 unsigned long* p_counter_array,
+                 unsigned long* p_output_array)
+{
+    unsigned long left  = p_counter_array[0] & WORD_MASK;
+    unsigned long right = p_counter_array[1] & WORD_MASK;
+    unsigned long high;
+    unsigned long low;
+    int           round;
+
+    key &= WORD_MASK;
+
+    for (round = 0; round < PHILOX_ROUNDS; ++round)
+    {
+        multiply_high_low(PHILOX_MULTIPLIER, left, &high, &low);
+        left  = high ^ key ^ right;
+        right = low;
+        key   = (key + PHILOX_KEY_BUMP) & WORD_MASK;
+    }
+
+    p_output_array[0] = left;
+    p_output_array[1] = right;
+}
+
+void philox_init(philox* p_philox, unsigned long seed, size_t stream)
+{
+    /* Streams beyond 32 bits are told apart by the key. */
+    p_philox->key       = (seed ^ (unsigned long)(stream >> 16 >> 16)
+                                  * PHILOX_KEY_BUMP) & WORD_MASK;
+    p_philox->stream    = (unsigned long) stream & WORD_MASK;
+    p_philox->counter   = 0;
+    p_philox->available = 0;
+}
+
+unsigned long philox_next(philox* p_philox)
+{
+    unsigned long p_counter_array[2];
+
+    if (p_philox->available == 0)
+    {
+        p_counter_array[0] = p_philox->counter;
+        p_counter_array[1] = p_philox->stream;
+        philox_2x32(p_philox->key, p_counter_array, p_philox->p_output_array);
+        p_philox->counter = (p_philox->counter + 1) & WORD_MASK;
+        p_philox->available = 2;
+    }
+
+    return p_philox->p_output_array[2 - p_philox->available--];
+}
+
+double philox_uniform(philox* p_philox)
+{
+    /* 53 random bits fill the mantissa of a double. */
+    unsigned long high = philox_next(p_philox) >> 6;
+    unsigned long low  = philox_next(p_philox) >> 5;
+
+    return ((double) high * 134217728.0 + (double) low)
+           / 9007199254740992.0;
+}
+
+size_t philox_below(philox* p_philox, size_t bound)
+{
+    unsigned long high;
+    unsigned long low;
+    size_t        value;
+
+    if (bound - 1 <= WORD_MASK)
+    {
+        /* The high word of 'next * bound' is uniform enough over [0, bound)
+           and avoids the division. */
+        multiply_high_low(philox_next(p_philox),
+                          (unsigned long) bound,
+                          &high,
+                          &low);
+        return (size_t) high;
+    }
+
+    value = (size_t) philox_next(p_philox) << 16 << 16;
+    value |= (size_t) philox_next(p_philox);
+    return value % bound;
+}
+
+static void philox_test_known_answers()
+{
+    unsigned long p_counter_array[2];
+    unsigned long p_output_array[2];
+
+    puts("        philox_test_known_answers()");
+
+    /* The known answers of the Random123 reference implementation. */
+    p_counter_array[0] = 0;
+    p_counter_array[1] = 0;
+    philox_2x32(0, p_counter_array, p_output_array);
+    ASSERT(p_output_array[0] == 0xff1dae59UL);
+    ASSERT(p_output_array[1] == 0x6cd10df2UL);
+
+    p_counter_array[0] = 0xffffffffUL;
+    p_counter_array[1] = 0xffffffffUL;
+    philox_2x32(0xffffffffUL, p_counter_array, p_output_array);
+    ASSERT(p_output_array[0] == 0x2c3f628bUL);
+    ASSERT(p_output_array[1] == 0xab4fd7adUL);
+
+    p_counter_array[0] = 0x243f6a88UL;
+    p_counter_array[1] = 0x85a308d3UL;
+    philox_2x32(0x13198a2eUL, p_counter_array, p_output_array);
+    ASSERT(p_output_array[0] == 0xdd7ce038UL);
+    ASSERT(p_output_array[1] == 0xf62a4c12UL);
+}
+
+static void philox_test_streams()
+{
+    philox        a;
+    philox        b;
+    unsigned long p_first_array[5];
+    size_t        i;
+    int           differs = FALSE;
+    double        u;
+
+    puts("        philox_test_streams()");
+
+    philox_init(&a, 42, 7);
+
+    for (i = 0; i < 5; ++i)
+    {
+        p_first_array[i] = philox_next(&a);
+    }
+
+    /* Replaying a stream gives the same numbers. */
+    philox_init(&a, 42, 7);
+
+    for (i = 0; i < 5; ++i)
+    {
+        ASSERT(philox_next(&a) == p_first_array[i]);
+    }
+
+    philox_init(&b, 42, 8);
+
+    for (i = 0; i < 5; ++i)
+    {
+        if (philox_next(&b) != p_first_array[i])
+        {
+            differs = TRUE;
+        }
+    }
+
+    ASSERT(differs);
+
+    for (i = 0; i < 1000; ++i)
+    {
+        u = philox_uniform(&a);
+        ASSERT(u >= 0.0 && u < 1.0);
+        ASSERT(philox_below(&a, 10) < 10);
+        ASSERT(philox_below(&a, 1) == 0);
+    }
+}
+
+void philox_test()
+{
+    puts("    philox_test()");
+    philox_test_known_answers();
+    philox_test_streams();
+}
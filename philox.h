@@ -0,0 +1,60 @@
+#ifndef PHILOX_H
+#define PHILOX_H
+
+#include <stddef.h>
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * A Philox-2x32-10 counter-based random number generator. Each output is   *
+    * a pure function of the key, the stream and the position in the stream,   *
+    * so separate streams can be drawn from any thread in any order and the    *
+    * results are the same on every platform.                                  *
+    ***************************************************************************/
+    typedef struct philox {
+        unsigned long key;
+        unsigned long stream;
+        unsigned long counter;
+        unsigned long p_output_array[2];
+        int           available;
+    } philox;
+
+    /***************************************************************************
+    * Runs the ten Philox rounds over the counter ('p_counter_array[0]',       *
+    * 'p_counter_array[1]') with the key and stores the two 32-bit words in    *
+    * 'p_output_array'.                                                        *
+    ***************************************************************************/
+    void philox_2x32(unsigned long key,
+                     unsigned long* p_counter_array,
+                     unsigned long* p_output_array);
+
+    /***************************************************************************
+    * Positions the generator at the start of the stream 'stream' of the seed. *
+    ***************************************************************************/
+    void philox_init(philox* p_philox, unsigned long seed, size_t stream);
+
+    /***************************************************************************
+    * Returns the next 32 random bits.                                         *
+    ***************************************************************************/
+    unsigned long philox_next(philox* p_philox);
+
+    /***************************************************************************
+    * Returns a random number uniformly distributed in [0, 1).                 *
+    ***************************************************************************/
+    double philox_uniform(philox* p_philox);
+
+    /***************************************************************************
+    * Returns a random number in [0, bound). 'bound' must be positive.         *
+    ***************************************************************************/
+    size_t philox_below(philox* p_philox, size_t bound);
+
+    /* Contains the unit tests. */
+    void philox_test();
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif  /* PHILOX_H */
@@ -0,0 +1,596 @@
+#include "query_engine.h"
+#include "bidirectional_breadth_first_search.h"
+#include "breadth_first_search.h"
+#include "compressed_graph.h"
+#include "graph_generator.h"
+#include "my_assert.h"
+#include "philox.h"
+#include <stdlib.h>
+
+#define FALSE 0
+#define TRUE 1
+
+static void run_query(query_engine_worker* p_worker,
+                      query_engine_query* p_query)
+{
+    if (p_worker->p_engine->bidirectional)
+    {
+        bidirectional_breadth_first_search_balanced_in_context(
+            p_query->p_source,
+            p_query->p_target,
+            &p_worker->child_iterator,
+            &p_worker->parent_iterator,
+            NULL,
+            NULL,
+            &p_worker->context,
+            NULL,
+            &p_worker->path);
+    }
+    else
+    {
+        breadth_first_search_in_context(p_query->p_source,
+                                        p_query->p_target,
+                                        &p_worker->child_iterator,
+                                        &p_worker->context,
+                                        NULL,
+                                        &p_worker->path);
+    }
+
+    p_query->p_path = p_worker->path.nodes > 0 ?
+                      search_path_to_list(&p_worker->path) : NULL;
+}
+
+/*******************************************************************************
+* Takes the batch at the head of the queue and claims its queries until none   *
+* is left. The first worker to run out of queries unlinks the batch, so no     *
+* new worker picks it up, and the last one to let go of it wakes the awaiting  *
+* threads.                                                                     *
+*******************************************************************************/
+static void worker_main(void* p_argument)
+{
+    query_engine_worker* p_worker = p_argument;
+    query_engine*        p_engine = p_worker->p_engine;
+    query_engine_batch*  p_batch;
+    size_t               claimed;
+    size_t               i;
+
+    parallel_mutex_lock(&p_engine->mutex);
+
+    for (;;)
+    {
+        while (!p_engine->p_head && !p_engine->stopping)
+        {
+            parallel_condition_wait(&p_engine->work_ready, &p_engine->mutex);
+        }
+
+        if (!p_engine->p_head) break;
+
+        p_batch = p_engine->p_head;
+        p_batch->holders++;
+        parallel_mutex_unlock(&p_engine->mutex);
+
+        claimed = 0;
+
+        while ((i = PARALLEL_FETCH_ADD(&p_batch->next, 1)) <
+               p_batch->queries)
+        {
+            run_query(p_worker, &p_batch->p_query_array[i]);
+            claimed++;
+        }
+
+        parallel_mutex_lock(&p_engine->mutex);
+
+        if (p_engine->p_head == p_batch)
+        {
+            p_engine->p_head = p_batch->p_next;
+
+            if (!p_engine->p_head) p_engine->p_tail = NULL;
+        }
+
+        p_batch->finished += claimed;
+        p_batch->holders--;
+
+        if (p_batch->finished == p_batch->queries && p_batch->holders == 0)
+        {
+            parallel_condition_broadcast(&p_engine->batch_done);
+        }
+    }
+
+    parallel_mutex_unlock(&p_engine->mutex);
+}
+
+query_engine* query_engine_alloc(
+    size_t threads,
+    child_node_iterator* p_child_iterator,
+    parent_node_iterator* p_parent_iterator,
+    void (*p_setup)(child_node_iterator* p_child_iterator,
+                    parent_node_iterator* p_parent_iterator,
+                    size_t worker,
+                    void* p_argument),
+    void* p_setup_argument,
+    size_t (*p_hash_function)(void*),
+    int (*p_equals_function)(void*, void*))
+{
+    query_engine*        p_engine;
+    query_engine_worker* p_worker;
+    size_t               i;
+
+    if (!p_child_iterator || !p_hash_function || !p_equals_function)
+    {
+        return NULL;
+    }
+
+    if (threads == 0) threads = parallel_hardware_concurrency();
+
+    p_engine = malloc(sizeof(*p_engine));
+
+    if (!p_engine) return NULL;
+
+    p_engine->p_worker_array = malloc(sizeof(query_engine_worker) * threads);
+
+    if (!p_engine->p_worker_array)
+    {
+        free(p_engine);
+        return NULL;
+    }
+
+    p_engine->workers           = 0;
+    p_engine->bidirectional     = p_parent_iterator != NULL;
+    p_engine->p_hash_function   = p_hash_function;
+    p_engine->p_equals_function = p_equals_function;
+    p_engine->p_head            = NULL;
+    p_engine->p_tail            = NULL;
+    p_engine->stopping          = FALSE;
+    parallel_mutex_init(&p_engine->mutex);
+    parallel_condition_init(&p_engine->work_ready);
+    parallel_condition_init(&p_engine->batch_done);
+
+    for (i = 0; i < threads; ++i)
+    {
+        p_worker                 = &p_engine->p_worker_array[i];
+        p_worker->p_engine       = p_engine;
+        p_worker->index          = i;
+        p_worker->child_iterator = *p_child_iterator;
+
+        if (p_parent_iterator)
+        {
+            p_worker->parent_iterator = *p_parent_iterator;
+        }
+
+        if (p_setup)
+        {
+            p_setup(&p_worker->child_iterator,
+                    p_parent_iterator ? &p_worker->parent_iterator : NULL,
+                    i,
+                    p_setup_argument);
+        }
+    }
+
+    for (i = 0; i < threads; ++i)
+    {
+        p_worker = &p_engine->p_worker_array[i];
+        search_path_init(&p_worker->path);
+
+        if (!search_context_init(&p_worker->context,
+                                 p_hash_function,
+                                 p_equals_function))
+        {
+            query_engine_free(p_engine);
+            return NULL;
+        }
+
+        if (!parallel_thread_create(&p_worker->thread, worker_main, p_worker))
+        {
+            search_context_destroy(&p_worker->context);
+            query_engine_free(p_engine);
+            return NULL;
+        }
+
+        p_engine->workers++;
+    }
+
+    return p_engine;
+}
+
+query_engine_batch* query_engine_submit(query_engine* p_engine,
+                                        query_engine_query* p_query_array,
+                                        size_t queries)
+{
+    query_engine_batch* p_batch = malloc(sizeof(*p_batch));
+    size_t              i;
+
+    if (!p_batch) return NULL;
+
+    for (i = 0; i < queries; ++i)
+    {
+        p_query_array[i].p_path = NULL;
+    }
+
+    p_batch->p_query_array = p_query_array;
+    p_batch->queries       = queries;
+    p_batch->next          = 0;
+    p_batch->finished      = 0;
+    p_batch->holders       = 0;
+    p_batch->p_next        = NULL;
+
+    if (queries == 0) return p_batch;
+
+    parallel_mutex_lock(&p_engine->mutex);
+
+    if (p_engine->p_tail)
+    {
+        p_engine->p_tail->p_next = p_batch;
+    }
+    else
+    {
+        p_engine->p_head = p_batch;
+    }
+
+    p_engine->p_tail = p_batch;
+    parallel_condition_broadcast(&p_engine->work_ready);
+    parallel_mutex_unlock(&p_engine->mutex);
+    return p_batch;
+}
+
+void query_engine_await(query_engine* p_engine, query_engine_batch* p_batch)
+{
+    if (!p_batch) return;
+
+    parallel_mutex_lock(&p_engine->mutex);
+
+    while (p_batch->finished < p_batch->queries || p_batch->holders > 0)
+    {
+        parallel_condition_wait(&p_engine->batch_done, &p_engine->mutex);
+    }
+
+    parallel_mutex_unlock(&p_engine->mutex);
+    free(p_batch);
+}
+
+int query_engine_run(query_engine* p_engine,
+                     query_engine_query* p_query_array,
+                     size_t queries)
+{
+    query_engine_batch* p_batch = query_engine_submit(p_engine,
+                                                      p_query_array,
+                                                      queries);
+
+    if (!p_batch) return FALSE;
+
+    query_engine_await(p_engine, p_batch);
+    return TRUE;
+}
+
+void query_engine_free(query_engine* p_engine)
+{
+    size_t i;
+
+    if (!p_engine) return;
+
+    parallel_mutex_lock(&p_engine->mutex);
+    p_engine->stopping = TRUE;
+    parallel_condition_broadcast(&p_engine->work_ready);
+    parallel_mutex_unlock(&p_engine->mutex);
+
+    for (i = 0; i < p_engine->workers; ++i)
+    {
+        parallel_thread_join(p_engine->p_worker_array[i].thread);
+        search_context_destroy(&p_engine->p_worker_array[i].context);
+        search_path_destroy(&p_engine->p_worker_array[i].path);
+    }
+
+    parallel_condition_destroy(&p_engine->work_ready);
+    parallel_condition_destroy(&p_engine->batch_done);
+    parallel_mutex_destroy(&p_engine->mutex);
+    free(p_engine->p_worker_array);
+    free(p_engine);
+}
+
+typedef struct test_cursors {
+    compressed_graph*        p_graph;
+    compressed_graph_cursor* p_child_cursor_array;
+    compressed_graph_cursor* p_parent_cursor_array;
+} test_cursors;
+
+/*******************************************************************************
+* Gives each worker cursors of its own over the compressed graph.              *
+*******************************************************************************/
+static void setup_cursors(child_node_iterator* p_child_iterator,
+                          parent_node_iterator* p_parent_iterator,
+                          size_t worker,
+                          void* p_argument)
+{
+    test_cursors* p_cursors = p_argument;
+
+    compressed_graph_children_iterator(
+        p_child_iterator,
+        &p_cursors->p_child_cursor_array[worker],
+        p_cursors->p_graph);
+
+    if (p_parent_iterator)
+    {
+        compressed_graph_parents_iterator(
+            p_parent_iterator,
+            &p_cursors->p_parent_cursor_array[worker],
+            p_cursors->p_graph);
+    }
+}
+
+static size_t grid_distance(size_t a, size_t b, size_t width)
+{
+    size_t ax = a % width;
+    size_t ay = a / width;
+    size_t bx = b % width;
+    size_t by = b / width;
+
+    return (ax > bx ? ax - bx : bx - ax) + (ay > by ? ay - by : by - ay);
+}
+
+/*******************************************************************************
+* Checks that every query of the array got a shortest path of the grid.        *
+*******************************************************************************/
+static int paths_are_shortest(query_engine_query* p_query_array,
+                              size_t queries,
+                              size_t width)
+{
+    size_t source;
+    size_t target;
+    size_t i;
+    int    ok = TRUE;
+
+    for (i = 0; i < queries; ++i)
+    {
+        source = compressed_graph_index(p_query_array[i].p_source);
+        target = compressed_graph_index(p_query_array[i].p_target);
+
+        if (!p_query_array[i].p_path ||
+            list_size(p_query_array[i].p_path) !=
+            grid_distance(source, target, width) + 1 ||
+            list_get(p_query_array[i].p_path, 0) !=
+            p_query_array[i].p_source)
+        {
+            ok = FALSE;
+        }
+
+        list_free(p_query_array[i].p_path);
+        p_query_array[i].p_path = NULL;
+    }
+
+    return ok;
+}
+
+static void query_engine_test_batches()
+{
+    const size_t            width = 30;
+    const size_t            queries = 300;
+    const size_t            threads = 4;
+    compact_graph*          p_graph;
+    compressed_graph*       p_compressed;
+    query_engine*           p_engine;
+    query_engine_query*     p_first_array;
+    query_engine_query*     p_second_array;
+    query_engine_batch*     p_first;
+    query_engine_batch*     p_second;
+    query_engine_batch*     p_empty;
+    child_node_iterator     child_iterator;
+    parent_node_iterator    parent_iterator;
+    compressed_graph_cursor p_child_cursor_array[4];
+    compressed_graph_cursor p_parent_cursor_array[4];
+    compressed_graph_cursor prototype_cursor;
+    test_cursors            cursors;
+    philox                  random;
+    size_t                  run;
+    size_t                  i;
+
+    puts("        query_engine_test_batches()");
+
+    p_graph      = graph_generator_grid(width, width, 1, 1);
+    p_compressed = compressed_graph_alloc(p_graph, 1);
+    cursors.p_graph               = p_compressed;
+    cursors.p_child_cursor_array  = p_child_cursor_array;
+    cursors.p_parent_cursor_array = p_parent_cursor_array;
+
+    p_first_array  = malloc(sizeof(query_engine_query) * queries);
+    p_second_array = malloc(sizeof(query_engine_query) * queries);
+    philox_init(&random, 23, 0);
+
+    for (i = 0; i < queries; ++i)
+    {
+        p_first_array[i].p_source  = compressed_graph_node(
+                                         philox_below(&random, width * width));
+        p_first_array[i].p_target  = compressed_graph_node(
+                                         philox_below(&random, width * width));
+        p_second_array[i].p_source = p_first_array[i].p_target;
+        p_second_array[i].p_target = p_first_array[i].p_source;
+    }
+
+    compressed_graph_children_iterator(&child_iterator,
+                                       &prototype_cursor,
+                                       p_compressed);
+    compressed_graph_parents_iterator(&parent_iterator,
+                                      &prototype_cursor,
+                                      p_compressed);
+
+    /* Plain searches first, then bidirectional ones. */
+    for (run = 0; run < 2; ++run)
+    {
+        p_engine = query_engine_alloc(threads,
+                                      &child_iterator,
+                                      run == 0 ? NULL : &parent_iterator,
+                                      setup_cursors,
+                                      &cursors,
+                                      compressed_graph_node_hash_function,
+                                      compressed_graph_nodes_equal_function);
+        ASSERT(p_engine != NULL);
+        ASSERT(p_engine->workers == threads);
+        ASSERT(p_engine->bidirectional == (run == 1));
+
+        /* Two batches in flight at once, and an empty one. */
+        p_first  = query_engine_submit(p_engine, p_first_array, queries);
+        p_second = query_engine_submit(p_engine, p_second_array, queries);
+        p_empty  = query_engine_submit(p_engine, p_second_array, 0);
+        query_engine_await(p_engine, p_empty);
+        query_engine_await(p_engine, p_second);
+        query_engine_await(p_engine, p_first);
+        ASSERT(paths_are_shortest(p_first_array, queries, width));
+        ASSERT(paths_are_shortest(p_second_array, queries, width));
+
+        ASSERT(query_engine_run(p_engine, p_first_array, queries));
+        ASSERT(paths_are_shortest(p_first_array, queries, width));
+        query_engine_free(p_engine);
+    }
+
+    free(p_first_array);
+    free(p_second_array);
+    compressed_graph_free(p_compressed);
+    compact_graph_free(p_graph);
+}
+
+/*******************************************************************************
+* Checks that every query of the array got a path of the hop count in          *
+* 'p_hops_array' from its source to its target, or none if it is unreachable.  *
+*******************************************************************************/
+static int paths_match(query_engine_query* p_query_array,
+                       size_t* p_hops_array,
+                       size_t queries)
+{
+    list*  p_path;
+    size_t i;
+    int    ok = TRUE;
+
+    for (i = 0; i < queries; ++i)
+    {
+        p_path = p_query_array[i].p_path;
+
+        if (p_hops_array[i] == SEARCH_PATH_UNREACHABLE)
+        {
+            if (p_path) ok = FALSE;
+
+            continue;
+        }
+
+        if (!p_path
+            || list_size(p_path) != p_hops_array[i] + 1
+            || list_get(p_path, 0) != p_query_array[i].p_source
+            || list_get(p_path, p_hops_array[i]) != p_query_array[i].p_target)
+        {
+            ok = FALSE;
+        }
+
+        list_free(p_path);
+        p_query_array[i].p_path = NULL;
+    }
+
+    return ok;
+}
+
+/*******************************************************************************
+* Answers random queries on an R-MAT graph, whose hubs and unreachable pairs   *
+* the grid lacks, and compares the path lengths with plain breadth-first       *
+* search.                                                                      *
+*******************************************************************************/
+static void query_engine_test_rmat()
+{
+    const size_t            nodes = 2000;
+    const size_t            queries = 400;
+    const size_t            threads = 3;
+    compact_graph*          p_graph;
+    compressed_graph*       p_compressed;
+    query_engine*           p_engine;
+    query_engine_query*     p_query_array;
+    size_t*                 p_hops_array;
+    child_node_iterator     child_iterator;
+    parent_node_iterator    parent_iterator;
+    compressed_graph_cursor p_child_cursor_array[3];
+    compressed_graph_cursor p_parent_cursor_array[3];
+    compressed_graph_cursor prototype_cursor;
+    test_cursors            cursors;
+    search_path             path;
+    philox                  random;
+    size_t                  unreachable = 0;
+    size_t                  batch;
+    size_t                  run;
+    size_t                  i;
+
+    puts("        query_engine_test_rmat()");
+
+    p_graph      = graph_generator_rmat(nodes, 3 * nodes, 0.57, 0.19, 0.19,
+                                        29, 1);
+    p_compressed = compressed_graph_alloc(p_graph, 1);
+    cursors.p_graph               = p_compressed;
+    cursors.p_child_cursor_array  = p_child_cursor_array;
+    cursors.p_parent_cursor_array = p_parent_cursor_array;
+
+    p_query_array = malloc(sizeof(query_engine_query) * queries);
+    p_hops_array  = malloc(sizeof(size_t) * queries);
+    ASSERT(p_query_array != NULL && p_hops_array != NULL);
+
+    compressed_graph_children_iterator(&child_iterator,
+                                       &prototype_cursor,
+                                       p_compressed);
+    compressed_graph_parents_iterator(&parent_iterator,
+                                      &prototype_cursor,
+                                      p_compressed);
+    philox_init(&random, 31, 0);
+    search_path_init(&path);
+
+    for (i = 0; i < queries; ++i)
+    {
+        p_query_array[i].p_source = compressed_graph_node(
+                                        philox_below(&random, nodes));
+        p_query_array[i].p_target = compressed_graph_node(
+                                        philox_below(&random, nodes));
+        p_hops_array[i] = breadth_first_search_path(
+                              p_query_array[i].p_source,
+                              p_query_array[i].p_target,
+                              &child_iterator,
+                              compressed_graph_node_hash_function,
+                              compressed_graph_nodes_equal_function,
+                              &path);
+
+        if (p_hops_array[i] == SEARCH_PATH_UNREACHABLE) unreachable++;
+    }
+
+    /* Both kinds of answers are exercised. */
+    ASSERT(unreachable > 0 && unreachable < queries);
+
+    for (run = 0; run < 2; ++run)
+    {
+        p_engine = query_engine_alloc(threads,
+                                      &child_iterator,
+                                      run == 0 ? NULL : &parent_iterator,
+                                      setup_cursors,
+                                      &cursors,
+                                      compressed_graph_node_hash_function,
+                                      compressed_graph_nodes_equal_function);
+        ASSERT(p_engine != NULL);
+
+        /* The second batch reuses the contexts the first one emptied. */
+        for (batch = 0; batch < 2; ++batch)
+        {
+            ASSERT(query_engine_run(p_engine, p_query_array, queries));
+            ASSERT(paths_match(p_query_array, p_hops_array, queries));
+        }
+
+        for (i = 0; i < threads; ++i)
+        {
+            ASSERT(unordered_map_size(
+                       p_engine->p_worker_array[i].context.p_forward_map) == 0);
+        }
+
+        query_engine_free(p_engine);
+    }
+
+    search_path_destroy(&path);
+    free(p_query_array);
+    free(p_hops_array);
+    compressed_graph_free(p_compressed);
+    compact_graph_free(p_graph);
+}
+
+void query_engine_test()
+{
+    puts("    query_engine_test()");
+    query_engine_test_batches();
+    query_engine_test_rmat();
+}
@@ -0,0 +1,132 @@
+#ifndef QUERY_ENGINE_H
+#define QUERY_ENGINE_H
+
+#include "list.h"
+#include "parallel.h"
+#include "search_path.h"
+#include "utils.h"
+#include <stddef.h>
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * A point-to-point query. 'p_path' receives the shortest path from         *
+    * 'p_source' to 'p_target', or NULL if there is none; the caller frees it. *
+    ***************************************************************************/
+    typedef struct query_engine_query {
+        void* p_source;
+        void* p_target;
+        list* p_path;
+    } query_engine_query;
+
+    /***************************************************************************
+    * A submitted batch. The workers claim its queries one at a time, so long  *
+    * and short searches balance across the pool.                              *
+    ***************************************************************************/
+    typedef struct query_engine_batch {
+        query_engine_query*        p_query_array;
+        size_t                     queries;
+        size_t                     next;
+        size_t                     finished;
+        size_t                     holders;
+        struct query_engine_batch* p_next;
+    } query_engine_batch;
+
+    /***************************************************************************
+    * The private state of one worker thread. The queues and parent maps in    *
+    * 'context' and the array of 'path' are allocated once and reused by each  *
+    * query the worker runs.                                                   *
+    ***************************************************************************/
+    typedef struct query_engine_worker {
+        struct query_engine* p_engine;
+        child_node_iterator  child_iterator;
+        parent_node_iterator parent_iterator;
+        search_context       context;
+        search_path          path;
+        size_t               index;
+        parallel_thread      thread;
+    } query_engine_worker;
+
+    /***************************************************************************
+    * A fixed pool of threads answering shortest path queries over a graph     *
+    * that nobody modifies meanwhile. The searches mutate the iterator state   *
+    * in place, so every worker holds its own copies of the iterators. The     *
+    * batches wait in a FIFO queue guarded by 'mutex'.                         *
+    ***************************************************************************/
+    typedef struct query_engine {
+        query_engine_worker* p_worker_array;
+        size_t               workers;
+        int                  bidirectional;
+        size_t (*p_hash_function)(void*);
+        int    (*p_equals_function)(void*, void*);
+        parallel_mutex       mutex;
+        parallel_condition   work_ready;
+        parallel_condition   batch_done;
+        query_engine_batch*  p_head;
+        query_engine_batch*  p_tail;
+        int                  stopping;
+    } query_engine;
+
+    /***************************************************************************
+    * Starts 'threads' workers, or as many as the hardware concurrency if it   *
+    * is zero. Each worker gets copies of '*p_child_iterator' and, unless it   *
+    * is NULL, of '*p_parent_iterator'; then 'p_setup', if not NULL, is called *
+    * with the copies and the worker index so that iterators keeping their     *
+    * state in a cursor can be given one cursor per worker. The queries run    *
+    * the level-balanced bidirectional breadth-first search, comparing the     *
+    * frontier sizes, if there is a parent iterator and plain breadth-first    *
+    * search otherwise. Returns NULL if the memory ran out or a thread could   *
+    * not be started.                                                          *
+    ***************************************************************************/
+    query_engine* query_engine_alloc(
+        size_t threads,
+        child_node_iterator* p_child_iterator,
+        parent_node_iterator* p_parent_iterator,
+        void (*p_setup)(child_node_iterator* p_child_iterator,
+                        parent_node_iterator* p_parent_iterator,
+                        size_t worker,
+                        void* p_argument),
+        void* p_setup_argument,
+        size_t (*p_hash_function)(void*),
+        int (*p_equals_function)(void*, void*));
+
+    /***************************************************************************
+    * Queues the 'queries' queries in 'p_query_array' and returns at once. The *
+    * array must stay alive until the batch is awaited. Returns NULL if the    *
+    * memory ran out.                                                          *
+    ***************************************************************************/
+    query_engine_batch* query_engine_submit(query_engine* p_engine,
+                                            query_engine_query* p_query_array,
+                                            size_t queries);
+
+    /***************************************************************************
+    * Waits until every query of the batch has its path and releases the       *
+    * batch.                                                                   *
+    ***************************************************************************/
+    void query_engine_await(query_engine* p_engine,
+                            query_engine_batch* p_batch);
+
+    /***************************************************************************
+    * Runs the queries on the pool and waits for them. Returns false if the    *
+    * memory ran out.                                                          *
+    ***************************************************************************/
+    int query_engine_run(query_engine* p_engine,
+                         query_engine_query* p_query_array,
+                         size_t queries);
+
+    /***************************************************************************
+    * Finishes the queued batches, stops the workers and deallocates the       *
+    * engine.                                                                  *
+    ***************************************************************************/
+    void query_engine_free(query_engine* p_engine);
+
+    /* Contains the unit tests. */
+    void query_engine_test();
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif  /* QUERY_ENGINE_H */
@@ -1,3 +1,4 @@
+#include "allocation.h"
 #include "my_assert.h"
 #include "queue.h"
 #include <stddef.h>
@@ -16,18 +17,18 @@ typedef struct queue_state {
 
 queue* queue_alloc()
 {
-    queue* q = malloc(sizeof(*q));
+    queue* q = allocation_alloc(ALLOCATION_QUEUE, sizeof(*q));
 
     if (!q)
     {
         return NULL;
     }
 
-    q->state = malloc(sizeof(queue_state));
+    q->state = allocation_alloc(ALLOCATION_QUEUE, sizeof(queue_state));
 
     if (!q->state)
     {
-        free(q);
+        allocation_free(ALLOCATION_QUEUE, q, sizeof(*q));
         return NULL;
     }
 
@@ -46,7 +47,13 @@ void queue_push_back(queue* q, void* element)
         return;
     }
 
-    new_queue_node = malloc(sizeof(queue_node));
+    new_queue_node = allocation_alloc(ALLOCATION_QUEUE, sizeof(queue_node));
+
+    if (!new_queue_node)
+    {
+        return;
+    }
+
     new_queue_node->element = element;
     new_queue_node->next = NULL;
 
@@ -93,7 +100,7 @@ void* queue_pop_front(queue* q)
     }
 
     q->state->size--;
-    free(front_node);
+    allocation_free(ALLOCATION_QUEUE, front_node, sizeof(queue_node));
     return element;
 }
 
@@ -112,25 +119,43 @@ size_t queue_size(queue* q)
     return q->state->size;
 }
 
-void queue_free(queue* q)
+void queue_clear(queue* q)
 {
     queue_node* q_node;
     queue_node* q_node_next;
 
-    if (!q || !q->state || !q->state->front) return;
+    if (!q || !q->state) return;
 
     q_node = q->state->front;
-    q_node_next = q_node->next;
 
     while (q_node)
     {
         q_node_next = q_node->next;
-        free(q_node);
+        allocation_free(ALLOCATION_QUEUE, q_node, sizeof(queue_node));
         q_node = q_node_next;
     }
 
-    free(q->state);
-    free(q);
+    q->state->front = NULL;
+    q->state->back  = NULL;
+    q->state->size  = 0;
+}
+
+void queue_free(queue* q)
+{
+    if (!q || !q->state) return;
+
+    queue_clear(q);
+    allocation_free(ALLOCATION_QUEUE, q->state, sizeof(queue_state));
+    allocation_free(ALLOCATION_QUEUE, q, sizeof(*q));
+}
+
+size_t queue_memory_usage(queue* q)
+{
+    if (!q || !q->state) return 0;
+
+    return sizeof(*q)
+         + sizeof(queue_state)
+         + sizeof(queue_node) * q->state->size;
 }
 
 void queue_test()
@@ -177,4 +202,17 @@ void queue_test()
     num = (intptr_t) queue_pop_front(q);
     ASSERT(num == 11);
     ASSERT(queue_size(q) == 0);
+
+    for (i = 0; i < 10; i++) {
+        queue_push_back(q, (void*)(intptr_t) i);
+    }
+
+    queue_clear(q);
+    ASSERT(queue_size(q) == 0);
+    ASSERT(queue_pop_front(q) == NULL);
+    ASSERT(queue_memory_usage(q) == sizeof(*q) + sizeof(queue_state));
+    queue_push_back(q, (void*) 12);
+    ASSERT(queue_front(q) == (void*) 12);
+    ASSERT(queue_size(q) == 1);
+    queue_free(q);
 }
\ No newline at end of file
@@ -35,11 +35,21 @@ extern "C" {
     *******************************************************************************/
     size_t queue_size(queue*);
 
+    /*******************************************************************************
+    * Removes all the elements from the queue, keeping the queue itself.           *
+    *******************************************************************************/
+    void   queue_clear(queue*);
+
     /*******************************************************************************
     * Remove all the contents of the queue.                                        *
     *******************************************************************************/
     void   queue_free(queue*);
 
+    /*******************************************************************************
+    * Returns the number of bytes allocated by the queue.                          *
+    *******************************************************************************/
+    size_t queue_memory_usage(queue*);
+
     /* Contains unit tests. */
     void   queue_test();
 
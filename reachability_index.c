@@ -0,0 +1,1124 @@
+#include "bidirectional_breadth_first_search.h"
+#include "breadth_first_search.h"
+#include "list.h"
+#include "my_assert.h"
+#include "reachability_index.h"
+#include "unordered_set.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+#define FALSE 0
+#define TRUE 1
+
+static const size_t DEFAULT_LABELS = 3;
+
+static size_t component_hash_function(void* p_key)
+{
+    return (size_t) p_key;
+}
+
+static int component_equals_function(void* p_a, void* p_b)
+{
+    return p_a == p_b;
+}
+
+static size_t size_t_min(size_t a, size_t b)
+{
+    return a < b ? a : b;
+}
+
+static size_t size_t_max(size_t a, size_t b)
+{
+    return a > b ? a : b;
+}
+
+/*******************************************************************************
+* A tiny linear congruential generator; the traversal orders only need to be   *
+* different, not of high statistical quality.                                 *
+*******************************************************************************/
+static size_t next_random(unsigned long* p_state)
+{
+    *p_state = *p_state * 1103515245UL + 12345UL;
+    return (size_t)((*p_state >> 16) & 0x7fffffffUL);
+}
+
+/*******************************************************************************
+* Computes the strongly connected components with an iterative Tarjan's        *
+* algorithm. Components are numbered in reverse topological order, that is,    *
+* every arc between two components leads to a smaller component ID.           *
+*******************************************************************************/
+static int compute_components(reachability_index* p_index)
+{
+    compact_graph* p_graph  = p_index->p_graph;
+    size_t         nodes    = p_graph->nodes;
+    size_t*        p_order  = malloc(sizeof(size_t) * (nodes + 1));
+    size_t*        p_low    = malloc(sizeof(size_t) * (nodes + 1));
+    size_t*        p_stack  = malloc(sizeof(size_t) * (nodes + 1));
+    size_t*        p_frames = malloc(sizeof(size_t) * (nodes + 1));
+    size_t*        p_cursor = malloc(sizeof(size_t) * (nodes + 1));
+    char*          p_on_stack = calloc(nodes + 1, 1);
+    size_t         counter  = 0;
+    size_t         top      = 0;
+    size_t         frames   = 0;
+    size_t         root;
+    size_t         node;
+    size_t         child;
+    size_t         member;
+
+    if (!p_order || !p_low || !p_stack || !p_frames || !p_cursor
+        || !p_on_stack)
+    {
+        free(p_order);
+        free(p_low);
+        free(p_stack);
+        free(p_frames);
+        free(p_cursor);
+        free(p_on_stack);
+        return FALSE;
+    }
+
+    for (node = 0; node < nodes; ++node)
+    {
+        p_order[node] = nodes;
+    }
+
+    p_index->components = 0;
+
+    for (root = 0; root < nodes; ++root)
+    {
+        if (p_order[root] != nodes) continue;
+
+        p_order[root] = p_low[root] = counter++;
+        p_stack[top++] = root;
+        p_on_stack[root] = TRUE;
+        p_frames[frames] = root;
+        p_cursor[frames++] = p_graph->p_child_offsets[root];
+
+        while (frames > 0)
+        {
+            node = p_frames[frames - 1];
+
+            if (p_cursor[frames - 1] < p_graph->p_child_offsets[node + 1])
+            {
+                child = p_graph->p_child_array[p_cursor[frames - 1]++];
+
+                if (p_order[child] == nodes)
+                {
+                    p_order[child] = p_low[child] = counter++;
+                    p_stack[top++] = child;
+                    p_on_stack[child] = TRUE;
+                    p_frames[frames] = child;
+                    p_cursor[frames++] = p_graph->p_child_offsets[child];
+                }
+                else if (p_on_stack[child])
+                {
+                    p_low[node] = size_t_min(p_low[node], p_order[child]);
+                }
+
+                continue;
+            }
+
+            --frames;
+
+            if (p_low[node] == p_order[node])
+            {
+                do
+                {
+                    member = p_stack[--top];
+                    p_on_stack[member] = FALSE;
+                    p_index->p_component_array[member] = p_index->components;
+                }
+                while (member != node);
+
+                p_index->components++;
+            }
+
+            if (frames > 0)
+            {
+                p_low[p_frames[frames - 1]] =
+                    size_t_min(p_low[p_frames[frames - 1]], p_low[node]);
+            }
+        }
+    }
+
+    free(p_order);
+    free(p_low);
+    free(p_stack);
+    free(p_frames);
+    free(p_cursor);
+    free(p_on_stack);
+    return TRUE;
+}
+
+/*******************************************************************************
+* Builds the condensation DAG without duplicate arcs.                          *
+*******************************************************************************/
+static int build_condensation(reachability_index* p_index)
+{
+    compact_graph* p_graph      = p_index->p_graph;
+    size_t         components   = p_index->components;
+    size_t*        p_components = p_index->p_component_array;
+    size_t*        p_last_tail;
+    size_t         node;
+    size_t         arc;
+    size_t         tail;
+    size_t         head;
+    size_t         read;
+    size_t         write;
+    size_t         begin;
+
+    p_index->p_dag_offsets = calloc(components + 1, sizeof(size_t));
+    p_index->p_dag_array   = malloc(sizeof(size_t) * (p_graph->arcs + 1));
+    p_last_tail            = malloc(sizeof(size_t) * (components + 1));
+
+    if (!p_index->p_dag_offsets || !p_index->p_dag_array || !p_last_tail)
+    {
+        free(p_last_tail);
+        return FALSE;
+    }
+
+    for (node = 0; node < p_graph->nodes; ++node)
+    {
+        for (arc = p_graph->p_child_offsets[node];
+             arc < p_graph->p_child_offsets[node + 1];
+             ++arc)
+        {
+            if (p_components[node] !=
+                p_components[p_graph->p_child_array[arc]])
+            {
+                p_index->p_dag_offsets[p_components[node] + 1]++;
+            }
+        }
+    }
+
+    for (tail = 0; tail < components; ++tail)
+    {
+        p_index->p_dag_offsets[tail + 1] += p_index->p_dag_offsets[tail];
+        p_last_tail[tail] = components;
+    }
+
+    /* Scatter the arcs using the offsets as cursors, then shift them back. */
+    for (node = 0; node < p_graph->nodes; ++node)
+    {
+        for (arc = p_graph->p_child_offsets[node];
+             arc < p_graph->p_child_offsets[node + 1];
+             ++arc)
+        {
+            tail = p_components[node];
+            head = p_components[p_graph->p_child_array[arc]];
+
+            if (tail != head)
+            {
+                p_index->p_dag_array[p_index->p_dag_offsets[tail]++] = head;
+            }
+        }
+    }
+
+    for (tail = components; tail > 0; --tail)
+    {
+        p_index->p_dag_offsets[tail] = p_index->p_dag_offsets[tail - 1];
+    }
+
+    p_index->p_dag_offsets[0] = 0;
+
+    /* Drop the parallel arcs in place. */
+    write = 0;
+
+    for (tail = 0; tail < components; ++tail)
+    {
+        begin = write;
+
+        for (read = p_index->p_dag_offsets[tail];
+             read < p_index->p_dag_offsets[tail + 1];
+             ++read)
+        {
+            head = p_index->p_dag_array[read];
+
+            if (p_last_tail[head] != tail)
+            {
+                p_last_tail[head] = tail;
+                p_index->p_dag_array[write++] = head;
+            }
+        }
+
+        p_index->p_dag_offsets[tail] = begin;
+    }
+
+    p_index->p_dag_offsets[components] = write;
+    free(p_last_tail);
+    return TRUE;
+}
+
+static void compute_levels(reachability_index* p_index)
+{
+    size_t component;
+    size_t arc;
+    size_t head;
+
+    for (component = 0; component < p_index->components; ++component)
+    {
+        p_index->p_depth_array[component]  = 0;
+        p_index->p_height_array[component] = 0;
+    }
+
+    /* Heads have smaller IDs than tails, so ascending IDs visit the heads
+       first and descending IDs visit the tails first. */
+    for (component = 0; component < p_index->components; ++component)
+    {
+        for (arc = p_index->p_dag_offsets[component];
+             arc < p_index->p_dag_offsets[component + 1];
+             ++arc)
+        {
+            head = p_index->p_dag_array[arc];
+            p_index->p_height_array[component] =
+                size_t_max(p_index->p_height_array[component],
+                           p_index->p_height_array[head] + 1);
+        }
+    }
+
+    for (component = p_index->components; component > 0; --component)
+    {
+        for (arc = p_index->p_dag_offsets[component - 1];
+             arc < p_index->p_dag_offsets[component];
+             ++arc)
+        {
+            head = p_index->p_dag_array[arc];
+            p_index->p_depth_array[head] =
+                size_t_max(p_index->p_depth_array[head],
+                           p_index->p_depth_array[component - 1] + 1);
+        }
+    }
+}
+
+/*******************************************************************************
+* Assigns the label 'label' to each component by a post-order traversal which  *
+* starts at a random root and visits the children from a random rotation.      *
+* The rank of a component is its post-order number and its low value is the   *
+* smallest rank in the sub-DAG under it.                                       *
+*******************************************************************************/
+static int compute_label(reachability_index* p_index,
+                         size_t label,
+                         unsigned long* p_random_state)
+{
+    size_t  components = p_index->components;
+    size_t  labels     = p_index->labels;
+    size_t* p_frames   = malloc(sizeof(size_t) * (components + 1));
+    size_t* p_visited  = malloc(sizeof(size_t) * (components + 1));
+    size_t* p_start    = malloc(sizeof(size_t) * (components + 1));
+    size_t* p_done     = malloc(sizeof(size_t) * (components + 1));
+    size_t  frames     = 0;
+    size_t  rank       = 0;
+    size_t  root_shift;
+    size_t  root;
+    size_t  i;
+    size_t  component;
+    size_t  degree;
+    size_t  child;
+    size_t  low;
+    size_t  arc;
+
+    if (!p_frames || !p_visited || !p_start || !p_done)
+    {
+        free(p_frames);
+        free(p_visited);
+        free(p_start);
+        free(p_done);
+        return FALSE;
+    }
+
+    for (i = 0; i < components; ++i)
+    {
+        p_visited[i] = FALSE;
+    }
+
+    root_shift = components > 0 ? next_random(p_random_state) % components : 0;
+
+    for (i = 0; i < components; ++i)
+    {
+        root = (root_shift + i) % components;
+
+        if (p_visited[root]) continue;
+
+        p_visited[root] = TRUE;
+        p_frames[frames++] = root;
+        degree = p_index->p_dag_offsets[root + 1] -
+                 p_index->p_dag_offsets[root];
+        p_start[root] = degree ? next_random(p_random_state) % degree : 0;
+        p_done[root] = 0;
+
+        while (frames > 0)
+        {
+            component = p_frames[frames - 1];
+            degree = p_index->p_dag_offsets[component + 1] -
+                     p_index->p_dag_offsets[component];
+
+            if (p_done[component] < degree)
+            {
+                child = p_index->p_dag_array[
+                            p_index->p_dag_offsets[component] +
+                            (p_start[component] + p_done[component]) % degree];
+                p_done[component]++;
+
+                if (!p_visited[child])
+                {
+                    p_visited[child] = TRUE;
+                    p_frames[frames++] = child;
+                    degree = p_index->p_dag_offsets[child + 1] -
+                             p_index->p_dag_offsets[child];
+                    p_start[child] =
+                        degree ? next_random(p_random_state) % degree : 0;
+                    p_done[child] = 0;
+                }
+
+                continue;
+            }
+
+            --frames;
+            low = rank;
+
+            for (arc = p_index->p_dag_offsets[component];
+                 arc < p_index->p_dag_offsets[component + 1];
+                 ++arc)
+            {
+                child = p_index->p_dag_array[arc];
+                low = size_t_min(low, p_index->p_low_array[child * labels +
+                                                           label]);
+            }
+
+            p_index->p_rank_array[component * labels + label] = rank++;
+            p_index->p_low_array[component * labels + label] = low;
+        }
+    }
+
+    free(p_frames);
+    free(p_visited);
+    free(p_start);
+    free(p_done);
+    return TRUE;
+}
+
+reachability_index* reachability_index_alloc(compact_graph* p_graph,
+                                             size_t labels)
+{
+    reachability_index* p_index;
+    unsigned long       random_state = 2016UL;
+    size_t              label;
+    size_t              components;
+
+    if (!p_graph) return NULL;
+
+    if (labels == 0) labels = DEFAULT_LABELS;
+
+    p_index = calloc(1, sizeof(*p_index));
+
+    if (!p_index) return NULL;
+
+    p_index->p_graph = p_graph;
+    p_index->labels  = labels;
+    p_index->p_component_array =
+        malloc(sizeof(size_t) * (p_graph->nodes + 1));
+
+    if (!p_index->p_component_array
+        || !compute_components(p_index)
+        || !build_condensation(p_index))
+    {
+        reachability_index_free(p_index);
+        return NULL;
+    }
+
+    components = p_index->components;
+    p_index->p_depth_array  = malloc(sizeof(size_t) * (components + 1));
+    p_index->p_height_array = malloc(sizeof(size_t) * (components + 1));
+    p_index->p_low_array    = malloc(sizeof(size_t) * (components * labels + 1));
+    p_index->p_rank_array   = malloc(sizeof(size_t) * (components * labels + 1));
+
+    if (!p_index->p_depth_array
+        || !p_index->p_height_array
+        || !p_index->p_low_array
+        || !p_index->p_rank_array)
+    {
+        reachability_index_free(p_index);
+        return NULL;
+    }
+
+    compute_levels(p_index);
+
+    for (label = 0; label < labels; ++label)
+    {
+        if (!compute_label(p_index, label, &random_state))
+        {
+            reachability_index_free(p_index);
+            return NULL;
+        }
+    }
+
+    return p_index;
+}
+
+/*******************************************************************************
+* Returns false if the component 'target' is certainly not reachable from the  *
+* component 'source'.                                                          *
+*******************************************************************************/
+static int components_may_reach(reachability_index* p_index,
+                                size_t source,
+                                size_t target)
+{
+    size_t  labels = p_index->labels;
+    size_t* p_source_low;
+    size_t* p_source_rank;
+    size_t* p_target_low;
+    size_t* p_target_rank;
+    size_t  i;
+
+    if (source == target) return TRUE;
+
+    /* Arcs only lead to smaller component IDs. */
+    if (source < target) return FALSE;
+
+    if (p_index->p_height_array[source] <= p_index->p_height_array[target]
+        || p_index->p_depth_array[source] >= p_index->p_depth_array[target])
+    {
+        return FALSE;
+    }
+
+    p_source_low  = &p_index->p_low_array[source * labels];
+    p_source_rank = &p_index->p_rank_array[source * labels];
+    p_target_low  = &p_index->p_low_array[target * labels];
+    p_target_rank = &p_index->p_rank_array[target * labels];
+
+    for (i = 0; i < labels; ++i)
+    {
+        if (p_target_low[i] < p_source_low[i]
+            || p_target_rank[i] > p_source_rank[i])
+        {
+            return FALSE;
+        }
+    }
+
+    return TRUE;
+}
+
+int reachability_index_may_reach(reachability_index* p_index,
+                                 size_t source,
+                                 size_t target)
+{
+    if (!p_index
+        || source >= p_index->p_graph->nodes
+        || target >= p_index->p_graph->nodes)
+    {
+        return FALSE;
+    }
+
+    return components_may_reach(p_index,
+                                p_index->p_component_array[source],
+                                p_index->p_component_array[target]);
+}
+
+int reachability_index_is_reachable(reachability_index* p_index,
+                                    size_t source,
+                                    size_t target)
+{
+    unordered_set* p_visited;
+    list*          p_stack;
+    size_t         source_component;
+    size_t         target_component;
+    size_t         component;
+    size_t         child;
+    size_t         arc;
+    int            found = FALSE;
+
+    if (!reachability_index_may_reach(p_index, source, target)) return FALSE;
+
+    source_component = p_index->p_component_array[source];
+    target_component = p_index->p_component_array[target];
+
+    if (source_component == target_component) return TRUE;
+
+    /* Components are stored off by one so that no key is NULL. */
+    p_visited = unordered_set_alloc(16,
+                                    1.0f,
+                                    component_hash_function,
+                                    component_equals_function);
+    p_stack = list_alloc(16);
+
+    list_push_back(p_stack, (void*)(intptr_t)(source_component + 1));
+    unordered_set_add(p_visited, (void*)(intptr_t)(source_component + 1));
+
+    while (list_size(p_stack) > 0 && !found)
+    {
+        component = (size_t)(intptr_t) list_pop_back(p_stack) - 1;
+
+        for (arc = p_index->p_dag_offsets[component];
+             arc < p_index->p_dag_offsets[component + 1];
+             ++arc)
+        {
+            child = p_index->p_dag_array[arc];
+
+            if (child == target_component)
+            {
+                found = TRUE;
+                break;
+            }
+
+            if (components_may_reach(p_index, child, target_component)
+                && unordered_set_add(p_visited, (void*)(intptr_t)(child + 1)))
+            {
+                list_push_back(p_stack, (void*)(intptr_t)(child + 1));
+            }
+        }
+    }
+
+    unordered_set_free(&p_visited);
+    list_free(p_stack);
+    return found;
+}
+
+/*******************************************************************************
+* Wraps the caller's iterators so that the search enters only the nodes the    *
+* labels do not rule out: the children that may reach 'endpoint_component'     *
+* and the parents that it may reach. 'p_next' holds the next admitted node,    *
+* or NULL when the wrapped iterator is exhausted.                              *
+*******************************************************************************/
+typedef struct pruning_iterator_state {
+    reachability_index*   p_index;
+    child_node_iterator*  p_child_iterator;
+    parent_node_iterator* p_parent_iterator;
+    size_t                endpoint_component;
+    void*                 p_next;
+} pruning_iterator_state;
+
+static int admits_child(pruning_iterator_state* p_state, void* p_node)
+{
+    size_t index = compact_graph_index_of(p_state->p_index->p_graph, p_node);
+
+    return index < p_state->p_index->p_graph->nodes
+        && components_may_reach(p_state->p_index,
+                                p_state->p_index->p_component_array[index],
+                                p_state->endpoint_component);
+}
+
+static int admits_parent(pruning_iterator_state* p_state, void* p_node)
+{
+    size_t index = compact_graph_index_of(p_state->p_index->p_graph, p_node);
+
+    return index < p_state->p_index->p_graph->nodes
+        && components_may_reach(p_state->p_index,
+                                p_state->endpoint_component,
+                                p_state->p_index->p_component_array[index]);
+}
+
+static void pruning_children_advance(pruning_iterator_state* p_state)
+{
+    child_node_iterator* p_inner = p_state->p_child_iterator;
+    void*                p_node;
+
+    while (p_inner->child_node_iterator_has_next(p_inner))
+    {
+        p_node = p_inner->child_node_iterator_next(p_inner);
+
+        if (admits_child(p_state, p_node))
+        {
+            p_state->p_next = p_node;
+            return;
+        }
+    }
+
+    p_state->p_next = NULL;
+}
+
+static void pruning_parents_advance(pruning_iterator_state* p_state)
+{
+    parent_node_iterator* p_inner = p_state->p_parent_iterator;
+    void*                 p_node;
+
+    while (p_inner->parent_node_iterator_has_next(p_inner))
+    {
+        p_node = p_inner->parent_node_iterator_next(p_inner);
+
+        if (admits_parent(p_state, p_node))
+        {
+            p_state->p_next = p_node;
+            return;
+        }
+    }
+
+    p_state->p_next = NULL;
+}
+
+static void pruning_children_init(child_node_iterator* p_me, void* p_node)
+{
+    pruning_iterator_state* p_state = p_me->state;
+
+    p_state->p_child_iterator->child_node_iterator_init(
+        p_state->p_child_iterator,
+        p_node);
+    pruning_children_advance(p_state);
+}
+
+static int pruning_children_has_next(child_node_iterator* p_me)
+{
+    return ((pruning_iterator_state*) p_me->state)->p_next != NULL;
+}
+
+static void* pruning_children_next(child_node_iterator* p_me)
+{
+    pruning_iterator_state* p_state = p_me->state;
+    void*                   p_node  = p_state->p_next;
+
+    pruning_children_advance(p_state);
+    return p_node;
+}
+
+static void pruning_children_free(child_node_iterator* p_me)
+{
+    pruning_iterator_state* p_state = p_me->state;
+
+    p_state->p_child_iterator->child_node_iterator_free(
+        p_state->p_child_iterator);
+}
+
+static void pruning_parents_init(parent_node_iterator* p_me, void* p_node)
+{
+    pruning_iterator_state* p_state = p_me->state;
+
+    p_state->p_parent_iterator->parent_node_iterator_init(
+        p_state->p_parent_iterator,
+        p_node);
+    pruning_parents_advance(p_state);
+}
+
+static int pruning_parents_has_next(parent_node_iterator* p_me)
+{
+    return ((pruning_iterator_state*) p_me->state)->p_next != NULL;
+}
+
+static void* pruning_parents_next(parent_node_iterator* p_me)
+{
+    pruning_iterator_state* p_state = p_me->state;
+    void*                   p_node  = p_state->p_next;
+
+    pruning_parents_advance(p_state);
+    return p_node;
+}
+
+static void pruning_parents_free(parent_node_iterator* p_me)
+{
+    pruning_iterator_state* p_state = p_me->state;
+
+    p_state->p_parent_iterator->parent_node_iterator_free(
+        p_state->p_parent_iterator);
+}
+
+list* reachability_index_find_path(reachability_index* p_index,
+                                   directed_graph_node* source_node,
+                                   directed_graph_node* target_node,
+                                   child_node_iterator* child_iterator,
+                                   parent_node_iterator* parent_iterator,
+                                   size_t (*hash_function)(void*),
+                                   int (*equals_function)(void*, void*))
+{
+    pruning_iterator_state child_state;
+    pruning_iterator_state parent_state;
+    child_node_iterator    pruning_child_iterator;
+    parent_node_iterator   pruning_parent_iterator;
+    search_path            path;
+    list*                  p_list;
+    size_t                 source = 0;
+    size_t                 target = 0;
+    int                    pruned = FALSE;
+
+    if (p_index && source_node && target_node
+        && child_iterator && parent_iterator)
+    {
+        source = compact_graph_index_of(p_index->p_graph, source_node);
+        target = compact_graph_index_of(p_index->p_graph, target_node);
+        pruned = source < p_index->p_graph->nodes
+              && target < p_index->p_graph->nodes;
+    }
+
+    if (pruned)
+    {
+        if (!reachability_index_may_reach(p_index, source, target))
+        {
+            return NULL;
+        }
+
+        child_state.p_index            = p_index;
+        child_state.p_child_iterator   = child_iterator;
+        child_state.p_parent_iterator  = NULL;
+        child_state.endpoint_component = p_index->p_component_array[target];
+        child_state.p_next             = NULL;
+
+        parent_state.p_index            = p_index;
+        parent_state.p_child_iterator   = NULL;
+        parent_state.p_parent_iterator  = parent_iterator;
+        parent_state.endpoint_component = p_index->p_component_array[source];
+        parent_state.p_next             = NULL;
+
+        pruning_child_iterator.state = &child_state;
+        pruning_child_iterator.child_node_iterator_init =
+            pruning_children_init;
+        pruning_child_iterator.child_node_iterator_has_next =
+            pruning_children_has_next;
+        pruning_child_iterator.child_node_iterator_next =
+            pruning_children_next;
+        pruning_child_iterator.child_node_iterator_free =
+            pruning_children_free;
+
+        pruning_parent_iterator.state = &parent_state;
+        pruning_parent_iterator.parent_node_iterator_init =
+            pruning_parents_init;
+        pruning_parent_iterator.parent_node_iterator_has_next =
+            pruning_parents_has_next;
+        pruning_parent_iterator.parent_node_iterator_next =
+            pruning_parents_next;
+        pruning_parent_iterator.parent_node_iterator_free =
+            pruning_parents_free;
+
+        child_iterator  = &pruning_child_iterator;
+        parent_iterator = &pruning_parent_iterator;
+    }
+
+    /* The search itself decides the reachability the labels left open. */
+    search_path_init(&path);
+    bidirectional_breadth_first_search_balanced(source_node,
+                                                target_node,
+                                                child_iterator,
+                                                parent_iterator,
+                                                NULL,
+                                                NULL,
+                                                hash_function,
+                                                equals_function,
+                                                NULL,
+                                                &path);
+
+    p_list = path.nodes > 0 ? search_path_to_list(&path) : NULL;
+    search_path_destroy(&path);
+    return p_list;
+}
+
+void reachability_index_free(reachability_index* p_index)
+{
+    if (!p_index) return;
+
+    free(p_index->p_component_array);
+    free(p_index->p_dag_offsets);
+    free(p_index->p_dag_array);
+    free(p_index->p_depth_array);
+    free(p_index->p_height_array);
+    free(p_index->p_low_array);
+    free(p_index->p_rank_array);
+    free(p_index);
+}
+
+static void reachability_index_test_small()
+{
+    directed_graph_node* p_nodes[7];
+    compact_graph*       p_graph;
+    reachability_index*  p_index;
+    size_t               i;
+
+    puts("        reachability_index_test_small()");
+
+    for (i = 0; i < 7; ++i)
+    {
+        p_nodes[i] = directed_graph_node_alloc(i);
+    }
+
+    /* The cycle 0 -> 1 -> 2 -> 0 leads to 3 -> 4; 5 -> 4; 6 is isolated. */
+    directed_graph_node_add_arc(p_nodes[0], p_nodes[1]);
+    directed_graph_node_add_arc(p_nodes[1], p_nodes[2]);
+    directed_graph_node_add_arc(p_nodes[2], p_nodes[0]);
+    directed_graph_node_add_arc(p_nodes[2], p_nodes[3]);
+    directed_graph_node_add_arc(p_nodes[3], p_nodes[4]);
+    directed_graph_node_add_arc(p_nodes[5], p_nodes[4]);
+
+    p_graph = compact_graph_alloc(p_nodes, 7);
+    p_index = reachability_index_alloc(p_graph, 2);
+
+    ASSERT(p_index->components == 5);
+    ASSERT(p_index->p_component_array[0] == p_index->p_component_array[1]);
+    ASSERT(p_index->p_component_array[1] == p_index->p_component_array[2]);
+
+    ASSERT(reachability_index_is_reachable(p_index, 1, 0));
+    ASSERT(reachability_index_is_reachable(p_index, 0, 4));
+    ASSERT(reachability_index_is_reachable(p_index, 5, 4));
+    ASSERT(reachability_index_is_reachable(p_index, 6, 6));
+    ASSERT(!reachability_index_is_reachable(p_index, 4, 0));
+    ASSERT(!reachability_index_is_reachable(p_index, 5, 3));
+    ASSERT(!reachability_index_is_reachable(p_index, 0, 5));
+    ASSERT(!reachability_index_is_reachable(p_index, 0, 6));
+    ASSERT(!reachability_index_may_reach(p_index, 4, 0));
+
+    reachability_index_free(p_index);
+    compact_graph_free(p_graph);
+
+    for (i = 0; i < 7; ++i)
+    {
+        directed_graph_node_free(p_nodes[i]);
+    }
+}
+
+/* Returns a 'nodes' x 'nodes' matrix of reachability computed by DFS. */
+static char* reference_reachability(compact_graph* p_graph)
+{
+    size_t nodes    = p_graph->nodes;
+    char*  p_matrix = calloc(nodes * nodes, 1);
+    size_t* p_stack = malloc(sizeof(size_t) * (nodes + 1));
+    size_t source;
+    size_t node;
+    size_t child;
+    size_t arc;
+    size_t top;
+
+    for (source = 0; source < nodes; ++source)
+    {
+        p_matrix[source * nodes + source] = TRUE;
+        p_stack[0] = source;
+        top = 1;
+
+        while (top > 0)
+        {
+            node = p_stack[--top];
+
+            for (arc = p_graph->p_child_offsets[node];
+                 arc < p_graph->p_child_offsets[node + 1];
+                 ++arc)
+            {
+                child = p_graph->p_child_array[arc];
+
+                if (!p_matrix[source * nodes + child])
+                {
+                    p_matrix[source * nodes + child] = TRUE;
+                    p_stack[top++] = child;
+                }
+            }
+        }
+    }
+
+    free(p_stack);
+    return p_matrix;
+}
+
+static void reachability_index_test_random()
+{
+    const size_t          nodes = 300;
+    directed_graph_node** p_nodes;
+    compact_graph*        p_graph;
+    reachability_index*   p_index;
+    char*                 p_expected;
+    size_t                i;
+    size_t                j;
+    int                   exact_ok = TRUE;
+    int                   filter_ok = TRUE;
+
+    puts("        reachability_index_test_random()");
+
+    p_nodes = malloc(sizeof(directed_graph_node*) * nodes);
+
+    for (i = 0; i < nodes; ++i)
+    {
+        p_nodes[i] = directed_graph_node_alloc(i);
+    }
+
+    for (i = 0; i < nodes + nodes / 3; ++i)
+    {
+        directed_graph_node_add_arc(p_nodes[rand() % nodes],
+                                    p_nodes[rand() % nodes]);
+    }
+
+    p_graph    = compact_graph_alloc(p_nodes, nodes);
+    p_index    = reachability_index_alloc(p_graph, 3);
+    p_expected = reference_reachability(p_graph);
+
+    for (i = 0; i < nodes; ++i)
+    {
+        for (j = 0; j < nodes; ++j)
+        {
+            if (reachability_index_is_reachable(p_index, i, j) !=
+                p_expected[i * nodes + j])
+            {
+                exact_ok = FALSE;
+            }
+
+            if (p_expected[i * nodes + j]
+                && !reachability_index_may_reach(p_index, i, j))
+            {
+                filter_ok = FALSE;
+            }
+        }
+    }
+
+    ASSERT(exact_ok);
+    ASSERT(filter_ok);
+
+    free(p_expected);
+    reachability_index_free(p_index);
+    compact_graph_free(p_graph);
+
+    for (i = 0; i < nodes; ++i)
+    {
+        directed_graph_node_free(p_nodes[i]);
+    }
+
+    free(p_nodes);
+}
+
+static void children_iterator_init(child_node_iterator* p_me, void* p_node)
+{
+    p_me->state = unordered_set_iterator_alloc(
+                      directed_graph_node_children_set(p_node));
+}
+
+static int children_iterator_has_next(child_node_iterator* p_me)
+{
+    return unordered_set_iterator_has_next(p_me->state);
+}
+
+static void* children_iterator_next(child_node_iterator* p_me)
+{
+    void* p_node;
+
+    unordered_set_iterator_next(p_me->state, &p_node);
+    return p_node;
+}
+
+static void children_iterator_free(child_node_iterator* p_me)
+{
+    unordered_set_iterator_free(p_me->state);
+}
+
+static void parents_iterator_init(parent_node_iterator* p_me, void* p_node)
+{
+    p_me->state = unordered_set_iterator_alloc(
+                      directed_graph_node_parent_set(p_node));
+}
+
+static int parents_iterator_has_next(parent_node_iterator* p_me)
+{
+    return unordered_set_iterator_has_next(p_me->state);
+}
+
+static void* parents_iterator_next(parent_node_iterator* p_me)
+{
+    void* p_node;
+
+    unordered_set_iterator_next(p_me->state, &p_node);
+    return p_node;
+}
+
+static void parents_iterator_free(parent_node_iterator* p_me)
+{
+    unordered_set_iterator_free(p_me->state);
+}
+
+/*******************************************************************************
+* Checks that the pruned search finds a path exactly when there is one, and    *
+* that the path is as short as the one of the plain breadth-first search.      *
+*******************************************************************************/
+static void reachability_index_test_find_path()
+{
+    const size_t          nodes = 200;
+    directed_graph_node** p_nodes;
+    compact_graph*        p_graph;
+    reachability_index*   p_index;
+    char*                 p_expected;
+    child_node_iterator   child_iterator;
+    parent_node_iterator  parent_iterator;
+    list*                 p_path;
+    size_t                hops;
+    size_t                i;
+    size_t                j;
+    int                   found_ok = TRUE;
+    int                   length_ok = TRUE;
+
+    puts("        reachability_index_test_find_path()");
+
+    child_iterator.child_node_iterator_init       = children_iterator_init;
+    child_iterator.child_node_iterator_has_next   = children_iterator_has_next;
+    child_iterator.child_node_iterator_next       = children_iterator_next;
+    child_iterator.child_node_iterator_free       = children_iterator_free;
+    parent_iterator.parent_node_iterator_init     = parents_iterator_init;
+    parent_iterator.parent_node_iterator_has_next = parents_iterator_has_next;
+    parent_iterator.parent_node_iterator_next     = parents_iterator_next;
+    parent_iterator.parent_node_iterator_free     = parents_iterator_free;
+
+    p_nodes = malloc(sizeof(directed_graph_node*) * nodes);
+
+    for (i = 0; i < nodes; ++i)
+    {
+        p_nodes[i] = directed_graph_node_alloc(i);
+    }
+
+    for (i = 0; i < nodes + nodes / 4; ++i)
+    {
+        directed_graph_node_add_arc(p_nodes[rand() % nodes],
+                                    p_nodes[rand() % nodes]);
+    }
+
+    p_graph    = compact_graph_alloc(p_nodes, nodes);
+    p_index    = reachability_index_alloc(p_graph, 2);
+    p_expected = reference_reachability(p_graph);
+
+    for (i = 0; i < nodes; i += 3)
+    {
+        for (j = 0; j < nodes; j += 2)
+        {
+            p_path = reachability_index_find_path(
+                         p_index,
+                         p_graph->p_node_array[i],
+                         p_graph->p_node_array[j],
+                         &child_iterator,
+                         &parent_iterator,
+                         directed_graph_node_hash_function,
+                         directed_graph_nodes_equal_function);
+
+            if ((p_path != NULL) != p_expected[i * nodes + j])
+            {
+                found_ok = FALSE;
+            }
+
+            if (p_path)
+            {
+                hops = breadth_first_search_path(
+                           p_graph->p_node_array[i],
+                           p_graph->p_node_array[j],
+                           &child_iterator,
+                           directed_graph_node_hash_function,
+                           directed_graph_nodes_equal_function,
+                           NULL);
+
+                if (list_size(p_path) != hops + 1
+                    || list_get(p_path, 0) != p_graph->p_node_array[i]
+                    || list_get(p_path, hops) != p_graph->p_node_array[j])
+                {
+                    length_ok = FALSE;
+                }
+
+                list_free(p_path);
+            }
+        }
+    }
+
+    ASSERT(found_ok);
+    ASSERT(length_ok);
+
+    free(p_expected);
+    reachability_index_free(p_index);
+    compact_graph_free(p_graph);
+
+    for (i = 0; i < nodes; ++i)
+    {
+        directed_graph_node_free(p_nodes[i]);
+    }
+
+    free(p_nodes);
+}
+
+void reachability_index_test()
+{
+    puts("    reachability_index_test()");
+    reachability_index_test_small();
+    reachability_index_test_random();
+    reachability_index_test_find_path();
+}
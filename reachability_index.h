@@ -0,0 +1,93 @@
+#ifndef REACHABILITY_INDEX_H
+#define REACHABILITY_INDEX_H
+
+#include "compact_graph.h"
+#include "list.h"
+#include "utils.h"
+#include <stddef.h>
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * A GRAIL-style reachability index over the condensation of a compact      *
+    * graph. Each strongly connected component gets 'labels' interval labels   *
+    * from randomized post-order traversals together with its topological      *
+    * depth and height. If any of these filters fails, the target is           *
+    * definitely unreachable from the source.                                  *
+    ***************************************************************************/
+    typedef struct reachability_index {
+        compact_graph* p_graph;
+        size_t         components;
+        size_t         labels;
+
+        /* Maps each node index to its strongly connected component. */
+        size_t*        p_component_array;
+
+        /* The condensation DAG in compressed sparse row form. */
+        size_t*        p_dag_offsets;
+        size_t*        p_dag_array;
+
+        /* Longest path from any source component and to any sink component. */
+        size_t*        p_depth_array;
+        size_t*        p_height_array;
+
+        /* Label 'i' of component 'c' is at index 'c * labels + i'. */
+        size_t*        p_low_array;
+        size_t*        p_rank_array;
+    } reachability_index;
+
+    /***************************************************************************
+    * Builds the index for the snapshot 'p_graph' using 'labels' interval      *
+    * labels per component. The snapshot must outlive the index.               *
+    ***************************************************************************/
+    reachability_index* reachability_index_alloc(compact_graph* p_graph,
+                                                 size_t labels);
+
+    /***************************************************************************
+    * Returns false if the node with index 'target' is definitely unreachable  *
+    * from the node with index 'source'. Runs in O(labels) time.               *
+    ***************************************************************************/
+    int reachability_index_may_reach(reachability_index* p_index,
+                                     size_t source,
+                                     size_t target);
+
+    /***************************************************************************
+    * Returns true if 'target' is reachable from 'source'. Falls back to a     *
+    * depth-first search over the condensation pruned by the labels whenever   *
+    * the O(labels) filter cannot decide.                                      *
+    ***************************************************************************/
+    int reachability_index_is_reachable(reachability_index* p_index,
+                                        size_t source,
+                                        size_t target);
+
+    /***************************************************************************
+    * Returns NULL right away if the labels rule out a path from 'source_node' *
+    * to 'target_node', and otherwise runs the level-balanced bidirectional    *
+    * breadth-first search, which decides the reachability. The forward side   *
+    * enters only the children that may reach the target and the backward      *
+    * side only the parents the source may reach. If either node is not in     *
+    * the snapshot, the search runs without pruning.                           *
+    ***************************************************************************/
+    list* reachability_index_find_path(reachability_index* p_index,
+                                       directed_graph_node* source_node,
+                                       directed_graph_node* target_node,
+                                       child_node_iterator* child_iterator,
+                                       parent_node_iterator* parent_iterator,
+                                       size_t (*hash_function)(void*),
+                                       int (*equals_function)(void*, void*));
+
+    /***************************************************************************
+    * Deallocates the index. The snapshot is not touched.                      *
+    ***************************************************************************/
+    void reachability_index_free(reachability_index* p_index);
+
+    /* Contains the unit tests. */
+    void reachability_index_test();
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif  /* REACHABILITY_INDEX_H */
@@ -0,0 +1,1126 @@
+/***********************************
+* Exposes pthread keys under C89. *
+***********************************/
+#define _POSIX_C_SOURCE 200112L
+
+#include "my_assert.h"
+#include "scheduler.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define FALSE 0
+#define TRUE 1
+
+#define INITIAL_CAPACITY  64
+#define TASKS_PER_BLOCK   64
+#define SPIN_ROUNDS       64
+#define GRAINS_PER_THREAD 8
+
+/*******************************************************************************
+* A loop in progress. 'shares' counts the ranges of the loop that are queued   *
+* or running; no range is offered to the thieves once it reaches 'threads', so *
+* that no more slots than that run the body at once.                           *
+*******************************************************************************/
+typedef struct scheduler_loop {
+    void (*p_body)(size_t, size_t, size_t, void*);
+    void*           p_argument;
+    size_t          grain;
+    size_t          threads;
+    size_t          shares;
+    scheduler_group group;
+} scheduler_loop;
+
+/*******************************************************************************
+* A task is either a call of 'p_function' or, if 'p_loop' is set, the range    *
+* ['begin', 'end') of a loop. 'p_next' links the free tasks of a worker.       *
+*******************************************************************************/
+typedef struct scheduler_task {
+    void (*p_function)(void*);
+    void*                  p_argument;
+    scheduler_loop*        p_loop;
+    size_t                 begin;
+    size_t                 end;
+    scheduler_group*       p_group;
+    struct scheduler_task* p_next;
+} scheduler_task;
+
+/*******************************************************************************
+* The ring buffer of a deque. A ring replaced by a larger one is kept in the   *
+* 'p_previous' chain until the scheduler goes away, as a thief may still be    *
+* reading it.                                                                  *
+*******************************************************************************/
+typedef struct scheduler_ring {
+    size_t                 capacity;
+    size_t*                p_slot_array;
+    struct scheduler_ring* p_previous;
+} scheduler_ring;
+
+typedef struct scheduler_block {
+    struct scheduler_block* p_next;
+    scheduler_task          task_array[TASKS_PER_BLOCK];
+} scheduler_block;
+
+/*******************************************************************************
+* A slot of the scheduler. 'in_use' is only meaningful for the external slots. *
+* The padding keeps the deques of neighbouring slots off the same cache line.  *
+*******************************************************************************/
+typedef struct scheduler_worker {
+    scheduler_deque  deque;
+    scheduler*       p_scheduler;
+    scheduler_task*  p_free_task;
+    scheduler_block* p_block;
+    size_t           index;
+    size_t           in_use;
+    size_t           random;
+    parallel_thread  thread;
+    char             padding[64];
+} scheduler_worker;
+
+static scheduler_worker* current_worker(scheduler* p_scheduler)
+{
+#ifdef _WIN32
+    return TlsGetValue(p_scheduler->key);
+#else
+    return pthread_getspecific(p_scheduler->key);
+#endif
+}
+
+static void set_current_worker(scheduler* p_scheduler,
+                               scheduler_worker* p_worker)
+{
+#ifdef _WIN32
+    TlsSetValue(p_scheduler->key, p_worker);
+#else
+    pthread_setspecific(p_scheduler->key, p_worker);
+#endif
+}
+
+static scheduler_ring* ring_alloc(size_t capacity)
+{
+    scheduler_ring* p_ring = malloc(sizeof(*p_ring));
+
+    if (!p_ring) return NULL;
+
+    p_ring->p_slot_array = malloc(sizeof(size_t) * capacity);
+
+    if (!p_ring->p_slot_array)
+    {
+        free(p_ring);
+        return NULL;
+    }
+
+    p_ring->capacity   = capacity;
+    p_ring->p_previous = NULL;
+    return p_ring;
+}
+
+/*******************************************************************************
+* The indices start at one so that 'bottom - 1' never wraps around.            *
+*******************************************************************************/
+static int deque_init(scheduler_deque* p_deque)
+{
+    scheduler_ring* p_ring = ring_alloc(INITIAL_CAPACITY);
+
+    if (!p_ring) return FALSE;
+
+    p_deque->top    = 1;
+    p_deque->bottom = 1;
+    p_deque->array  = (size_t) p_ring;
+    return TRUE;
+}
+
+static void deque_destroy(scheduler_deque* p_deque)
+{
+    scheduler_ring* p_ring = (scheduler_ring*) p_deque->array;
+    scheduler_ring* p_previous;
+
+    while (p_ring)
+    {
+        p_previous = p_ring->p_previous;
+        free(p_ring->p_slot_array);
+        free(p_ring);
+        p_ring = p_previous;
+    }
+}
+
+/*******************************************************************************
+* Called by the owner only. Returns false if the ring could not grow.          *
+*******************************************************************************/
+static int deque_push(scheduler_deque* p_deque, scheduler_task* p_task)
+{
+    size_t          bottom = p_deque->bottom;
+    size_t          top    = PARALLEL_LOAD(&p_deque->top);
+    scheduler_ring* p_ring = (scheduler_ring*) p_deque->array;
+    scheduler_ring* p_larger;
+    size_t          i;
+
+    if (bottom - top >= p_ring->capacity)
+    {
+        p_larger = ring_alloc(2 * p_ring->capacity);
+
+        if (!p_larger) return FALSE;
+
+        for (i = top; i < bottom; ++i)
+        {
+            p_larger->p_slot_array[i & (p_larger->capacity - 1)] =
+                PARALLEL_LOAD(&p_ring->p_slot_array[
+                    i & (p_ring->capacity - 1)]);
+        }
+
+        p_larger->p_previous = p_ring;
+        PARALLEL_STORE(&p_deque->array, (size_t) p_larger);
+        p_ring = p_larger;
+    }
+
+    PARALLEL_STORE(&p_ring->p_slot_array[bottom & (p_ring->capacity - 1)],
+                   (size_t) p_task);
+    PARALLEL_STORE(&p_deque->bottom, bottom + 1);
+    return TRUE;
+}
+
+/*******************************************************************************
+* Called by the owner only. The decrement of 'bottom' is a full barrier, so    *
+* that a thief and the owner racing for the last task both see each other and  *
+* settle it with a CAS on 'top'.                                               *
+*******************************************************************************/
+static scheduler_task* deque_pop(scheduler_deque* p_deque)
+{
+    size_t          bottom = PARALLEL_FETCH_ADD(&p_deque->bottom,
+                                                (size_t) -1) - 1;
+    size_t          top    = PARALLEL_LOAD(&p_deque->top);
+    scheduler_ring* p_ring = (scheduler_ring*) p_deque->array;
+    scheduler_task* p_task;
+
+    if (top > bottom)
+    {
+        PARALLEL_STORE(&p_deque->bottom, bottom + 1);
+        return NULL;
+    }
+
+    p_task = (scheduler_task*) PARALLEL_LOAD(
+        &p_ring->p_slot_array[bottom & (p_ring->capacity - 1)]);
+
+    if (top == bottom)
+    {
+        if (!PARALLEL_CAS(&p_deque->top, top, top + 1)) p_task = NULL;
+
+        PARALLEL_STORE(&p_deque->bottom, bottom + 1);
+    }
+
+    return p_task;
+}
+
+static scheduler_task* deque_steal(scheduler_deque* p_deque)
+{
+    size_t          top    = PARALLEL_LOAD(&p_deque->top);
+    size_t          bottom = PARALLEL_LOAD(&p_deque->bottom);
+    scheduler_ring* p_ring;
+    scheduler_task* p_task;
+
+    if (top >= bottom) return NULL;
+
+    p_ring = (scheduler_ring*) PARALLEL_LOAD(&p_deque->array);
+    p_task = (scheduler_task*) PARALLEL_LOAD(
+        &p_ring->p_slot_array[top & (p_ring->capacity - 1)]);
+
+    return PARALLEL_CAS(&p_deque->top, top, top + 1) ? p_task : NULL;
+}
+
+static int deque_is_empty(scheduler_deque* p_deque)
+{
+    return p_deque->bottom == PARALLEL_LOAD(&p_deque->top);
+}
+
+static scheduler_task* task_alloc(scheduler_worker* p_worker)
+{
+    scheduler_block* p_block;
+    scheduler_task*  p_task;
+    size_t           i;
+
+    if (!p_worker->p_free_task)
+    {
+        p_block = malloc(sizeof(*p_block));
+
+        if (!p_block) return NULL;
+
+        p_block->p_next   = p_worker->p_block;
+        p_worker->p_block = p_block;
+
+        for (i = 0; i < TASKS_PER_BLOCK; ++i)
+        {
+            p_block->task_array[i].p_next = p_worker->p_free_task;
+            p_worker->p_free_task = &p_block->task_array[i];
+        }
+    }
+
+    p_task = p_worker->p_free_task;
+    p_worker->p_free_task = p_task->p_next;
+    return p_task;
+}
+
+/*******************************************************************************
+* A stolen task goes to the free list of the thief.                            *
+*******************************************************************************/
+static void task_release(scheduler_worker* p_worker, scheduler_task* p_task)
+{
+    p_task->p_next = p_worker->p_free_task;
+    p_worker->p_free_task = p_task;
+}
+
+/*******************************************************************************
+* The fetch-and-add orders the push before the check against the 'sleepers'    *
+* increment of a worker about to sleep, which rescans the deques after it.     *
+*******************************************************************************/
+static void wake_worker(scheduler* p_scheduler)
+{
+    if (PARALLEL_FETCH_ADD(&p_scheduler->sleepers, 0) == 0) return;
+
+    parallel_mutex_lock(&p_scheduler->mutex);
+    p_scheduler->wake_epoch++;
+    parallel_condition_signal(&p_scheduler->wake_condition);
+    parallel_mutex_unlock(&p_scheduler->mutex);
+}
+
+static size_t next_random(scheduler_worker* p_worker)
+{
+    size_t x = p_worker->random;
+
+    x ^= x << 7;
+    x ^= x >> 9;
+    x ^= x << 8;
+    p_worker->random = x;
+    return x;
+}
+
+static scheduler_task* find_task(scheduler_worker* p_worker)
+{
+    scheduler*      p_scheduler = p_worker->p_scheduler;
+    scheduler_task* p_task      = deque_pop(&p_worker->deque);
+    size_t          start;
+    size_t          i;
+
+    if (p_task) return p_task;
+
+    start = next_random(p_worker) % p_scheduler->slots;
+
+    for (i = 0; i < p_scheduler->slots; ++i)
+    {
+        scheduler_worker* p_victim =
+            &p_scheduler->p_worker_array[(start + i) % p_scheduler->slots];
+
+        if (p_victim == p_worker) continue;
+
+        p_task = deque_steal(&p_victim->deque);
+
+        if (p_task) return p_task;
+    }
+
+    return NULL;
+}
+
+static int push_task(scheduler_worker* p_worker,
+                     scheduler_task* p_task,
+                     scheduler_group* p_group)
+{
+    p_task->p_group = p_group;
+    PARALLEL_FETCH_ADD(&p_group->pending, 1);
+
+    if (!deque_push(&p_worker->deque, p_task))
+    {
+        PARALLEL_FETCH_ADD(&p_group->pending, (size_t) -1);
+        task_release(p_worker, p_task);
+        return FALSE;
+    }
+
+    wake_worker(p_worker->p_scheduler);
+    return TRUE;
+}
+
+/*******************************************************************************
+* Takes a share of the loop for a new range. Returns false if the loop already *
+* has as many ranges as it may use threads.                                    *
+*******************************************************************************/
+static int loop_take_share(scheduler_loop* p_loop)
+{
+    size_t shares = PARALLEL_LOAD(&p_loop->shares);
+
+    while (shares < p_loop->threads)
+    {
+        if (PARALLEL_CAS(&p_loop->shares, shares, shares + 1)) return TRUE;
+
+        shares = PARALLEL_LOAD(&p_loop->shares);
+    }
+
+    return FALSE;
+}
+
+/*******************************************************************************
+* Lazy binary splitting: while nobody has anything to steal from this worker   *
+* and the loop may use another thread, the upper half of the range is offered  *
+* to the thieves; otherwise the range is worked through one grain at a time,   *
+* checking again after each grain.                                             *
+*******************************************************************************/
+static void run_range(scheduler_worker* p_worker,
+                      scheduler_loop* p_loop,
+                      size_t begin,
+                      size_t end)
+{
+    scheduler_task* p_task;
+    size_t          middle;
+
+    while (end - begin > p_loop->grain)
+    {
+        if (deque_is_empty(&p_worker->deque) && loop_take_share(p_loop))
+        {
+            if ((p_task = task_alloc(p_worker)) != NULL)
+            {
+                middle = begin + (end - begin) / 2;
+                p_task->p_loop = p_loop;
+                p_task->begin  = middle;
+                p_task->end    = end;
+
+                if (push_task(p_worker, p_task, &p_loop->group))
+                {
+                    end = middle;
+                    continue;
+                }
+            }
+
+            PARALLEL_FETCH_ADD(&p_loop->shares, (size_t) -1);
+        }
+
+        p_loop->p_body(begin,
+                       begin + p_loop->grain,
+                       p_worker->index,
+                       p_loop->p_argument);
+        begin += p_loop->grain;
+    }
+
+    p_loop->p_body(begin, end, p_worker->index, p_loop->p_argument);
+}
+
+static void run_task(scheduler_worker* p_worker, scheduler_task* p_task)
+{
+    scheduler_group* p_group = p_task->p_group;
+
+    if (p_task->p_loop)
+    {
+        run_range(p_worker, p_task->p_loop, p_task->begin, p_task->end);
+        PARALLEL_FETCH_ADD(&p_task->p_loop->shares, (size_t) -1);
+    }
+    else
+    {
+        p_task->p_function(p_task->p_argument);
+    }
+
+    task_release(p_worker, p_task);
+    PARALLEL_FETCH_ADD(&p_group->pending, (size_t) -1);
+}
+
+static void worker_main(void* p_argument)
+{
+    scheduler_worker* p_worker    = p_argument;
+    scheduler*        p_scheduler = p_worker->p_scheduler;
+    scheduler_task*   p_task;
+    size_t            failures = 0;
+    size_t            epoch;
+
+    set_current_worker(p_scheduler, p_worker);
+
+    for (;;)
+    {
+        p_task = find_task(p_worker);
+
+        if (p_task)
+        {
+            run_task(p_worker, p_task);
+            failures = 0;
+            continue;
+        }
+
+        if (PARALLEL_LOAD(&p_scheduler->stopping)) break;
+
+        if (++failures < SPIN_ROUNDS)
+        {
+            parallel_yield();
+            continue;
+        }
+
+        /* Announce the sleep before the last scan; a push after the scan
+           sees the announcement and bumps the epoch. */
+        parallel_mutex_lock(&p_scheduler->mutex);
+        epoch = p_scheduler->wake_epoch;
+        PARALLEL_FETCH_ADD(&p_scheduler->sleepers, 1);
+        p_task = find_task(p_worker);
+
+        while (!p_task
+               && epoch == p_scheduler->wake_epoch
+               && !p_scheduler->stopping)
+        {
+            parallel_condition_wait(&p_scheduler->wake_condition,
+                                    &p_scheduler->mutex);
+        }
+
+        PARALLEL_FETCH_ADD(&p_scheduler->sleepers, (size_t) -1);
+        parallel_mutex_unlock(&p_scheduler->mutex);
+
+        if (p_task) run_task(p_worker, p_task);
+
+        failures = 0;
+    }
+}
+
+/*******************************************************************************
+* Claims an external slot for the calling thread, waiting for one to free up.  *
+*******************************************************************************/
+static scheduler_worker* attach(scheduler* p_scheduler)
+{
+    size_t i;
+
+    for (;;)
+    {
+        for (i = 0; i < p_scheduler->external_slots; ++i)
+        {
+            scheduler_worker* p_worker = &p_scheduler->p_worker_array[i];
+
+            if (PARALLEL_CAS(&p_worker->in_use, 0, 1))
+            {
+                set_current_worker(p_scheduler, p_worker);
+                return p_worker;
+            }
+        }
+
+        parallel_yield();
+    }
+}
+
+static void detach(scheduler* p_scheduler, scheduler_worker* p_worker)
+{
+    set_current_worker(p_scheduler, NULL);
+    PARALLEL_STORE(&p_worker->in_use, 0);
+}
+
+scheduler* scheduler_alloc(size_t threads)
+{
+    scheduler* p_scheduler;
+    size_t     i;
+
+    if (threads == 0) threads = parallel_hardware_concurrency();
+
+    p_scheduler = calloc(1, sizeof(*p_scheduler));
+
+    if (!p_scheduler) return NULL;
+
+    p_scheduler->threads        = threads;
+    p_scheduler->external_slots = threads;
+    p_scheduler->slots          = 2 * threads - 1;
+    p_scheduler->p_worker_array =
+        calloc(p_scheduler->slots, sizeof(scheduler_worker));
+
+    if (!p_scheduler->p_worker_array)
+    {
+        free(p_scheduler);
+        return NULL;
+    }
+
+    for (i = 0; i < p_scheduler->slots; ++i)
+    {
+        scheduler_worker* p_worker = &p_scheduler->p_worker_array[i];
+
+        if (!deque_init(&p_worker->deque))
+        {
+            while (i > 0) deque_destroy(&p_scheduler->p_worker_array[--i]
+                                        .deque);
+
+            free(p_scheduler->p_worker_array);
+            free(p_scheduler);
+            return NULL;
+        }
+
+        p_worker->p_scheduler = p_scheduler;
+        p_worker->index       = i;
+        p_worker->random      = 2654435761UL * (i + 1);
+    }
+
+#ifdef _WIN32
+    p_scheduler->key = TlsAlloc();
+
+    if (p_scheduler->key == TLS_OUT_OF_INDEXES)
+#else
+    if (pthread_key_create(&p_scheduler->key, NULL) != 0)
+#endif
+    {
+        for (i = 0; i < p_scheduler->slots; ++i)
+        {
+            deque_destroy(&p_scheduler->p_worker_array[i].deque);
+        }
+
+        free(p_scheduler->p_worker_array);
+        free(p_scheduler);
+        return NULL;
+    }
+
+    parallel_mutex_init(&p_scheduler->mutex);
+    parallel_condition_init(&p_scheduler->wake_condition);
+
+    /* The slots of the workers that could not be started stay empty. */
+    for (i = p_scheduler->external_slots; i < p_scheduler->slots; ++i)
+    {
+        if (!parallel_thread_create(&p_scheduler->p_worker_array[i].thread,
+                                    worker_main,
+                                    &p_scheduler->p_worker_array[i]))
+        {
+            break;
+        }
+
+        p_scheduler->started++;
+    }
+
+    return p_scheduler;
+}
+
+static size_t shared_scheduler = 0;
+
+scheduler* scheduler_shared()
+{
+    scheduler* p_scheduler = (scheduler*) PARALLEL_LOAD(&shared_scheduler);
+
+    if (p_scheduler) return p_scheduler;
+
+    p_scheduler = scheduler_alloc(0);
+
+    if (!p_scheduler) return NULL;
+
+    if (!PARALLEL_CAS(&shared_scheduler, 0, (size_t) p_scheduler))
+    {
+        scheduler_free(p_scheduler);
+        p_scheduler = (scheduler*) PARALLEL_LOAD(&shared_scheduler);
+    }
+
+    return p_scheduler;
+}
+
+size_t scheduler_slots(scheduler* p_scheduler)
+{
+    return p_scheduler ? p_scheduler->slots : 1;
+}
+
+void scheduler_group_init(scheduler_group* p_group)
+{
+    p_group->pending = 0;
+}
+
+void scheduler_run(scheduler* p_scheduler,
+                   void (*p_function)(void*),
+                   void* p_argument)
+{
+    scheduler_worker* p_worker;
+
+    if (!p_function) return;
+
+    if (!p_scheduler || current_worker(p_scheduler))
+    {
+        p_function(p_argument);
+        return;
+    }
+
+    p_worker = attach(p_scheduler);
+    p_function(p_argument);
+    detach(p_scheduler, p_worker);
+}
+
+int scheduler_spawn(scheduler* p_scheduler,
+                    scheduler_group* p_group,
+                    void (*p_function)(void*),
+                    void* p_argument)
+{
+    scheduler_worker* p_worker;
+    scheduler_task*   p_task;
+
+    if (!p_function || !p_group) return FALSE;
+
+    p_worker = p_scheduler ? current_worker(p_scheduler) : NULL;
+
+    if (!p_worker)
+    {
+        p_function(p_argument);
+        return TRUE;
+    }
+
+    p_task = task_alloc(p_worker);
+
+    if (p_task)
+    {
+        p_task->p_function = p_function;
+        p_task->p_argument = p_argument;
+        p_task->p_loop     = NULL;
+
+        if (push_task(p_worker, p_task, p_group)) return TRUE;
+    }
+
+    p_function(p_argument);
+    return FALSE;
+}
+
+void scheduler_wait(scheduler* p_scheduler, scheduler_group* p_group)
+{
+    scheduler_worker* p_worker;
+    scheduler_task*   p_task;
+
+    if (!p_group) return;
+
+    p_worker = p_scheduler ? current_worker(p_scheduler) : NULL;
+
+    while (PARALLEL_LOAD(&p_group->pending) != 0)
+    {
+        p_task = p_worker ? find_task(p_worker) : NULL;
+
+        if (p_task)
+        {
+            run_task(p_worker, p_task);
+        }
+        else
+        {
+            parallel_yield();
+        }
+    }
+}
+
+void scheduler_parallel_for(scheduler* p_scheduler,
+                            size_t begin,
+                            size_t end,
+                            size_t grain,
+                            size_t threads,
+                            void (*p_body)(size_t, size_t, size_t, void*),
+                            void* p_argument)
+{
+    scheduler_worker* p_worker;
+    scheduler_loop    loop;
+
+    if (!p_body || begin >= end) return;
+
+    if (!p_scheduler)
+    {
+        p_body(begin, end, 0, p_argument);
+        return;
+    }
+
+    if (threads == 0 || threads > p_scheduler->slots)
+    {
+        threads = p_scheduler->slots;
+    }
+
+    if (grain == 0)
+    {
+        grain = (end - begin) / (GRAINS_PER_THREAD *
+                                 (threads < p_scheduler->threads ?
+                                  threads : p_scheduler->threads));
+    }
+
+    loop.p_body     = p_body;
+    loop.p_argument = p_argument;
+    loop.grain      = grain > 0 ? grain : 1;
+    loop.threads    = threads;
+    loop.shares     = 1;
+    scheduler_group_init(&loop.group);
+
+    p_worker = current_worker(p_scheduler);
+
+    if (p_worker)
+    {
+        run_range(p_worker, &loop, begin, end);
+        PARALLEL_FETCH_ADD(&loop.shares, (size_t) -1);
+        scheduler_wait(p_scheduler, &loop.group);
+        return;
+    }
+
+    p_worker = attach(p_scheduler);
+    run_range(p_worker, &loop, begin, end);
+    PARALLEL_FETCH_ADD(&loop.shares, (size_t) -1);
+    scheduler_wait(p_scheduler, &loop.group);
+    detach(p_scheduler, p_worker);
+}
+
+void scheduler_free(scheduler* p_scheduler)
+{
+    scheduler_block* p_block;
+    scheduler_block* p_next;
+    size_t           i;
+
+    if (!p_scheduler) return;
+
+    parallel_mutex_lock(&p_scheduler->mutex);
+    PARALLEL_STORE(&p_scheduler->stopping, 1);
+    p_scheduler->wake_epoch++;
+    parallel_condition_broadcast(&p_scheduler->wake_condition);
+    parallel_mutex_unlock(&p_scheduler->mutex);
+
+    for (i = 0; i < p_scheduler->started; ++i)
+    {
+        parallel_thread_join(p_scheduler->p_worker_array[
+            p_scheduler->external_slots + i].thread);
+    }
+
+    for (i = 0; i < p_scheduler->slots; ++i)
+    {
+        deque_destroy(&p_scheduler->p_worker_array[i].deque);
+
+        for (p_block = p_scheduler->p_worker_array[i].p_block;
+             p_block;
+             p_block = p_next)
+        {
+            p_next = p_block->p_next;
+            free(p_block);
+        }
+    }
+
+#ifdef _WIN32
+    TlsFree(p_scheduler->key);
+#else
+    pthread_key_delete(p_scheduler->key);
+#endif
+
+    parallel_condition_destroy(&p_scheduler->wake_condition);
+    parallel_mutex_destroy(&p_scheduler->mutex);
+    free(p_scheduler->p_worker_array);
+    free(p_scheduler);
+}
+
+typedef struct scheduler_test_loop {
+    size_t* p_mark_array;
+    size_t* p_busy_array;
+    size_t  slots;
+    size_t  errors;
+    size_t  running;
+    size_t  peak;
+} scheduler_test_loop;
+
+static void scheduler_test_mark_body(size_t chunk_begin,
+                                     size_t chunk_end,
+                                     size_t thread_index,
+                                     void* p_argument)
+{
+    scheduler_test_loop* p_loop = p_argument;
+    size_t               running;
+    size_t               peak;
+    size_t               i;
+
+    if (thread_index >= p_loop->slots
+        || !PARALLEL_CAS(&p_loop->p_busy_array[thread_index], 0, 1))
+    {
+        PARALLEL_FETCH_ADD(&p_loop->errors, 1);
+        return;
+    }
+
+    running = PARALLEL_FETCH_ADD(&p_loop->running, 1) + 1;
+    peak    = PARALLEL_LOAD(&p_loop->peak);
+
+    while (running > peak && !PARALLEL_CAS(&p_loop->peak, peak, running))
+    {
+        peak = PARALLEL_LOAD(&p_loop->peak);
+    }
+
+    for (i = chunk_begin; i < chunk_end; ++i)
+    {
+        PARALLEL_FETCH_ADD(&p_loop->p_mark_array[i], 1);
+    }
+
+    PARALLEL_FETCH_ADD(&p_loop->running, (size_t) -1);
+    PARALLEL_STORE(&p_loop->p_busy_array[thread_index], 0);
+}
+
+static void scheduler_test_parallel_for()
+{
+    scheduler_test_loop loop;
+    scheduler*          p_scheduler;
+    size_t              grains[] = { 0, 1, 7, 1000, 100000 };
+    size_t              threads;
+    size_t              cap;
+    size_t              g;
+    size_t              i;
+
+    puts("        scheduler_test_parallel_for()");
+
+    loop.p_mark_array = calloc(10000, sizeof(size_t));
+    loop.running      = 0;
+    loop.peak         = 0;
+
+    for (threads = 1; threads <= 4; ++threads)
+    {
+        p_scheduler       = scheduler_alloc(threads);
+        loop.slots        = scheduler_slots(p_scheduler);
+        loop.p_busy_array = calloc(loop.slots, sizeof(size_t));
+        loop.errors       = 0;
+
+        ASSERT(loop.slots == 2 * threads - 1);
+
+        for (g = 0; g < sizeof(grains) / sizeof(grains[0]); ++g)
+        {
+            for (i = 0; i < 10000; ++i) loop.p_mark_array[i] = 0;
+
+            scheduler_parallel_for(p_scheduler,
+                                   3,
+                                   9997,
+                                   grains[g],
+                                   0,
+                                   scheduler_test_mark_body,
+                                   &loop);
+
+            for (i = 0; i < 10000; ++i)
+            {
+                ASSERT(loop.p_mark_array[i] == (i >= 3 && i < 9997));
+            }
+        }
+
+        scheduler_parallel_for(p_scheduler,
+                               5,
+                               5,
+                               0,
+                               0,
+                               scheduler_test_mark_body,
+                               &loop);
+
+        /* A capped loop never runs on more slots than it was given. */
+        for (cap = 1; cap <= threads; ++cap)
+        {
+            for (i = 0; i < 10000; ++i) loop.p_mark_array[i] = 0;
+
+            loop.peak = 0;
+            scheduler_parallel_for(p_scheduler,
+                                   0,
+                                   10000,
+                                   1,
+                                   cap,
+                                   scheduler_test_mark_body,
+                                   &loop);
+            ASSERT(loop.peak >= 1 && loop.peak <= cap);
+
+            for (i = 0; i < 10000; ++i) ASSERT(loop.p_mark_array[i] == 1);
+        }
+
+        ASSERT(loop.errors == 0);
+        free(loop.p_busy_array);
+        scheduler_free(p_scheduler);
+    }
+
+    free(loop.p_mark_array);
+}
+
+typedef struct scheduler_test_fibonacci {
+    scheduler* p_scheduler;
+    size_t     n;
+    size_t     result;
+} scheduler_test_fibonacci;
+
+static void scheduler_test_fibonacci_task(void* p_argument)
+{
+    scheduler_test_fibonacci* p_task = p_argument;
+    scheduler_test_fibonacci  left;
+    scheduler_test_fibonacci  right;
+    scheduler_group           group;
+
+    if (p_task->n < 2)
+    {
+        p_task->result = p_task->n;
+        return;
+    }
+
+    left.p_scheduler  = p_task->p_scheduler;
+    left.n            = p_task->n - 1;
+    right.p_scheduler = p_task->p_scheduler;
+    right.n           = p_task->n - 2;
+
+    scheduler_group_init(&group);
+    scheduler_spawn(p_task->p_scheduler,
+                    &group,
+                    scheduler_test_fibonacci_task,
+                    &left);
+    scheduler_test_fibonacci_task(&right);
+    scheduler_wait(p_task->p_scheduler, &group);
+    p_task->result = left.result + right.result;
+}
+
+static void scheduler_test_fork_join()
+{
+    scheduler_test_fibonacci task;
+    scheduler*               p_scheduler;
+    size_t                   threads;
+
+    puts("        scheduler_test_fork_join()");
+
+    for (threads = 1; threads <= 4; threads += 3)
+    {
+        p_scheduler = scheduler_alloc(threads);
+
+        task.p_scheduler = p_scheduler;
+        task.n           = 20;
+        scheduler_run(p_scheduler, scheduler_test_fibonacci_task, &task);
+        ASSERT(task.result == 6765);
+
+        /* Outside of the scheduler the tasks run inline. */
+        task.n = 15;
+        scheduler_test_fibonacci_task(&task);
+        ASSERT(task.result == 610);
+
+        scheduler_free(p_scheduler);
+    }
+}
+
+typedef struct scheduler_test_nest {
+    scheduler* p_scheduler;
+    size_t     sum;
+} scheduler_test_nest;
+
+static void scheduler_test_inner_body(size_t chunk_begin,
+                                      size_t chunk_end,
+                                      size_t thread_index,
+                                      void* p_argument)
+{
+    size_t local = 0;
+    size_t i;
+
+    (void) thread_index;
+
+    for (i = chunk_begin; i < chunk_end; ++i) local += i;
+
+    PARALLEL_FETCH_ADD((size_t*) p_argument, local);
+}
+
+static void scheduler_test_outer_body(size_t chunk_begin,
+                                      size_t chunk_end,
+                                      size_t thread_index,
+                                      void* p_argument)
+{
+    scheduler_test_nest* p_nest = p_argument;
+    size_t               i;
+
+    (void) thread_index;
+
+    for (i = chunk_begin; i < chunk_end; ++i)
+    {
+        scheduler_parallel_for(p_nest->p_scheduler,
+                               0,
+                               i,
+                               0,
+                               0,
+                               scheduler_test_inner_body,
+                               &p_nest->sum);
+    }
+}
+
+static void scheduler_test_nested()
+{
+    scheduler_test_nest nest;
+    size_t              expected = 0;
+    size_t              i;
+
+    puts("        scheduler_test_nested()");
+
+    nest.p_scheduler = scheduler_alloc(3);
+    nest.sum         = 0;
+
+    scheduler_parallel_for(nest.p_scheduler,
+                           0,
+                           200,
+                           1,
+                           0,
+                           scheduler_test_outer_body,
+                           &nest);
+
+    for (i = 0; i < 200; ++i) expected += i * (i - 1) / 2;
+
+    ASSERT(nest.sum == expected);
+    scheduler_free(nest.p_scheduler);
+}
+
+typedef struct scheduler_test_client {
+    scheduler*          p_scheduler;
+    scheduler_test_loop loop;
+    size_t*             p_errors;
+} scheduler_test_client;
+
+static void scheduler_test_client_main(void* p_argument)
+{
+    scheduler_test_client* p_client = p_argument;
+    size_t                 round;
+    size_t                 i;
+
+    for (round = 0; round < 20; ++round)
+    {
+        for (i = 0; i < 5000; ++i) p_client->loop.p_mark_array[i] = 0;
+
+        scheduler_parallel_for(p_client->p_scheduler,
+                               0,
+                               5000,
+                               0,
+                               0,
+                               scheduler_test_mark_body,
+                               &p_client->loop);
+
+        for (i = 0; i < 5000; ++i)
+        {
+            if (p_client->loop.p_mark_array[i] != 1)
+            {
+                PARALLEL_FETCH_ADD(p_client->p_errors, 1);
+                break;
+            }
+        }
+    }
+}
+
+/*******************************************************************************
+* More outside threads than external slots enter at once. The busy flags of    *
+* the slots are shared, so two chunks running at once under the same index     *
+* would be caught.                                                             *
+*******************************************************************************/
+static void scheduler_test_clients()
+{
+    scheduler_test_client client_array[5];
+    parallel_thread       thread_array[5];
+    scheduler*            p_scheduler;
+    size_t*               p_busy_array;
+    size_t                errors = 0;
+    size_t                i;
+
+    puts("        scheduler_test_clients()");
+
+    p_scheduler  = scheduler_alloc(3);
+    p_busy_array = calloc(scheduler_slots(p_scheduler), sizeof(size_t));
+
+    for (i = 0; i < 5; ++i)
+    {
+        client_array[i].p_scheduler       = p_scheduler;
+        client_array[i].loop.p_mark_array = calloc(5000, sizeof(size_t));
+        client_array[i].loop.p_busy_array = p_busy_array;
+        client_array[i].loop.slots        = scheduler_slots(p_scheduler);
+        client_array[i].loop.errors       = 0;
+        client_array[i].loop.running      = 0;
+        client_array[i].loop.peak         = 0;
+        client_array[i].p_errors          = &errors;
+        ASSERT(parallel_thread_create(&thread_array[i],
+                                      scheduler_test_client_main,
+                                      &client_array[i]));
+    }
+
+    for (i = 0; i < 5; ++i)
+    {
+        parallel_thread_join(thread_array[i]);
+        ASSERT(client_array[i].loop.errors == 0);
+        free(client_array[i].loop.p_mark_array);
+    }
+
+    ASSERT(errors == 0);
+    ASSERT(scheduler_shared() != NULL);
+    ASSERT(scheduler_shared() == scheduler_shared());
+    free(p_busy_array);
+    scheduler_free(p_scheduler);
+}
+
+void scheduler_test()
+{
+    puts("    scheduler_test()");
+    scheduler_test_parallel_for();
+    scheduler_test_fork_join();
+    scheduler_test_nested();
+    scheduler_test_clients();
+}
@@ -0,0 +1,138 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "parallel.h"
+#include <stddef.h>
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+#ifdef _WIN32
+    typedef DWORD         scheduler_key;
+#else
+    typedef pthread_key_t scheduler_key;
+#endif
+
+    /***************************************************************************
+    * Counts the tasks spawned into it that have not finished yet.             *
+    ***************************************************************************/
+    typedef struct scheduler_group {
+        size_t pending;
+    } scheduler_group;
+
+    /***************************************************************************
+    * A Chase-Lev deque of tasks. The owner pushes and pops at 'bottom', the   *
+    * thieves take from 'top'. 'array' points to the current ring buffer,      *
+    * which the owner replaces with one twice as large when it fills up.       *
+    ***************************************************************************/
+    typedef struct scheduler_deque {
+        size_t top;
+        size_t bottom;
+        size_t array;
+    } scheduler_deque;
+
+    /***************************************************************************
+    * A work-stealing scheduler. Each slot owns a deque. The slots below       *
+    * 'external_slots' are lent to outside threads for the duration of a       *
+    * 'scheduler_run' or a 'scheduler_parallel_for', so that several threads   *
+    * can enter at once; the other slots belong to the worker threads. An idle *
+    * worker steals from random victims and sleeps after a while; a push wakes *
+    * it if anybody sleeps.                                                    *
+    ***************************************************************************/
+    typedef struct scheduler {
+        struct scheduler_worker* p_worker_array;
+        size_t                   slots;
+        size_t                   external_slots;
+        size_t                   threads;
+        size_t                   started;
+        size_t                   stopping;
+        size_t                   sleepers;
+        size_t                   wake_epoch;
+        parallel_mutex           mutex;
+        parallel_condition       wake_condition;
+        scheduler_key            key;
+    } scheduler;
+
+    /***************************************************************************
+    * Allocates a scheduler of 'threads' threads counting the one that enters  *
+    * it, or of the hardware concurrency if 'threads' is zero. Returns NULL if *
+    * the memory ran out.                                                      *
+    ***************************************************************************/
+    scheduler* scheduler_alloc(size_t threads);
+
+    /***************************************************************************
+    * Returns the scheduler shared by the library, creating it with the        *
+    * hardware concurrency on the first call. Returns NULL if it could not be  *
+    * created.                                                                 *
+    ***************************************************************************/
+    scheduler* scheduler_shared();
+
+    /***************************************************************************
+    * Returns the number of slots. The 'thread_index' passed to the loop       *
+    * bodies is below it.                                                      *
+    ***************************************************************************/
+    size_t scheduler_slots(scheduler* p_scheduler);
+
+    void scheduler_group_init(scheduler_group* p_group);
+
+    /***************************************************************************
+    * Runs 'p_function(p_argument)' on the scheduler with the calling thread   *
+    * taking part, and returns when it returns. The function may spawn tasks   *
+    * and must wait for them. If the calling thread is already a worker of the *
+    * scheduler, the function is just called; otherwise the thread waits for   *
+    * a free external slot.                                                    *
+    ***************************************************************************/
+    void scheduler_run(scheduler* p_scheduler,
+                       void (*p_function)(void* p_argument),
+                       void* p_argument);
+
+    /***************************************************************************
+    * Forks 'p_function(p_argument)' as a task of 'p_group'. Outside of the    *
+    * scheduler, the task runs at once. Returns false if the memory ran out,   *
+    * in which case the task ran at once as well.                              *
+    ***************************************************************************/
+    int scheduler_spawn(scheduler* p_scheduler,
+                        scheduler_group* p_group,
+                        void (*p_function)(void* p_argument),
+                        void* p_argument);
+
+    /***************************************************************************
+    * Joins the tasks of 'p_group', running other tasks meanwhile.             *
+    ***************************************************************************/
+    void scheduler_wait(scheduler* p_scheduler, scheduler_group* p_group);
+
+    /***************************************************************************
+    * Runs 'p_body' over chunks of ['begin', 'end') that together cover the    *
+    * range once. A worker keeps splitting its range in halves for the         *
+    * thieves only while its own deque is empty, and otherwise works through   *
+    * 'grain' elements at a time, so skewed ranges balance without splitting   *
+    * more than needed. At most 'threads' slots run the body at once, or all   *
+    * of them if 'threads' is zero. If 'grain' is zero, an eighth of the range *
+    * per thread is used. Chunks running at the same time get different        *
+    * 'thread_index' values. Returns when the whole range is processed.        *
+    ***************************************************************************/
+    void scheduler_parallel_for(scheduler* p_scheduler,
+                                size_t begin,
+                                size_t end,
+                                size_t grain,
+                                size_t threads,
+                                void (*p_body)(size_t chunk_begin,
+                                               size_t chunk_end,
+                                               size_t thread_index,
+                                               void* p_argument),
+                                void* p_argument);
+
+    /***************************************************************************
+    * Stops the workers and deallocates the scheduler. No thread may be in it. *
+    ***************************************************************************/
+    void scheduler_free(scheduler* p_scheduler);
+
+    /* Contains the unit tests. */
+    void scheduler_test();
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif  /* SCHEDULER_H */
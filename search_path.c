@@ -0,0 +1,315 @@
+#include "allocation.h"
+#include "my_assert.h"
+#include "search_path.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FALSE 0
+#define TRUE 1
+
+void search_path_init(search_path* p_path)
+{
+    p_path->p_node_array = NULL;
+    p_path->nodes        = 0;
+    p_path->capacity     = 0;
+}
+
+int search_path_resize(search_path* p_path, size_t nodes)
+{
+    void** p_node_array;
+
+    if (nodes > p_path->capacity)
+    {
+        p_node_array = allocation_alloc(ALLOCATION_SEARCH_PATH,
+                                        sizeof(void*) * nodes);
+
+        if (!p_node_array)
+        {
+            p_path->nodes = 0;
+            return FALSE;
+        }
+
+        /* The nodes stored so far are kept. */
+        if (p_path->nodes > 0)
+        {
+            memcpy(p_node_array,
+                   p_path->p_node_array,
+                   sizeof(void*) * p_path->nodes);
+        }
+
+        allocation_free(ALLOCATION_SEARCH_PATH,
+                        p_path->p_node_array,
+                        sizeof(void*) * p_path->capacity);
+        p_path->p_node_array = p_node_array;
+        p_path->capacity     = nodes;
+    }
+
+    p_path->nodes = nodes;
+    return TRUE;
+}
+
+int search_path_trace(search_path* p_path,
+                      void* p_target,
+                      size_t hops,
+                      unordered_map* p_parent_map)
+{
+    void*  p_node = p_target;
+    size_t i;
+
+    if (!search_path_resize(p_path, hops + 1)) return FALSE;
+
+    for (i = hops + 1; i > 0; --i)
+    {
+        p_path->p_node_array[i - 1] = p_node;
+        p_node = unordered_map_get(p_parent_map, p_node);
+    }
+
+    return TRUE;
+}
+
+int search_path_trace_bidirectional(search_path* p_path,
+                                    void* p_touch,
+                                    size_t forward_hops,
+                                    size_t backward_hops,
+                                    unordered_map* p_forward_map,
+                                    unordered_map* p_backward_map)
+{
+    void*  p_node;
+    size_t i;
+
+    if (!search_path_trace(p_path, p_touch, forward_hops, p_forward_map)
+        || !search_path_resize(p_path, forward_hops + backward_hops + 1))
+    {
+        return FALSE;
+    }
+
+    p_node = p_touch;
+
+    for (i = forward_hops + 1; i < p_path->nodes; ++i)
+    {
+        p_node = unordered_map_get(p_backward_map, p_node);
+        p_path->p_node_array[i] = p_node;
+    }
+
+    return TRUE;
+}
+
+size_t search_path_hops(search_path* p_path)
+{
+    return p_path->nodes > 0 ? p_path->nodes - 1 : SEARCH_PATH_UNREACHABLE;
+}
+
+list* search_path_to_list(search_path* p_path)
+{
+    list*  p_list = list_alloc(p_path->nodes > 0 ? p_path->nodes : 1);
+    size_t i;
+
+    if (!p_list) return NULL;
+
+    for (i = 0; i < p_path->nodes; ++i)
+    {
+        if (!list_push_back(p_list, p_path->p_node_array[i]))
+        {
+            list_free(p_list);
+            return NULL;
+        }
+    }
+
+    return p_list;
+}
+
+void search_path_destroy(search_path* p_path)
+{
+    allocation_free(ALLOCATION_SEARCH_PATH,
+                    p_path->p_node_array,
+                    sizeof(void*) * p_path->capacity);
+    search_path_init(p_path);
+}
+
+size_t search_path_memory_usage(search_path* p_path)
+{
+    return p_path ? sizeof(void*) * p_path->capacity : 0;
+}
+
+int search_context_init(search_context* p_context,
+                        size_t (*hash_function)(void*),
+                        int (*equals_function)(void*, void*))
+{
+    p_context->p_forward_queue  = queue_alloc();
+    p_context->p_backward_queue = queue_alloc();
+    p_context->p_forward_map    = unordered_map_alloc(10,
+                                                      1.0f,
+                                                      hash_function,
+                                                      equals_function);
+    p_context->p_backward_map   = unordered_map_alloc(10,
+                                                      1.0f,
+                                                      hash_function,
+                                                      equals_function);
+    p_context->hash_function    = hash_function;
+    p_context->equals_function  = equals_function;
+
+    if (!p_context->p_forward_queue
+        || !p_context->p_backward_queue
+        || !p_context->p_forward_map
+        || !p_context->p_backward_map)
+    {
+        search_context_destroy(p_context);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+void search_context_clear(search_context* p_context)
+{
+    queue_clear(p_context->p_forward_queue);
+    queue_clear(p_context->p_backward_queue);
+    unordered_map_clear(p_context->p_forward_map);
+    unordered_map_clear(p_context->p_backward_map);
+}
+
+void search_context_destroy(search_context* p_context)
+{
+    queue_free(p_context->p_forward_queue);
+    queue_free(p_context->p_backward_queue);
+
+    if (p_context->p_forward_map)
+    {
+        unordered_map_free(&p_context->p_forward_map);
+    }
+
+    if (p_context->p_backward_map)
+    {
+        unordered_map_free(&p_context->p_backward_map);
+    }
+
+    p_context->p_forward_queue  = NULL;
+    p_context->p_backward_queue = NULL;
+    p_context->p_forward_map    = NULL;
+    p_context->p_backward_map   = NULL;
+}
+
+size_t search_context_memory_usage(search_context* p_context)
+{
+    return queue_memory_usage(p_context->p_forward_queue)
+         + queue_memory_usage(p_context->p_backward_queue)
+         + unordered_map_memory_usage(p_context->p_forward_map)
+         + unordered_map_memory_usage(p_context->p_backward_map);
+}
+
+static size_t search_path_test_hash(void* p_key)
+{
+    return (size_t) p_key;
+}
+
+static int search_path_test_equals(void* p_a, void* p_b)
+{
+    return p_a == p_b;
+}
+
+static void search_path_test_trace()
+{
+    unordered_map* p_forward_map = unordered_map_alloc(
+                                       10,
+                                       1.0f,
+                                       search_path_test_hash,
+                                       search_path_test_equals);
+    unordered_map* p_backward_map = unordered_map_alloc(
+                                        10,
+                                        1.0f,
+                                        search_path_test_hash,
+                                        search_path_test_equals);
+    search_path    path;
+    list*          p_list;
+    size_t         i;
+
+    puts("        search_path_test_trace()");
+
+    /* 1 -> 2 -> 3 -> 4 forward, 4 -> 5 -> 6 backward. */
+    unordered_map_put(p_forward_map, (void*) 1, NULL);
+
+    for (i = 2; i <= 4; ++i)
+    {
+        unordered_map_put(p_forward_map, (void*) i, (void*) (i - 1));
+    }
+
+    unordered_map_put(p_backward_map, (void*) 6, NULL);
+    unordered_map_put(p_backward_map, (void*) 5, (void*) 6);
+    unordered_map_put(p_backward_map, (void*) 4, (void*) 5);
+
+    search_path_init(&path);
+    ASSERT(search_path_hops(&path) == SEARCH_PATH_UNREACHABLE);
+
+    ASSERT(search_path_trace(&path, (void*) 4, 3, p_forward_map));
+    ASSERT(search_path_hops(&path) == 3);
+
+    for (i = 0; i < 4; ++i) ASSERT(path.p_node_array[i] == (void*) (i + 1));
+
+    /* The array is reused for the longer path. */
+    ASSERT(search_path_trace_bidirectional(&path,
+                                           (void*) 4,
+                                           3,
+                                           2,
+                                           p_forward_map,
+                                           p_backward_map));
+    ASSERT(search_path_hops(&path) == 5);
+
+    for (i = 0; i < 6; ++i) ASSERT(path.p_node_array[i] == (void*) (i + 1));
+
+    p_list = search_path_to_list(&path);
+    ASSERT(list_size(p_list) == 6);
+    ASSERT(list_get(p_list, 5) == (void*) 6);
+    list_free(p_list);
+
+    ASSERT(search_path_trace(&path, (void*) 1, 0, p_forward_map));
+    ASSERT(path.nodes == 1 && path.capacity == 6);
+    ASSERT(path.p_node_array[0] == (void*) 1);
+    ASSERT(search_path_memory_usage(&path) == 6 * sizeof(void*));
+
+    search_path_destroy(&path);
+    ASSERT(path.p_node_array == NULL && path.nodes == 0);
+    ASSERT(search_path_memory_usage(&path) == 0);
+    unordered_map_free(&p_forward_map);
+    unordered_map_free(&p_backward_map);
+}
+
+static void search_path_test_context()
+{
+    search_context context;
+    size_t         empty_bytes;
+    size_t         i;
+
+    puts("        search_path_test_context()");
+
+    ASSERT(search_context_init(&context,
+                               search_path_test_hash,
+                               search_path_test_equals));
+    empty_bytes = search_context_memory_usage(&context);
+
+    for (i = 1; i <= 100; ++i)
+    {
+        queue_push_back(context.p_forward_queue, (void*) i);
+        unordered_map_put(context.p_backward_map, (void*) i, NULL);
+    }
+
+    ASSERT(search_context_memory_usage(&context) > empty_bytes);
+
+    /* The tables stay grown, the entries and the queue nodes go. */
+    search_context_clear(&context);
+    ASSERT(queue_size(context.p_forward_queue) == 0);
+    ASSERT(unordered_map_size(context.p_backward_map) == 0);
+    ASSERT(!unordered_map_contains_key(context.p_backward_map, (void*) 1));
+    ASSERT(search_context_memory_usage(&context) > empty_bytes);
+
+    search_context_destroy(&context);
+    ASSERT(context.p_forward_map == NULL);
+    ASSERT(search_context_memory_usage(&context) == 0);
+}
+
+void search_path_test()
+{
+    puts("    search_path_test()");
+    search_path_test_trace();
+    search_path_test_context();
+}
@@ -0,0 +1,129 @@
+#ifndef SEARCH_PATH_H
+#define SEARCH_PATH_H
+
+#include "list.h"
+#include "queue.h"
+#include "unordered_map.h"
+#include <stddef.h>
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * The hop count of a path that was not found.                              *
+    ***************************************************************************/
+#define SEARCH_PATH_UNREACHABLE ((size_t) -1)
+
+    /***************************************************************************
+    * A path as a contiguous array of 'nodes' nodes, from the source to the    *
+    * target. The searches know the hop count before they trace the path, so   *
+    * the array is sized once and filled from the back. The array is kept      *
+    * between searches; 'capacity' is its size.                                *
+    ***************************************************************************/
+    typedef struct search_path {
+        void** p_node_array;
+        size_t nodes;
+        size_t capacity;
+    } search_path;
+
+    /***************************************************************************
+    * Initializes an empty path.                                               *
+    ***************************************************************************/
+    void search_path_init(search_path* p_path);
+
+    /***************************************************************************
+    * Makes room for 'nodes' nodes and sets the length to it. Returns false if *
+    * the memory ran out, leaving the path empty.                              *
+    ***************************************************************************/
+    int search_path_resize(search_path* p_path, size_t nodes);
+
+    /***************************************************************************
+    * Stores the path of 'hops' hops ending at 'p_target' by following         *
+    * 'p_parent_map', in which the source maps to NULL. Returns false if the   *
+    * memory ran out.                                                          *
+    ***************************************************************************/
+    int search_path_trace(search_path* p_path,
+                          void* p_target,
+                          size_t hops,
+                          unordered_map* p_parent_map);
+
+    /***************************************************************************
+    * Stores the path through 'p_touch', which is 'forward_hops' hops from the *
+    * source along 'p_forward_map' and 'backward_hops' hops from the target    *
+    * along 'p_backward_map'. Returns false if the memory ran out.             *
+    ***************************************************************************/
+    int search_path_trace_bidirectional(search_path* p_path,
+                                        void* p_touch,
+                                        size_t forward_hops,
+                                        size_t backward_hops,
+                                        unordered_map* p_forward_map,
+                                        unordered_map* p_backward_map);
+
+    /***************************************************************************
+    * Returns the hop count, or SEARCH_PATH_UNREACHABLE if the path is empty.  *
+    ***************************************************************************/
+    size_t search_path_hops(search_path* p_path);
+
+    /***************************************************************************
+    * Copies the path into a new list. Returns NULL if the memory ran out.     *
+    ***************************************************************************/
+    list* search_path_to_list(search_path* p_path);
+
+    /***************************************************************************
+    * Releases the array of the path.                                          *
+    ***************************************************************************/
+    void search_path_destroy(search_path* p_path);
+
+    /***************************************************************************
+    * Returns the number of bytes allocated by the array of the path.          *
+    ***************************************************************************/
+    size_t search_path_memory_usage(search_path* p_path);
+
+    /***************************************************************************
+    * The queues and parent maps of a search, kept between searches so that a  *
+    * thread running many of them allocates them once. The forward members     *
+    * serve a search from the source and the backward ones the search from the *
+    * target. The searches that take a context leave it empty.                 *
+    ***************************************************************************/
+    typedef struct search_context {
+        queue*         p_forward_queue;
+        queue*         p_backward_queue;
+        unordered_map* p_forward_map;
+        unordered_map* p_backward_map;
+        size_t       (*hash_function)(void*);
+        int          (*equals_function)(void*, void*);
+    } search_context;
+
+    /***************************************************************************
+    * Allocates the queues and the maps, which hash and compare the nodes with *
+    * the given functions. Returns false if the memory ran out, leaving        *
+    * nothing allocated.                                                       *
+    ***************************************************************************/
+    int search_context_init(search_context* p_context,
+                            size_t (*hash_function)(void*),
+                            int (*equals_function)(void*, void*));
+
+    /***************************************************************************
+    * Empties the queues and the maps, keeping their tables.                   *
+    ***************************************************************************/
+    void search_context_clear(search_context* p_context);
+
+    /***************************************************************************
+    * Releases the queues and the maps.                                        *
+    ***************************************************************************/
+    void search_context_destroy(search_context* p_context);
+
+    /***************************************************************************
+    * Returns the number of bytes allocated by the queues and the maps.        *
+    ***************************************************************************/
+    size_t search_context_memory_usage(search_context* p_context);
+
+    /* Contains the unit tests. */
+    void search_path_test();
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif  /* SEARCH_PATH_H */
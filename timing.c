@@ -0,0 +1,214 @@
+/**************************************
+* Exposes clock_gettime under C89.    *
+**************************************/
+#define _POSIX_C_SOURCE 200112L
+
+#include "my_assert.h"
+#include "timing.h"
+#include <stdlib.h>
+#include <time.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define TIMING_RDTSC() ((timing_ticks) __rdtsc())
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define TIMING_RDTSC() ((timing_ticks) __builtin_ia32_rdtsc())
+#endif
+
+#define FALSE 0
+#define TRUE 1
+
+timing_ticks timing_now_ns()
+{
+#ifdef _WIN32
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+
+    /* Split the conversion to avoid overflowing the 64-bit product. */
+    return (timing_ticks)(counter.QuadPart / frequency.QuadPart) * 1000000000
+         + (timing_ticks)(counter.QuadPart % frequency.QuadPart) * 1000000000
+         / (timing_ticks) frequency.QuadPart;
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (timing_ticks) ts.tv_sec * 1000000000 + (timing_ticks) ts.tv_nsec;
+#endif
+}
+
+int timing_has_rdtsc()
+{
+#ifdef TIMING_RDTSC
+    return TRUE;
+#else
+    return FALSE;
+#endif
+}
+
+timing_ticks timing_rdtsc()
+{
+#ifdef TIMING_RDTSC
+    return TIMING_RDTSC();
+#else
+    return timing_now_ns();
+#endif
+}
+
+double timing_rdtsc_ticks_per_ns(size_t milliseconds)
+{
+    timing_ticks start_ns = timing_now_ns();
+    timing_ticks start_ticks = timing_rdtsc();
+    timing_ticks end_ns;
+    timing_ticks end_ticks;
+
+    do
+    {
+        end_ns = timing_now_ns();
+    }
+    while (end_ns - start_ns < (timing_ticks) milliseconds * 1000000);
+
+    end_ticks = timing_rdtsc();
+
+    return end_ns == start_ns ?
+           1.0 :
+           (double)(end_ticks - start_ticks) / (double)(end_ns - start_ns);
+}
+
+double timing_elapsed_ms(timing_ticks start_ns, timing_ticks end_ns)
+{
+    return (double)(end_ns - start_ns) / 1e6;
+}
+
+void search_stats_init(search_stats* p_stats)
+{
+    if (!p_stats) return;
+
+    p_stats->p_forward_frontier_array = NULL;
+    p_stats->forward_capacity = 0;
+    p_stats->p_backward_frontier_array = NULL;
+    p_stats->backward_capacity = 0;
+    search_stats_reset(p_stats);
+}
+
+void search_stats_reset(search_stats* p_stats)
+{
+    if (!p_stats) return;
+
+    p_stats->nodes_popped = 0;
+    p_stats->arcs_scanned = 0;
+    p_stats->hash_probes = 0;
+    p_stats->allocations = 0;
+    p_stats->forward_levels = 0;
+    p_stats->backward_levels = 0;
+    p_stats->peak_memory_bytes = 0;
+    p_stats->duration_ns = 0;
+}
+
+int search_stats_add_level(search_stats* p_stats,
+                           int forward,
+                           size_t frontier_size)
+{
+    size_t** pp_array;
+    size_t*  p_levels;
+    size_t*  p_capacity;
+    size_t*  p_new_array;
+    size_t   new_capacity;
+
+    if (!p_stats) return FALSE;
+
+    pp_array   = forward ? &p_stats->p_forward_frontier_array
+                         : &p_stats->p_backward_frontier_array;
+    p_levels   = forward ? &p_stats->forward_levels
+                         : &p_stats->backward_levels;
+    p_capacity = forward ? &p_stats->forward_capacity
+                         : &p_stats->backward_capacity;
+
+    if (*p_levels == *p_capacity)
+    {
+        new_capacity = *p_capacity ? 2 * *p_capacity : 16;
+        p_new_array = realloc(*pp_array, sizeof(size_t) * new_capacity);
+
+        if (!p_new_array) return FALSE;
+
+        *pp_array = p_new_array;
+        *p_capacity = new_capacity;
+    }
+
+    (*pp_array)[(*p_levels)++] = frontier_size;
+    return TRUE;
+}
+
+void search_stats_destroy(search_stats* p_stats)
+{
+    if (!p_stats) return;
+
+    free(p_stats->p_forward_frontier_array);
+    free(p_stats->p_backward_frontier_array);
+    search_stats_init(p_stats);
+}
+
+static void timing_test_clock()
+{
+    timing_ticks a;
+    timing_ticks b;
+    timing_ticks c;
+    timing_ticks d;
+
+    puts("        timing_test_clock()");
+
+    a = timing_now_ns();
+    b = timing_now_ns();
+    c = timing_rdtsc();
+    d = timing_rdtsc();
+
+    ASSERT(a <= b);
+    ASSERT(timing_elapsed_ms(a, a + 2000000) == 2.0);
+    ASSERT(c <= d || timing_has_rdtsc());
+    ASSERT(timing_rdtsc_ticks_per_ns(1) > 0.0);
+}
+
+static void timing_test_stats()
+{
+    search_stats stats;
+    size_t       i;
+
+    puts("        timing_test_stats()");
+
+    search_stats_init(&stats);
+    ASSERT(stats.nodes_popped == 0);
+    ASSERT(stats.forward_levels == 0);
+
+    for (i = 0; i < 40; ++i)
+    {
+        ASSERT(search_stats_add_level(&stats, TRUE, i));
+    }
+
+    ASSERT(search_stats_add_level(&stats, FALSE, 7));
+    ASSERT(stats.forward_levels == 40);
+    ASSERT(stats.p_forward_frontier_array[39] == 39);
+    ASSERT(stats.backward_levels == 1);
+    ASSERT(stats.p_backward_frontier_array[0] == 7);
+
+    stats.arcs_scanned = 5;
+    search_stats_reset(&stats);
+    ASSERT(stats.arcs_scanned == 0);
+    ASSERT(stats.forward_levels == 0);
+    ASSERT(stats.forward_capacity >= 40);
+
+    search_stats_destroy(&stats);
+    ASSERT(stats.p_forward_frontier_array == NULL);
+}
+
+void timing_test()
+{
+    puts("    timing_test()");
+    timing_test_clock();
+    timing_test_stats();
+}
@@ -0,0 +1,100 @@
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <stddef.h>
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * An unsigned 64-bit count of nanoseconds or time stamp counter ticks.     *
+    ***************************************************************************/
+#if defined(_MSC_VER)
+    typedef unsigned __int64 timing_ticks;
+#elif defined(__GNUC__)
+    __extension__ typedef unsigned long long timing_ticks;
+#else
+    typedef unsigned long timing_ticks;
+#endif
+
+    /***************************************************************************
+    * Counts where the time of one search goes. The frontier arrays hold the   *
+    * number of nodes in the queue at the start of each level, separately for  *
+    * the forward and the backward direction. 'peak_memory_bytes' is the most  *
+    * memory the containers of the search held at once.                        *
+    ***************************************************************************/
+    typedef struct search_stats {
+        size_t       nodes_popped;
+        size_t       arcs_scanned;
+        size_t       hash_probes;
+        size_t       allocations;
+        size_t*      p_forward_frontier_array;
+        size_t       forward_levels;
+        size_t       forward_capacity;
+        size_t*      p_backward_frontier_array;
+        size_t       backward_levels;
+        size_t       backward_capacity;
+        size_t       peak_memory_bytes;
+        timing_ticks duration_ns;
+    } search_stats;
+
+    /***************************************************************************
+    * Returns the time of a monotonic wall clock in nanoseconds.               *
+    ***************************************************************************/
+    timing_ticks timing_now_ns();
+
+    /***************************************************************************
+    * Returns a positive value if 'timing_rdtsc' reads the CPU time stamp      *
+    * counter, and zero if it falls back to 'timing_now_ns'.                   *
+    ***************************************************************************/
+    int timing_has_rdtsc();
+
+    /***************************************************************************
+    * Reads the time stamp counter, which is cheaper than the clock but counts *
+    * ticks instead of nanoseconds.                                            *
+    ***************************************************************************/
+    timing_ticks timing_rdtsc();
+
+    /***************************************************************************
+    * Measures the number of 'timing_rdtsc' ticks per nanosecond over about    *
+    * 'milliseconds' of wall clock time.                                       *
+    ***************************************************************************/
+    double timing_rdtsc_ticks_per_ns(size_t milliseconds);
+
+    /***************************************************************************
+    * Returns the time between the two readings in milliseconds.               *
+    ***************************************************************************/
+    double timing_elapsed_ms(timing_ticks start_ns, timing_ticks end_ns);
+
+    /***************************************************************************
+    * Initializes the statistics to zero.                                      *
+    ***************************************************************************/
+    void search_stats_init(search_stats* p_stats);
+
+    /***************************************************************************
+    * Zeroes the counters but keeps the memory of the frontier arrays.         *
+    ***************************************************************************/
+    void search_stats_reset(search_stats* p_stats);
+
+    /***************************************************************************
+    * Appends the size of a new level's frontier. 'forward' selects the        *
+    * direction. Returns false if the memory ran out.                          *
+    ***************************************************************************/
+    int search_stats_add_level(search_stats* p_stats,
+                               int forward,
+                               size_t frontier_size);
+
+    /***************************************************************************
+    * Releases the frontier arrays.                                            *
+    ***************************************************************************/
+    void search_stats_destroy(search_stats* p_stats);
+
+    /* Contains the unit tests. */
+    void timing_test();
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif  /* TIMING_H */
@@ -1,3 +1,4 @@
+#include "allocation.h"
 #include "my_assert.h"
 #include "unordered_map.h"
 #include <stdbool.h>
@@ -9,7 +10,8 @@
 
 static unordered_map_entry* unordered_map_entry_alloc(void* key, void* value)
 {
-    unordered_map_entry* entry = malloc(sizeof(*entry));
+    unordered_map_entry* entry =
+        allocation_alloc(ALLOCATION_UNORDERED_MAP, sizeof(*entry));
 
     if (!entry)
     {
@@ -83,7 +85,8 @@ int unordered_map_init(unordered_map* p_memory,
     p_memory->size = 0;
     p_memory->mod_count = 0;
     p_memory->table = 
-        calloc(p_memory->table_capacity, 
+        allocation_calloc(ALLOCATION_UNORDERED_MAP,
+                          p_memory->table_capacity, 
                sizeof(p_memory->table[0]));
 
     if (!p_memory->table)
@@ -103,7 +106,8 @@ unordered_map* unordered_map_alloc(size_t initial_capacity,
                                    size_t (*p_hash_function)(void*),
                                    int (*p_equals_function)(void*, void*))
 {
-    unordered_map* map = malloc(sizeof(*map));
+    unordered_map* map = allocation_alloc(ALLOCATION_UNORDERED_MAP,
+                                         sizeof(*map));
     int initialization_succeeded;
 
     if (!map || !p_hash_function || !p_equals_function)
@@ -120,7 +124,7 @@ unordered_map* unordered_map_alloc(size_t initial_capacity,
 
     if (!initialization_succeeded)
     {
-        free(map);
+        allocation_free(ALLOCATION_UNORDERED_MAP, map, sizeof(*map));
         return NULL;
     }
 
@@ -142,7 +146,9 @@ static void ensure_capacity(unordered_map* map)
 
     new_capacity = map->table_capacity << 1;
     new_mask = new_capacity - 1;
-    new_table = calloc(new_capacity, sizeof(unordered_map_entry*));
+    new_table = allocation_calloc(ALLOCATION_UNORDERED_MAP,
+                                  new_capacity,
+                                  sizeof(unordered_map_entry*));
 
     if (!new_table)
     {
@@ -157,7 +163,9 @@ static void ensure_capacity(unordered_map* map)
         new_table[index] = entry;
     }
 
-    free(map->table);
+    allocation_free(ALLOCATION_UNORDERED_MAP,
+                    map->table,
+                    sizeof(unordered_map_entry*) * map->table_capacity);
 
     map->table          = new_table;
     map->table_capacity = new_capacity;
@@ -366,7 +374,9 @@ void* unordered_map_remove(unordered_map* map, void* key)
             unlink_from_successor_entry(map, current_entry);
             map->size--;
             map->mod_count++;
-            free(current_entry);
+            allocation_free(ALLOCATION_UNORDERED_MAP,
+                            current_entry,
+                            sizeof(unordered_map_entry));
             return value;
         }
     }
@@ -391,7 +401,7 @@ void unordered_map_clear(unordered_map* map)
     {
         index = entry->key_hash_value & map->mask;
         next_entry = entry->next;
-        free(entry);
+        allocation_free(ALLOCATION_UNORDERED_MAP, entry, sizeof(*entry));
         entry = next_entry;
         map->table[index] = NULL;
     }
@@ -467,7 +477,9 @@ void unordered_map_destroy(unordered_map* map)
     }
 
     unordered_map_clear(map);
-    free(map->table);
+    allocation_free(ALLOCATION_UNORDERED_MAP,
+                    map->table,
+                    sizeof(unordered_map_entry*) * map->table_capacity);
     map->table = NULL;
 }
 
@@ -479,10 +491,22 @@ void unordered_map_free(unordered_map** p_map)
     }
 
     unordered_map_destroy(*p_map);
-    free(*p_map);
+    allocation_free(ALLOCATION_UNORDERED_MAP, *p_map, sizeof(**p_map));
     *p_map = NULL;
 }
 
+size_t unordered_map_memory_usage(unordered_map* map)
+{
+    if (!map)
+    {
+        return 0;
+    }
+
+    return sizeof(*map)
+         + sizeof(map->table[0]) * (map->table ? map->table_capacity : 0)
+         + sizeof(*map->head) * map->size;
+}
+
 void unordered_map_iterator_init(unordered_map* map,
                                  unordered_map_iterator* iterator)
 {
@@ -503,7 +527,7 @@ unordered_map_iterator_alloc(unordered_map* map)
     }
 
     iterator = (unordered_map_iterator*)
-                malloc(sizeof(*iterator));
+                allocation_alloc(ALLOCATION_UNORDERED_MAP, sizeof(*iterator));
 
     if (!iterator)
     {
@@ -575,7 +599,7 @@ void unordered_map_iterator_free(unordered_map_iterator* iterator)
 
     iterator->map = NULL;
     iterator->next_entry = NULL;
-    free(iterator);
+    allocation_free(ALLOCATION_UNORDERED_MAP, iterator, sizeof(*iterator));
 }
 
 static int int_equals(void* a, void* b)
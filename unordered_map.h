@@ -104,6 +104,12 @@ extern "C" {
     ***************************************************************************/
     void unordered_map_free(unordered_map** map);
 
+    /***************************************************************************
+    * Returns the number of bytes allocated by the map, counting the map       *
+    * structure itself.                                                        *
+    ***************************************************************************/
+    size_t unordered_map_memory_usage(unordered_map* map);
+
     /***************************************************************************
     * Destroys but does not deallocate the map.                                *
     ***************************************************************************/
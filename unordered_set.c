@@ -1,3 +1,4 @@
+#include "allocation.h"
 #include "my_assert.h"
 #include "unordered_set.h"
 #include <stdint.h>
@@ -9,7 +10,8 @@
 
 static unordered_set_entry* unordered_set_entry_alloc(void* key)
 {
-    unordered_set_entry* entry = malloc(sizeof(*entry));
+    unordered_set_entry* entry =
+        allocation_alloc(ALLOCATION_UNORDERED_SET, sizeof(*entry));
 
     if (!entry)
     {
@@ -79,7 +81,8 @@ int unordered_set_init(unordered_set* p_memory,
     p_memory->size            = 0;
     p_memory->mod_count       = 0;
     p_memory->table           = 
-        calloc(p_memory->table_capacity,
+        allocation_calloc(ALLOCATION_UNORDERED_SET,
+                          p_memory->table_capacity,
                sizeof(p_memory->table[0]));
 
     if (!p_memory->table)
@@ -99,7 +102,8 @@ unordered_set* unordered_set_alloc(size_t initial_capacity,
                                    size_t(*p_hash_function)(void*),
                                    int (*p_equals_function)(void*, void*))
 {
-    unordered_set* set = malloc(sizeof(*set));
+    unordered_set* set = allocation_alloc(ALLOCATION_UNORDERED_SET,
+                                         sizeof(*set));
     int initialization_succeeded;
 
     if (!set || !p_hash_function || !p_equals_function)
@@ -116,33 +120,28 @@ unordered_set* unordered_set_alloc(size_t initial_capacity,
 
     if (!initialization_succeeded)
     {
-        free(set);
+        allocation_free(ALLOCATION_UNORDERED_SET, set, sizeof(*set));
         return NULL;
     }
 
     return set;
 }
 
-static void ensure_capacity(unordered_set* set)
+static int rehash(unordered_set* set, size_t new_capacity)
 {
-    size_t new_capacity;
     size_t new_mask;
     size_t index;
     unordered_set_entry*  entry;
     unordered_set_entry** new_table;
 
-    if (set->size < set->max_allowed_size)
-    {
-        return;
-    }
-
-    new_capacity = set->table_capacity << 1;
     new_mask = new_capacity - 1;
-    new_table = calloc(new_capacity, sizeof(unordered_set_entry*));
+    new_table = allocation_calloc(ALLOCATION_UNORDERED_SET,
+                                  new_capacity,
+                                  sizeof(unordered_set_entry*));
 
     if (!new_table)
     {
-        return;
+        return FALSE;
     }
 
     /* Rehash the entries. */
@@ -153,12 +152,49 @@ static void ensure_capacity(unordered_set* set)
         new_table[index] = entry;
     }
 
-    free(set->table);
+    allocation_free(ALLOCATION_UNORDERED_SET,
+                    set->table,
+                    sizeof(unordered_set_entry*) * set->table_capacity);
 
     set->table          = new_table;
     set->table_capacity = new_capacity;
     set->mask           = new_mask;
     set->max_allowed_size = (size_t)(new_capacity * set->load_factor);
+    return TRUE;
+}
+
+static void ensure_capacity(unordered_set* set)
+{
+    if (set->size < set->max_allowed_size)
+    {
+        return;
+    }
+
+    rehash(set, set->table_capacity << 1);
+}
+
+int unordered_set_reserve(unordered_set* set, size_t size)
+{
+    size_t new_capacity;
+
+    if (!set)
+    {
+        return FALSE;
+    }
+
+    if (size < set->max_allowed_size)
+    {
+        return TRUE;
+    }
+
+    new_capacity = set->table_capacity;
+
+    while ((size_t)(new_capacity * set->load_factor) <= size)
+    {
+        new_capacity <<= 1;
+    }
+
+    return rehash(set, new_capacity);
 }
 
 int unordered_set_add(unordered_set* set, void* key)
@@ -340,7 +376,9 @@ int unordered_set_remove(unordered_set* set, void* key)
             
             set->size--;
             set->mod_count++;
-            free(current_entry);
+            allocation_free(ALLOCATION_UNORDERED_SET,
+                            current_entry,
+                            sizeof(unordered_set_entry));
             return TRUE;
         }
     }
@@ -365,7 +403,7 @@ void unordered_set_clear(unordered_set* set)
     {
         index = entry->hash_value & set->mask;
         next_entry = entry->next;
-        free(entry);
+        allocation_free(ALLOCATION_UNORDERED_SET, entry, sizeof(*entry));
         entry = next_entry;
         set->table[index] = NULL;
     }
@@ -444,17 +482,31 @@ void unordered_set_destroy(unordered_set* set)
     }
 
     unordered_set_clear(set);
-    free(set->table);
+    allocation_free(ALLOCATION_UNORDERED_SET,
+                    set->table,
+                    sizeof(unordered_set_entry*) * set->table_capacity);
     set->table = NULL;
 }
 
 void unordered_set_free(unordered_set** p_set)
 {
     unordered_set_destroy(*p_set);
-    free(*p_set);
+    allocation_free(ALLOCATION_UNORDERED_SET, *p_set, sizeof(**p_set));
     *p_set = NULL;
 }
 
+size_t unordered_set_memory_usage(unordered_set* set)
+{
+    if (!set)
+    {
+        return 0;
+    }
+
+    return sizeof(*set)
+         + sizeof(set->table[0]) * (set->table ? set->table_capacity : 0)
+         + sizeof(*set->head) * set->size;
+}
+
 void unordered_set_iterator_init(unordered_set* set, 
                                  unordered_set_iterator* iterator)
 {
@@ -468,7 +520,8 @@ unordered_set_iterator*
 unordered_set_iterator_alloc(unordered_set* set)
 {
     unordered_set_iterator* iterator =
-        (unordered_set_iterator*)malloc(sizeof(*iterator));
+        (unordered_set_iterator*)
+        allocation_alloc(ALLOCATION_UNORDERED_SET, sizeof(*iterator));
 
     if (!iterator)
     {
@@ -538,7 +591,7 @@ void unordered_set_iterator_free(unordered_set_iterator* iterator)
 
     iterator->set = NULL;
     iterator->next_entry = NULL;
-    free(iterator);
+    allocation_free(ALLOCATION_UNORDERED_SET, iterator, sizeof(*iterator));
 }
 
 static int int_equals(void* a, void* b)
@@ -646,6 +699,38 @@ static void unordered_set_test_add()
     ASSERT(!unordered_set_add(set, "repeat"));
 }
 
+static void unordered_set_test_reserve()
+{
+    unordered_set* set = unordered_set_alloc(1,
+                                             0.75f,
+                                             int_hash_function,
+                                             int_equals);
+    size_t capacity;
+    int i;
+
+    puts("        unordered_set_test_reserve()");
+
+    ASSERT(unordered_set_add(set, (void*)(intptr_t) 1));
+    ASSERT(unordered_set_reserve(set, 100));
+    capacity = set->table_capacity;
+    ASSERT(set->max_allowed_size > 100);
+
+    /* The reserved room takes the elements without another rehash. */
+    for (i = 2; i <= 100; i++)
+    {
+        ASSERT(unordered_set_add(set, (void*)(intptr_t) i));
+    }
+
+    ASSERT(set->table_capacity == capacity);
+    ASSERT(unordered_set_contains(set, (void*)(intptr_t) 1));
+    ASSERT(unordered_set_size(set) == 100);
+    ASSERT(unordered_set_is_healthy(set));
+    ASSERT(unordered_set_reserve(set, 10));
+    ASSERT(set->table_capacity == capacity);
+
+    unordered_set_free(&set);
+}
+
 static void unordered_set_test_contains()
 {
     unordered_set* set = unordered_set_alloc(3,
@@ -794,6 +879,7 @@ void unordered_set_test()
     debug_mask();
     unordered_set_test_debug_clear();
     unordered_set_test_add();
+    unordered_set_test_reserve();
     unordered_set_test_contains();
     unordered_set_test_remove();
     unordered_set_test_clear();
@@ -62,6 +62,12 @@ extern "C" {
     ***************************************************************************/
     int  unordered_set_add(unordered_set* p_set, void* p_element);
 
+    /***************************************************************************
+    * Grows the table so that the set can hold 'size' elements without         *
+    * rehashing. Returns true if the set has the room.                         *
+    ***************************************************************************/
+    int  unordered_set_reserve(unordered_set* p_set, size_t size);
+
     /***************************************************************************
     * Returns true if the set contains the element.                            *
     ***************************************************************************/
@@ -94,6 +100,12 @@ extern "C" {
     ***************************************************************************/
     void unordered_set_free(unordered_set** p_set);
 
+    /***************************************************************************
+    * Returns the number of bytes allocated by the set, counting the set       *
+    * structure itself.                                                        *
+    ***************************************************************************/
+    size_t unordered_set_memory_usage(unordered_set* set);
+
     /***************************************************************************
     * Destroys but does not deallocate the set.                                *
     ***************************************************************************/
@@ -7,6 +7,7 @@
 #include "unordered_map.h"
 #include "utils.h"
 #include "list.h"
+#include "timing.h"
 #include <math.h>
 #include <stdio.h>
 #include <time.h>
@@ -199,7 +200,7 @@ int is_valid_path(list* p_path)
 
 double get_time()
 {
-    return (1000.0 * clock()) / CLOCKS_PER_SEC;
+    return timing_now_ns() / 1e6;
 }
 
 /*
@@ -0,0 +1,1497 @@
+#include "versioned_graph.h"
+#include "allocation.h"
+#include "breadth_first_search.h"
+#include "compressed_graph.h"
+#include "directed_graph_update.h"
+#include "graph_generator.h"
+#include "my_assert.h"
+#include "parallel.h"
+#include "philox.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define FALSE 0
+#define TRUE 1
+
+/*******************************************************************************
+* The rows are held in pages of this many nodes, so that a batch copies the    *
+* page table and the pages it touches instead of the whole node array.         *
+*******************************************************************************/
+#define PAGE_NODES 256
+
+/*******************************************************************************
+* The number announced by a reader that pins no version.                       *
+*******************************************************************************/
+#define IDLE ((size_t) -1)
+
+/*******************************************************************************
+* A row is NULL if the node has no neighbors, and otherwise an array holding   *
+* the number of children, the number of parents, the sorted children and the   *
+* sorted parents. A missing page stands for a page of empty rows.              *
+*******************************************************************************/
+typedef struct versioned_page {
+    size_t* p_row_array[PAGE_NODES];
+} versioned_page;
+
+/*******************************************************************************
+* A block of graph memory and its size, which the allocation layer needs back  *
+* when the block is freed.                                                     *
+*******************************************************************************/
+typedef struct graph_block {
+    void*  p_memory;
+    size_t bytes;
+} graph_block;
+
+/*******************************************************************************
+* The rows, pages, page table and version replaced when the version 'number'   *
+* was superseded. Only the versions up to 'number' refer to them.              *
+*******************************************************************************/
+typedef struct retired_version {
+    size_t                  number;
+    graph_block*            p_garbage_array;
+    size_t                  garbage;
+    size_t                  capacity;
+    struct retired_version* p_next;
+} retired_version;
+
+/*******************************************************************************
+* One side of an update: 'other' is added to or removed from the children of   *
+* 'node', or from its parents if 'parents' is set.                             *
+*******************************************************************************/
+typedef struct half_update {
+    size_t node;
+    size_t other;
+    size_t sequence;
+    int    parents;
+    int    operation;
+} half_update;
+
+/*******************************************************************************
+* A net change of one neighbor list.                                           *
+*******************************************************************************/
+typedef struct row_edit {
+    size_t other;
+    int    insert;
+} row_edit;
+
+static size_t page_count(size_t nodes)
+{
+    return nodes == 0 ? 1 : (nodes + PAGE_NODES - 1) / PAGE_NODES;
+}
+
+static size_t page_table_bytes(size_t nodes)
+{
+    return sizeof(versioned_page*) * page_count(nodes);
+}
+
+static size_t row_bytes(const size_t* p_row)
+{
+    return sizeof(size_t) * (2 + p_row[0] + p_row[1]);
+}
+
+static void* graph_alloc(size_t bytes)
+{
+    return allocation_alloc(ALLOCATION_GRAPH, bytes);
+}
+
+static void graph_free(void* p_memory, size_t bytes)
+{
+    allocation_free(ALLOCATION_GRAPH, p_memory, bytes);
+}
+
+static void add_block(graph_block* p_block_array,
+                      size_t* p_blocks,
+                      void* p_memory,
+                      size_t bytes)
+{
+    p_block_array[*p_blocks].p_memory = p_memory;
+    p_block_array[*p_blocks].bytes    = bytes;
+    ++*p_blocks;
+}
+
+static const size_t* get_row(versioned_graph_snapshot* p_snapshot,
+                             size_t index)
+{
+    versioned_page* p_page = p_snapshot->pp_page_array[index / PAGE_NODES];
+
+    return p_page ? p_page->p_row_array[index % PAGE_NODES] : NULL;
+}
+
+static int compare_size_t(const void* p_a, const void* p_b)
+{
+    size_t a = *(const size_t*) p_a;
+    size_t b = *(const size_t*) p_b;
+
+    return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+static int compare_half_updates(const void* p_a, const void* p_b)
+{
+    const half_update* p_x = p_a;
+    const half_update* p_y = p_b;
+
+    if (p_x->node != p_y->node)         return p_x->node < p_y->node ? -1 : 1;
+    if (p_x->parents != p_y->parents)   return p_x->parents - p_y->parents;
+    if (p_x->other != p_y->other)       return p_x->other < p_y->other ? -1 : 1;
+    if (p_x->sequence != p_y->sequence)
+    {
+        return p_x->sequence < p_y->sequence ? -1 : 1;
+    }
+
+    return 0;
+}
+
+static versioned_graph_snapshot* version_alloc(size_t nodes)
+{
+    versioned_graph_snapshot* p_version = graph_alloc(sizeof(*p_version));
+
+    if (!p_version) return NULL;
+
+    p_version->pp_page_array = allocation_calloc(ALLOCATION_GRAPH,
+                                                 page_count(nodes),
+                                                 sizeof(versioned_page*));
+
+    if (!p_version->pp_page_array)
+    {
+        graph_free(p_version, sizeof(*p_version));
+        return NULL;
+    }
+
+    p_version->number = 0;
+    p_version->nodes  = nodes;
+    p_version->arcs   = 0;
+    return p_version;
+}
+
+static void version_free(versioned_graph_snapshot* p_version)
+{
+    versioned_page* p_page;
+    size_t*         p_row;
+    size_t          page;
+    size_t          i;
+
+    for (page = 0; page < page_count(p_version->nodes); ++page)
+    {
+        p_page = p_version->pp_page_array[page];
+
+        if (!p_page) continue;
+
+        for (i = 0; i < PAGE_NODES; ++i)
+        {
+            p_row = p_page->p_row_array[i];
+
+            if (p_row) graph_free(p_row, row_bytes(p_row));
+        }
+
+        graph_free(p_page, sizeof(*p_page));
+    }
+
+    graph_free(p_version->pp_page_array, page_table_bytes(p_version->nodes));
+    graph_free(p_version, sizeof(*p_version));
+}
+
+/*******************************************************************************
+* Releases the bookkeeping of a retired version, and also its garbage if       *
+* 'with_garbage' is set.                                                       *
+*******************************************************************************/
+static void retired_version_release(retired_version* p_retired,
+                                    int with_garbage)
+{
+    size_t i;
+
+    if (!p_retired) return;
+
+    if (with_garbage)
+    {
+        for (i = 0; i < p_retired->garbage; ++i)
+        {
+            graph_free(p_retired->p_garbage_array[i].p_memory,
+                       p_retired->p_garbage_array[i].bytes);
+        }
+    }
+
+    graph_free(p_retired->p_garbage_array,
+               sizeof(graph_block) * p_retired->capacity);
+    graph_free(p_retired, sizeof(*p_retired));
+}
+
+static void retired_version_free(retired_version* p_retired)
+{
+    retired_version_release(p_retired, TRUE);
+}
+
+static size_t reader_array_bytes(size_t max_readers)
+{
+    return sizeof(versioned_graph_reader) *
+           (max_readers == 0 ? 1 : max_readers);
+}
+
+versioned_graph* versioned_graph_alloc(size_t nodes, size_t max_readers)
+{
+    versioned_graph*          p_graph = graph_alloc(sizeof(*p_graph));
+    versioned_graph_snapshot* p_version;
+    size_t                    i;
+
+    if (!p_graph) return NULL;
+
+    p_graph->p_reader_array = graph_alloc(reader_array_bytes(max_readers));
+    p_version = version_alloc(nodes);
+
+    if (!p_graph->p_reader_array || !p_version)
+    {
+        graph_free(p_graph->p_reader_array, reader_array_bytes(max_readers));
+        graph_free(p_graph, sizeof(*p_graph));
+
+        if (p_version) version_free(p_version);
+
+        return NULL;
+    }
+
+    for (i = 0; i < max_readers; ++i)
+    {
+        p_graph->p_reader_array[i].number  = IDLE;
+        p_graph->p_reader_array[i].in_use  = FALSE;
+        p_graph->p_reader_array[i].p_graph = p_graph;
+    }
+
+    p_graph->nodes          = nodes;
+    p_graph->number         = 0;
+    p_graph->current        = (size_t) p_version;
+    p_graph->max_readers    = max_readers;
+    p_graph->p_retired_head = NULL;
+    p_graph->p_retired_tail = NULL;
+    return p_graph;
+}
+
+versioned_graph* versioned_graph_load(compact_graph* p_graph,
+                                      size_t max_readers)
+{
+    versioned_graph*          p_versioned;
+    versioned_graph_snapshot* p_version;
+    versioned_page*           p_page;
+    size_t*                   p_row;
+    size_t                    node;
+    size_t                    children;
+    size_t                    parents;
+
+    p_versioned = versioned_graph_alloc(p_graph->nodes, max_readers);
+
+    if (!p_versioned) return NULL;
+
+    p_version       = (versioned_graph_snapshot*) p_versioned->current;
+    p_version->arcs = p_graph->arcs;
+
+    for (node = 0; node < p_graph->nodes; ++node)
+    {
+        children = compact_graph_out_degree(p_graph, node);
+        parents  = compact_graph_in_degree(p_graph, node);
+
+        if (children + parents == 0) continue;
+
+        p_page = p_version->pp_page_array[node / PAGE_NODES];
+
+        if (!p_page)
+        {
+            p_page = allocation_calloc(ALLOCATION_GRAPH,
+                                       1,
+                                       sizeof(versioned_page));
+
+            if (!p_page)
+            {
+                versioned_graph_free(p_versioned);
+                return NULL;
+            }
+
+            p_version->pp_page_array[node / PAGE_NODES] = p_page;
+        }
+
+        p_row = graph_alloc(sizeof(size_t) * (2 + children + parents));
+
+        if (!p_row)
+        {
+            versioned_graph_free(p_versioned);
+            return NULL;
+        }
+
+        p_row[0] = children;
+        p_row[1] = parents;
+        memcpy(p_row + 2,
+               p_graph->p_child_array + p_graph->p_child_offsets[node],
+               sizeof(size_t) * children);
+        memcpy(p_row + 2 + children,
+               p_graph->p_parent_array + p_graph->p_parent_offsets[node],
+               sizeof(size_t) * parents);
+        qsort(p_row + 2, children, sizeof(size_t), compare_size_t);
+        qsort(p_row + 2 + children, parents, sizeof(size_t), compare_size_t);
+        p_page->p_row_array[node % PAGE_NODES] = p_row;
+    }
+
+    return p_versioned;
+}
+
+versioned_graph_reader* versioned_graph_reader_alloc(versioned_graph* p_graph)
+{
+    size_t i;
+
+    for (i = 0; i < p_graph->max_readers; ++i)
+    {
+        if (PARALLEL_CAS(&p_graph->p_reader_array[i].in_use, FALSE, TRUE))
+        {
+            return &p_graph->p_reader_array[i];
+        }
+    }
+
+    return NULL;
+}
+
+void versioned_graph_reader_free(versioned_graph_reader* p_reader)
+{
+    if (!p_reader) return;
+
+    PARALLEL_STORE(&p_reader->number, IDLE);
+    PARALLEL_STORE(&p_reader->in_use, FALSE);
+}
+
+versioned_graph_snapshot* versioned_graph_begin(
+                            versioned_graph_reader* p_reader)
+{
+    versioned_graph* p_graph = p_reader->p_graph;
+    size_t           number  = PARALLEL_LOAD(&p_graph->number);
+
+    /***************************************************************************
+    * The compare-and-swap is a full barrier, and the writer publishes a       *
+    * version with one before it scans the slots. Hence either the writer sees *
+    * the announcement, or the load below sees the newer version; the number   *
+    * announced is never newer than the version read.                          *
+    ***************************************************************************/
+    PARALLEL_CAS(&p_reader->number, IDLE, number);
+    return (versioned_graph_snapshot*) PARALLEL_LOAD(&p_graph->current);
+}
+
+void versioned_graph_end(versioned_graph_reader* p_reader)
+{
+    PARALLEL_STORE(&p_reader->number, IDLE);
+}
+
+size_t versioned_graph_children(versioned_graph_snapshot* p_snapshot,
+                                size_t index,
+                                const size_t** pp_child_array)
+{
+    const size_t* p_row = get_row(p_snapshot, index);
+
+    *pp_child_array = p_row ? p_row + 2 : NULL;
+    return p_row ? p_row[0] : 0;
+}
+
+size_t versioned_graph_parents(versioned_graph_snapshot* p_snapshot,
+                               size_t index,
+                               const size_t** pp_parent_array)
+{
+    const size_t* p_row = get_row(p_snapshot, index);
+
+    *pp_parent_array = p_row ? p_row + 2 + p_row[0] : NULL;
+    return p_row ? p_row[1] : 0;
+}
+
+/*******************************************************************************
+* Replays the sorted half updates of one side of a node against its old        *
+* neighbor list and stores the net changes in 'p_edit_array'. Returns the      *
+* number of edits and adds the number of updates that changed the list to      *
+* '*p_changes'.                                                                *
+*******************************************************************************/
+static size_t collect_edits(half_update* p_begin,
+                            half_update* p_end,
+                            const size_t* p_list,
+                            size_t size,
+                            row_edit* p_edit_array,
+                            size_t* p_changes)
+{
+    half_update* p_run;
+    size_t       edits = 0;
+    int          initial;
+    int          present;
+
+    while (p_begin != p_end)
+    {
+        initial = p_list && bsearch(&p_begin->other,
+                                    p_list,
+                                    size,
+                                    sizeof(size_t),
+                                    compare_size_t) != NULL;
+        present = initial;
+
+        for (p_run = p_begin;
+             p_run != p_end && p_run->other == p_begin->other;
+             ++p_run)
+        {
+            if ((p_run->operation == DIRECTED_GRAPH_UPDATE_ADD) != present)
+            {
+                present = !present;
+                ++*p_changes;
+            }
+        }
+
+        if (present != initial)
+        {
+            p_edit_array[edits].other  = p_begin->other;
+            p_edit_array[edits].insert = present;
+            ++edits;
+        }
+
+        p_begin = p_run;
+    }
+
+    return edits;
+}
+
+/*******************************************************************************
+* Merges the sorted old list with the sorted edits into 'p_output'. Returns    *
+* the size of the new list.                                                    *
+*******************************************************************************/
+static size_t merge_edits(const size_t* p_list,
+                          size_t size,
+                          row_edit* p_edit_array,
+                          size_t edits,
+                          size_t* p_output)
+{
+    size_t i = 0;
+    size_t j = 0;
+    size_t k = 0;
+
+    while (i < size || j < edits)
+    {
+        if (j == edits || (i < size && p_list[i] < p_edit_array[j].other))
+        {
+            p_output[k++] = p_list[i++];
+        }
+        else if (p_edit_array[j].insert)
+        {
+            p_output[k++] = p_edit_array[j++].other;
+        }
+        else
+        {
+            /* A removal matches the current list entry. */
+            ++i;
+            ++j;
+        }
+    }
+
+    return k;
+}
+
+static size_t count_inserts(row_edit* p_edit_array, size_t edits)
+{
+    size_t inserts = 0;
+    size_t i;
+
+    for (i = 0; i < edits; ++i)
+    {
+        inserts += p_edit_array[i].insert;
+    }
+
+    return inserts;
+}
+
+size_t versioned_graph_apply(versioned_graph* p_graph,
+                             versioned_graph_update* p_update_array,
+                             size_t updates)
+{
+    versioned_graph_snapshot* p_old;
+    versioned_graph_snapshot* p_new      = NULL;
+    retired_version*          p_retired  = NULL;
+    half_update*              p_half_array;
+    row_edit*                 p_edit_array;
+    graph_block*              p_fresh_array = NULL;
+    size_t                    fresh = 0;
+    half_update*              p_node_begin;
+    half_update*              p_node_end;
+    half_update*              p_split;
+    versioned_page*           p_page;
+    const size_t*             p_old_row;
+    size_t*                   p_row;
+    size_t                    halves = 0;
+    size_t                    touched = 0;
+    size_t                    changes = 0;
+    size_t                    ignored = 0;
+    size_t                    pages;
+    size_t                    child_edits;
+    size_t                    parent_edits;
+    size_t                    children;
+    size_t                    parents;
+    size_t                    node;
+    size_t                    i;
+
+    p_old = (versioned_graph_snapshot*) p_graph->current;
+    pages = page_count(p_graph->nodes);
+
+    p_half_array = malloc(sizeof(half_update) * 2 * (updates + 1));
+    p_edit_array = malloc(sizeof(row_edit) * 2 * (updates + 1));
+
+    if (!p_half_array || !p_edit_array) goto out_of_memory;
+
+    for (i = 0; i < updates; ++i)
+    {
+        if (p_update_array[i].tail >= p_graph->nodes ||
+            p_update_array[i].head >= p_graph->nodes)
+        {
+            continue;
+        }
+
+        p_half_array[halves].node      = p_update_array[i].tail;
+        p_half_array[halves].other     = p_update_array[i].head;
+        p_half_array[halves].sequence  = i;
+        p_half_array[halves].parents   = FALSE;
+        p_half_array[halves].operation = p_update_array[i].operation;
+        ++halves;
+        p_half_array[halves].node      = p_update_array[i].head;
+        p_half_array[halves].other     = p_update_array[i].tail;
+        p_half_array[halves].sequence  = i;
+        p_half_array[halves].parents   = TRUE;
+        p_half_array[halves].operation = p_update_array[i].operation;
+        ++halves;
+    }
+
+    qsort(p_half_array, halves, sizeof(half_update), compare_half_updates);
+
+    for (i = 0; i < halves; ++i)
+    {
+        if (i == 0 || p_half_array[i].node != p_half_array[i - 1].node)
+        {
+            ++touched;
+        }
+    }
+
+    /* Each touched node replaces at most one row and one page. */
+    p_new         = graph_alloc(sizeof(*p_new));
+    p_retired     = graph_alloc(sizeof(*p_retired));
+    p_fresh_array = malloc(sizeof(graph_block) * 2 * (touched + 1));
+
+    if (p_new)     p_new->pp_page_array       = NULL;
+    if (p_retired) p_retired->p_garbage_array = NULL;
+
+    if (!p_new || !p_retired || !p_fresh_array) goto out_of_memory;
+
+    p_new->pp_page_array       = graph_alloc(page_table_bytes(p_graph->nodes));
+    p_retired->capacity        = 2 * (touched + 1);
+    p_retired->p_garbage_array = graph_alloc(sizeof(graph_block) *
+                                             p_retired->capacity);
+    p_retired->garbage         = 0;
+
+    if (!p_new->pp_page_array || !p_retired->p_garbage_array)
+    {
+        goto out_of_memory;
+    }
+
+    memcpy(p_new->pp_page_array,
+           p_old->pp_page_array,
+           sizeof(versioned_page*) * pages);
+    p_new->number = p_old->number + 1;
+    p_new->nodes  = p_old->nodes;
+    p_new->arcs   = p_old->arcs;
+
+    for (p_node_begin = p_half_array;
+         p_node_begin != p_half_array + halves;
+         p_node_begin = p_node_end)
+    {
+        node = p_node_begin->node;
+
+        for (p_split = p_node_begin;
+             p_split != p_half_array + halves &&
+             p_split->node == node &&
+             !p_split->parents;
+             ++p_split)
+        {
+        }
+
+        for (p_node_end = p_split;
+             p_node_end != p_half_array + halves && p_node_end->node == node;
+             ++p_node_end)
+        {
+        }
+
+        p_old_row    = get_row(p_old, node);
+        children     = p_old_row ? p_old_row[0] : 0;
+        parents      = p_old_row ? p_old_row[1] : 0;
+        child_edits  = collect_edits(p_node_begin,
+                                     p_split,
+                                     p_old_row ? p_old_row + 2 : NULL,
+                                     children,
+                                     p_edit_array,
+                                     &changes);
+        parent_edits = collect_edits(p_split,
+                                     p_node_end,
+                                     p_old_row ? p_old_row + 2 + children
+                                               : NULL,
+                                     parents,
+                                     p_edit_array + child_edits,
+                                     &ignored);
+
+        if (child_edits + parent_edits == 0) continue;
+
+        children += 2 * count_inserts(p_edit_array, child_edits)
+                      - child_edits;
+        parents  += 2 * count_inserts(p_edit_array + child_edits,
+                                      parent_edits)
+                      - parent_edits;
+        p_new->arcs += 2 * count_inserts(p_edit_array, child_edits);
+        p_new->arcs -= child_edits;
+
+        if (children + parents == 0)
+        {
+            p_row = NULL;
+        }
+        else
+        {
+            p_row = graph_alloc(sizeof(size_t) * (2 + children + parents));
+
+            if (!p_row) goto out_of_memory;
+
+            add_block(p_fresh_array,
+                      &fresh,
+                      p_row,
+                      sizeof(size_t) * (2 + children + parents));
+            p_row[0] = children;
+            p_row[1] = parents;
+            merge_edits(p_old_row ? p_old_row + 2 : NULL,
+                        p_old_row ? p_old_row[0] : 0,
+                        p_edit_array,
+                        child_edits,
+                        p_row + 2);
+            merge_edits(p_old_row ? p_old_row + 2 + p_old_row[0] : NULL,
+                        p_old_row ? p_old_row[1] : 0,
+                        p_edit_array + child_edits,
+                        parent_edits,
+                        p_row + 2 + children);
+        }
+
+        /* Copy the page on its first write in this batch. */
+        p_page = p_new->pp_page_array[node / PAGE_NODES];
+
+        if (p_page == p_old->pp_page_array[node / PAGE_NODES])
+        {
+            p_page = graph_alloc(sizeof(versioned_page));
+
+            if (!p_page) goto out_of_memory;
+
+            add_block(p_fresh_array, &fresh, p_page, sizeof(versioned_page));
+
+            if (p_new->pp_page_array[node / PAGE_NODES])
+            {
+                memcpy(p_page,
+                       p_new->pp_page_array[node / PAGE_NODES],
+                       sizeof(versioned_page));
+                add_block(p_retired->p_garbage_array,
+                          &p_retired->garbage,
+                          p_new->pp_page_array[node / PAGE_NODES],
+                          sizeof(versioned_page));
+            }
+            else
+            {
+                memset(p_page, 0, sizeof(versioned_page));
+            }
+
+            p_new->pp_page_array[node / PAGE_NODES] = p_page;
+        }
+
+        if (p_old_row)
+        {
+            add_block(p_retired->p_garbage_array,
+                      &p_retired->garbage,
+                      (void*) p_old_row,
+                      row_bytes(p_old_row));
+        }
+
+        p_page->p_row_array[node % PAGE_NODES] = p_row;
+    }
+
+    free(p_half_array);
+    free(p_edit_array);
+    free(p_fresh_array);
+
+    if (fresh == 0)
+    {
+        /* The batch cancelled out; keep the current version. */
+        graph_free(p_new->pp_page_array, page_table_bytes(p_graph->nodes));
+        graph_free(p_new, sizeof(*p_new));
+        retired_version_release(p_retired, FALSE);
+        return changes;
+    }
+
+    p_retired->number = p_old->number;
+    p_retired->p_next = NULL;
+    add_block(p_retired->p_garbage_array,
+              &p_retired->garbage,
+              p_old->pp_page_array,
+              page_table_bytes(p_graph->nodes));
+    add_block(p_retired->p_garbage_array,
+              &p_retired->garbage,
+              p_old,
+              sizeof(*p_old));
+
+    PARALLEL_CAS(&p_graph->current, (size_t) p_old, (size_t) p_new);
+    PARALLEL_STORE(&p_graph->number, p_new->number);
+
+    if (p_graph->p_retired_tail)
+    {
+        p_graph->p_retired_tail->p_next = p_retired;
+    }
+    else
+    {
+        p_graph->p_retired_head = p_retired;
+    }
+
+    p_graph->p_retired_tail = p_retired;
+    versioned_graph_reclaim(p_graph);
+    return changes;
+
+out_of_memory:
+
+    for (i = 0; i < fresh; ++i)
+    {
+        graph_free(p_fresh_array[i].p_memory, p_fresh_array[i].bytes);
+    }
+
+    free(p_half_array);
+    free(p_edit_array);
+    free(p_fresh_array);
+
+    if (p_new)
+    {
+        graph_free(p_new->pp_page_array, page_table_bytes(p_graph->nodes));
+        graph_free(p_new, sizeof(*p_new));
+    }
+
+    if (p_retired)
+    {
+        if (!p_retired->p_garbage_array) p_retired->capacity = 0;
+
+        retired_version_release(p_retired, FALSE);
+    }
+
+    return (size_t) -1;
+}
+
+void versioned_graph_reclaim(versioned_graph* p_graph)
+{
+    retired_version* p_retired;
+    size_t           oldest = IDLE;
+    size_t           number;
+    size_t           i;
+
+    for (i = 0; i < p_graph->max_readers; ++i)
+    {
+        number = PARALLEL_LOAD(&p_graph->p_reader_array[i].number);
+
+        if (number < oldest) oldest = number;
+    }
+
+    while (p_graph->p_retired_head &&
+           p_graph->p_retired_head->number < oldest)
+    {
+        p_retired               = p_graph->p_retired_head;
+        p_graph->p_retired_head = p_retired->p_next;
+        retired_version_free(p_retired);
+    }
+
+    if (!p_graph->p_retired_head) p_graph->p_retired_tail = NULL;
+}
+
+static void cursor_init(versioned_graph_cursor* p_cursor,
+                        void* p_node,
+                        int parents)
+{
+    const size_t* p_list;
+    size_t        size;
+
+    if (parents)
+    {
+        size = versioned_graph_parents(p_cursor->p_snapshot,
+                                       compressed_graph_index(p_node),
+                                       &p_list);
+    }
+    else
+    {
+        size = versioned_graph_children(p_cursor->p_snapshot,
+                                        compressed_graph_index(p_node),
+                                        &p_list);
+    }
+
+    p_cursor->p_next = p_list;
+    p_cursor->p_end  = p_list ? p_list + size : NULL;
+}
+
+static void children_iterator_init(child_node_iterator* p_iterator,
+                                   void* p_node)
+{
+    cursor_init(p_iterator->state, p_node, FALSE);
+}
+
+static int children_iterator_has_next(child_node_iterator* p_iterator)
+{
+    versioned_graph_cursor* p_cursor = p_iterator->state;
+
+    return p_cursor->p_next != p_cursor->p_end;
+}
+
+static void* children_iterator_next(child_node_iterator* p_iterator)
+{
+    versioned_graph_cursor* p_cursor = p_iterator->state;
+
+    return compressed_graph_node(*p_cursor->p_next++);
+}
+
+static void children_iterator_free(child_node_iterator* p_iterator)
+{
+    (void) p_iterator;
+}
+
+static void parents_iterator_init(parent_node_iterator* p_iterator,
+                                  void* p_node)
+{
+    cursor_init(p_iterator->state, p_node, TRUE);
+}
+
+static int parents_iterator_has_next(parent_node_iterator* p_iterator)
+{
+    versioned_graph_cursor* p_cursor = p_iterator->state;
+
+    return p_cursor->p_next != p_cursor->p_end;
+}
+
+static void* parents_iterator_next(parent_node_iterator* p_iterator)
+{
+    versioned_graph_cursor* p_cursor = p_iterator->state;
+
+    return compressed_graph_node(*p_cursor->p_next++);
+}
+
+static void parents_iterator_free(parent_node_iterator* p_iterator)
+{
+    (void) p_iterator;
+}
+
+void versioned_graph_children_iterator(
+         child_node_iterator* p_iterator,
+         versioned_graph_cursor* p_cursor,
+         versioned_graph_snapshot* p_snapshot)
+{
+    p_cursor->p_snapshot                     = p_snapshot;
+    p_cursor->p_next                         = NULL;
+    p_cursor->p_end                          = NULL;
+    p_iterator->state                        = p_cursor;
+    p_iterator->child_node_iterator_init     = children_iterator_init;
+    p_iterator->child_node_iterator_has_next = children_iterator_has_next;
+    p_iterator->child_node_iterator_next     = children_iterator_next;
+    p_iterator->child_node_iterator_free     = children_iterator_free;
+}
+
+void versioned_graph_parents_iterator(
+         parent_node_iterator* p_iterator,
+         versioned_graph_cursor* p_cursor,
+         versioned_graph_snapshot* p_snapshot)
+{
+    p_cursor->p_snapshot                      = p_snapshot;
+    p_cursor->p_next                          = NULL;
+    p_cursor->p_end                           = NULL;
+    p_iterator->state                         = p_cursor;
+    p_iterator->parent_node_iterator_init     = parents_iterator_init;
+    p_iterator->parent_node_iterator_has_next = parents_iterator_has_next;
+    p_iterator->parent_node_iterator_next     = parents_iterator_next;
+    p_iterator->parent_node_iterator_free     = parents_iterator_free;
+}
+
+void versioned_graph_free(versioned_graph* p_graph)
+{
+    retired_version* p_retired;
+
+    if (!p_graph) return;
+
+    while (p_graph->p_retired_head)
+    {
+        p_retired               = p_graph->p_retired_head;
+        p_graph->p_retired_head = p_retired->p_next;
+        retired_version_free(p_retired);
+    }
+
+    version_free((versioned_graph_snapshot*) p_graph->current);
+    graph_free(p_graph->p_reader_array,
+               reader_array_bytes(p_graph->max_readers));
+    graph_free(p_graph, sizeof(*p_graph));
+}
+
+size_t versioned_graph_memory_usage(versioned_graph* p_graph)
+{
+    versioned_graph_snapshot* p_version;
+    versioned_page*           p_page;
+    retired_version*          p_retired;
+    size_t                    bytes;
+    size_t                    page;
+    size_t                    i;
+
+    if (!p_graph) return 0;
+
+    p_version = (versioned_graph_snapshot*) p_graph->current;
+    bytes     = sizeof(*p_graph)
+              + reader_array_bytes(p_graph->max_readers)
+              + sizeof(*p_version)
+              + page_table_bytes(p_version->nodes);
+
+    for (page = 0; page < page_count(p_version->nodes); ++page)
+    {
+        p_page = p_version->pp_page_array[page];
+
+        if (!p_page) continue;
+
+        bytes += sizeof(*p_page);
+
+        for (i = 0; i < PAGE_NODES; ++i)
+        {
+            if (p_page->p_row_array[i])
+            {
+                bytes += row_bytes(p_page->p_row_array[i]);
+            }
+        }
+    }
+
+    for (p_retired = p_graph->p_retired_head;
+         p_retired;
+         p_retired = p_retired->p_next)
+    {
+        bytes += sizeof(*p_retired)
+               + sizeof(graph_block) * p_retired->capacity;
+
+        for (i = 0; i < p_retired->garbage; ++i)
+        {
+            bytes += p_retired->p_garbage_array[i].bytes;
+        }
+    }
+
+    return bytes;
+}
+
+static int row_equals(const size_t* p_list,
+                      size_t size,
+                      const size_t* p_expected,
+                      size_t expected)
+{
+    size_t i;
+
+    if (size != expected) return FALSE;
+
+    for (i = 0; i < size; ++i)
+    {
+        if (p_list[i] != p_expected[i]) return FALSE;
+    }
+
+    return TRUE;
+}
+
+static void versioned_graph_test_snapshots()
+{
+    versioned_graph*          p_graph;
+    versioned_graph_reader*   p_reader_a;
+    versioned_graph_reader*   p_reader_b;
+    versioned_graph_snapshot* p_empty;
+    versioned_graph_snapshot* p_first;
+    versioned_graph_snapshot* p_second;
+    const size_t*             p_list;
+    size_t                    p_two[]   = { 2 };
+    size_t                    p_one[]   = { 1 };
+    size_t                    p_three[] = { 2, 3 };
+    versioned_graph_update    p_batch_a[] = {
+        { 0, 1, DIRECTED_GRAPH_UPDATE_ADD    },
+        { 1, 2, DIRECTED_GRAPH_UPDATE_ADD    },
+        { 0, 1, DIRECTED_GRAPH_UPDATE_ADD    },
+        { 3, 4, DIRECTED_GRAPH_UPDATE_ADD    },
+        { 3, 4, DIRECTED_GRAPH_UPDATE_REMOVE },
+        { 2, 0, DIRECTED_GRAPH_UPDATE_ADD    },
+        { 9, 1, DIRECTED_GRAPH_UPDATE_ADD    }
+    };
+    versioned_graph_update    p_batch_b[] = {
+        { 0, 1, DIRECTED_GRAPH_UPDATE_REMOVE },
+        { 0, 3, DIRECTED_GRAPH_UPDATE_ADD    },
+        { 0, 2, DIRECTED_GRAPH_UPDATE_ADD    },
+        { 4, 4, DIRECTED_GRAPH_UPDATE_REMOVE }
+    };
+
+    puts("        versioned_graph_test_snapshots()");
+
+    p_graph    = versioned_graph_alloc(5, 2);
+    p_reader_a = versioned_graph_reader_alloc(p_graph);
+    p_reader_b = versioned_graph_reader_alloc(p_graph);
+    ASSERT(p_reader_a != NULL);
+    ASSERT(p_reader_b != NULL);
+    ASSERT(versioned_graph_reader_alloc(p_graph) == NULL);
+
+    p_empty = versioned_graph_begin(p_reader_a);
+    ASSERT(versioned_graph_apply(p_graph, p_batch_a, 7) == 5);
+
+    /* The pinned version does not see the batch... */
+    ASSERT(p_empty->arcs == 0);
+    ASSERT(versioned_graph_children(p_empty, 0, &p_list) == 0);
+    ASSERT(p_graph->p_retired_head != NULL);
+    versioned_graph_end(p_reader_a);
+
+    /* ...but the next one does. */
+    p_first = versioned_graph_begin(p_reader_a);
+    ASSERT(p_first->arcs == 3);
+    ASSERT(p_first->number == 1);
+    versioned_graph_children(p_first, 0, &p_list);
+    ASSERT(row_equals(p_list, 1, p_one, 1));
+    ASSERT(versioned_graph_parents(p_first, 0, &p_list) == 1);
+    ASSERT(row_equals(p_list, 1, p_two, 1));
+    ASSERT(versioned_graph_children(p_first, 3, &p_list) == 0);
+
+    p_second = versioned_graph_begin(p_reader_b);
+    ASSERT(p_second == p_first);
+    ASSERT(versioned_graph_apply(p_graph, p_batch_b, 4) == 3);
+    versioned_graph_children(p_first, 0, &p_list);
+    ASSERT(row_equals(p_list, 1, p_one, 1));
+    versioned_graph_end(p_reader_b);
+    versioned_graph_end(p_reader_a);
+
+    p_second = versioned_graph_begin(p_reader_b);
+    ASSERT(p_second->arcs == 4);
+    ASSERT(versioned_graph_children(p_second, 0, &p_list) == 2);
+    ASSERT(row_equals(p_list, 2, p_three, 2));
+    ASSERT(versioned_graph_parents(p_second, 1, &p_list) == 0);
+    versioned_graph_end(p_reader_b);
+
+    /* With no reader left, all replaced versions are freed. */
+    versioned_graph_reclaim(p_graph);
+    ASSERT(p_graph->p_retired_head == NULL);
+
+    versioned_graph_reader_free(p_reader_a);
+    versioned_graph_reader_free(p_reader_b);
+    versioned_graph_free(p_graph);
+}
+
+/*******************************************************************************
+* Checks every row of the snapshot against an adjacency matrix.                *
+*******************************************************************************/
+static int rows_match(versioned_graph_snapshot* p_snapshot,
+                      const char* p_matrix,
+                      size_t nodes)
+{
+    const size_t* p_list;
+    size_t        size;
+    size_t        expected;
+    size_t        node;
+    size_t        other;
+    size_t        arcs = 0;
+
+    for (node = 0; node < nodes; ++node)
+    {
+        size     = versioned_graph_children(p_snapshot, node, &p_list);
+        expected = 0;
+
+        for (other = 0; other < nodes; ++other)
+        {
+            if (!p_matrix[node * nodes + other]) continue;
+            if (expected >= size || p_list[expected] != other) return FALSE;
+
+            ++expected;
+        }
+
+        if (expected != size) return FALSE;
+
+        arcs    += size;
+        size     = versioned_graph_parents(p_snapshot, node, &p_list);
+        expected = 0;
+
+        for (other = 0; other < nodes; ++other)
+        {
+            if (!p_matrix[other * nodes + node]) continue;
+            if (expected >= size || p_list[expected] != other) return FALSE;
+
+            ++expected;
+        }
+
+        if (expected != size) return FALSE;
+    }
+
+    return arcs == p_snapshot->arcs;
+}
+
+static void versioned_graph_test_batches()
+{
+    const size_t              nodes = 700;
+    const size_t              updates = 3000;
+    compact_graph*            p_compact;
+    versioned_graph*          p_graph;
+    versioned_graph_reader*   p_reader;
+    versioned_graph_snapshot* p_snapshot;
+    versioned_graph_update*   p_update_array;
+    char*                     p_matrix;
+    philox                    random;
+    size_t                    expected;
+    size_t                    batch;
+    size_t                    node;
+    size_t                    i;
+    char*                     p_cell;
+
+    puts("        versioned_graph_test_batches()");
+
+    p_compact      = graph_generator_rmat(nodes, 5000, 0.57, 0.19, 0.19, 5, 1);
+    p_graph        = versioned_graph_load(p_compact, 1);
+    p_reader       = versioned_graph_reader_alloc(p_graph);
+    p_matrix       = calloc(nodes * nodes, 1);
+    p_update_array = malloc(sizeof(versioned_graph_update) * updates);
+
+    for (node = 0; node < nodes; ++node)
+    {
+        for (i = p_compact->p_child_offsets[node];
+             i < p_compact->p_child_offsets[node + 1];
+             ++i)
+        {
+            p_matrix[node * nodes + p_compact->p_child_array[i]] = TRUE;
+        }
+    }
+
+    p_snapshot = versioned_graph_begin(p_reader);
+    ASSERT(p_snapshot->arcs == p_compact->arcs);
+    ASSERT(rows_match(p_snapshot, p_matrix, nodes));
+    versioned_graph_end(p_reader);
+
+    philox_init(&random, 13, 0);
+
+    for (batch = 0; batch < 5; ++batch)
+    {
+        expected = 0;
+
+        /* Small node ranges make the updates of a batch collide. */
+        for (i = 0; i < updates; ++i)
+        {
+            p_update_array[i].tail      = philox_below(&random, nodes / 7);
+            p_update_array[i].head      = philox_below(&random, nodes);
+            p_update_array[i].operation = philox_below(&random, 2) == 0 ?
+                                          DIRECTED_GRAPH_UPDATE_ADD :
+                                          DIRECTED_GRAPH_UPDATE_REMOVE;
+            p_cell = &p_matrix[p_update_array[i].tail * nodes +
+                               p_update_array[i].head];
+
+            if ((p_update_array[i].operation == DIRECTED_GRAPH_UPDATE_ADD)
+                != *p_cell)
+            {
+                *p_cell = !*p_cell;
+                ++expected;
+            }
+        }
+
+        ASSERT(versioned_graph_apply(p_graph, p_update_array, updates)
+               == expected);
+        p_snapshot = versioned_graph_begin(p_reader);
+        ASSERT(p_snapshot->number == batch + 1);
+        ASSERT(rows_match(p_snapshot, p_matrix, nodes));
+        versioned_graph_end(p_reader);
+    }
+
+    free(p_update_array);
+    free(p_matrix);
+    versioned_graph_reader_free(p_reader);
+    versioned_graph_free(p_graph);
+    compact_graph_free(p_compact);
+}
+
+static void versioned_graph_test_iterators()
+{
+    compact_graph*            p_compact;
+    versioned_graph*          p_graph;
+    versioned_graph_reader*   p_reader_a;
+    versioned_graph_reader*   p_reader_b;
+    versioned_graph_snapshot* p_before;
+    versioned_graph_snapshot* p_after;
+    versioned_graph_cursor    child_cursor;
+    versioned_graph_cursor    parent_cursor;
+    child_node_iterator       child_iterator;
+    parent_node_iterator      parent_iterator;
+    list*                     p_path;
+    size_t                    parents = 0;
+    versioned_graph_update    p_cut_array[] = {
+        { 0, 1,  DIRECTED_GRAPH_UPDATE_REMOVE },
+        { 0, 10, DIRECTED_GRAPH_UPDATE_REMOVE }
+    };
+
+    puts("        versioned_graph_test_iterators()");
+
+    /* The corners of a 10 x 10 grid are 18 steps apart. */
+    p_compact  = graph_generator_grid(10, 10, 1, 1);
+    p_graph    = versioned_graph_load(p_compact, 2);
+    p_reader_a = versioned_graph_reader_alloc(p_graph);
+    p_reader_b = versioned_graph_reader_alloc(p_graph);
+    p_before   = versioned_graph_begin(p_reader_a);
+
+    versioned_graph_parents_iterator(&parent_iterator,
+                                     &parent_cursor,
+                                     p_before);
+    parent_iterator.parent_node_iterator_init(&parent_iterator,
+                                              compressed_graph_node(11));
+
+    while (parent_iterator.parent_node_iterator_has_next(&parent_iterator))
+    {
+        parent_iterator.parent_node_iterator_next(&parent_iterator);
+        parents++;
+    }
+
+    parent_iterator.parent_node_iterator_free(&parent_iterator);
+    ASSERT(parents == 4);
+
+    /* Cutting the arcs out of the corner leaves the old snapshot whole. */
+    ASSERT(versioned_graph_apply(p_graph, p_cut_array, 2) == 2);
+    p_after = versioned_graph_begin(p_reader_b);
+
+    versioned_graph_children_iterator(&child_iterator,
+                                      &child_cursor,
+                                      p_before);
+    p_path = breadth_first_search(compressed_graph_node(0),
+                                  compressed_graph_node(99),
+                                  &child_iterator,
+                                  compressed_graph_node_hash_function,
+                                  compressed_graph_nodes_equal_function);
+    ASSERT(p_path != NULL);
+    ASSERT(list_size(p_path) == 19);
+    list_free(p_path);
+
+    versioned_graph_children_iterator(&child_iterator,
+                                      &child_cursor,
+                                      p_after);
+    p_path = breadth_first_search(compressed_graph_node(0),
+                                  compressed_graph_node(99),
+                                  &child_iterator,
+                                  compressed_graph_node_hash_function,
+                                  compressed_graph_nodes_equal_function);
+    ASSERT(p_path == NULL);
+
+    versioned_graph_end(p_reader_a);
+    versioned_graph_end(p_reader_b);
+    versioned_graph_reader_free(p_reader_a);
+    versioned_graph_reader_free(p_reader_b);
+    versioned_graph_free(p_graph);
+    compact_graph_free(p_compact);
+}
+
+#define CONCURRENT_NODES   1000
+#define CONCURRENT_READERS 3
+#define CONCURRENT_BATCHES 300
+
+typedef struct concurrent_test_state {
+    versioned_graph* p_graph;
+    size_t           done;
+    size_t           reads;
+    size_t           errors;
+} concurrent_test_state;
+
+/*******************************************************************************
+* The writer keeps the graph symmetric by adding and removing both directions  *
+* of an arc in the same batch, so a torn read would show as an arc without its *
+* reverse.                                                                     *
+*******************************************************************************/
+static void concurrent_writer(void* p_argument)
+{
+    concurrent_test_state* p_state = p_argument;
+    versioned_graph_update p_update_array[200];
+    philox                 random;
+    size_t                 batch;
+    size_t                 i;
+
+    philox_init(&random, 17, 0);
+
+    for (batch = 0; batch < CONCURRENT_BATCHES; ++batch)
+    {
+        for (i = 0; i < 200; i += 2)
+        {
+            p_update_array[i].tail      = philox_below(&random,
+                                                       CONCURRENT_NODES);
+            p_update_array[i].head      = philox_below(&random,
+                                                       CONCURRENT_NODES);
+            p_update_array[i].operation = philox_below(&random, 3) == 0 ?
+                                          DIRECTED_GRAPH_UPDATE_REMOVE :
+                                          DIRECTED_GRAPH_UPDATE_ADD;
+            p_update_array[i + 1].tail      = p_update_array[i].head;
+            p_update_array[i + 1].head      = p_update_array[i].tail;
+            p_update_array[i + 1].operation = p_update_array[i].operation;
+        }
+
+        if (versioned_graph_apply(p_state->p_graph, p_update_array, 200)
+            == (size_t) -1)
+        {
+            PARALLEL_FETCH_ADD(&p_state->errors, 1);
+        }
+    }
+
+    PARALLEL_STORE(&p_state->done, TRUE);
+}
+
+static int snapshot_is_symmetric(versioned_graph_snapshot* p_snapshot)
+{
+    const size_t* p_child_array;
+    const size_t* p_other_array;
+    size_t        children;
+    size_t        others;
+    size_t        arcs = 0;
+    size_t        node;
+    size_t        i;
+
+    for (node = 0; node < p_snapshot->nodes; ++node)
+    {
+        children = versioned_graph_children(p_snapshot, node, &p_child_array);
+        arcs    += children;
+
+        for (i = 0; i < children; ++i)
+        {
+            others = versioned_graph_children(p_snapshot,
+                                              p_child_array[i],
+                                              &p_other_array);
+
+            if (others == 0 || !bsearch(&node,
+                                        p_other_array,
+                                        others,
+                                        sizeof(size_t),
+                                        compare_size_t))
+            {
+                return FALSE;
+            }
+        }
+    }
+
+    return arcs == p_snapshot->arcs;
+}
+
+static void concurrent_reader(void* p_argument)
+{
+    concurrent_test_state*    p_state = p_argument;
+    versioned_graph_reader*   p_reader;
+    versioned_graph_snapshot* p_snapshot;
+    size_t                    number = 0;
+
+    p_reader = versioned_graph_reader_alloc(p_state->p_graph);
+
+    do
+    {
+        p_snapshot = versioned_graph_begin(p_reader);
+
+        if (p_snapshot->number < number ||
+            !snapshot_is_symmetric(p_snapshot))
+        {
+            PARALLEL_FETCH_ADD(&p_state->errors, 1);
+        }
+
+        number = p_snapshot->number;
+        versioned_graph_end(p_reader);
+        PARALLEL_FETCH_ADD(&p_state->reads, 1);
+    }
+    while (!PARALLEL_LOAD(&p_state->done));
+
+    versioned_graph_reader_free(p_reader);
+}
+
+static void versioned_graph_test_concurrent()
+{
+    concurrent_test_state     state;
+    parallel_thread           writer;
+    parallel_thread           p_reader_array[CONCURRENT_READERS];
+    versioned_graph_reader*   p_reader;
+    versioned_graph_snapshot* p_snapshot;
+    size_t                    i;
+
+    puts("        versioned_graph_test_concurrent()");
+
+    state.p_graph = versioned_graph_alloc(CONCURRENT_NODES,
+                                          CONCURRENT_READERS + 1);
+    state.done    = FALSE;
+    state.reads   = 0;
+    state.errors  = 0;
+
+    for (i = 0; i < CONCURRENT_READERS; ++i)
+    {
+        ASSERT(parallel_thread_create(&p_reader_array[i],
+                                      concurrent_reader,
+                                      &state));
+    }
+
+    ASSERT(parallel_thread_create(&writer, concurrent_writer, &state));
+    parallel_thread_join(writer);
+
+    for (i = 0; i < CONCURRENT_READERS; ++i)
+    {
+        parallel_thread_join(p_reader_array[i]);
+    }
+
+    ASSERT(state.errors == 0);
+    ASSERT(state.reads >= CONCURRENT_READERS);
+
+    p_reader   = versioned_graph_reader_alloc(state.p_graph);
+    p_snapshot = versioned_graph_begin(p_reader);
+    ASSERT(p_snapshot->number == CONCURRENT_BATCHES);
+    ASSERT(snapshot_is_symmetric(p_snapshot));
+    versioned_graph_end(p_reader);
+    versioned_graph_reader_free(p_reader);
+
+    versioned_graph_reclaim(state.p_graph);
+    ASSERT(state.p_graph->p_retired_head == NULL);
+    versioned_graph_free(state.p_graph);
+}
+
+/*******************************************************************************
+* Returns the bytes the graph subsystem has in use.                            *
+*******************************************************************************/
+static size_t graph_bytes()
+{
+    allocation_counters counters;
+
+    allocation_get_counters(ALLOCATION_GRAPH, &counters);
+    return counters.bytes;
+}
+
+/*******************************************************************************
+* Checks that the graph memory goes through the allocation layer and that      *
+* 'versioned_graph_memory_usage' accounts for it, retired versions included.   *
+*******************************************************************************/
+static void versioned_graph_test_memory()
+{
+    compact_graph*          p_compact;
+    versioned_graph*        p_graph;
+    versioned_graph_reader* p_reader;
+    versioned_graph_update  p_batch[] = {
+        { 0,   1,   DIRECTED_GRAPH_UPDATE_REMOVE },
+        { 0,   899, DIRECTED_GRAPH_UPDATE_ADD    },
+        { 450, 3,   DIRECTED_GRAPH_UPDATE_ADD    }
+    };
+    size_t                  base;
+
+    puts("        versioned_graph_test_memory()");
+
+    p_compact = graph_generator_grid(30, 30, 1, 1);
+    base      = graph_bytes();
+    p_graph   = versioned_graph_load(p_compact, 1);
+    ASSERT(p_graph != NULL);
+    ASSERT(graph_bytes() - base == versioned_graph_memory_usage(p_graph));
+
+    /* The pinned version stays allocated... */
+    p_reader = versioned_graph_reader_alloc(p_graph);
+    versioned_graph_begin(p_reader);
+    ASSERT(versioned_graph_apply(p_graph, p_batch, 3) == 3);
+    ASSERT(p_graph->p_retired_head != NULL);
+    ASSERT(graph_bytes() - base == versioned_graph_memory_usage(p_graph));
+
+    /* ...until the reader lets go of it. */
+    versioned_graph_end(p_reader);
+    versioned_graph_reclaim(p_graph);
+    ASSERT(p_graph->p_retired_head == NULL);
+    ASSERT(graph_bytes() - base == versioned_graph_memory_usage(p_graph));
+
+    versioned_graph_reader_free(p_reader);
+    versioned_graph_free(p_graph);
+    ASSERT(graph_bytes() == base);
+    compact_graph_free(p_compact);
+}
+
+void versioned_graph_test()
+{
+    puts("    versioned_graph_test()");
+    versioned_graph_test_snapshots();
+    versioned_graph_test_batches();
+    versioned_graph_test_iterators();
+    versioned_graph_test_memory();
+    versioned_graph_test_concurrent();
+}
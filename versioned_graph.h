@@ -0,0 +1,171 @@
+#ifndef VERSIONED_GRAPH_H
+#define VERSIONED_GRAPH_H
+
+#include "compact_graph.h"
+#include "utils.h"
+#include <stddef.h>
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+    /***************************************************************************
+    * A graph over the node indices 0, 1, ..., nodes - 1 that many threads can *
+    * search while one writer updates it. Each batch of updates produces a new *
+    * immutable version. The rows of the nodes touched by the batch and the    *
+    * pages holding them are copied on write, while everything else is shared  *
+    * with the previous version, so that a version costs about the size of     *
+    * the batch. Readers take no locks: a reader announces the version number  *
+    * in its own slot and reads the current version. The writer frees the      *
+    * rows and pages replaced by a batch only once no reader announces a       *
+    * number that old.                                                         *
+    ***************************************************************************/
+    typedef struct versioned_graph_snapshot {
+        size_t                  number;
+        size_t                  nodes;
+        size_t                  arcs;
+        struct versioned_page** pp_page_array;
+    } versioned_graph_snapshot;
+
+    typedef struct versioned_graph_reader {
+        size_t                  number;
+        size_t                  in_use;
+        struct versioned_graph* p_graph;
+    } versioned_graph_reader;
+
+    typedef struct versioned_graph {
+        size_t                  nodes;
+        size_t                  number;
+        size_t                  current;
+        size_t                  max_readers;
+        versioned_graph_reader* p_reader_array;
+        struct retired_version* p_retired_head;
+        struct retired_version* p_retired_tail;
+    } versioned_graph;
+
+    /***************************************************************************
+    * Adds or removes the arc ('tail', 'head') depending on 'operation', which *
+    * is DIRECTED_GRAPH_UPDATE_ADD or DIRECTED_GRAPH_UPDATE_REMOVE.            *
+    ***************************************************************************/
+    typedef struct versioned_graph_update {
+        size_t tail;
+        size_t head;
+        int    operation;
+    } versioned_graph_update;
+
+    /***************************************************************************
+    * Walks one neighbor list of a snapshot.                                   *
+    ***************************************************************************/
+    typedef struct versioned_graph_cursor {
+        versioned_graph_snapshot* p_snapshot;
+        const size_t*             p_next;
+        const size_t*             p_end;
+    } versioned_graph_cursor;
+
+    /***************************************************************************
+    * Allocates an arcless graph with 'nodes' nodes that up to 'max_readers'   *
+    * readers may read at the same time. Returns NULL if the memory ran out.   *
+    ***************************************************************************/
+    versioned_graph* versioned_graph_alloc(size_t nodes, size_t max_readers);
+
+    /***************************************************************************
+    * Allocates a versioned graph with the nodes and arcs of 'p_graph'.        *
+    ***************************************************************************/
+    versioned_graph* versioned_graph_load(compact_graph* p_graph,
+                                          size_t max_readers);
+
+    /***************************************************************************
+    * Claims a reader slot. Each reading thread needs a slot of its own.       *
+    * Returns NULL if all 'max_readers' slots are taken.                       *
+    ***************************************************************************/
+    versioned_graph_reader* versioned_graph_reader_alloc(
+                                versioned_graph* p_graph);
+
+    /***************************************************************************
+    * Returns the reader slot.                                                 *
+    ***************************************************************************/
+    void versioned_graph_reader_free(versioned_graph_reader* p_reader);
+
+    /***************************************************************************
+    * Pins the current version and returns it. The snapshot stays valid and    *
+    * unchanged until 'versioned_graph_end' whatever the writer does. Never    *
+    * blocks. A reader pins one snapshot at a time.                            *
+    ***************************************************************************/
+    versioned_graph_snapshot* versioned_graph_begin(
+                                versioned_graph_reader* p_reader);
+
+    /***************************************************************************
+    * Unpins the snapshot of the reader.                                       *
+    ***************************************************************************/
+    void versioned_graph_end(versioned_graph_reader* p_reader);
+
+    /***************************************************************************
+    * Points '*pp_child_array' at the sorted children of the node with index   *
+    * 'index' in the snapshot and returns their number.                        *
+    ***************************************************************************/
+    size_t versioned_graph_children(versioned_graph_snapshot* p_snapshot,
+                                    size_t index,
+                                    const size_t** pp_child_array);
+
+    /***************************************************************************
+    * Points '*pp_parent_array' at the sorted parents in the same manner.      *
+    ***************************************************************************/
+    size_t versioned_graph_parents(versioned_graph_snapshot* p_snapshot,
+                                   size_t index,
+                                   const size_t** pp_parent_array);
+
+    /***************************************************************************
+    * Applies a batch of updates as one new version. The result is the same as *
+    * applying the updates one by one in array order; updates naming nodes out *
+    * of range are ignored. Only one thread may write at a time, but readers   *
+    * need not stop. Returns the number of updates that changed the graph, or  *
+    * (size_t) -1 if the memory ran out, in which case nothing changed.        *
+    ***************************************************************************/
+    size_t versioned_graph_apply(versioned_graph* p_graph,
+                                 versioned_graph_update* p_update_array,
+                                 size_t updates);
+
+    /***************************************************************************
+    * Frees the versions that no reader can see any more. The writer does this *
+    * after each batch; calling it again helps once long readers have ended.   *
+    ***************************************************************************/
+    void versioned_graph_reclaim(versioned_graph* p_graph);
+
+    /***************************************************************************
+    * Sets up 'p_iterator' to walk the children in the snapshot, with          *
+    * 'p_cursor' as its state. The nodes are the values of                     *
+    * 'compressed_graph_node' and need its hash and equality functions.        *
+    ***************************************************************************/
+    void versioned_graph_children_iterator(
+             child_node_iterator* p_iterator,
+             versioned_graph_cursor* p_cursor,
+             versioned_graph_snapshot* p_snapshot);
+
+    /***************************************************************************
+    * Sets up 'p_iterator' to walk the parents in the snapshot.                *
+    ***************************************************************************/
+    void versioned_graph_parents_iterator(
+             parent_node_iterator* p_iterator,
+             versioned_graph_cursor* p_cursor,
+             versioned_graph_snapshot* p_snapshot);
+
+    /***************************************************************************
+    * Deallocates the graph and all its versions. No reader may be active.     *
+    ***************************************************************************/
+    void versioned_graph_free(versioned_graph* p_graph);
+
+    /***************************************************************************
+    * Returns the number of bytes allocated by the graph: the current version, *
+    * the retired versions not yet reclaimed and the reader slots. Only the    *
+    * writer may call this.                                                    *
+    ***************************************************************************/
+    size_t versioned_graph_memory_usage(versioned_graph* p_graph);
+
+    /* Contains the unit tests. */
+    void versioned_graph_test();
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif  /* VERSIONED_GRAPH_H */
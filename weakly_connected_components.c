@@ -0,0 +1,416 @@
+#include "my_assert.h"
+#include "parallel.h"
+#include "weakly_connected_components.h"
+#include <stdint.h>
+#include <stdlib.h>
+
+typedef struct wcc_context {
+    compact_graph* p_graph;
+    size_t*        p_parent_array;
+    size_t*        p_label_array;
+    size_t*        p_component_array;
+    size_t*        p_size_array;
+} wcc_context;
+
+/*******************************************************************************
+* Returns the root of 'node' halving the path on the way: each visited node is *
+* swung to point to its grandparent. Roots are always the smallest index of    *
+* their tree, so parent pointers only decrease and no cycle can form.          *
+*******************************************************************************/
+static size_t find_root(size_t* p_parent_array, size_t node)
+{
+    size_t parent;
+    size_t grandparent;
+
+    for (;;)
+    {
+        parent = PARALLEL_LOAD(&p_parent_array[node]);
+
+        if (parent == node) return node;
+
+        grandparent = PARALLEL_LOAD(&p_parent_array[parent]);
+
+        if (parent != grandparent)
+        {
+            PARALLEL_CAS(&p_parent_array[node], parent, grandparent);
+        }
+
+        node = parent;
+    }
+}
+
+/*******************************************************************************
+* Links the trees of 'a' and 'b', hanging the larger root under the smaller.   *
+* Retries if another thread relinked the root in between.                      *
+*******************************************************************************/
+static void unite(size_t* p_parent_array, size_t a, size_t b)
+{
+    size_t tmp;
+
+    for (;;)
+    {
+        a = find_root(p_parent_array, a);
+        b = find_root(p_parent_array, b);
+
+        if (a == b) return;
+
+        if (a > b)
+        {
+            tmp = a;
+            a = b;
+            b = tmp;
+        }
+
+        if (PARALLEL_CAS(&p_parent_array[b], b, a)) return;
+    }
+}
+
+static void init_body(size_t begin,
+                      size_t end,
+                      size_t thread_index,
+                      void*  p_argument)
+{
+    wcc_context* p_context = p_argument;
+    size_t       i;
+
+    (void) thread_index;
+
+    for (i = begin; i < end; ++i)
+    {
+        p_context->p_parent_array[i] = i;
+    }
+}
+
+static void link_body(size_t begin,
+                      size_t end,
+                      size_t thread_index,
+                      void*  p_argument)
+{
+    wcc_context* p_context = p_argument;
+    size_t*      p_offsets = p_context->p_graph->p_child_offsets;
+    size_t       low;
+    size_t       high;
+    size_t       middle;
+    size_t       tail;
+    size_t       arc;
+
+    (void) thread_index;
+
+    /* Find the tail of the first arc in the chunk. */
+    low  = 0;
+    high = p_context->p_graph->nodes;
+
+    while (low + 1 < high)
+    {
+        middle = low + (high - low) / 2;
+
+        if (p_offsets[middle] <= begin)
+        {
+            low = middle;
+        }
+        else
+        {
+            high = middle;
+        }
+    }
+
+    tail = low;
+
+    for (arc = begin; arc < end; ++arc)
+    {
+        while (p_offsets[tail + 1] <= arc)
+        {
+            ++tail;
+        }
+
+        unite(p_context->p_parent_array,
+              tail,
+              p_context->p_graph->p_child_array[arc]);
+    }
+}
+
+static void compress_body(size_t begin,
+                          size_t end,
+                          size_t thread_index,
+                          void*  p_argument)
+{
+    wcc_context* p_context = p_argument;
+    size_t       i;
+
+    (void) thread_index;
+
+    for (i = begin; i < end; ++i)
+    {
+        p_context->p_label_array[i] = find_root(p_context->p_parent_array, i);
+    }
+}
+
+static void label_body(size_t begin,
+                       size_t end,
+                       size_t thread_index,
+                       void*  p_argument)
+{
+    wcc_context* p_context = p_argument;
+    size_t       component;
+    size_t       i;
+
+    (void) thread_index;
+
+    for (i = begin; i < end; ++i)
+    {
+        component = p_context->p_parent_array[p_context->p_label_array[i]];
+        p_context->p_component_array[i] = component;
+        PARALLEL_FETCH_ADD(&p_context->p_size_array[component], 1);
+    }
+}
+
+weakly_connected_components*
+weakly_connected_components_alloc(compact_graph* p_graph, size_t threads)
+{
+    weakly_connected_components* p_ret;
+    wcc_context                  context;
+    size_t                       nodes;
+    size_t                       i;
+
+    if (!p_graph) return NULL;
+
+    nodes = p_graph->nodes;
+    p_ret = malloc(sizeof(*p_ret));
+
+    if (!p_ret) return NULL;
+
+    context.p_graph           = p_graph;
+    context.p_parent_array    = malloc(sizeof(size_t) * (nodes + 1));
+    context.p_label_array     = malloc(sizeof(size_t) * (nodes + 1));
+    context.p_component_array = malloc(sizeof(size_t) * (nodes + 1));
+    context.p_size_array      = NULL;
+
+    if (!context.p_parent_array
+        || !context.p_label_array
+        || !context.p_component_array)
+    {
+        free(context.p_parent_array);
+        free(context.p_label_array);
+        free(context.p_component_array);
+        free(p_ret);
+        return NULL;
+    }
+
+    parallel_for(0, nodes, threads, init_body, &context);
+    parallel_for(0, p_graph->arcs, threads, link_body, &context);
+    parallel_for(0, nodes, threads, compress_body, &context);
+
+    /* Number the roots densely. A root precedes the rest of its component,
+       and the parent array is no longer needed, so it holds the numbering. */
+    p_ret->components = 0;
+
+    for (i = 0; i < nodes; ++i)
+    {
+        if (context.p_label_array[i] == i)
+        {
+            context.p_parent_array[i] = p_ret->components++;
+        }
+    }
+
+    context.p_size_array = calloc(p_ret->components + 1, sizeof(size_t));
+
+    if (!context.p_size_array)
+    {
+        free(context.p_parent_array);
+        free(context.p_label_array);
+        free(context.p_component_array);
+        free(p_ret);
+        return NULL;
+    }
+
+    parallel_for(0, nodes, threads, label_body, &context);
+
+    free(context.p_parent_array);
+    free(context.p_label_array);
+
+    p_ret->p_component_array = context.p_component_array;
+    p_ret->p_size_array      = context.p_size_array;
+    return p_ret;
+}
+
+void weakly_connected_components_free(
+    weakly_connected_components* p_components)
+{
+    if (!p_components) return;
+
+    free(p_components->p_component_array);
+    free(p_components->p_size_array);
+    free(p_components);
+}
+
+static void weakly_connected_components_test_small()
+{
+    directed_graph_node*         p_nodes[7];
+    compact_graph*               p_graph;
+    weakly_connected_components* p_components;
+    size_t                       i;
+
+    puts("        weakly_connected_components_test_small()");
+
+    for (i = 0; i < 7; ++i)
+    {
+        p_nodes[i] = directed_graph_node_alloc(i);
+    }
+
+    /* Components: {0, 1, 2}, {3}, {4, 5, 6}. */
+    directed_graph_node_add_arc(p_nodes[0], p_nodes[1]);
+    directed_graph_node_add_arc(p_nodes[2], p_nodes[1]);
+    directed_graph_node_add_arc(p_nodes[6], p_nodes[5]);
+    directed_graph_node_add_arc(p_nodes[5], p_nodes[4]);
+    directed_graph_node_add_arc(p_nodes[3], p_nodes[3]);
+
+    p_graph = compact_graph_alloc(p_nodes, 7);
+    p_components = weakly_connected_components_alloc(p_graph, 3);
+
+    ASSERT(p_components->components == 3);
+    ASSERT(p_components->p_component_array[0] == 0);
+    ASSERT(p_components->p_component_array[1] == 0);
+    ASSERT(p_components->p_component_array[2] == 0);
+    ASSERT(p_components->p_component_array[3] == 1);
+    ASSERT(p_components->p_component_array[4] == 2);
+    ASSERT(p_components->p_component_array[5] == 2);
+    ASSERT(p_components->p_component_array[6] == 2);
+    ASSERT(p_components->p_size_array[0] == 3);
+    ASSERT(p_components->p_size_array[1] == 1);
+    ASSERT(p_components->p_size_array[2] == 3);
+
+    weakly_connected_components_free(p_components);
+    compact_graph_free(p_graph);
+
+    for (i = 0; i < 7; ++i)
+    {
+        directed_graph_node_free(p_nodes[i]);
+    }
+}
+
+/* Labels the components with a sequential undirected search for reference. */
+static size_t* reference_components(compact_graph* p_graph)
+{
+    size_t* p_label_array = malloc(sizeof(size_t) * p_graph->nodes);
+    size_t* p_stack       = malloc(sizeof(size_t) * p_graph->nodes);
+    size_t  components    = 0;
+    size_t  top;
+    size_t  node;
+    size_t  next;
+    size_t  i;
+    size_t  j;
+
+    for (i = 0; i < p_graph->nodes; ++i)
+    {
+        p_label_array[i] = p_graph->nodes;
+    }
+
+    for (i = 0; i < p_graph->nodes; ++i)
+    {
+        if (p_label_array[i] != p_graph->nodes) continue;
+
+        p_label_array[i] = components;
+        p_stack[0] = i;
+        top = 1;
+
+        while (top > 0)
+        {
+            node = p_stack[--top];
+
+            for (j = p_graph->p_child_offsets[node];
+                 j < p_graph->p_child_offsets[node + 1];
+                 ++j)
+            {
+                next = p_graph->p_child_array[j];
+
+                if (p_label_array[next] == p_graph->nodes)
+                {
+                    p_label_array[next] = components;
+                    p_stack[top++] = next;
+                }
+            }
+
+            for (j = p_graph->p_parent_offsets[node];
+                 j < p_graph->p_parent_offsets[node + 1];
+                 ++j)
+            {
+                next = p_graph->p_parent_array[j];
+
+                if (p_label_array[next] == p_graph->nodes)
+                {
+                    p_label_array[next] = components;
+                    p_stack[top++] = next;
+                }
+            }
+        }
+
+        ++components;
+    }
+
+    free(p_stack);
+    return p_label_array;
+}
+
+static void weakly_connected_components_test_random()
+{
+    const size_t                 nodes = 2000;
+    directed_graph_node**        p_nodes;
+    compact_graph*               p_graph;
+    weakly_connected_components* p_components;
+    size_t*                      p_expected;
+    size_t                       i;
+    size_t                       threads;
+    int                          all_equal;
+
+    puts("        weakly_connected_components_test_random()");
+
+    p_nodes = malloc(sizeof(directed_graph_node*) * nodes);
+
+    for (i = 0; i < nodes; ++i)
+    {
+        p_nodes[i] = directed_graph_node_alloc(i);
+    }
+
+    for (i = 0; i < nodes; ++i)
+    {
+        directed_graph_node_add_arc(p_nodes[rand() % nodes],
+                                    p_nodes[rand() % nodes]);
+    }
+
+    p_graph = compact_graph_alloc(p_nodes, nodes);
+    p_expected = reference_components(p_graph);
+
+    for (threads = 1; threads <= 8; threads <<= 1)
+    {
+        p_components = weakly_connected_components_alloc(p_graph, threads);
+        all_equal = TRUE;
+
+        for (i = 0; i < nodes; ++i)
+        {
+            if (p_components->p_component_array[i] != p_expected[i])
+            {
+                all_equal = FALSE;
+            }
+        }
+
+        ASSERT(all_equal);
+        weakly_connected_components_free(p_components);
+    }
+
+    free(p_expected);
+    compact_graph_free(p_graph);
+
+    for (i = 0; i < nodes; ++i)
+    {
+        directed_graph_node_free(p_nodes[i]);
+    }
+
+    free(p_nodes);
+}
+
+void weakly_connected_components_test()
+{
+    puts("    weakly_connected_components_test()");
+    weakly_connected_components_test_small();
+    weakly_connected_components_test_random();
+}
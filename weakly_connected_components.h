@@ -0,0 +1,44 @@
+#ifndef WEAKLY_CONNECTED_COMPONENTS_H
+#define WEAKLY_CONNECTED_COMPONENTS_H
+
+#include "compact_graph.h"
+#include <stddef.h>
+
+#ifdef  __cplusplus
+extern "C" {
+#endif
+
+    typedef struct weakly_connected_components {
+        size_t  components;
+
+        /* Maps each node index to its component ID in [0, components). */
+        size_t* p_component_array;
+
+        /* Maps each component ID to the number of nodes in it. */
+        size_t* p_size_array;
+    } weakly_connected_components;
+
+    /***************************************************************************
+    * Computes the weakly connected components of the graph using a lock-free  *
+    * union-find over the arcs, processed in parallel chunks by 'threads'      *
+    * threads. If 'threads' is zero, the hardware concurrency is used.         *
+    * Components are numbered in the order of their smallest node index.       *
+    ***************************************************************************/
+    weakly_connected_components*
+        weakly_connected_components_alloc(compact_graph* p_graph,
+                                          size_t threads);
+
+    /***************************************************************************
+    * Deallocates the component data.                                          *
+    ***************************************************************************/
+    void weakly_connected_components_free(
+        weakly_connected_components* p_components);
+
+    /* Contains the unit tests. */
+    void weakly_connected_components_test();
+
+#ifdef  __cplusplus
+}
+#endif
+
+#endif  /* WEAKLY_CONNECTED_COMPONENTS_H */